@@ -60,12 +60,804 @@ def is_descendant_type(types, name, base):
 		return False
 	return any([is_descendant_type(types, parent, base) for parent in parents.split(',')])
 
+def allocator_object_type(types, param_names, param_types):
+	# object whose host allocations go through pAllocator: the created handle, else the destroyed one
+	index = param_names.index('pAllocator')
+	for i in (len(param_names) - 1, index - 1):
+		type = types.get(param_types[i])
+		if type is not None and type.get('category') == 'handle' and type.get('objtypeenum'):
+			return type.get('objtypeenum')
+	return 'VK_OBJECT_TYPE_UNKNOWN'
+
 def defined(key):
 	return 'defined(' + key + ')'
 
 def cdepends(key):
 	return re.sub(r'[a-zA-Z0-9_]+', lambda m: defined(m.group(0)), key).replace(',', ' || ').replace('+', ' && ')
 
+scalar_sizes = {'char': 1, 'int8_t': 1, 'uint8_t': 1, 'int16_t': 2, 'uint16_t': 2, 'int': 4, 'int32_t': 4, 'uint32_t': 4, 'float': 4, 'int64_t': 8, 'uint64_t': 8, 'double': 8}
+
+def is_vulkan_api(node, attr='api'):
+	api = node.get(attr)
+	return not api or 'vulkan' in api.split(',')
+
+def parse_member(node):
+	# <member> or <param>: type and name are tagged, pointers, const and array sizes are in the text around them
+	head = node.text or ''
+	tail = ''
+	after = False
+	for child in node:
+		if child.tag == 'name':
+			after = True
+		elif child.tag != 'comment':
+			if after:
+				tail += child.text or ''
+			else:
+				head += child.text or ''
+		if after:
+			tail += child.tail or ''
+		else:
+			head += child.tail or ''
+	head = ' '.join(head.split()).replace(' *', '*')
+	length = node.get('len')
+	return {
+		'name': node.findtext('name'),
+		'type': node.findtext('type'),
+		'ctype': head,
+		'ptr': head.count('*'),
+		'dims': re.findall(r'\[\s*([^\]]+?)\s*\]', tail),
+		'bits': ':' in tail,
+		'len': length.split(',') if length else [],
+		'altlen': node.get('altlen'),
+		'selector': node.get('selector'),
+		'selection': node.get('selection'),
+		'stride': node.get('stride'),
+		'values': node.get('values'),
+	}
+
+def guard_expr(atoms):
+	atoms = sorted(set([a for a in atoms if a]))
+	return ' && '.join(['(' + a + ')' if '||' in a else a for a in atoms])
+
+class StructModel:
+	"""Structures and commands of vk.xml as seen by the generated functions of vilc_structs.h"""
+
+	def __init__(self, spec):
+		self.types = {}
+		for type in spec.findall('types/type'):
+			if is_vulkan_api(type):
+				name = type.get('name') or type.findtext('name') or type.findtext('proto/name')
+				self.types[name] = type
+
+		self.structs = OrderedDict()
+		for (name, type) in self.types.items():
+			if type.get('category') in ('struct', 'union') and not type.get('alias'):
+				self.structs[name] = [parse_member(m) for m in type.findall('member') if is_vulkan_api(m)]
+
+		self.constants = {}
+		for enum in spec.findall('enums[@name="API Constants"]/enum'):
+			self.constants[enum.get('name')] = enum
+
+		# types are defined by the header when a feature or extension that requires them is; those only
+		# required by disabled extensions are not defined at all
+		required = {}
+		listed = set()
+		for feature in spec.findall('feature'):
+			name = re.sub(r'VK_(BASE|COMPUTE|GRAPHICS)_VERSION_', 'VK_VERSION_', feature.get('name'))
+			for type in feature.findall('require/type'):
+				listed.add(type.get('name'))
+				if is_vulkan_api(feature):
+					required.setdefault(type.get('name'), set()).add(name)
+		for ext in spec.findall('extensions/extension'):
+			for type in ext.findall('require/type'):
+				listed.add(type.get('name'))
+				if is_vulkan_api(ext, 'supported'):
+					required.setdefault(type.get('name'), set()).add(ext.get('name'))
+
+		self.guards = {}
+		for name in self.types:
+			features = required.get(name, set())
+			if name in listed and not features:
+				continue
+			self.guards[name] = '' if not features or 'VK_VERSION_1_0' in features else ' || '.join([defined(f) for f in sorted(features)])
+
+		self.infos = {}
+
+	def resolve(self, name):
+		type = self.types.get(name)
+		while type is not None and type.get('alias'):
+			name = type.get('alias')
+			type = self.types.get(name)
+		return (name, type)
+
+	def kind(self, name):
+		if name == 'size_t' or name == 'void':
+			return name
+		if name in scalar_sizes:
+			return 'scalar'
+		(name, type) = self.resolve(name)
+		if type is None:
+			return 'opaque'
+		category = type.get('category')
+		if category in ('struct', 'union'):
+			return category
+		if category == 'handle':
+			return 'handle' if type.findtext('type') == 'VK_DEFINE_HANDLE' else 'scalar'
+		if category == 'funcpointer':
+			return 'address'
+		if category == 'basetype':
+			text = ''.join(type.itertext())
+			if 'typedef' not in text:
+				return 'opaque'
+			return 'address' if '*' in text else 'scalar'
+		if category in ('enum', 'bitmask'):
+			return 'scalar'
+		# types of video std headers are described by video.xml; platform types are only passed around by pointer
+		return 'video' if (type.get('requires') or '').startswith('vk_video') else 'opaque'
+
+	def dim_count(self, dims):
+		count = 1
+		for dim in dims:
+			if dim.isdigit():
+				count *= int(dim)
+			elif dim in self.constants and (self.constants[dim].get('value') or '').isdigit():
+				count *= int(self.constants[dim].get('value'))
+			else:
+				return None
+		return count
+
+	def wire(self, name):
+		"""Bytes of the encoding of a value of the type when it is a fixed sequence of scalars, else None"""
+		if name in scalar_sizes:
+			return scalar_sizes[name]
+		(name, type) = self.resolve(name)
+		if type is None:
+			return None
+		category = type.get('category')
+		if category == 'enum':
+			return 4
+		if category in ('bitmask', 'basetype'):
+			inner = type.findtext('type')
+			return scalar_sizes.get(inner) or (self.wire(inner) if inner in self.types else None) if '*' not in ''.join(type.itertext()) else None
+		if category == 'handle':
+			return 8 if type.findtext('type') != 'VK_DEFINE_HANDLE' else None
+		if category in ('struct', 'union'):
+			sizes = []
+			for m in self.structs[name]:
+				size = self.wire(m['type']) if m['ptr'] == 0 and not m['bits'] else None
+				count = self.dim_count(m['dims'])
+				if size is None or count is None:
+					return None
+				sizes.append(size * count)
+			return (sum(sizes) if category == 'struct' else max(sizes)) if sizes else None
+		return None
+
+	def union_mode(self, name):
+		if self.wire(name) is not None:
+			return 'plain'
+		if any([m['selection'] for m in self.structs[name]]):
+			return 'selector'
+		return 'widest'
+
+	def selector(self, name):
+		"""Type of the member that picks the member of a union, None when it has none"""
+		if self.types[name].get('category') != 'union' or self.union_mode(name) != 'selector':
+			return None
+		for s in self.structs.values():
+			for m in s:
+				if self.resolve(m['type'])[0] == name and m['selector']:
+					return [p for p in s if p['name'] == m['selector']][0]['type']
+		return None
+
+	def widest(self, name):
+		sizes = [(self.wire(m['type']) or 0, i) for (i, m) in enumerate(self.structs[name]) if m['ptr'] == 0 and not m['dims']]
+		return self.structs[name][max(sizes)[1]] if sizes and max(sizes)[0] else None
+
+	def mode(self, m, siblings):
+		"""How a member or parameter is encoded, None when vk.xml does not describe it completely"""
+		kind = self.kind(m['type'])
+		if kind == 'video':
+			return None
+		if m['ptr'] == 0:
+			return 'value' if kind not in ('void', 'opaque') else None
+		if m['name'] == 'pNext' and m['ptr'] == 1:
+			return 'next'
+		if not m['len']:
+			return 'address' if kind in ('void', 'opaque', 'address') or m['ptr'] > 1 else 'single'
+		if kind == 'opaque':
+			return None
+		if m['len'][0] == 'null-terminated':
+			return 'string' if m['type'] == 'char' and m['ptr'] == 1 else None
+		if m['len'][0].startswith('latexmath') and not m['altlen']:
+			return None
+		if m['ptr'] == 1:
+			return 'array'
+		if m['ptr'] == 2 and len(m['len']) == 2 and m['len'][1] == 'null-terminated' and m['type'] == 'char':
+			return 'strings'
+		if m['ptr'] == 2 and len(m['len']) == 2 and m['len'][1] == '1' and kind != 'void':
+			return 'pointers'
+		return None
+
+	def length(self, m, siblings, scope):
+		names = set([s['name'] for s in siblings])
+		expr = m['altlen'] or m['len'][0]
+		return re.sub(r'(?<![\w>.])([A-Za-z_]\w*)', lambda g: scope + g.group(1) if g.group(1) in names else g.group(1), expr)
+
+	def info(self, name):
+		"""Whether functions can be generated for the struct, the guards of the types they use and whether it holds no pointers"""
+		if name in self.infos:
+			return self.infos[name]
+		if name not in self.guards:
+			self.infos[name] = (False, set(), False)
+			return self.infos[name]
+		self.infos[name] = (True, set([self.guards[name]]), True) # cycles through pointers are fine
+		info = self.check(self.structs[name])
+		info[1].add(self.guards[name])
+		self.infos[name] = info
+		return info
+
+	def check(self, members):
+		atoms = set()
+		pointer_free = True
+		for m in members:
+			mode = self.mode(m, members)
+			kind = self.kind(m['type'])
+			if mode is None:
+				return (False, atoms, False)
+			if mode not in ('value', 'address'):
+				pointer_free = False
+			if kind in ('struct', 'union') and mode != 'next':
+				(resolved, type) = self.resolve(m['type'])
+				(ok, sub, free) = self.info(resolved)
+				if not ok:
+					return (False, atoms, False)
+				if kind == 'union' and self.union_mode(resolved) == 'selector':
+					if mode != 'value' or m['dims'] or not m['selector'] or m['selector'] not in [s['name'] for s in members[:members.index(m)]]:
+						return (False, atoms, False)
+				if mode == 'pointers' and kind == 'union':
+					return (False, atoms, False)
+				atoms |= sub
+				pointer_free = pointer_free and free
+			elif mode == 'pointers':
+				return (False, atoms, False)
+			if m['stride'] and (mode != 'array' or kind != 'struct'):
+				return (False, atoms, False)
+		return (True, atoms, pointer_free)
+
+	def element(self, m, access):
+		# address of element i of a struct array member, honoring its stride
+		if m['stride']:
+			return '(const ' + m['type'] + '*)((const char*)' + access + ' + i * ' + m['stride_expr'] + ')'
+		return '&' + access + '[i]'
+
+	def encode_field(self, m, siblings, scope, strides):
+		v = scope + m['name']
+		t = m['type']
+		r = self.resolve(t)[0]
+		kind = self.kind(t)
+		mode = self.mode(m, siblings)
+		count = ' * '.join(m['dims'])
+		if mode == 'value':
+			if m['name'] in strides: # arrays with a stride are encoded packed
+				return ['{', '\t' + m['ctype'] + ' value = (' + m['ctype'] + ')sizeof(' + strides[m['name']] + ');', '\tvilc_codecWrite(writer, &value, sizeof(value));', '}']
+			if kind in ('struct', 'union'):
+				args = ', ' + scope + m['selector'] if m['selector'] else ''
+				if m['dims']:
+					return ['{', '\tsize_t i;', '\tfor (i = 0; i < ' + count + '; ++i)', '\t\tvilcEncode_' + r + '(writer, &' + v + '[i]' + args + ');', '}']
+				return ['vilcEncode_' + r + '(writer, &' + v + args + ');']
+			if kind == 'scalar':
+				return ['vilc_codecWrite(writer, ' + ('' if m['dims'] else '&') + v + ', ' + (count + ' * ' if m['dims'] else '') + 'sizeof(' + t + '));']
+			value = '(uint64_t)' + v if kind == 'size_t' else '(uint64_t)(uintptr_t)' + v
+			if m['dims']:
+				return ['{', '\tsize_t i;', '\tfor (i = 0; i < ' + count + '; ++i)', '\t\tvilc_codecWriteU64(writer, ' + value + '[i]);', '}']
+			return ['vilc_codecWriteU64(writer, ' + value + ');']
+		if mode == 'address':
+			return ['vilc_codecWriteU64(writer, (uint64_t)(uintptr_t)' + v + ');']
+		if mode == 'next':
+			return ['vilc_codecEncodeNext(writer, ' + v + ');']
+		if mode == 'string':
+			return ['vilc_codecWriteString(writer, ' + v + ');']
+		length = self.length(m, siblings, scope) if m['len'] else '1'
+		lines = ['{', '\tsize_t count = vilc_codecWriteCount(writer, ' + v + ', ' + length + ');']
+		if mode == 'strings':
+			lines += ['\tsize_t i;', '\tfor (i = 0; i < count; ++i)', '\t\tvilc_codecWriteString(writer, ' + v + '[i]);']
+		elif mode == 'pointers':
+			lines += ['\tsize_t i;', '\tfor (i = 0; i < count; ++i)', '\t\tif (vilc_codecWriteCount(writer, ' + v + '[i], 1))', '\t\t\tvilcEncode_' + r + '(writer, ' + v + '[i]);']
+		elif kind == 'void':
+			lines += ['\tvilc_codecWrite(writer, ' + v + ', count);']
+		elif kind == 'scalar':
+			lines += ['\tvilc_codecWrite(writer, ' + v + ', count * sizeof(' + t + '));']
+		else:
+			m = dict(m, stride_expr=scope + (m['stride'] or ''))
+			if kind in ('struct', 'union'):
+				loop = ['\tfor (i = 0; i < count; ++i)', '\t\tvilcEncode_' + r + '(writer, ' + self.element(m, v) + ');']
+			else:
+				loop = ['\tfor (i = 0; i < count; ++i)', '\t\tvilc_codecWriteU64(writer, (uint64_t)' + ('' if kind == 'size_t' else '(uintptr_t)') + v + '[i]);']
+			wire = self.wire(r) if kind in ('struct', 'union') and not m['stride'] else None
+			lines += ['\tsize_t i;']
+			if wire:
+				lines += ['\tif (sizeof(' + t + ') == ' + str(wire) + ')', '\t\tvilc_codecWrite(writer, ' + v + ', count * ' + str(wire) + ');', '\telse']
+				loop = ['\t' + l for l in loop]
+			lines += loop
+		return lines + ['}']
+
+	def decode_field(self, m, siblings, scope):
+		v = scope + m['name']
+		t = m['type']
+		r = self.resolve(t)[0]
+		kind = self.kind(t)
+		mode = self.mode(m, siblings)
+		count = ' * '.join(m['dims'])
+		if mode == 'value':
+			if kind in ('struct', 'union'):
+				args = ', ' + scope + m['selector'] if m['selector'] else ''
+				if m['dims']:
+					return ['{', '\tsize_t i;', '\tfor (i = 0; i < ' + count + '; ++i)', '\t\tvilcDecode_' + r + '(reader, &' + v + '[i]' + args + ');', '}']
+				return ['vilcDecode_' + r + '(reader, &' + v + args + ');']
+			if kind == 'scalar':
+				return ['vilc_codecRead(reader, ' + ('' if m['dims'] else '&') + v + ', ' + (count + ' * ' if m['dims'] else '') + 'sizeof(' + t + '));']
+			value = '(' + t + ')' + ('' if kind == 'size_t' else '(uintptr_t)') + 'vilc_codecReadU64(reader)'
+			if m['dims']:
+				return ['{', '\tsize_t i;', '\tfor (i = 0; i < ' + count + '; ++i)', '\t\t' + v + '[i] = ' + value + ';', '}']
+			return [v + ' = ' + value + ';']
+		if mode == 'address':
+			return [v + ' = (' + m['ctype'] + ')(uintptr_t)vilc_codecReadU64(reader);']
+		if mode == 'next':
+			return [v + ' = (' + m['ctype'] + ')vilc_codecDecodeNext(reader);']
+		if mode == 'string':
+			return [v + ' = (' + m['ctype'] + ')vilc_codecReadString(reader);']
+		if mode == 'strings':
+			return ['{', '\tsize_t count = 0, i;', '\tconst char** items = (const char**)vilc_codecReadArray(reader, sizeof(const char*), &count);',
+				'\tfor (i = 0; i < count; ++i)', '\t\titems[i] = vilc_codecReadString(reader);', '\t' + v + ' = (' + m['ctype'] + ')items;', '}']
+		if mode == 'pointers':
+			return ['{', '\tsize_t count = 0, i;', '\tconst ' + t + '** items = (const ' + t + '**)vilc_codecReadArray(reader, sizeof(const ' + t + '*), &count);',
+				'\tfor (i = 0; i < count; ++i)', '\t{', '\t\tsize_t one = 0, j;', '\t\t' + t + '* item = (' + t + '*)vilc_codecReadArray(reader, sizeof(' + t + '), &one);',
+				'\t\tfor (j = 0; j < one; ++j)', '\t\t\tvilcDecode_' + r + '(reader, &item[j]);', '\t\titems[i] = item;', '\t}', '\t' + v + ' = (' + m['ctype'] + ')items;', '}']
+		if kind == 'void':
+			return ['{', '\tsize_t count = 0;', '\tvoid* items = vilc_codecReadArray(reader, 1, &count);', '\tvilc_codecRead(reader, items, count);', '\t' + v + ' = (' + m['ctype'] + ')items;', '}']
+		lines = ['{']
+		if kind == 'scalar':
+			lines += ['\tsize_t count = 0;', '\t' + t + '* items = (' + t + '*)vilc_codecReadArray(reader, sizeof(' + t + '), &count);', '\tvilc_codecRead(reader, items, count * sizeof(' + t + '));']
+		else:
+			lines += ['\tsize_t count = 0, i;', '\t' + t + '* items = (' + t + '*)vilc_codecReadArray(reader, sizeof(' + t + '), &count);']
+			if kind in ('struct', 'union'):
+				loop = ['\tfor (i = 0; i < count; ++i)', '\t\tvilcDecode_' + r + '(reader, &items[i]);']
+			else:
+				loop = ['\tfor (i = 0; i < count; ++i)', '\t\titems[i] = (' + t + ')' + ('' if kind == 'size_t' else '(uintptr_t)') + 'vilc_codecReadU64(reader);']
+			wire = self.wire(r) if kind in ('struct', 'union') else None
+			if wire:
+				lines += ['\tif (sizeof(' + t + ') == ' + str(wire) + ')', '\t\tvilc_codecRead(reader, items, count * ' + str(wire) + ');', '\telse']
+				loop = ['\t' + l for l in loop]
+			lines += loop
+		return lines + ['\t' + v + ' = (' + m['ctype'] + ')items;', '}']
+
+	def copied(self, name):
+		"""Whether values of the type hold pointers that a deep copy replaces"""
+		(name, type) = self.resolve(name)
+		if self.kind(name) not in ('struct', 'union') or self.info(name)[2]:
+			return False
+		return type.get('category') == 'struct' or self.union_mode(name) == 'selector'
+
+	def copy_field(self, m, siblings, scope):
+		# replaces the pointers of a member of a shallow copy with copies made in the arena; fails when it is exhausted
+		v = scope + m['name']
+		t = m['type']
+		r = self.resolve(t)[0]
+		kind = self.kind(t)
+		mode = self.mode(m, siblings)
+		if mode == 'value':
+			if not self.copied(r):
+				return []
+			args = ', ' + scope + m['selector'] if m['selector'] else ''
+			if m['dims']:
+				return ['{', '\tsize_t i;', '\tfor (i = 0; i < ' + ' * '.join(m['dims']) + '; ++i)', '\t\tif (!vilc_copyMembers_' + r + '(arena, &' + v + '[i]' + args + '))', '\t\t\treturn 0;', '}']
+			return ['if (!vilc_copyMembers_' + r + '(arena, &' + v + args + '))', '\treturn 0;']
+		if mode == 'address':
+			return []
+		if mode == 'next':
+			return ['if (' + v + ')', '{', '\t' + v + ' = (' + m['ctype'] + ')vilcDeepCopyChain(arena, ' + v + ');', '\tif (!' + v + ')', '\t\treturn 0;', '}']
+		if mode == 'string':
+			return ['if (' + v + ')', '{', '\t' + v + ' = (' + m['ctype'] + ')vilc_copyBytes(arena, ' + v + ', strlen(' + v + ') + 1);', '\tif (!' + v + ')', '\t\treturn 0;', '}']
+		loop = mode in ('strings', 'pointers') or self.copied(r)
+		lines = ['if (' + v + ')', '{', '\tsize_t count = ' + ('(size_t)(' + self.length(m, siblings, scope) + ')' if m['len'] else '1') + (', i;' if loop else ';')]
+		if mode == 'strings':
+			lines += ['\tconst char** items = (const char**)vilc_copyBytes(arena, ' + v + ', count * sizeof(const char*));', '\tif (!items)', '\t\treturn 0;',
+				'\tfor (i = 0; i < count; ++i)', '\t\tif (items[i] && !(items[i] = (const char*)vilc_copyBytes(arena, items[i], strlen(items[i]) + 1)))', '\t\t\treturn 0;']
+		elif mode == 'pointers':
+			lines += ['\tconst ' + t + '** items = (const ' + t + '**)vilc_copyBytes(arena, ' + v + ', count * sizeof(const ' + t + '*));', '\tif (!items)', '\t\treturn 0;',
+				'\tfor (i = 0; i < count; ++i)', '\t\tif (items[i] && !(items[i] = vilcDeepCopy_' + r + '(arena, items[i])))', '\t\t\treturn 0;']
+		else:
+			item = 'char' if kind == 'void' else t
+			size = 'count' if kind == 'void' else 'count * sizeof(' + t + ')'
+			if m['stride']:
+				size = '(count ? (count - 1) * ' + scope + m['stride'] + ' + sizeof(' + t + ') : 0)'
+			lines += ['\t' + item + '* items = (' + item + '*)vilc_copyBytes(arena, ' + v + ', ' + size + ');', '\tif (!items)', '\t\treturn 0;']
+			if loop:
+				element = '(' + t + '*)((char*)items + i * ' + scope + m['stride'] + ')' if m['stride'] else '&items[i]'
+				lines += ['\tfor (i = 0; i < count; ++i)', '\t\tif (!vilc_copyMembers_' + r + '(arena, ' + element + '))', '\t\t\treturn 0;']
+		return lines + ['\t' + v + ' = (' + m['ctype'] + ')items;', '}']
+
+	def spanned(self, m, siblings):
+		# members hashed and compared as bytes, together with their neighbors when there is no padding in between
+		mode = self.mode(m, siblings)
+		kind = self.kind(m['type'])
+		if mode == 'address':
+			return True
+		if mode != 'value' or m['bits'] or kind == 'struct':
+			return False
+		return kind != 'union' or self.union_mode(self.resolve(m['type'])[0]) != 'selector'
+
+	def hash_span(self, name, run):
+		first = run[0]['name']
+		last = run[-1]['name']
+		if len(run) == 1:
+			return (['hash = vilc_structHash(&value->' + first + ', sizeof(value->' + first + '), hash);'], ['if (memcmp(&a->' + first + ', &b->' + first + ', sizeof(a->' + first + ')) != 0)', '\treturn 0;'])
+		span = 'offsetof(' + name + ', ' + last + ') + sizeof(value->' + last + ') - offsetof(' + name + ', ' + first + ')'
+		packed = 'if (' + span + ' == ' + ' + '.join(['sizeof(value->' + m['name'] + ')' for m in run]) + ')'
+		hash = [packed, '\thash = vilc_structHash(&value->' + first + ', ' + span + ', hash);', 'else', '{']
+		equal = [packed.replace('value->', 'a->'), '{', '\tif (memcmp(&a->' + first + ', &b->' + first + ', ' + span.replace('value->', 'a->') + ') != 0)', '\t\treturn 0;', '}', 'else', '{']
+		for m in run:
+			(h, e) = self.hash_span(name, [m])
+			hash += ['\t' + l for l in h]
+			equal += ['\t' + l for l in e]
+		return (hash + ['}'], equal + ['}'])
+
+	def hash_field(self, m, siblings):
+		# hashes and compares members that are not bytes of the structure itself
+		t = m['type']
+		r = self.resolve(t)[0]
+		kind = self.kind(t)
+		mode = self.mode(m, siblings)
+		n = m['name']
+		if mode == 'value':
+			args = ', value->' + m['selector'] if m['selector'] else ''
+			if m['dims']:
+				loop = ['{', '\tsize_t i;', '\tfor (i = 0; i < ' + ' * '.join(m['dims']) + '; ++i)']
+				return (loop + ['\t\thash = vilc_hashMembers_' + r + '(&value->' + n + '[i], hash' + args + ');', '}'],
+					loop + ['\t\tif (!vilc_equalMembers_' + r + '(&a->' + n + '[i], &b->' + n + '[i]' + args.replace('value->', 'a->') + '))', '\t\t\treturn 0;', '}'])
+			return (['hash = vilc_hashMembers_' + r + '(&value->' + n + ', hash' + args + ');'], ['if (!vilc_equalMembers_' + r + '(&a->' + n + ', &b->' + n + args.replace('value->', 'a->') + '))', '\treturn 0;'])
+		if mode == 'next':
+			return (['hash = vilc_hashNext(value->' + n + ', hash);'], ['if (!vilc_equalNext(a->' + n + ', b->' + n + '))', '\treturn 0;'])
+		if mode == 'string':
+			return (['hash = vilc_hashString(value->' + n + ', hash);'], ['if (!vilc_equalString(a->' + n + ', b->' + n + '))', '\treturn 0;'])
+		loop = mode in ('strings', 'pointers') or kind == 'struct' or (kind == 'union' and self.union_mode(r) == 'selector')
+		if mode == 'single' and loop:
+			return (['if (value->' + n + ')', '\thash = vilc_hashMembers_' + r + '(value->' + n + ', hash);', 'else', '\thash = vilc_structHash(&value->' + n + ', sizeof(value->' + n + '), hash);'],
+				['if (a->' + n + ' && b->' + n + ' ? !vilc_equalMembers_' + r + '(a->' + n + ', b->' + n + ') : a->' + n + ' != b->' + n + ')', '\treturn 0;'])
+		length = self.length(m, siblings, 'value->') if m['len'] else '1'
+		count = 'size_t count = value->' + n + ' ? (size_t)(' + length + ') : 0' + (', i;' if loop else ';')
+		hash = ['{', '\t' + count, '\thash = vilc_structHash(&count, sizeof(count), hash);']
+		equal = ['{', '\t' + count.replace('value->', 'a->'), '\tif (count != (b->' + n + ' ? (size_t)(' + length.replace('value->', 'b->') + ') : 0))', '\t\treturn 0;']
+		if mode == 'strings':
+			hash += ['\tfor (i = 0; i < count; ++i)', '\t\thash = vilc_hashString(value->' + n + '[i], hash);']
+			equal += ['\tfor (i = 0; i < count; ++i)', '\t\tif (!vilc_equalString(a->' + n + '[i], b->' + n + '[i]))', '\t\t\treturn 0;']
+		elif mode == 'pointers':
+			hash += ['\tfor (i = 0; i < count; ++i)', '\t\tif (value->' + n + '[i])', '\t\t\thash = vilc_hashMembers_' + r + '(value->' + n + '[i], vilc_structHash(&i, sizeof(i), hash));']
+			equal += ['\tfor (i = 0; i < count; ++i)', '\t\tif (a->' + n + '[i] && b->' + n + '[i] ? !vilc_equalMembers_' + r + '(a->' + n + '[i], b->' + n + '[i]) : a->' + n + '[i] != b->' + n + '[i])', '\t\t\treturn 0;']
+		elif loop:
+			if m['stride']:
+				element = '(const ' + t + '*)((const char*)value->' + n + ' + i * value->' + m['stride'] + ')'
+			else:
+				element = '&value->' + n + '[i]'
+			hloop = ['\tfor (i = 0; i < count; ++i)', '\t\thash = vilc_hashMembers_' + r + '(' + element + ', hash);']
+			eloop = ['\tfor (i = 0; i < count; ++i)', '\t\tif (!vilc_equalMembers_' + r + '(' + element.replace('value->', 'a->') + ', ' + element.replace('value->', 'b->') + '))', '\t\t\treturn 0;']
+			wire = self.wire(r) if not m['stride'] else None
+			if wire:
+				hash += ['\tif (sizeof(' + t + ') == ' + str(wire) + ')', '\t\thash = vilc_structHash(value->' + n + ', count * ' + str(wire) + ', hash);', '\telse']
+				equal += ['\tif (sizeof(' + t + ') == ' + str(wire) + ')', '\t{', '\t\tif (count && memcmp(a->' + n + ', b->' + n + ', count * ' + str(wire) + ') != 0)', '\t\t\treturn 0;', '\t}', '\telse']
+				hloop = ['\t' + l for l in hloop]
+				eloop = ['\t' + l for l in eloop]
+			hash += hloop
+			equal += eloop
+		else:
+			size = 'count' if kind == 'void' else 'count * sizeof(' + t + ')'
+			hash += ['\thash = vilc_structHash(value->' + n + ', ' + size + ', hash);']
+			equal += ['\tif (count && memcmp(a->' + n + ', b->' + n + ', ' + size + ') != 0)', '\t\treturn 0;']
+		return (hash + ['}'], equal + ['}'])
+
+	def hash_members(self, name, members):
+		"""Bodies of the functions hashing and comparing a structure or the arguments of a command"""
+		hash = []
+		equal = []
+		i = 0
+		while i < len(members):
+			if self.spanned(members[i], members):
+				j = i
+				while j < len(members) and self.spanned(members[j], members):
+					j += 1
+				(h, e) = self.hash_span(name, members[i:j])
+				i = j
+			else:
+				(h, e) = self.hash_field(members[i], members)
+				i += 1
+			hash += h
+			equal += e
+		return (hash, equal)
+
+	def hash_struct(self, name):
+		members = self.structs[name]
+		wire = self.wire(name)
+		if any([m['bits'] for m in members]) or (self.types[name].get('category') == 'union' and not self.selector(name)):
+			return (['return vilc_structHash(value, sizeof(' + name + '), hash);'], ['return memcmp(a, b, sizeof(' + name + ')) == 0;'])
+		if self.selector(name):
+			hash = ['switch (selector)', '{']
+			equal = ['switch (selector)', '{']
+			for m in members:
+				if not m['selection']:
+					continue
+				(h, e) = self.hash_span(name, [m]) if self.spanned(m, members) else self.hash_field(m, members)
+				cases = ['case ' + s + ':' for s in m['selection'].split(',')]
+				hash += cases + ['\t' + l for l in h] + ['\tbreak;']
+				equal += cases + ['\t' + l for l in e] + ['\tbreak;']
+			return (hash + ['default:', '\tbreak;', '}', 'return hash;'], equal + ['default:', '\tbreak;', '}', 'return 1;'])
+		(hash, equal) = self.hash_members(name, members)
+		if wire:
+			hash = ['if (sizeof(' + name + ') == ' + str(wire) + ')', '\treturn vilc_structHash(value, ' + str(wire) + ', hash);'] + hash
+			equal = ['if (sizeof(' + name + ') == ' + str(wire) + ')', '\treturn memcmp(a, b, ' + str(wire) + ') == 0;'] + equal
+		return (hash + ['return hash;'], equal + ['return 1;'])
+
+	def commands(self, commands, command_guards):
+		"""Commands with the parameters, guard and pointer freedom of their arguments, and those vk.xml does not describe"""
+		described = []
+		skipped = []
+		for name in sorted(command_guards):
+			params = [parse_member(p) for p in commands[name].findall('param') if is_vulkan_api(p)]
+			if [p for p in params if p['ptr'] and not p['ctype'].startswith('const ')]:
+				continue # commands returning data through their parameters have nothing to replay
+			(ok, atoms, pointer_free) = self.check(params)
+			if not ok:
+				skipped.append(name)
+				continue
+			described.append((name, params, guard_expr(atoms | set([command_guards[name]])), pointer_free))
+		return (described, skipped)
+
+	def strides(self, members):
+		return dict([(m['stride'], m['type']) for m in members if m['stride']])
+
+	def codec_struct(self, name):
+		members = self.structs[name]
+		union = self.types[name].get('category') == 'union'
+		mode = self.union_mode(name) if union else None
+		wire = self.wire(name)
+		selector = self.selector(name)
+		extra = ', ' + selector + ' selector' if selector else ''
+		encode = ['void vilcEncode_' + name + '(VilcCodecWriter* writer, const ' + name + '* src' + extra + ')', '{']
+		decode = ['void vilcDecode_' + name + '(VilcCodecReader* reader, ' + name + '* dst' + extra + ')', '{']
+		if union:
+			decode += ['\tmemset(dst, 0, sizeof(*dst));']
+		if any([m['bits'] for m in members]):
+			encode += ['\tvilc_codecWrite(writer, src, sizeof(' + name + '));']
+			decode += ['\tvilc_codecRead(reader, dst, sizeof(' + name + '));']
+		elif union and mode in ('plain', 'widest'):
+			m = self.widest(name) if mode == 'widest' else None
+			if m:
+				encode += ['\t' + l for l in self.encode_field(m, members, 'src->', {})]
+				decode += ['\t' + l for l in self.decode_field(m, members, 'dst->')]
+			else:
+				encode += ['\tvilc_codecWrite(writer, src, ' + str(wire) + ');']
+				decode += ['\tvilc_codecRead(reader, dst, ' + str(wire) + ');']
+		elif union:
+			encode += ['\tswitch (selector)', '\t{']
+			decode += ['\tswitch (selector)', '\t{']
+			for m in members:
+				if not m['selection']:
+					continue
+				cases = ['\tcase ' + s + ':' for s in m['selection'].split(',')]
+				encode += cases + ['\t\t' + l for l in self.encode_field(m, members, 'src->', {})] + ['\t\tbreak;']
+				decode += cases + ['\t\t' + l for l in self.decode_field(m, members, 'dst->')] + ['\t\tbreak;']
+			encode += ['\tdefault:', '\t\tbreak;', '\t}']
+			decode += ['\tdefault:', '\t\tbreak;', '\t}']
+		else:
+			if wire:
+				encode += ['\tif (sizeof(' + name + ') == ' + str(wire) + ')', '\t{', '\t\tvilc_codecWrite(writer, src, ' + str(wire) + ');', '\t\treturn;', '\t}']
+				decode += ['\tif (sizeof(' + name + ') == ' + str(wire) + ')', '\t{', '\t\tvilc_codecRead(reader, dst, ' + str(wire) + ');', '\t\treturn;', '\t}']
+			strides = self.strides(members)
+			for m in members:
+				encode += ['\t' + l for l in self.encode_field(m, members, 'src->', strides)]
+				decode += ['\t' + l for l in self.decode_field(m, members, 'dst->')]
+		return (encode + ['}'], decode + ['}'], selector)
+
+def codec_blocks(model, commands, command_guards):
+	keys = ('CODEC_TYPES_H', 'CODEC_H', 'CODEC_C', 'CODEC_ENCODE_NEXT_C', 'CODEC_DECODE_NEXT_C', 'CODEC_TYPE_INFO_C', 'CODEC_ENCODE_TYPE_C', 'CODEC_DECODE_TYPE_C')
+	groups = OrderedDict([('', dict([(key, '') for key in keys]))])
+
+	def add(guard, key, text):
+		groups.setdefault(guard, dict([(k, '') for k in keys]))[key] += text
+
+	for name in model.structs:
+		(ok, atoms, pointer_free) = model.info(name)
+		if not ok:
+			continue
+		guard = guard_expr(atoms)
+		(encode, decode, selector) = model.codec_struct(name)
+		extra = ', ' + selector + ' selector' if selector else ''
+		add(guard, 'CODEC_H', 'void vilcEncode_' + name + '(VilcCodecWriter* writer, const ' + name + '* src' + extra + ');\n')
+		add(guard, 'CODEC_H', 'void vilcDecode_' + name + '(VilcCodecReader* reader, ' + name + '* dst' + extra + ');\n')
+		add(guard, 'CODEC_C', '\n'.join(encode) + '\n\n' + '\n'.join(decode) + '\n\n')
+		stype = [m['values'] for m in model.structs[name] if m['name'] == 'sType' and m['values']]
+		if stype:
+			add(guard, 'CODEC_ENCODE_NEXT_C', '\t\tcase ' + stype[0] + ':\n\t\t\tvilc_codecWrite(writer, &present, 1);\n\t\t\tvilcEncode_' + name + '(writer, (const ' + name + '*)base);\n\t\t\treturn;\n')
+			add(guard, 'CODEC_DECODE_NEXT_C', '\tcase ' + stype[0] + ':\n\t\tnext = vilc_codecAlloc(reader, sizeof(' + name + '));\n\t\tif (next)\n\t\t\tvilcDecode_' + name + '(reader, (' + name + '*)next);\n\t\treturn next;\n')
+		if selector:
+			continue # only encoded as part of the structure holding the selector
+		add(guard, 'CODEC_TYPES_H', '\tVILC_CODEC_TYPE_' + name + ',\n')
+		info = '\tcase VILC_CODEC_TYPE_' + name + ':\n\t\tinfo.name = "' + name + '";\n\t\tinfo.size = sizeof(' + name + ');\n'
+		if stype:
+			info += '\t\tinfo.sType = ' + stype[0] + ';\n'
+		if pointer_free:
+			info += '\t\tinfo.flags = VILC_CODEC_TYPE_POINTER_FREE_BIT;\n'
+		add(guard, 'CODEC_TYPE_INFO_C', info + '\t\tbreak;\n')
+		add(guard, 'CODEC_ENCODE_TYPE_C', '\tcase VILC_CODEC_TYPE_' + name + ':\n\t\tvilcEncode_' + name + '(writer, (const ' + name + '*)value);\n\t\tbreak;\n')
+		add(guard, 'CODEC_DECODE_TYPE_C', '\tcase VILC_CODEC_TYPE_' + name + ':\n\t\tvilcDecode_' + name + '(reader, (' + name + '*)value);\n\t\tbreak;\n')
+
+	ids = {}
+	(described, skipped) = model.commands(commands, command_guards)
+	for (name, params, guard, pointer_free) in described:
+		id = zlib.crc32(name.encode())
+		assert(id != 0 and id not in ids)
+		ids[id] = name
+		decls = [p['ctype'] + ' ' + p['name'] + ''.join(['[' + d + ']' for d in p['dims']]) for p in params]
+		fields = [re.sub(r'^const (?=[^*]*$)', '', d) if p['dims'] else d for (p, d) in zip(params, decls)]
+		strides = model.strides(params)
+		add(guard, 'CODEC_H', '#define VILC_CODEC_COMMAND_%s 0x%08xu\n' % (name, id))
+		add(guard, 'CODEC_H', 'typedef struct VilcCodecArgs_' + name + '\n{\n' + ''.join(['\t' + f + ';\n' for f in fields]) + '} VilcCodecArgs_' + name + ';\n')
+		add(guard, 'CODEC_H', 'void vilcEncode_' + name + '(VilcCodecWriter* writer, ' + ', '.join(decls) + ');\n')
+		add(guard, 'CODEC_H', 'void vilcDecode_' + name + '(VilcCodecReader* reader, VilcCodecArgs_' + name + '* args);\n')
+		encode = ['void vilcEncode_' + name + '(VilcCodecWriter* writer, ' + ', '.join(decls) + ')', '{', '\tsize_t record = vilc_codecBeginRecord(writer, VILC_CODEC_COMMAND_' + name + ');']
+		decode = ['void vilcDecode_' + name + '(VilcCodecReader* reader, VilcCodecArgs_' + name + '* args)', '{']
+		for p in params:
+			encode += ['\t' + l for l in model.encode_field(p, params, '', strides)]
+			decode += ['\t' + l for l in model.decode_field(p, params, 'args->')]
+		encode += ['\tvilc_codecEndRecord(writer, record);', '}']
+		decode += ['\tvilc_codecEndRead(reader);', '}']
+		add(guard, 'CODEC_C', '\n'.join(encode) + '\n\n' + '\n'.join(decode) + '\n\n')
+		add(guard, 'CODEC_TYPES_H', '\tVILC_CODEC_TYPE_' + name + ',\n')
+		info = '\tcase VILC_CODEC_TYPE_' + name + ':\n\t\tinfo.name = "' + name + '";\n\t\tinfo.size = sizeof(VilcCodecArgs_' + name + ');\n'
+		info += '\t\tinfo.flags = VILC_CODEC_TYPE_COMMAND_BIT' + (' | VILC_CODEC_TYPE_POINTER_FREE_BIT' if pointer_free else '') + ';\n'
+		add(guard, 'CODEC_TYPE_INFO_C', info + '\t\tbreak;\n')
+		args = ', '.join(['args->' + p['name'] for p in params])
+		add(guard, 'CODEC_ENCODE_TYPE_C', '\tcase VILC_CODEC_TYPE_' + name + ':\n\t{\n\t\tconst VilcCodecArgs_' + name + '* args = (const VilcCodecArgs_' + name + '*)value;\n\t\tvilcEncode_' + name + '(writer, ' + args + ');\n\t\tbreak;\n\t}\n')
+		add(guard, 'CODEC_DECODE_TYPE_C', '\tcase VILC_CODEC_TYPE_' + name + ':\n\t\tif (vilc_codecExpectCommand(reader, VILC_CODEC_COMMAND_' + name + '))\n\t\t\tvilcDecode_' + name + '(reader, (VilcCodecArgs_' + name + '*)value);\n\t\tbreak;\n')
+
+	blocks = dict([(key, '') for key in keys])
+	for (guard, texts) in groups.items():
+		for key in keys:
+			if texts[key]:
+				blocks[key] += ('#if ' + guard + '\n' if guard else '') + texts[key] + ('#endif /* ' + guard + ' */\n' if guard else '')
+	if skipped:
+		blocks['CODEC_H'] += '/* Not described completely by vk.xml: ' + ', '.join(skipped) + ' */\n'
+	return blocks
+
+def copy_blocks(model, commands, command_guards):
+	keys = ('COPY_H', 'COPY_DECL_C', 'COPY_C', 'COPY_NEXT_C', 'COPY_SIZE_C', 'COPY_TYPE_C')
+	groups = OrderedDict([('', dict([(key, '') for key in keys]))])
+
+	def add(guard, key, text):
+		groups.setdefault(guard, dict([(k, '') for k in keys]))[key] += text
+
+	for (name, members) in model.structs.items():
+		stype = [m['values'] for m in members if m['name'] == 'sType' and m['values']]
+		if stype and name in model.guards:
+			add(guard_expr([model.guards[name]]), 'COPY_SIZE_C', '\tcase ' + stype[0] + ':\n\t\treturn sizeof(' + name + ');\n')
+		(ok, atoms, pointer_free) = model.info(name)
+		if not ok:
+			continue
+		guard = guard_expr(atoms)
+		selector = model.selector(name)
+		if model.copied(name):
+			decl = 'static int vilc_copyMembers_' + name + '(VilcArena* arena, ' + name + '* dst' + (', ' + selector + ' selector' if selector else '') + ')'
+			body = []
+			if selector:
+				body += ['switch (selector)', '{']
+				for m in members:
+					if m['selection'] and model.copy_field(m, members, 'dst->'):
+						body += ['case ' + s + ':' for s in m['selection'].split(',')] + ['\t' + l for l in model.copy_field(m, members, 'dst->')] + ['\tbreak;']
+				body += ['default:', '\tbreak;', '}']
+			else:
+				for m in members:
+					body += model.copy_field(m, members, 'dst->')
+			add(guard, 'COPY_DECL_C', decl + ';\n')
+			add(guard, 'COPY_C', decl + '\n{\n' + ''.join(['\t' + l + '\n' for l in body]) + '\treturn 1;\n}\n\n')
+		if selector:
+			continue # only copied as part of the structure holding the selector
+		add(guard, 'COPY_H', name + '* vilcDeepCopy_' + name + '(VilcArena* arena, const ' + name + '* src);\n')
+		copy = name + '* vilcDeepCopy_' + name + '(VilcArena* arena, const ' + name + '* src)\n{\n'
+		if pointer_free:
+			copy += '\treturn (' + name + '*)vilc_copyBytes(arena, src, sizeof(' + name + '));\n}\n\n'
+		else:
+			copy += '\tsize_t mark = arena->size;\n\t' + name + '* dst = (' + name + '*)vilc_copyBytes(arena, src, sizeof(' + name + '));\n\n'
+			copy += '\tif (dst && vilc_copyMembers_' + name + '(arena, dst))\n\t\treturn dst;\n\tarena->size = mark;\n\treturn NULL;\n}\n\n'
+		add(guard, 'COPY_C', copy)
+		if stype:
+			add(guard, 'COPY_NEXT_C', '\tcase ' + stype[0] + ':\n\t\treturn vilcDeepCopy_' + name + '(arena, (const ' + name + '*)base);\n')
+		add(guard, 'COPY_TYPE_C', '\tcase VILC_CODEC_TYPE_' + name + ':\n\t\tresult = vilcDeepCopy_' + name + '(arena, (const ' + name + '*)value);\n\t\tbreak;\n')
+
+	for (name, params, guard, pointer_free) in model.commands(commands, command_guards)[0]:
+		args = 'VilcCodecArgs_' + name
+		copy = '\tcase VILC_CODEC_TYPE_' + name + ':\n\t\tresult = vilc_copyBytes(arena, value, sizeof(' + args + '));\n'
+		if not pointer_free:
+			body = []
+			for p in params:
+				body += model.copy_field(p, params, 'dst->')
+			add(guard, 'COPY_C', 'static int vilc_copyArgs_' + name + '(VilcArena* arena, ' + args + '* dst)\n{\n' + ''.join(['\t' + l + '\n' for l in body]) + '\treturn 1;\n}\n\n')
+			copy += '\t\tif (result && !vilc_copyArgs_' + name + '(arena, (' + args + '*)result))\n\t\t\tresult = NULL;\n'
+		add(guard, 'COPY_TYPE_C', copy + '\t\tbreak;\n')
+
+	blocks = dict([(key, '') for key in keys])
+	for (guard, texts) in groups.items():
+		for key in keys:
+			if texts[key]:
+				blocks[key] += ('#if ' + guard + '\n' if guard else '') + texts[key] + ('#endif /* ' + guard + ' */\n' if guard else '')
+	return blocks
+
+def hash_blocks(model, commands, command_guards):
+	keys = ('HASH_H', 'HASH_DECL_C', 'HASH_C', 'HASH_NEXT_C', 'EQUAL_NEXT_C', 'HASH_TYPE_C', 'EQUAL_TYPE_C')
+	groups = OrderedDict([('', dict([(key, '') for key in keys]))])
+
+	def add(guard, key, text):
+		groups.setdefault(guard, dict([(k, '') for k in keys]))[key] += text
+
+	def body(lines):
+		return '{\n' + ''.join(['\t' + l + '\n' for l in lines]) + '}\n\n'
+
+	for (name, members) in model.structs.items():
+		(ok, atoms, pointer_free) = model.info(name)
+		if not ok:
+			continue
+		guard = guard_expr(atoms)
+		selector = model.selector(name)
+		extra = ', ' + selector + ' selector' if selector else ''
+		(hash, equal) = model.hash_struct(name)
+		hdecl = 'static uint64_t vilc_hashMembers_' + name + '(const ' + name + '* value, uint64_t hash' + extra + ')'
+		edecl = 'static int vilc_equalMembers_' + name + '(const ' + name + '* a, const ' + name + '* b' + extra + ')'
+		add(guard, 'HASH_DECL_C', hdecl + ';\n' + edecl + ';\n')
+		add(guard, 'HASH_C', hdecl + '\n' + body(hash) + edecl + '\n' + body(equal))
+		if selector:
+			continue # only hashed as part of the structure holding the selector
+		add(guard, 'HASH_H', 'uint64_t vilcHash_' + name + '(const ' + name + '* value);\n')
+		add(guard, 'HASH_H', 'VkBool32 vilcEqual_' + name + '(const ' + name + '* a, const ' + name + '* b);\n')
+		add(guard, 'HASH_C', 'uint64_t vilcHash_' + name + '(const ' + name + '* value)\n' + body(['return vilc_structHashFinal(vilc_hashMembers_' + name + '(value, 0));']))
+		add(guard, 'HASH_C', 'VkBool32 vilcEqual_' + name + '(const ' + name + '* a, const ' + name + '* b)\n' + body(['return a == b || vilc_equalMembers_' + name + '(a, b) ? VK_TRUE : VK_FALSE;']))
+		stype = [m['values'] for m in members if m['name'] == 'sType' and m['values']]
+		if stype:
+			add(guard, 'HASH_NEXT_C', '\tcase ' + stype[0] + ':\n\t\treturn vilc_hashMembers_' + name + '((const ' + name + '*)base, hash);\n')
+			add(guard, 'EQUAL_NEXT_C', '\tcase ' + stype[0] + ':\n\t\treturn vilc_equalMembers_' + name + '((const ' + name + '*)a, (const ' + name + '*)b);\n')
+		add(guard, 'HASH_TYPE_C', '\tcase VILC_CODEC_TYPE_' + name + ':\n\t\treturn vilcHash_' + name + '((const ' + name + '*)value);\n')
+		add(guard, 'EQUAL_TYPE_C', '\tcase VILC_CODEC_TYPE_' + name + ':\n\t\treturn vilcEqual_' + name + '((const ' + name + '*)a, (const ' + name + '*)b);\n')
+
+	for (name, params, guard, pointer_free) in model.commands(commands, command_guards)[0]:
+		args = 'VilcCodecArgs_' + name
+		(hash, equal) = model.hash_members(args, params)
+		add(guard, 'HASH_C', 'static uint64_t vilc_hashArgs_' + name + '(const ' + args + '* value, uint64_t hash)\n' + body(hash + ['return hash;']))
+		add(guard, 'HASH_C', 'static int vilc_equalArgs_' + name + '(const ' + args + '* a, const ' + args + '* b)\n' + body(equal + ['return 1;']))
+		add(guard, 'HASH_TYPE_C', '\tcase VILC_CODEC_TYPE_' + name + ':\n\t\treturn vilc_structHashFinal(vilc_hashArgs_' + name + '((const ' + args + '*)value, 0));\n')
+		add(guard, 'EQUAL_TYPE_C', '\tcase VILC_CODEC_TYPE_' + name + ':\n\t\treturn vilc_equalArgs_' + name + '((const ' + args + '*)a, (const ' + args + '*)b) ? VK_TRUE : VK_FALSE;\n')
+
+	blocks = dict([(key, '') for key in keys])
+	for (guard, texts) in groups.items():
+		for key in keys:
+			if texts[key]:
+				blocks[key] += ('#if ' + guard + '\n' if guard else '') + texts[key] + ('#endif /* ' + guard + ' */\n' if guard else '')
+	return blocks
+
+# Commands recorded into command buffers as one X-macro, VILC_DEVICE_COMMANDS(X, X_RESULT), so that modes that hook all of
+# them expand the list instead of pasting it; macros cannot hold #if, so every group gets a macro that is empty when the
+# group is not compiled in
+def device_commands_block(device_commands):
+	block = ''
+	macros = []
+	for (group, entries) in device_commands.items():
+		macro = f'VILC_DEVICE_COMMANDS_{zlib.crc32(group.encode()):x}'
+		assert(macro not in macros)
+		macros.append(macro)
+		block += '#if ' + group + '\n'
+		block += '#define ' + macro + '(X, X_RESULT) \\\n\t' + ' \\\n\t'.join(entries) + '\n'
+		block += '#else\n'
+		block += '#define ' + macro + '(X, X_RESULT)\n'
+		block += '#endif /* ' + group + ' */\n'
+	block += '#define VILC_DEVICE_COMMANDS(X, X_RESULT) \\\n\t' + ' \\\n\t'.join([macro + '(X, X_RESULT)' for macro in macros]) + '\n'
+	return block
+
 if __name__ == "__main__":
 	specpath = "https://raw.githubusercontent.com/KhronosGroup/Vulkan-Docs/main/xml/vk.xml"
 
@@ -162,6 +954,7 @@ if __name__ == "__main__":
 
 	devp = {}
 	instp = {}
+	device_commands = OrderedDict()
 
 	for (group, cmdnames) in command_groups.items():
 		ifdef = '#if ' + group + '\n'
@@ -179,6 +972,7 @@ if __name__ == "__main__":
 			ret = cmd.findtext('proto/type')
 			params = []
 			param_names = []
+			param_types = []
 			for param in cmd.findall('param'):
 				api = param.get('api')
 				if api and ('vulkan' not in api.split(',')):
@@ -189,6 +983,7 @@ if __name__ == "__main__":
 					param_str += child.tail or ""
 				params.append(param_str)
 				param_names.append(param.findtext('name'))
+				param_types.append(param.findtext('type'))
 			type = cmd.findtext('param[1]/type')
 
 			if name == 'vkGetInstanceProcAddr':
@@ -230,13 +1025,19 @@ if __name__ == "__main__":
 	
 			blocks['PROTOTYPES_C_VILC'] += ret + ' ' + name + '(' + ', '.join(params) +') {\n'
 			blocks['PROTOTYPES_C_VILC'] += '\tvilc_initOnce();\n'
-			vilc_invocation = 'vilc_' + name + '(' + ', '.join(param_names) + ')'
+			vilc_args = param_names
+			if 'pAllocator' in param_names:
+				objtype = allocator_object_type(types, param_names, param_types)
+				vilc_args = ['VILC_HOST_ALLOCATOR(pAllocator, ' + objtype + ')' if p == 'pAllocator' else p for p in param_names]
+			vilc_invocation = 'vilc_' + name + '(' + ', '.join(vilc_args) + ')'
 			if name == 'vkCreateInstance':
 				blocks['PROTOTYPES_C_VILC'] += '\tVkResult result = ' + vilc_invocation + ';\n'
 				blocks['PROTOTYPES_C_VILC'] += '\tif(result == VK_SUCCESS) {\n'
 				blocks['PROTOTYPES_C_VILC'] += '\t\tloadedInstance = *pInstance;\n'
 				blocks['PROTOTYPES_C_VILC'] += '\t\tvolkGenLoadInstance(loadedInstance, vkGetInstanceProcAddrStub);\n'
 				blocks['PROTOTYPES_C_VILC'] += '\t\tvolkGenLoadDevice(loadedInstance, vkGetInstanceProcAddrStub);\n'
+				blocks['PROTOTYPES_C_VILC'] += '\t\tvilc_installInstanceLayers();\n'
+				blocks['PROTOTYPES_C_VILC'] += '\t\tvilc_installDeviceLayers();\n'
 				blocks['PROTOTYPES_C_VILC'] += '\t}\n'
 				blocks['PROTOTYPES_C_VILC'] += '\treturn result;\n'
 			elif name == 'vkCreateDevice':
@@ -244,6 +1045,7 @@ if __name__ == "__main__":
 				blocks['PROTOTYPES_C_VILC'] += '\tif(result == VK_SUCCESS) {\n'
 				blocks['PROTOTYPES_C_VILC'] += '\t\tloadedDevice = *pDevice;\n'
 				blocks['PROTOTYPES_C_VILC'] += '\t\tvolkGenLoadDevice(loadedDevice, vkGetDeviceProcAddrStub);\n'
+				blocks['PROTOTYPES_C_VILC'] += '\t\tvilc_installDeviceLayers();\n'
 				blocks['PROTOTYPES_C_VILC'] += '\t}\n'
 				blocks['PROTOTYPES_C_VILC'] += '\treturn result;\n'
 			else:
@@ -252,6 +1054,10 @@ if __name__ == "__main__":
 
 			blocks['PROTOTYPES_C'] += 'PFN_' + name + ' ' + name + ';\n'
 
+			# commands recorded into command buffers and loaded with the device, for modes that hook all of them
+			if name.startswith('vkCmd') and name not in instance_commands:
+				device_commands.setdefault(group, []).append(('X(' if ret == 'void' else 'X_RESULT(') + name + ', (' + ', '.join(params) + '), (' + ', '.join(param_names) + '))')
+
 		for key in block_keys:
 			if blocks[key].endswith(ifdef):
 				blocks[key] = blocks[key][:-len(ifdef)]
@@ -274,8 +1080,20 @@ if __name__ == "__main__":
 			else:
 				blocks[key] += '#endif /* ' + group + ' */\n'
 
-	patch_file('volk.h', blocks)
-	patch_file('volk.c', blocks)
-	patch_file('CMakeLists.txt', blocks)
+	blocks['COMMANDS_C_VILC'] = device_commands_block(device_commands)
+
+	command_guards = {}
+	for (name, groups) in commands_to_groups.items():
+		if commands[name].findtext('proto/name') == name:
+			key = groups[0] if len(groups) == 1 else ' || '.join(['(' + g + ')' for g in groups])
+			command_guards[name] = '' if key == defined('VK_VERSION_1_0') else key
+
+	model = StructModel(spec)
+	blocks.update(codec_blocks(model, commands, command_guards))
+	blocks.update(copy_blocks(model, commands, command_guards))
+	blocks.update(hash_blocks(model, commands, command_guards))
+
+	for path in sys.argv[2:] or ['volk.h', 'volk.c', 'CMakeLists.txt', 'vilc_structs.h']:
+		patch_file(path, blocks)
 
 	print(version.find('name').tail.strip())
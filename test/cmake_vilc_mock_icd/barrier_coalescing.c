@@ -0,0 +1,486 @@
+#include "mock_icd.h"
+#include "vilc.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/* the mock does not look at buffers and images, so any handle will do */
+#define HANDLE(type, value) ((type)(uintptr_t)(value))
+
+#define RESOURCE_COUNT 3
+#define BUFFER(index) (0x1000u + (index))
+#define IMAGE(index) (0x2000u + (index))
+
+#define STREAM_COUNT 1024
+#define STREAM_WORK_COUNT 16
+#define STREAM_CAPACITY 1024
+
+/* A dispatch stands for work with one stage and access on one resource; the reference model below only needs that */
+typedef struct Work
+{
+	VkPipelineStageFlags2 stage;
+	VkAccessFlags2 access;
+	uint64_t resource;
+} Work;
+
+static const VkPipelineStageFlags2 stages[] = { VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+	VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT };
+static const VkAccessFlags2 accesses[] = { VK_ACCESS_2_SHADER_WRITE_BIT, VK_ACCESS_2_SHADER_READ_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_ACCESS_2_TRANSFER_READ_BIT };
+static const VkImageLayout layouts[] = { VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+
+static Work works[STREAM_WORK_COUNT];
+static MockCommand stream[STREAM_CAPACITY];
+static uint32_t streamCount;
+static uint32_t streamCalls;
+
+static uint32_t seed = 12345;
+
+static uint32_t randomNumber(uint32_t range)
+{
+	seed = seed * 1664525u + 1013904223u;
+	return (seed >> 8) % range;
+}
+
+static VkFlags64 randomMask(const VkFlags64* bits, uint32_t count, int nonZero)
+{
+	VkFlags64 mask = 0;
+	uint32_t i;
+
+	do
+	{
+		for (i = 0; i < count; ++i)
+			if (randomNumber(3) == 0)
+				mask |= bits[i];
+	} while (nonZero && !mask);
+
+	return mask;
+}
+
+static int isWrite(VkAccessFlags2 access)
+{
+	return (access & (VK_ACCESS_2_SHADER_WRITE_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT)) != 0;
+}
+
+static int stagesOverlap(VkPipelineStageFlags2 first, VkPipelineStageFlags2 second)
+{
+	return (first & second) || ((first | second) & VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
+}
+
+/* Random runs of vkCmdPipelineBarrier and, with synchronization2, vkCmdPipelineBarrier2 calls between dispatches; the
+ * image barriers transition from the layout the image is in, and a barrier call never names a resource twice
+ */
+static void generateStream(int sync2)
+{
+	VkImageLayout imageLayouts[RESOURCE_COUNT];
+	uint32_t work, call, entry, i;
+
+	streamCount = 0;
+	streamCalls = 0;
+	for (i = 0; i < RESOURCE_COUNT; ++i)
+		imageLayouts[i] = VK_IMAGE_LAYOUT_GENERAL;
+
+	for (work = 0; work < STREAM_WORK_COUNT; ++work)
+	{
+		uint32_t callCount = randomNumber(5);
+
+		for (call = 0; call < callCount; ++call)
+		{
+			int legacy = !sync2 || randomNumber(2);
+			VkDependencyFlags dependencyFlags = randomNumber(8) == 0 ? VK_DEPENDENCY_BY_REGION_BIT : 0;
+			VkPipelineStageFlags2 srcStageMask = randomMask(stages, 4, 1), dstStageMask = randomMask(stages, 4, 1);
+			uint32_t entryCount = 1 + randomNumber(3);
+			uint32_t usedBuffers = 0, usedImages = 0;
+
+			if (randomNumber(16) == 0)
+				srcStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+			for (entry = 0; entry < entryCount; ++entry)
+			{
+				MockCommand* command = &stream[streamCount];
+				uint32_t resource = randomNumber(RESOURCE_COUNT);
+
+				memset(command, 0, sizeof(*command));
+				command->type = (MockCommandType)(MOCK_COMMAND_MEMORY_BARRIER + randomNumber(3));
+				command->call = streamCalls;
+				command->legacy = legacy;
+				command->dependencyFlags = dependencyFlags;
+				command->srcStageMask = legacy ? srcStageMask : randomMask(stages, 4, 1);
+				command->dstStageMask = legacy ? dstStageMask : randomMask(stages, 4, 1);
+				command->srcAccessMask = randomMask(accesses, 4, 0);
+				command->dstAccessMask = randomMask(accesses, 4, 0);
+				if (command->type == MOCK_COMMAND_BUFFER_BARRIER)
+				{
+					if (usedBuffers & (1u << resource))
+						continue;
+					usedBuffers |= 1u << resource;
+					command->resource = BUFFER(resource);
+				}
+				else if (command->type == MOCK_COMMAND_IMAGE_BARRIER)
+				{
+					if (usedImages & (1u << resource))
+						continue;
+					usedImages |= 1u << resource;
+					command->resource = IMAGE(resource);
+					command->oldLayout = imageLayouts[resource];
+					command->newLayout = imageLayouts[resource] = layouts[randomNumber(3)];
+				}
+				streamCount++;
+			}
+			streamCalls++;
+		}
+
+		works[work].stage = stages[randomNumber(4)];
+		works[work].access = accesses[randomNumber(4)];
+		works[work].resource = randomNumber(2) ? BUFFER(randomNumber(RESOURCE_COUNT)) : IMAGE(randomNumber(RESOURCE_COUNT));
+		memset(&stream[streamCount], 0, sizeof(stream[streamCount]));
+		stream[streamCount].type = MOCK_COMMAND_DISPATCH;
+		stream[streamCount].call = work;
+		streamCount++;
+	}
+}
+
+/* Records the barrier call that starts at the given entry, and returns the entry after it */
+static uint32_t recordCall(VkCommandBuffer commandBuffer, uint32_t first)
+{
+	VkMemoryBarrier memoryBarriers[3];
+	VkBufferMemoryBarrier bufferBarriers[3];
+	VkImageMemoryBarrier imageBarriers[3];
+	VkMemoryBarrier2 memoryBarriers2[3];
+	VkBufferMemoryBarrier2 bufferBarriers2[3];
+	VkImageMemoryBarrier2 imageBarriers2[3];
+	VkDependencyInfo dependencyInfo = { VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+	uint32_t memoryCount = 0, bufferCount = 0, imageCount = 0;
+	uint32_t last = first;
+
+	memset(memoryBarriers, 0, sizeof(memoryBarriers));
+	memset(bufferBarriers, 0, sizeof(bufferBarriers));
+	memset(imageBarriers, 0, sizeof(imageBarriers));
+	memset(memoryBarriers2, 0, sizeof(memoryBarriers2));
+	memset(bufferBarriers2, 0, sizeof(bufferBarriers2));
+	memset(imageBarriers2, 0, sizeof(imageBarriers2));
+
+	for (; last < streamCount && stream[last].type != MOCK_COMMAND_DISPATCH && stream[last].call == stream[first].call; ++last)
+	{
+		const MockCommand* command = &stream[last];
+
+		if (command->type == MOCK_COMMAND_MEMORY_BARRIER)
+		{
+			memoryBarriers[memoryCount].sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			memoryBarriers[memoryCount].srcAccessMask = (VkAccessFlags)command->srcAccessMask;
+			memoryBarriers[memoryCount].dstAccessMask = (VkAccessFlags)command->dstAccessMask;
+			memoryBarriers2[memoryCount].sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+			memoryBarriers2[memoryCount].srcStageMask = command->srcStageMask;
+			memoryBarriers2[memoryCount].srcAccessMask = command->srcAccessMask;
+			memoryBarriers2[memoryCount].dstStageMask = command->dstStageMask;
+			memoryBarriers2[memoryCount].dstAccessMask = command->dstAccessMask;
+			memoryCount++;
+		}
+		else if (command->type == MOCK_COMMAND_BUFFER_BARRIER)
+		{
+			bufferBarriers[bufferCount].sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+			bufferBarriers[bufferCount].srcAccessMask = (VkAccessFlags)command->srcAccessMask;
+			bufferBarriers[bufferCount].dstAccessMask = (VkAccessFlags)command->dstAccessMask;
+			bufferBarriers[bufferCount].buffer = HANDLE(VkBuffer, command->resource);
+			bufferBarriers[bufferCount].size = VK_WHOLE_SIZE;
+			bufferBarriers2[bufferCount].sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+			bufferBarriers2[bufferCount].srcStageMask = command->srcStageMask;
+			bufferBarriers2[bufferCount].srcAccessMask = command->srcAccessMask;
+			bufferBarriers2[bufferCount].dstStageMask = command->dstStageMask;
+			bufferBarriers2[bufferCount].dstAccessMask = command->dstAccessMask;
+			bufferBarriers2[bufferCount].buffer = HANDLE(VkBuffer, command->resource);
+			bufferBarriers2[bufferCount].size = VK_WHOLE_SIZE;
+			bufferCount++;
+		}
+		else
+		{
+			imageBarriers[imageCount].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			imageBarriers[imageCount].srcAccessMask = (VkAccessFlags)command->srcAccessMask;
+			imageBarriers[imageCount].dstAccessMask = (VkAccessFlags)command->dstAccessMask;
+			imageBarriers[imageCount].oldLayout = command->oldLayout;
+			imageBarriers[imageCount].newLayout = command->newLayout;
+			imageBarriers[imageCount].image = HANDLE(VkImage, command->resource);
+			imageBarriers2[imageCount].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+			imageBarriers2[imageCount].srcStageMask = command->srcStageMask;
+			imageBarriers2[imageCount].srcAccessMask = command->srcAccessMask;
+			imageBarriers2[imageCount].dstStageMask = command->dstStageMask;
+			imageBarriers2[imageCount].dstAccessMask = command->dstAccessMask;
+			imageBarriers2[imageCount].oldLayout = command->oldLayout;
+			imageBarriers2[imageCount].newLayout = command->newLayout;
+			imageBarriers2[imageCount].image = HANDLE(VkImage, command->resource);
+			imageCount++;
+		}
+	}
+
+	if (stream[first].legacy)
+	{
+		vkCmdPipelineBarrier(commandBuffer, (VkPipelineStageFlags)stream[first].srcStageMask, (VkPipelineStageFlags)stream[first].dstStageMask,
+		    stream[first].dependencyFlags, memoryCount, memoryBarriers, bufferCount, bufferBarriers, imageCount, imageBarriers);
+	}
+	else
+	{
+		dependencyInfo.dependencyFlags = stream[first].dependencyFlags;
+		dependencyInfo.memoryBarrierCount = memoryCount;
+		dependencyInfo.pMemoryBarriers = memoryBarriers2;
+		dependencyInfo.bufferMemoryBarrierCount = bufferCount;
+		dependencyInfo.pBufferMemoryBarriers = bufferBarriers2;
+		dependencyInfo.imageMemoryBarrierCount = imageCount;
+		dependencyInfo.pImageMemoryBarriers = imageBarriers2;
+		vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+	}
+
+	return last;
+}
+
+static uint32_t findWork(const MockCommand* commands, uint32_t count, uint32_t work)
+{
+	uint32_t i;
+	for (i = 0; i < count; ++i)
+		if (commands[i].type == MOCK_COMMAND_DISPATCH && commands[i].call == work)
+			break;
+	return i;
+}
+
+/* Reference model: whether the barriers between two works order them. The stages of the first work grow by the
+ * destination stages of every barrier whose source stages they reach, using the stages from before the call for all
+ * barriers of a call; a write is made available by a reached barrier on its resource, or a memory barrier, with its
+ * access in the source access mask, and visible to the second work by such a barrier that also has the stage and
+ * access of the second work in its destination masks.
+ */
+static int isOrdered(const MockCommand* commands, uint32_t count, uint32_t first, uint32_t second)
+{
+	const Work* earlier = &works[first];
+	const Work* later = &works[second];
+	uint32_t i = findWork(commands, count, first) + 1, end = findWork(commands, count, second);
+	VkPipelineStageFlags2 reached = earlier->stage;
+	int available = 0, visible = 0;
+
+	while (i < end)
+	{
+		VkPipelineStageFlags2 callReached = reached;
+		uint32_t call = commands[i].call;
+		int callAvailable = available;
+
+		if (commands[i].type == MOCK_COMMAND_DISPATCH)
+		{
+			++i;
+			continue;
+		}
+
+		for (; i < end && commands[i].type != MOCK_COMMAND_DISPATCH && commands[i].call == call; ++i)
+		{
+			const MockCommand* command = &commands[i];
+
+			if (!stagesOverlap(reached, command->srcStageMask))
+				continue;
+			callReached |= command->dstStageMask;
+			if (command->resource && command->resource != earlier->resource)
+				continue;
+			if (available || (command->srcAccessMask & earlier->access))
+			{
+				callAvailable = 1;
+				visible |= stagesOverlap(command->dstStageMask, later->stage) && (command->dstAccessMask & later->access);
+			}
+		}
+
+		reached = callReached;
+		available = callAvailable;
+	}
+
+	return stagesOverlap(reached, later->stage) && (!isWrite(earlier->access) || visible);
+}
+
+/* Records each stream and checks that the barriers that reach the driver order every pair of works on the same
+ * resource that the stream orders, keep the layout transitions of every image, and take fewer barrier commands
+ */
+static int checkStreams(VkCommandBuffer commandBuffer, int sync2)
+{
+	VkCommandBufferBeginInfo beginInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+	uint32_t orderedPairs = 0, recordedCalls = 0, emittedCalls = 0;
+	uint32_t iteration, first, second, i, j;
+
+	for (iteration = 0; iteration < STREAM_COUNT; ++iteration)
+	{
+		const MockCommand* commands;
+		uint32_t count, lastCall = ~0u;
+
+		generateStream(sync2);
+		mockResetCommandLog();
+		CHECK(vkBeginCommandBuffer(commandBuffer, &beginInfo) == VK_SUCCESS);
+		for (i = 0; i < streamCount;)
+		{
+			if (stream[i].type == MOCK_COMMAND_DISPATCH)
+			{
+				vkCmdDispatch(commandBuffer, stream[i].call, 1, 1);
+				++i;
+			}
+			else
+			{
+				i = recordCall(commandBuffer, i);
+			}
+		}
+		CHECK(vkEndCommandBuffer(commandBuffer) == VK_SUCCESS);
+		count = mockCommandLog(&commands);
+
+		for (first = 0; first < STREAM_WORK_COUNT; ++first)
+			for (second = first + 1; second < STREAM_WORK_COUNT; ++second)
+				if (works[first].resource == works[second].resource && (isWrite(works[first].access) || isWrite(works[second].access)) &&
+				    isOrdered(stream, streamCount, first, second))
+				{
+					CHECK(isOrdered(commands, count, first, second));
+					orderedPairs++;
+				}
+
+		/* image barriers reach the driver in the same order, with the same layouts */
+		for (i = 0, j = 0; i < streamCount; ++i)
+		{
+			if (stream[i].type != MOCK_COMMAND_IMAGE_BARRIER)
+				continue;
+			while (j < count && commands[j].type != MOCK_COMMAND_IMAGE_BARRIER)
+				++j;
+			CHECK(j < count && commands[j].resource == stream[i].resource);
+			CHECK(commands[j].oldLayout == stream[i].oldLayout && commands[j].newLayout == stream[i].newLayout);
+			++j;
+		}
+		for (; j < count; ++j)
+			CHECK(commands[j].type != MOCK_COMMAND_IMAGE_BARRIER);
+
+		for (i = 0; i < count; ++i)
+		{
+			if (commands[i].type == MOCK_COMMAND_DISPATCH || commands[i].call == lastCall)
+				continue;
+			CHECK(commands[i].legacy == !sync2);
+			lastCall = commands[i].call;
+			emittedCalls++;
+		}
+		recordedCalls += streamCalls;
+	}
+
+	CHECK(orderedPairs > 0);
+	CHECK(emittedCalls < recordedCalls);
+	return 0;
+}
+
+int main(void)
+{
+	VkInstanceCreateInfo instanceInfo = { VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
+	VkPhysicalDeviceVulkan13Features features13 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES };
+	VkDeviceCreateInfo deviceInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+	VkCommandPoolCreateInfo poolInfo = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+	VkCommandBufferAllocateInfo allocateInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+	VkCommandBufferBeginInfo beginInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+	VkRenderPassBeginInfo renderPassBegin = { VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO };
+	VkImageMemoryBarrier2 imageBarriers[3];
+	VkDependencyInfo dependencyInfo = { VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+	VkMemoryBarrier memoryBarrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+	VkInstance instance;
+	VkPhysicalDevice physicalDevice;
+	VkDevice device;
+	VkCommandPool commandPool;
+	VkCommandBuffer commandBuffer;
+	VilcBarrierCoalescingStats stats;
+	const MockCommand* commands;
+	uint32_t physicalDeviceCount = 1;
+	uint32_t i;
+
+	CHECK(vkCreateInstance(&instanceInfo, NULL, &instance) == VK_SUCCESS);
+	CHECK(vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, &physicalDevice) == VK_SUCCESS);
+	features13.synchronization2 = VK_TRUE;
+	deviceInfo.pNext = &features13;
+	CHECK(vkCreateDevice(physicalDevice, &deviceInfo, NULL, &device) == VK_SUCCESS);
+
+	CHECK(vkCreateCommandPool(device, &poolInfo, NULL, &commandPool) == VK_SUCCESS);
+	allocateInfo.commandPool = commandPool;
+	allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocateInfo.commandBufferCount = 1;
+	CHECK(vkAllocateCommandBuffers(device, &allocateInfo, &commandBuffer) == VK_SUCCESS);
+
+	memset(imageBarriers, 0, sizeof(imageBarriers));
+	for (i = 0; i < 3; ++i)
+	{
+		imageBarriers[i].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+		imageBarriers[i].srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+		imageBarriers[i].srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+		imageBarriers[i].dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT << i;
+		imageBarriers[i].dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT;
+		imageBarriers[i].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		imageBarriers[i].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		imageBarriers[i].image = HANDLE(VkImage, IMAGE(i));
+	}
+	dependencyInfo.imageMemoryBarrierCount = 1;
+
+	/* a run of barriers on different images is recorded as one command with the union of the stage masks */
+	mockResetCallCounts();
+	mockResetCommandLog();
+	CHECK(vkBeginCommandBuffer(commandBuffer, &beginInfo) == VK_SUCCESS);
+	for (i = 0; i < 3; ++i)
+	{
+		dependencyInfo.pImageMemoryBarriers = &imageBarriers[i];
+		vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+	}
+	CHECK(mockCallCount("vkCmdPipelineBarrier2") == 0);
+	vkCmdDispatch(commandBuffer, 0, 1, 1);
+	CHECK(mockCallCount("vkCmdPipelineBarrier2") == 1 && mockCommandLog(&commands) == 4);
+	for (i = 0; i < 3; ++i)
+	{
+		CHECK(commands[i].type == MOCK_COMMAND_IMAGE_BARRIER && commands[i].call == 0 && commands[i].resource == IMAGE(i));
+		CHECK(commands[i].dstStageMask == (VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | (VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT << 1) | (VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT << 2)));
+	}
+	CHECK(commands[3].type == MOCK_COMMAND_DISPATCH);
+
+	/* a second barrier on the same image, or other dependency flags, start a new command */
+	mockResetCommandLog();
+	dependencyInfo.pImageMemoryBarriers = &imageBarriers[0];
+	vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+	dependencyInfo.pImageMemoryBarriers = &imageBarriers[1];
+	vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+	dependencyInfo.pImageMemoryBarriers = &imageBarriers[0];
+	vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+	dependencyInfo.dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+	dependencyInfo.pImageMemoryBarriers = &imageBarriers[2];
+	vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+	dependencyInfo.dependencyFlags = 0;
+	CHECK(mockCallCount("vkCmdPipelineBarrier2") == 3);
+
+	/* legacy calls merge into the same command; the last run is recorded at vkEndCommandBuffer */
+	memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memoryBarrier, 0, NULL, 0, NULL);
+	CHECK(vkEndCommandBuffer(commandBuffer) == VK_SUCCESS);
+	CHECK(mockCallCount("vkCmdPipelineBarrier2") == 5 && mockCallCount("vkCmdPipelineBarrier") == 0);
+	CHECK(mockCommandLog(&commands) == 5);
+	CHECK(commands[2].resource == IMAGE(0) && commands[3].dependencyFlags == VK_DEPENDENCY_BY_REGION_BIT && commands[4].call == 3);
+	CHECK(commands[4].type == MOCK_COMMAND_MEMORY_BARRIER && commands[4].srcAccessMask == VK_ACCESS_2_SHADER_WRITE_BIT);
+
+	/* barriers inside render pass instances pass through */
+	CHECK(vkBeginCommandBuffer(commandBuffer, &beginInfo) == VK_SUCCESS);
+	vkCmdBeginRenderPass(commandBuffer, &renderPassBegin, VK_SUBPASS_CONTENTS_INLINE);
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_DEPENDENCY_BY_REGION_BIT, 1, &memoryBarrier, 0, NULL, 0, NULL);
+	CHECK(mockCallCount("vkCmdPipelineBarrier") == 1);
+	vkCmdEndRenderPass(commandBuffer);
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 1, &memoryBarrier, 0, NULL, 0, NULL);
+	CHECK(mockCallCount("vkCmdPipelineBarrier") == 1);
+	CHECK(vkEndCommandBuffer(commandBuffer) == VK_SUCCESS);
+	CHECK(mockCallCount("vkCmdPipelineBarrier") == 1 && mockCallCount("vkCmdPipelineBarrier2") == 6);
+
+	vilcGetBarrierCoalescingStats(&stats);
+	CHECK(stats.barrierCalls == 9 && stats.flushedCalls == 6 && stats.passedThroughCalls == 1);
+
+	CHECK(checkStreams(commandBuffer, 1) == 0);
+
+	vkDestroyCommandPool(device, commandPool, NULL);
+	vkDestroyDevice(device, NULL);
+
+	/* without synchronization2 only vkCmdPipelineBarrier calls are merged, into vkCmdPipelineBarrier */
+	deviceInfo.pNext = NULL;
+	CHECK(vkCreateDevice(physicalDevice, &deviceInfo, NULL, &device) == VK_SUCCESS);
+	CHECK(vkCreateCommandPool(device, &poolInfo, NULL, &commandPool) == VK_SUCCESS);
+	allocateInfo.commandPool = commandPool;
+	CHECK(vkAllocateCommandBuffers(device, &allocateInfo, &commandBuffer) == VK_SUCCESS);
+	CHECK(checkStreams(commandBuffer, 0) == 0);
+
+	vkDestroyCommandPool(device, commandPool, NULL);
+	vkDestroyDevice(device, NULL);
+	vkDestroyInstance(instance, NULL);
+
+	printf("barrier_coalescing: passed\n");
+	return 0;
+}
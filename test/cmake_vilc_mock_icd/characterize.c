@@ -0,0 +1,185 @@
+#include "mock_icd.h"
+#include "vilc.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define HANDLE(type, value) ((type)(uintptr_t)(value))
+
+#define CONCURRENT_UPDATES 20000
+#define CONCURRENT_FRAMES 100
+
+static VkCommandBuffer updateCommandBuffer;
+
+/* Records while the main thread presents; the mock only counts vkCmdUpdateBuffer, so it is safe to call concurrently */
+static void* recordUpdates(void* unused)
+{
+	uint32_t data = 0;
+	uint32_t i;
+
+	(void)unused;
+	for (i = 0; i < CONCURRENT_UPDATES; ++i)
+		vkCmdUpdateBuffer(updateCommandBuffer, HANDLE(VkBuffer, 0x100), 0, sizeof(data), &data);
+	return NULL;
+}
+
+/* Redirects the reports written to stderr to a temporary file so that they can be checked */
+static FILE* captureStderr(int* saved)
+{
+	FILE* file = tmpfile();
+
+	fflush(stderr);
+	*saved = dup(2);
+	if (file)
+		dup2(fileno(file), 2);
+	return file;
+}
+
+static size_t restoreStderr(FILE* file, int saved, char* text, size_t capacity)
+{
+	size_t size;
+
+	fflush(stderr);
+	dup2(saved, 2);
+	close(saved);
+	rewind(file);
+	size = fread(text, 1, capacity - 1, file);
+	text[size] = 0;
+	fclose(file);
+	return size;
+}
+
+int main(void)
+{
+	VkInstanceCreateInfo instanceInfo = { VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
+	VkDeviceCreateInfo deviceInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+	VkCommandPoolCreateInfo poolInfo = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+	VkCommandBufferAllocateInfo allocateInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+	VkPresentInfoKHR presentInfo = { VK_STRUCTURE_TYPE_PRESENT_INFO_KHR };
+	VkMemoryBarrier barriers[2] = { { VK_STRUCTURE_TYPE_MEMORY_BARRIER }, { VK_STRUCTURE_TYPE_MEMORY_BARRIER } };
+	VkBufferCopy regions[2] = { { 0, 0, 64 }, { 64, 64, 4096 } };
+	VkBuffer buffer = HANDLE(VkBuffer, 0x100);
+	uint32_t data[64] = { 0 };
+	VkInstance instance;
+	VkPhysicalDevice physicalDevice;
+	VkDevice device;
+	VkQueue queue;
+	VkCommandPool commandPool;
+	VkCommandBuffer commandBuffer;
+	VilcWorkloadStats lastFrame, run;
+	const VilcHistogram* histogram;
+	uint32_t physicalDeviceCount = 1;
+	char report[8192];
+	FILE* captured;
+	pthread_t thread;
+	int saved, i;
+
+	setenv("VILC_CHARACTERIZE_REPORT_EVERY", "2", 1);
+
+	CHECK(vkCreateInstance(&instanceInfo, NULL, &instance) == VK_SUCCESS);
+	CHECK(vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, &physicalDevice) == VK_SUCCESS);
+	CHECK(vkCreateDevice(physicalDevice, &deviceInfo, NULL, &device) == VK_SUCCESS);
+	vkGetDeviceQueue(device, 0, 0, &queue);
+	CHECK(vkCreateCommandPool(device, &poolInfo, NULL, &commandPool) == VK_SUCCESS);
+	allocateInfo.commandPool = commandPool;
+	allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocateInfo.commandBufferCount = 1;
+	CHECK(vkAllocateCommandBuffers(device, &allocateInfo, &commandBuffer) == VK_SUCCESS);
+
+	/* nothing is reported before the first present */
+	vilcGetWorkloadStats(&lastFrame, &run);
+	CHECK(lastFrame.frameCount == 0 && run.frameCount == 0);
+	CHECK(lastFrame.metrics[VILC_WORKLOAD_DRAW_VERTEX_COUNT].count == 0);
+
+	/* frame 1: every metric, including the commands reached through KHR aliases */
+	vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+	vkCmdDraw(commandBuffer, 100, 2, 0, 0);
+	vkCmdDrawIndexed(commandBuffer, 36, 4, 0, 0, 0);
+	vkCmdDrawIndirectCountKHR(commandBuffer, buffer, 0, buffer, 0, 7, 16);
+	vkCmdDispatch(commandBuffer, 8, 8, 1);
+	vkCmdDispatchBaseKHR(commandBuffer, 0, 0, 0, 4, 4, 1);
+	vkCmdCopyBuffer(commandBuffer, buffer, buffer, 2, regions);
+	vkCmdUpdateBuffer(commandBuffer, buffer, 0, sizeof(data), data);
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, 0, 2, barriers, 0, NULL, 0, NULL);
+	CHECK(mockCallCount("vkCmdDrawIndirectCount") == 1 && mockCallCount("vkCmdDispatchBase") == 1);
+
+	/* a frame is only visible once it was ended by a present */
+	vilcGetWorkloadStats(&lastFrame, NULL);
+	CHECK(lastFrame.metrics[VILC_WORKLOAD_DRAW_VERTEX_COUNT].count == 0);
+	CHECK(vkQueuePresentKHR(queue, &presentInfo) == VK_SUCCESS);
+	vilcGetWorkloadStats(&lastFrame, &run);
+	CHECK(lastFrame.frameCount == 1 && run.frameCount == 1);
+
+	histogram = &lastFrame.metrics[VILC_WORKLOAD_DRAW_VERTEX_COUNT];
+	CHECK(histogram->count == 2 && histogram->sum == 103 && histogram->min == 3 && histogram->max == 100);
+	/* 3 is in [2, 4) and 100 in [64, 128) */
+	CHECK(histogram->buckets[2] == 1 && histogram->buckets[7] == 1);
+	histogram = &lastFrame.metrics[VILC_WORKLOAD_DRAW_INSTANCE_COUNT];
+	CHECK(histogram->count == 3 && histogram->sum == 7 && histogram->min == 1 && histogram->max == 4);
+	histogram = &lastFrame.metrics[VILC_WORKLOAD_DRAW_INDEX_COUNT];
+	CHECK(histogram->count == 1 && histogram->sum == 36);
+	histogram = &lastFrame.metrics[VILC_WORKLOAD_DRAW_INDIRECT_COUNT];
+	CHECK(histogram->count == 1 && histogram->sum == 7);
+	histogram = &lastFrame.metrics[VILC_WORKLOAD_DISPATCH_GROUP_COUNT];
+	CHECK(histogram->count == 2 && histogram->min == 16 && histogram->max == 64);
+	histogram = &lastFrame.metrics[VILC_WORKLOAD_COPY_BUFFER_BYTES];
+	CHECK(histogram->count == 2 && histogram->sum == 4160);
+	histogram = &lastFrame.metrics[VILC_WORKLOAD_UPDATE_BUFFER_BYTES];
+	CHECK(histogram->count == 1 && histogram->sum == sizeof(data));
+	histogram = &lastFrame.metrics[VILC_WORKLOAD_BARRIER_COUNT];
+	CHECK(histogram->count == 1 && histogram->sum == 2);
+	CHECK(memcmp(&lastFrame.metrics, &run.metrics, sizeof(run.metrics)) == 0);
+
+	/* frame 2 is recorded into the other slot and merged into the run; every second frame is reported */
+	vkCmdDraw(commandBuffer, 1000, 1, 0, 0);
+	CHECK((captured = captureStderr(&saved)) != NULL);
+	CHECK(vkQueuePresentKHR(queue, &presentInfo) == VK_SUCCESS);
+	restoreStderr(captured, saved, report, sizeof(report));
+	CHECK(strstr(report, "vilc: frame workload (frames: 1)") != NULL);
+	CHECK(strstr(report, "draw vertexCount") != NULL && strstr(report, "draw indexCount") == NULL);
+
+	vilcGetWorkloadStats(&lastFrame, &run);
+	CHECK(lastFrame.frameCount == 1 && run.frameCount == 2);
+	histogram = &lastFrame.metrics[VILC_WORKLOAD_DRAW_VERTEX_COUNT];
+	CHECK(histogram->count == 1 && histogram->min == 1000 && histogram->max == 1000);
+	CHECK(lastFrame.metrics[VILC_WORKLOAD_DRAW_INDEX_COUNT].count == 0);
+	histogram = &run.metrics[VILC_WORKLOAD_DRAW_VERTEX_COUNT];
+	CHECK(histogram->count == 3 && histogram->sum == 1103 && histogram->min == 3 && histogram->max == 1000);
+
+	/* frame 3 reuses the slot of frame 1, which must have been cleared when it was flipped back in */
+	CHECK(vkQueuePresentKHR(queue, &presentInfo) == VK_SUCCESS);
+	vilcGetWorkloadStats(&lastFrame, &run);
+	CHECK(lastFrame.frameCount == 1 && run.frameCount == 3);
+	CHECK(lastFrame.metrics[VILC_WORKLOAD_DRAW_VERTEX_COUNT].count == 0);
+	CHECK(lastFrame.metrics[VILC_WORKLOAD_DISPATCH_GROUP_COUNT].count == 0);
+	CHECK(run.metrics[VILC_WORKLOAD_DRAW_VERTEX_COUNT].count == 3);
+
+	/* frames flip while another thread records; a record that races a flip is counted whole, once */
+	updateCommandBuffer = commandBuffer;
+	CHECK((captured = captureStderr(&saved)) != NULL);
+	CHECK(pthread_create(&thread, NULL, recordUpdates, NULL) == 0);
+	for (i = 0; i < CONCURRENT_FRAMES; ++i)
+		CHECK(vkQueuePresentKHR(queue, &presentInfo) == VK_SUCCESS);
+	pthread_join(thread, NULL);
+	CHECK(vkQueuePresentKHR(queue, &presentInfo) == VK_SUCCESS);
+	restoreStderr(captured, saved, report, sizeof(report));
+	vilcGetWorkloadStats(NULL, &run);
+	CHECK(run.frameCount == 4 + CONCURRENT_FRAMES);
+	histogram = &run.metrics[VILC_WORKLOAD_UPDATE_BUFFER_BYTES];
+	CHECK(histogram->count == 1 + CONCURRENT_UPDATES && histogram->sum == sizeof(data) + CONCURRENT_UPDATES * sizeof(uint32_t));
+
+	/* the run report is printed at device destruction */
+	vkDestroyCommandPool(device, commandPool, NULL);
+	CHECK((captured = captureStderr(&saved)) != NULL);
+	vkDestroyDevice(device, NULL);
+	restoreStderr(captured, saved, report, sizeof(report));
+	CHECK(strstr(report, "vilc: run workload (frames: 104)") != NULL);
+	CHECK(strstr(report, "dispatch groups") != NULL && strstr(report, "barriers per call") != NULL);
+	vkDestroyInstance(instance, NULL);
+
+	printf("characterize: passed\n");
+	return 0;
+}
@@ -0,0 +1,232 @@
+#include "mock_icd.h"
+#include "vilc.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/* the mock does not look at buffers, so any handle will do */
+#define HANDLE(type, value) ((type)(uintptr_t)(value))
+
+#define RECYCLED_DRAWS 1000
+
+#define BENCHMARK_DRAWS 10000
+#define BENCHMARK_RUN 50
+
+static uint32_t driverCommandCalls(void)
+{
+	return mockCallCount("vkCmdBindVertexBuffers") + mockCallCount("vkCmdDrawIndexed") + mockCallCount("vilcCmdExecuteRecordedCommands");
+}
+
+/* Driver calls that record BENCHMARK_DRAWS draws in runs of BENCHMARK_RUN, with a vertex buffer bound before each run */
+static uint32_t benchmark(VkPhysicalDevice physicalDevice, const VkDeviceCreateInfo* deviceInfo, const char* name)
+{
+	VkCommandPoolCreateInfo poolInfo = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+	VkCommandBufferAllocateInfo allocateInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+	VkCommandBufferBeginInfo beginInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+	VkBuffer vertexBuffer = HANDLE(VkBuffer, 0x1000);
+	VkDeviceSize offset = 0;
+	VkDevice device;
+	VkCommandPool commandPool;
+	VkCommandBuffer commandBuffer;
+	uint32_t calls, i;
+
+	if (vkCreateDevice(physicalDevice, deviceInfo, NULL, &device) != VK_SUCCESS || vkCreateCommandPool(device, &poolInfo, NULL, &commandPool) != VK_SUCCESS)
+		return 0;
+	allocateInfo.commandPool = commandPool;
+	allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocateInfo.commandBufferCount = 1;
+	if (vkAllocateCommandBuffers(device, &allocateInfo, &commandBuffer) != VK_SUCCESS)
+		return 0;
+
+	mockResetCallCounts();
+	vkBeginCommandBuffer(commandBuffer, &beginInfo);
+	for (i = 0; i < BENCHMARK_DRAWS; ++i)
+	{
+		if (i % BENCHMARK_RUN == 0)
+			vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer, &offset);
+		vkCmdDrawIndexed(commandBuffer, 36, 1, i * 36, 0, 0);
+	}
+	vkEndCommandBuffer(commandBuffer);
+	calls = driverCommandCalls();
+
+	vkDestroyCommandPool(device, commandPool, NULL);
+	vkDestroyDevice(device, NULL);
+	printf("deferred_commands: %d draws in runs of %d %s: %u driver calls\n", BENCHMARK_DRAWS, BENCHMARK_RUN, name, calls);
+	return calls;
+}
+
+int main(void)
+{
+	VkInstanceCreateInfo instanceInfo = { VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
+	VkDeviceCreateInfo deviceInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+	VkCommandPoolCreateInfo poolInfo = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+	VkCommandBufferAllocateInfo allocateInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+	VkCommandBufferBeginInfo beginInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+	VkDebugUtilsLabelEXT label = { VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT };
+	VkBuffer buffers[2] = { HANDLE(VkBuffer, 0x1000), HANDLE(VkBuffer, 0x2000) };
+	VkDeviceSize offsets[2] = { 0, 256 };
+	VkDescriptorSet sets[2] = { HANDLE(VkDescriptorSet, 0x3000), HANDLE(VkDescriptorSet, 0x4000) };
+	uint32_t dynamicOffset = 64;
+	VkViewport viewport = { 0, 0, 640, 480, 0, 1 };
+	VkRect2D scissor = { { 0, 0 }, { 640, 480 } };
+	VkBufferCopy region = { 0, 0, 256 };
+	uint32_t values[2] = { 0x11223344, 0x55667788 };
+	VkInstance instance;
+	VkPhysicalDevice physicalDevice;
+	VkDevice device;
+	VkCommandPool commandPool;
+	VkCommandBuffer commandBuffers[2];
+	VilcDeferredCommandsStats stats;
+	const MockCommand* commands;
+	const VilcRecordedDispatch* dispatch;
+	const VilcRecordedPushConstants* pushConstants;
+	const VilcRecordedDraw* draw;
+	const unsigned char* stream;
+	size_t streamSize;
+	uint64_t arenaAllocations;
+	uint32_t physicalDeviceCount = 1, replayedCalls, executedCalls;
+	uint32_t i;
+
+	CHECK(vkCreateInstance(&instanceInfo, NULL, &instance) == VK_SUCCESS);
+	CHECK(vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, &physicalDevice) == VK_SUCCESS);
+
+	/* without the ICD entry the stream is replayed command by command; with it, recording takes one call */
+	replayedCalls = benchmark(physicalDevice, &deviceInfo, "replayed");
+	CHECK(replayedCalls == BENCHMARK_DRAWS + BENCHMARK_DRAWS / BENCHMARK_RUN);
+	mockSetExecuteRecordedCommands(1);
+	executedCalls = benchmark(physicalDevice, &deviceInfo, "with vilcCmdExecuteRecordedCommands");
+	CHECK(executedCalls == 1 && mockCallCount("vkCmdDrawIndexed") == 0);
+	mockSetExecuteRecordedCommands(0);
+
+	CHECK(vkCreateDevice(physicalDevice, &deviceInfo, NULL, &device) == VK_SUCCESS);
+	CHECK(vkCreateCommandPool(device, &poolInfo, NULL, &commandPool) == VK_SUCCESS);
+	allocateInfo.commandPool = commandPool;
+	allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocateInfo.commandBufferCount = 2;
+	CHECK(vkAllocateCommandBuffers(device, &allocateInfo, commandBuffers) == VK_SUCCESS);
+
+	/* recorded commands reach the driver in order before the next other command, with the data they pointed to when
+	 * they were recorded
+	 */
+	mockResetCallCounts();
+	mockResetCommandLog();
+	CHECK(vkBeginCommandBuffer(commandBuffers[0], &beginInfo) == VK_SUCCESS);
+	vkCmdDispatch(commandBuffers[0], 1, 1, 1);
+	vkCmdPushConstants(commandBuffers[0], VK_NULL_HANDLE, VK_SHADER_STAGE_COMPUTE_BIT, 4, sizeof(values), values);
+	values[0] = 0;
+	vkCmdDispatch(commandBuffers[0], 2, 1, 1);
+	CHECK(mockCallCount("vkCmdDispatch") == 0 && mockCallCount("vkCmdPushConstants") == 0);
+	vkCmdPipelineBarrier(commandBuffers[0], VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, NULL, 0, NULL, 0, NULL);
+	CHECK(mockCommandLog(&commands) == 4);
+	CHECK(commands[0].type == MOCK_COMMAND_DISPATCH && commands[0].call == 1);
+	CHECK(commands[1].type == MOCK_COMMAND_PUSH_CONSTANTS && commands[1].first == 4 && commands[1].count == sizeof(values) && commands[1].data == 0x11223344);
+	CHECK(commands[2].type == MOCK_COMMAND_DISPATCH && commands[2].call == 2);
+	CHECK(commands[3].type == MOCK_COMMAND_MEMORY_BARRIER);
+
+	/* the other recorded commands are replayed at vkEndCommandBuffer, and labels end a stream too */
+	vkCmdBindPipeline(commandBuffers[0], VK_PIPELINE_BIND_POINT_GRAPHICS, HANDLE(VkPipeline, 0x5000));
+	vkCmdBindDescriptorSets(commandBuffers[0], VK_PIPELINE_BIND_POINT_GRAPHICS, VK_NULL_HANDLE, 0, 2, sets, 1, &dynamicOffset);
+	vkCmdBindVertexBuffers(commandBuffers[0], 0, 2, buffers, offsets);
+	vkCmdBindIndexBuffer(commandBuffers[0], buffers[1], 0, VK_INDEX_TYPE_UINT16);
+	vkCmdSetViewport(commandBuffers[0], 0, 1, &viewport);
+	vkCmdSetScissor(commandBuffers[0], 0, 1, &scissor);
+	vkCmdSetLineWidth(commandBuffers[0], 1.0f);
+	vkCmdDraw(commandBuffers[0], 3, 1, 0, 0);
+	vkCmdBeginDebugUtilsLabelEXT(commandBuffers[0], &label);
+	CHECK(mockCallCount("vkCmdDraw") == 1 && mockCallCount("vkCmdBeginDebugUtilsLabelEXT") == 1);
+	vkCmdDrawIndexed(commandBuffers[0], 6, 1, 0, -3, 0);
+	vkCmdDispatchIndirect(commandBuffers[0], buffers[0], 0);
+	vkCmdCopyBuffer(commandBuffers[0], buffers[0], buffers[1], 1, &region);
+	vkCmdUpdateBuffer(commandBuffers[0], buffers[1], 0, sizeof(values), values);
+	CHECK(mockCallCount("vkCmdDrawIndexed") == 0);
+	CHECK(vkEndCommandBuffer(commandBuffers[0]) == VK_SUCCESS);
+	CHECK(mockCallCount("vkCmdBindPipeline") == 1 && mockCallCount("vkCmdBindDescriptorSets") == 1 && mockCallCount("vkCmdBindVertexBuffers") == 1);
+	CHECK(mockCallCount("vkCmdBindIndexBuffer") == 1 && mockCallCount("vkCmdSetViewport") == 1 && mockCallCount("vkCmdSetScissor") == 1);
+	CHECK(mockCallCount("vkCmdSetLineWidth") == 1 && mockCallCount("vkCmdDrawIndexed") == 1 && mockCallCount("vkCmdDispatchIndirect") == 1);
+	CHECK(mockCallCount("vkCmdCopyBuffer") == 1 && mockCallCount("vkCmdUpdateBuffer") == 1);
+	CHECK(mockCommandLog(&commands) == 6);
+	CHECK(commands[4].type == MOCK_COMMAND_DRAW && commands[4].count == 3);
+	CHECK(commands[5].type == MOCK_COMMAND_DRAW_INDEXED && commands[5].count == 6 && commands[5].vertexOffset == -3);
+
+	/* command buffers keep streams of their own, and a recording that is begun again drops the one it had */
+	mockResetCommandLog();
+	CHECK(vkBeginCommandBuffer(commandBuffers[0], &beginInfo) == VK_SUCCESS);
+	CHECK(vkBeginCommandBuffer(commandBuffers[1], &beginInfo) == VK_SUCCESS);
+	vkCmdDispatch(commandBuffers[0], 3, 1, 1);
+	vkCmdDispatch(commandBuffers[1], 4, 1, 1);
+	vkCmdDispatch(commandBuffers[0], 5, 1, 1);
+	CHECK(vkEndCommandBuffer(commandBuffers[1]) == VK_SUCCESS);
+	CHECK(mockCommandLog(&commands) == 1 && commands[0].call == 4);
+	CHECK(vkBeginCommandBuffer(commandBuffers[0], &beginInfo) == VK_SUCCESS);
+	vkCmdDispatch(commandBuffers[0], 6, 1, 1);
+	CHECK(vkEndCommandBuffer(commandBuffers[0]) == VK_SUCCESS);
+	CHECK(mockCommandLog(&commands) == 2 && commands[1].call == 6);
+
+	/* stream memory is kept across resets, until a reset releases resources */
+	vilcGetDeferredCommandsStats(&stats);
+	arenaAllocations = stats.arenaAllocations;
+	for (i = 0; i < 3; ++i)
+	{
+		uint32_t j;
+
+		if (i == 1)
+			CHECK(vkResetCommandBuffer(commandBuffers[0], 0) == VK_SUCCESS);
+		if (i == 2)
+			CHECK(vkResetCommandPool(device, commandPool, 0) == VK_SUCCESS);
+		CHECK(vkBeginCommandBuffer(commandBuffers[0], &beginInfo) == VK_SUCCESS);
+		for (j = 0; j < RECYCLED_DRAWS; ++j)
+			vkCmdDraw(commandBuffers[0], 3, 1, j * 3, 0);
+		CHECK(vkEndCommandBuffer(commandBuffers[0]) == VK_SUCCESS);
+		vilcGetDeferredCommandsStats(&stats);
+		CHECK(i == 0 ? stats.arenaAllocations > arenaAllocations : stats.arenaAllocations == arenaAllocations);
+		arenaAllocations = stats.arenaAllocations;
+	}
+	CHECK(vkResetCommandPool(device, commandPool, VK_COMMAND_POOL_RESET_RELEASE_RESOURCES_BIT) == VK_SUCCESS);
+	CHECK(vkBeginCommandBuffer(commandBuffers[0], &beginInfo) == VK_SUCCESS);
+	vkCmdDispatch(commandBuffers[0], 7, 1, 1);
+	CHECK(vkEndCommandBuffer(commandBuffers[0]) == VK_SUCCESS);
+	vilcGetDeferredCommandsStats(&stats);
+	CHECK(stats.arenaAllocations == arenaAllocations + 1);
+
+	vkDestroyCommandPool(device, commandPool, NULL);
+	vkDestroyDevice(device, NULL);
+
+	/* the ICD gets the stream as laid out in vilc.h */
+	mockSetExecuteRecordedCommands(1);
+	CHECK(vkCreateDevice(physicalDevice, &deviceInfo, NULL, &device) == VK_SUCCESS);
+	CHECK(vkCreateCommandPool(device, &poolInfo, NULL, &commandPool) == VK_SUCCESS);
+	allocateInfo.commandPool = commandPool;
+	CHECK(vkAllocateCommandBuffers(device, &allocateInfo, commandBuffers) == VK_SUCCESS);
+	mockResetCallCounts();
+	values[0] = 0x11223344;
+	CHECK(vkBeginCommandBuffer(commandBuffers[0], &beginInfo) == VK_SUCCESS);
+	vkCmdDispatch(commandBuffers[0], 8, 1, 1);
+	vkCmdPushConstants(commandBuffers[0], VK_NULL_HANDLE, VK_SHADER_STAGE_COMPUTE_BIT, 0, 6, values);
+	vkCmdDraw(commandBuffers[0], 3, 2, 1, 0);
+	CHECK(vkEndCommandBuffer(commandBuffers[0]) == VK_SUCCESS);
+	CHECK(mockCallCount("vilcCmdExecuteRecordedCommands") == 1 && mockCallCount("vkCmdDispatch") == 0 && mockCallCount("vkCmdDraw") == 0);
+
+	stream = (const unsigned char*)mockLastRecordedCommands(&streamSize);
+	dispatch = (const VilcRecordedDispatch*)stream;
+	CHECK(dispatch->header.type == VILC_RECORDED_DISPATCH && dispatch->header.size % 8 == 0 && dispatch->groupCountX == 8);
+	pushConstants = (const VilcRecordedPushConstants*)(stream + dispatch->header.size);
+	CHECK(pushConstants->header.type == VILC_RECORDED_PUSH_CONSTANTS && pushConstants->header.size % 8 == 0 && pushConstants->size == 6);
+	CHECK(pushConstants->pValues % 8 == 0 && pushConstants->pValues + 6 <= pushConstants->header.size);
+	CHECK(memcmp((const char*)pushConstants + pushConstants->pValues, values, 6) == 0);
+	draw = (const VilcRecordedDraw*)((const char*)pushConstants + pushConstants->header.size);
+	CHECK(draw->header.type == VILC_RECORDED_DRAW && draw->vertexCount == 3 && draw->instanceCount == 2 && draw->firstVertex == 1);
+	CHECK(dispatch->header.size + pushConstants->header.size + draw->header.size == streamSize);
+
+	vkDestroyCommandPool(device, commandPool, NULL);
+	vkDestroyDevice(device, NULL);
+	mockSetExecuteRecordedCommands(0);
+
+	vilcGetDeferredCommandsStats(&stats);
+	CHECK(stats.recordedCommands == 2 * (BENCHMARK_DRAWS + BENCHMARK_DRAWS / BENCHMARK_RUN) + 3 + 8 + 4 + 4 + 3 * RECYCLED_DRAWS + 1 + 3);
+	CHECK(stats.executedStreams == 2 && stats.replayedStreams == 1 + 3 + 2 + 3 + 1);
+
+	vkDestroyInstance(instance, NULL);
+
+	printf("deferred_commands: passed\n");
+	return 0;
+}
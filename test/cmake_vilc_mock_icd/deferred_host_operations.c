@@ -0,0 +1,105 @@
+#include "mock_icd.h"
+#include "vilc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PIPELINE_COUNT 16
+
+static VkShaderModule moduleOf(uint32_t index)
+{
+	return (VkShaderModule)(uintptr_t)(0x1000 + index);
+}
+
+static void destroyPipelines(VkDevice device, const VkPipeline* pipelines, uint32_t count)
+{
+	uint32_t i;
+	for (i = 0; i < count; ++i)
+		vkDestroyPipeline(device, pipelines[i], NULL);
+}
+
+int main(void)
+{
+	const char* deviceExtensions[] = { "VK_KHR_deferred_host_operations", "VK_KHR_acceleration_structure", "VK_KHR_ray_tracing_pipeline" };
+	VkInstanceCreateInfo instanceInfo = { VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
+	VkDeviceCreateInfo deviceInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+	VkRayTracingPipelineCreateInfoKHR pipelineInfos[PIPELINE_COUNT];
+	VkPipelineShaderStageCreateInfo stages[PIPELINE_COUNT];
+	VkAccelerationStructureBuildGeometryInfoKHR buildInfos[8];
+	VkInstance instance;
+	VkPhysicalDevice physicalDevice;
+	VkDevice device;
+	VkDeferredOperationKHR operation;
+	VkPipeline pipelines[PIPELINE_COUNT];
+	VilcDeferredHostOperationStats stats;
+	uint32_t physicalDeviceCount = 1;
+	uint32_t i;
+
+	memset(pipelineInfos, 0, sizeof(pipelineInfos));
+	memset(stages, 0, sizeof(stages));
+	memset(buildInfos, 0, sizeof(buildInfos));
+	for (i = 0; i < PIPELINE_COUNT; ++i)
+	{
+		stages[i].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		stages[i].module = moduleOf(i);
+		pipelineInfos[i].sType = VK_STRUCTURE_TYPE_RAY_TRACING_PIPELINE_CREATE_INFO_KHR;
+		pipelineInfos[i].stageCount = 1;
+		pipelineInfos[i].pStages = &stages[i];
+		pipelineInfos[i].basePipelineIndex = -1;
+	}
+	for (i = 0; i < 8; ++i)
+		buildInfos[i].sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
+
+	setenv("VILC_DEFERRED_HOST_OPERATIONS_THREADS", "3", 1);
+	CHECK(vkCreateInstance(&instanceInfo, NULL, &instance) == VK_SUCCESS);
+	CHECK(vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, &physicalDevice) == VK_SUCCESS);
+	deviceInfo.enabledExtensionCount = 3;
+	deviceInfo.ppEnabledExtensionNames = deviceExtensions;
+	CHECK(vkCreateDevice(physicalDevice, &deviceInfo, NULL, &device) == VK_SUCCESS);
+
+	/* without a deferred operation the call still completes synchronously, but the pool joins in */
+	mockSetPipelineCompileTime(2000);
+	CHECK(vkCreateRayTracingPipelinesKHR(device, VK_NULL_HANDLE, VK_NULL_HANDLE, PIPELINE_COUNT, pipelineInfos, NULL, pipelines) == VK_SUCCESS);
+	for (i = 0; i < PIPELINE_COUNT; ++i)
+		CHECK(pipelines[i] && mockPipelineShaderModule(pipelines[i]) == moduleOf(i));
+	CHECK(mockDeferredOperationPeakJoiners() > 1);
+	CHECK(mockCallCount("vkCreateDeferredOperationKHR") == 1 && mockCallCount("vkDestroyDeferredOperationKHR") == 1);
+	destroyPipelines(device, pipelines, PIPELINE_COUNT);
+
+	/* the result of the operation is returned as the result of the call */
+	stages[7].module = MOCK_SHADER_MODULE_INVALID;
+	CHECK(vkCreateRayTracingPipelinesKHR(device, VK_NULL_HANDLE, VK_NULL_HANDLE, PIPELINE_COUNT, pipelineInfos, NULL, pipelines) == VK_ERROR_OUT_OF_DEVICE_MEMORY);
+	CHECK(pipelines[7] == VK_NULL_HANDLE && pipelines[6] && pipelines[8]);
+	destroyPipelines(device, pipelines, PIPELINE_COUNT);
+	stages[7].module = moduleOf(7);
+
+	CHECK(vkBuildAccelerationStructuresKHR(device, VK_NULL_HANDLE, 8, buildInfos, NULL) == VK_SUCCESS);
+	mockSetPipelineCompileTime(0);
+
+	/* operations the driver does not defer are not joined */
+	mockResetCallCounts();
+	CHECK(vkBuildAccelerationStructuresKHR(device, VK_NULL_HANDLE, 0, buildInfos, NULL) == VK_SUCCESS);
+	CHECK(mockCallCount("vkDeferredOperationJoinKHR") == 0 && mockCallCount("vkDestroyDeferredOperationKHR") == 1);
+
+	/* operations of the application are passed through, and can be joined through the pool */
+	CHECK(vkCreateDeferredOperationKHR(device, NULL, &operation) == VK_SUCCESS);
+	CHECK(vkCreateRayTracingPipelinesKHR(device, operation, VK_NULL_HANDLE, PIPELINE_COUNT, pipelineInfos, NULL, pipelines) == VK_OPERATION_DEFERRED_KHR);
+	CHECK(mockCallCount("vkDeferredOperationJoinKHR") == 0);
+	CHECK(vilcJoinDeferredOperation(device, operation) == VK_SUCCESS);
+	CHECK(vkGetDeferredOperationResultKHR(device, operation) == VK_SUCCESS);
+	for (i = 0; i < PIPELINE_COUNT; ++i)
+		CHECK(mockPipelineShaderModule(pipelines[i]) == moduleOf(i));
+	vkDestroyDeferredOperationKHR(device, operation, NULL);
+	destroyPipelines(device, pipelines, PIPELINE_COUNT);
+
+	vilcGetDeferredHostOperationStats(&stats);
+	CHECK(stats.threads == 3 && stats.deferredCalls == 3 && stats.joinedOperations == 4);
+	CHECK(stats.poolJoins > 0);
+
+	vkDestroyDevice(device, NULL);
+	vkDestroyInstance(instance, NULL);
+
+	printf("deferred_host_operations: passed\n");
+	return 0;
+}
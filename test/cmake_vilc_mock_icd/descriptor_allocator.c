@@ -0,0 +1,140 @@
+#include "mock_icd.h"
+#include "vilc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_SETS 4
+/* more sets than a pool of VILC_DESCRIPTOR_ALLOCATOR_MAX_GROWTH times the size holds */
+#define TOO_MANY_SETS (MAX_SETS * 16 + 1)
+
+static VkResult allocate(VkDevice device, VkDescriptorPool pool, uint32_t count, const VkDescriptorSetLayout* layouts, VkDescriptorSet* sets)
+{
+	VkDescriptorSetAllocateInfo info = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+
+	info.descriptorPool = pool;
+	info.descriptorSetCount = count;
+	info.pSetLayouts = layouts;
+	return vkAllocateDescriptorSets(device, &info, sets);
+}
+
+int main(void)
+{
+	VkInstanceCreateInfo instanceInfo = { VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
+	VkDeviceCreateInfo deviceInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+	VkDescriptorSetLayoutCreateInfo layoutInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+	VkDescriptorPoolCreateInfo poolInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+	VkDescriptorPoolSize poolSize = { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, MAX_SETS };
+	VkBaseInStructure unknown = { VK_STRUCTURE_TYPE_APPLICATION_INFO };
+	VkInstance instance;
+	VkPhysicalDevice physicalDevice;
+	VkDevice device;
+	VkDescriptorSetLayout layouts[TOO_MANY_SETS], pair[2];
+	VkDescriptorSet sets[TOO_MANY_SETS], recycled[2];
+	VkDescriptorPool pool, other, freeable, passedThrough;
+	VilcDescriptorAllocatorStats stats;
+	uint32_t physicalDeviceCount = 1;
+	uint32_t creates, allocations, frees, i;
+
+	setenv("VILC_DESCRIPTOR_ALLOCATOR_PARKED_POOLS", "1", 1);
+
+	CHECK(vkCreateInstance(&instanceInfo, NULL, &instance) == VK_SUCCESS);
+	CHECK(vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, &physicalDevice) == VK_SUCCESS);
+	CHECK(vkCreateDevice(physicalDevice, &deviceInfo, NULL, &device) == VK_SUCCESS);
+	CHECK(vkCreateDescriptorSetLayout(device, &layoutInfo, NULL, &pair[0]) == VK_SUCCESS);
+	CHECK(vkCreateDescriptorSetLayout(device, &layoutInfo, NULL, &pair[1]) == VK_SUCCESS);
+	for (i = 0; i < TOO_MANY_SETS; ++i)
+		layouts[i] = pair[0];
+
+	poolInfo.maxSets = MAX_SETS;
+	poolInfo.poolSizeCount = 1;
+	poolInfo.pPoolSizes = &poolSize;
+	CHECK(vkCreateDescriptorPool(device, &poolInfo, NULL, &pool) == VK_SUCCESS);
+	CHECK(mockDescriptorPoolCount() == 1);
+
+	/* allocations past maxSets go to driver pools added to the chain, each twice as large as the last */
+	for (i = 0; i < MAX_SETS; ++i)
+	{
+		CHECK(allocate(device, pool, 1, layouts, &sets[i]) == VK_SUCCESS);
+		CHECK(mockDescriptorSetPool(sets[i]) == pool);
+	}
+	CHECK(allocate(device, pool, 1, layouts, &sets[0]) == VK_SUCCESS);
+	CHECK(mockDescriptorSetPool(sets[0]) != pool && mockDescriptorPoolCount() == 2);
+	CHECK(allocate(device, pool, MAX_SETS * 2, layouts, sets) == VK_SUCCESS);
+	CHECK(mockDescriptorSetPool(sets[0]) != pool && mockDescriptorPoolCount() == 3);
+
+	/* calls that do not fit into a pool of the largest size still fail */
+	CHECK(allocate(device, pool, TOO_MANY_SETS, layouts, sets) == VK_ERROR_OUT_OF_POOL_MEMORY);
+	CHECK(mockDescriptorPoolCount() == 5);
+
+	/* a reset starts over at the first driver pool, which is the handle of the application */
+	CHECK(vkResetDescriptorPool(device, pool, 0) == VK_SUCCESS);
+	CHECK(allocate(device, pool, 1, layouts, &sets[0]) == VK_SUCCESS);
+	CHECK(mockDescriptorSetPool(sets[0]) == pool);
+
+	/* destroyed pools are parked, and taken back by a pool created with the same flags and sizes */
+	creates = mockCallCount("vkCreateDescriptorPool");
+	vkDestroyDescriptorPool(device, pool, NULL);
+	CHECK(mockDescriptorPoolCount() == 5);
+	CHECK(vkCreateDescriptorPool(device, &poolInfo, NULL, &other) == VK_SUCCESS);
+	CHECK(other == pool && mockCallCount("vkCreateDescriptorPool") == creates);
+	CHECK(allocate(device, pool, 1, layouts, &sets[0]) == VK_SUCCESS);
+	CHECK(mockDescriptorSetPool(sets[0]) == pool);
+
+	/* past VILC_DESCRIPTOR_ALLOCATOR_PARKED_POOLS, destroyed chains are destroyed */
+	poolInfo.maxSets = MAX_SETS / 2;
+	CHECK(vkCreateDescriptorPool(device, &poolInfo, NULL, &other) == VK_SUCCESS);
+	CHECK(other != pool && mockCallCount("vkCreateDescriptorPool") == creates + 1 && mockDescriptorPoolCount() == 6);
+	vkDestroyDescriptorPool(device, other, NULL);
+	vkDestroyDescriptorPool(device, pool, NULL);
+	CHECK(mockDescriptorPoolCount() == 1);
+	vilcGetDescriptorAllocatorStats(&stats);
+	CHECK(stats.livePools == 0 && stats.parkedPools == 1 && stats.driverPools == 1);
+
+	/* sets freed from pools that allow it are reused by allocations with the same layout */
+	poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+	poolInfo.maxSets = MAX_SETS;
+	CHECK(vkCreateDescriptorPool(device, &poolInfo, NULL, &freeable) == VK_SUCCESS);
+	CHECK(allocate(device, freeable, 2, pair, sets) == VK_SUCCESS);
+	allocations = mockCallCount("vkAllocateDescriptorSets");
+	frees = mockCallCount("vkFreeDescriptorSets");
+	CHECK(vkFreeDescriptorSets(device, freeable, 1, &sets[0]) == VK_SUCCESS);
+	CHECK(allocate(device, freeable, 1, pair, &recycled[0]) == VK_SUCCESS);
+	CHECK(recycled[0] == sets[0] && mockCallCount("vkAllocateDescriptorSets") == allocations);
+
+	/* calls served partly from freelists only ask the driver for the rest */
+	CHECK(vkFreeDescriptorSets(device, freeable, 1, &sets[1]) == VK_SUCCESS);
+	CHECK(allocate(device, freeable, 2, pair, recycled) == VK_SUCCESS);
+	CHECK(recycled[1] == sets[1] && recycled[0] != sets[0] && mockCallCount("vkAllocateDescriptorSets") == allocations + 1);
+	CHECK(mockCallCount("vkFreeDescriptorSets") == frees);
+
+	/* destroying a layout frees the sets on its freelist */
+	CHECK(vkFreeDescriptorSets(device, freeable, 1, &recycled[1]) == VK_SUCCESS);
+	vkDestroyDescriptorSetLayout(device, pair[1], NULL);
+	CHECK(mockCallCount("vkFreeDescriptorSets") == frees + 1);
+	CHECK(allocate(device, freeable, 1, &pair[1], &sets[1]) == VK_SUCCESS);
+	CHECK(mockCallCount("vkAllocateDescriptorSets") == allocations + 2);
+
+	/* pools created with pNext structures pass through */
+	poolInfo.pNext = &unknown;
+	CHECK(vkCreateDescriptorPool(device, &poolInfo, NULL, &passedThrough) == VK_SUCCESS);
+	CHECK(allocate(device, passedThrough, 1, layouts, &sets[2]) == VK_SUCCESS);
+	CHECK(mockDescriptorSetPool(sets[2]) == passedThrough);
+	vkDestroyDescriptorPool(device, passedThrough, NULL);
+
+	vilcGetDescriptorAllocatorStats(&stats);
+	CHECK(stats.allocatedSets == MAX_SETS + 1 + MAX_SETS * 2 + 1 + 1 + 2 + 1 + 2 + 1 && stats.recycledSets == 2);
+	CHECK(stats.driverAllocations == 16 && stats.outOfPoolErrors == 5 && stats.grownPools == 4);
+	CHECK(stats.recycledPools == 1 && stats.passedThroughPools == 1 && stats.livePools == 1 && stats.driverPools == 2);
+	CHECK(stats.allocationTime.count == 12);
+
+	/* pools the application did not destroy and parked ones are destroyed with the device */
+	vkDestroyDescriptorSetLayout(device, pair[0], NULL);
+	vkDestroyDevice(device, NULL);
+	CHECK(mockDescriptorPoolCount() == 0);
+	vkDestroyInstance(instance, NULL);
+
+	printf("descriptor_allocator: passed\n");
+	return 0;
+}
@@ -0,0 +1,208 @@
+#include "mock_icd.h"
+#include "vilc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HANDLE(type, value) ((type)(uintptr_t)(value))
+
+static VkResult allocate(VkDevice device, VkDescriptorPool pool, uint32_t count, const VkDescriptorSetLayout* layouts, VkDescriptorSet* sets)
+{
+	VkDescriptorSetAllocateInfo info = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+
+	info.descriptorPool = pool;
+	info.descriptorSetCount = count;
+	info.pSetLayouts = layouts;
+	return vkAllocateDescriptorSets(device, &info, sets);
+}
+
+/* Writes the buffer to binding 0 and, unless image is 0, the image view to both elements of binding 1 */
+static void write(VkDevice device, VkDescriptorSet set, uint64_t buffer, uint64_t image)
+{
+	VkDescriptorBufferInfo bufferInfo = { HANDLE(VkBuffer, buffer), 0, 256 };
+	VkDescriptorImageInfo imageInfos[2] = { { HANDLE(VkSampler, 0x700), HANDLE(VkImageView, image), VK_IMAGE_LAYOUT_GENERAL },
+		{ HANDLE(VkSampler, 0x700), HANDLE(VkImageView, image), VK_IMAGE_LAYOUT_GENERAL } };
+	VkWriteDescriptorSet writes[2];
+
+	memset(writes, 0, sizeof(writes));
+	writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	writes[0].dstSet = set;
+	writes[0].descriptorCount = 1;
+	writes[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	writes[0].pBufferInfo = &bufferInfo;
+	writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	writes[1].dstSet = set;
+	writes[1].dstBinding = 1;
+	writes[1].descriptorCount = 2;
+	writes[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	writes[1].pImageInfo = imageInfos;
+	vkUpdateDescriptorSets(device, image ? 2 : 1, writes, 0, NULL);
+}
+
+/* Binds the sets and returns the driver sets they were bound as */
+static const VkDescriptorSet* bind(uint32_t count, const VkDescriptorSet* sets)
+{
+	VkCommandBuffer commandBuffer = HANDLE(VkCommandBuffer, 0x1000);
+	const VkDescriptorSet* bound;
+
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, HANDLE(VkPipelineLayout, 0x800), 0, count, sets, 0, NULL);
+	return mockLastBoundDescriptorSets(&bound) == count ? bound : NULL;
+}
+
+int main(void)
+{
+	VkInstanceCreateInfo instanceInfo = { VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
+	VkDeviceCreateInfo deviceInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+	VkDescriptorSetLayoutCreateInfo layoutInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+	VkDescriptorPoolCreateInfo poolInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+	VkDescriptorUpdateTemplateCreateInfo templateInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO };
+	VkPresentInfoKHR presentInfo = { VK_STRUCTURE_TYPE_PRESENT_INFO_KHR };
+	VkCopyDescriptorSet copy = { VK_STRUCTURE_TYPE_COPY_DESCRIPTOR_SET };
+	VkBaseInStructure unknown = { VK_STRUCTURE_TYPE_APPLICATION_INFO };
+	VkDescriptorSetLayoutBinding bindings[2] = { { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_ALL, NULL },
+		{ 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2, VK_SHADER_STAGE_ALL, NULL } };
+	VkDescriptorPoolSize poolSizes[2] = { { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 16 }, { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 32 } };
+	VkDescriptorUpdateTemplateEntry templateEntry = { 0, 0, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0, sizeof(VkDescriptorBufferInfo) };
+	VkDescriptorBufferInfo templateData = { HANDLE(VkBuffer, 0x200), 0, 256 };
+	VkInstance instance;
+	VkPhysicalDevice physicalDevice;
+	VkDevice device;
+	VkQueue queue;
+	VkDescriptorSetLayout layout, passedThroughLayout, layouts[4];
+	VkDescriptorPool pool;
+	VkDescriptorUpdateTemplate updateTemplate;
+	VkDescriptorSet sets[4], shared, other, copied, reborn, passedThrough;
+	VilcDescriptorReuseStats stats;
+	const VkDescriptorSet* bound;
+	uint32_t physicalDeviceCount = 1;
+	uint32_t allocations, updates, frees;
+
+	setenv("VILC_DESCRIPTOR_REUSE_FRAMES", "2", 1);
+
+	CHECK(vkCreateInstance(&instanceInfo, NULL, &instance) == VK_SUCCESS);
+	CHECK(vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, &physicalDevice) == VK_SUCCESS);
+	CHECK(vkCreateDevice(physicalDevice, &deviceInfo, NULL, &device) == VK_SUCCESS);
+	vkGetDeviceQueue(device, 0, 0, &queue);
+	layoutInfo.bindingCount = 2;
+	layoutInfo.pBindings = bindings;
+	CHECK(vkCreateDescriptorSetLayout(device, &layoutInfo, NULL, &layout) == VK_SUCCESS);
+	layouts[0] = layouts[1] = layouts[2] = layouts[3] = layout;
+
+	poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+	poolInfo.maxSets = 8;
+	poolInfo.poolSizeCount = 2;
+	poolInfo.pPoolSizes = poolSizes;
+	CHECK(vkCreateDescriptorPool(device, &poolInfo, NULL, &pool) == VK_SUCCESS);
+
+	/* sets are only allocated and written by the driver when they are bound */
+	allocations = mockCallCount("vkAllocateDescriptorSets");
+	updates = mockCallCount("vkUpdateDescriptorSets");
+	CHECK(allocate(device, pool, 3, layouts, sets) == VK_SUCCESS);
+	write(device, sets[0], 0x100, 0x300);
+	write(device, sets[1], 0x100, 0x300);
+	write(device, sets[2], 0x200, 0);
+	CHECK(mockCallCount("vkAllocateDescriptorSets") == allocations && mockCallCount("vkUpdateDescriptorSets") == updates);
+
+	/* sets with the same content are bound as one driver set */
+	CHECK((bound = bind(3, sets)) != NULL);
+	CHECK(bound[0] == bound[1] && bound[0] != bound[2]);
+	shared = bound[0];
+	other = bound[2];
+	CHECK(mockCallCount("vkAllocateDescriptorSets") == allocations + 2);
+	CHECK(mockDescriptor(shared, 0, 0) == 0x100 && mockDescriptor(shared, 1, 0) == 0x300 && mockDescriptor(shared, 1, 1) == 0x300);
+	CHECK(mockDescriptor(other, 0, 0) == 0x200 && mockDescriptor(other, 1, 0) == 0);
+
+	/* a set updated after it was bound gets a driver set of its own, with what was written before */
+	write(device, sets[0], 0x200, 0);
+	CHECK((bound = bind(2, sets)) != NULL);
+	CHECK(bound[0] != shared && bound[0] != other && bound[1] == shared);
+	CHECK(mockDescriptor(bound[0], 0, 0) == 0x200 && mockDescriptor(bound[0], 1, 1) == 0x300);
+	CHECK(mockDescriptor(shared, 0, 0) == 0x100);
+
+	/* template updates and copies are recorded like writes */
+	CHECK(allocate(device, pool, 1, layouts, &sets[3]) == VK_SUCCESS);
+	templateInfo.descriptorUpdateEntryCount = 1;
+	templateInfo.pDescriptorUpdateEntries = &templateEntry;
+	templateInfo.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+	templateInfo.descriptorSetLayout = layout;
+	CHECK(vkCreateDescriptorUpdateTemplate(device, &templateInfo, NULL, &updateTemplate) == VK_SUCCESS);
+	vkUpdateDescriptorSetWithTemplate(device, sets[3], updateTemplate, &templateData);
+	CHECK((bound = bind(1, &sets[3])) != NULL && bound[0] == other);
+
+	CHECK(allocate(device, pool, 1, layouts, &copied) == VK_SUCCESS);
+	copy.srcSet = sets[1];
+	copy.dstSet = copied;
+	copy.descriptorCount = 3;
+	vkUpdateDescriptorSets(device, 0, NULL, 1, &copy);
+	CHECK((bound = bind(1, &copied)) != NULL && bound[0] == shared);
+	CHECK(mockCallCount("vkAllocateDescriptorSets") == allocations + 3);
+
+	/* driver sets no set is bound as any more are reused until they retire after VILC_DESCRIPTOR_REUSE_FRAMES presents */
+	frees = mockCallCount("vkFreeDescriptorSets");
+	CHECK(vkFreeDescriptorSets(device, pool, 2, &sets[2]) == VK_SUCCESS);
+	CHECK(mockCallCount("vkFreeDescriptorSets") == frees);
+	CHECK(vkQueuePresentKHR(queue, &presentInfo) == VK_SUCCESS);
+	CHECK(allocate(device, pool, 1, layouts, &sets[2]) == VK_SUCCESS);
+	write(device, sets[2], 0x200, 0);
+	CHECK((bound = bind(1, &sets[2])) != NULL && bound[0] == other);
+	CHECK(vkFreeDescriptorSets(device, pool, 1, &sets[2]) == VK_SUCCESS);
+	CHECK(vkQueuePresentKHR(queue, &presentInfo) == VK_SUCCESS);
+	CHECK(mockCallCount("vkFreeDescriptorSets") == frees);
+	CHECK(vkQueuePresentKHR(queue, &presentInfo) == VK_SUCCESS);
+	CHECK(mockCallCount("vkFreeDescriptorSets") == frees + 1);
+	CHECK(mockCallCount("vkAllocateDescriptorSets") == allocations + 3);
+
+	/* a destroyed image view stops the driver sets written with it from being shared, so a view created with the same
+	 * handle gets a driver set of its own
+	 */
+	vkDestroyImageView(device, HANDLE(VkImageView, 0x300), NULL);
+	CHECK(allocate(device, pool, 1, layouts, &sets[2]) == VK_SUCCESS);
+	write(device, sets[2], 0x100, 0x300);
+	CHECK((bound = bind(1, &sets[2])) != NULL && bound[0] != shared);
+	reborn = bound[0];
+	CHECK(mockDescriptor(reborn, 0, 0) == 0x100 && mockDescriptor(reborn, 1, 1) == 0x300);
+	CHECK(mockCallCount("vkAllocateDescriptorSets") == allocations + 4);
+
+	/* sets bound as such a driver set keep it, and updating them does not write the destroyed view again */
+	CHECK((bound = bind(1, &copied)) != NULL && bound[0] == shared);
+	write(device, sets[1], 0x100, 0);
+	CHECK((bound = bind(1, &sets[1])) != NULL && bound[0] != shared && bound[0] != reborn);
+	CHECK(mockDescriptor(bound[0], 0, 0) == 0x100 && mockDescriptor(bound[0], 1, 0) == 0 && mockDescriptor(bound[0], 1, 1) == 0);
+	CHECK(mockCallCount("vkAllocateDescriptorSets") == allocations + 5);
+
+	/* idle driver sets with a destroyed view are freed right away */
+	frees = mockCallCount("vkFreeDescriptorSets");
+	CHECK(vkFreeDescriptorSets(device, pool, 1, &sets[2]) == VK_SUCCESS);
+	CHECK(mockCallCount("vkFreeDescriptorSets") == frees);
+	vkDestroyImageView(device, HANDLE(VkImageView, 0x300), NULL);
+	CHECK(mockCallCount("vkFreeDescriptorSets") == frees + 1);
+
+	/* sets of layouts created with pNext structures pass through */
+	layoutInfo.pNext = &unknown;
+	CHECK(vkCreateDescriptorSetLayout(device, &layoutInfo, NULL, &passedThroughLayout) == VK_SUCCESS);
+	CHECK(allocate(device, pool, 1, &passedThroughLayout, &passedThrough) == VK_SUCCESS);
+	CHECK(mockDescriptorSetPool(passedThrough) == pool);
+	write(device, passedThrough, 0x400, 0);
+	CHECK(mockDescriptor(passedThrough, 0, 0) == 0x400);
+	CHECK((bound = bind(1, &passedThrough)) != NULL && bound[0] == passedThrough);
+
+	vilcGetDescriptorReuseStats(&stats);
+	CHECK(stats.allocatedSets == 7 && stats.passedThroughSets == 1 && stats.recordedUpdates == 10);
+	CHECK(stats.reusedSets == 4 && stats.driverSets == 5 && stats.privateSets == 2 && stats.retiredSets == 1);
+	CHECK(stats.liveDriverSets == 3);
+
+	/* layouts with driver sets left are destroyed with them, and those go with the device */
+	vkDestroyDescriptorUpdateTemplate(device, updateTemplate, NULL);
+	vkDestroyDescriptorPool(device, pool, NULL);
+	CHECK(mockDescriptorPoolCount() == 1);
+	vkDestroyDescriptorSetLayout(device, layout, NULL);
+	vkDestroyDescriptorSetLayout(device, passedThroughLayout, NULL);
+	CHECK(mockCallCount("vkDestroyDescriptorSetLayout") == 1);
+	vkDestroyDevice(device, NULL);
+	CHECK(mockDescriptorPoolCount() == 0 && mockCallCount("vkDestroyDescriptorSetLayout") == 2);
+	vkDestroyInstance(instance, NULL);
+
+	printf("descriptor_reuse: passed\n");
+	return 0;
+}
@@ -0,0 +1,283 @@
+#include "mock_icd.h"
+#include "vilc.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/* the mock does not look at buffers, so any handle will do */
+#define HANDLE(type, value) ((type)(uintptr_t)(value))
+
+/* one run longer than the mock lets a multi draw command take */
+#define LONG_RUN 200
+#define BATCH_SIZE (MOCK_MAX_MULTI_DRAW_COUNT - 1)
+
+#define BENCHMARK_DRAWS 10000
+#define BENCHMARK_RUN 50
+
+/* SPIR-V headers followed by OpCapability Shader and a BuiltIn decoration; only the decorations matter to VILC */
+static const uint32_t positionCode[] = { 0x07230203, 0x00010000, 0, 8, 0, (2u << 16) | 17, 1, (4u << 16) | 71, 1, 11, 0 };
+static const uint32_t drawIndexCode[] = { 0x07230203, 0x00010000, 0, 8, 0, (2u << 16) | 17, 1, (4u << 16) | 71, 1, 11, 4426 };
+static const uint32_t memberDrawIndexCode[] = { 0x07230203, 0x00010000, 0, 8, 0, (2u << 16) | 17, 1, (5u << 16) | 72, 1, 2, 11, 4426 };
+
+static VkShaderModule createShaderModule(VkDevice device, const uint32_t* code, size_t codeSize)
+{
+	VkShaderModuleCreateInfo moduleInfo = { VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO };
+	VkShaderModule module = VK_NULL_HANDLE;
+
+	moduleInfo.codeSize = codeSize;
+	moduleInfo.pCode = code;
+	vkCreateShaderModule(device, &moduleInfo, NULL, &module);
+	return module;
+}
+
+/* A vertex and a fragment stage; a stage without a module gets its code chained from moduleInfo */
+static VkPipeline createPipeline(VkDevice device, VkShaderModule vertex, VkShaderModule fragment, const VkShaderModuleCreateInfo* moduleInfo)
+{
+	VkGraphicsPipelineCreateInfo pipelineInfo = { VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO };
+	VkPipelineShaderStageCreateInfo stages[2];
+	VkPipeline pipeline = VK_NULL_HANDLE;
+	uint32_t i;
+
+	memset(stages, 0, sizeof(stages));
+	for (i = 0; i < 2; ++i)
+	{
+		stages[i].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		stages[i].stage = i ? VK_SHADER_STAGE_FRAGMENT_BIT : VK_SHADER_STAGE_VERTEX_BIT;
+		stages[i].module = i ? fragment : vertex;
+		stages[i].pNext = stages[i].module ? NULL : moduleInfo;
+		stages[i].pName = "main";
+	}
+	pipelineInfo.stageCount = vertex || fragment || moduleInfo ? 2 : 0;
+	pipelineInfo.pStages = stages;
+	vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, NULL, &pipeline);
+	return pipeline;
+}
+
+static uint32_t drawCalls(void)
+{
+	return mockCallCount("vkCmdDraw") + mockCallCount("vkCmdDrawIndexed") + mockCallCount("vkCmdDrawMultiEXT") + mockCallCount("vkCmdDrawMultiIndexedEXT");
+}
+
+static int isDraw(const MockCommand* command, MockCommandType type, uint32_t call, uint32_t count, uint32_t instanceCount, uint32_t first, int32_t vertexOffset,
+    uint32_t firstInstance)
+{
+	return command->type == type && command->call == call && command->count == count && command->instanceCount == instanceCount && command->first == first &&
+	    command->vertexOffset == vertexOffset && command->firstInstance == firstInstance;
+}
+
+/* Driver draw commands for BENCHMARK_DRAWS draws in runs of BENCHMARK_RUN, with a vertex buffer bound before each run */
+static uint32_t benchmark(VkPhysicalDevice physicalDevice, const VkDeviceCreateInfo* deviceInfo, const char* name)
+{
+	VkCommandPoolCreateInfo poolInfo = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+	VkCommandBufferAllocateInfo allocateInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+	VkCommandBufferBeginInfo beginInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+	VkBuffer vertexBuffer = HANDLE(VkBuffer, 0x1000);
+	VkDeviceSize offset = 0;
+	VkDevice device;
+	VkCommandPool commandPool;
+	VkCommandBuffer commandBuffer;
+	VkShaderModule module;
+	VkPipeline pipeline;
+	uint32_t calls, i;
+
+	if (vkCreateDevice(physicalDevice, deviceInfo, NULL, &device) != VK_SUCCESS || vkCreateCommandPool(device, &poolInfo, NULL, &commandPool) != VK_SUCCESS)
+		return 0;
+	allocateInfo.commandPool = commandPool;
+	allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocateInfo.commandBufferCount = 1;
+	if (vkAllocateCommandBuffers(device, &allocateInfo, &commandBuffer) != VK_SUCCESS)
+		return 0;
+	module = createShaderModule(device, positionCode, sizeof(positionCode));
+	pipeline = createPipeline(device, module, module, NULL);
+
+	mockResetCallCounts();
+	vkBeginCommandBuffer(commandBuffer, &beginInfo);
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+	for (i = 0; i < BENCHMARK_DRAWS; ++i)
+	{
+		if (i % BENCHMARK_RUN == 0)
+			vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer, &offset);
+		vkCmdDrawIndexed(commandBuffer, 36, 1, i * 36, 0, 0);
+	}
+	vkEndCommandBuffer(commandBuffer);
+	calls = drawCalls();
+
+	vkDestroyPipeline(device, pipeline, NULL);
+	vkDestroyShaderModule(device, module, NULL);
+	vkDestroyCommandPool(device, commandPool, NULL);
+	vkDestroyDevice(device, NULL);
+	printf("draw_batching: %d draws in runs of %d %s: %u driver draw calls\n", BENCHMARK_DRAWS, BENCHMARK_RUN, name, calls);
+	return calls;
+}
+
+int main(void)
+{
+	VkInstanceCreateInfo instanceInfo = { VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
+	VkPhysicalDeviceMultiDrawFeaturesEXT multiDrawFeatures = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTI_DRAW_FEATURES_EXT };
+	VkDeviceCreateInfo deviceInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+	VkDeviceCreateInfo multiDrawDeviceInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+	VkCommandPoolCreateInfo poolInfo = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+	VkCommandBufferAllocateInfo allocateInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+	VkCommandBufferBeginInfo beginInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+	VkShaderModuleCreateInfo inlineInfo = { VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO };
+	VkDebugUtilsLabelEXT label = { VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT };
+	const char* extensions[] = { VK_EXT_MULTI_DRAW_EXTENSION_NAME };
+	VkInstance instance;
+	VkPhysicalDevice physicalDevice;
+	VkDevice device;
+	VkCommandPool commandPool;
+	VkCommandBuffer commandBuffers[2];
+	VkShaderModule positionModule, drawIndexModule, memberDrawIndexModule;
+	VkPipeline pipeline, drawIndexPipeline, memberDrawIndexPipeline, inlinePipeline, libraryPipeline;
+	VilcDrawBatchingStats stats;
+	const MockCommand* commands;
+	uint32_t physicalDeviceCount = 1, unbatchedCalls, batchedCalls;
+	uint32_t i;
+
+	CHECK(vkCreateInstance(&instanceInfo, NULL, &instance) == VK_SUCCESS);
+	CHECK(vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, &physicalDevice) == VK_SUCCESS);
+	multiDrawFeatures.multiDraw = VK_TRUE;
+	multiDrawDeviceInfo.pNext = &multiDrawFeatures;
+	multiDrawDeviceInfo.enabledExtensionCount = 1;
+	multiDrawDeviceInfo.ppEnabledExtensionNames = extensions;
+
+	/* without VK_EXT_multi_draw every draw reaches the driver as it is recorded */
+	unbatchedCalls = benchmark(physicalDevice, &deviceInfo, "without VK_EXT_multi_draw");
+	CHECK(unbatchedCalls == BENCHMARK_DRAWS && mockCallCount("vkCmdDrawMultiIndexedEXT") == 0);
+	batchedCalls = benchmark(physicalDevice, &multiDrawDeviceInfo, "with VK_EXT_multi_draw");
+	CHECK(batchedCalls == BENCHMARK_DRAWS / BENCHMARK_RUN && mockCallCount("vkCmdDrawIndexed") == 0);
+
+	/* the extension without the feature does not batch either */
+	multiDrawFeatures.multiDraw = VK_FALSE;
+	CHECK(benchmark(physicalDevice, &multiDrawDeviceInfo, "without the multiDraw feature") == BENCHMARK_DRAWS);
+	multiDrawFeatures.multiDraw = VK_TRUE;
+
+	CHECK(vkCreateDevice(physicalDevice, &multiDrawDeviceInfo, NULL, &device) == VK_SUCCESS);
+	CHECK(vkCreateCommandPool(device, &poolInfo, NULL, &commandPool) == VK_SUCCESS);
+	allocateInfo.commandPool = commandPool;
+	allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocateInfo.commandBufferCount = 2;
+	CHECK(vkAllocateCommandBuffers(device, &allocateInfo, commandBuffers) == VK_SUCCESS);
+
+	positionModule = createShaderModule(device, positionCode, sizeof(positionCode));
+	drawIndexModule = createShaderModule(device, drawIndexCode, sizeof(drawIndexCode));
+	memberDrawIndexModule = createShaderModule(device, memberDrawIndexCode, sizeof(memberDrawIndexCode));
+	inlineInfo.codeSize = sizeof(positionCode);
+	inlineInfo.pCode = positionCode;
+	pipeline = createPipeline(device, positionModule, positionModule, NULL);
+	drawIndexPipeline = createPipeline(device, positionModule, drawIndexModule, NULL);
+	memberDrawIndexPipeline = createPipeline(device, memberDrawIndexModule, positionModule, NULL);
+	inlinePipeline = createPipeline(device, VK_NULL_HANDLE, VK_NULL_HANDLE, &inlineInfo);
+	libraryPipeline = createPipeline(device, VK_NULL_HANDLE, VK_NULL_HANDLE, NULL);
+
+	/* a run of draws is recorded as one multi draw before the next other command, with the draws in order */
+	mockResetCallCounts();
+	mockResetCommandLog();
+	CHECK(vkBeginCommandBuffer(commandBuffers[0], &beginInfo) == VK_SUCCESS);
+	vkCmdBindPipeline(commandBuffers[0], VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+	vkCmdDraw(commandBuffers[0], 3, 1, 0, 0);
+	vkCmdDraw(commandBuffers[0], 6, 1, 3, 0);
+	vkCmdDraw(commandBuffers[0], 9, 1, 9, 0);
+	CHECK(drawCalls() == 0);
+	vkCmdDispatch(commandBuffers[0], 7, 1, 1);
+	CHECK(mockCallCount("vkCmdDrawMultiEXT") == 1 && drawCalls() == 1 && mockCommandLog(&commands) == 4);
+	CHECK(isDraw(&commands[0], MOCK_COMMAND_DRAW, 0, 3, 1, 0, 0, 0));
+	CHECK(isDraw(&commands[1], MOCK_COMMAND_DRAW, 0, 6, 1, 3, 0, 0));
+	CHECK(isDraw(&commands[2], MOCK_COMMAND_DRAW, 0, 9, 1, 9, 0, 0));
+	CHECK(commands[3].type == MOCK_COMMAND_DISPATCH && commands[3].call == 7);
+
+	/* indexed draws keep their vertex offsets; other kinds or instance ranges start a new run, and a run of one draw
+	 * is recorded unchanged at vkEndCommandBuffer
+	 */
+	mockResetCallCounts();
+	mockResetCommandLog();
+	vkCmdDrawIndexed(commandBuffers[0], 12, 1, 0, -4, 0);
+	vkCmdDrawIndexed(commandBuffers[0], 24, 1, 12, 100, 0);
+	vkCmdDraw(commandBuffers[0], 3, 2, 0, 0);
+	vkCmdDraw(commandBuffers[0], 3, 2, 3, 0);
+	vkCmdDraw(commandBuffers[0], 3, 2, 6, 1);
+	CHECK(mockCallCount("vkCmdDrawMultiIndexedEXT") == 1 && mockCallCount("vkCmdDrawMultiEXT") == 1 && mockCallCount("vkCmdDraw") == 0);
+	CHECK(vkEndCommandBuffer(commandBuffers[0]) == VK_SUCCESS);
+	CHECK(mockCallCount("vkCmdDraw") == 1 && mockCommandLog(&commands) == 5);
+	CHECK(isDraw(&commands[0], MOCK_COMMAND_DRAW_INDEXED, 0, 12, 1, 0, -4, 0));
+	CHECK(isDraw(&commands[1], MOCK_COMMAND_DRAW_INDEXED, 0, 24, 1, 12, 100, 0));
+	CHECK(isDraw(&commands[2], MOCK_COMMAND_DRAW, 1, 3, 2, 0, 0, 0));
+	CHECK(isDraw(&commands[3], MOCK_COMMAND_DRAW, 1, 3, 2, 3, 0, 0));
+	CHECK(isDraw(&commands[4], MOCK_COMMAND_DRAW, 2, 3, 2, 6, 0, 1));
+
+	/* runs are split below maxMultiDrawCount */
+	mockResetCallCounts();
+	mockResetCommandLog();
+	CHECK(vkBeginCommandBuffer(commandBuffers[0], &beginInfo) == VK_SUCCESS);
+	vkCmdBindPipeline(commandBuffers[0], VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+	for (i = 0; i < LONG_RUN; ++i)
+		vkCmdDraw(commandBuffers[0], i + 1, 1, i, 0);
+	CHECK(vkEndCommandBuffer(commandBuffers[0]) == VK_SUCCESS);
+	CHECK(mockCallCount("vkCmdDrawMultiEXT") == (LONG_RUN + BATCH_SIZE - 1) / BATCH_SIZE && mockCommandLog(&commands) == LONG_RUN);
+	for (i = 0; i < LONG_RUN; ++i)
+		CHECK(isDraw(&commands[i], MOCK_COMMAND_DRAW, i / BATCH_SIZE, i + 1, 1, i, 0, 0));
+
+	/* pipelines that read DrawIndex, or whose code is not known, draw as recorded; chained code is known */
+	mockResetCallCounts();
+	CHECK(vkBeginCommandBuffer(commandBuffers[0], &beginInfo) == VK_SUCCESS);
+	vkCmdBindPipeline(commandBuffers[0], VK_PIPELINE_BIND_POINT_GRAPHICS, drawIndexPipeline);
+	vkCmdDraw(commandBuffers[0], 3, 1, 0, 0);
+	vkCmdDraw(commandBuffers[0], 3, 1, 3, 0);
+	CHECK(mockCallCount("vkCmdDraw") == 2);
+	vkCmdBindPipeline(commandBuffers[0], VK_PIPELINE_BIND_POINT_GRAPHICS, memberDrawIndexPipeline);
+	vkCmdDraw(commandBuffers[0], 3, 1, 0, 0);
+	vkCmdDraw(commandBuffers[0], 3, 1, 3, 0);
+	CHECK(mockCallCount("vkCmdDraw") == 4);
+	vkCmdBindPipeline(commandBuffers[0], VK_PIPELINE_BIND_POINT_GRAPHICS, libraryPipeline);
+	vkCmdDraw(commandBuffers[0], 3, 1, 0, 0);
+	vkCmdDraw(commandBuffers[0], 3, 1, 3, 0);
+	CHECK(mockCallCount("vkCmdDraw") == 6);
+	vkCmdBindPipeline(commandBuffers[0], VK_PIPELINE_BIND_POINT_GRAPHICS, inlinePipeline);
+	vkCmdDraw(commandBuffers[0], 3, 1, 0, 0);
+	vkCmdDraw(commandBuffers[0], 3, 1, 3, 0);
+	CHECK(mockCallCount("vkCmdDraw") == 6 && mockCallCount("vkCmdDrawMultiEXT") == 0);
+
+	/* binding another pipeline flushes the run before it, and so does a debug label */
+	vkCmdBindPipeline(commandBuffers[0], VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+	CHECK(mockCallCount("vkCmdDrawMultiEXT") == 1);
+	vkCmdDraw(commandBuffers[0], 3, 1, 0, 0);
+	vkCmdDraw(commandBuffers[0], 3, 1, 3, 0);
+	vkCmdBeginDebugUtilsLabelEXT(commandBuffers[0], &label);
+	CHECK(mockCallCount("vkCmdDrawMultiEXT") == 2);
+	vkCmdEndDebugUtilsLabelEXT(commandBuffers[0]);
+
+	/* the bound pipeline is not known after secondary command buffers execute */
+	vkCmdExecuteCommands(commandBuffers[0], 1, &commandBuffers[1]);
+	vkCmdDraw(commandBuffers[0], 3, 1, 0, 0);
+	vkCmdDraw(commandBuffers[0], 3, 1, 3, 0);
+	CHECK(mockCallCount("vkCmdDraw") == 8);
+
+	/* a recording that is begun again drops the draws of the previous one */
+	vkCmdBindPipeline(commandBuffers[0], VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+	vkCmdDraw(commandBuffers[0], 3, 1, 0, 0);
+	vkCmdDraw(commandBuffers[0], 3, 1, 3, 0);
+	CHECK(vkBeginCommandBuffer(commandBuffers[0], &beginInfo) == VK_SUCCESS);
+	CHECK(vkEndCommandBuffer(commandBuffers[0]) == VK_SUCCESS);
+	CHECK(mockCallCount("vkCmdDraw") == 8 && mockCallCount("vkCmdDrawMultiEXT") == 2);
+
+	/* the benchmarks batched their draws only once; the dropped draws above were never recorded */
+	vilcGetDrawBatchingStats(&stats);
+	CHECK(stats.drawCalls == 3 * BENCHMARK_DRAWS + 3 + 5 + LONG_RUN + 8 + 2 + 2 + 2);
+	CHECK(stats.batchedDraws == BENCHMARK_DRAWS + 3 + 2 + 2 + LONG_RUN + 2 + 2);
+	CHECK(stats.multiDrawCalls == BENCHMARK_DRAWS / BENCHMARK_RUN + 1 + 2 + (LONG_RUN + BATCH_SIZE - 1) / BATCH_SIZE + 2);
+
+	vkDestroyPipeline(device, pipeline, NULL);
+	vkDestroyPipeline(device, drawIndexPipeline, NULL);
+	vkDestroyPipeline(device, memberDrawIndexPipeline, NULL);
+	vkDestroyPipeline(device, inlinePipeline, NULL);
+	vkDestroyPipeline(device, libraryPipeline, NULL);
+	vkDestroyShaderModule(device, positionModule, NULL);
+	vkDestroyShaderModule(device, drawIndexModule, NULL);
+	vkDestroyShaderModule(device, memberDrawIndexModule, NULL);
+	vkDestroyCommandPool(device, commandPool, NULL);
+	vkDestroyDevice(device, NULL);
+	vkDestroyInstance(instance, NULL);
+
+	printf("draw_batching: passed\n");
+	return 0;
+}
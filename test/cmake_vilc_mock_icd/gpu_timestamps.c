@@ -0,0 +1,119 @@
+#include "mock_icd.h"
+#include "vilc.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static void recordFrame(VkCommandBuffer commandBuffer)
+{
+	VkCommandBufferBeginInfo beginInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+	VkDebugUtilsLabelEXT label = { VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT };
+	VkRenderPassBeginInfo renderPassBegin = { VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO };
+
+	label.pLabelName = "frame";
+
+	vkBeginCommandBuffer(commandBuffer, &beginInfo);
+	vkCmdBeginDebugUtilsLabelEXT(commandBuffer, &label);
+	vkCmdBeginRenderPass(commandBuffer, &renderPassBegin, VK_SUBPASS_CONTENTS_INLINE);
+	vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+	vkCmdEndRenderPass(commandBuffer);
+	vkCmdDispatch(commandBuffer, 1, 1, 1);
+	vkCmdEndDebugUtilsLabelEXT(commandBuffer);
+	vkEndCommandBuffer(commandBuffer);
+}
+
+/* Checks the timings of one recordFrame; timestamps are written in recording order, 1000 ticks apart */
+static int checkFrame(const VilcGpuTiming* timings, VkCommandBuffer commandBuffer)
+{
+	uint64_t base = timings[0].beginNs;
+
+	CHECK(timings[0].kind == VILC_GPU_TIMING_LABEL && strcmp(timings[0].label, "frame") == 0);
+	CHECK(timings[1].kind == VILC_GPU_TIMING_RENDER_PASS);
+	CHECK(timings[2].kind == VILC_GPU_TIMING_DISPATCH);
+	CHECK(timings[0].endNs - base == 5000);
+	CHECK(timings[1].beginNs - base == 1000 && timings[1].endNs - base == 2000);
+	CHECK(timings[2].beginNs - base == 3000 && timings[2].endNs - base == 4000);
+	CHECK(timings[0].commandBuffer == commandBuffer && timings[2].commandBuffer == commandBuffer);
+	CHECK(timings[0].calibrated && timings[1].calibrated && timings[2].calibrated);
+	/* the mock calibrates every resolve after the last timestamp write, at MOCK_CALIBRATION_OFFSET ahead of the GPU */
+	CHECK(base >= MOCK_CALIBRATION_OFFSET);
+
+	return 0;
+}
+
+int main(void)
+{
+	const char* deviceExtensions[] = { "VK_KHR_calibrated_timestamps", "VK_KHR_synchronization2" };
+	VkInstanceCreateInfo instanceInfo = { VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
+	VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR };
+	VkDeviceCreateInfo deviceInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+	VkCommandPoolCreateInfo poolInfo = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+	VkCommandBufferAllocateInfo allocateInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+	VkSubmitInfo submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
+	VkPresentInfoKHR presentInfo = { VK_STRUCTURE_TYPE_PRESENT_INFO_KHR };
+	VkInstance instance;
+	VkPhysicalDevice physicalDevice;
+	VkDevice device;
+	VkQueue queue;
+	VkCommandPool commandPool;
+	VkCommandBuffer commandBuffer;
+	VilcGpuTiming timings[8];
+	uint32_t physicalDeviceCount = 1;
+
+	CHECK(vkCreateInstance(&instanceInfo, NULL, &instance) == VK_SUCCESS);
+	CHECK(vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, &physicalDevice) == VK_SUCCESS);
+
+	synchronization2.synchronization2 = VK_TRUE;
+	deviceInfo.pNext = &synchronization2;
+	deviceInfo.enabledExtensionCount = 2;
+	deviceInfo.ppEnabledExtensionNames = deviceExtensions;
+	CHECK(vkCreateDevice(physicalDevice, &deviceInfo, NULL, &device) == VK_SUCCESS);
+	vkGetDeviceQueue(device, 0, 0, &queue);
+
+	CHECK(vkCreateCommandPool(device, &poolInfo, NULL, &commandPool) == VK_SUCCESS);
+	allocateInfo.commandPool = commandPool;
+	allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocateInfo.commandBufferCount = 1;
+	CHECK(vkAllocateCommandBuffers(device, &allocateInfo, &commandBuffer) == VK_SUCCESS);
+
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &commandBuffer;
+
+	/* results are read back at present once the internal fence of the submit is signaled */
+	recordFrame(commandBuffer);
+	CHECK(vilcGetGpuTimings(timings, 8) == 0);
+	CHECK(vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE) == VK_SUCCESS);
+	CHECK(vkQueuePresentKHR(queue, &presentInfo) == VK_SUCCESS);
+	CHECK(vilcGetGpuTimings(timings, 8) == 3);
+	CHECK(checkFrame(timings, commandBuffer) == 0);
+	CHECK(mockCallCount("vkCmdWriteTimestamp2") == 6 && mockCallCount("vkCmdWriteTimestamp") == 0);
+	CHECK(mockCallCount("vkCmdResetQueryPool") == 1);
+	CHECK(mockCallCount("vkQueueSubmit") == 2);
+
+	/* re-recording reuses the query chunk; an unsubmitted recording produces no timings */
+	recordFrame(commandBuffer);
+	recordFrame(commandBuffer);
+	CHECK(vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE) == VK_SUCCESS);
+	CHECK(vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE) == VK_SUCCESS);
+	CHECK(vilcGetGpuTimings(timings, 8) == 6);
+	CHECK(checkFrame(timings, commandBuffer) == 0);
+	CHECK(checkFrame(timings + 3, commandBuffer) == 0);
+	CHECK(mockCallCount("vkCmdResetQueryPool") == 3);
+
+	/* executions are resolved when the command buffer is freed, even before the internal fence is polled */
+	recordFrame(commandBuffer);
+	CHECK(vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE) == VK_SUCCESS);
+	vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+	CHECK(vilcGetGpuTimings(timings, 2) == 2);
+	CHECK(vilcGetGpuTimings(timings + 2, 8) == 1);
+	CHECK(checkFrame(timings, commandBuffer) == 0);
+
+	vkDestroyCommandPool(device, commandPool, NULL);
+	vkDestroyDevice(device, NULL);
+	CHECK(mockCallCount("vkCreateQueryPool") == 1 && mockCallCount("vkDestroyQueryPool") == 1);
+	CHECK(mockCallCount("vkCreateFence") == mockCallCount("vkDestroyFence"));
+	vkDestroyInstance(instance, NULL);
+
+	printf("gpu_timestamps: passed\n");
+	return 0;
+}
@@ -0,0 +1,112 @@
+#include "mock_icd.h"
+#include "vilc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct AppAllocator
+{
+	uint32_t allocations;
+	uint32_t frees;
+	size_t lastAlignment;
+} AppAllocator;
+
+static void* VKAPI_PTR appAllocation(void* pUserData, size_t size, size_t alignment, VkSystemAllocationScope scope)
+{
+	AppAllocator* app = (AppAllocator*)pUserData;
+	void* memory = NULL;
+	app->allocations++;
+	app->lastAlignment = alignment;
+	return posix_memalign(&memory, alignment, size) == 0 ? memory : NULL;
+}
+
+static void* VKAPI_PTR appReallocation(void* pUserData, void* pOriginal, size_t size, size_t alignment, VkSystemAllocationScope scope)
+{
+	return NULL;
+}
+
+static void VKAPI_PTR appFree(void* pUserData, void* pMemory)
+{
+	AppAllocator* app = (AppAllocator*)pUserData;
+	app->frees += pMemory ? 1 : 0;
+	free(pMemory);
+}
+
+static const VilcHostMemoryCounter* findObjectType(const VilcHostMemoryStats* stats, VkObjectType objectType)
+{
+	uint32_t i;
+	for (i = 0; i < stats->objectTypeCount; ++i)
+		if (stats->objectTypes[i].objectType == objectType)
+			return &stats->objectTypes[i].counter;
+	return NULL;
+}
+
+int main(void)
+{
+	VkInstanceCreateInfo instanceInfo = { VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
+	VkDeviceCreateInfo deviceInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+	VkFenceCreateInfo fenceInfo = { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+	VkAllocationCallbacks callbacks;
+	AppAllocator app;
+	VkInstance instance;
+	VkPhysicalDevice physicalDevice;
+	VkDevice device;
+	VkFence fence, appFence;
+	VilcHostMemoryStats stats;
+	const VilcHostMemoryCounter* counter;
+	uint32_t physicalDeviceCount = 1;
+
+	memset(&app, 0, sizeof(app));
+	memset(&callbacks, 0, sizeof(callbacks));
+	callbacks.pUserData = &app;
+	callbacks.pfnAllocation = appAllocation;
+	callbacks.pfnReallocation = appReallocation;
+	callbacks.pfnFree = appFree;
+
+	CHECK(vkCreateInstance(&instanceInfo, NULL, &instance) == VK_SUCCESS);
+	CHECK(vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, &physicalDevice) == VK_SUCCESS);
+
+	/* pAllocator == NULL still reaches the driver as callbacks; the mock grows its device state once */
+	CHECK(vkCreateDevice(physicalDevice, &deviceInfo, NULL, &device) == VK_SUCCESS);
+	vilcGetHostMemoryStats(&stats);
+	CHECK(stats.total.bytes == MOCK_DEVICE_STATE_SIZE && stats.total.allocationCount == 1);
+	CHECK(stats.total.peakBytes == MOCK_DEVICE_STATE_SIZE && stats.total.totalAllocationCount == 2);
+	CHECK(stats.scopes[VK_SYSTEM_ALLOCATION_SCOPE_DEVICE].bytes == MOCK_DEVICE_STATE_SIZE);
+	CHECK(stats.internalScopes[VK_SYSTEM_ALLOCATION_SCOPE_DEVICE].bytes == MOCK_INTERNAL_ALLOCATION_SIZE);
+	counter = findObjectType(&stats, VK_OBJECT_TYPE_DEVICE);
+	CHECK(counter && counter->bytes == MOCK_DEVICE_STATE_SIZE);
+
+	/* blocks keep the alignment the driver asked for */
+	CHECK(vkCreateFence(device, &fenceInfo, NULL, &fence) == VK_SUCCESS);
+	CHECK((uintptr_t)fence % MOCK_ALLOCATION_ALIGNMENT == 0);
+	vilcGetHostMemoryStats(&stats);
+	CHECK(stats.scopes[VK_SYSTEM_ALLOCATION_SCOPE_OBJECT].allocationCount == 1);
+	counter = findObjectType(&stats, VK_OBJECT_TYPE_FENCE);
+	CHECK(counter && counter->allocationCount == 1 && counter->bytes > 0);
+
+	/* application callbacks are wrapped, not replaced */
+	CHECK(vkCreateFence(device, &fenceInfo, &callbacks, &appFence) == VK_SUCCESS);
+	CHECK((uintptr_t)appFence % MOCK_ALLOCATION_ALIGNMENT == 0);
+	CHECK(app.allocations == 1 && app.lastAlignment >= MOCK_ALLOCATION_ALIGNMENT);
+	vilcGetHostMemoryStats(&stats);
+	counter = findObjectType(&stats, VK_OBJECT_TYPE_FENCE);
+	CHECK(counter && counter->allocationCount == 2);
+
+	vkDestroyFence(device, appFence, &callbacks);
+	CHECK(app.frees == 1);
+	vkDestroyFence(device, fence, NULL);
+	vilcGetHostMemoryStats(&stats);
+	counter = findObjectType(&stats, VK_OBJECT_TYPE_FENCE);
+	CHECK(counter && counter->bytes == 0 && counter->allocationCount == 0 && counter->totalAllocationCount == 2);
+
+	vkDestroyDevice(device, NULL);
+	vilcGetHostMemoryStats(&stats);
+	CHECK(stats.total.bytes == 0 && stats.total.allocationCount == 0);
+	CHECK(stats.internalScopes[VK_SYSTEM_ALLOCATION_SCOPE_DEVICE].bytes == 0);
+	CHECK(findObjectType(&stats, VK_OBJECT_TYPE_INSTANCE) != NULL);
+	vkDestroyInstance(instance, NULL);
+
+	printf("host_memory_stats: passed\n");
+	return 0;
+}
@@ -0,0 +1,388 @@
+#include "mock_icd.h"
+#include "vilc.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define MIP_LEVELS 4
+#define ARRAY_LAYERS 8
+#define RANDOM_SUBMITS 256
+#define RANDOM_BARRIERS 16
+
+static const VkImageLayout layouts[] = { VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+	VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+
+/* aspect (depth, stencil), mip level, array layer */
+static VkImageLayout model[2][MIP_LEVELS][ARRAY_LAYERS];
+static int touched[2][MIP_LEVELS][ARRAY_LAYERS];
+
+static uint32_t seed = 12345;
+
+static uint32_t randomNumber(uint32_t range)
+{
+	seed = seed * 1664525u + 1013904223u;
+	return (seed >> 8) % range;
+}
+
+static VkImageMemoryBarrier imageBarrier(VkImage image, VkImageAspectFlags aspectMask, VkImageLayout oldLayout, VkImageLayout newLayout)
+{
+	VkImageMemoryBarrier barrier = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+
+	barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	barrier.oldLayout = oldLayout;
+	barrier.newLayout = newLayout;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = image;
+	barrier.subresourceRange.aspectMask = aspectMask;
+	barrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+	barrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+	return barrier;
+}
+
+static uint32_t imageBarrierCount(void)
+{
+	const MockCommand* commands;
+	uint32_t count = mockCommandLog(&commands), images = 0, i;
+
+	for (i = 0; i < count; ++i)
+		images += commands[i].type == MOCK_COMMAND_IMAGE_BARRIER;
+	return images;
+}
+
+static int checkLayout(VkImage image, VkImageAspectFlags aspectMask, uint32_t mipLevel, uint32_t arrayLayer, VkImageLayout layout)
+{
+	VkImageSubresource subresource;
+
+	subresource.aspectMask = aspectMask;
+	subresource.mipLevel = mipLevel;
+	subresource.arrayLayer = arrayLayer;
+	return vilcGetImageLayout(image, &subresource) == layout;
+}
+
+static void submit(VkQueue queue, VkCommandBuffer commandBuffer)
+{
+	VkSubmitInfo submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
+
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &commandBuffer;
+	vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
+}
+
+/* Random transitions of random depth/stencil subresource ranges, checked against a layout per subresource after every
+ * submit; barriers that do not change the layout must be dropped exactly when their oldLayout agrees with the command
+ * buffer
+ */
+static int checkRandomRanges(VkDevice device, VkQueue queue, VkCommandBuffer commandBuffer)
+{
+	static const VkImageAspectFlags aspectMasks[] = { VK_IMAGE_ASPECT_DEPTH_BIT, VK_IMAGE_ASPECT_STENCIL_BIT, VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT };
+	VkImageCreateInfo imageInfo = { VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+	VkCommandBufferBeginInfo beginInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+	VilcImageLayoutTrackingStats before, after;
+	VkImage image;
+	uint32_t submitIndex, barrierIndex, aspect, level, layer;
+
+	imageInfo.extent.width = imageInfo.extent.height = imageInfo.extent.depth = 1;
+	imageInfo.mipLevels = MIP_LEVELS;
+	imageInfo.arrayLayers = ARRAY_LAYERS;
+	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	CHECK(vkCreateImage(device, &imageInfo, NULL, &image) == VK_SUCCESS);
+	memset(model, 0, sizeof(model));
+
+	for (submitIndex = 0; submitIndex < RANDOM_SUBMITS; ++submitIndex)
+	{
+		memset(touched, 0, sizeof(touched));
+		CHECK(vkBeginCommandBuffer(commandBuffer, &beginInfo) == VK_SUCCESS);
+
+		for (barrierIndex = 0; barrierIndex < RANDOM_BARRIERS; ++barrierIndex)
+		{
+			VkImageMemoryBarrier barrier = imageBarrier(image, aspectMasks[randomNumber(3)], VK_IMAGE_LAYOUT_UNDEFINED, layouts[randomNumber(5)]);
+			VkImageSubresourceRange* range = &barrier.subresourceRange;
+			uint32_t levelCount, layerCount;
+			int agrees = 1, expectDropped;
+
+			range->baseMipLevel = randomNumber(MIP_LEVELS);
+			range->baseArrayLayer = randomNumber(ARRAY_LAYERS);
+			range->levelCount = randomNumber(4) == 0 ? VK_REMAINING_MIP_LEVELS : 1 + randomNumber(MIP_LEVELS - range->baseMipLevel);
+			range->layerCount = randomNumber(4) == 0 ? VK_REMAINING_ARRAY_LAYERS : 1 + randomNumber(ARRAY_LAYERS - range->baseArrayLayer);
+			levelCount = range->levelCount == VK_REMAINING_MIP_LEVELS ? MIP_LEVELS - range->baseMipLevel : range->levelCount;
+			layerCount = range->layerCount == VK_REMAINING_ARRAY_LAYERS ? ARRAY_LAYERS - range->baseArrayLayer : range->layerCount;
+
+			/* a third of the barriers keep the layout, claiming either the layout of the first subresource or a random one */
+			if (randomNumber(3) == 0)
+			{
+				aspect = (range->aspectMask & VK_IMAGE_ASPECT_DEPTH_BIT) ? 0 : 1;
+				barrier.oldLayout = barrier.newLayout = randomNumber(2) ? model[aspect][range->baseMipLevel][range->baseArrayLayer] : layouts[randomNumber(5)];
+				if (barrier.oldLayout == VK_IMAGE_LAYOUT_UNDEFINED)
+					barrier.oldLayout = barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+			}
+			else if (randomNumber(2))
+			{
+				barrier.oldLayout = layouts[randomNumber(5)];
+			}
+
+			for (aspect = 0; aspect < 2; ++aspect)
+				for (level = range->baseMipLevel; level < range->baseMipLevel + levelCount; ++level)
+					for (layer = range->baseArrayLayer; layer < range->baseArrayLayer + layerCount; ++layer)
+						if (range->aspectMask & (VK_IMAGE_ASPECT_DEPTH_BIT << aspect))
+							if (touched[aspect][level][layer] && model[aspect][level][layer] != barrier.oldLayout)
+								agrees = 0;
+			expectDropped = barrier.oldLayout == barrier.newLayout && agrees;
+
+			vilcGetImageLayoutTrackingStats(&before);
+			mockResetCommandLog();
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, NULL, 0, NULL, 1, &barrier);
+			vilcGetImageLayoutTrackingStats(&after);
+			CHECK(imageBarrierCount() == (expectDropped ? 0u : 1u));
+			CHECK(after.droppedImageBarriers - before.droppedImageBarriers == (expectDropped ? 1u : 0u));
+			CHECK(after.mismatchedImageBarriers - before.mismatchedImageBarriers == (barrier.oldLayout != VK_IMAGE_LAYOUT_UNDEFINED && !agrees ? 1u : 0u));
+
+			for (aspect = 0; aspect < 2; ++aspect)
+				for (level = range->baseMipLevel; level < range->baseMipLevel + levelCount; ++level)
+					for (layer = range->baseArrayLayer; layer < range->baseArrayLayer + layerCount; ++layer)
+						if (range->aspectMask & (VK_IMAGE_ASPECT_DEPTH_BIT << aspect))
+						{
+							model[aspect][level][layer] = barrier.newLayout;
+							touched[aspect][level][layer] = 1;
+						}
+		}
+
+		CHECK(vkEndCommandBuffer(commandBuffer) == VK_SUCCESS);
+		submit(queue, commandBuffer);
+
+		for (aspect = 0; aspect < 2; ++aspect)
+			for (level = 0; level < MIP_LEVELS; ++level)
+				for (layer = 0; layer < ARRAY_LAYERS; ++layer)
+					CHECK(checkLayout(image, VK_IMAGE_ASPECT_DEPTH_BIT << aspect, level, layer, model[aspect][level][layer]));
+	}
+
+	vkDestroyImage(device, image, NULL);
+	CHECK(checkLayout(image, VK_IMAGE_ASPECT_DEPTH_BIT, 0, 0, VK_IMAGE_LAYOUT_MAX_ENUM));
+	return 0;
+}
+
+int main(void)
+{
+	VkInstanceCreateInfo instanceInfo = { VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
+	VkPhysicalDeviceVulkan13Features features13 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES };
+	VkDeviceCreateInfo deviceInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+	VkCommandPoolCreateInfo poolInfo = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+	VkCommandBufferAllocateInfo allocateInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+	VkCommandBufferBeginInfo beginInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+	VkImageCreateInfo imageInfo = { VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+	VkImageViewCreateInfo viewInfo = { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+	VkAttachmentDescription attachment;
+	VkRenderPassCreateInfo renderPassInfo = { VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO };
+	VkFramebufferCreateInfo framebufferInfo = { VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO };
+	VkRenderPassBeginInfo renderPassBegin = { VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO };
+	VkImageMemoryBarrier2 imageBarriers2[3];
+	VkDependencyInfo dependencyInfo = { VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+	VkHostImageLayoutTransitionInfo transitions[2];
+	VkImageMemoryBarrier barrier;
+	VkInstance instance;
+	VkPhysicalDevice physicalDevice;
+	VkDevice device;
+	VkQueue queue;
+	VkCommandPool commandPool;
+	VkCommandBuffer commandBuffer, secondary;
+	VkImage image;
+	VkImageView view;
+	VkRenderPass renderPass;
+	VkFramebuffer framebuffer;
+	VilcImageLayoutTrackingStats stats;
+	const MockCommand* commands;
+	uint32_t physicalDeviceCount = 1;
+	uint32_t i;
+
+	CHECK(vkCreateInstance(&instanceInfo, NULL, &instance) == VK_SUCCESS);
+	CHECK(vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, &physicalDevice) == VK_SUCCESS);
+	features13.synchronization2 = VK_TRUE;
+	deviceInfo.pNext = &features13;
+	CHECK(vkCreateDevice(physicalDevice, &deviceInfo, NULL, &device) == VK_SUCCESS);
+	vkGetDeviceQueue(device, 0, 0, &queue);
+
+	CHECK(vkCreateCommandPool(device, &poolInfo, NULL, &commandPool) == VK_SUCCESS);
+	allocateInfo.commandPool = commandPool;
+	allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocateInfo.commandBufferCount = 1;
+	CHECK(vkAllocateCommandBuffers(device, &allocateInfo, &commandBuffer) == VK_SUCCESS);
+	allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+	CHECK(vkAllocateCommandBuffers(device, &allocateInfo, &secondary) == VK_SUCCESS);
+
+	imageInfo.extent.width = imageInfo.extent.height = imageInfo.extent.depth = 1;
+	imageInfo.mipLevels = MIP_LEVELS;
+	imageInfo.arrayLayers = ARRAY_LAYERS;
+	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	CHECK(vkCreateImage(device, &imageInfo, NULL, &image) == VK_SUCCESS);
+	CHECK(checkLayout(image, VK_IMAGE_ASPECT_COLOR_BIT, 3, 7, VK_IMAGE_LAYOUT_UNDEFINED));
+
+	/* a barrier that keeps the layout is recorded as a memory barrier with its access masks */
+	mockResetCommandLog();
+	CHECK(vkBeginCommandBuffer(commandBuffer, &beginInfo) == VK_SUCCESS);
+	barrier = imageBarrier(image, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, NULL, 0, NULL, 1, &barrier);
+	barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, NULL, 0, NULL, 1, &barrier);
+	CHECK(mockCallCount("vkCmdPipelineBarrier") == 2 && mockCommandLog(&commands) == 2);
+	CHECK(commands[0].type == MOCK_COMMAND_IMAGE_BARRIER && commands[0].newLayout == VK_IMAGE_LAYOUT_GENERAL);
+	CHECK(commands[1].type == MOCK_COMMAND_MEMORY_BARRIER && commands[1].srcAccessMask == VK_ACCESS_SHADER_WRITE_BIT &&
+	    commands[1].dstAccessMask == VK_ACCESS_SHADER_READ_BIT && commands[1].srcStageMask == VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+	/* ones that contradict the layout known in the command buffer, or transfer ownership, are recorded unchanged */
+	mockResetCommandLog();
+	barrier.oldLayout = barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.subresourceRange.baseMipLevel = 1;
+	barrier.subresourceRange.levelCount = 1;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, NULL, 0, NULL, 1, &barrier);
+	barrier.srcQueueFamilyIndex = 0;
+	barrier.dstQueueFamilyIndex = 1;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, NULL, 0, NULL, 1, &barrier);
+	CHECK(imageBarrierCount() == 2);
+
+	/* with synchronization2 each set of masks becomes one memory barrier */
+	mockResetCommandLog();
+	memset(imageBarriers2, 0, sizeof(imageBarriers2));
+	for (i = 0; i < 3; ++i)
+	{
+		imageBarriers2[i].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+		imageBarriers2[i].srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+		imageBarriers2[i].srcAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT;
+		imageBarriers2[i].dstStageMask = i == 2 ? VK_PIPELINE_STAGE_2_TRANSFER_BIT : VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+		imageBarriers2[i].dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT;
+		imageBarriers2[i].oldLayout = imageBarriers2[i].newLayout = VK_IMAGE_LAYOUT_GENERAL;
+		imageBarriers2[i].srcQueueFamilyIndex = imageBarriers2[i].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		imageBarriers2[i].image = image;
+		imageBarriers2[i].subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		imageBarriers2[i].subresourceRange.baseMipLevel = 2 + (i & 1);
+		imageBarriers2[i].subresourceRange.levelCount = 1;
+		imageBarriers2[i].subresourceRange.layerCount = 4;
+	}
+	dependencyInfo.imageMemoryBarrierCount = 3;
+	dependencyInfo.pImageMemoryBarriers = imageBarriers2;
+	vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+	CHECK(mockCommandLog(&commands) == 2);
+	CHECK(commands[0].type == MOCK_COMMAND_MEMORY_BARRIER && commands[0].dstStageMask == VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT);
+	CHECK(commands[1].type == MOCK_COMMAND_MEMORY_BARRIER && commands[1].dstStageMask == VK_PIPELINE_STAGE_2_TRANSFER_BIT);
+	CHECK(vkEndCommandBuffer(commandBuffer) == VK_SUCCESS);
+
+	/* layouts apply to the image when the command buffer is submitted */
+	CHECK(checkLayout(image, VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, VK_IMAGE_LAYOUT_UNDEFINED));
+	submit(queue, commandBuffer);
+	CHECK(checkLayout(image, VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, VK_IMAGE_LAYOUT_GENERAL));
+	CHECK(checkLayout(image, VK_IMAGE_ASPECT_COLOR_BIT, 1, 5, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL));
+	CHECK(checkLayout(image, VK_IMAGE_ASPECT_COLOR_BIT, 3, 7, VK_IMAGE_LAYOUT_GENERAL));
+	CHECK(checkLayout(image, VK_IMAGE_ASPECT_DEPTH_BIT, 0, 0, VK_IMAGE_LAYOUT_UNDEFINED));
+
+	/* render passes leave their attachments in the final layouts */
+	viewInfo.image = image;
+	viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	viewInfo.subresourceRange.levelCount = 1;
+	viewInfo.subresourceRange.baseArrayLayer = 2;
+	viewInfo.subresourceRange.layerCount = 2;
+	CHECK(vkCreateImageView(device, &viewInfo, NULL, &view) == VK_SUCCESS);
+	memset(&attachment, 0, sizeof(attachment));
+	attachment.initialLayout = VK_IMAGE_LAYOUT_GENERAL;
+	attachment.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	renderPassInfo.attachmentCount = 1;
+	renderPassInfo.pAttachments = &attachment;
+	CHECK(vkCreateRenderPass(device, &renderPassInfo, NULL, &renderPass) == VK_SUCCESS);
+	framebufferInfo.renderPass = renderPass;
+	framebufferInfo.attachmentCount = 1;
+	framebufferInfo.pAttachments = &view;
+	CHECK(vkCreateFramebuffer(device, &framebufferInfo, NULL, &framebuffer) == VK_SUCCESS);
+
+	mockResetCommandLog();
+	CHECK(vkBeginCommandBuffer(commandBuffer, &beginInfo) == VK_SUCCESS);
+	renderPassBegin.renderPass = renderPass;
+	renderPassBegin.framebuffer = framebuffer;
+	vkCmdBeginRenderPass(commandBuffer, &renderPassBegin, VK_SUBPASS_CONTENTS_INLINE);
+	barrier = imageBarrier(image, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL);
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_DEPENDENCY_BY_REGION_BIT, 0, NULL, 0, NULL, 1, &barrier);
+	vkCmdEndRenderPass(commandBuffer);
+	CHECK(imageBarrierCount() == 1);
+	/* the final layout is known afterwards */
+	mockResetCommandLog();
+	barrier.oldLayout = barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.baseArrayLayer = 2;
+	barrier.subresourceRange.layerCount = 2;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, NULL, 0, NULL, 1, &barrier);
+	barrier.oldLayout = barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+	barrier.subresourceRange.baseArrayLayer = 3;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, NULL, 0, NULL, 1, &barrier);
+	CHECK(imageBarrierCount() == 1);
+	CHECK(vkEndCommandBuffer(commandBuffer) == VK_SUCCESS);
+	submit(queue, commandBuffer);
+	CHECK(checkLayout(image, VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, VK_IMAGE_LAYOUT_GENERAL));
+	CHECK(checkLayout(image, VK_IMAGE_ASPECT_COLOR_BIT, 0, 2, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
+	CHECK(checkLayout(image, VK_IMAGE_ASPECT_COLOR_BIT, 0, 3, VK_IMAGE_LAYOUT_GENERAL));
+	CHECK(checkLayout(image, VK_IMAGE_ASPECT_COLOR_BIT, 1, 2, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL));
+
+	/* secondary command buffers apply where they are executed */
+	CHECK(vkBeginCommandBuffer(secondary, &beginInfo) == VK_SUCCESS);
+	barrier = imageBarrier(image, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+	vkCmdPipelineBarrier(secondary, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, 1, &barrier);
+	CHECK(vkEndCommandBuffer(secondary) == VK_SUCCESS);
+	mockResetCommandLog();
+	CHECK(vkBeginCommandBuffer(commandBuffer, &beginInfo) == VK_SUCCESS);
+	barrier.oldLayout = barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, 1, &barrier);
+	vkCmdExecuteCommands(commandBuffer, 1, &secondary);
+	barrier.oldLayout = barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, 1, &barrier);
+	barrier.oldLayout = barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, 1, &barrier);
+	CHECK(imageBarrierCount() == 1);
+	CHECK(vkEndCommandBuffer(commandBuffer) == VK_SUCCESS);
+	submit(queue, commandBuffer);
+	CHECK(checkLayout(image, VK_IMAGE_ASPECT_COLOR_BIT, 2, 6, VK_IMAGE_LAYOUT_GENERAL));
+
+	/* render passes that are not tracked make all layouts unknown */
+	CHECK(vkBeginCommandBuffer(commandBuffer, &beginInfo) == VK_SUCCESS);
+	renderPassBegin.renderPass = (VkRenderPass)(uintptr_t)0x5000;
+	vkCmdBeginRenderPass(commandBuffer, &renderPassBegin, VK_SUBPASS_CONTENTS_INLINE);
+	vkCmdEndRenderPass(commandBuffer);
+	CHECK(vkEndCommandBuffer(commandBuffer) == VK_SUCCESS);
+	submit(queue, commandBuffer);
+	CHECK(checkLayout(image, VK_IMAGE_ASPECT_COLOR_BIT, 2, 6, VK_IMAGE_LAYOUT_MAX_ENUM));
+
+	/* host transitions apply directly, and the ones that keep the layout do not reach the driver */
+	memset(transitions, 0, sizeof(transitions));
+	for (i = 0; i < 2; ++i)
+	{
+		transitions[i].sType = VK_STRUCTURE_TYPE_HOST_IMAGE_LAYOUT_TRANSITION_INFO;
+		transitions[i].image = image;
+		transitions[i].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		transitions[i].newLayout = VK_IMAGE_LAYOUT_GENERAL;
+		transitions[i].subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		transitions[i].subresourceRange.baseMipLevel = i;
+		transitions[i].subresourceRange.levelCount = 1;
+		transitions[i].subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+	}
+	mockResetCallCounts();
+	CHECK(vkTransitionImageLayout(device, 2, transitions) == VK_SUCCESS);
+	CHECK(mockCallCount("vkTransitionImageLayout") == 1);
+	CHECK(checkLayout(image, VK_IMAGE_ASPECT_COLOR_BIT, 1, 7, VK_IMAGE_LAYOUT_GENERAL));
+	CHECK(checkLayout(image, VK_IMAGE_ASPECT_COLOR_BIT, 2, 0, VK_IMAGE_LAYOUT_MAX_ENUM));
+	transitions[0].oldLayout = transitions[1].oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+	CHECK(vkTransitionImageLayout(device, 2, transitions) == VK_SUCCESS);
+	CHECK(mockCallCount("vkTransitionImageLayout") == 1);
+
+	vilcGetImageLayoutTrackingStats(&stats);
+	CHECK(stats.imageBarriers == 13 && stats.droppedImageBarriers == 7 && stats.mismatchedImageBarriers == 3);
+	CHECK(stats.hostTransitions == 4 && stats.droppedHostTransitions == 2);
+
+	CHECK(checkRandomRanges(device, queue, commandBuffer) == 0);
+
+	vkDestroyFramebuffer(device, framebuffer, NULL);
+	vkDestroyRenderPass(device, renderPass, NULL);
+	vkDestroyImageView(device, view, NULL);
+	vkDestroyImage(device, image, NULL);
+	vkDestroyCommandPool(device, commandPool, NULL);
+	vkDestroyDevice(device, NULL);
+	vkDestroyInstance(instance, NULL);
+
+	printf("image_layout_tracking: passed\n");
+	return 0;
+}
@@ -0,0 +1,120 @@
+#include "mock_icd.h"
+#include "vilc.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define MATERIAL_COUNT 10
+
+static VkSampler immutableSamplers[2] = { (VkSampler)(uintptr_t)0x1000, (VkSampler)(uintptr_t)0x2000 };
+
+/* uniform buffer at binding 0 and an immutable sampler at binding 1, listed in either order */
+static VkResult createSetLayout(VkDevice device, int reversed, uint32_t sampler, const void* pNext, VkDescriptorSetLayout* pSetLayout)
+{
+	VkDescriptorSetLayoutCreateInfo createInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+	VkDescriptorSetLayoutBinding bindings[2];
+
+	memset(bindings, 0, sizeof(bindings));
+	bindings[reversed].binding = 0;
+	bindings[reversed].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	bindings[reversed].descriptorCount = 1;
+	bindings[reversed].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	/* ignored for uniform buffers */
+	bindings[reversed].pImmutableSamplers = reversed ? &immutableSamplers[1] : NULL;
+	bindings[!reversed].binding = 1;
+	bindings[!reversed].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	bindings[!reversed].descriptorCount = 1;
+	bindings[!reversed].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+	bindings[!reversed].pImmutableSamplers = &immutableSamplers[sampler];
+
+	createInfo.pNext = pNext;
+	createInfo.bindingCount = 2;
+	createInfo.pBindings = bindings;
+	return vkCreateDescriptorSetLayout(device, &createInfo, NULL, pSetLayout);
+}
+
+static VkResult createPipelineLayout(VkDevice device, VkDescriptorSetLayout setLayout, VkPipelineLayout* pPipelineLayout)
+{
+	VkPipelineLayoutCreateInfo createInfo = { VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
+	VkPushConstantRange range = { VK_SHADER_STAGE_VERTEX_BIT, 0, 64 };
+
+	createInfo.setLayoutCount = 1;
+	createInfo.pSetLayouts = &setLayout;
+	createInfo.pushConstantRangeCount = 1;
+	createInfo.pPushConstantRanges = &range;
+	return vkCreatePipelineLayout(device, &createInfo, NULL, pPipelineLayout);
+}
+
+int main(void)
+{
+	VkInstanceCreateInfo instanceInfo = { VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
+	VkDeviceCreateInfo deviceInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+	VkDescriptorSetLayoutBindingFlagsCreateInfo flagsInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO };
+	VkBaseInStructure unknownInfo = { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO };
+	VkDescriptorBindingFlags bindingFlags[2] = { 0, 0 };
+	VkInstance instance;
+	VkPhysicalDevice physicalDevice;
+	VkDevice device;
+	VkDescriptorSetLayout setLayouts[MATERIAL_COUNT], otherSampler, zeroFlags, unknown;
+	VkPipelineLayout pipelineLayouts[MATERIAL_COUNT], unknownPipelineLayout;
+	VilcLayoutCacheStats stats;
+	uint32_t physicalDeviceCount = 1;
+	uint32_t i;
+
+	CHECK(vkCreateInstance(&instanceInfo, NULL, &instance) == VK_SUCCESS);
+	CHECK(vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, &physicalDevice) == VK_SUCCESS);
+	CHECK(vkCreateDevice(physicalDevice, &deviceInfo, NULL, &device) == VK_SUCCESS);
+
+	/* every material creates its own layouts; binding order and ignored immutable samplers do not matter */
+	for (i = 0; i < MATERIAL_COUNT; ++i)
+	{
+		CHECK(createSetLayout(device, i % 2, 0, NULL, &setLayouts[i]) == VK_SUCCESS);
+		CHECK(createPipelineLayout(device, setLayouts[i], &pipelineLayouts[i]) == VK_SUCCESS);
+		CHECK(setLayouts[i] == setLayouts[0] && pipelineLayouts[i] == pipelineLayouts[0]);
+	}
+	CHECK(mockCallCount("vkCreateDescriptorSetLayout") == 1 && mockCallCount("vkCreatePipelineLayout") == 1);
+
+	/* immutable samplers are compared by handle; all-zero binding flags are the same as none */
+	CHECK(createSetLayout(device, 0, 1, NULL, &otherSampler) == VK_SUCCESS);
+	CHECK(otherSampler != setLayouts[0]);
+	flagsInfo.bindingCount = 2;
+	flagsInfo.pBindingFlags = bindingFlags;
+	CHECK(createSetLayout(device, 1, 0, &flagsInfo, &zeroFlags) == VK_SUCCESS);
+	CHECK(zeroFlags == setLayouts[0] && mockCallCount("vkCreateDescriptorSetLayout") == 2);
+
+	/* unknown structures pass through, and so do pipeline layouts using such set layouts */
+	CHECK(createSetLayout(device, 0, 0, &unknownInfo, &unknown) == VK_SUCCESS);
+	CHECK(unknown != setLayouts[0]);
+	CHECK(createPipelineLayout(device, unknown, &unknownPipelineLayout) == VK_SUCCESS);
+	CHECK(unknownPipelineLayout != pipelineLayouts[0] && mockCallCount("vkCreatePipelineLayout") == 2);
+	vkDestroyPipelineLayout(device, unknownPipelineLayout, NULL);
+	vkDestroyDescriptorSetLayout(device, unknown, NULL);
+	CHECK(mockCallCount("vkDestroyPipelineLayout") == 1 && mockCallCount("vkDestroyDescriptorSetLayout") == 1);
+
+	vilcGetLayoutCacheStats(&stats);
+	CHECK(stats.setLayouts.misses == 2 && stats.setLayouts.hits == MATERIAL_COUNT && stats.setLayouts.uncached == 1);
+	CHECK(stats.pipelineLayouts.misses == 1 && stats.pipelineLayouts.hits == MATERIAL_COUNT - 1 && stats.pipelineLayouts.uncached == 1);
+	CHECK(stats.setLayouts.layouts == 2 && stats.pipelineLayouts.layouts == 1);
+
+	/* set layouts may be destroyed before the pipeline layouts made from them; the cache keeps them alive */
+	for (i = 0; i < MATERIAL_COUNT; ++i)
+		vkDestroyDescriptorSetLayout(device, setLayouts[i], NULL);
+	vkDestroyDescriptorSetLayout(device, zeroFlags, NULL);
+	vkDestroyDescriptorSetLayout(device, otherSampler, NULL);
+	CHECK(mockCallCount("vkDestroyDescriptorSetLayout") == 2);
+
+	for (i = 0; i < MATERIAL_COUNT - 1; ++i)
+		vkDestroyPipelineLayout(device, pipelineLayouts[i], NULL);
+	CHECK(mockCallCount("vkDestroyPipelineLayout") == 1);
+	vkDestroyPipelineLayout(device, pipelineLayouts[MATERIAL_COUNT - 1], NULL);
+	CHECK(mockCallCount("vkDestroyPipelineLayout") == 2 && mockCallCount("vkDestroyDescriptorSetLayout") == 3);
+
+	vilcGetLayoutCacheStats(&stats);
+	CHECK(stats.setLayouts.layouts == 0 && stats.pipelineLayouts.layouts == 0);
+
+	vkDestroyDevice(device, NULL);
+	vkDestroyInstance(instance, NULL);
+
+	printf("layout_cache: passed\n");
+	return 0;
+}
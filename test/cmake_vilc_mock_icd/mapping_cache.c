@@ -0,0 +1,194 @@
+#include "mock_icd.h"
+#include "vilc.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define MEMORY_SIZE 4096
+
+static VkMappedMemoryRange rangeOf(VkDeviceMemory memory, VkDeviceSize offset, VkDeviceSize size)
+{
+	VkMappedMemoryRange range = { VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE };
+	range.memory = memory;
+	range.offset = offset;
+	range.size = size;
+	return range;
+}
+
+int main(void)
+{
+	VkInstanceCreateInfo instanceInfo = { VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
+	VkDeviceCreateInfo deviceInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+	VkMemoryAllocateInfo allocateInfo = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
+	VkMemoryMapInfo mapInfo = { VK_STRUCTURE_TYPE_MEMORY_MAP_INFO };
+	VkMemoryUnmapInfo unmapInfo = { VK_STRUCTURE_TYPE_MEMORY_UNMAP_INFO };
+	VkSubmitInfo submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
+	VkEventCreateInfo eventInfo = { VK_STRUCTURE_TYPE_EVENT_CREATE_INFO };
+	VkSemaphoreCreateInfo semaphoreInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+	VkSemaphoreSignalInfo signalInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO };
+	VkMappedMemoryRange ranges[4];
+	VkInstance instance;
+	VkPhysicalDevice physicalDevice;
+	VkDevice device;
+	VkQueue queue;
+	VkEvent event;
+	VkDeviceMemory memories[2], coherent, local;
+	VilcMappingCacheStats stats;
+	const MockMappedRange* log;
+	char* base;
+	char* data;
+	void* mapped;
+	uint32_t physicalDeviceCount = 1;
+	uint32_t maps, unmaps, i;
+
+	/* memory type 1 is host-visible without being host-coherent */
+	mockSetHostCoherent(0);
+	CHECK(vkCreateInstance(&instanceInfo, NULL, &instance) == VK_SUCCESS);
+	CHECK(vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, &physicalDevice) == VK_SUCCESS);
+	CHECK(vkCreateDevice(physicalDevice, &deviceInfo, NULL, &device) == VK_SUCCESS);
+	vkGetDeviceQueue(device, 0, 0, &queue);
+
+	allocateInfo.allocationSize = MEMORY_SIZE;
+	allocateInfo.memoryTypeIndex = 1;
+	CHECK(vkAllocateMemory(device, &allocateInfo, NULL, &memories[0]) == VK_SUCCESS);
+	CHECK(vkAllocateMemory(device, &allocateInfo, NULL, &memories[1]) == VK_SUCCESS);
+	allocateInfo.memoryTypeIndex = 0;
+	CHECK(vkAllocateMemory(device, &allocateInfo, NULL, &local) == VK_SUCCESS);
+
+	/* the allocation is mapped by the driver once, and maps of the application point into that mapping */
+	maps = mockCallCount("vkMapMemory");
+	unmaps = mockCallCount("vkUnmapMemory");
+	CHECK(vkMapMemory(device, memories[0], 0, VK_WHOLE_SIZE, 0, &mapped) == VK_SUCCESS);
+	base = (char*)mapped;
+	vkUnmapMemory(device, memories[0]);
+	for (i = 0; i < 10; ++i)
+	{
+		CHECK(vkMapMemory(device, memories[0], 256 * i, 256, 0, &mapped) == VK_SUCCESS);
+		CHECK((char*)mapped == base + 256 * i);
+		memset(mapped, (int)i, 256);
+		vkUnmapMemory(device, memories[0]);
+	}
+	CHECK(mockCallCount("vkMapMemory") == maps + 1 && mockCallCount("vkUnmapMemory") == unmaps);
+	CHECK(base[256 * 9] == 9);
+
+	/* so are maps with vkMapMemory2, and unmaps with vkUnmapMemory2 are elided the same way */
+	mapInfo.memory = memories[0];
+	mapInfo.offset = 1024;
+	mapInfo.size = 64;
+	CHECK(vkMapMemory2(device, &mapInfo, &mapped) == VK_SUCCESS);
+	CHECK((char*)mapped == base + 1024 && mockCallCount("vkMapMemory2") == 0);
+	unmapInfo.memory = memories[0];
+	CHECK(vkUnmapMemory2(device, &unmapInfo) == VK_SUCCESS);
+	CHECK(mockCallCount("vkUnmapMemory2") == 0);
+
+	/* memory that is not host-visible is passed through */
+	CHECK(vkMapMemory(device, local, 0, VK_WHOLE_SIZE, 0, &mapped) == VK_SUCCESS);
+	vkUnmapMemory(device, local);
+	CHECK(mockCallCount("vkMapMemory") == maps + 2 && mockCallCount("vkUnmapMemory") == unmaps + 1);
+
+	/* flushes are held until the next submit, where the ranges that touch are made as one */
+	CHECK(vkMapMemory(device, memories[1], 0, VK_WHOLE_SIZE, 0, &mapped) == VK_SUCCESS);
+	mockResetMappedRangeLog();
+	ranges[0] = rangeOf(memories[0], 128, 64);
+	ranges[1] = rangeOf(memories[1], 0, 64);
+	CHECK(vkFlushMappedMemoryRanges(device, 2, ranges) == VK_SUCCESS);
+	ranges[0] = rangeOf(memories[0], 0, 128);
+	ranges[1] = rangeOf(memories[0], 512, 64);
+	ranges[2] = rangeOf(memories[0], 3072, VK_WHOLE_SIZE);
+	CHECK(vkFlushMappedMemoryRanges(device, 3, ranges) == VK_SUCCESS);
+	CHECK(mockMappedRangeLog(&log) == 0 && mockCallCount("vkFlushMappedMemoryRanges") == 0);
+	CHECK(vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE) == VK_SUCCESS);
+	CHECK(mockCallCount("vkFlushMappedMemoryRanges") == 1 && mockMappedRangeLog(&log) == 4);
+	for (i = 0; i < 4; ++i)
+		CHECK(!log[i].invalidate);
+	/* the two allocations are sorted by handle, which is not the order of allocation */
+	for (i = 0; i < 4 && log[i].memory != memories[0]; ++i)
+		;
+	CHECK(i < 3 && log[i].offset == 0 && log[i].size == 192);
+	CHECK(log[i + 1].memory == memories[0] && log[i + 1].offset == 512 && log[i + 1].size == 64);
+	CHECK(log[i + 2].memory == memories[0] && log[i + 2].offset == 3072 && log[i + 2].size == MEMORY_SIZE - 3072);
+	CHECK(vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE) == VK_SUCCESS);
+	CHECK(mockCallCount("vkFlushMappedMemoryRanges") == 1);
+
+	/* held flushes are made before an invalidation, which would drop the host writes */
+	mockResetMappedRangeLog();
+	ranges[0] = rangeOf(memories[1], 64, 64);
+	CHECK(vkFlushMappedMemoryRanges(device, 1, ranges) == VK_SUCCESS);
+	ranges[0] = rangeOf(memories[1], 0, 64);
+	ranges[1] = rangeOf(memories[1], 64, 64);
+	CHECK(vkInvalidateMappedMemoryRanges(device, 2, ranges) == VK_SUCCESS);
+	CHECK(mockMappedRangeLog(&log) == 2 && !log[0].invalidate && log[0].offset == 64);
+	CHECK(log[1].invalidate && log[1].offset == 0 && log[1].size == 128);
+
+	/* held flushes are made before host signals, which can release submitted work that reads the memory */
+	CHECK(vkCreateEvent(device, &eventInfo, NULL, &event) == VK_SUCCESS);
+	CHECK(vkCreateSemaphore(device, &semaphoreInfo, NULL, &signalInfo.semaphore) == VK_SUCCESS);
+	signalInfo.value = 1;
+	mockResetMappedRangeLog();
+	CHECK(vkFlushMappedMemoryRanges(device, 1, ranges) == VK_SUCCESS);
+	CHECK(mockMappedRangeLog(&log) == 0);
+	CHECK(vkSetEvent(device, event) == VK_SUCCESS);
+	CHECK(mockCallCount("vkSetEvent") == 1 && mockMappedRangeLog(&log) == 1);
+	CHECK(vkFlushMappedMemoryRanges(device, 1, ranges) == VK_SUCCESS);
+	CHECK(vkSignalSemaphore(device, &signalInfo) == VK_SUCCESS);
+	CHECK(mockCallCount("vkSignalSemaphore") == 1 && mockMappedRangeLog(&log) == 2);
+	CHECK(vkFlushMappedMemoryRanges(device, 1, ranges) == VK_SUCCESS);
+	signalInfo.value = 2;
+	CHECK(vkSignalSemaphoreKHR(device, &signalInfo) == VK_SUCCESS);
+	CHECK(mockCallCount("vkSignalSemaphore") == 2 && mockMappedRangeLog(&log) == 3);
+	for (i = 0; i < 3; ++i)
+		CHECK(!log[i].invalidate && log[i].memory == memories[1] && log[i].offset == 0 && log[i].size == 64);
+	vkDestroySemaphore(device, signalInfo.semaphore, NULL);
+	vkDestroyEvent(device, event, NULL);
+
+	/* flushes of an allocation that is freed are dropped, and freeing unmaps it */
+	mockResetMappedRangeLog();
+	CHECK(vkFlushMappedMemoryRanges(device, 1, ranges) == VK_SUCCESS);
+	vkFreeMemory(device, memories[1], NULL);
+	CHECK(vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE) == VK_SUCCESS);
+	CHECK(mockMappedRangeLog(&log) == 0);
+
+	/* vkUnmapMemory2 with flags unmaps the allocation after its held flushes were made, and the next map maps it again */
+	ranges[0] = rangeOf(memories[0], 0, 64);
+	CHECK(vkFlushMappedMemoryRanges(device, 1, ranges) == VK_SUCCESS);
+	unmapInfo.flags = VK_MEMORY_UNMAP_RESERVE_BIT_EXT;
+	CHECK(vkUnmapMemory2(device, &unmapInfo) == VK_SUCCESS);
+	CHECK(mockCallCount("vkUnmapMemory2") == 1 && mockMappedRangeLog(&log) == 1);
+	CHECK(vkMapMemory(device, memories[0], 64, 64, 0, &mapped) == VK_SUCCESS);
+	CHECK(mockCallCount("vkMapMemory") == maps + 4);
+	data = (char*)mapped;
+	vkUnmapMemory(device, memories[0]);
+
+	vilcGetMappingCacheStats(&stats);
+	CHECK(stats.driverMaps == 3 && stats.liveMappings == 1 && stats.mappedBytes == MEMORY_SIZE);
+	CHECK(stats.flushedRanges == 11 && stats.driverFlushes == 6 && stats.mergedRanges == 2);
+	CHECK(stats.invalidatedRanges == 2 && stats.driverInvalidates == 1 && stats.coherentRanges == 0);
+	CHECK(data == base + 64);
+
+	vkFreeMemory(device, memories[0], NULL);
+	vkFreeMemory(device, local, NULL);
+	vkDestroyDevice(device, NULL);
+
+	/* flushes and invalidations of host-coherent memory do not reach the driver */
+	mockSetHostCoherent(1);
+	CHECK(vkCreateDevice(physicalDevice, &deviceInfo, NULL, &device) == VK_SUCCESS);
+	vkGetDeviceQueue(device, 0, 0, &queue);
+	allocateInfo.memoryTypeIndex = 1;
+	CHECK(vkAllocateMemory(device, &allocateInfo, NULL, &coherent) == VK_SUCCESS);
+	CHECK(vkMapMemory(device, coherent, 0, VK_WHOLE_SIZE, 0, &mapped) == VK_SUCCESS);
+	mockResetMappedRangeLog();
+	ranges[0] = rangeOf(coherent, 0, VK_WHOLE_SIZE);
+	CHECK(vkFlushMappedMemoryRanges(device, 1, ranges) == VK_SUCCESS);
+	CHECK(vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE) == VK_SUCCESS);
+	CHECK(vkInvalidateMappedMemoryRanges(device, 1, ranges) == VK_SUCCESS);
+	CHECK(mockMappedRangeLog(&log) == 0);
+	vilcGetMappingCacheStats(&stats);
+	CHECK(stats.coherentRanges == 2 && stats.driverInvalidates == 1);
+	vkUnmapMemory(device, coherent);
+	vkFreeMemory(device, coherent, NULL);
+	vkDestroyDevice(device, NULL);
+	vkDestroyInstance(instance, NULL);
+
+	printf("mapping_cache: passed\n");
+	return 0;
+}
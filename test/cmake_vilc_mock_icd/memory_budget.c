@@ -0,0 +1,96 @@
+#include "mock_icd.h"
+#include "vilc.h"
+
+#include <stdio.h>
+#include <string.h>
+
+int main(void)
+{
+	const char* deviceExtensions[] = { "VK_EXT_memory_budget" };
+	VkInstanceCreateInfo instanceInfo = { VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
+	VkDeviceCreateInfo deviceInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+	VkMemoryDedicatedAllocateInfo dedicatedInfo = { VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO };
+	VkMemoryAllocateInfo allocateInfo = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
+	VkBufferCreateInfo bufferInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+	VkImageCreateInfo imageInfo = { VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+	VkBindBufferMemoryInfo bindInfo = { VK_STRUCTURE_TYPE_BIND_BUFFER_MEMORY_INFO };
+	VkInstance instance;
+	VkPhysicalDevice physicalDevice;
+	VkDevice device;
+	VkDeviceMemory deviceMemory, hostMemory;
+	VkBuffer buffer;
+	VkImage image;
+	VilcMemoryBudget budget;
+	uint32_t physicalDeviceCount = 1;
+
+	CHECK(vkCreateInstance(&instanceInfo, NULL, &instance) == VK_SUCCESS);
+	CHECK(vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, &physicalDevice) == VK_SUCCESS);
+
+	deviceInfo.enabledExtensionCount = 1;
+	deviceInfo.ppEnabledExtensionNames = deviceExtensions;
+	CHECK(vkCreateDevice(physicalDevice, &deviceInfo, NULL, &device) == VK_SUCCESS);
+
+	vilcGetMemoryBudget(&budget);
+	CHECK(budget.driverBudget && budget.memoryTypeCount == 2 && budget.memoryHeapCount == 2);
+	CHECK(budget.maxMemoryAllocationCount == 4096 && budget.allocationCount == 0);
+	CHECK(budget.memoryHeaps[0].budget == MOCK_HEAP_BUDGET && budget.memoryHeaps[0].usage == MOCK_HEAP_EXTERNAL_USAGE);
+	CHECK(budget.memoryHeaps[0].size == (1ull << 30));
+
+	/* memory type i is in heap i; the driver budget is refreshed after every allocation */
+	allocateInfo.pNext = &dedicatedInfo;
+	allocateInfo.allocationSize = 1 << 20;
+	allocateInfo.memoryTypeIndex = 0;
+	CHECK(vkAllocateMemory(device, &allocateInfo, NULL, &deviceMemory) == VK_SUCCESS);
+	allocateInfo.pNext = NULL;
+	allocateInfo.allocationSize = 64 << 10;
+	allocateInfo.memoryTypeIndex = 1;
+	CHECK(vkAllocateMemory(device, &allocateInfo, NULL, &hostMemory) == VK_SUCCESS);
+
+	vilcGetMemoryBudget(&budget);
+	CHECK(budget.allocationCount == 2);
+	CHECK(budget.memoryTypes[0].allocatedBytes == (1 << 20) && budget.memoryTypes[0].dedicatedAllocationCount == 1);
+	CHECK(budget.memoryTypes[1].allocatedBytes == (64 << 10) && budget.memoryTypes[1].dedicatedAllocationCount == 0);
+	CHECK(budget.memoryHeaps[0].counter.allocationCount == 1 && budget.memoryHeaps[1].counter.allocationCount == 1);
+	CHECK(budget.memoryHeaps[0].usage == MOCK_HEAP_EXTERNAL_USAGE + (1 << 20));
+
+	/* bound bytes are the memory requirements, which the mock rounds up to MOCK_RESOURCE_ALIGNMENT */
+	bufferInfo.size = 1000;
+	CHECK(vkCreateBuffer(device, &bufferInfo, NULL, &buffer) == VK_SUCCESS);
+	bindInfo.buffer = buffer;
+	bindInfo.memory = hostMemory;
+	CHECK(vkBindBufferMemory2(device, 1, &bindInfo) == VK_SUCCESS);
+	imageInfo.extent.width = 16;
+	imageInfo.extent.height = 16;
+	imageInfo.extent.depth = 1;
+	CHECK(vkCreateImage(device, &imageInfo, NULL, &image) == VK_SUCCESS);
+	CHECK(vkBindImageMemory(device, image, deviceMemory, 0) == VK_SUCCESS);
+
+	vilcGetMemoryBudget(&budget);
+	CHECK(budget.memoryTypes[1].boundBytes == 1024 && budget.memoryTypes[1].boundResourceCount == 1);
+	CHECK(budget.memoryHeaps[0].counter.boundBytes == 16 * 16 * 4 && budget.memoryHeaps[0].counter.boundResourceCount == 1);
+
+	vkDestroyBuffer(device, buffer, NULL);
+	vkFreeMemory(device, deviceMemory, NULL);
+	vilcGetMemoryBudget(&budget);
+	CHECK(budget.allocationCount == 1);
+	CHECK(budget.memoryTypes[1].boundBytes == 0 && budget.memoryTypes[1].boundResourceCount == 0);
+	CHECK(budget.memoryTypes[0].allocatedBytes == 0 && budget.memoryTypes[0].peakAllocatedBytes == (1 << 20));
+	CHECK(budget.memoryTypes[0].dedicatedAllocationCount == 0);
+	CHECK(budget.memoryHeaps[0].usage == MOCK_HEAP_EXTERNAL_USAGE);
+
+	/* the image still counts as bound until it is destroyed */
+	CHECK(budget.memoryTypes[0].boundResourceCount == 1);
+	vkDestroyImage(device, image, NULL);
+	vilcGetMemoryBudget(&budget);
+	CHECK(budget.memoryTypes[0].boundBytes == 0 && budget.memoryTypes[0].boundResourceCount == 0);
+
+	vkFreeMemory(device, hostMemory, NULL);
+	vilcGetMemoryBudget(&budget);
+	CHECK(budget.allocationCount == 0 && budget.memoryHeaps[1].counter.allocatedBytes == 0);
+
+	vkDestroyDevice(device, NULL);
+	vkDestroyInstance(instance, NULL);
+
+	printf("memory_budget: passed\n");
+	return 0;
+}
@@ -0,0 +1,211 @@
+#include "mock_icd.h"
+#include "vilc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* the mock asks for 1024 bytes of bufferImageGranularity and 64 of nonCoherentAtomSize, so nodes are pages */
+#define NODE_SIZE 4096
+#define BLOCK_SIZE (1u << 20)
+#define SMALL_COUNT 64
+#define SMALL_SIZE 1000
+#define FILL_COUNT (BLOCK_SIZE / NODE_SIZE)
+
+static VkMappedMemoryRange rangeOf(VkDeviceMemory memory, VkDeviceSize offset, VkDeviceSize size)
+{
+	VkMappedMemoryRange range = { VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE };
+	range.memory = memory;
+	range.offset = offset;
+	range.size = size;
+	return range;
+}
+
+int main(void)
+{
+	VkInstanceCreateInfo instanceInfo = { VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
+	VkDeviceCreateInfo deviceInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+	VkMemoryAllocateInfo allocateInfo = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
+	VkMemoryDedicatedAllocateInfo dedicatedInfo = { VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO };
+	VkMemoryAllocateFlagsInfo flagsInfo = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO };
+	VkBufferCreateInfo bufferInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+	VkImageCreateInfo imageInfo = { VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+	VkBindImageMemoryInfo bindImageInfo = { VK_STRUCTURE_TYPE_BIND_IMAGE_MEMORY_INFO };
+	VkBindSparseInfo bindSparseInfo = { VK_STRUCTURE_TYPE_BIND_SPARSE_INFO };
+	VkSparseBufferMemoryBindInfo sparseBufferInfo;
+	VkSparseMemoryBind sparseBind;
+	VkMappedMemoryRange range;
+	VkInstance instance;
+	VkPhysicalDevice physicalDevice;
+	VkDevice device;
+	VkQueue queue;
+	VkDeviceMemory small[SMALL_COUNT], fill[FILL_COUNT], block, other, large, dedicated, addressed, local;
+	VkBuffer buffers[SMALL_COUNT], sparseBuffer;
+	VkImage image;
+	VkDeviceSize offsets[SMALL_COUNT], offset, committed;
+	VilcMemorySuballocatorStats stats;
+	const MockMappedRange* log;
+	void* mapped[2];
+	uint32_t physicalDeviceCount = 1;
+	uint32_t allocations, frees, maps, unmaps, i, j;
+
+	setenv("VILC_MEMORY_SUBALLOCATOR_BLOCK_SIZE", "1048576", 1);
+	/* memory type 1 is host-visible without being host-coherent, so flushes reach the driver */
+	mockSetHostCoherent(0);
+
+	CHECK(vkCreateInstance(&instanceInfo, NULL, &instance) == VK_SUCCESS);
+	CHECK(vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, &physicalDevice) == VK_SUCCESS);
+	CHECK(vkCreateDevice(physicalDevice, &deviceInfo, NULL, &device) == VK_SUCCESS);
+	vkGetDeviceQueue(device, 0, 0, &queue);
+
+	/* small allocations are served from one driver allocation, at distinct node-aligned offsets of it */
+	allocations = mockCallCount("vkAllocateMemory");
+	allocateInfo.allocationSize = SMALL_SIZE;
+	allocateInfo.memoryTypeIndex = 1;
+	bufferInfo.size = SMALL_SIZE;
+	for (i = 0; i < SMALL_COUNT; ++i)
+	{
+		CHECK(vkAllocateMemory(device, &allocateInfo, NULL, &small[i]) == VK_SUCCESS);
+		CHECK(vkCreateBuffer(device, &bufferInfo, NULL, &buffers[i]) == VK_SUCCESS);
+		CHECK(vkBindBufferMemory(device, buffers[i], small[i], 0) == VK_SUCCESS);
+	}
+	CHECK(mockCallCount("vkAllocateMemory") == allocations + 1);
+	block = mockBufferMemory(buffers[0], &offsets[0]);
+	for (i = 0; i < SMALL_COUNT; ++i)
+	{
+		CHECK(mockBufferMemory(buffers[i], &offsets[i]) == block && offsets[i] % NODE_SIZE == 0 && offsets[i] < BLOCK_SIZE);
+		for (j = 0; j < i; ++j)
+			CHECK(small[i] != small[j] && offsets[i] != offsets[j]);
+	}
+
+	/* bind offsets are added to the offset of the suballocation */
+	CHECK(vkBindBufferMemory(device, buffers[1], small[2], 256) == VK_SUCCESS);
+	CHECK(mockBufferMemory(buffers[1], &offset) == block && offset == offsets[2] + 256);
+	CHECK(vkBindBufferMemory(device, buffers[1], small[1], 0) == VK_SUCCESS);
+
+	/* the block is mapped once, maps point into it at the offset of the suballocation, and unmaps do not reach the driver */
+	maps = mockCallCount("vkMapMemory");
+	unmaps = mockCallCount("vkUnmapMemory");
+	CHECK(vkMapMemory(device, small[0], 0, VK_WHOLE_SIZE, 0, &mapped[0]) == VK_SUCCESS);
+	CHECK(vkMapMemory(device, small[5], 16, 64, 0, &mapped[1]) == VK_SUCCESS);
+	CHECK((char*)mapped[1] - (char*)mapped[0] == (ptrdiff_t)(offsets[5] - offsets[0] + 16));
+	memset(mapped[1], 5, 64);
+	vkUnmapMemory(device, small[5]);
+	vkUnmapMemory(device, small[0]);
+	CHECK(mockCallCount("vkMapMemory") == maps + 1 && mockCallCount("vkUnmapMemory") == unmaps);
+	CHECK(vkMapMemory(device, small[5], 0, 64, 1, &mapped[1]) == VK_ERROR_MEMORY_MAP_FAILED);
+
+	/* flushed ranges are moved to the block, and ranges to the end of the allocation extend to the end of its node */
+	mockResetMappedRangeLog();
+	range = rangeOf(small[5], 64, VK_WHOLE_SIZE);
+	CHECK(vkFlushMappedMemoryRanges(device, 1, &range) == VK_SUCCESS);
+	range = rangeOf(small[6], 128, SMALL_SIZE - 128);
+	CHECK(vkInvalidateMappedMemoryRanges(device, 1, &range) == VK_SUCCESS);
+	CHECK(mockMappedRangeLog(&log) == 2);
+	CHECK(log[0].memory == block && log[0].offset == offsets[5] + 64 && log[0].size == NODE_SIZE - 64 && !log[0].invalidate);
+	CHECK(log[1].memory == block && log[1].offset == offsets[6] + 128 && log[1].size == NODE_SIZE - 128 && log[1].invalidate);
+
+	vkGetDeviceMemoryCommitment(device, small[3], &committed);
+	CHECK(committed == SMALL_SIZE && mockCallCount("vkGetDeviceMemoryCommitment") == 0);
+
+	/* large and dedicated allocations reach the driver as they are */
+	allocations = mockCallCount("vkAllocateMemory");
+	allocateInfo.allocationSize = BLOCK_SIZE / 8 + 1;
+	CHECK(vkAllocateMemory(device, &allocateInfo, NULL, &large) == VK_SUCCESS);
+	allocateInfo.allocationSize = SMALL_SIZE;
+	allocateInfo.pNext = &dedicatedInfo;
+	dedicatedInfo.buffer = buffers[0];
+	CHECK(vkAllocateMemory(device, &allocateInfo, NULL, &dedicated) == VK_SUCCESS);
+	CHECK(mockCallCount("vkAllocateMemory") == allocations + 2);
+	vkGetDeviceMemoryCommitment(device, large, &committed);
+	CHECK(committed == BLOCK_SIZE / 8 + 1 && mockCallCount("vkGetDeviceMemoryCommitment") == 1);
+
+	/* memory with device addresses comes from blocks of its own */
+	allocateInfo.pNext = &flagsInfo;
+	flagsInfo.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT;
+	CHECK(vkAllocateMemory(device, &allocateInfo, NULL, &addressed) == VK_SUCCESS);
+	CHECK(vkBindBufferMemory(device, buffers[0], addressed, 0) == VK_SUCCESS);
+	CHECK(mockBufferMemory(buffers[0], &offset) != block && mockCallCount("vkAllocateMemory") == allocations + 3);
+	CHECK(vkBindBufferMemory(device, buffers[0], small[0], 0) == VK_SUCCESS);
+	allocateInfo.pNext = NULL;
+
+	/* so does every memory type, and vkBindImageMemory2 binds are translated */
+	allocateInfo.memoryTypeIndex = 0;
+	allocateInfo.allocationSize = 64 * 64 * 4;
+	CHECK(vkAllocateMemory(device, &allocateInfo, NULL, &local) == VK_SUCCESS);
+	imageInfo.imageType = VK_IMAGE_TYPE_2D;
+	imageInfo.extent.width = 64;
+	imageInfo.extent.height = 64;
+	imageInfo.extent.depth = 1;
+	CHECK(vkCreateImage(device, &imageInfo, NULL, &image) == VK_SUCCESS);
+	bindImageInfo.image = image;
+	bindImageInfo.memory = local;
+	CHECK(vkBindImageMemory2(device, 1, &bindImageInfo) == VK_SUCCESS);
+	CHECK(mockImageMemory(image, &offset) != block && mockImageMemory(image, &offset) != local && offset == 0);
+	CHECK(mockCallCount("vkAllocateMemory") == allocations + 4);
+
+	/* sparse binds are translated as well */
+	CHECK(vkCreateBuffer(device, &bufferInfo, NULL, &sparseBuffer) == VK_SUCCESS);
+	memset(&sparseBind, 0, sizeof(sparseBind));
+	sparseBind.size = SMALL_SIZE;
+	sparseBind.memory = small[7];
+	sparseBind.memoryOffset = 512;
+	sparseBufferInfo.buffer = sparseBuffer;
+	sparseBufferInfo.bindCount = 1;
+	sparseBufferInfo.pBinds = &sparseBind;
+	bindSparseInfo.bufferBindCount = 1;
+	bindSparseInfo.pBufferBinds = &sparseBufferInfo;
+	CHECK(vkQueueBindSparse(queue, 1, &bindSparseInfo, VK_NULL_HANDLE) == VK_SUCCESS);
+	CHECK(mockBufferMemory(sparseBuffer, &offset) == block && offset == offsets[7] + 512);
+	CHECK(sparseBind.memory == small[7] && sparseBufferInfo.pBinds == &sparseBind);
+
+	/* a full block makes another one, and an empty block is freed while another one is empty */
+	allocations = mockCallCount("vkAllocateMemory");
+	frees = mockCallCount("vkFreeMemory");
+	allocateInfo.memoryTypeIndex = 1;
+	allocateInfo.allocationSize = NODE_SIZE;
+	for (i = 0; i < FILL_COUNT; ++i)
+		CHECK(vkAllocateMemory(device, &allocateInfo, NULL, &fill[i]) == VK_SUCCESS);
+	CHECK(mockCallCount("vkAllocateMemory") == allocations + 1);
+	vilcGetMemorySuballocatorStats(&stats);
+	CHECK(stats.liveBlocks == 4 && stats.liveSuballocations == SMALL_COUNT + FILL_COUNT + 2);
+	for (i = 0; i < FILL_COUNT; ++i)
+		vkFreeMemory(device, fill[i], NULL);
+	CHECK(mockCallCount("vkFreeMemory") == frees);
+	for (i = 0; i < SMALL_COUNT; ++i)
+		vkFreeMemory(device, small[i], NULL);
+	CHECK(mockCallCount("vkFreeMemory") == frees + 1);
+
+	/* freed nodes merge back, so a suballocation of the largest size fits again */
+	allocateInfo.allocationSize = BLOCK_SIZE / 8;
+	for (i = 0; i < 8; ++i)
+		CHECK(vkAllocateMemory(device, &allocateInfo, NULL, &fill[i]) == VK_SUCCESS);
+	CHECK(vkAllocateMemory(device, &allocateInfo, NULL, &other) == VK_SUCCESS);
+	CHECK(mockCallCount("vkAllocateMemory") == allocations + 2);
+
+	vilcGetMemorySuballocatorStats(&stats);
+	CHECK(stats.suballocations == SMALL_COUNT + 2 + FILL_COUNT + 9 && stats.passedThroughAllocations == 2 && stats.blockAllocations == 5);
+	CHECK(stats.liveSuballocations == 11 && stats.liveBlocks == 4 && stats.blockBytes == 4ull * BLOCK_SIZE);
+	CHECK(stats.requestedBytes == 9ull * BLOCK_SIZE / 8 + SMALL_SIZE + 64 * 64 * 4 && stats.usedBytes == 9ull * BLOCK_SIZE / 8 + NODE_SIZE + 64 * 64 * 4);
+	CHECK(stats.largestFreeBytes == BLOCK_SIZE / 2);
+
+	for (i = 0; i < 8; ++i)
+		vkFreeMemory(device, fill[i], NULL);
+	vkFreeMemory(device, other, NULL);
+	vkFreeMemory(device, large, NULL);
+	vkFreeMemory(device, dedicated, NULL);
+	vkFreeMemory(device, addressed, NULL);
+	vkFreeMemory(device, local, NULL);
+	for (i = 0; i < SMALL_COUNT; ++i)
+		vkDestroyBuffer(device, buffers[i], NULL);
+	vkDestroyBuffer(device, sparseBuffer, NULL);
+	vkDestroyImage(device, image, NULL);
+
+	/* the blocks left are freed with the device */
+	vkDestroyDevice(device, NULL);
+	CHECK(mockCallCount("vkAllocateMemory") == mockCallCount("vkFreeMemory"));
+	vkDestroyInstance(instance, NULL);
+
+	printf("memory_suballocator: passed\n");
+	return 0;
+}
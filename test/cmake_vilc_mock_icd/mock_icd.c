@@ -0,0 +1,2003 @@
+/* Minimal ICD that lets the VILC modes run without a GPU; see mock_icd.h */
+#include "mock_icd.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MOCK_COMMANDS(X) \
+	X(vkCreateInstance) \
+	X(vkDestroyInstance) \
+	X(vkEnumeratePhysicalDevices) \
+	X(vkGetPhysicalDeviceProperties) \
+	X(vkGetPhysicalDeviceMemoryProperties) \
+	X(vkGetPhysicalDeviceQueueFamilyProperties) \
+	X(vkGetPhysicalDeviceCalibrateableTimeDomainsKHR) \
+	X(vkGetCalibratedTimestampsKHR) \
+	X(vkGetDeviceProcAddr) \
+	X(vkCreateDevice) \
+	X(vkDestroyDevice) \
+	X(vkGetDeviceQueue) \
+	X(vkCreateCommandPool) \
+	X(vkDestroyCommandPool) \
+	X(vkResetCommandPool) \
+	X(vkAllocateCommandBuffers) \
+	X(vkFreeCommandBuffers) \
+	X(vkBeginCommandBuffer) \
+	X(vkEndCommandBuffer) \
+	X(vkResetCommandBuffer) \
+	X(vkCreateFence) \
+	X(vkDestroyFence) \
+	X(vkGetFenceStatus) \
+	X(vkResetFences) \
+	X(vkWaitForFences) \
+	X(vkCreateSemaphore) \
+	X(vkDestroySemaphore) \
+	X(vkSignalSemaphore) \
+	X(vkCreateEvent) \
+	X(vkDestroyEvent) \
+	X(vkSetEvent) \
+	X(vkCreateQueryPool) \
+	X(vkDestroyQueryPool) \
+	X(vkGetQueryPoolResults) \
+	X(vkCmdResetQueryPool) \
+	X(vkCmdWriteTimestamp) \
+	X(vkCmdWriteTimestamp2) \
+	X(vkCmdBeginRenderPass) \
+	X(vkCmdEndRenderPass) \
+	X(vkCmdBeginRendering) \
+	X(vkCmdEndRendering) \
+	X(vkCmdBeginDebugUtilsLabelEXT) \
+	X(vkCmdEndDebugUtilsLabelEXT) \
+	X(vkQueueInsertDebugUtilsLabelEXT) \
+	X(vkCmdDraw) \
+	X(vkCmdDrawIndexed) \
+	X(vkCmdDrawMultiEXT) \
+	X(vkCmdDrawMultiIndexedEXT) \
+	X(vkCmdDispatch) \
+	X(vkCmdDispatchIndirect) \
+	X(vkCmdDispatchBase) \
+	X(vkCmdDrawIndirectCount) \
+	X(vkCmdCopyBuffer) \
+	X(vkCmdUpdateBuffer) \
+	X(vkCmdPipelineBarrier) \
+	X(vkCmdPipelineBarrier2) \
+	X(vkQueueSubmit) \
+	X(vkQueueSubmit2) \
+	X(vkQueuePresentKHR) \
+	X(vkQueueWaitIdle) \
+	X(vkQueueBindSparse) \
+	X(vkDeviceWaitIdle) \
+	X(vkAllocateMemory) \
+	X(vkFreeMemory) \
+	X(vkMapMemory) \
+	X(vkGetDeviceMemoryCommitment) \
+	X(vkUnmapMemory) \
+	X(vkMapMemory2) \
+	X(vkUnmapMemory2) \
+	X(vkFlushMappedMemoryRanges) \
+	X(vkInvalidateMappedMemoryRanges) \
+	X(vkCmdBindPipeline) \
+	X(vkCmdBindIndexBuffer) \
+	X(vkCmdBindDescriptorSets) \
+	X(vkCmdBindVertexBuffers) \
+	X(vkCmdSetViewport) \
+	X(vkCmdSetScissor) \
+	X(vkCmdSetLineWidth) \
+	X(vkCmdPushConstants) \
+	X(vkCmdExecuteCommands) \
+	X(vkGetPhysicalDeviceMemoryProperties2) \
+	X(vkGetPhysicalDeviceProperties2) \
+	X(vkCreateBuffer) \
+	X(vkDestroyBuffer) \
+	X(vkGetBufferMemoryRequirements) \
+	X(vkBindBufferMemory) \
+	X(vkBindBufferMemory2) \
+	X(vkCreateImage) \
+	X(vkDestroyImage) \
+	X(vkGetImageMemoryRequirements) \
+	X(vkBindImageMemory) \
+	X(vkBindImageMemory2) \
+	X(vkCreateImageView) \
+	X(vkDestroyImageView) \
+	X(vkCreateRenderPass) \
+	X(vkDestroyRenderPass) \
+	X(vkCreateFramebuffer) \
+	X(vkDestroyFramebuffer) \
+	X(vkTransitionImageLayout) \
+	X(vkCreateShaderModule) \
+	X(vkDestroyShaderModule) \
+	X(vkCreateSampler) \
+	X(vkDestroySampler) \
+	X(vkCreateDescriptorSetLayout) \
+	X(vkDestroyDescriptorSetLayout) \
+	X(vkCreateDescriptorPool) \
+	X(vkDestroyDescriptorPool) \
+	X(vkResetDescriptorPool) \
+	X(vkAllocateDescriptorSets) \
+	X(vkFreeDescriptorSets) \
+	X(vkUpdateDescriptorSets) \
+	X(vkCreateDescriptorUpdateTemplate) \
+	X(vkDestroyDescriptorUpdateTemplate) \
+	X(vkUpdateDescriptorSetWithTemplate) \
+	X(vkCreatePipelineLayout) \
+	X(vkDestroyPipelineLayout) \
+	X(vkCreatePipelineCache) \
+	X(vkDestroyPipelineCache) \
+	X(vkGetPipelineCacheData) \
+	X(vkMergePipelineCaches) \
+	X(vkCreateGraphicsPipelines) \
+	X(vkCreateComputePipelines) \
+	X(vkDestroyPipeline) \
+	X(vkCreateDeferredOperationKHR) \
+	X(vkDestroyDeferredOperationKHR) \
+	X(vkGetDeferredOperationMaxConcurrencyKHR) \
+	X(vkGetDeferredOperationResultKHR) \
+	X(vkDeferredOperationJoinKHR) \
+	X(vkCreateRayTracingPipelinesKHR) \
+	X(vkBuildAccelerationStructuresKHR) \
+	X(vilcCmdExecuteRecordedCommands)
+
+enum
+{
+#define MOCK_ENUM(name) MOCK_##name,
+	MOCK_COMMANDS(MOCK_ENUM)
+#undef MOCK_ENUM
+	MOCK_COMMAND_COUNT
+};
+
+static const char* mockNames[MOCK_COMMAND_COUNT] = {
+#define MOCK_NAME(name) #name,
+	MOCK_COMMANDS(MOCK_NAME)
+#undef MOCK_NAME
+};
+
+static uint32_t mockCalls[MOCK_COMMAND_COUNT];
+
+/* dispatchable handles only need to be unique pointers */
+static char mockInstance, mockPhysicalDevice, mockDevice, mockQueues[MOCK_QUEUE_COUNT], mockCommandBuffers[64];
+
+/* atomic, as tests may call in from several threads */
+#define MOCK_CALL(name) __atomic_add_fetch(&mockCalls[MOCK_##name], 1, __ATOMIC_RELAXED)
+
+/* fences and semaphores are signaled by the thread that submits, which need not be the one that waits */
+typedef struct MockFence
+{
+	int signaled;
+} MockFence;
+
+typedef struct MockSemaphore
+{
+	int signaled;
+} MockSemaphore;
+
+typedef struct MockEvent
+{
+	int set;
+} MockEvent;
+
+typedef struct MockQueryPool
+{
+	uint32_t queryCount;
+	uint64_t* values;
+	uint8_t* available;
+} MockQueryPool;
+
+static uint64_t mockClock = 0;
+static uint64_t mockNextHandle = 1;
+
+#define MOCK_HANDLE(type, pointer) ((type)(uintptr_t)(pointer))
+#define MOCK_NEXT_HANDLE() __atomic_fetch_add(&mockNextHandle, 1, __ATOMIC_RELAXED)
+#define MOCK_OBJECT(type, handle) ((type*)(uintptr_t)(handle))
+
+/* Fences and device state are allocated through pAllocator like a real driver would */
+static void* mockAllocate(const VkAllocationCallbacks* pAllocator, size_t size, VkSystemAllocationScope scope)
+{
+	void* memory = pAllocator ? pAllocator->pfnAllocation(pAllocator->pUserData, size, MOCK_ALLOCATION_ALIGNMENT, scope) : malloc(size);
+	if (memory)
+		memset(memory, 0, size);
+	return memory;
+}
+
+static void mockFree(const VkAllocationCallbacks* pAllocator, void* memory)
+{
+	if (pAllocator)
+		pAllocator->pfnFree(pAllocator->pUserData, memory);
+	else
+		free(memory);
+}
+
+static void* mockDeviceState;
+
+/* memory type i lives in heap i */
+#define MOCK_MEMORY_HEADER_SIZE 16
+static VkDeviceSize mockHeapUsage[2];
+static int mockHostCoherent = 1;
+
+typedef struct MockResource
+{
+	VkDeviceSize size;
+	/* the last bind, of the first range for sparse binds */
+	VkDeviceMemory memory;
+	VkDeviceSize memoryOffset;
+} MockResource;
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkCreateInstance(const VkInstanceCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkInstance* pInstance)
+{
+	MOCK_CALL(vkCreateInstance);
+	*pInstance = (VkInstance)&mockInstance;
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkDestroyInstance(VkInstance instance, const VkAllocationCallbacks* pAllocator)
+{
+	MOCK_CALL(vkDestroyInstance);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkEnumeratePhysicalDevices(VkInstance instance, uint32_t* pPhysicalDeviceCount, VkPhysicalDevice* pPhysicalDevices)
+{
+	MOCK_CALL(vkEnumeratePhysicalDevices);
+	if (pPhysicalDevices && *pPhysicalDeviceCount)
+		pPhysicalDevices[0] = (VkPhysicalDevice)&mockPhysicalDevice;
+	*pPhysicalDeviceCount = 1;
+	return VK_SUCCESS;
+}
+
+static void mockProperties(VkPhysicalDeviceProperties* pProperties)
+{
+	memset(pProperties, 0, sizeof(*pProperties));
+	pProperties->apiVersion = VK_API_VERSION_1_3;
+	pProperties->vendorID = 0x1234;
+	pProperties->deviceID = 0x5678;
+	pProperties->driverVersion = 1;
+	pProperties->limits.timestampPeriod = 1.0f;
+	pProperties->limits.timestampComputeAndGraphics = VK_TRUE;
+	pProperties->limits.maxMemoryAllocationCount = 4096;
+	pProperties->limits.maxSamplerAllocationCount = 4000;
+	pProperties->limits.nonCoherentAtomSize = 64;
+	pProperties->limits.bufferImageGranularity = 1024;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkGetPhysicalDeviceProperties(VkPhysicalDevice physicalDevice, VkPhysicalDeviceProperties* pProperties)
+{
+	MOCK_CALL(vkGetPhysicalDeviceProperties);
+	mockProperties(pProperties);
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkGetPhysicalDeviceProperties2(VkPhysicalDevice physicalDevice, VkPhysicalDeviceProperties2* pProperties)
+{
+	VkBaseOutStructure* next;
+	MOCK_CALL(vkGetPhysicalDeviceProperties2);
+	mockProperties(&pProperties->properties);
+	for (next = (VkBaseOutStructure*)pProperties->pNext; next; next = next->pNext)
+		if (next->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTI_DRAW_PROPERTIES_EXT)
+			((VkPhysicalDeviceMultiDrawPropertiesEXT*)next)->maxMultiDrawCount = MOCK_MAX_MULTI_DRAW_COUNT;
+}
+
+static void mockMemoryProperties(VkPhysicalDeviceMemoryProperties* pMemoryProperties)
+{
+	memset(pMemoryProperties, 0, sizeof(*pMemoryProperties));
+	pMemoryProperties->memoryTypeCount = 2;
+	pMemoryProperties->memoryTypes[0].propertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+	pMemoryProperties->memoryTypes[0].heapIndex = 0;
+	pMemoryProperties->memoryTypes[1].propertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | (mockHostCoherent ? VK_MEMORY_PROPERTY_HOST_COHERENT_BIT : 0);
+	pMemoryProperties->memoryTypes[1].heapIndex = 1;
+	pMemoryProperties->memoryHeapCount = 2;
+	pMemoryProperties->memoryHeaps[0].size = 1ull << 30;
+	pMemoryProperties->memoryHeaps[0].flags = VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+	pMemoryProperties->memoryHeaps[1].size = 1ull << 30;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkGetPhysicalDeviceMemoryProperties(VkPhysicalDevice physicalDevice, VkPhysicalDeviceMemoryProperties* pMemoryProperties)
+{
+	MOCK_CALL(vkGetPhysicalDeviceMemoryProperties);
+	mockMemoryProperties(pMemoryProperties);
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkGetPhysicalDeviceMemoryProperties2(VkPhysicalDevice physicalDevice, VkPhysicalDeviceMemoryProperties2* pMemoryProperties)
+{
+	VkBaseOutStructure* next;
+	MOCK_CALL(vkGetPhysicalDeviceMemoryProperties2);
+	mockMemoryProperties(&pMemoryProperties->memoryProperties);
+	for (next = (VkBaseOutStructure*)pMemoryProperties->pNext; next; next = next->pNext)
+		if (next->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT)
+		{
+			VkPhysicalDeviceMemoryBudgetPropertiesEXT* budget = (VkPhysicalDeviceMemoryBudgetPropertiesEXT*)next;
+			uint32_t i;
+			for (i = 0; i < 2; ++i)
+			{
+				budget->heapBudget[i] = MOCK_HEAP_BUDGET;
+				budget->heapUsage[i] = MOCK_HEAP_EXTERNAL_USAGE + mockHeapUsage[i];
+			}
+		}
+}
+
+static VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL mock_vkGetDeviceProcAddr(VkDevice device, const char* pName);
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkCreateDevice(VkPhysicalDevice physicalDevice, const VkDeviceCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDevice* pDevice)
+{
+	MOCK_CALL(vkCreateDevice);
+	/* device state grows once after creation, and shader code is reported as a driver-internal allocation */
+	mockDeviceState = mockAllocate(pAllocator, MOCK_DEVICE_STATE_SIZE / 2, VK_SYSTEM_ALLOCATION_SCOPE_DEVICE);
+	if (pAllocator)
+	{
+		mockDeviceState = pAllocator->pfnReallocation(pAllocator->pUserData, mockDeviceState, MOCK_DEVICE_STATE_SIZE, MOCK_ALLOCATION_ALIGNMENT, VK_SYSTEM_ALLOCATION_SCOPE_DEVICE);
+		if (pAllocator->pfnInternalAllocation)
+			pAllocator->pfnInternalAllocation(pAllocator->pUserData, MOCK_INTERNAL_ALLOCATION_SIZE, VK_INTERNAL_ALLOCATION_TYPE_EXECUTABLE, VK_SYSTEM_ALLOCATION_SCOPE_DEVICE);
+	}
+	if (!mockDeviceState)
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	*pDevice = (VkDevice)&mockDevice;
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkDestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator)
+{
+	MOCK_CALL(vkDestroyDevice);
+	if (pAllocator && pAllocator->pfnInternalFree)
+		pAllocator->pfnInternalFree(pAllocator->pUserData, MOCK_INTERNAL_ALLOCATION_SIZE, VK_INTERNAL_ALLOCATION_TYPE_EXECUTABLE, VK_SYSTEM_ALLOCATION_SCOPE_DEVICE);
+	mockFree(pAllocator, mockDeviceState);
+	mockDeviceState = NULL;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkGetDeviceQueue(VkDevice device, uint32_t queueFamilyIndex, uint32_t queueIndex, VkQueue* pQueue)
+{
+	MOCK_CALL(vkGetDeviceQueue);
+	*pQueue = (VkQueue)&mockQueues[queueIndex % MOCK_QUEUE_COUNT];
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkAllocateCommandBuffers(VkDevice device, const VkCommandBufferAllocateInfo* pAllocateInfo, VkCommandBuffer* pCommandBuffers)
+{
+	static uint32_t next = 0;
+	uint32_t i;
+	MOCK_CALL(vkAllocateCommandBuffers);
+	for (i = 0; i < pAllocateInfo->commandBufferCount; ++i)
+		pCommandBuffers[i] = (VkCommandBuffer)&mockCommandBuffers[next++ % 64];
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkBeginCommandBuffer(VkCommandBuffer commandBuffer, const VkCommandBufferBeginInfo* pBeginInfo)
+{
+	MOCK_CALL(vkBeginCommandBuffer);
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkEndCommandBuffer(VkCommandBuffer commandBuffer)
+{
+	MOCK_CALL(vkEndCommandBuffer);
+	return VK_SUCCESS;
+}
+
+/* Commands in the order they were recorded, across all command buffers */
+static MockCommand mockCommands[MOCK_COMMAND_LOG_CAPACITY];
+static uint32_t mockCommandCount = 0;
+static uint32_t mockBarrierCommandCount = 0;
+static uint32_t mockDrawCommandCount = 0;
+
+static MockCommand* mockLogCommand(MockCommandType type, uint32_t call)
+{
+	MockCommand* command;
+
+	if (mockCommandCount == MOCK_COMMAND_LOG_CAPACITY)
+		return NULL;
+
+	command = &mockCommands[mockCommandCount++];
+	memset(command, 0, sizeof(*command));
+	command->type = type;
+	command->call = call;
+	return command;
+}
+
+static void mockLogBarrier(MockCommandType type, int legacy, VkDependencyFlags dependencyFlags, VkPipelineStageFlags2 srcStageMask, VkAccessFlags2 srcAccessMask,
+    VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask, uint64_t resource, VkImageLayout oldLayout, VkImageLayout newLayout)
+{
+	MockCommand* command = mockLogCommand(type, mockBarrierCommandCount);
+
+	if (!command)
+		return;
+
+	command->legacy = legacy;
+	command->dependencyFlags = dependencyFlags;
+	command->srcStageMask = srcStageMask;
+	command->srcAccessMask = srcAccessMask;
+	command->dstStageMask = dstStageMask;
+	command->dstAccessMask = dstAccessMask;
+	command->resource = resource;
+	command->oldLayout = oldLayout;
+	command->newLayout = newLayout;
+}
+
+static void mockLogDraw(MockCommandType type, uint32_t count, uint32_t instanceCount, uint32_t first, int32_t vertexOffset, uint32_t firstInstance)
+{
+	MockCommand* command = mockLogCommand(type, mockDrawCommandCount);
+
+	if (!command)
+		return;
+
+	command->count = count;
+	command->instanceCount = instanceCount;
+	command->first = first;
+	command->vertexOffset = vertexOffset;
+	command->firstInstance = firstInstance;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkCmdDraw(VkCommandBuffer commandBuffer, uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance)
+{
+	MOCK_CALL(vkCmdDraw);
+	mockLogDraw(MOCK_COMMAND_DRAW, vertexCount, instanceCount, firstVertex, 0, firstInstance);
+	mockDrawCommandCount++;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkCmdDrawIndexed(VkCommandBuffer commandBuffer, uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance)
+{
+	MOCK_CALL(vkCmdDrawIndexed);
+	mockLogDraw(MOCK_COMMAND_DRAW_INDEXED, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+	mockDrawCommandCount++;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkCmdDrawMultiEXT(VkCommandBuffer commandBuffer, uint32_t drawCount, const VkMultiDrawInfoEXT* pVertexInfo, uint32_t instanceCount, uint32_t firstInstance, uint32_t stride)
+{
+	uint32_t i;
+
+	MOCK_CALL(vkCmdDrawMultiEXT);
+	for (i = 0; i < drawCount; ++i)
+	{
+		const VkMultiDrawInfoEXT* draw = (const VkMultiDrawInfoEXT*)((const char*)pVertexInfo + (size_t)i * stride);
+		mockLogDraw(MOCK_COMMAND_DRAW, draw->vertexCount, instanceCount, draw->firstVertex, 0, firstInstance);
+	}
+	mockDrawCommandCount++;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkCmdDrawMultiIndexedEXT(VkCommandBuffer commandBuffer, uint32_t drawCount, const VkMultiDrawIndexedInfoEXT* pIndexInfo, uint32_t instanceCount, uint32_t firstInstance, uint32_t stride, const int32_t* pVertexOffset)
+{
+	uint32_t i;
+
+	MOCK_CALL(vkCmdDrawMultiIndexedEXT);
+	for (i = 0; i < drawCount; ++i)
+	{
+		const VkMultiDrawIndexedInfoEXT* draw = (const VkMultiDrawIndexedInfoEXT*)((const char*)pIndexInfo + (size_t)i * stride);
+		mockLogDraw(MOCK_COMMAND_DRAW_INDEXED, draw->indexCount, instanceCount, draw->firstIndex, pVertexOffset ? *pVertexOffset : draw->vertexOffset, firstInstance);
+	}
+	mockDrawCommandCount++;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkCmdDispatch(VkCommandBuffer commandBuffer, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+{
+	MOCK_CALL(vkCmdDispatch);
+	mockLogCommand(MOCK_COMMAND_DISPATCH, groupCountX);
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkCmdCopyBuffer(VkCommandBuffer commandBuffer, VkBuffer srcBuffer, VkBuffer dstBuffer, uint32_t regionCount, const VkBufferCopy* pRegions)
+{
+	MOCK_CALL(vkCmdCopyBuffer);
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkCmdUpdateBuffer(VkCommandBuffer commandBuffer, VkBuffer dstBuffer, VkDeviceSize dstOffset, VkDeviceSize dataSize, const void* pData)
+{
+	MOCK_CALL(vkCmdUpdateBuffer);
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkCmdPipelineBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask, VkDependencyFlags dependencyFlags, uint32_t memoryBarrierCount, const VkMemoryBarrier* pMemoryBarriers, uint32_t bufferMemoryBarrierCount, const VkBufferMemoryBarrier* pBufferMemoryBarriers, uint32_t imageMemoryBarrierCount, const VkImageMemoryBarrier* pImageMemoryBarriers)
+{
+	uint32_t i;
+
+	MOCK_CALL(vkCmdPipelineBarrier);
+	/* the stage masks apply to the whole call, which is an execution dependency even without barriers */
+	if (!memoryBarrierCount && !bufferMemoryBarrierCount && !imageMemoryBarrierCount)
+		mockLogBarrier(MOCK_COMMAND_MEMORY_BARRIER, 1, dependencyFlags, srcStageMask, 0, dstStageMask, 0, 0, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_UNDEFINED);
+	for (i = 0; i < memoryBarrierCount; ++i)
+		mockLogBarrier(MOCK_COMMAND_MEMORY_BARRIER, 1, dependencyFlags, srcStageMask, pMemoryBarriers[i].srcAccessMask, dstStageMask,
+		    pMemoryBarriers[i].dstAccessMask, 0, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_UNDEFINED);
+	for (i = 0; i < bufferMemoryBarrierCount; ++i)
+		mockLogBarrier(MOCK_COMMAND_BUFFER_BARRIER, 1, dependencyFlags, srcStageMask, pBufferMemoryBarriers[i].srcAccessMask, dstStageMask,
+		    pBufferMemoryBarriers[i].dstAccessMask, (uint64_t)(uintptr_t)pBufferMemoryBarriers[i].buffer, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_UNDEFINED);
+	for (i = 0; i < imageMemoryBarrierCount; ++i)
+		mockLogBarrier(MOCK_COMMAND_IMAGE_BARRIER, 1, dependencyFlags, srcStageMask, pImageMemoryBarriers[i].srcAccessMask, dstStageMask,
+		    pImageMemoryBarriers[i].dstAccessMask, (uint64_t)(uintptr_t)pImageMemoryBarriers[i].image, pImageMemoryBarriers[i].oldLayout,
+		    pImageMemoryBarriers[i].newLayout);
+	mockBarrierCommandCount++;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkCmdPipelineBarrier2(VkCommandBuffer commandBuffer, const VkDependencyInfo* pDependencyInfo)
+{
+	uint32_t i;
+
+	MOCK_CALL(vkCmdPipelineBarrier2);
+	for (i = 0; i < pDependencyInfo->memoryBarrierCount; ++i)
+	{
+		const VkMemoryBarrier2* barrier = &pDependencyInfo->pMemoryBarriers[i];
+		mockLogBarrier(MOCK_COMMAND_MEMORY_BARRIER, 0, pDependencyInfo->dependencyFlags, barrier->srcStageMask, barrier->srcAccessMask, barrier->dstStageMask,
+		    barrier->dstAccessMask, 0, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_UNDEFINED);
+	}
+	for (i = 0; i < pDependencyInfo->bufferMemoryBarrierCount; ++i)
+	{
+		const VkBufferMemoryBarrier2* barrier = &pDependencyInfo->pBufferMemoryBarriers[i];
+		mockLogBarrier(MOCK_COMMAND_BUFFER_BARRIER, 0, pDependencyInfo->dependencyFlags, barrier->srcStageMask, barrier->srcAccessMask, barrier->dstStageMask,
+		    barrier->dstAccessMask, (uint64_t)(uintptr_t)barrier->buffer, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_UNDEFINED);
+	}
+	for (i = 0; i < pDependencyInfo->imageMemoryBarrierCount; ++i)
+	{
+		const VkImageMemoryBarrier2* barrier = &pDependencyInfo->pImageMemoryBarriers[i];
+		mockLogBarrier(MOCK_COMMAND_IMAGE_BARRIER, 0, pDependencyInfo->dependencyFlags, barrier->srcStageMask, barrier->srcAccessMask, barrier->dstStageMask,
+		    barrier->dstAccessMask, (uint64_t)(uintptr_t)barrier->image, barrier->oldLayout, barrier->newLayout);
+	}
+	mockBarrierCommandCount++;
+}
+
+static uint32_t mockSubmitLatency = 0;
+static pthread_mutex_t mockSubmitMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t mockSubmitGate = PTHREAD_COND_INITIALIZER;
+static int mockSubmitGateClosed = 0;
+static MockSubmit mockSubmits[MOCK_SUBMIT_LOG_CAPACITY];
+static uint32_t mockSubmitCount = 0;
+static uint32_t mockUnsignaledWaits = 0;
+
+/* Logs a submit or present and applies its semaphore operations; binary semaphore waits consume the signal */
+static void mockSubmit(VkQueue queue, int present, uint32_t commandBufferCount, VkCommandBuffer commandBuffer, uint32_t waitCount,
+    const VkSemaphore* waits, const VkSemaphoreSubmitInfo* waitInfos, uint32_t signalCount, const VkSemaphore* signals,
+    const VkSemaphoreSubmitInfo* signalInfos, VkFence fence)
+{
+	uint32_t i;
+
+	if (mockSubmitLatency)
+		usleep(mockSubmitLatency);
+
+	pthread_mutex_lock(&mockSubmitMutex);
+	while (mockSubmitGateClosed)
+		pthread_cond_wait(&mockSubmitGate, &mockSubmitMutex);
+	for (i = 0; i < waitCount; ++i)
+	{
+		MockSemaphore* semaphore = MOCK_OBJECT(MockSemaphore, waits ? waits[i] : waitInfos[i].semaphore);
+		if (!semaphore->signaled)
+			mockUnsignaledWaits++;
+		semaphore->signaled = 0;
+	}
+	for (i = 0; i < signalCount; ++i)
+		MOCK_OBJECT(MockSemaphore, signals ? signals[i] : signalInfos[i].semaphore)->signaled = 1;
+
+	if (mockSubmitCount < MOCK_SUBMIT_LOG_CAPACITY)
+	{
+		MockSubmit* submit = &mockSubmits[mockSubmitCount++];
+		submit->queue = queue;
+		submit->present = present;
+		submit->commandBufferCount = commandBufferCount;
+		submit->commandBuffer = commandBuffer;
+		submit->fence = fence;
+		submit->thread = pthread_self();
+	}
+	pthread_mutex_unlock(&mockSubmitMutex);
+
+	/* work executes at record time, so the fence is signaled right away */
+	if (fence)
+		__atomic_store_n(&MOCK_OBJECT(MockFence, fence)->signaled, 1, __ATOMIC_RELEASE);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkQueueSubmit(VkQueue queue, uint32_t submitCount, const VkSubmitInfo* pSubmits, VkFence fence)
+{
+	uint32_t i;
+
+	MOCK_CALL(vkQueueSubmit);
+	for (i = 0; i < submitCount; ++i)
+		mockSubmit(queue, 0, pSubmits[i].commandBufferCount, pSubmits[i].commandBufferCount ? pSubmits[i].pCommandBuffers[0] : NULL,
+		    pSubmits[i].waitSemaphoreCount, pSubmits[i].pWaitSemaphores, NULL, pSubmits[i].signalSemaphoreCount, pSubmits[i].pSignalSemaphores, NULL,
+		    i + 1 == submitCount ? fence : VK_NULL_HANDLE);
+	if (!submitCount)
+		mockSubmit(queue, 0, 0, NULL, 0, NULL, NULL, 0, NULL, NULL, fence);
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkQueueSubmit2(VkQueue queue, uint32_t submitCount, const VkSubmitInfo2* pSubmits, VkFence fence)
+{
+	uint32_t i;
+
+	MOCK_CALL(vkQueueSubmit2);
+	for (i = 0; i < submitCount; ++i)
+		mockSubmit(queue, 0, pSubmits[i].commandBufferInfoCount, pSubmits[i].commandBufferInfoCount ? pSubmits[i].pCommandBufferInfos[0].commandBuffer : NULL,
+		    pSubmits[i].waitSemaphoreInfoCount, NULL, pSubmits[i].pWaitSemaphoreInfos, pSubmits[i].signalSemaphoreInfoCount, NULL, pSubmits[i].pSignalSemaphoreInfos,
+		    i + 1 == submitCount ? fence : VK_NULL_HANDLE);
+	if (!submitCount)
+		mockSubmit(queue, 0, 0, NULL, 0, NULL, NULL, 0, NULL, NULL, fence);
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkQueuePresentKHR(VkQueue queue, const VkPresentInfoKHR* pPresentInfo)
+{
+	MOCK_CALL(vkQueuePresentKHR);
+	mockSubmit(queue, 1, 0, NULL, pPresentInfo->waitSemaphoreCount, pPresentInfo->pWaitSemaphores, NULL, 0, NULL, NULL, VK_NULL_HANDLE);
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkQueueWaitIdle(VkQueue queue)
+{
+	MOCK_CALL(vkQueueWaitIdle);
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkDeviceWaitIdle(VkDevice device)
+{
+	MOCK_CALL(vkDeviceWaitIdle);
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkAllocateMemory(VkDevice device, const VkMemoryAllocateInfo* pAllocateInfo, const VkAllocationCallbacks* pAllocator, VkDeviceMemory* pMemory)
+{
+	/* the size is kept in front of the mapped data for the heap usage of VK_EXT_memory_budget */
+	VkDeviceSize* memory = (VkDeviceSize*)calloc(1, (size_t)pAllocateInfo->allocationSize + MOCK_MEMORY_HEADER_SIZE);
+	MOCK_CALL(vkAllocateMemory);
+	if (!memory)
+		return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+	memory[0] = pAllocateInfo->allocationSize;
+	memory[1] = pAllocateInfo->memoryTypeIndex;
+	mockHeapUsage[pAllocateInfo->memoryTypeIndex] += pAllocateInfo->allocationSize;
+	*pMemory = MOCK_HANDLE(VkDeviceMemory, (char*)memory + MOCK_MEMORY_HEADER_SIZE);
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkFreeMemory(VkDevice device, VkDeviceMemory memory, const VkAllocationCallbacks* pAllocator)
+{
+	VkDeviceSize* header = memory ? (VkDeviceSize*)(MOCK_OBJECT(char, memory) - MOCK_MEMORY_HEADER_SIZE) : NULL;
+	MOCK_CALL(vkFreeMemory);
+	if (header)
+		mockHeapUsage[header[1]] -= header[0];
+	free(header);
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkGetDeviceMemoryCommitment(VkDevice device, VkDeviceMemory memory, VkDeviceSize* pCommittedMemoryInBytes)
+{
+	MOCK_CALL(vkGetDeviceMemoryCommitment);
+	*pCommittedMemoryInBytes = *(VkDeviceSize*)(MOCK_OBJECT(char, memory) - MOCK_MEMORY_HEADER_SIZE);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkMapMemory(VkDevice device, VkDeviceMemory memory, VkDeviceSize offset, VkDeviceSize size, VkMemoryMapFlags flags, void** ppData)
+{
+	MOCK_CALL(vkMapMemory);
+	*ppData = MOCK_OBJECT(char, memory) + offset;
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkUnmapMemory(VkDevice device, VkDeviceMemory memory)
+{
+	MOCK_CALL(vkUnmapMemory);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkMapMemory2(VkDevice device, const VkMemoryMapInfo* pMemoryMapInfo, void** ppData)
+{
+	MOCK_CALL(vkMapMemory2);
+	*ppData = MOCK_OBJECT(char, pMemoryMapInfo->memory) + pMemoryMapInfo->offset;
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkUnmapMemory2(VkDevice device, const VkMemoryUnmapInfo* pMemoryUnmapInfo)
+{
+	MOCK_CALL(vkUnmapMemory2);
+	return VK_SUCCESS;
+}
+
+static pthread_mutex_t mockRangeMutex = PTHREAD_MUTEX_INITIALIZER;
+static MockMappedRange mockRanges[MOCK_RANGE_LOG_CAPACITY];
+static uint32_t mockRangeCount = 0;
+
+static void mockLogRanges(int invalidate, uint32_t memoryRangeCount, const VkMappedMemoryRange* pMemoryRanges)
+{
+	uint32_t i;
+
+	pthread_mutex_lock(&mockRangeMutex);
+	for (i = 0; i < memoryRangeCount && mockRangeCount < MOCK_RANGE_LOG_CAPACITY; ++i)
+	{
+		MockMappedRange* range = &mockRanges[mockRangeCount++];
+		range->invalidate = invalidate;
+		range->memory = pMemoryRanges[i].memory;
+		range->offset = pMemoryRanges[i].offset;
+		range->size = pMemoryRanges[i].size;
+	}
+	pthread_mutex_unlock(&mockRangeMutex);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkFlushMappedMemoryRanges(VkDevice device, uint32_t memoryRangeCount, const VkMappedMemoryRange* pMemoryRanges)
+{
+	MOCK_CALL(vkFlushMappedMemoryRanges);
+	mockLogRanges(0, memoryRangeCount, pMemoryRanges);
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkInvalidateMappedMemoryRanges(VkDevice device, uint32_t memoryRangeCount, const VkMappedMemoryRange* pMemoryRanges)
+{
+	MOCK_CALL(vkInvalidateMappedMemoryRanges);
+	mockLogRanges(1, memoryRangeCount, pMemoryRanges);
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkCmdBindPipeline(VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipeline pipeline)
+{
+	MOCK_CALL(vkCmdBindPipeline);
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkCmdBindIndexBuffer(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkIndexType indexType)
+{
+	MOCK_CALL(vkCmdBindIndexBuffer);
+}
+
+static VkDescriptorSet mockBoundDescriptorSets[MOCK_BOUND_DESCRIPTOR_SETS];
+static uint32_t mockBoundDescriptorSetCount;
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkCmdBindDescriptorSets(VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout, uint32_t firstSet, uint32_t descriptorSetCount, const VkDescriptorSet* pDescriptorSets, uint32_t dynamicOffsetCount, const uint32_t* pDynamicOffsets)
+{
+	MOCK_CALL(vkCmdBindDescriptorSets);
+	mockBoundDescriptorSetCount = descriptorSetCount < MOCK_BOUND_DESCRIPTOR_SETS ? descriptorSetCount : MOCK_BOUND_DESCRIPTOR_SETS;
+	memcpy(mockBoundDescriptorSets, pDescriptorSets, mockBoundDescriptorSetCount * sizeof(VkDescriptorSet));
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkCmdBindVertexBuffers(VkCommandBuffer commandBuffer, uint32_t firstBinding, uint32_t bindingCount, const VkBuffer* pBuffers, const VkDeviceSize* pOffsets)
+{
+	MOCK_CALL(vkCmdBindVertexBuffers);
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkCmdSetViewport(VkCommandBuffer commandBuffer, uint32_t firstViewport, uint32_t viewportCount, const VkViewport* pViewports)
+{
+	MOCK_CALL(vkCmdSetViewport);
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkCmdSetScissor(VkCommandBuffer commandBuffer, uint32_t firstScissor, uint32_t scissorCount, const VkRect2D* pScissors)
+{
+	MOCK_CALL(vkCmdSetScissor);
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkCmdSetLineWidth(VkCommandBuffer commandBuffer, float lineWidth)
+{
+	MOCK_CALL(vkCmdSetLineWidth);
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkCmdPushConstants(VkCommandBuffer commandBuffer, VkPipelineLayout layout, VkShaderStageFlags stageFlags, uint32_t offset, uint32_t size, const void* pValues)
+{
+	MockCommand* command;
+
+	MOCK_CALL(vkCmdPushConstants);
+	command = mockLogCommand(MOCK_COMMAND_PUSH_CONSTANTS, 0);
+	if (!command)
+		return;
+	command->first = offset;
+	command->count = size;
+	memcpy(&command->data, pValues, size < sizeof(command->data) ? size : sizeof(command->data));
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkCmdExecuteCommands(VkCommandBuffer commandBuffer, uint32_t commandBufferCount, const VkCommandBuffer* pCommandBuffers)
+{
+	MOCK_CALL(vkCmdExecuteCommands);
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkGetPhysicalDeviceQueueFamilyProperties(VkPhysicalDevice physicalDevice, uint32_t* pQueueFamilyPropertyCount, VkQueueFamilyProperties* pQueueFamilyProperties)
+{
+	MOCK_CALL(vkGetPhysicalDeviceQueueFamilyProperties);
+	if (pQueueFamilyProperties && *pQueueFamilyPropertyCount)
+	{
+		memset(pQueueFamilyProperties, 0, sizeof(*pQueueFamilyProperties));
+		pQueueFamilyProperties->queueFlags = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT;
+		pQueueFamilyProperties->queueCount = MOCK_QUEUE_COUNT;
+		pQueueFamilyProperties->timestampValidBits = 64;
+	}
+	*pQueueFamilyPropertyCount = 1;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkGetPhysicalDeviceCalibrateableTimeDomainsKHR(VkPhysicalDevice physicalDevice, uint32_t* pTimeDomainCount, VkTimeDomainKHR* pTimeDomains)
+{
+	MOCK_CALL(vkGetPhysicalDeviceCalibrateableTimeDomainsKHR);
+	if (pTimeDomains && *pTimeDomainCount >= 2)
+	{
+		pTimeDomains[0] = VK_TIME_DOMAIN_DEVICE_KHR;
+		pTimeDomains[1] = VK_TIME_DOMAIN_CLOCK_MONOTONIC_KHR;
+	}
+	*pTimeDomainCount = 2;
+	return VK_SUCCESS;
+}
+
+/* the host clock runs MOCK_CALIBRATION_OFFSET ticks ahead of the device clock */
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkGetCalibratedTimestampsKHR(VkDevice device, uint32_t timestampCount, const VkCalibratedTimestampInfoKHR* pTimestampInfos, uint64_t* pTimestamps, uint64_t* pMaxDeviation)
+{
+	uint32_t i;
+	MOCK_CALL(vkGetCalibratedTimestampsKHR);
+	for (i = 0; i < timestampCount; ++i)
+		pTimestamps[i] = pTimestampInfos[i].timeDomain == VK_TIME_DOMAIN_DEVICE_KHR ? mockClock : mockClock + MOCK_CALIBRATION_OFFSET;
+	*pMaxDeviation = 0;
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkCreateCommandPool(VkDevice device, const VkCommandPoolCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkCommandPool* pCommandPool)
+{
+	MOCK_CALL(vkCreateCommandPool);
+	*pCommandPool = MOCK_HANDLE(VkCommandPool, MOCK_NEXT_HANDLE());
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkDestroyCommandPool(VkDevice device, VkCommandPool commandPool, const VkAllocationCallbacks* pAllocator)
+{
+	MOCK_CALL(vkDestroyCommandPool);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkResetCommandPool(VkDevice device, VkCommandPool commandPool, VkCommandPoolResetFlags flags)
+{
+	MOCK_CALL(vkResetCommandPool);
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkFreeCommandBuffers(VkDevice device, VkCommandPool commandPool, uint32_t commandBufferCount, const VkCommandBuffer* pCommandBuffers)
+{
+	MOCK_CALL(vkFreeCommandBuffers);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkResetCommandBuffer(VkCommandBuffer commandBuffer, VkCommandBufferResetFlags flags)
+{
+	MOCK_CALL(vkResetCommandBuffer);
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkCreateFence(VkDevice device, const VkFenceCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkFence* pFence)
+{
+	MockFence* fence = (MockFence*)mockAllocate(pAllocator, sizeof(MockFence), VK_SYSTEM_ALLOCATION_SCOPE_OBJECT);
+	MOCK_CALL(vkCreateFence);
+	if (!fence)
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	fence->signaled = (pCreateInfo->flags & VK_FENCE_CREATE_SIGNALED_BIT) != 0;
+	*pFence = MOCK_HANDLE(VkFence, fence);
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkDestroyFence(VkDevice device, VkFence fence, const VkAllocationCallbacks* pAllocator)
+{
+	MOCK_CALL(vkDestroyFence);
+	if (fence)
+		mockFree(pAllocator, MOCK_OBJECT(MockFence, fence));
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkGetFenceStatus(VkDevice device, VkFence fence)
+{
+	MOCK_CALL(vkGetFenceStatus);
+	return __atomic_load_n(&MOCK_OBJECT(MockFence, fence)->signaled, __ATOMIC_ACQUIRE) ? VK_SUCCESS : VK_NOT_READY;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkResetFences(VkDevice device, uint32_t fenceCount, const VkFence* pFences)
+{
+	uint32_t i;
+	MOCK_CALL(vkResetFences);
+	for (i = 0; i < fenceCount; ++i)
+		__atomic_store_n(&MOCK_OBJECT(MockFence, pFences[i])->signaled, 0, __ATOMIC_RELAXED);
+	return VK_SUCCESS;
+}
+
+/* nothing executes later than it is submitted, so fences that are not signaled yet never will be */
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkWaitForFences(VkDevice device, uint32_t fenceCount, const VkFence* pFences, VkBool32 waitAll, uint64_t timeout)
+{
+	uint32_t signaled = 0, i;
+
+	MOCK_CALL(vkWaitForFences);
+	for (i = 0; i < fenceCount; ++i)
+		signaled += __atomic_load_n(&MOCK_OBJECT(MockFence, pFences[i])->signaled, __ATOMIC_ACQUIRE) != 0;
+	return signaled == fenceCount || (!waitAll && signaled) ? VK_SUCCESS : VK_TIMEOUT;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkCreateSemaphore(VkDevice device, const VkSemaphoreCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkSemaphore* pSemaphore)
+{
+	MockSemaphore* semaphore = (MockSemaphore*)mockAllocate(pAllocator, sizeof(MockSemaphore), VK_SYSTEM_ALLOCATION_SCOPE_OBJECT);
+	MOCK_CALL(vkCreateSemaphore);
+	if (!semaphore)
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	semaphore->signaled = 0;
+	*pSemaphore = MOCK_HANDLE(VkSemaphore, semaphore);
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkDestroySemaphore(VkDevice device, VkSemaphore semaphore, const VkAllocationCallbacks* pAllocator)
+{
+	MOCK_CALL(vkDestroySemaphore);
+	if (semaphore)
+		mockFree(pAllocator, MOCK_OBJECT(MockSemaphore, semaphore));
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkSignalSemaphore(VkDevice device, const VkSemaphoreSignalInfo* pSignalInfo)
+{
+	MOCK_CALL(vkSignalSemaphore);
+	MOCK_OBJECT(MockSemaphore, pSignalInfo->semaphore)->signaled = 1;
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkCreateEvent(VkDevice device, const VkEventCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkEvent* pEvent)
+{
+	MockEvent* event = (MockEvent*)mockAllocate(pAllocator, sizeof(MockEvent), VK_SYSTEM_ALLOCATION_SCOPE_OBJECT);
+	MOCK_CALL(vkCreateEvent);
+	if (!event)
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	event->set = 0;
+	*pEvent = MOCK_HANDLE(VkEvent, event);
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkDestroyEvent(VkDevice device, VkEvent event, const VkAllocationCallbacks* pAllocator)
+{
+	MOCK_CALL(vkDestroyEvent);
+	if (event)
+		mockFree(pAllocator, MOCK_OBJECT(MockEvent, event));
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkSetEvent(VkDevice device, VkEvent event)
+{
+	MOCK_CALL(vkSetEvent);
+	MOCK_OBJECT(MockEvent, event)->set = 1;
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkCreateQueryPool(VkDevice device, const VkQueryPoolCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkQueryPool* pQueryPool)
+{
+	MockQueryPool* pool = (MockQueryPool*)calloc(1, sizeof(MockQueryPool));
+	MOCK_CALL(vkCreateQueryPool);
+	pool->queryCount = pCreateInfo->queryCount;
+	pool->values = (uint64_t*)calloc(pCreateInfo->queryCount, sizeof(uint64_t));
+	pool->available = (uint8_t*)calloc(pCreateInfo->queryCount, 1);
+	*pQueryPool = MOCK_HANDLE(VkQueryPool, pool);
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkDestroyQueryPool(VkDevice device, VkQueryPool queryPool, const VkAllocationCallbacks* pAllocator)
+{
+	MockQueryPool* pool = MOCK_OBJECT(MockQueryPool, queryPool);
+	MOCK_CALL(vkDestroyQueryPool);
+	if (pool)
+	{
+		free(pool->values);
+		free(pool->available);
+		free(pool);
+	}
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkGetQueryPoolResults(VkDevice device, VkQueryPool queryPool, uint32_t firstQuery, uint32_t queryCount, size_t dataSize, void* pData, VkDeviceSize stride, VkQueryResultFlags flags)
+{
+	MockQueryPool* pool = MOCK_OBJECT(MockQueryPool, queryPool);
+	VkResult result = VK_SUCCESS;
+	uint32_t i;
+
+	MOCK_CALL(vkGetQueryPoolResults);
+	for (i = 0; i < queryCount; ++i)
+	{
+		uint64_t* data = (uint64_t*)((char*)pData + i * stride);
+		if (pool->available[firstQuery + i])
+			data[0] = pool->values[firstQuery + i];
+		else
+			result = VK_NOT_READY;
+		if (flags & VK_QUERY_RESULT_WITH_AVAILABILITY_BIT)
+			data[1] = pool->available[firstQuery + i];
+	}
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkCmdResetQueryPool(VkCommandBuffer commandBuffer, VkQueryPool queryPool, uint32_t firstQuery, uint32_t queryCount)
+{
+	MockQueryPool* pool = MOCK_OBJECT(MockQueryPool, queryPool);
+	MOCK_CALL(vkCmdResetQueryPool);
+	memset(pool->available + firstQuery, 0, queryCount);
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkCmdWriteTimestamp(VkCommandBuffer commandBuffer, VkPipelineStageFlagBits pipelineStage, VkQueryPool queryPool, uint32_t query)
+{
+	MockQueryPool* pool = MOCK_OBJECT(MockQueryPool, queryPool);
+	MOCK_CALL(vkCmdWriteTimestamp);
+	mockClock += 1000;
+	pool->values[query] = mockClock;
+	pool->available[query] = 1;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkCmdWriteTimestamp2(VkCommandBuffer commandBuffer, VkPipelineStageFlags2 stage, VkQueryPool queryPool, uint32_t query)
+{
+	MockQueryPool* pool = MOCK_OBJECT(MockQueryPool, queryPool);
+	MOCK_CALL(vkCmdWriteTimestamp2);
+	mockClock += 1000;
+	pool->values[query] = mockClock;
+	pool->available[query] = 1;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkCmdBeginRenderPass(VkCommandBuffer commandBuffer, const VkRenderPassBeginInfo* pRenderPassBegin, VkSubpassContents contents)
+{
+	MOCK_CALL(vkCmdBeginRenderPass);
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkCmdEndRenderPass(VkCommandBuffer commandBuffer)
+{
+	MOCK_CALL(vkCmdEndRenderPass);
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkCmdBeginRendering(VkCommandBuffer commandBuffer, const VkRenderingInfo* pRenderingInfo)
+{
+	MOCK_CALL(vkCmdBeginRendering);
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkCmdEndRendering(VkCommandBuffer commandBuffer)
+{
+	MOCK_CALL(vkCmdEndRendering);
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkCmdBeginDebugUtilsLabelEXT(VkCommandBuffer commandBuffer, const VkDebugUtilsLabelEXT* pLabelInfo)
+{
+	MOCK_CALL(vkCmdBeginDebugUtilsLabelEXT);
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkCmdEndDebugUtilsLabelEXT(VkCommandBuffer commandBuffer)
+{
+	MOCK_CALL(vkCmdEndDebugUtilsLabelEXT);
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkQueueInsertDebugUtilsLabelEXT(VkQueue queue, const VkDebugUtilsLabelEXT* pLabelInfo)
+{
+	MOCK_CALL(vkQueueInsertDebugUtilsLabelEXT);
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkCmdDispatchIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset)
+{
+	MOCK_CALL(vkCmdDispatchIndirect);
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkCmdDispatchBase(VkCommandBuffer commandBuffer, uint32_t baseGroupX, uint32_t baseGroupY, uint32_t baseGroupZ, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+{
+	MOCK_CALL(vkCmdDispatchBase);
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkCmdDrawIndirectCount(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkBuffer countBuffer, VkDeviceSize countBufferOffset, uint32_t maxDrawCount, uint32_t stride)
+{
+	MOCK_CALL(vkCmdDrawIndirectCount);
+}
+
+/* KHR aliases of core commands (e.g. vkCmdWriteTimestamp2KHR) resolve to the core implementation */
+/* buffers and images need MOCK_RESOURCE_ALIGNMENT aligned memory; image texels are 4 bytes */
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkCreateBuffer(VkDevice device, const VkBufferCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkBuffer* pBuffer)
+{
+	MockResource* buffer = (MockResource*)calloc(1, sizeof(MockResource));
+	MOCK_CALL(vkCreateBuffer);
+	if (!buffer)
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	buffer->size = pCreateInfo->size;
+	*pBuffer = MOCK_HANDLE(VkBuffer, buffer);
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkDestroyBuffer(VkDevice device, VkBuffer buffer, const VkAllocationCallbacks* pAllocator)
+{
+	MOCK_CALL(vkDestroyBuffer);
+	free(MOCK_OBJECT(MockResource, buffer));
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkGetBufferMemoryRequirements(VkDevice device, VkBuffer buffer, VkMemoryRequirements* pMemoryRequirements)
+{
+	MOCK_CALL(vkGetBufferMemoryRequirements);
+	pMemoryRequirements->size = (MOCK_OBJECT(MockResource, buffer)->size + MOCK_RESOURCE_ALIGNMENT - 1) & ~(VkDeviceSize)(MOCK_RESOURCE_ALIGNMENT - 1);
+	pMemoryRequirements->alignment = MOCK_RESOURCE_ALIGNMENT;
+	pMemoryRequirements->memoryTypeBits = 3;
+}
+
+static void mockBind(MockResource* resource, VkDeviceMemory memory, VkDeviceSize memoryOffset)
+{
+	/* the memory has to be an allocation of the mock, large enough for the resource */
+	VkDeviceSize allocationSize = *(VkDeviceSize*)(MOCK_OBJECT(char, memory) - MOCK_MEMORY_HEADER_SIZE);
+
+	if (memoryOffset + resource->size > allocationSize)
+		abort();
+	resource->memory = memory;
+	resource->memoryOffset = memoryOffset;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkBindBufferMemory(VkDevice device, VkBuffer buffer, VkDeviceMemory memory, VkDeviceSize memoryOffset)
+{
+	MOCK_CALL(vkBindBufferMemory);
+	mockBind(MOCK_OBJECT(MockResource, buffer), memory, memoryOffset);
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkBindBufferMemory2(VkDevice device, uint32_t bindInfoCount, const VkBindBufferMemoryInfo* pBindInfos)
+{
+	uint32_t i;
+
+	MOCK_CALL(vkBindBufferMemory2);
+	for (i = 0; i < bindInfoCount; ++i)
+		mockBind(MOCK_OBJECT(MockResource, pBindInfos[i].buffer), pBindInfos[i].memory, pBindInfos[i].memoryOffset);
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkCreateImage(VkDevice device, const VkImageCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkImage* pImage)
+{
+	MockResource* image = (MockResource*)calloc(1, sizeof(MockResource));
+	MOCK_CALL(vkCreateImage);
+	if (!image)
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	image->size = (VkDeviceSize)pCreateInfo->extent.width * pCreateInfo->extent.height * pCreateInfo->extent.depth * 4;
+	*pImage = MOCK_HANDLE(VkImage, image);
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkDestroyImage(VkDevice device, VkImage image, const VkAllocationCallbacks* pAllocator)
+{
+	MOCK_CALL(vkDestroyImage);
+	free(MOCK_OBJECT(MockResource, image));
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkGetImageMemoryRequirements(VkDevice device, VkImage image, VkMemoryRequirements* pMemoryRequirements)
+{
+	MOCK_CALL(vkGetImageMemoryRequirements);
+	pMemoryRequirements->size = (MOCK_OBJECT(MockResource, image)->size + MOCK_RESOURCE_ALIGNMENT - 1) & ~(VkDeviceSize)(MOCK_RESOURCE_ALIGNMENT - 1);
+	pMemoryRequirements->alignment = MOCK_RESOURCE_ALIGNMENT;
+	pMemoryRequirements->memoryTypeBits = 1;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkBindImageMemory(VkDevice device, VkImage image, VkDeviceMemory memory, VkDeviceSize memoryOffset)
+{
+	MOCK_CALL(vkBindImageMemory);
+	mockBind(MOCK_OBJECT(MockResource, image), memory, memoryOffset);
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkBindImageMemory2(VkDevice device, uint32_t bindInfoCount, const VkBindImageMemoryInfo* pBindInfos)
+{
+	uint32_t i;
+
+	MOCK_CALL(vkBindImageMemory2);
+	for (i = 0; i < bindInfoCount; ++i)
+		mockBind(MOCK_OBJECT(MockResource, pBindInfos[i].image), pBindInfos[i].memory, pBindInfos[i].memoryOffset);
+	return VK_SUCCESS;
+}
+
+/* Sparse resources record the memory of the first range of their first bind */
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkQueueBindSparse(VkQueue queue, uint32_t bindInfoCount, const VkBindSparseInfo* pBindInfo, VkFence fence)
+{
+	uint32_t i, j;
+
+	MOCK_CALL(vkQueueBindSparse);
+	for (i = 0; i < bindInfoCount; ++i)
+	{
+		for (j = 0; j < pBindInfo[i].bufferBindCount; ++j)
+			if (pBindInfo[i].pBufferBinds[j].bindCount)
+			{
+				MockResource* buffer = MOCK_OBJECT(MockResource, pBindInfo[i].pBufferBinds[j].buffer);
+				const VkSparseMemoryBind* bind = &pBindInfo[i].pBufferBinds[j].pBinds[0];
+
+				buffer->memory = bind->memory;
+				buffer->memoryOffset = bind->memoryOffset;
+			}
+		for (j = 0; j < pBindInfo[i].imageOpaqueBindCount; ++j)
+			if (pBindInfo[i].pImageOpaqueBinds[j].bindCount)
+			{
+				MockResource* image = MOCK_OBJECT(MockResource, pBindInfo[i].pImageOpaqueBinds[j].image);
+				const VkSparseMemoryBind* bind = &pBindInfo[i].pImageOpaqueBinds[j].pBinds[0];
+
+				image->memory = bind->memory;
+				image->memoryOffset = bind->memoryOffset;
+			}
+	}
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkCreateImageView(VkDevice device, const VkImageViewCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkImageView* pView)
+{
+	MOCK_CALL(vkCreateImageView);
+	*pView = MOCK_HANDLE(VkImageView, MOCK_NEXT_HANDLE());
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkDestroyImageView(VkDevice device, VkImageView imageView, const VkAllocationCallbacks* pAllocator)
+{
+	MOCK_CALL(vkDestroyImageView);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkCreateRenderPass(VkDevice device, const VkRenderPassCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkRenderPass* pRenderPass)
+{
+	MOCK_CALL(vkCreateRenderPass);
+	*pRenderPass = MOCK_HANDLE(VkRenderPass, MOCK_NEXT_HANDLE());
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkDestroyRenderPass(VkDevice device, VkRenderPass renderPass, const VkAllocationCallbacks* pAllocator)
+{
+	MOCK_CALL(vkDestroyRenderPass);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkCreateFramebuffer(VkDevice device, const VkFramebufferCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkFramebuffer* pFramebuffer)
+{
+	MOCK_CALL(vkCreateFramebuffer);
+	*pFramebuffer = MOCK_HANDLE(VkFramebuffer, MOCK_NEXT_HANDLE());
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkDestroyFramebuffer(VkDevice device, VkFramebuffer framebuffer, const VkAllocationCallbacks* pAllocator)
+{
+	MOCK_CALL(vkDestroyFramebuffer);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkTransitionImageLayout(VkDevice device, uint32_t transitionCount, const VkHostImageLayoutTransitionInfo* pTransitions)
+{
+	MOCK_CALL(vkTransitionImageLayout);
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkCreateShaderModule(VkDevice device, const VkShaderModuleCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkShaderModule* pShaderModule)
+{
+	MOCK_CALL(vkCreateShaderModule);
+	*pShaderModule = MOCK_HANDLE(VkShaderModule, MOCK_NEXT_HANDLE());
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkDestroyShaderModule(VkDevice device, VkShaderModule shaderModule, const VkAllocationCallbacks* pAllocator)
+{
+	MOCK_CALL(vkDestroyShaderModule);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkCreateSampler(VkDevice device, const VkSamplerCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkSampler* pSampler)
+{
+	MOCK_CALL(vkCreateSampler);
+	*pSampler = MOCK_HANDLE(VkSampler, MOCK_NEXT_HANDLE());
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkDestroySampler(VkDevice device, VkSampler sampler, const VkAllocationCallbacks* pAllocator)
+{
+	MOCK_CALL(vkDestroySampler);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkCreateDescriptorSetLayout(VkDevice device, const VkDescriptorSetLayoutCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDescriptorSetLayout* pSetLayout)
+{
+	MOCK_CALL(vkCreateDescriptorSetLayout);
+	*pSetLayout = MOCK_HANDLE(VkDescriptorSetLayout, MOCK_NEXT_HANDLE());
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkDestroyDescriptorSetLayout(VkDevice device, VkDescriptorSetLayout descriptorSetLayout, const VkAllocationCallbacks* pAllocator)
+{
+	MOCK_CALL(vkDestroyDescriptorSetLayout);
+}
+
+/* descriptor pools hold up to maxSets sets, and abort on sets that are not theirs */
+#define MOCK_DESCRIPTOR_SET_MAGIC 0x5e75e75eu
+
+typedef struct MockDescriptorSet
+{
+	uint32_t magic;
+	struct MockDescriptorPool* pool;
+	struct MockDescriptorSet* next;
+	struct MockDescriptorSet* prev;
+	uint64_t descriptors[MOCK_DESCRIPTOR_BINDINGS * MOCK_DESCRIPTOR_ELEMENTS];
+} MockDescriptorSet;
+
+typedef struct MockDescriptorPool
+{
+	VkDescriptorPoolCreateFlags flags;
+	uint32_t maxSets;
+	uint32_t setCount;
+	MockDescriptorSet* sets;
+} MockDescriptorPool;
+
+static pthread_mutex_t mockDescriptorMutex = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t mockDescriptorPools;
+
+static void mockFreeDescriptorSet(MockDescriptorSet* set)
+{
+	if (set->prev)
+		set->prev->next = set->next;
+	else
+		set->pool->sets = set->next;
+	if (set->next)
+		set->next->prev = set->prev;
+	set->pool->setCount--;
+	set->magic = 0;
+	free(set);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkCreateDescriptorPool(VkDevice device, const VkDescriptorPoolCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDescriptorPool* pDescriptorPool)
+{
+	MockDescriptorPool* pool = (MockDescriptorPool*)calloc(1, sizeof(MockDescriptorPool));
+	MOCK_CALL(vkCreateDescriptorPool);
+	if (!pool)
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	pool->flags = pCreateInfo->flags;
+	pool->maxSets = pCreateInfo->maxSets;
+	__atomic_add_fetch(&mockDescriptorPools, 1, __ATOMIC_RELAXED);
+	*pDescriptorPool = MOCK_HANDLE(VkDescriptorPool, pool);
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkResetDescriptorPool(VkDevice device, VkDescriptorPool descriptorPool, VkDescriptorPoolResetFlags flags)
+{
+	MockDescriptorPool* pool = MOCK_OBJECT(MockDescriptorPool, descriptorPool);
+	MOCK_CALL(vkResetDescriptorPool);
+	pthread_mutex_lock(&mockDescriptorMutex);
+	while (pool->sets)
+		mockFreeDescriptorSet(pool->sets);
+	pthread_mutex_unlock(&mockDescriptorMutex);
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkDestroyDescriptorPool(VkDevice device, VkDescriptorPool descriptorPool, const VkAllocationCallbacks* pAllocator)
+{
+	MOCK_CALL(vkDestroyDescriptorPool);
+	if (!descriptorPool)
+		return;
+	pthread_mutex_lock(&mockDescriptorMutex);
+	while (MOCK_OBJECT(MockDescriptorPool, descriptorPool)->sets)
+		mockFreeDescriptorSet(MOCK_OBJECT(MockDescriptorPool, descriptorPool)->sets);
+	pthread_mutex_unlock(&mockDescriptorMutex);
+	__atomic_sub_fetch(&mockDescriptorPools, 1, __ATOMIC_RELAXED);
+	free(MOCK_OBJECT(MockDescriptorPool, descriptorPool));
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkAllocateDescriptorSets(VkDevice device, const VkDescriptorSetAllocateInfo* pAllocateInfo, VkDescriptorSet* pDescriptorSets)
+{
+	MockDescriptorPool* pool = MOCK_OBJECT(MockDescriptorPool, pAllocateInfo->descriptorPool);
+	MockDescriptorSet* set;
+	VkResult result = VK_SUCCESS;
+	uint32_t i;
+
+	MOCK_CALL(vkAllocateDescriptorSets);
+	pthread_mutex_lock(&mockDescriptorMutex);
+	if (pool->setCount + pAllocateInfo->descriptorSetCount > pool->maxSets)
+		result = VK_ERROR_OUT_OF_POOL_MEMORY;
+	for (i = 0; result == VK_SUCCESS && i < pAllocateInfo->descriptorSetCount; ++i)
+	{
+		set = (MockDescriptorSet*)calloc(1, sizeof(MockDescriptorSet));
+		if (!set)
+		{
+			while (i--)
+				mockFreeDescriptorSet(MOCK_OBJECT(MockDescriptorSet, pDescriptorSets[i]));
+			result = VK_ERROR_OUT_OF_HOST_MEMORY;
+			break;
+		}
+		set->magic = MOCK_DESCRIPTOR_SET_MAGIC;
+		set->pool = pool;
+		set->next = pool->sets;
+		if (pool->sets)
+			pool->sets->prev = set;
+		pool->sets = set;
+		pool->setCount++;
+		pDescriptorSets[i] = MOCK_HANDLE(VkDescriptorSet, set);
+	}
+	pthread_mutex_unlock(&mockDescriptorMutex);
+	return result;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkFreeDescriptorSets(VkDevice device, VkDescriptorPool descriptorPool, uint32_t descriptorSetCount, const VkDescriptorSet* pDescriptorSets)
+{
+	MockDescriptorPool* pool = MOCK_OBJECT(MockDescriptorPool, descriptorPool);
+	uint32_t i;
+
+	MOCK_CALL(vkFreeDescriptorSets);
+	if (!(pool->flags & VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT))
+		abort();
+	pthread_mutex_lock(&mockDescriptorMutex);
+	for (i = 0; i < descriptorSetCount; ++i)
+		if (pDescriptorSets[i])
+		{
+			if (MOCK_OBJECT(MockDescriptorSet, pDescriptorSets[i])->pool != pool)
+				abort();
+			mockFreeDescriptorSet(MOCK_OBJECT(MockDescriptorSet, pDescriptorSets[i]));
+		}
+	pthread_mutex_unlock(&mockDescriptorMutex);
+	return VK_SUCCESS;
+}
+
+/* Updates abort on handles that are not sets of the mock */
+static uint64_t* mockDescriptorSlot(VkDescriptorSet descriptorSet, uint32_t binding, uint32_t arrayElement)
+{
+	MockDescriptorSet* set = MOCK_OBJECT(MockDescriptorSet, descriptorSet);
+
+	if (!set || set->magic != MOCK_DESCRIPTOR_SET_MAGIC || binding >= MOCK_DESCRIPTOR_BINDINGS || arrayElement >= MOCK_DESCRIPTOR_ELEMENTS)
+		abort();
+	return &set->descriptors[binding * MOCK_DESCRIPTOR_ELEMENTS + arrayElement];
+}
+
+/* Sets keep the buffer, image view, sampler of sampler descriptors or buffer view of every descriptor */
+static void mockWriteDescriptors(VkDescriptorSet descriptorSet, uint32_t binding, uint32_t arrayElement, uint32_t count, VkDescriptorType type, const void* data, size_t stride)
+{
+	uint32_t i;
+
+	for (i = 0; i < count; ++i)
+	{
+		const void* descriptor = (const char*)data + i * stride;
+		uint64_t* slot = mockDescriptorSlot(descriptorSet, binding, arrayElement + i);
+
+		if (type == VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER || type == VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER)
+			*slot = (uint64_t)(uintptr_t)*(const VkBufferView*)descriptor;
+		else if (type >= VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER && type <= VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC)
+			*slot = (uint64_t)(uintptr_t)((const VkDescriptorBufferInfo*)descriptor)->buffer;
+		else if (type == VK_DESCRIPTOR_TYPE_SAMPLER)
+			*slot = (uint64_t)(uintptr_t)((const VkDescriptorImageInfo*)descriptor)->sampler;
+		else
+			*slot = (uint64_t)(uintptr_t)((const VkDescriptorImageInfo*)descriptor)->imageView;
+	}
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkUpdateDescriptorSets(VkDevice device, uint32_t descriptorWriteCount, const VkWriteDescriptorSet* pDescriptorWrites, uint32_t descriptorCopyCount, const VkCopyDescriptorSet* pDescriptorCopies)
+{
+	uint32_t i, j;
+
+	MOCK_CALL(vkUpdateDescriptorSets);
+	pthread_mutex_lock(&mockDescriptorMutex);
+	for (i = 0; i < descriptorWriteCount; ++i)
+	{
+		const VkWriteDescriptorSet* write = &pDescriptorWrites[i];
+
+		if (write->descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER || write->descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER)
+			mockWriteDescriptors(write->dstSet, write->dstBinding, write->dstArrayElement, write->descriptorCount, write->descriptorType, write->pTexelBufferView, sizeof(VkBufferView));
+		else if (write->descriptorType >= VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER && write->descriptorType <= VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC)
+			mockWriteDescriptors(write->dstSet, write->dstBinding, write->dstArrayElement, write->descriptorCount, write->descriptorType, write->pBufferInfo, sizeof(VkDescriptorBufferInfo));
+		else
+			mockWriteDescriptors(write->dstSet, write->dstBinding, write->dstArrayElement, write->descriptorCount, write->descriptorType, write->pImageInfo, sizeof(VkDescriptorImageInfo));
+	}
+	for (i = 0; i < descriptorCopyCount; ++i)
+		for (j = 0; j < pDescriptorCopies[i].descriptorCount; ++j)
+			*mockDescriptorSlot(pDescriptorCopies[i].dstSet, pDescriptorCopies[i].dstBinding, pDescriptorCopies[i].dstArrayElement + j) =
+			    *mockDescriptorSlot(pDescriptorCopies[i].srcSet, pDescriptorCopies[i].srcBinding, pDescriptorCopies[i].srcArrayElement + j);
+	pthread_mutex_unlock(&mockDescriptorMutex);
+}
+
+typedef struct MockDescriptorUpdateTemplate
+{
+	uint32_t entryCount;
+	VkDescriptorUpdateTemplateEntry entries[1];
+} MockDescriptorUpdateTemplate;
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkCreateDescriptorUpdateTemplate(VkDevice device, const VkDescriptorUpdateTemplateCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDescriptorUpdateTemplate* pDescriptorUpdateTemplate)
+{
+	MockDescriptorUpdateTemplate* updateTemplate = (MockDescriptorUpdateTemplate*)malloc(sizeof(MockDescriptorUpdateTemplate) + pCreateInfo->descriptorUpdateEntryCount * sizeof(VkDescriptorUpdateTemplateEntry));
+	MOCK_CALL(vkCreateDescriptorUpdateTemplate);
+	if (!updateTemplate)
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	updateTemplate->entryCount = pCreateInfo->descriptorUpdateEntryCount;
+	memcpy(updateTemplate->entries, pCreateInfo->pDescriptorUpdateEntries, pCreateInfo->descriptorUpdateEntryCount * sizeof(VkDescriptorUpdateTemplateEntry));
+	*pDescriptorUpdateTemplate = MOCK_HANDLE(VkDescriptorUpdateTemplate, updateTemplate);
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkDestroyDescriptorUpdateTemplate(VkDevice device, VkDescriptorUpdateTemplate descriptorUpdateTemplate, const VkAllocationCallbacks* pAllocator)
+{
+	MOCK_CALL(vkDestroyDescriptorUpdateTemplate);
+	free(MOCK_OBJECT(MockDescriptorUpdateTemplate, descriptorUpdateTemplate));
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkUpdateDescriptorSetWithTemplate(VkDevice device, VkDescriptorSet descriptorSet, VkDescriptorUpdateTemplate descriptorUpdateTemplate, const void* pData)
+{
+	MockDescriptorUpdateTemplate* updateTemplate = MOCK_OBJECT(MockDescriptorUpdateTemplate, descriptorUpdateTemplate);
+	uint32_t i;
+
+	MOCK_CALL(vkUpdateDescriptorSetWithTemplate);
+	pthread_mutex_lock(&mockDescriptorMutex);
+	for (i = 0; i < updateTemplate->entryCount; ++i)
+	{
+		const VkDescriptorUpdateTemplateEntry* entry = &updateTemplate->entries[i];
+		mockWriteDescriptors(descriptorSet, entry->dstBinding, entry->dstArrayElement, entry->descriptorCount, entry->descriptorType, (const char*)pData + entry->offset, entry->stride);
+	}
+	pthread_mutex_unlock(&mockDescriptorMutex);
+}
+
+uint64_t mockDescriptor(VkDescriptorSet descriptorSet, uint32_t binding, uint32_t arrayElement)
+{
+	uint64_t descriptor;
+
+	pthread_mutex_lock(&mockDescriptorMutex);
+	descriptor = *mockDescriptorSlot(descriptorSet, binding, arrayElement);
+	pthread_mutex_unlock(&mockDescriptorMutex);
+	return descriptor;
+}
+
+uint32_t mockLastBoundDescriptorSets(const VkDescriptorSet** descriptorSets)
+{
+	*descriptorSets = mockBoundDescriptorSets;
+	return mockBoundDescriptorSetCount;
+}
+
+VkDescriptorPool mockDescriptorSetPool(VkDescriptorSet descriptorSet)
+{
+	return MOCK_HANDLE(VkDescriptorPool, MOCK_OBJECT(MockDescriptorSet, descriptorSet)->pool);
+}
+
+uint32_t mockDescriptorPoolCount(void)
+{
+	return __atomic_load_n(&mockDescriptorPools, __ATOMIC_RELAXED);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkCreatePipelineLayout(VkDevice device, const VkPipelineLayoutCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkPipelineLayout* pPipelineLayout)
+{
+	MOCK_CALL(vkCreatePipelineLayout);
+	*pPipelineLayout = MOCK_HANDLE(VkPipelineLayout, MOCK_NEXT_HANDLE());
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkDestroyPipelineLayout(VkDevice device, VkPipelineLayout pipelineLayout, const VkAllocationCallbacks* pAllocator)
+{
+	MOCK_CALL(vkDestroyPipelineLayout);
+}
+
+typedef struct MockPipelineCache
+{
+	pthread_mutex_t mutex;
+	size_t size;
+	unsigned char* data;
+} MockPipelineCache;
+
+static void mockPipelineCacheAppend(MockPipelineCache* cache, const void* data, size_t size)
+{
+	unsigned char* grown;
+
+	if (!size)
+		return;
+
+	pthread_mutex_lock(&cache->mutex);
+	grown = (unsigned char*)realloc(cache->data, cache->size + size);
+	if (grown)
+	{
+		memcpy(grown + cache->size, data, size);
+		cache->data = grown;
+		cache->size += size;
+	}
+	pthread_mutex_unlock(&cache->mutex);
+}
+
+static int mockPipelineCacheContains(MockPipelineCache* cache, const unsigned char* entry)
+{
+	size_t offset;
+	int found = 0;
+
+	pthread_mutex_lock(&cache->mutex);
+	for (offset = 0; !found && offset + MOCK_PIPELINE_CACHE_ENTRY_SIZE <= cache->size; offset += MOCK_PIPELINE_CACHE_ENTRY_SIZE)
+		found = memcmp(cache->data + offset, entry, MOCK_PIPELINE_CACHE_ENTRY_SIZE) == 0;
+	pthread_mutex_unlock(&cache->mutex);
+	return found;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkCreatePipelineCache(VkDevice device, const VkPipelineCacheCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkPipelineCache* pPipelineCache)
+{
+	MockPipelineCache* cache = (MockPipelineCache*)calloc(1, sizeof(MockPipelineCache));
+	MOCK_CALL(vkCreatePipelineCache);
+	pthread_mutex_init(&cache->mutex, NULL);
+	mockPipelineCacheAppend(cache, pCreateInfo->pInitialData, pCreateInfo->initialDataSize);
+	*pPipelineCache = MOCK_HANDLE(VkPipelineCache, cache);
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkDestroyPipelineCache(VkDevice device, VkPipelineCache pipelineCache, const VkAllocationCallbacks* pAllocator)
+{
+	MockPipelineCache* cache = MOCK_OBJECT(MockPipelineCache, pipelineCache);
+	MOCK_CALL(vkDestroyPipelineCache);
+	if (cache)
+	{
+		pthread_mutex_destroy(&cache->mutex);
+		free(cache->data);
+		free(cache);
+	}
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkGetPipelineCacheData(VkDevice device, VkPipelineCache pipelineCache, size_t* pDataSize, void* pData)
+{
+	MockPipelineCache* cache = MOCK_OBJECT(MockPipelineCache, pipelineCache);
+	VkResult result = VK_SUCCESS;
+
+	MOCK_CALL(vkGetPipelineCacheData);
+	pthread_mutex_lock(&cache->mutex);
+	if (!pData)
+		*pDataSize = cache->size;
+	else
+	{
+		result = *pDataSize < cache->size ? VK_INCOMPLETE : VK_SUCCESS;
+		*pDataSize = *pDataSize < cache->size ? *pDataSize : cache->size;
+		memcpy(pData, cache->data, *pDataSize);
+	}
+	pthread_mutex_unlock(&cache->mutex);
+	return result;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkMergePipelineCaches(VkDevice device, VkPipelineCache dstCache, uint32_t srcCacheCount, const VkPipelineCache* pSrcCaches)
+{
+	uint32_t i;
+
+	MOCK_CALL(vkMergePipelineCaches);
+	for (i = 0; i < srcCacheCount; ++i)
+	{
+		MockPipelineCache* source = MOCK_OBJECT(MockPipelineCache, pSrcCaches[i]);
+		size_t offset;
+
+		/* like a driver, skip the entries the destination already has */
+		pthread_mutex_lock(&source->mutex);
+		for (offset = 0; offset + MOCK_PIPELINE_CACHE_ENTRY_SIZE <= source->size; offset += MOCK_PIPELINE_CACHE_ENTRY_SIZE)
+			if (!mockPipelineCacheContains(MOCK_OBJECT(MockPipelineCache, dstCache), source->data + offset))
+				mockPipelineCacheAppend(MOCK_OBJECT(MockPipelineCache, dstCache), source->data + offset, MOCK_PIPELINE_CACHE_ENTRY_SIZE);
+		pthread_mutex_unlock(&source->mutex);
+	}
+	return VK_SUCCESS;
+}
+
+typedef struct MockPipeline
+{
+	VkShaderModule module;
+} MockPipeline;
+
+static uint32_t mockPipelineCompileTime;
+
+/* Pipelines created with a cache add MOCK_PIPELINE_CACHE_ENTRY_SIZE bytes to it */
+static VkResult mockCreatePipeline(VkPipelineCache pipelineCache, VkPipelineCreateFlags flags, VkShaderModule module, VkPipeline* pPipeline)
+{
+	unsigned char entry[MOCK_PIPELINE_CACHE_ENTRY_SIZE];
+	uint64_t handle = MOCK_NEXT_HANDLE();
+	MockPipeline* pipeline;
+
+	*pPipeline = VK_NULL_HANDLE;
+	if (module == MOCK_SHADER_MODULE_COMPILE_REQUIRED && (flags & VK_PIPELINE_CREATE_FAIL_ON_PIPELINE_COMPILE_REQUIRED_BIT))
+		return VK_PIPELINE_COMPILE_REQUIRED;
+	if (mockPipelineCompileTime)
+		usleep(mockPipelineCompileTime);
+	if (module == MOCK_SHADER_MODULE_INVALID)
+		return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+
+	pipeline = (MockPipeline*)calloc(1, sizeof(MockPipeline));
+	if (!pipeline)
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	pipeline->module = module;
+
+	if (pipelineCache)
+	{
+		memset(entry, 0, sizeof(entry));
+		memcpy(entry, &handle, sizeof(handle));
+		mockPipelineCacheAppend(MOCK_OBJECT(MockPipelineCache, pipelineCache), entry, sizeof(entry));
+	}
+	*pPipeline = MOCK_HANDLE(VkPipeline, pipeline);
+	return VK_SUCCESS;
+}
+
+/* Errors take precedence over VK_PIPELINE_COMPILE_REQUIRED */
+static VkResult mockPipelinesResult(VkResult result, VkResult pipelineResult)
+{
+	if (pipelineResult != VK_SUCCESS && (pipelineResult < 0 ? result >= 0 : result == VK_SUCCESS))
+		return pipelineResult;
+	return result;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkCreateGraphicsPipelines(VkDevice device, VkPipelineCache pipelineCache, uint32_t createInfoCount, const VkGraphicsPipelineCreateInfo* pCreateInfos, const VkAllocationCallbacks* pAllocator, VkPipeline* pPipelines)
+{
+	VkResult result = VK_SUCCESS, pipelineResult = VK_SUCCESS;
+	uint32_t i;
+
+	MOCK_CALL(vkCreateGraphicsPipelines);
+	for (i = 0; i < createInfoCount; ++i)
+	{
+		VkShaderModule module = pCreateInfos[i].stageCount ? pCreateInfos[i].pStages[0].module : VK_NULL_HANDLE;
+		pipelineResult = mockCreatePipeline(pipelineCache, pCreateInfos[i].flags, module, &pPipelines[i]);
+		result = mockPipelinesResult(result, pipelineResult);
+		if (pipelineResult != VK_SUCCESS && (pCreateInfos[i].flags & VK_PIPELINE_CREATE_EARLY_RETURN_ON_FAILURE_BIT))
+			break;
+	}
+	/* pipelines after an early return failure are not attempted */
+	for (; i < createInfoCount; ++i)
+		pPipelines[i] = VK_NULL_HANDLE;
+	return result;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkCreateComputePipelines(VkDevice device, VkPipelineCache pipelineCache, uint32_t createInfoCount, const VkComputePipelineCreateInfo* pCreateInfos, const VkAllocationCallbacks* pAllocator, VkPipeline* pPipelines)
+{
+	VkResult result = VK_SUCCESS, pipelineResult = VK_SUCCESS;
+	uint32_t i;
+
+	MOCK_CALL(vkCreateComputePipelines);
+	for (i = 0; i < createInfoCount; ++i)
+	{
+		pipelineResult = mockCreatePipeline(pipelineCache, pCreateInfos[i].flags, pCreateInfos[i].stage.module, &pPipelines[i]);
+		result = mockPipelinesResult(result, pipelineResult);
+		if (pipelineResult != VK_SUCCESS && (pCreateInfos[i].flags & VK_PIPELINE_CREATE_EARLY_RETURN_ON_FAILURE_BIT))
+			break;
+	}
+	for (; i < createInfoCount; ++i)
+		pPipelines[i] = VK_NULL_HANDLE;
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkDestroyPipeline(VkDevice device, VkPipeline pipeline, const VkAllocationCallbacks* pAllocator)
+{
+	MOCK_CALL(vkDestroyPipeline);
+	free(MOCK_OBJECT(MockPipeline, pipeline));
+}
+
+static VkResult mockCreateRayTracingPipeline(VkPipelineCache pipelineCache, const VkRayTracingPipelineCreateInfoKHR* pCreateInfo, VkPipeline* pPipeline)
+{
+	VkShaderModule module = pCreateInfo->stageCount ? pCreateInfo->pStages[0].module : VK_NULL_HANDLE;
+	return mockCreatePipeline(pipelineCache, pCreateInfo->flags, module, pPipeline);
+}
+
+/* Deferred operations split their host work into units, one per pipeline or acceleration structure build,
+ * that joining threads claim one at a time
+ */
+typedef struct MockDeferredOperation
+{
+	pthread_mutex_t mutex;
+	uint32_t unitCount;
+	uint32_t nextUnit;
+	uint32_t completedUnits;
+	uint32_t joiners;
+	VkResult result;
+	VkPipelineCache pipelineCache;
+	const VkRayTracingPipelineCreateInfoKHR* pCreateInfos;
+	VkPipeline* pPipelines;
+} MockDeferredOperation;
+
+static uint32_t mockPeakJoiners;
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkCreateDeferredOperationKHR(VkDevice device, const VkAllocationCallbacks* pAllocator, VkDeferredOperationKHR* pDeferredOperation)
+{
+	MockDeferredOperation* operation = (MockDeferredOperation*)calloc(1, sizeof(MockDeferredOperation));
+	MOCK_CALL(vkCreateDeferredOperationKHR);
+	pthread_mutex_init(&operation->mutex, NULL);
+	*pDeferredOperation = MOCK_HANDLE(VkDeferredOperationKHR, operation);
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL mock_vkDestroyDeferredOperationKHR(VkDevice device, VkDeferredOperationKHR operation, const VkAllocationCallbacks* pAllocator)
+{
+	MockDeferredOperation* deferred = MOCK_OBJECT(MockDeferredOperation, operation);
+	MOCK_CALL(vkDestroyDeferredOperationKHR);
+	if (deferred)
+	{
+		pthread_mutex_destroy(&deferred->mutex);
+		free(deferred);
+	}
+}
+
+static VKAPI_ATTR uint32_t VKAPI_CALL mock_vkGetDeferredOperationMaxConcurrencyKHR(VkDevice device, VkDeferredOperationKHR operation)
+{
+	MockDeferredOperation* deferred = MOCK_OBJECT(MockDeferredOperation, operation);
+	uint32_t concurrency;
+
+	MOCK_CALL(vkGetDeferredOperationMaxConcurrencyKHR);
+	pthread_mutex_lock(&deferred->mutex);
+	concurrency = deferred->unitCount - deferred->nextUnit;
+	pthread_mutex_unlock(&deferred->mutex);
+	return concurrency;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkGetDeferredOperationResultKHR(VkDevice device, VkDeferredOperationKHR operation)
+{
+	MockDeferredOperation* deferred = MOCK_OBJECT(MockDeferredOperation, operation);
+	VkResult result;
+
+	MOCK_CALL(vkGetDeferredOperationResultKHR);
+	pthread_mutex_lock(&deferred->mutex);
+	result = deferred->completedUnits == deferred->unitCount ? deferred->result : VK_NOT_READY;
+	pthread_mutex_unlock(&deferred->mutex);
+	return result;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkDeferredOperationJoinKHR(VkDevice device, VkDeferredOperationKHR operation)
+{
+	MockDeferredOperation* deferred = MOCK_OBJECT(MockDeferredOperation, operation);
+	VkResult result;
+	uint32_t unit;
+
+	MOCK_CALL(vkDeferredOperationJoinKHR);
+	pthread_mutex_lock(&deferred->mutex);
+	deferred->joiners++;
+	mockPeakJoiners = deferred->joiners > mockPeakJoiners ? deferred->joiners : mockPeakJoiners;
+	while (deferred->nextUnit < deferred->unitCount)
+	{
+		unit = deferred->nextUnit++;
+		pthread_mutex_unlock(&deferred->mutex);
+		if (deferred->pCreateInfos)
+			result = mockCreateRayTracingPipeline(deferred->pipelineCache, &deferred->pCreateInfos[unit], &deferred->pPipelines[unit]);
+		else
+		{
+			result = VK_SUCCESS;
+			if (mockPipelineCompileTime)
+				usleep(mockPipelineCompileTime);
+		}
+		pthread_mutex_lock(&deferred->mutex);
+		deferred->result = mockPipelinesResult(deferred->result, result);
+		deferred->completedUnits++;
+	}
+	deferred->joiners--;
+	result = deferred->completedUnits == deferred->unitCount ? VK_SUCCESS : VK_THREAD_DONE_KHR;
+	pthread_mutex_unlock(&deferred->mutex);
+	return result;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkCreateRayTracingPipelinesKHR(VkDevice device, VkDeferredOperationKHR deferredOperation, VkPipelineCache pipelineCache, uint32_t createInfoCount, const VkRayTracingPipelineCreateInfoKHR* pCreateInfos, const VkAllocationCallbacks* pAllocator, VkPipeline* pPipelines)
+{
+	MockDeferredOperation* deferred = MOCK_OBJECT(MockDeferredOperation, deferredOperation);
+	VkResult result = VK_SUCCESS;
+	uint32_t i;
+
+	MOCK_CALL(vkCreateRayTracingPipelinesKHR);
+	if (!deferred)
+	{
+		for (i = 0; i < createInfoCount; ++i)
+			result = mockPipelinesResult(result, mockCreateRayTracingPipeline(pipelineCache, &pCreateInfos[i], &pPipelines[i]));
+		return result;
+	}
+
+	deferred->unitCount = createInfoCount;
+	deferred->pipelineCache = pipelineCache;
+	deferred->pCreateInfos = pCreateInfos;
+	deferred->pPipelines = pPipelines;
+	return createInfoCount ? VK_OPERATION_DEFERRED_KHR : VK_OPERATION_NOT_DEFERRED_KHR;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL mock_vkBuildAccelerationStructuresKHR(VkDevice device, VkDeferredOperationKHR deferredOperation, uint32_t infoCount, const VkAccelerationStructureBuildGeometryInfoKHR* pInfos, const VkAccelerationStructureBuildRangeInfoKHR* const* ppBuildRangeInfos)
+{
+	MockDeferredOperation* deferred = MOCK_OBJECT(MockDeferredOperation, deferredOperation);
+	uint32_t i;
+
+	MOCK_CALL(vkBuildAccelerationStructuresKHR);
+	if (!deferred)
+	{
+		for (i = 0; i < infoCount && mockPipelineCompileTime; ++i)
+			usleep(mockPipelineCompileTime);
+		return VK_SUCCESS;
+	}
+
+	deferred->unitCount = infoCount;
+	return infoCount ? VK_OPERATION_DEFERRED_KHR : VK_OPERATION_NOT_DEFERRED_KHR;
+}
+
+static int mockExecuteRecordedCommands = 0;
+static void* mockRecordedCommands = NULL;
+static size_t mockRecordedCommandsSize = 0;
+
+static VKAPI_ATTR void VKAPI_CALL mock_vilcCmdExecuteRecordedCommands(VkCommandBuffer commandBuffer, const void* pStream, size_t size)
+{
+	MOCK_CALL(vilcCmdExecuteRecordedCommands);
+	free(mockRecordedCommands);
+	mockRecordedCommands = malloc(size);
+	mockRecordedCommandsSize = mockRecordedCommands ? size : 0;
+	if (mockRecordedCommands)
+		memcpy(mockRecordedCommands, pStream, size);
+}
+
+static PFN_vkVoidFunction mockLookup(const char* pName)
+{
+	size_t length = strlen(pName);
+
+	if (!mockExecuteRecordedCommands && strcmp(pName, "vilcCmdExecuteRecordedCommands") == 0)
+		return NULL;
+
+#define MOCK_LOOKUP(name) \
+	if (strcmp(pName, #name) == 0 || (length == sizeof(#name) + 2 && strncmp(pName, #name, length - 3) == 0 && strcmp(pName + length - 3, "KHR") == 0)) \
+		return (PFN_vkVoidFunction)mock_##name;
+	MOCK_COMMANDS(MOCK_LOOKUP)
+#undef MOCK_LOOKUP
+	return NULL;
+}
+
+static VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL mock_vkGetDeviceProcAddr(VkDevice device, const char* pName)
+{
+	return mockLookup(pName);
+}
+
+PFN_vkVoidFunction vk_icdGetInstanceProcAddr(VkInstance instance, const char* pName)
+{
+	return mockLookup(pName);
+}
+
+uint32_t mockCallCount(const char* name)
+{
+	uint32_t i;
+	for (i = 0; i < MOCK_COMMAND_COUNT; ++i)
+		if (strcmp(mockNames[i], name) == 0)
+			return mockCalls[i];
+	return 0;
+}
+
+void mockResetCallCounts(void)
+{
+	memset(mockCalls, 0, sizeof(mockCalls));
+}
+
+uint32_t mockCommandLog(const MockCommand** commands)
+{
+	*commands = mockCommands;
+	return mockCommandCount;
+}
+
+void mockResetCommandLog(void)
+{
+	mockCommandCount = 0;
+	mockBarrierCommandCount = 0;
+	mockDrawCommandCount = 0;
+}
+
+void mockSetPipelineCompileTime(uint32_t microseconds)
+{
+	mockPipelineCompileTime = microseconds;
+}
+
+VkShaderModule mockPipelineShaderModule(VkPipeline pipeline)
+{
+	return MOCK_OBJECT(MockPipeline, pipeline)->module;
+}
+
+VkDeviceMemory mockBufferMemory(VkBuffer buffer, VkDeviceSize* memoryOffset)
+{
+	*memoryOffset = MOCK_OBJECT(MockResource, buffer)->memoryOffset;
+	return MOCK_OBJECT(MockResource, buffer)->memory;
+}
+
+VkDeviceMemory mockImageMemory(VkImage image, VkDeviceSize* memoryOffset)
+{
+	*memoryOffset = MOCK_OBJECT(MockResource, image)->memoryOffset;
+	return MOCK_OBJECT(MockResource, image)->memory;
+}
+
+uint32_t mockDeferredOperationPeakJoiners(void)
+{
+	return mockPeakJoiners;
+}
+
+void mockSetSubmitLatency(uint32_t microseconds)
+{
+	mockSubmitLatency = microseconds;
+}
+
+void mockSetSubmitGate(int closed)
+{
+	pthread_mutex_lock(&mockSubmitMutex);
+	mockSubmitGateClosed = closed;
+	pthread_cond_broadcast(&mockSubmitGate);
+	pthread_mutex_unlock(&mockSubmitMutex);
+}
+
+uint32_t mockSubmitLog(const MockSubmit** submits)
+{
+	uint32_t count;
+
+	pthread_mutex_lock(&mockSubmitMutex);
+	count = mockSubmitCount;
+	pthread_mutex_unlock(&mockSubmitMutex);
+	*submits = mockSubmits;
+	return count;
+}
+
+void mockResetSubmitLog(void)
+{
+	pthread_mutex_lock(&mockSubmitMutex);
+	mockSubmitCount = 0;
+	mockUnsignaledWaits = 0;
+	pthread_mutex_unlock(&mockSubmitMutex);
+}
+
+uint32_t mockUnsignaledSemaphoreWaits(void)
+{
+	uint32_t count;
+
+	pthread_mutex_lock(&mockSubmitMutex);
+	count = mockUnsignaledWaits;
+	pthread_mutex_unlock(&mockSubmitMutex);
+	return count;
+}
+
+void mockSetExecuteRecordedCommands(int enabled)
+{
+	mockExecuteRecordedCommands = enabled;
+}
+
+const void* mockLastRecordedCommands(size_t* size)
+{
+	*size = mockRecordedCommandsSize;
+	return mockRecordedCommands;
+}
+
+void mockSetHostCoherent(int enabled)
+{
+	mockHostCoherent = enabled;
+}
+
+uint32_t mockMappedRangeLog(const MockMappedRange** ranges)
+{
+	uint32_t count;
+
+	pthread_mutex_lock(&mockRangeMutex);
+	count = mockRangeCount;
+	pthread_mutex_unlock(&mockRangeMutex);
+	*ranges = mockRanges;
+	return count;
+}
+
+void mockResetMappedRangeLog(void)
+{
+	pthread_mutex_lock(&mockRangeMutex);
+	mockRangeCount = 0;
+	pthread_mutex_unlock(&mockRangeMutex);
+}
@@ -0,0 +1,175 @@
+/* Minimal ICD that lets the VILC modes run without a GPU.
+ * Commands execute at record time; timestamp queries return a synthetic clock that advances by 1000 ticks per write.
+ */
+#ifndef MOCK_ICD_H_
+#define MOCK_ICD_H_
+
+#include <pthread.h>
+#include <stdio.h>
+#include <vulkan/vulkan_core.h>
+
+/* Checks a condition in the main function of a test; a failed check is printed with its line and fails the test */
+#define CHECK(condition) \
+	if (!(condition)) \
+	{ \
+		printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+		return 1; \
+	}
+
+#define MOCK_CALIBRATION_OFFSET 5000000
+
+/* Host allocations the mock makes through pAllocator */
+#define MOCK_ALLOCATION_ALIGNMENT 64
+#define MOCK_DEVICE_STATE_SIZE 256
+#define MOCK_INTERNAL_ALLOCATION_SIZE 4096
+
+/* Both heaps report this budget through VK_EXT_memory_budget, and this usage on top of the live allocations */
+#define MOCK_HEAP_BUDGET (768ull << 20)
+#define MOCK_HEAP_EXTERNAL_USAGE (64ull << 20)
+#define MOCK_RESOURCE_ALIGNMENT 256
+
+/* Bytes every pipeline adds to the VkPipelineCache it is created with */
+#define MOCK_PIPELINE_CACHE_ENTRY_SIZE 32
+
+/* maxMultiDrawCount reported through VK_EXT_multi_draw */
+#define MOCK_MAX_MULTI_DRAW_COUNT 64
+
+/* Pipelines whose (first) shader stage uses one of these modules fail with VK_ERROR_OUT_OF_DEVICE_MEMORY, or with
+ * VK_PIPELINE_COMPILE_REQUIRED when VK_PIPELINE_CREATE_FAIL_ON_PIPELINE_COMPILE_REQUIRED_BIT is set
+ */
+#define MOCK_SHADER_MODULE_INVALID ((VkShaderModule)(uintptr_t)0xbad0)
+#define MOCK_SHADER_MODULE_COMPILE_REQUIRED ((VkShaderModule)(uintptr_t)0xc0de)
+
+/* Number of times the driver entry point with the given name was called */
+uint32_t mockCallCount(const char* name);
+void mockResetCallCounts(void);
+
+/* Commands the mock logs as they are recorded, for tests that check what reaches the driver. Barriers are logged one
+ * per memory, buffer or image barrier, with the stage masks of the call for vkCmdPipelineBarrier, and barriers recorded
+ * by the same command share its index; dispatches log their groupCountX there. A vkCmdPipelineBarrier without barriers
+ * is logged as a memory barrier without access masks. Draws are logged one per draw, and the draws of a multi draw
+ * command share its index the same way. Push constants log their offset and size as first and count, and their first
+ * four bytes as data.
+ */
+#define MOCK_COMMAND_LOG_CAPACITY 65536
+
+typedef enum MockCommandType
+{
+	MOCK_COMMAND_DISPATCH,
+	MOCK_COMMAND_MEMORY_BARRIER,
+	MOCK_COMMAND_BUFFER_BARRIER,
+	MOCK_COMMAND_IMAGE_BARRIER,
+	MOCK_COMMAND_DRAW,
+	MOCK_COMMAND_DRAW_INDEXED,
+	MOCK_COMMAND_PUSH_CONSTANTS
+} MockCommandType;
+
+typedef struct MockCommand
+{
+	MockCommandType type;
+	uint32_t call;
+	int legacy;
+	VkDependencyFlags dependencyFlags;
+	VkPipelineStageFlags2 srcStageMask;
+	VkAccessFlags2 srcAccessMask;
+	VkPipelineStageFlags2 dstStageMask;
+	VkAccessFlags2 dstAccessMask;
+	/* buffer or image handle, 0 for memory barriers */
+	uint64_t resource;
+	VkImageLayout oldLayout;
+	VkImageLayout newLayout;
+	/* vertex or index count and first vertex or index of draws */
+	uint32_t count;
+	uint32_t instanceCount;
+	uint32_t first;
+	int32_t vertexOffset;
+	uint32_t firstInstance;
+	uint32_t data;
+} MockCommand;
+
+uint32_t mockCommandLog(const MockCommand** commands);
+void mockResetCommandLog(void);
+
+/* vkGetDeviceQueue returns one of this many queues by queueIndex, all in the single queue family */
+#define MOCK_QUEUE_COUNT 4
+
+/* Queue submits, one per VkSubmitInfo(2), and presents in the order they reach the driver, with the thread that made
+ * them. Binary semaphore signals are tracked, and a wait on a semaphore that no earlier submit signaled is counted.
+ */
+#define MOCK_SUBMIT_LOG_CAPACITY 4096
+
+typedef struct MockSubmit
+{
+	VkQueue queue;
+	int present;
+	uint32_t commandBufferCount;
+	/* first command buffer of the submit */
+	VkCommandBuffer commandBuffer;
+	VkFence fence;
+	pthread_t thread;
+} MockSubmit;
+
+uint32_t mockSubmitLog(const MockSubmit** submits);
+void mockResetSubmitLog(void);
+uint32_t mockUnsignaledSemaphoreWaits(void);
+/* Make every submit and present sleep, like a driver validating and patching command buffers; 0 by default */
+void mockSetSubmitLatency(uint32_t microseconds);
+/* Make every submit and present block before it is logged until the gate is opened again; open by default */
+void mockSetSubmitGate(int closed);
+
+/* Make every pipeline creation and acceleration structure build sleep, like a driver compiling shaders; 0 by default */
+void mockSetPipelineCompileTime(uint32_t microseconds);
+/* Module of the (first) shader stage the pipeline was created with */
+VkShaderModule mockPipelineShaderModule(VkPipeline pipeline);
+/* Most threads seen in vkDeferredOperationJoinKHR on one operation at the same time */
+uint32_t mockDeferredOperationPeakJoiners(void);
+
+/* Expose vilcCmdExecuteRecordedCommands to devices created from now on; disabled by default. The stream it was called
+ * with last is kept until the next call.
+ */
+void mockSetExecuteRecordedCommands(int enabled);
+const void* mockLastRecordedCommands(size_t* size);
+
+/* Whether memory type 1 is host-coherent for devices created from now on; enabled by default */
+void mockSetHostCoherent(int enabled);
+
+/* Ranges of vkFlushMappedMemoryRanges and vkInvalidateMappedMemoryRanges in the order they reach the driver */
+#define MOCK_RANGE_LOG_CAPACITY 1024
+
+typedef struct MockMappedRange
+{
+	int invalidate;
+	VkDeviceMemory memory;
+	VkDeviceSize offset;
+	VkDeviceSize size;
+} MockMappedRange;
+
+uint32_t mockMappedRangeLog(const MockMappedRange** ranges);
+void mockResetMappedRangeLog(void);
+
+/* Memory and offset the buffer or image was last bound to. Binds abort unless the memory is an allocation of the mock
+ * that the resource fits into at that offset.
+ */
+VkDeviceMemory mockBufferMemory(VkBuffer buffer, VkDeviceSize* memoryOffset);
+VkDeviceMemory mockImageMemory(VkImage image, VkDeviceSize* memoryOffset);
+
+/* Driver pool the set was allocated from, and the driver pools not destroyed yet. Pools fail allocations past maxSets
+ * with VK_ERROR_OUT_OF_POOL_MEMORY, and frees abort unless the sets are allocations of that pool.
+ */
+VkDescriptorPool mockDescriptorSetPool(VkDescriptorSet descriptorSet);
+uint32_t mockDescriptorPoolCount(void);
+
+/* Handle of the buffer, image view, sampler of sampler descriptors or buffer view the descriptor was last written or
+ * copied with, for bindings and array elements below these. Updates abort on sets that are not allocations of the mock.
+ */
+#define MOCK_DESCRIPTOR_BINDINGS 4
+#define MOCK_DESCRIPTOR_ELEMENTS 4
+
+uint64_t mockDescriptor(VkDescriptorSet descriptorSet, uint32_t binding, uint32_t arrayElement);
+
+/* Sets the last vkCmdBindDescriptorSets bound, up to MOCK_BOUND_DESCRIPTOR_SETS */
+#define MOCK_BOUND_DESCRIPTOR_SETS 8
+
+uint32_t mockLastBoundDescriptorSets(const VkDescriptorSet** descriptorSets);
+
+#endif
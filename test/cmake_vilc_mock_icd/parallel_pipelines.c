@@ -0,0 +1,189 @@
+#include "mock_icd.h"
+#include "vilc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define PIPELINE_COUNT 32
+#define COMPILE_TIME_US 4000
+
+static VkShaderModule moduleOf(uint32_t index)
+{
+	return (VkShaderModule)(uintptr_t)(0x1000 + index);
+}
+
+static void destroyPipelines(VkDevice device, const VkPipeline* pipelines, uint32_t count)
+{
+	uint32_t i;
+	for (i = 0; i < count; ++i)
+		vkDestroyPipeline(device, pipelines[i], NULL);
+}
+
+static double elapsedMs(const struct timespec* start)
+{
+	struct timespec end;
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	return (double)(end.tv_sec - start->tv_sec) * 1e3 + (double)(end.tv_nsec - start->tv_nsec) / 1e6;
+}
+
+/* Creates one batch with the given number of workers and checks how it was split; 0 workers passes the batch through
+ * serially. The wall clock time is only printed, since it depends on the load of the machine.
+ */
+static int benchmark(VkPhysicalDevice physicalDevice, const VkComputePipelineCreateInfo* computeInfos, uint32_t threads, uint32_t driverCalls, double* ms)
+{
+	VkDeviceCreateInfo deviceInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+	VkPipeline pipelines[PIPELINE_COUNT];
+	VkDevice device;
+	VilcParallelPipelineStats before, after;
+	struct timespec start;
+	char count[16];
+
+	/* the pool is restarted with the new thread count after vkDestroyDevice */
+	snprintf(count, sizeof(count), "%u", threads);
+	setenv("VILC_PARALLEL_PIPELINES_THREADS", count, 1);
+	CHECK(vkCreateDevice(physicalDevice, &deviceInfo, NULL, &device) == VK_SUCCESS);
+
+	mockResetCallCounts();
+	vilcGetParallelPipelineStats(&before);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	CHECK(vkCreateComputePipelines(device, VK_NULL_HANDLE, PIPELINE_COUNT, computeInfos, NULL, pipelines) == VK_SUCCESS);
+	*ms = elapsedMs(&start);
+	vilcGetParallelPipelineStats(&after);
+
+	CHECK(after.threads == threads);
+	CHECK(after.splitCalls - before.splitCalls == (threads ? 1 : 0));
+	CHECK(after.splitPipelines - before.splitPipelines == (threads ? PIPELINE_COUNT : 0));
+	CHECK(after.passedThroughCalls - before.passedThroughCalls == (threads ? 0 : 1));
+	CHECK(mockCallCount("vkCreateComputePipelines") == driverCalls);
+
+	destroyPipelines(device, pipelines, PIPELINE_COUNT);
+	vkDestroyDevice(device, NULL);
+	printf("parallel_pipelines: %d pipelines of %d us with %u workers: %.1f ms\n", PIPELINE_COUNT, COMPILE_TIME_US, threads, *ms);
+	return 0;
+}
+
+int main(void)
+{
+	VkInstanceCreateInfo instanceInfo = { VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
+	VkDeviceCreateInfo deviceInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+	VkPipelineCacheCreateInfo cacheInfo = { VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
+	VkComputePipelineCreateInfo computeInfos[PIPELINE_COUNT];
+	VkGraphicsPipelineCreateInfo graphicsInfos[8];
+	VkPipelineShaderStageCreateInfo stages[8];
+	VkInstance instance;
+	VkPhysicalDevice physicalDevice;
+	VkDevice device;
+	VkPipelineCache appCache;
+	VkPipeline pipelines[PIPELINE_COUNT];
+	VilcParallelPipelineStats stats;
+	size_t cacheSize;
+	double serialMs, parallelMs;
+	uint32_t physicalDeviceCount = 1;
+	uint32_t i;
+
+	memset(computeInfos, 0, sizeof(computeInfos));
+	memset(graphicsInfos, 0, sizeof(graphicsInfos));
+	memset(stages, 0, sizeof(stages));
+	for (i = 0; i < PIPELINE_COUNT; ++i)
+	{
+		computeInfos[i].sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		computeInfos[i].stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		computeInfos[i].stage.module = moduleOf(i);
+		computeInfos[i].basePipelineIndex = -1;
+	}
+	for (i = 0; i < 8; ++i)
+	{
+		stages[i].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		stages[i].module = moduleOf(i);
+		graphicsInfos[i].sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+		graphicsInfos[i].stageCount = 1;
+		graphicsInfos[i].pStages = &stages[i];
+		graphicsInfos[i].basePipelineIndex = -1;
+	}
+
+	setenv("VILC_PARALLEL_PIPELINES_THREADS", "3", 1);
+	CHECK(vkCreateInstance(&instanceInfo, NULL, &instance) == VK_SUCCESS);
+	CHECK(vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, &physicalDevice) == VK_SUCCESS);
+	CHECK(vkCreateDevice(physicalDevice, &deviceInfo, NULL, &device) == VK_SUCCESS);
+
+	/* 3 workers and the calling thread take two chunks each; every pipeline lands at its own index */
+	mockResetCallCounts();
+	CHECK(vkCreateComputePipelines(device, VK_NULL_HANDLE, PIPELINE_COUNT, computeInfos, NULL, pipelines) == VK_SUCCESS);
+	CHECK(mockCallCount("vkCreateComputePipelines") == 8);
+	for (i = 0; i < PIPELINE_COUNT; ++i)
+		CHECK(pipelines[i] && mockPipelineShaderModule(pipelines[i]) == moduleOf(i));
+	destroyPipelines(device, pipelines, PIPELINE_COUNT);
+
+	CHECK(vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 8, graphicsInfos, NULL, pipelines) == VK_SUCCESS);
+	CHECK(mockCallCount("vkCreateGraphicsPipelines") == 8);
+	for (i = 0; i < 8; ++i)
+		CHECK(mockPipelineShaderModule(pipelines[i]) == moduleOf(i));
+	destroyPipelines(device, pipelines, 8);
+
+	/* small batches are passed through */
+	CHECK(vkCreateComputePipelines(device, VK_NULL_HANDLE, 4, computeInfos, NULL, pipelines) == VK_SUCCESS);
+	CHECK(mockCallCount("vkCreateComputePipelines") == 9);
+	destroyPipelines(device, pipelines, 4);
+
+	/* compile required is returned when nothing else failed, and errors take precedence over it */
+	computeInfos[5].flags = VK_PIPELINE_CREATE_FAIL_ON_PIPELINE_COMPILE_REQUIRED_BIT;
+	computeInfos[5].stage.module = MOCK_SHADER_MODULE_COMPILE_REQUIRED;
+	CHECK(vkCreateComputePipelines(device, VK_NULL_HANDLE, 16, computeInfos, NULL, pipelines) == VK_PIPELINE_COMPILE_REQUIRED);
+	CHECK(pipelines[5] == VK_NULL_HANDLE && pipelines[4] && pipelines[15]);
+	destroyPipelines(device, pipelines, 16);
+
+	computeInfos[12].stage.module = MOCK_SHADER_MODULE_INVALID;
+	CHECK(vkCreateComputePipelines(device, VK_NULL_HANDLE, 16, computeInfos, NULL, pipelines) == VK_ERROR_OUT_OF_DEVICE_MEMORY);
+	CHECK(pipelines[5] == VK_NULL_HANDLE && pipelines[12] == VK_NULL_HANDLE);
+	CHECK(pipelines[11] && pipelines[13] && mockPipelineShaderModule(pipelines[13]) == moduleOf(13));
+	destroyPipelines(device, pipelines, 16);
+
+	/* early return depends on creation order, so the driver gets the batch whole and stops at the failure */
+	mockResetCallCounts();
+	for (i = 0; i < 16; ++i)
+		computeInfos[i].flags |= VK_PIPELINE_CREATE_EARLY_RETURN_ON_FAILURE_BIT;
+	CHECK(vkCreateComputePipelines(device, VK_NULL_HANDLE, 16, computeInfos, NULL, pipelines) == VK_PIPELINE_COMPILE_REQUIRED);
+	CHECK(mockCallCount("vkCreateComputePipelines") == 1);
+	CHECK(pipelines[4] && pipelines[5] == VK_NULL_HANDLE && pipelines[6] == VK_NULL_HANDLE && pipelines[15] == VK_NULL_HANDLE);
+	destroyPipelines(device, pipelines, 16);
+
+	for (i = 0; i < 16; ++i)
+	{
+		computeInfos[i].flags = 0;
+		computeInfos[i].stage.module = moduleOf(i);
+	}
+
+	/* private caches are seeded from the application cache and merged back without duplicating the seed */
+	mockResetCallCounts();
+	CHECK(vkCreatePipelineCache(device, &cacheInfo, NULL, &appCache) == VK_SUCCESS);
+	CHECK(vkCreateComputePipelines(device, appCache, 16, computeInfos, NULL, pipelines) == VK_SUCCESS);
+	destroyPipelines(device, pipelines, 16);
+	CHECK(mockCallCount("vkMergePipelineCaches") == 1);
+	CHECK(mockCallCount("vkCreatePipelineCache") == mockCallCount("vkDestroyPipelineCache") + 1);
+	CHECK(vkCreateComputePipelines(device, appCache, 16, computeInfos, NULL, pipelines) == VK_SUCCESS);
+	destroyPipelines(device, pipelines, 16);
+	CHECK(vkGetPipelineCacheData(device, appCache, &cacheSize, NULL) == VK_SUCCESS);
+	CHECK(cacheSize == 32 * MOCK_PIPELINE_CACHE_ENTRY_SIZE);
+	vkDestroyPipelineCache(device, appCache, NULL);
+
+	vilcGetParallelPipelineStats(&stats);
+	CHECK(stats.threads == 3 && stats.splitCalls == 6 && stats.passedThroughCalls == 2);
+	CHECK(stats.splitPipelines == PIPELINE_COUNT + 8 + 16 * 4);
+	vkDestroyDevice(device, NULL);
+
+	/* simulated compile latency: each worker and the calling thread take two chunks of the batch */
+	mockSetPipelineCompileTime(COMPILE_TIME_US);
+	CHECK(benchmark(physicalDevice, computeInfos, 0, 1, &serialMs) == 0);
+	CHECK(benchmark(physicalDevice, computeInfos, 1, 4, &parallelMs) == 0);
+	CHECK(benchmark(physicalDevice, computeInfos, 3, 8, &parallelMs) == 0);
+	printf("parallel_pipelines: speedup with 3 workers: %.1fx\n", serialMs / parallelMs);
+	CHECK(benchmark(physicalDevice, computeInfos, 7, 16, &parallelMs) == 0);
+	mockSetPipelineCompileTime(0);
+
+	vkDestroyInstance(instance, NULL);
+
+	printf("parallel_pipelines: passed\n");
+	return 0;
+}
@@ -0,0 +1,183 @@
+#include "mock_icd.h"
+#include "vilc.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#define HANDLE(type, value) ((type)(uintptr_t)(value))
+
+#define THREAD_COUNT 4
+#define THREAD_BINDS 4096
+
+/* More command buffers than the lint has table entries, so that threads share entries */
+#define THREAD_COMMAND_BUFFERS 512
+
+/* Binds a different pipeline every time, on command buffers that no other thread uses */
+static void* bindPipelines(void* data)
+{
+	uintptr_t thread = (uintptr_t)data;
+	uint32_t i;
+
+	for (i = 0; i < THREAD_BINDS; ++i)
+	{
+		VkCommandBuffer commandBuffer = HANDLE(VkCommandBuffer, 0x100000 + (thread * THREAD_COMMAND_BUFFERS + i % THREAD_COMMAND_BUFFERS) * 64);
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, HANDLE(VkPipeline, 0x1000 + (thread * THREAD_BINDS + i) * 8));
+		vkCmdBindIndexBuffer(commandBuffer, HANDLE(VkBuffer, 0x100), i * 4, VK_INDEX_TYPE_UINT16);
+	}
+	return NULL;
+}
+
+static VkResult submit(VkQueue queue, VkCommandBuffer commandBuffer, int synchronization2)
+{
+	VkSubmitInfo submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
+	VkSubmitInfo2 submitInfo2 = { VK_STRUCTURE_TYPE_SUBMIT_INFO_2 };
+	VkCommandBufferSubmitInfo commandBufferInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO };
+
+	if (!synchronization2)
+	{
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &commandBuffer;
+		return vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
+	}
+
+	commandBufferInfo.commandBuffer = commandBuffer;
+	submitInfo2.commandBufferInfoCount = 1;
+	submitInfo2.pCommandBufferInfos = &commandBufferInfo;
+	return vkQueueSubmit2KHR(queue, 1, &submitInfo2, VK_NULL_HANDLE);
+}
+
+int main(void)
+{
+	VkInstanceCreateInfo instanceInfo = { VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
+	VkDeviceCreateInfo deviceInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+	VkMemoryAllocateInfo allocateInfo = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
+	VkShaderModuleCreateInfo moduleInfo = { VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO };
+	VkPipelineShaderStageCreateInfo stage = { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO };
+	VkComputePipelineCreateInfo computeInfo = { VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO };
+	VkGraphicsPipelineCreateInfo graphicsInfo = { VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO };
+	VkCommandPoolCreateInfo poolInfo = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+	VkCommandBufferAllocateInfo commandBufferInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+	VkCommandBufferBeginInfo beginInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+	VkPresentInfoKHR presentInfo = { VK_STRUCTURE_TYPE_PRESENT_INFO_KHR };
+	VilcPerfLintEntry entries[VILC_PERF_LINT_COUNT];
+	VkInstance instance;
+	VkPhysicalDevice physicalDevice;
+	VkDevice device;
+	VkQueue queue;
+	VkDeviceMemory memory;
+	VkShaderModule module;
+	VkPipeline pipelines[2];
+	VkCommandPool commandPool;
+	VkCommandBuffer commandBuffer;
+	pthread_t threads[THREAD_COUNT];
+	uint32_t physicalDeviceCount = 1;
+	uint64_t redundantBinds;
+	uint32_t i;
+	void* data;
+
+	CHECK(vkCreateInstance(&instanceInfo, NULL, &instance) == VK_SUCCESS);
+	CHECK(vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, &physicalDevice) == VK_SUCCESS);
+	CHECK(vkCreateDevice(physicalDevice, &deviceInfo, NULL, &device) == VK_SUCCESS);
+	vkGetDeviceQueue(device, 0, 0, &queue);
+	CHECK(vkCreateCommandPool(device, &poolInfo, NULL, &commandPool) == VK_SUCCESS);
+	commandBufferInfo.commandPool = commandPool;
+	commandBufferInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	commandBufferInfo.commandBufferCount = 1;
+	CHECK(vkAllocateCommandBuffers(device, &commandBufferInfo, &commandBuffer) == VK_SUCCESS);
+
+	/* load-time work before the first present is not flagged */
+	CHECK(vkCreateShaderModule(device, &moduleInfo, NULL, &module) == VK_SUCCESS);
+	stage.module = module;
+	computeInfo.stage = stage;
+	computeInfo.basePipelineIndex = -1;
+	CHECK(vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &computeInfo, NULL, &pipelines[0]) == VK_SUCCESS);
+	CHECK(vkDeviceWaitIdle(device) == VK_SUCCESS);
+	allocateInfo.allocationSize = 64ull << 20;
+	CHECK(vkAllocateMemory(device, &allocateInfo, NULL, &memory) == VK_SUCCESS);
+	vilcGetPerfLintReport(entries);
+	for (i = 0; i < VILC_PERF_LINT_COUNT; ++i)
+		CHECK(entries[i].count == 0);
+
+	/* mapping the same memory in VILC_PERF_LINT_MAP_STREAK consecutive frames */
+	for (i = 0; i < 3; ++i)
+	{
+		CHECK(vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, &data) == VK_SUCCESS);
+		vkUnmapMemory(device, memory);
+		CHECK(vkQueuePresentKHR(queue, &presentInfo) == VK_SUCCESS);
+	}
+	vilcGetPerfLintReport(entries);
+	CHECK(entries[VILC_PERF_LINT_MAP_EVERY_FRAME].count == 1 && entries[VILC_PERF_LINT_MAP_EVERY_FRAME].firstFrame == 2);
+	CHECK(entries[VILC_PERF_LINT_MAP_EVERY_FRAME].stackDepth > 0);
+	vkFreeMemory(device, memory, NULL);
+
+	/* frame 3: the other lints, each with the frame and the stack of its first occurrence */
+	allocateInfo.allocationSize = 4096;
+	CHECK(vkAllocateMemory(device, &allocateInfo, NULL, &memory) == VK_SUCCESS);
+	vkFreeMemory(device, memory, NULL);
+	CHECK(vkCreateShaderModule(device, &moduleInfo, NULL, &module) == VK_SUCCESS);
+	CHECK(vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &computeInfo, NULL, &pipelines[1]) == VK_SUCCESS);
+	vkDestroyPipeline(device, pipelines[1], NULL);
+	graphicsInfo.stageCount = 1;
+	graphicsInfo.pStages = &stage;
+	graphicsInfo.basePipelineIndex = -1;
+	CHECK(vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &graphicsInfo, NULL, &pipelines[1]) == VK_SUCCESS);
+
+	CHECK(vkBeginCommandBuffer(commandBuffer, &beginInfo) == VK_SUCCESS);
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelines[0]);
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelines[1]);
+	vkCmdBindIndexBuffer(commandBuffer, HANDLE(VkBuffer, 0x100), 0, VK_INDEX_TYPE_UINT16);
+	vkCmdBindIndexBuffer(commandBuffer, HANDLE(VkBuffer, 0x100), 256, VK_INDEX_TYPE_UINT16);
+	vilcGetPerfLintReport(entries);
+	CHECK(entries[VILC_PERF_LINT_REDUNDANT_BIND].count == 0);
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelines[0]);
+	vkCmdBindIndexBuffer(commandBuffer, HANDLE(VkBuffer, 0x100), 256, VK_INDEX_TYPE_UINT16);
+	CHECK(vkEndCommandBuffer(commandBuffer) == VK_SUCCESS);
+
+	/* a new recording starts without bindings */
+	CHECK(vkBeginCommandBuffer(commandBuffer, &beginInfo) == VK_SUCCESS);
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelines[0]);
+	CHECK(vkEndCommandBuffer(commandBuffer) == VK_SUCCESS);
+
+	/* vkQueueSubmit and vkQueueSubmit2KHR count the same way */
+	CHECK(submit(queue, commandBuffer, 0) == VK_SUCCESS);
+	CHECK(submit(queue, commandBuffer, 1) == VK_SUCCESS);
+	CHECK(submit(queue, commandBuffer, 1) == VK_SUCCESS);
+	CHECK(vkQueueWaitIdle(queue) == VK_SUCCESS);
+	CHECK(vkDeviceWaitIdle(device) == VK_SUCCESS);
+
+	vilcGetPerfLintReport(entries);
+	CHECK(entries[VILC_PERF_LINT_MAP_EVERY_FRAME].count == 1);
+	CHECK(entries[VILC_PERF_LINT_SMALL_ALLOCATION].count == 1);
+	CHECK(entries[VILC_PERF_LINT_SHADER_MODULE_IN_FRAME].count == 1);
+	CHECK(entries[VILC_PERF_LINT_PIPELINE_IN_FRAME].count == 2);
+	CHECK(entries[VILC_PERF_LINT_REDUNDANT_BIND].count == 2);
+	CHECK(entries[VILC_PERF_LINT_SUBMIT_PER_COMMAND_BUFFER].count == 2);
+	CHECK(entries[VILC_PERF_LINT_WAIT_IDLE_IN_FRAME].count == 2);
+	for (i = VILC_PERF_LINT_SMALL_ALLOCATION; i < VILC_PERF_LINT_COUNT; ++i)
+		CHECK(entries[i].firstFrame == 3 && entries[i].stackDepth > 0 && entries[i].stack[0] != NULL);
+
+	/* a single submit per frame is fine */
+	CHECK(vkQueuePresentKHR(queue, &presentInfo) == VK_SUCCESS);
+	CHECK(submit(queue, commandBuffer, 1) == VK_SUCCESS);
+	vilcGetPerfLintReport(entries);
+	CHECK(entries[VILC_PERF_LINT_SUBMIT_PER_COMMAND_BUFFER].count == 2);
+
+	/* threads whose command buffers share table entries never see each other's bindings */
+	redundantBinds = entries[VILC_PERF_LINT_REDUNDANT_BIND].count;
+	for (i = 0; i < THREAD_COUNT; ++i)
+		CHECK(pthread_create(&threads[i], NULL, bindPipelines, (void*)(uintptr_t)i) == 0);
+	for (i = 0; i < THREAD_COUNT; ++i)
+		pthread_join(threads[i], NULL);
+	vilcGetPerfLintReport(entries);
+	CHECK(entries[VILC_PERF_LINT_REDUNDANT_BIND].count == redundantBinds);
+
+	vkDestroyPipeline(device, pipelines[0], NULL);
+	vkDestroyPipeline(device, pipelines[1], NULL);
+	vkDestroyCommandPool(device, commandPool, NULL);
+	vkDestroyDevice(device, NULL);
+	vkDestroyInstance(instance, NULL);
+
+	printf("perf_lint: passed\n");
+	return 0;
+}
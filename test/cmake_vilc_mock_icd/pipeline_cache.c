@@ -0,0 +1,123 @@
+#include "mock_icd.h"
+#include "vilc.h"
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* the mock reports vendor 0x1234, device 0x5678, driver version 1 and a zero pipelineCacheUUID */
+#define CACHE_FILE "vilc-pipeline-cache-1234-5678-00000001-00000000000000000000000000000000.bin"
+
+static uint32_t countFiles(const char* path)
+{
+	DIR* directory = opendir(path);
+	struct dirent* entry;
+	uint32_t count = 0;
+
+	while (directory && (entry = readdir(directory)) != NULL)
+		count += entry->d_name[0] != '.';
+	if (directory)
+		closedir(directory);
+	return count;
+}
+
+int main(void)
+{
+	VkInstanceCreateInfo instanceInfo = { VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
+	VkDeviceCreateInfo deviceInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+	VkComputePipelineCreateInfo computeInfos[2];
+	VkGraphicsPipelineCreateInfo graphicsInfo = { VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO };
+	VkPipelineCacheCreateInfo cacheInfo = { VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
+	VkInstance instance;
+	VkPhysicalDevice physicalDevice;
+	VkDevice device;
+	VkPipelineCache appCache;
+	VkPipeline pipelines[2];
+	VilcPipelineCacheStats stats;
+	char directory[] = "/tmp/vilc_pipeline_cache_XXXXXX";
+	char path[256];
+	uint32_t physicalDeviceCount = 1;
+	uint32_t i;
+	FILE* file;
+
+	CHECK(mkdtemp(directory) != NULL);
+	snprintf(path, sizeof(path), "%s/%s", directory, CACHE_FILE);
+	setenv("VILC_PIPELINE_CACHE_DIR", directory, 1);
+	setenv("VILC_PIPELINE_CACHE_FLUSH_MS", "10", 1);
+
+	memset(computeInfos, 0, sizeof(computeInfos));
+	computeInfos[0].sType = computeInfos[1].sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+
+	CHECK(vkCreateInstance(&instanceInfo, NULL, &instance) == VK_SUCCESS);
+	CHECK(vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, &physicalDevice) == VK_SUCCESS);
+
+	/* first run: no file yet; the internal cache is created on first use and flushed in the background */
+	CHECK(vkCreateDevice(physicalDevice, &deviceInfo, NULL, &device) == VK_SUCCESS);
+	CHECK(vkCreateComputePipelines(device, VK_NULL_HANDLE, 2, computeInfos, NULL, pipelines) == VK_SUCCESS);
+	CHECK(mockCallCount("vkCreatePipelineCache") == 1);
+	vkDestroyPipeline(device, pipelines[0], NULL);
+	vkDestroyPipeline(device, pipelines[1], NULL);
+
+	for (i = 0; i < 200; ++i)
+	{
+		vilcGetPipelineCacheStats(&stats);
+		if (stats.saveCount)
+			break;
+		usleep(10000);
+	}
+	CHECK(stats.saveCount == 1 && stats.savedBytes == 2 * MOCK_PIPELINE_CACHE_ENTRY_SIZE);
+	CHECK(stats.loadedBytes == 0 && stats.substitutedCalls == 1);
+
+	/* application caches are left alone */
+	CHECK(vkCreatePipelineCache(device, &cacheInfo, NULL, &appCache) == VK_SUCCESS);
+	CHECK(vkCreateComputePipelines(device, appCache, 1, computeInfos, NULL, pipelines) == VK_SUCCESS);
+	vkDestroyPipeline(device, pipelines[0], NULL);
+	vkDestroyPipelineCache(device, appCache, NULL);
+	vilcGetPipelineCacheStats(&stats);
+	CHECK(stats.substitutedCalls == 1);
+
+	/* unchanged since the background flush, so destroying the device does not write again */
+	vkDestroyDevice(device, NULL);
+	CHECK(mockCallCount("vkDestroyPipelineCache") == 2);
+	vilcGetPipelineCacheStats(&stats);
+	CHECK(stats.saveCount == 1);
+
+	/* second run: seeded from the file, and written back with the new pipeline at vkDestroyDevice */
+	setenv("VILC_PIPELINE_CACHE_FLUSH_MS", "0", 1);
+	CHECK(vkCreateDevice(physicalDevice, &deviceInfo, NULL, &device) == VK_SUCCESS);
+	CHECK(vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &graphicsInfo, NULL, pipelines) == VK_SUCCESS);
+	vkDestroyPipeline(device, pipelines[0], NULL);
+	vilcGetPipelineCacheStats(&stats);
+	CHECK(stats.loadedBytes == 2 * MOCK_PIPELINE_CACHE_ENTRY_SIZE && stats.rejectedFiles == 0);
+	vkDestroyDevice(device, NULL);
+	vilcGetPipelineCacheStats(&stats);
+	CHECK(stats.saveCount == 1 && stats.savedBytes == 3 * MOCK_PIPELINE_CACHE_ENTRY_SIZE);
+
+	/* a corrupt file is ignored and replaced */
+	file = fopen(path, "r+b");
+	CHECK(file != NULL);
+	fseek(file, -1, SEEK_END);
+	fputc(0xff, file);
+	fclose(file);
+
+	CHECK(vkCreateDevice(physicalDevice, &deviceInfo, NULL, &device) == VK_SUCCESS);
+	CHECK(vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, computeInfos, NULL, pipelines) == VK_SUCCESS);
+	vkDestroyPipeline(device, pipelines[0], NULL);
+	vilcGetPipelineCacheStats(&stats);
+	CHECK(stats.loadedBytes == 0 && stats.rejectedFiles == 1);
+	vkDestroyDevice(device, NULL);
+	vilcGetPipelineCacheStats(&stats);
+	CHECK(stats.savedBytes == MOCK_PIPELINE_CACHE_ENTRY_SIZE);
+
+	/* no temporary files are left behind */
+	CHECK(countFiles(directory) == 1);
+	remove(path);
+	rmdir(directory);
+
+	vkDestroyInstance(instance, NULL);
+
+	printf("pipeline_cache: passed\n");
+	return 0;
+}
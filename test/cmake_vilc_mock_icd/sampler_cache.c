@@ -0,0 +1,159 @@
+#include "mock_icd.h"
+#include "vilc.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#define MATERIAL_COUNT 1000
+#define THREAD_COUNT 4
+#define THREAD_SAMPLER_COUNT 256
+
+static VkDevice device;
+static VkSampler threadSamplers[THREAD_COUNT][THREAD_SAMPLER_COUNT];
+
+static void initSampler(VkSamplerCreateInfo* createInfo, uint32_t variant)
+{
+	memset(createInfo, 0, sizeof(*createInfo));
+	createInfo->sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	createInfo->magFilter = (variant & 1) ? VK_FILTER_LINEAR : VK_FILTER_NEAREST;
+	createInfo->minFilter = createInfo->magFilter;
+	createInfo->addressModeU = (variant & 2) ? VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE : VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	createInfo->addressModeV = createInfo->addressModeU;
+	createInfo->mipLodBias = (float)(variant / 4);
+	createInfo->maxLod = 16.0f;
+}
+
+static void* createSamplers(void* pIndex)
+{
+	uint32_t index = *(const uint32_t*)pIndex, i;
+	VkSamplerCreateInfo createInfo;
+
+	for (i = 0; i < THREAD_SAMPLER_COUNT; ++i)
+	{
+		/* odd samplers use states nothing else holds and are dropped right away, so entries die and get recycled
+		 * while other threads look them up */
+		initSampler(&createInfo, i % 2 ? 4 + i / 2 % 2 : i % 4);
+		vkCreateSampler(device, &createInfo, NULL, &threadSamplers[index][i]);
+		if (i % 2)
+			vkDestroySampler(device, threadSamplers[index][i], NULL);
+	}
+
+	return NULL;
+}
+
+int main(void)
+{
+	VkInstanceCreateInfo instanceInfo = { VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
+	VkDeviceCreateInfo deviceInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+	VkSamplerCreateInfo createInfo;
+	VkSamplerReductionModeCreateInfo reductionInfo = { VK_STRUCTURE_TYPE_SAMPLER_REDUCTION_MODE_CREATE_INFO };
+	VkSamplerCustomBorderColorCreateInfoEXT borderInfo = { VK_STRUCTURE_TYPE_SAMPLER_CUSTOM_BORDER_COLOR_CREATE_INFO_EXT };
+	VkBaseInStructure unknownInfo = { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO };
+	VkInstance instance;
+	VkPhysicalDevice physicalDevice;
+	VkSampler materials[MATERIAL_COUNT], reduced, bordered, borderedReordered, unknown;
+	VilcSamplerCacheStats stats;
+	pthread_t threads[THREAD_COUNT];
+	uint32_t threadIndices[THREAD_COUNT];
+	uint32_t physicalDeviceCount = 1;
+	uint32_t i, j;
+
+	CHECK(vkCreateInstance(&instanceInfo, NULL, &instance) == VK_SUCCESS);
+	CHECK(vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, &physicalDevice) == VK_SUCCESS);
+	CHECK(vkCreateDevice(physicalDevice, &deviceInfo, NULL, &device) == VK_SUCCESS);
+
+	/* one sampler per material, with only 4 distinct states */
+	for (i = 0; i < MATERIAL_COUNT; ++i)
+	{
+		initSampler(&createInfo, i % 4);
+		CHECK(vkCreateSampler(device, &createInfo, NULL, &materials[i]) == VK_SUCCESS);
+	}
+	CHECK(mockCallCount("vkCreateSampler") == 4);
+	for (i = 4; i < MATERIAL_COUNT; ++i)
+		CHECK(materials[i] == materials[i % 4]);
+
+	vilcGetSamplerCacheStats(&stats);
+	CHECK(stats.samplers == 4 && stats.references == MATERIAL_COUNT);
+	CHECK(stats.misses == 4 && stats.hits == MATERIAL_COUNT - 4 && stats.uncached == 0);
+
+	/* the default reduction mode is the same state as no structure; other modes are not */
+	initSampler(&createInfo, 0);
+	reductionInfo.reductionMode = VK_SAMPLER_REDUCTION_MODE_WEIGHTED_AVERAGE;
+	createInfo.pNext = &reductionInfo;
+	CHECK(vkCreateSampler(device, &createInfo, NULL, &reduced) == VK_SUCCESS);
+	CHECK(reduced == materials[0]);
+	vkDestroySampler(device, reduced, NULL);
+	reductionInfo.reductionMode = VK_SAMPLER_REDUCTION_MODE_MIN;
+	CHECK(vkCreateSampler(device, &createInfo, NULL, &reduced) == VK_SUCCESS);
+	CHECK(reduced != materials[0] && mockCallCount("vkCreateSampler") == 5);
+
+	/* the order of the pNext chain does not matter */
+	createInfo.borderColor = VK_BORDER_COLOR_FLOAT_CUSTOM_EXT;
+	borderInfo.customBorderColor.float32[0] = 1.0f;
+	reductionInfo.pNext = &borderInfo;
+	borderInfo.pNext = NULL;
+	CHECK(vkCreateSampler(device, &createInfo, NULL, &bordered) == VK_SUCCESS);
+	createInfo.pNext = &borderInfo;
+	borderInfo.pNext = &reductionInfo;
+	reductionInfo.pNext = NULL;
+	CHECK(vkCreateSampler(device, &createInfo, NULL, &borderedReordered) == VK_SUCCESS);
+	CHECK(bordered == borderedReordered && bordered != reduced && mockCallCount("vkCreateSampler") == 6);
+
+	/* unknown structures pass through */
+	unknownInfo.pNext = (const VkBaseInStructure*)createInfo.pNext;
+	createInfo.pNext = &unknownInfo;
+	CHECK(vkCreateSampler(device, &createInfo, NULL, &unknown) == VK_SUCCESS);
+	CHECK(unknown != bordered && mockCallCount("vkCreateSampler") == 7);
+	vkDestroySampler(device, unknown, NULL);
+	CHECK(mockCallCount("vkDestroySampler") == 1);
+
+	vilcGetSamplerCacheStats(&stats);
+	CHECK(stats.samplers == 6 && stats.uncached == 1);
+
+	/* the driver only destroys a sampler with its last reference */
+	for (i = 0; i < MATERIAL_COUNT; i += 4)
+		vkDestroySampler(device, materials[i], NULL);
+	vkDestroySampler(device, reduced, NULL);
+	vkDestroySampler(device, bordered, NULL);
+	CHECK(mockCallCount("vkDestroySampler") == 3);
+	vkDestroySampler(device, borderedReordered, NULL);
+	CHECK(mockCallCount("vkDestroySampler") == 4);
+
+	vilcGetSamplerCacheStats(&stats);
+	CHECK(stats.samplers == 3 && stats.references == MATERIAL_COUNT * 3 / 4);
+
+	/* concurrent creates and destroys of the same states */
+	for (i = 0; i < THREAD_COUNT; ++i)
+	{
+		threadIndices[i] = i;
+		CHECK(pthread_create(&threads[i], NULL, createSamplers, &threadIndices[i]) == 0);
+	}
+	for (i = 0; i < THREAD_COUNT; ++i)
+		pthread_join(threads[i], NULL);
+
+	for (i = 0; i < THREAD_COUNT; ++i)
+		for (j = 0; j < THREAD_SAMPLER_COUNT; j += 2)
+			CHECK(threadSamplers[i][j] == threadSamplers[0][j % 4]);
+	CHECK(threadSamplers[0][2] == materials[2]);
+
+	vilcGetSamplerCacheStats(&stats);
+	CHECK(stats.samplers == 4 && stats.references == MATERIAL_COUNT * 3 / 4 + THREAD_COUNT * THREAD_SAMPLER_COUNT / 2);
+
+	for (i = 0; i < THREAD_COUNT; ++i)
+		for (j = 0; j < THREAD_SAMPLER_COUNT; j += 2)
+			vkDestroySampler(device, threadSamplers[i][j], NULL);
+	for (i = 0; i < MATERIAL_COUNT; ++i)
+		if (i % 4)
+			vkDestroySampler(device, materials[i], NULL);
+
+	vilcGetSamplerCacheStats(&stats);
+	CHECK(stats.samplers == 0 && stats.references == 0);
+	CHECK(mockCallCount("vkDestroySampler") == mockCallCount("vkCreateSampler"));
+
+	vkDestroyDevice(device, NULL);
+	vkDestroyInstance(instance, NULL);
+
+	printf("sampler_cache: passed\n");
+	return 0;
+}
@@ -0,0 +1,100 @@
+#include "mock_icd.h"
+#include "vilc.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define SPIRV_WORD_COUNT 64
+#define MATERIAL_COUNT 12
+
+static uint32_t spirv[3][SPIRV_WORD_COUNT];
+
+static VkResult createModule(VkDevice device, uint32_t variant, VkShaderModule* pShaderModule)
+{
+	VkShaderModuleCreateInfo createInfo = { VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO };
+	uint32_t code[SPIRV_WORD_COUNT];
+
+	/* every create passes its own copy of the code, as if freshly loaded from disk */
+	memcpy(code, spirv[variant], sizeof(code));
+	createInfo.codeSize = sizeof(code);
+	createInfo.pCode = code;
+	return vkCreateShaderModule(device, &createInfo, NULL, pShaderModule);
+}
+
+int main(void)
+{
+	VkInstanceCreateInfo instanceInfo = { VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
+	VkDeviceCreateInfo deviceInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+	VkShaderModuleCreateInfo chainedInfo = { VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO };
+	VkInstance instance;
+	VkPhysicalDevice physicalDevice;
+	VkDevice device;
+	VkShaderModule modules[MATERIAL_COUNT][3], chained;
+	VilcShaderModuleCacheStats stats;
+	uint32_t physicalDeviceCount = 1;
+	uint32_t i, j;
+
+	/* three shaders that only differ in their last word, so equal hashes of different code would show */
+	for (i = 0; i < 3; ++i)
+	{
+		for (j = 0; j < SPIRV_WORD_COUNT; ++j)
+			spirv[i][j] = 0x07230203 + j;
+		spirv[i][SPIRV_WORD_COUNT - 1] = i;
+	}
+
+	CHECK(vkCreateInstance(&instanceInfo, NULL, &instance) == VK_SUCCESS);
+	CHECK(vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, &physicalDevice) == VK_SUCCESS);
+	CHECK(vkCreateDevice(physicalDevice, &deviceInfo, NULL, &device) == VK_SUCCESS);
+
+	/* every material creates the vertex, fragment and shadow shader it uses: 36 creates, 3 distinct modules */
+	for (i = 0; i < MATERIAL_COUNT; ++i)
+		for (j = 0; j < 3; ++j)
+			CHECK(createModule(device, j, &modules[i][j]) == VK_SUCCESS);
+
+	CHECK(mockCallCount("vkCreateShaderModule") == 3);
+	CHECK(modules[0][0] != modules[0][1] && modules[0][1] != modules[0][2] && modules[0][0] != modules[0][2]);
+	for (i = 1; i < MATERIAL_COUNT; ++i)
+		CHECK(modules[i][0] == modules[0][0] && modules[i][1] == modules[0][1] && modules[i][2] == modules[0][2]);
+
+	vilcGetShaderModuleCacheStats(&stats);
+	CHECK(stats.misses == 3 && stats.hits == 3 * (MATERIAL_COUNT - 1) && stats.uncached == 0);
+	CHECK(stats.modules == 3 && stats.references == 3 * MATERIAL_COUNT);
+
+	/* create infos with a pNext chain are not cached */
+	chainedInfo.pNext = &deviceInfo;
+	chainedInfo.codeSize = sizeof(spirv[0]);
+	chainedInfo.pCode = spirv[0];
+	CHECK(vkCreateShaderModule(device, &chainedInfo, NULL, &chained) == VK_SUCCESS);
+	CHECK(chained != modules[0][0] && mockCallCount("vkCreateShaderModule") == 4);
+	vkDestroyShaderModule(device, chained, NULL);
+	CHECK(mockCallCount("vkDestroyShaderModule") == 1);
+
+	/* the driver only destroys a module with its last reference */
+	for (i = 0; i < MATERIAL_COUNT - 1; ++i)
+		vkDestroyShaderModule(device, modules[i][0], NULL);
+	CHECK(mockCallCount("vkDestroyShaderModule") == 1);
+	vkDestroyShaderModule(device, modules[MATERIAL_COUNT - 1][0], NULL);
+	CHECK(mockCallCount("vkDestroyShaderModule") == 2);
+
+	vilcGetShaderModuleCacheStats(&stats);
+	CHECK(stats.modules == 2 && stats.references == 2 * MATERIAL_COUNT && stats.uncached == 1);
+
+	/* a destroyed module is created again on next use */
+	CHECK(createModule(device, 0, &modules[0][0]) == VK_SUCCESS);
+	CHECK(mockCallCount("vkCreateShaderModule") == 5);
+	vkDestroyShaderModule(device, modules[0][0], NULL);
+
+	for (i = 0; i < MATERIAL_COUNT; ++i)
+		for (j = 1; j < 3; ++j)
+			vkDestroyShaderModule(device, modules[i][j], NULL);
+	CHECK(mockCallCount("vkDestroyShaderModule") == mockCallCount("vkCreateShaderModule"));
+
+	vilcGetShaderModuleCacheStats(&stats);
+	CHECK(stats.modules == 0 && stats.references == 0 && stats.misses == 4);
+
+	vkDestroyDevice(device, NULL);
+	vkDestroyInstance(instance, NULL);
+
+	printf("shader_module_cache: passed\n");
+	return 0;
+}
@@ -0,0 +1,183 @@
+#include "mock_icd.h"
+#include "vilc.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define DRAW_COUNT 8
+
+/* the mock does not look at layouts, sets and buffers, so any handle will do */
+#define HANDLE(type, value) ((type)(uintptr_t)(value))
+
+/* Binds all state before every draw, like code ported from an API without persistent state */
+static void recordDraws(VkCommandBuffer commandBuffer, VkPipeline pipeline, VkPipelineLayout layout)
+{
+	VkDescriptorSet sets[2] = { HANDLE(VkDescriptorSet, 0x100), HANDLE(VkDescriptorSet, 0x101) };
+	VkBuffer vertexBuffers[2] = { HANDLE(VkBuffer, 0x200), HANDLE(VkBuffer, 0x201) };
+	VkDeviceSize vertexOffsets[2] = { 0, 256 };
+	VkViewport viewport = { 0, 0, 640, 480, 0, 1 };
+	VkRect2D scissor = { { 0, 0 }, { 640, 480 } };
+	uint32_t dynamicOffset = 64;
+	float transform[4] = { 1, 0, 0, 1 };
+	uint32_t i;
+
+	for (i = 0; i < DRAW_COUNT; ++i)
+	{
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+		vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+		vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 0, 2, sets, 1, &dynamicOffset);
+		vkCmdBindVertexBuffers(commandBuffer, 0, 2, vertexBuffers, vertexOffsets);
+		vkCmdBindIndexBuffer(commandBuffer, HANDLE(VkBuffer, 0x300), 0, VK_INDEX_TYPE_UINT16);
+		vkCmdPushConstants(commandBuffer, layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(transform), transform);
+		vkCmdDrawIndexed(commandBuffer, 3, 1, 0, 0, 0);
+	}
+}
+
+int main(void)
+{
+	VkInstanceCreateInfo instanceInfo = { VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
+	VkDeviceCreateInfo deviceInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+	VkCommandPoolCreateInfo poolInfo = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+	VkCommandBufferAllocateInfo allocateInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+	VkCommandBufferBeginInfo beginInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+	VkRenderPassBeginInfo renderPassBegin = { VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO };
+	VkPresentInfoKHR presentInfo = { VK_STRUCTURE_TYPE_PRESENT_INFO_KHR };
+	VkDynamicState dynamicStates[2] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+	VkPipelineDynamicStateCreateInfo dynamicInfo = { VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO };
+	VkGraphicsPipelineCreateInfo pipelineInfos[2];
+	VkComputePipelineCreateInfo computeInfo = { VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO };
+	VkPipelineLayout layout = HANDLE(VkPipelineLayout, 0x10), otherLayout = HANDLE(VkPipelineLayout, 0x11);
+	VkDescriptorSet sets[2] = { HANDLE(VkDescriptorSet, 0x100), HANDLE(VkDescriptorSet, 0x101) };
+	VkViewport viewport = { 0, 0, 640, 480, 0, 1 };
+	uint32_t dynamicOffset = 64;
+	float transform[4] = { 1, 0, 0, 1 };
+	VkInstance instance;
+	VkPhysicalDevice physicalDevice;
+	VkDevice device;
+	VkQueue queue;
+	VkCommandPool commandPool;
+	VkCommandBuffer commandBuffers[2];
+	VkPipeline dynamicPipeline, staticPipeline, computePipeline;
+	VilcStateFilterStats stats;
+	uint32_t physicalDeviceCount = 1;
+
+	CHECK(vkCreateInstance(&instanceInfo, NULL, &instance) == VK_SUCCESS);
+	CHECK(vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, &physicalDevice) == VK_SUCCESS);
+	CHECK(vkCreateDevice(physicalDevice, &deviceInfo, NULL, &device) == VK_SUCCESS);
+	vkGetDeviceQueue(device, 0, 0, &queue);
+
+	CHECK(vkCreateCommandPool(device, &poolInfo, NULL, &commandPool) == VK_SUCCESS);
+	allocateInfo.commandPool = commandPool;
+	allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocateInfo.commandBufferCount = 2;
+	CHECK(vkAllocateCommandBuffers(device, &allocateInfo, commandBuffers) == VK_SUCCESS);
+
+	/* viewport and scissor are dynamic in the first pipeline and static in the second */
+	memset(pipelineInfos, 0, sizeof(pipelineInfos));
+	pipelineInfos[0].sType = pipelineInfos[1].sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	pipelineInfos[0].basePipelineIndex = pipelineInfos[1].basePipelineIndex = -1;
+	dynamicInfo.dynamicStateCount = 2;
+	dynamicInfo.pDynamicStates = dynamicStates;
+	pipelineInfos[0].pDynamicState = &dynamicInfo;
+	CHECK(vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfos[0], NULL, &dynamicPipeline) == VK_SUCCESS);
+	CHECK(vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfos[1], NULL, &staticPipeline) == VK_SUCCESS);
+	computeInfo.basePipelineIndex = -1;
+	CHECK(vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &computeInfo, NULL, &computePipeline) == VK_SUCCESS);
+
+	/* only the first of the repeated binds reaches the driver */
+	mockResetCallCounts();
+	CHECK(vkBeginCommandBuffer(commandBuffers[0], &beginInfo) == VK_SUCCESS);
+	recordDraws(commandBuffers[0], dynamicPipeline, layout);
+	CHECK(mockCallCount("vkCmdBindPipeline") == 1 && mockCallCount("vkCmdSetViewport") == 1 && mockCallCount("vkCmdSetScissor") == 1);
+	CHECK(mockCallCount("vkCmdBindDescriptorSets") == 1 && mockCallCount("vkCmdBindVertexBuffers") == 1);
+	CHECK(mockCallCount("vkCmdBindIndexBuffer") == 1 && mockCallCount("vkCmdPushConstants") == 1);
+	CHECK(mockCallCount("vkCmdDrawIndexed") == DRAW_COUNT);
+
+	/* changed values, dynamic offsets and push constant stages are passed on */
+	mockResetCallCounts();
+	dynamicOffset = 128;
+	vkCmdBindDescriptorSets(commandBuffers[0], VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 0, 2, sets, 1, &dynamicOffset);
+	vkCmdBindDescriptorSets(commandBuffers[0], VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 0, 2, sets, 1, &dynamicOffset);
+	viewport.width = 320;
+	vkCmdSetViewport(commandBuffers[0], 0, 1, &viewport);
+	vkCmdPushConstants(commandBuffers[0], layout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(transform), transform);
+	transform[3] = 2;
+	vkCmdPushConstants(commandBuffers[0], layout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(transform), transform);
+	vkCmdPushConstants(commandBuffers[0], layout, VK_SHADER_STAGE_FRAGMENT_BIT, 8, 8, &transform[2]);
+	CHECK(mockCallCount("vkCmdBindDescriptorSets") == 1 && mockCallCount("vkCmdSetViewport") == 1 && mockCallCount("vkCmdPushConstants") == 2);
+
+	/* binding with another layout keeps only the sets known to stay bound, which are those of the same layout */
+	mockResetCallCounts();
+	vkCmdBindDescriptorSets(commandBuffers[0], VK_PIPELINE_BIND_POINT_GRAPHICS, otherLayout, 1, 1, &sets[0], 0, NULL);
+	vkCmdBindDescriptorSets(commandBuffers[0], VK_PIPELINE_BIND_POINT_GRAPHICS, otherLayout, 1, 1, &sets[0], 0, NULL);
+	vkCmdBindDescriptorSets(commandBuffers[0], VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 0, 1, &sets[0], 0, NULL);
+	CHECK(mockCallCount("vkCmdBindDescriptorSets") == 2);
+	vkCmdPushConstants(commandBuffers[0], otherLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 8, 8, &transform[2]);
+	vkCmdPushConstants(commandBuffers[0], layout, VK_SHADER_STAGE_FRAGMENT_BIT, 8, 8, &transform[2]);
+	CHECK(mockCallCount("vkCmdPushConstants") == 2);
+
+	/* a pipeline with static viewport and scissor overwrites them */
+	mockResetCallCounts();
+	vkCmdBindPipeline(commandBuffers[0], VK_PIPELINE_BIND_POINT_GRAPHICS, staticPipeline);
+	vkCmdSetViewport(commandBuffers[0], 0, 1, &viewport);
+	CHECK(mockCallCount("vkCmdBindPipeline") == 1 && mockCallCount("vkCmdSetViewport") == 1);
+
+	/* rebinding restores static state that was set since the last bind, while dynamic state stays */
+	vkCmdBindPipeline(commandBuffers[0], VK_PIPELINE_BIND_POINT_GRAPHICS, staticPipeline);
+	vkCmdSetLineWidth(commandBuffers[0], 2.0f);
+	vkCmdBindPipeline(commandBuffers[0], VK_PIPELINE_BIND_POINT_GRAPHICS, staticPipeline);
+	vkCmdBindPipeline(commandBuffers[0], VK_PIPELINE_BIND_POINT_GRAPHICS, dynamicPipeline);
+	vkCmdSetViewport(commandBuffers[0], 0, 1, &viewport);
+	vkCmdBindPipeline(commandBuffers[0], VK_PIPELINE_BIND_POINT_GRAPHICS, dynamicPipeline);
+	CHECK(mockCallCount("vkCmdBindPipeline") == 4 && mockCallCount("vkCmdSetViewport") == 2);
+
+	/* compute state is separate from graphics state */
+	vkCmdBindPipeline(commandBuffers[0], VK_PIPELINE_BIND_POINT_COMPUTE, computePipeline);
+	vkCmdSetLineWidth(commandBuffers[0], 1.0f);
+	vkCmdBindPipeline(commandBuffers[0], VK_PIPELINE_BIND_POINT_COMPUTE, computePipeline);
+	vkCmdBindDescriptorSets(commandBuffers[0], VK_PIPELINE_BIND_POINT_COMPUTE, layout, 0, 1, &sets[0], 0, NULL);
+	CHECK(mockCallCount("vkCmdBindPipeline") == 5 && mockCallCount("vkCmdBindDescriptorSets") == 1);
+
+	/* state is unknown at the start of a render pass and after secondary command buffers */
+	mockResetCallCounts();
+	vkCmdBeginRenderPass(commandBuffers[0], &renderPassBegin, VK_SUBPASS_CONTENTS_INLINE);
+	vkCmdBindPipeline(commandBuffers[0], VK_PIPELINE_BIND_POINT_GRAPHICS, dynamicPipeline);
+	vkCmdExecuteCommands(commandBuffers[0], 1, &commandBuffers[1]);
+	vkCmdBindPipeline(commandBuffers[0], VK_PIPELINE_BIND_POINT_GRAPHICS, dynamicPipeline);
+	vkCmdBindPipeline(commandBuffers[0], VK_PIPELINE_BIND_POINT_GRAPHICS, dynamicPipeline);
+	vkCmdEndRenderPass(commandBuffers[0]);
+	CHECK(mockCallCount("vkCmdBindPipeline") == 2);
+	CHECK(vkEndCommandBuffer(commandBuffers[0]) == VK_SUCCESS);
+
+	/* every recording starts out unknown; calls are counted per frame when their command buffer is ended */
+	CHECK(vkBeginCommandBuffer(commandBuffers[1], &beginInfo) == VK_SUCCESS);
+	recordDraws(commandBuffers[1], dynamicPipeline, layout);
+	CHECK(vkBeginCommandBuffer(commandBuffers[0], &beginInfo) == VK_SUCCESS);
+	recordDraws(commandBuffers[0], dynamicPipeline, layout);
+	CHECK(mockCallCount("vkCmdBindPipeline") == 4);
+	CHECK(vkQueuePresentKHR(queue, &presentInfo) == VK_SUCCESS);
+	CHECK(vkEndCommandBuffer(commandBuffers[1]) == VK_SUCCESS);
+	CHECK(vkEndCommandBuffer(commandBuffers[0]) == VK_SUCCESS);
+	CHECK(vkQueuePresentKHR(queue, &presentInfo) == VK_SUCCESS);
+
+	vilcGetStateFilterStats(&stats);
+	CHECK(stats.frameCount == 2 && stats.lastFrameElidedCalls == 2 * 7 * (DRAW_COUNT - 1));
+	CHECK(stats.calls[VILC_STATE_FILTER_BIND_PIPELINE] == 3 * DRAW_COUNT + 10);
+	CHECK(stats.elidedCalls[VILC_STATE_FILTER_BIND_PIPELINE] == 3 * (DRAW_COUNT - 1) + 3);
+	CHECK(stats.calls[VILC_STATE_FILTER_BIND_DESCRIPTOR_SETS] == 3 * DRAW_COUNT + 6);
+	CHECK(stats.elidedCalls[VILC_STATE_FILTER_BIND_DESCRIPTOR_SETS] == 3 * (DRAW_COUNT - 1) + 2);
+	CHECK(stats.calls[VILC_STATE_FILTER_PUSH_CONSTANTS] == 3 * DRAW_COUNT + 5);
+	CHECK(stats.elidedCalls[VILC_STATE_FILTER_PUSH_CONSTANTS] == 3 * (DRAW_COUNT - 1) + 1);
+
+	vkFreeCommandBuffers(device, commandPool, 1, &commandBuffers[1]);
+	vkDestroyCommandPool(device, commandPool, NULL);
+	vkDestroyPipeline(device, dynamicPipeline, NULL);
+	vkDestroyPipeline(device, staticPipeline, NULL);
+	vkDestroyPipeline(device, computePipeline, NULL);
+	vkDestroyDevice(device, NULL);
+	vkDestroyInstance(instance, NULL);
+
+	printf("state_filter: passed\n");
+	return 0;
+}
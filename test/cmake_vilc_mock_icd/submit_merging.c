@@ -0,0 +1,154 @@
+#include "mock_icd.h"
+#include "vilc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAX_CALLS 8
+/* long enough for the checks before the timeout check not to be flushed by the timer thread */
+#define WINDOW_US 300000
+
+static VkCommandBuffer commandBufferOf(uint32_t index)
+{
+	return (VkCommandBuffer)(uintptr_t)(0x1000 + index);
+}
+
+/* Submits one command buffer with vkQueueSubmit */
+static VkResult submit(VkQueue queue, uint32_t index, VkSemaphore wait, VkSemaphore signal, VkFence fence)
+{
+	VkSubmitInfo info = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
+	VkCommandBuffer commandBuffer = commandBufferOf(index);
+	VkPipelineStageFlags stage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+	info.waitSemaphoreCount = wait ? 1 : 0;
+	info.pWaitSemaphores = &wait;
+	info.pWaitDstStageMask = &stage;
+	info.commandBufferCount = 1;
+	info.pCommandBuffers = &commandBuffer;
+	info.signalSemaphoreCount = signal ? 1 : 0;
+	info.pSignalSemaphores = &signal;
+	return vkQueueSubmit(queue, 1, &info, fence);
+}
+
+int main(void)
+{
+	VkInstanceCreateInfo instanceInfo = { VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
+	VkDeviceCreateInfo deviceInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+	VkFenceCreateInfo fenceInfo = { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+	VkSemaphoreCreateInfo semaphoreInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+	VkPresentInfoKHR presentInfo = { VK_STRUCTURE_TYPE_PRESENT_INFO_KHR };
+	VkSubmitInfo2 submit2 = { VK_STRUCTURE_TYPE_SUBMIT_INFO_2 };
+	VkCommandBufferSubmitInfo commandBufferInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO };
+	VkSubmitInfo unknownSubmit = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
+	VkBaseInStructure unknown = { VK_STRUCTURE_TYPE_APPLICATION_INFO };
+	VkDebugUtilsLabelEXT label = { VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT };
+	VkInstance instance;
+	VkPhysicalDevice physicalDevice;
+	VkDevice device;
+	VkQueue queues[2];
+	VkFence fence;
+	VkSemaphore semaphore;
+	VkSwapchainKHR swapchain = (VkSwapchainKHR)(uintptr_t)0x5000;
+	uint32_t imageIndex = 0;
+	VilcSubmitMergingStats stats;
+	const MockSubmit* log;
+	uint32_t physicalDeviceCount = 1;
+	uint32_t submits, i;
+
+	setenv("VILC_SUBMIT_MERGING_MAX_CALLS", "8", 1);
+	setenv("VILC_SUBMIT_MERGING_WINDOW_US", "300000", 1);
+
+	CHECK(vkCreateInstance(&instanceInfo, NULL, &instance) == VK_SUCCESS);
+	CHECK(vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, &physicalDevice) == VK_SUCCESS);
+	CHECK(vkCreateDevice(physicalDevice, &deviceInfo, NULL, &device) == VK_SUCCESS);
+	vkGetDeviceQueue(device, 0, 0, &queues[0]);
+	vkGetDeviceQueue(device, 0, 1, &queues[1]);
+	CHECK(vkCreateFence(device, &fenceInfo, NULL, &fence) == VK_SUCCESS);
+	CHECK(vkCreateSemaphore(device, &semaphoreInfo, NULL, &semaphore) == VK_SUCCESS);
+
+	/* calls without a fence are held, and made with the one that has a fence as one driver call in order */
+	submits = mockCallCount("vkQueueSubmit");
+	for (i = 0; i < 5; ++i)
+		CHECK(submit(queues[0], i, VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE) == VK_SUCCESS);
+	CHECK(mockSubmitLog(&log) == 0 && mockCallCount("vkQueueSubmit") == submits);
+	CHECK(submit(queues[0], 5, VK_NULL_HANDLE, VK_NULL_HANDLE, fence) == VK_SUCCESS);
+	CHECK(mockCallCount("vkQueueSubmit") == submits + 1 && mockSubmitLog(&log) == 6);
+	for (i = 0; i < 6; ++i)
+		CHECK(log[i].commandBuffer == commandBufferOf(i) && log[i].queue == queues[0] && log[i].fence == (i == 5 ? fence : VK_NULL_HANDLE));
+	CHECK(vkWaitForFences(device, 1, &fence, VK_TRUE, ~0ull) == VK_SUCCESS);
+	CHECK(vkResetFences(device, 1, &fence) == VK_SUCCESS);
+
+	/* a full batch is made right away */
+	mockResetSubmitLog();
+	submits = mockCallCount("vkQueueSubmit");
+	for (i = 0; i < MAX_CALLS; ++i)
+		CHECK(submit(queues[0], 10 + i, VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE) == VK_SUCCESS);
+	CHECK(mockCallCount("vkQueueSubmit") == submits + 1 && mockSubmitLog(&log) == MAX_CALLS);
+
+	/* a wait on another queue makes the held signal first */
+	mockResetSubmitLog();
+	CHECK(submit(queues[0], 20, VK_NULL_HANDLE, semaphore, VK_NULL_HANDLE) == VK_SUCCESS);
+	CHECK(submit(queues[1], 21, semaphore, VK_NULL_HANDLE, VK_NULL_HANDLE) == VK_SUCCESS);
+	CHECK(mockSubmitLog(&log) == 1 && log[0].commandBuffer == commandBufferOf(20));
+	CHECK(vkQueueWaitIdle(queues[1]) == VK_SUCCESS);
+	CHECK(mockSubmitLog(&log) == 2 && log[1].commandBuffer == commandBufferOf(21) && mockUnsignaledSemaphoreWaits() == 0);
+
+	/* calls of another entry point end the batch, so calls reach the driver in order */
+	mockResetSubmitLog();
+	submits = mockCallCount("vkQueueSubmit2");
+	CHECK(submit(queues[0], 30, VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE) == VK_SUCCESS);
+	commandBufferInfo.commandBuffer = commandBufferOf(31);
+	submit2.commandBufferInfoCount = 1;
+	submit2.pCommandBufferInfos = &commandBufferInfo;
+	CHECK(vkQueueSubmit2(queues[0], 1, &submit2, VK_NULL_HANDLE) == VK_SUCCESS);
+	commandBufferInfo.commandBuffer = commandBufferOf(32);
+	CHECK(vkQueueSubmit2(queues[0], 1, &submit2, VK_NULL_HANDLE) == VK_SUCCESS);
+	CHECK(mockSubmitLog(&log) == 1 && log[0].commandBuffer == commandBufferOf(30));
+
+	/* the present makes the held calls before it */
+	presentInfo.swapchainCount = 1;
+	presentInfo.pSwapchains = &swapchain;
+	presentInfo.pImageIndices = &imageIndex;
+	CHECK(vkQueuePresentKHR(queues[0], &presentInfo) == VK_SUCCESS);
+	CHECK(mockSubmitLog(&log) == 4 && log[1].commandBuffer == commandBufferOf(31) && log[2].commandBuffer == commandBufferOf(32) && log[3].present);
+	CHECK(mockCallCount("vkQueueSubmit2") == submits + 1);
+
+	/* calls with structures in their pNext chain that cannot be copied are made as they are, after the held ones */
+	mockResetSubmitLog();
+	CHECK(submit(queues[1], 40, VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE) == VK_SUCCESS);
+	unknownSubmit.pNext = &unknown;
+	CHECK(vkQueueSubmit(queues[1], 1, &unknownSubmit, VK_NULL_HANDLE) == VK_SUCCESS);
+	CHECK(mockSubmitLog(&log) == 2 && log[0].commandBuffer == commandBufferOf(40) && log[1].commandBufferCount == 0);
+
+	/* so are the held calls before a queue debug label */
+	mockResetSubmitLog();
+	CHECK(submit(queues[1], 45, VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE) == VK_SUCCESS);
+	label.pLabelName = "label";
+	vkQueueInsertDebugUtilsLabelEXT(queues[1], &label);
+	CHECK(mockSubmitLog(&log) == 1 && mockCallCount("vkQueueInsertDebugUtilsLabelEXT") == 1);
+
+	/* held calls reach the driver once the window passed, without another call */
+	mockResetSubmitLog();
+	CHECK(submit(queues[1], 50, VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE) == VK_SUCCESS);
+	CHECK(submit(queues[1], 51, VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE) == VK_SUCCESS);
+	for (i = 0; i < 100 && mockSubmitLog(&log) < 2; ++i)
+		usleep(WINDOW_US / 10);
+	CHECK(mockSubmitLog(&log) == 2 && log[1].commandBuffer == commandBufferOf(51));
+
+	vilcGetSubmitMergingStats(&stats);
+	CHECK(stats.heldCalls == 6 + MAX_CALLS + 2 + 3 + 1 + 1 + 2 && stats.passedThroughCalls == 1);
+	CHECK(stats.fenceFlushes == 1 && stats.countFlushes == 1 && stats.presentFlushes == 1 && stats.timeFlushes == 1);
+	CHECK(stats.syncFlushes == 2 && stats.orderFlushes == 3);
+	CHECK(stats.driverSubmits == stats.fenceFlushes + stats.presentFlushes + stats.syncFlushes + stats.orderFlushes + stats.countFlushes + stats.timeFlushes);
+	CHECK(stats.driverSubmits < stats.heldCalls / 2);
+
+	vkDestroySemaphore(device, semaphore, NULL);
+	vkDestroyFence(device, fence, NULL);
+	vkDestroyDevice(device, NULL);
+	vkDestroyInstance(instance, NULL);
+
+	printf("submit_merging: passed\n");
+	return 0;
+}
@@ -0,0 +1,204 @@
+#include "mock_icd.h"
+#include "vilc.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* microseconds the mock spends in every submit and present */
+#define SUBMIT_LATENCY 2000
+#define FRAME_COUNT 8
+
+static VkCommandBuffer commandBufferOf(uint32_t index)
+{
+	return (VkCommandBuffer)(uintptr_t)(0x1000 + index);
+}
+
+static uint64_t nowNs(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+/* Index of the first logged submit of the command buffer, or the log size */
+static uint32_t findSubmit(VkCommandBuffer commandBuffer)
+{
+	const MockSubmit* submits;
+	uint32_t count = mockSubmitLog(&submits), i;
+
+	for (i = 0; i < count; ++i)
+		if (submits[i].commandBuffer == commandBuffer)
+			return i;
+	return count;
+}
+
+int main(void)
+{
+	VkInstanceCreateInfo instanceInfo = { VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
+	VkDeviceCreateInfo deviceInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+	VkFenceCreateInfo fenceInfo = { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+	VkSemaphoreCreateInfo semaphoreInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+	VkPresentInfoKHR presentInfo = { VK_STRUCTURE_TYPE_PRESENT_INFO_KHR };
+	VkSubmitInfo2 submit2 = { VK_STRUCTURE_TYPE_SUBMIT_INFO_2 };
+	VkCommandBufferSubmitInfo commandBufferInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO };
+	VkSemaphoreSubmitInfo waitInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO };
+	VkBaseInStructure unknown = { VK_STRUCTURE_TYPE_APPLICATION_INFO };
+	VkDebugUtilsLabelEXT label = { VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT };
+	VkCommandBuffer manyCommandBuffers[200];
+	VkSubmitInfo submits[FRAME_COUNT];
+	VkInstance instance;
+	VkPhysicalDevice physicalDevice;
+	VkDevice device;
+	VkQueue queues[2];
+	VkFence fence;
+	VkSemaphore semaphores[2];
+	VkSwapchainKHR swapchain = (VkSwapchainKHR)(uintptr_t)0x5000;
+	VkResult presentResult = VK_SUCCESS;
+	uint32_t imageIndex = 0;
+	VilcSubmitThreadStats stats;
+	const MockSubmit* log;
+	uint64_t start, callerTime;
+	uint32_t physicalDeviceCount = 1;
+	uint32_t i, count;
+
+	CHECK(vkCreateInstance(&instanceInfo, NULL, &instance) == VK_SUCCESS);
+	CHECK(vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, &physicalDevice) == VK_SUCCESS);
+	CHECK(vkCreateDevice(physicalDevice, &deviceInfo, NULL, &device) == VK_SUCCESS);
+	vkGetDeviceQueue(device, 0, 0, &queues[0]);
+	vkGetDeviceQueue(device, 0, 1, &queues[1]);
+	CHECK(queues[0] != queues[1]);
+	CHECK(vkCreateFence(device, &fenceInfo, NULL, &fence) == VK_SUCCESS);
+	CHECK(vkCreateSemaphore(device, &semaphoreInfo, NULL, &semaphores[0]) == VK_SUCCESS);
+	CHECK(vkCreateSemaphore(device, &semaphoreInfo, NULL, &semaphores[1]) == VK_SUCCESS);
+
+	memset(submits, 0, sizeof(submits));
+	for (i = 0; i < FRAME_COUNT; ++i)
+	{
+		submits[i].sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submits[i].commandBufferCount = 1;
+	}
+
+	/* submits return before the driver is called, which happens in order on another thread: they return even while the
+	 * driver blocks every submit
+	 */
+	mockSetSubmitLatency(SUBMIT_LATENCY);
+	mockSetSubmitGate(1);
+	start = nowNs();
+	for (i = 0; i < FRAME_COUNT; ++i)
+	{
+		VkCommandBuffer commandBuffer = commandBufferOf(i);
+		submits[i].pCommandBuffers = &commandBuffer;
+		CHECK(vkQueueSubmit(queues[0], 1, &submits[i], i + 1 == FRAME_COUNT ? fence : VK_NULL_HANDLE) == VK_SUCCESS);
+		submits[i].pCommandBuffers = NULL;
+	}
+	callerTime = nowNs() - start;
+	CHECK(mockSubmitLog(&log) == 0);
+	mockSetSubmitGate(0);
+
+	/* the mock fails fence waits that would block, so the wait has to drain the ring first */
+	CHECK(vkWaitForFences(device, 1, &fence, VK_TRUE, ~0ull) == VK_SUCCESS);
+	CHECK(mockSubmitLog(&log) == FRAME_COUNT);
+	for (i = 0; i < FRAME_COUNT; ++i)
+		CHECK(log[i].commandBuffer == commandBufferOf(i) && log[i].queue == queues[0] && !pthread_equal(log[i].thread, pthread_self()));
+	CHECK(log[FRAME_COUNT - 1].fence == fence);
+	CHECK(vkResetFences(device, 1, &fence) == VK_SUCCESS);
+
+	/* a wait on another queue is only submitted after the signal queued before it, even while that queue is behind */
+	mockResetSubmitLog();
+	for (i = 0; i < 4; ++i)
+	{
+		submits[i].pCommandBuffers = NULL;
+		submits[i].commandBufferCount = 0;
+		CHECK(vkQueueSubmit(queues[0], 1, &submits[i], VK_NULL_HANDLE) == VK_SUCCESS);
+	}
+	submits[4].commandBufferCount = 1;
+	submits[4].pCommandBuffers = &manyCommandBuffers[0];
+	manyCommandBuffers[0] = commandBufferOf(100);
+	submits[4].signalSemaphoreCount = 1;
+	submits[4].pSignalSemaphores = &semaphores[0];
+	CHECK(vkQueueSubmit(queues[0], 1, &submits[4], VK_NULL_HANDLE) == VK_SUCCESS);
+	commandBufferInfo.commandBuffer = commandBufferOf(101);
+	waitInfo.semaphore = semaphores[0];
+	waitInfo.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+	submit2.waitSemaphoreInfoCount = 1;
+	submit2.pWaitSemaphoreInfos = &waitInfo;
+	submit2.commandBufferInfoCount = 1;
+	submit2.pCommandBufferInfos = &commandBufferInfo;
+	CHECK(vkQueueSubmit2(queues[1], 1, &submit2, fence) == VK_SUCCESS);
+	CHECK(vkQueueWaitIdle(queues[1]) == VK_SUCCESS);
+	CHECK(findSubmit(commandBufferOf(100)) < findSubmit(commandBufferOf(101)));
+	CHECK(mockSubmitLog(&log) == 6 && mockUnsignaledSemaphoreWaits() == 0);
+	CHECK(vkGetFenceStatus(device, fence) == VK_SUCCESS);
+
+	/* presents are queued behind the submit that signals their semaphore */
+	mockResetSubmitLog();
+	submits[5].commandBufferCount = 1;
+	submits[5].pCommandBuffers = &manyCommandBuffers[0];
+	submits[5].signalSemaphoreCount = 1;
+	submits[5].pSignalSemaphores = &semaphores[1];
+	manyCommandBuffers[0] = commandBufferOf(102);
+	CHECK(vkQueueSubmit(queues[0], 1, &submits[5], VK_NULL_HANDLE) == VK_SUCCESS);
+	presentInfo.waitSemaphoreCount = 1;
+	presentInfo.pWaitSemaphores = &semaphores[1];
+	presentInfo.swapchainCount = 1;
+	presentInfo.pSwapchains = &swapchain;
+	presentInfo.pImageIndices = &imageIndex;
+	CHECK(vkQueuePresentKHR(queues[0], &presentInfo) == VK_SUCCESS);
+	CHECK(vkDeviceWaitIdle(device) == VK_SUCCESS);
+	CHECK(mockSubmitLog(&log) == 2 && !log[0].present && log[1].present && !pthread_equal(log[1].thread, pthread_self()));
+	CHECK(mockUnsignaledSemaphoreWaits() == 0);
+
+	/* queue debug labels are made after the calls queued before them */
+	CHECK(vkQueueSubmit(queues[0], 1, &submits[5], VK_NULL_HANDLE) == VK_SUCCESS);
+	label.pLabelName = "label";
+	vkQueueInsertDebugUtilsLabelEXT(queues[0], &label);
+	CHECK(mockSubmitLog(&log) == 3 && mockCallCount("vkQueueInsertDebugUtilsLabelEXT") == 1);
+
+	/* per-swapchain results are only known after the call, so those presents are made by the calling thread */
+	mockResetSubmitLog();
+	presentInfo.waitSemaphoreCount = 0;
+	presentInfo.pResults = &presentResult;
+	CHECK(vkQueuePresentKHR(queues[0], &presentInfo) == VK_SUCCESS);
+	presentInfo.pResults = NULL;
+	/* so are submits with structures in their pNext chain that cannot be copied */
+	submits[6].pNext = &unknown;
+	submits[6].commandBufferCount = 0;
+	CHECK(vkQueueSubmit(queues[1], 1, &submits[6], VK_NULL_HANDLE) == VK_SUCCESS);
+	CHECK(mockSubmitLog(&log) == 2 && pthread_equal(log[0].thread, pthread_self()) && pthread_equal(log[1].thread, pthread_self()));
+	submits[6].pNext = NULL;
+
+	/* copies that do not fit into a ring slot are allocated, and a full ring makes the caller wait */
+	mockResetSubmitLog();
+	mockSetSubmitLatency(SUBMIT_LATENCY / 4);
+	for (i = 0; i < 200; ++i)
+		manyCommandBuffers[i] = commandBufferOf(200 + i);
+	submits[7].commandBufferCount = 200;
+	submits[7].pCommandBuffers = manyCommandBuffers;
+	for (i = 0; i < 40; ++i)
+		CHECK(vkQueueSubmit(queues[1], 1, &submits[7], VK_NULL_HANDLE) == VK_SUCCESS);
+	memset(manyCommandBuffers, 0, sizeof(manyCommandBuffers));
+	CHECK(vkQueueWaitIdle(queues[1]) == VK_SUCCESS);
+	count = mockSubmitLog(&log);
+	CHECK(count == 40);
+	for (i = 0; i < count; ++i)
+		CHECK(log[i].commandBufferCount == 200 && log[i].commandBuffer == commandBufferOf(200));
+
+	vilcGetSubmitThreadStats(&stats);
+	CHECK(stats.queuedSubmits == FRAME_COUNT + 4 + 2 + 1 + 1 + 40 && stats.queuedPresents == 1);
+	CHECK(stats.passedThroughCalls == 2 && stats.drains >= 5 && stats.ringFullWaits > 0 && stats.threads == 2);
+	CHECK(stats.queueLatency.count == stats.queuedSubmits + stats.queuedPresents && stats.driverTime.count == stats.queueLatency.count);
+	CHECK(stats.callerTime.count == stats.queueLatency.count);
+	CHECK(stats.driverTime.min >= SUBMIT_LATENCY / 4 * 1000ull);
+	printf("submit_thread: %llu ns per submit on the calling thread for %u ns in the driver\n",
+	    (unsigned long long)(callerTime / FRAME_COUNT), SUBMIT_LATENCY * 1000);
+
+	vkDestroySemaphore(device, semaphores[0], NULL);
+	vkDestroySemaphore(device, semaphores[1], NULL);
+	vkDestroyFence(device, fence, NULL);
+	vkDestroyDevice(device, NULL);
+	vkDestroyInstance(instance, NULL);
+
+	printf("submit_thread: passed\n");
+	return 0;
+}
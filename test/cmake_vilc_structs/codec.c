@@ -0,0 +1,489 @@
+#define VILC_STRUCTS_IMPLEMENTATION
+#include "vilc_structs.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define CHECK(condition) \
+	if (!(condition)) \
+	{ \
+		printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+		return 1; \
+	}
+
+/* handles are only carried around, so any value will do */
+#define HANDLE(type, value) ((type)(uintptr_t)(value))
+
+#define MAX_TYPE_SIZE 4096
+
+#define BENCHMARK_FRAMES 20000
+
+static uint8_t encoded[1 << 20];
+static uint8_t reencoded[1 << 20];
+static uint8_t arenaMemory[1 << 20];
+
+typedef union TypeStorage
+{
+	uint64_t alignment;
+	uint8_t bytes[MAX_TYPE_SIZE];
+} TypeStorage;
+
+/* Encodes a value, decodes it and checks that the decoded value encodes to the same bytes */
+static int roundTrip(VilcCodecType type)
+{
+	VilcCodecTypeInfo info = vilcCodecGetTypeInfo(type);
+	static TypeStorage value, decoded;
+	VilcCodecWriter writer, rewriter;
+	VilcCodecReader reader;
+	VilcArena arena;
+	size_t i;
+
+	CHECK(info.name && info.size <= MAX_TYPE_SIZE);
+
+	/* without pointers any bytes make a valid value; otherwise pointers stay NULL and counts 0 */
+	memset(value.bytes, 0, info.size);
+	if (info.flags & VILC_CODEC_TYPE_POINTER_FREE_BIT)
+		for (i = 0; i < info.size; ++i)
+			value.bytes[i] = (uint8_t)(i * 37 + 11);
+	if (info.sType != VK_STRUCTURE_TYPE_MAX_ENUM)
+		memcpy(value.bytes, &info.sType, sizeof(info.sType));
+
+	vilcCodecWriterInit(&writer, encoded, sizeof(encoded));
+	vilcEncodeType(&writer, type, value.bytes);
+	if (writer.result != VK_SUCCESS)
+		printf("codec: %s failed to encode\n", info.name);
+	CHECK(writer.result == VK_SUCCESS);
+
+	vilcArenaInit(&arena, arenaMemory, sizeof(arenaMemory));
+	vilcCodecReaderInit(&reader, encoded, writer.size, &arena);
+	memset(decoded.bytes, 0, info.size);
+	vilcDecodeType(&reader, type, decoded.bytes);
+	if (reader.result != VK_SUCCESS || reader.offset != writer.size)
+		printf("codec: %s failed to decode\n", info.name);
+	CHECK(reader.result == VK_SUCCESS && reader.offset == writer.size);
+
+	vilcCodecWriterInit(&rewriter, reencoded, sizeof(reencoded));
+	vilcEncodeType(&rewriter, type, decoded.bytes);
+	CHECK(rewriter.result == VK_SUCCESS);
+	if (rewriter.size != writer.size || memcmp(encoded, reencoded, writer.size) != 0)
+		printf("codec: %s changed in a round trip\n", info.name);
+	CHECK(rewriter.size == writer.size && memcmp(encoded, reencoded, writer.size) == 0);
+	return 0;
+}
+
+static int testBarriers(void)
+{
+	VkMemoryBarrier memoryBarrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+	VkImageMemoryBarrier imageBarriers[2];
+	VilcCodecArgs_vkCmdPipelineBarrier args;
+	VilcCodecWriter writer;
+	VilcCodecReader reader;
+	VilcArena arena;
+
+	memset(imageBarriers, 0, sizeof(imageBarriers));
+	imageBarriers[0].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	imageBarriers[0].pNext = &memoryBarrier; /* not a valid chain, but any known structure can be encoded */
+	imageBarriers[0].newLayout = VK_IMAGE_LAYOUT_GENERAL;
+	imageBarriers[0].image = HANDLE(VkImage, 0x1234567890ull);
+	imageBarriers[0].subresourceRange.layerCount = 6;
+	imageBarriers[1].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	imageBarriers[1].image = HANDLE(VkImage, 0xfedcba9876543210ull);
+	memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+	vilcCodecWriterInit(&writer, encoded, sizeof(encoded));
+	vilcEncode_vkCmdPipelineBarrier(&writer, HANDLE(VkCommandBuffer, 0x42), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 1, &memoryBarrier, 0, NULL, 2, imageBarriers);
+	CHECK(writer.result == VK_SUCCESS);
+
+	vilcArenaInit(&arena, arenaMemory, sizeof(arenaMemory));
+	vilcCodecReaderInit(&reader, encoded, writer.size, &arena);
+	CHECK(vilcCodecReadCommand(&reader) == VILC_CODEC_COMMAND_vkCmdPipelineBarrier);
+	vilcDecode_vkCmdPipelineBarrier(&reader, &args);
+	CHECK(reader.result == VK_SUCCESS);
+	CHECK(vilcCodecReadCommand(&reader) == 0);
+
+	CHECK(args.commandBuffer == HANDLE(VkCommandBuffer, 0x42));
+	CHECK(args.dstStageMask == VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+	CHECK(args.memoryBarrierCount == 1 && args.pMemoryBarriers[0].dstAccessMask == VK_ACCESS_SHADER_READ_BIT);
+	CHECK(args.bufferMemoryBarrierCount == 0 && args.pBufferMemoryBarriers == NULL);
+	CHECK(args.imageMemoryBarrierCount == 2);
+	CHECK(args.pImageMemoryBarriers[0].image == imageBarriers[0].image && args.pImageMemoryBarriers[1].image == imageBarriers[1].image);
+	CHECK(args.pImageMemoryBarriers[0].newLayout == VK_IMAGE_LAYOUT_GENERAL && args.pImageMemoryBarriers[0].subresourceRange.layerCount == 6);
+	CHECK(args.pImageMemoryBarriers[0].pNext != NULL && args.pImageMemoryBarriers[1].pNext == NULL);
+	CHECK(((const VkMemoryBarrier*)args.pImageMemoryBarriers[0].pNext)->sType == VK_STRUCTURE_TYPE_MEMORY_BARRIER);
+	CHECK(((const VkMemoryBarrier*)args.pImageMemoryBarriers[0].pNext)->dstAccessMask == VK_ACCESS_SHADER_READ_BIT);
+
+	/* VkDependencyInfo takes the same barriers as one structure */
+	{
+		VkImageMemoryBarrier2 imageBarrier2 = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2 };
+		VkDependencyInfo dependencyInfo = { VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+		VilcCodecArgs_vkCmdPipelineBarrier2 args2;
+
+		imageBarrier2.dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+		imageBarrier2.image = imageBarriers[1].image;
+		dependencyInfo.imageMemoryBarrierCount = 1;
+		dependencyInfo.pImageMemoryBarriers = &imageBarrier2;
+
+		vilcCodecWriterInit(&writer, encoded, sizeof(encoded));
+		vilcEncode_vkCmdPipelineBarrier2(&writer, HANDLE(VkCommandBuffer, 0x42), &dependencyInfo);
+		vilcCodecReaderInit(&reader, encoded, writer.size, &arena);
+		CHECK(vilcCodecReadCommand(&reader) == VILC_CODEC_COMMAND_vkCmdPipelineBarrier2);
+		vilcDecode_vkCmdPipelineBarrier2(&reader, &args2);
+		CHECK(reader.result == VK_SUCCESS);
+		CHECK(args2.pDependencyInfo->sType == VK_STRUCTURE_TYPE_DEPENDENCY_INFO && args2.pDependencyInfo->memoryBarrierCount == 0);
+		CHECK(args2.pDependencyInfo->imageMemoryBarrierCount == 1);
+		CHECK(args2.pDependencyInfo->pImageMemoryBarriers[0].dstStageMask == VK_PIPELINE_STAGE_2_COPY_BIT);
+		CHECK(args2.pDependencyInfo->pImageMemoryBarriers[0].image == imageBarriers[1].image);
+	}
+	return 0;
+}
+
+static int testRenderPass(void)
+{
+	VkClearValue clearValues[2];
+	VkRect2D deviceArea = { { 1, 2 }, { 3, 4 } };
+	VkImageView attachments[3] = { HANDLE(VkImageView, 7), HANDLE(VkImageView, 8), HANDLE(VkImageView, 9) };
+	VkRenderPassAttachmentBeginInfo attachmentInfo = { VK_STRUCTURE_TYPE_RENDER_PASS_ATTACHMENT_BEGIN_INFO };
+	VkDeviceGroupRenderPassBeginInfo deviceGroupInfo = { VK_STRUCTURE_TYPE_DEVICE_GROUP_RENDER_PASS_BEGIN_INFO };
+	VkRenderPassBeginInfo beginInfo = { VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO };
+	VilcCodecArgs_vkCmdBeginRenderPass args;
+	const VkDeviceGroupRenderPassBeginInfo* decodedGroup;
+	const VkRenderPassAttachmentBeginInfo* decodedAttachments;
+	VilcCodecWriter writer;
+	VilcCodecReader reader;
+	VilcArena arena;
+
+	memset(clearValues, 0, sizeof(clearValues));
+	clearValues[0].color.float32[2] = 0.5f;
+	clearValues[1].depthStencil.stencil = 3;
+	attachmentInfo.attachmentCount = 3;
+	attachmentInfo.pAttachments = attachments;
+	deviceGroupInfo.pNext = &attachmentInfo;
+	deviceGroupInfo.deviceMask = 3;
+	deviceGroupInfo.deviceRenderAreaCount = 1;
+	deviceGroupInfo.pDeviceRenderAreas = &deviceArea;
+	beginInfo.pNext = &deviceGroupInfo;
+	beginInfo.renderPass = HANDLE(VkRenderPass, 5);
+	beginInfo.renderArea.extent.width = 640;
+	beginInfo.clearValueCount = 2;
+	beginInfo.pClearValues = clearValues;
+
+	vilcCodecWriterInit(&writer, encoded, sizeof(encoded));
+	vilcEncode_vkCmdBeginRenderPass(&writer, HANDLE(VkCommandBuffer, 1), &beginInfo, VK_SUBPASS_CONTENTS_INLINE);
+	vilcEncode_vkCmdEndRenderPass(&writer, HANDLE(VkCommandBuffer, 1));
+	CHECK(writer.result == VK_SUCCESS);
+
+	vilcArenaInit(&arena, arenaMemory, sizeof(arenaMemory));
+	vilcCodecReaderInit(&reader, encoded, writer.size, &arena);
+	CHECK(vilcCodecReadCommand(&reader) == VILC_CODEC_COMMAND_vkCmdBeginRenderPass);
+	vilcDecode_vkCmdBeginRenderPass(&reader, &args);
+	CHECK(reader.result == VK_SUCCESS);
+	CHECK(args.pRenderPassBegin->renderPass == beginInfo.renderPass && args.pRenderPassBegin->renderArea.extent.width == 640);
+	CHECK(args.pRenderPassBegin->clearValueCount == 2);
+	CHECK(args.pRenderPassBegin->pClearValues[0].color.float32[2] == 0.5f && args.pRenderPassBegin->pClearValues[1].depthStencil.stencil == 3);
+
+	decodedGroup = (const VkDeviceGroupRenderPassBeginInfo*)args.pRenderPassBegin->pNext;
+	CHECK(decodedGroup && decodedGroup->sType == VK_STRUCTURE_TYPE_DEVICE_GROUP_RENDER_PASS_BEGIN_INFO);
+	CHECK(decodedGroup->deviceMask == 3 && decodedGroup->deviceRenderAreaCount == 1 && decodedGroup->pDeviceRenderAreas[0].extent.height == 4);
+	decodedAttachments = (const VkRenderPassAttachmentBeginInfo*)decodedGroup->pNext;
+	CHECK(decodedAttachments && decodedAttachments->sType == VK_STRUCTURE_TYPE_RENDER_PASS_ATTACHMENT_BEGIN_INFO);
+	CHECK(decodedAttachments->pNext == NULL && decodedAttachments->attachmentCount == 3);
+	CHECK(memcmp(decodedAttachments->pAttachments, attachments, sizeof(attachments)) == 0);
+
+	/* records that are not of interest are skipped */
+	CHECK(vilcCodecReadCommand(&reader) == VILC_CODEC_COMMAND_vkCmdEndRenderPass);
+	vilcCodecSkipCommand(&reader);
+	CHECK(vilcCodecReadCommand(&reader) == 0 && reader.result == VK_SUCCESS);
+	return 0;
+}
+
+static int testArrays(void)
+{
+	VkDescriptorSet sets[2] = { HANDLE(VkDescriptorSet, 10), HANDLE(VkDescriptorSet, 11) };
+	uint32_t dynamicOffsets[3] = { 256, 512, 768 };
+	VkDebugUtilsLabelEXT label = { VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT };
+	VkMultiDrawInfoEXT draws[3][2]; /* drawn with a stride of two structures */
+	VilcCodecArgs_vkCmdBindDescriptorSets bindArgs;
+	VilcCodecArgs_vkCmdBeginDebugUtilsLabelEXT labelArgs;
+	VilcCodecArgs_vkCmdDrawMultiEXT drawArgs;
+	VilcCodecWriter writer;
+	VilcCodecReader reader;
+	VilcArena arena;
+
+	label.pLabelName = "shadow pass";
+	label.color[3] = 1.0f;
+	memset(draws, 0, sizeof(draws));
+	draws[0][0].vertexCount = 3;
+	draws[1][0].firstVertex = 30;
+	draws[2][0].vertexCount = 300;
+
+	vilcCodecWriterInit(&writer, encoded, sizeof(encoded));
+	vilcEncode_vkCmdBindDescriptorSets(&writer, HANDLE(VkCommandBuffer, 1), VK_PIPELINE_BIND_POINT_COMPUTE, HANDLE(VkPipelineLayout, 2), 1, 2, sets, 3, dynamicOffsets);
+	vilcEncode_vkCmdBeginDebugUtilsLabelEXT(&writer, HANDLE(VkCommandBuffer, 1), &label);
+	vilcEncode_vkCmdDrawMultiEXT(&writer, HANDLE(VkCommandBuffer, 1), 3, &draws[0][0], 1, 0, sizeof(draws[0]));
+	CHECK(writer.result == VK_SUCCESS);
+
+	vilcArenaInit(&arena, arenaMemory, sizeof(arenaMemory));
+	vilcCodecReaderInit(&reader, encoded, writer.size, &arena);
+	CHECK(vilcCodecReadCommand(&reader) == VILC_CODEC_COMMAND_vkCmdBindDescriptorSets);
+	vilcDecode_vkCmdBindDescriptorSets(&reader, &bindArgs);
+	CHECK(vilcCodecReadCommand(&reader) == VILC_CODEC_COMMAND_vkCmdBeginDebugUtilsLabelEXT);
+	vilcDecode_vkCmdBeginDebugUtilsLabelEXT(&reader, &labelArgs);
+	CHECK(vilcCodecReadCommand(&reader) == VILC_CODEC_COMMAND_vkCmdDrawMultiEXT);
+	vilcDecode_vkCmdDrawMultiEXT(&reader, &drawArgs);
+	CHECK(reader.result == VK_SUCCESS);
+
+	CHECK(bindArgs.pipelineBindPoint == VK_PIPELINE_BIND_POINT_COMPUTE && bindArgs.layout == HANDLE(VkPipelineLayout, 2) && bindArgs.firstSet == 1);
+	CHECK(bindArgs.descriptorSetCount == 2 && memcmp(bindArgs.pDescriptorSets, sets, sizeof(sets)) == 0);
+	CHECK(bindArgs.dynamicOffsetCount == 3 && memcmp(bindArgs.pDynamicOffsets, dynamicOffsets, sizeof(dynamicOffsets)) == 0);
+
+	CHECK(strcmp(labelArgs.pLabelInfo->pLabelName, "shadow pass") == 0 && labelArgs.pLabelInfo->color[3] == 1.0f);
+
+	/* strided arrays are decoded packed */
+	CHECK(drawArgs.drawCount == 3 && drawArgs.stride == sizeof(VkMultiDrawInfoEXT));
+	CHECK(drawArgs.pVertexInfo[0].vertexCount == 3 && drawArgs.pVertexInfo[1].firstVertex == 30 && drawArgs.pVertexInfo[2].vertexCount == 300);
+	return 0;
+}
+
+static int testSelectedUnion(void)
+{
+	VkAccelerationStructureGeometryKHR geometry = { VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR };
+	VkAccelerationStructureGeometryKHR decoded;
+	VilcCodecWriter writer;
+	VilcCodecReader reader;
+	VilcArena arena;
+	size_t trianglesSize;
+
+	geometry.geometryType = VK_GEOMETRY_TYPE_TRIANGLES_KHR;
+	geometry.geometry.triangles.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR;
+	geometry.geometry.triangles.vertexStride = 12;
+	geometry.geometry.triangles.vertexData.deviceAddress = 0x10000;
+	geometry.geometry.triangles.maxVertex = 99;
+
+	vilcCodecWriterInit(&writer, encoded, sizeof(encoded));
+	vilcEncode_VkAccelerationStructureGeometryKHR(&writer, &geometry);
+	CHECK(writer.result == VK_SUCCESS);
+	trianglesSize = writer.size;
+
+	vilcArenaInit(&arena, arenaMemory, sizeof(arenaMemory));
+	vilcCodecReaderInit(&reader, encoded, writer.size, &arena);
+	vilcDecode_VkAccelerationStructureGeometryKHR(&reader, &decoded);
+	CHECK(reader.result == VK_SUCCESS && reader.offset == writer.size);
+	CHECK(decoded.geometryType == VK_GEOMETRY_TYPE_TRIANGLES_KHR && decoded.geometry.triangles.maxVertex == 99);
+	CHECK(decoded.geometry.triangles.vertexStride == 12 && decoded.geometry.triangles.vertexData.deviceAddress == 0x10000);
+
+	/* only the member picked by the selector is encoded */
+	geometry.geometryType = VK_GEOMETRY_TYPE_INSTANCES_KHR;
+	vilcCodecWriterInit(&writer, encoded, sizeof(encoded));
+	vilcEncode_VkAccelerationStructureGeometryKHR(&writer, &geometry);
+	CHECK(writer.result == VK_SUCCESS && writer.size < trianglesSize);
+	return 0;
+}
+
+static int testErrors(void)
+{
+	VkDescriptorSet sets[4] = { HANDLE(VkDescriptorSet, 1), HANDLE(VkDescriptorSet, 2), HANDLE(VkDescriptorSet, 3), HANDLE(VkDescriptorSet, 4) };
+	VkBaseInStructure unknown = { VK_STRUCTURE_TYPE_MAX_ENUM };
+	VkMemoryBarrier memoryBarrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+	VkMemoryBarrier chainedBarrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+	VilcCodecArgs_vkCmdBindDescriptorSets args;
+	VilcCodecArgs_vkCmdPipelineBarrier barrierArgs;
+	VilcCodecWriter writer;
+	VilcCodecReader reader;
+	VilcArena arena;
+	size_t size, truncated;
+
+	vilcCodecWriterInit(&writer, encoded, sizeof(encoded));
+	vilcEncode_vkCmdBindDescriptorSets(&writer, HANDLE(VkCommandBuffer, 1), VK_PIPELINE_BIND_POINT_GRAPHICS, HANDLE(VkPipelineLayout, 2), 0, 4, sets, 0, NULL);
+	CHECK(writer.result == VK_SUCCESS);
+	size = writer.size;
+
+	/* a full writer keeps counting the size the encoding needs */
+	vilcCodecWriterInit(&writer, reencoded, 16);
+	vilcEncode_vkCmdBindDescriptorSets(&writer, HANDLE(VkCommandBuffer, 1), VK_PIPELINE_BIND_POINT_GRAPHICS, HANDLE(VkPipelineLayout, 2), 0, 4, sets, 0, NULL);
+	CHECK(writer.result == VK_INCOMPLETE && writer.size == size);
+
+	/* records with truncated parameters fail and the rest decodes as zero */
+	for (truncated = 2 * sizeof(uint32_t); truncated < size; ++truncated)
+	{
+		uint32_t payload = (uint32_t)(truncated - 2 * sizeof(uint32_t));
+
+		memcpy(reencoded, encoded, truncated);
+		memcpy(&reencoded[sizeof(uint32_t)], &payload, sizeof(payload));
+		vilcArenaInit(&arena, arenaMemory, sizeof(arenaMemory));
+		vilcCodecReaderInit(&reader, reencoded, truncated, &arena);
+		memset(&args, 0xff, sizeof(args));
+		CHECK(vilcCodecReadCommand(&reader) == VILC_CODEC_COMMAND_vkCmdBindDescriptorSets);
+		vilcDecode_vkCmdBindDescriptorSets(&reader, &args);
+		CHECK(reader.result == VK_ERROR_FORMAT_NOT_SUPPORTED && args.dynamicOffsetCount == 0 && args.pDynamicOffsets == NULL);
+		CHECK(vilcCodecReadCommand(&reader) == 0);
+	}
+	vilcArenaInit(&arena, arenaMemory, sizeof(arenaMemory));
+	vilcCodecReaderInit(&reader, encoded, size - 1, &arena);
+	vilcDecodeType(&reader, VILC_CODEC_TYPE_vkCmdBindDescriptorSets, &args);
+	CHECK(reader.result == VK_ERROR_FORMAT_NOT_SUPPORTED);
+
+	/* decoding allocates from the arena */
+	vilcArenaInit(&arena, arenaMemory, 2 * sizeof(VkDescriptorSet));
+	vilcCodecReaderInit(&reader, encoded, size, &arena);
+	vilcDecodeType(&reader, VILC_CODEC_TYPE_vkCmdBindDescriptorSets, &args);
+	CHECK(reader.result == VK_ERROR_OUT_OF_HOST_MEMORY && args.pDescriptorSets == NULL);
+	vilcArenaInit(&arena, arenaMemory, 4 * sizeof(VkDescriptorSet));
+	vilcCodecReaderInit(&reader, encoded, size, &arena);
+	vilcDecodeType(&reader, VILC_CODEC_TYPE_vkCmdBindDescriptorSets, &args);
+	CHECK(reader.result == VK_SUCCESS && args.pDescriptorSets[3] == sets[3]);
+	vilcArenaReset(&arena);
+	CHECK(arena.size == 0 && vilcArenaAlloc(&arena, 4 * sizeof(VkDescriptorSet)) != NULL);
+	CHECK(vilcArenaAlloc(&arena, 1) == NULL);
+
+	/* structures unknown to the codec are left out of pNext chains */
+	unknown.pNext = (const VkBaseInStructure*)&chainedBarrier;
+	chainedBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	memoryBarrier.srcAccessMask = VK_ACCESS_HOST_WRITE_BIT;
+	vilcCodecWriterInit(&writer, encoded, sizeof(encoded));
+	vilcEncode_vkCmdPipelineBarrier(&writer, HANDLE(VkCommandBuffer, 1), 0, 0, 0, 0, NULL, 0, NULL, 0, NULL);
+	memoryBarrier.pNext = &unknown;
+	vilcEncode_vkCmdPipelineBarrier(&writer, HANDLE(VkCommandBuffer, 1), 0, 0, 0, 1, &memoryBarrier, 0, NULL, 0, NULL);
+	CHECK(writer.result == VK_ERROR_FORMAT_NOT_SUPPORTED);
+	vilcArenaInit(&arena, arenaMemory, sizeof(arenaMemory));
+	vilcCodecReaderInit(&reader, encoded, writer.size, &arena);
+	CHECK(vilcCodecReadCommand(&reader) == VILC_CODEC_COMMAND_vkCmdPipelineBarrier);
+	vilcCodecSkipCommand(&reader);
+	CHECK(vilcCodecReadCommand(&reader) == VILC_CODEC_COMMAND_vkCmdPipelineBarrier);
+	vilcDecode_vkCmdPipelineBarrier(&reader, &barrierArgs);
+	CHECK(reader.result == VK_SUCCESS && barrierArgs.memoryBarrierCount == 1);
+	CHECK(barrierArgs.pMemoryBarriers[0].srcAccessMask == VK_ACCESS_HOST_WRITE_BIT);
+	CHECK(barrierArgs.pMemoryBarriers[0].pNext && ((const VkMemoryBarrier*)barrierArgs.pMemoryBarriers[0].pNext)->dstAccessMask == VK_ACCESS_SHADER_READ_BIT);
+	CHECK(((const VkMemoryBarrier*)barrierArgs.pMemoryBarriers[0].pNext)->pNext == NULL);
+
+	/* and an sType the decoder does not know fails */
+	{
+		VkMemoryBarrier decoded;
+		uint8_t chain[1 + sizeof(VkStructureType)];
+
+		chain[0] = 1;
+		memcpy(&chain[1], &unknown.sType, sizeof(VkStructureType));
+		vilcCodecWriterInit(&writer, encoded, sizeof(encoded));
+		vilcEncode_VkMemoryBarrier(&writer, &memoryBarrier);
+		/* the chain follows the sType and starts with a presence byte */
+		memcpy(&encoded[sizeof(VkStructureType)], chain, sizeof(chain));
+		vilcCodecReaderInit(&reader, encoded, writer.size, &arena);
+		vilcDecode_VkMemoryBarrier(&reader, &decoded);
+		CHECK(reader.result == VK_ERROR_FORMAT_NOT_SUPPORTED && decoded.pNext == NULL);
+	}
+	return 0;
+}
+
+static double seconds(clock_t start)
+{
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/* A frame of typical commands, encoded into a buffer that is consumed whenever it is full */
+static void benchmark(void)
+{
+	VkDescriptorSet sets[3] = { HANDLE(VkDescriptorSet, 1), HANDLE(VkDescriptorSet, 2), HANDLE(VkDescriptorSet, 3) };
+	VkBuffer buffers[2] = { HANDLE(VkBuffer, 4), HANDLE(VkBuffer, 5) };
+	VkDeviceSize offsets[2] = { 0, 4096 };
+	uint32_t dynamicOffset = 256;
+	float pushConstants[16] = { 0 };
+	VkViewport viewport = { 0, 0, 1920, 1080, 0, 1 };
+	VkImageMemoryBarrier imageBarrier = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+	VkCommandBuffer commandBuffer = HANDLE(VkCommandBuffer, 6);
+	VilcCodecWriter writer;
+	VilcCodecReader reader;
+	VilcArena arena;
+	size_t frameSize, bytes = 0, decodedBytes = 0;
+	double encodeTime, decodeTime;
+	clock_t start;
+	int i, j;
+
+	imageBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	imageBarrier.subresourceRange.levelCount = 1;
+	imageBarrier.subresourceRange.layerCount = 1;
+
+	start = clock();
+	vilcCodecWriterInit(&writer, encoded, sizeof(encoded));
+	for (i = 0; i < BENCHMARK_FRAMES; ++i)
+	{
+		if (writer.capacity - writer.size < 4096)
+		{
+			bytes += writer.size;
+			vilcCodecWriterInit(&writer, encoded, sizeof(encoded));
+		}
+		vilcEncode_vkCmdPipelineBarrier(&writer, commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, NULL, 0, NULL, 1, &imageBarrier);
+		vilcEncode_vkCmdSetViewport(&writer, commandBuffer, 0, 1, &viewport);
+		vilcEncode_vkCmdBindPipeline(&writer, commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, HANDLE(VkPipeline, 7));
+		for (j = 0; j < 8; ++j)
+		{
+			vilcEncode_vkCmdBindDescriptorSets(&writer, commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, HANDLE(VkPipelineLayout, 8), 0, 3, sets, 1, &dynamicOffset);
+			vilcEncode_vkCmdBindVertexBuffers(&writer, commandBuffer, 0, 2, buffers, offsets);
+			vilcEncode_vkCmdPushConstants(&writer, commandBuffer, HANDLE(VkPipelineLayout, 8), VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(pushConstants), pushConstants);
+			vilcEncode_vkCmdDraw(&writer, commandBuffer, 3, 1, 0, 0);
+		}
+	}
+	bytes += writer.size;
+	encodeTime = seconds(start);
+
+	/* the last filled buffer, decoded as many times as it takes to consume the same amount of data */
+	frameSize = writer.size;
+	start = clock();
+	while (decodedBytes < bytes)
+	{
+		vilcArenaInit(&arena, arenaMemory, sizeof(arenaMemory));
+		vilcCodecReaderInit(&reader, encoded, frameSize, &arena);
+		for (;;)
+		{
+			union
+			{
+				VilcCodecArgs_vkCmdPipelineBarrier pipelineBarrier;
+				VilcCodecArgs_vkCmdSetViewport setViewport;
+				VilcCodecArgs_vkCmdBindPipeline bindPipeline;
+				VilcCodecArgs_vkCmdBindDescriptorSets bindDescriptorSets;
+				VilcCodecArgs_vkCmdBindVertexBuffers bindVertexBuffers;
+				VilcCodecArgs_vkCmdPushConstants pushConstants;
+				VilcCodecArgs_vkCmdDraw draw;
+			} args;
+			uint32_t command = vilcCodecReadCommand(&reader);
+
+			if (command == VILC_CODEC_COMMAND_vkCmdPipelineBarrier)
+				vilcDecode_vkCmdPipelineBarrier(&reader, &args.pipelineBarrier);
+			else if (command == VILC_CODEC_COMMAND_vkCmdSetViewport)
+				vilcDecode_vkCmdSetViewport(&reader, &args.setViewport);
+			else if (command == VILC_CODEC_COMMAND_vkCmdBindPipeline)
+				vilcDecode_vkCmdBindPipeline(&reader, &args.bindPipeline);
+			else if (command == VILC_CODEC_COMMAND_vkCmdBindDescriptorSets)
+				vilcDecode_vkCmdBindDescriptorSets(&reader, &args.bindDescriptorSets);
+			else if (command == VILC_CODEC_COMMAND_vkCmdBindVertexBuffers)
+				vilcDecode_vkCmdBindVertexBuffers(&reader, &args.bindVertexBuffers);
+			else if (command == VILC_CODEC_COMMAND_vkCmdPushConstants)
+				vilcDecode_vkCmdPushConstants(&reader, &args.pushConstants);
+			else if (command == VILC_CODEC_COMMAND_vkCmdDraw)
+				vilcDecode_vkCmdDraw(&reader, &args.draw);
+			else
+				break;
+		}
+		decodedBytes += frameSize;
+	}
+	decodeTime = seconds(start);
+
+	printf("codec: encoded %.1f MB at %.0f MB/s\n", bytes / 1e6, encodeTime > 0 ? bytes / 1e6 / encodeTime : 0.0);
+	printf("codec: decoded %.1f MB at %.0f MB/s\n", decodedBytes / 1e6, decodeTime > 0 ? decodedBytes / 1e6 / decodeTime : 0.0);
+}
+
+int main(void)
+{
+	int type;
+
+	for (type = 0; type < VILC_CODEC_TYPE_COUNT; ++type)
+		if (roundTrip((VilcCodecType)type))
+			return 1;
+
+	if (testBarriers() || testRenderPass() || testArrays() || testSelectedUnion() || testErrors())
+		return 1;
+
+	benchmark();
+
+	printf("codec: passed (%d types)\n", VILC_CODEC_TYPE_COUNT);
+	return 0;
+}
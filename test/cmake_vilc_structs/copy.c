@@ -0,0 +1,347 @@
+#define VILC_STRUCTS_IMPLEMENTATION
+#include "vilc_structs.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define CHECK(condition) \
+	if (!(condition)) \
+	{ \
+		printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+		return 1; \
+	}
+
+/* handles are only carried around, so any value will do */
+#define HANDLE(type, value) ((type)(uintptr_t)(value))
+
+#define MAX_TYPE_SIZE 4096
+
+#define BENCHMARK_COPIES 200000
+
+static uint8_t encoded[1 << 16];
+static uint8_t reencoded[1 << 16];
+static uint8_t arenaMemory[1 << 16];
+
+typedef union TypeStorage
+{
+	uint64_t alignment;
+	uint8_t bytes[MAX_TYPE_SIZE];
+} TypeStorage;
+
+/* A graphics pipeline as renderers typically create it: two stages, interleaved vertices and some dynamic state */
+typedef struct PipelineState
+{
+	VkSpecializationMapEntry specializationEntries[2];
+	uint32_t specializationData[2];
+	VkSpecializationInfo specialization;
+	VkPipelineShaderStageCreateInfo stages[2];
+	VkVertexInputBindingDescription bindings[2];
+	VkVertexInputAttributeDescription attributes[4];
+	VkPipelineVertexInputStateCreateInfo vertexInput;
+	VkPipelineInputAssemblyStateCreateInfo inputAssembly;
+	VkPipelineViewportStateCreateInfo viewport;
+	VkPipelineRasterizationStateCreateInfo rasterization;
+	VkSampleMask sampleMask;
+	VkPipelineMultisampleStateCreateInfo multisample;
+	VkPipelineDepthStencilStateCreateInfo depthStencil;
+	VkPipelineColorBlendAttachmentState blendAttachment;
+	VkPipelineColorBlendStateCreateInfo colorBlend;
+	VkDynamicState dynamicStates[2];
+	VkPipelineDynamicStateCreateInfo dynamic;
+	VkFormat colorFormat;
+	VkPipelineRenderingCreateInfo rendering;
+	VkGraphicsPipelineCreateInfo info;
+} PipelineState;
+
+static void initPipeline(PipelineState* state)
+{
+	uint32_t i;
+
+	memset(state, 0, sizeof(*state));
+
+	state->specializationEntries[0].constantID = 0;
+	state->specializationEntries[0].size = sizeof(uint32_t);
+	state->specializationEntries[1].constantID = 1;
+	state->specializationEntries[1].offset = sizeof(uint32_t);
+	state->specializationEntries[1].size = sizeof(uint32_t);
+	state->specializationData[0] = 64;
+	state->specializationData[1] = 1;
+	state->specialization.mapEntryCount = 2;
+	state->specialization.pMapEntries = state->specializationEntries;
+	state->specialization.dataSize = sizeof(state->specializationData);
+	state->specialization.pData = state->specializationData;
+
+	for (i = 0; i < 2; ++i)
+	{
+		state->stages[i].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		state->stages[i].module = HANDLE(VkShaderModule, 0x100 + i);
+		state->stages[i].pName = "main";
+	}
+	state->stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+	state->stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+	state->stages[1].pSpecializationInfo = &state->specialization;
+
+	state->bindings[0].stride = 32;
+	state->bindings[1].binding = 1;
+	state->bindings[1].stride = 16;
+	state->bindings[1].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+	for (i = 0; i < 4; ++i)
+	{
+		state->attributes[i].location = i;
+		state->attributes[i].binding = i / 3;
+		state->attributes[i].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+		state->attributes[i].offset = (i % 3) * 16;
+	}
+	state->vertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+	state->vertexInput.vertexBindingDescriptionCount = 2;
+	state->vertexInput.pVertexBindingDescriptions = state->bindings;
+	state->vertexInput.vertexAttributeDescriptionCount = 4;
+	state->vertexInput.pVertexAttributeDescriptions = state->attributes;
+
+	state->inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+	state->inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+	/* viewports and scissors are dynamic */
+	state->viewport.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+	state->viewport.viewportCount = 1;
+	state->viewport.scissorCount = 1;
+
+	state->rasterization.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+	state->rasterization.cullMode = VK_CULL_MODE_BACK_BIT;
+	state->rasterization.lineWidth = 1.0f;
+
+	state->sampleMask = 0xf;
+	state->multisample.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+	state->multisample.rasterizationSamples = VK_SAMPLE_COUNT_4_BIT;
+	state->multisample.pSampleMask = &state->sampleMask;
+
+	state->depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+	state->depthStencil.depthTestEnable = VK_TRUE;
+	state->depthStencil.depthWriteEnable = VK_TRUE;
+	state->depthStencil.depthCompareOp = VK_COMPARE_OP_GREATER;
+	state->depthStencil.maxDepthBounds = 1.0f;
+
+	state->blendAttachment.colorWriteMask = 0xf;
+	state->colorBlend.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+	state->colorBlend.attachmentCount = 1;
+	state->colorBlend.pAttachments = &state->blendAttachment;
+
+	state->dynamicStates[0] = VK_DYNAMIC_STATE_VIEWPORT;
+	state->dynamicStates[1] = VK_DYNAMIC_STATE_SCISSOR;
+	state->dynamic.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+	state->dynamic.dynamicStateCount = 2;
+	state->dynamic.pDynamicStates = state->dynamicStates;
+
+	state->colorFormat = VK_FORMAT_B8G8R8A8_SRGB;
+	state->rendering.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+	state->rendering.colorAttachmentCount = 1;
+	state->rendering.pColorAttachmentFormats = &state->colorFormat;
+	state->rendering.depthAttachmentFormat = VK_FORMAT_D32_SFLOAT;
+
+	state->info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	state->info.pNext = &state->rendering;
+	state->info.stageCount = 2;
+	state->info.pStages = state->stages;
+	state->info.pVertexInputState = &state->vertexInput;
+	state->info.pInputAssemblyState = &state->inputAssembly;
+	state->info.pViewportState = &state->viewport;
+	state->info.pRasterizationState = &state->rasterization;
+	state->info.pMultisampleState = &state->multisample;
+	state->info.pDepthStencilState = &state->depthStencil;
+	state->info.pColorBlendState = &state->colorBlend;
+	state->info.pDynamicState = &state->dynamic;
+	state->info.layout = HANDLE(VkPipelineLayout, 0x200);
+	state->info.basePipelineIndex = -1;
+}
+
+static int inArena(const VilcArena* arena, const void* pointer)
+{
+	return (const uint8_t*)pointer >= arena->data && (const uint8_t*)pointer < arena->data + arena->size;
+}
+
+static size_t encodeType(uint8_t* data, VilcCodecType type, const void* value)
+{
+	VilcCodecWriter writer;
+
+	vilcCodecWriterInit(&writer, data, sizeof(encoded));
+	vilcEncodeType(&writer, type, value);
+	return writer.result == VK_SUCCESS ? writer.size : 0;
+}
+
+/* Copies a value of every type and checks that the copy encodes to the same bytes */
+static int copyType(VilcCodecType type)
+{
+	VilcCodecTypeInfo info = vilcCodecGetTypeInfo(type);
+	static TypeStorage value;
+	VilcArena arena;
+	void* copy;
+	size_t size, i;
+
+	CHECK(info.name && info.size <= MAX_TYPE_SIZE);
+
+	/* without pointers any bytes make a valid value; otherwise pointers stay NULL and counts 0 */
+	memset(value.bytes, 0, info.size);
+	if (info.flags & VILC_CODEC_TYPE_POINTER_FREE_BIT)
+		for (i = 0; i < info.size; ++i)
+			value.bytes[i] = (uint8_t)(i * 37 + 11);
+	if (info.sType != VK_STRUCTURE_TYPE_MAX_ENUM)
+		memcpy(value.bytes, &info.sType, sizeof(info.sType));
+
+	vilcArenaInit(&arena, arenaMemory, sizeof(arenaMemory));
+	copy = vilcDeepCopyType(&arena, type, value.bytes);
+	if (!copy)
+		printf("copy: %s failed to copy\n", info.name);
+	CHECK(copy != NULL && inArena(&arena, copy));
+	CHECK(info.sType == VK_STRUCTURE_TYPE_MAX_ENUM || vilcGetStructureSize(info.sType) == info.size);
+
+	size = encodeType(encoded, type, value.bytes);
+	CHECK(size != 0 && encodeType(reencoded, type, copy) == size && memcmp(encoded, reencoded, size) == 0);
+	return 0;
+}
+
+static int testPipeline(void)
+{
+	static PipelineState state;
+	const VkGraphicsPipelineCreateInfo* copy;
+	const VkPipelineRenderingCreateInfo* rendering;
+	VilcArena arena;
+	size_t size;
+
+	initPipeline(&state);
+	size = encodeType(encoded, VILC_CODEC_TYPE_VkGraphicsPipelineCreateInfo, &state.info);
+	CHECK(size != 0);
+
+	vilcArenaInit(&arena, arenaMemory, sizeof(arenaMemory));
+	copy = vilcDeepCopy_VkGraphicsPipelineCreateInfo(&arena, &state.info);
+	CHECK(copy != NULL);
+
+	/* nothing of the copy refers to the source anymore */
+	memset(&state, 0xcd, sizeof(state));
+	CHECK(encodeType(reencoded, VILC_CODEC_TYPE_VkGraphicsPipelineCreateInfo, copy) == size && memcmp(encoded, reencoded, size) == 0);
+
+	CHECK(inArena(&arena, copy->pStages) && inArena(&arena, copy->pStages[1].pName) && inArena(&arena, copy->pStages[1].pSpecializationInfo));
+	CHECK(inArena(&arena, copy->pStages[1].pSpecializationInfo->pMapEntries) && inArena(&arena, copy->pStages[1].pSpecializationInfo->pData));
+	CHECK(copy->pStages[1].pSpecializationInfo->mapEntryCount == 2 && ((const uint32_t*)copy->pStages[1].pSpecializationInfo->pData)[0] == 64);
+	CHECK(copy->pVertexInputState->vertexAttributeDescriptionCount == 4 && copy->pVertexInputState->pVertexAttributeDescriptions[3].binding == 1);
+	CHECK(copy->pViewportState->viewportCount == 1 && copy->pViewportState->pViewports == NULL);
+	CHECK(inArena(&arena, copy->pMultisampleState->pSampleMask) && *copy->pMultisampleState->pSampleMask == 0xf);
+	CHECK(copy->pDynamicState->pDynamicStates[1] == VK_DYNAMIC_STATE_SCISSOR && copy->layout == HANDLE(VkPipelineLayout, 0x200));
+
+	rendering = (const VkPipelineRenderingCreateInfo*)copy->pNext;
+	CHECK(inArena(&arena, rendering) && rendering->sType == VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO && rendering->pNext == NULL);
+	CHECK(inArena(&arena, rendering->pColorAttachmentFormats) && rendering->pColorAttachmentFormats[0] == VK_FORMAT_B8G8R8A8_SRGB);
+	return 0;
+}
+
+static int testChains(void)
+{
+	static PipelineState state;
+	uint32_t sliceOffsets[2] = { 0, 4096 };
+	VkVideoDecodeH264PictureInfoKHR pictureInfo = { VK_STRUCTURE_TYPE_VIDEO_DECODE_H264_PICTURE_INFO_KHR };
+	VkMemoryBarrier barrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+	VkBaseInStructure unknown = { VK_STRUCTURE_TYPE_MAX_ENUM };
+	const VkGraphicsPipelineCreateInfo* copy;
+	const VkVideoDecodeH264PictureInfoKHR* pictureCopy;
+	VilcArena arena;
+
+	initPipeline(&state);
+
+	/* the picture info points to a video std structure, which vk.xml does not describe: it is copied by size */
+	pictureInfo.pNext = &barrier;
+	pictureInfo.sliceCount = 2;
+	pictureInfo.pSliceOffsets = sliceOffsets;
+	state.rendering.pNext = &pictureInfo;
+	CHECK(vilcGetStructureSize(VK_STRUCTURE_TYPE_VIDEO_DECODE_H264_PICTURE_INFO_KHR) == sizeof(pictureInfo));
+
+	vilcArenaInit(&arena, arenaMemory, sizeof(arenaMemory));
+	copy = vilcDeepCopy_VkGraphicsPipelineCreateInfo(&arena, &state.info);
+	CHECK(copy != NULL);
+	pictureCopy = (const VkVideoDecodeH264PictureInfoKHR*)((const VkPipelineRenderingCreateInfo*)copy->pNext)->pNext;
+	CHECK(inArena(&arena, pictureCopy) && pictureCopy->sliceCount == 2 && pictureCopy->pSliceOffsets == sliceOffsets);
+
+	/* the rest of the chain is copied deeply again */
+	CHECK(inArena(&arena, pictureCopy->pNext) && ((const VkMemoryBarrier*)pictureCopy->pNext)->sType == VK_STRUCTURE_TYPE_MEMORY_BARRIER);
+	CHECK(((const VkMemoryBarrier*)pictureCopy->pNext)->pNext == NULL);
+
+	/* a structure the headers do not know fails the whole copy instead of cutting the chain short */
+	barrier.pNext = &unknown;
+	vilcArenaInit(&arena, arenaMemory, sizeof(arenaMemory));
+	CHECK(vilcGetStructureSize(VK_STRUCTURE_TYPE_MAX_ENUM) == 0);
+	CHECK(vilcDeepCopy_VkGraphicsPipelineCreateInfo(&arena, &state.info) == NULL && arena.size == 0);
+	CHECK(vilcDeepCopyChain(&arena, &unknown) == NULL && arena.size == 0);
+	return 0;
+}
+
+static int testExhaustion(void)
+{
+	static PipelineState state;
+	VilcArena arena;
+	size_t needed, capacity;
+
+	initPipeline(&state);
+	vilcArenaInit(&arena, arenaMemory, sizeof(arenaMemory));
+	CHECK(vilcDeepCopy_VkGraphicsPipelineCreateInfo(&arena, &state.info) != NULL);
+	needed = arena.size;
+
+	/* a failed copy leaves the arena as it was, so earlier copies stay intact */
+	for (capacity = 0; capacity < needed; ++capacity)
+	{
+		vilcArenaInit(&arena, arenaMemory, capacity);
+		CHECK(vilcDeepCopy_VkGraphicsPipelineCreateInfo(&arena, &state.info) == NULL && arena.size == 0);
+	}
+
+	vilcArenaInit(&arena, arenaMemory, needed);
+	CHECK(vilcDeepCopy_VkGraphicsPipelineCreateInfo(&arena, &state.info) != NULL && arena.size == needed);
+	vilcArenaReset(&arena);
+	CHECK(arena.size == 0 && vilcDeepCopy_VkGraphicsPipelineCreateInfo(&arena, &state.info) != NULL);
+	return 0;
+}
+
+static double seconds(clock_t start)
+{
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/* Copies of a typical graphics pipeline create info, e.g. to compile the pipeline on another thread */
+static void benchmark(void)
+{
+	static PipelineState state;
+	VilcArena arena;
+	size_t bytes = 0;
+	double time;
+	clock_t start;
+	int i;
+
+	initPipeline(&state);
+	vilcArenaInit(&arena, arenaMemory, sizeof(arenaMemory));
+
+	start = clock();
+	for (i = 0; i < BENCHMARK_COPIES; ++i)
+	{
+		vilcArenaReset(&arena);
+		if (!vilcDeepCopy_VkGraphicsPipelineCreateInfo(&arena, &state.info))
+			break;
+		bytes = arena.size;
+	}
+	time = seconds(start);
+
+	printf("copy: %d pipeline create infos of %d bytes at %.0f ns each\n", i, (int)bytes, i > 0 ? time * 1e9 / i : 0.0);
+}
+
+int main(void)
+{
+	int type;
+
+	for (type = 0; type < VILC_CODEC_TYPE_COUNT; ++type)
+		if (copyType((VilcCodecType)type))
+			return 1;
+
+	if (testPipeline() || testChains() || testExhaustion())
+		return 1;
+
+	benchmark();
+
+	printf("copy: passed (%d types)\n", VILC_CODEC_TYPE_COUNT);
+	return 0;
+}
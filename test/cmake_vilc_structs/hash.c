@@ -0,0 +1,342 @@
+#define VILC_STRUCTS_IMPLEMENTATION
+#include "vilc_structs.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define CHECK(condition) \
+	if (!(condition)) \
+	{ \
+		printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+		return 1; \
+	}
+
+/* handles are only carried around, so any value will do */
+#define HANDLE(type, value) ((type)(uintptr_t)(value))
+
+#define MAX_TYPE_SIZE 4096
+
+#define BENCHMARK_HASHES 200000
+
+static uint8_t arenaMemory[1 << 16];
+
+typedef union TypeStorage
+{
+	uint64_t alignment;
+	uint8_t bytes[MAX_TYPE_SIZE];
+} TypeStorage;
+
+/* A graphics pipeline as renderers typically create it: two stages, interleaved vertices and some dynamic state */
+typedef struct PipelineState
+{
+	VkSpecializationMapEntry specializationEntries[2];
+	uint32_t specializationData[2];
+	VkSpecializationInfo specialization;
+	VkPipelineShaderStageCreateInfo stages[2];
+	VkVertexInputBindingDescription bindings[2];
+	VkVertexInputAttributeDescription attributes[4];
+	VkPipelineVertexInputStateCreateInfo vertexInput;
+	VkPipelineInputAssemblyStateCreateInfo inputAssembly;
+	VkPipelineViewportStateCreateInfo viewport;
+	VkPipelineRasterizationStateCreateInfo rasterization;
+	VkSampleMask sampleMask;
+	VkPipelineMultisampleStateCreateInfo multisample;
+	VkPipelineDepthStencilStateCreateInfo depthStencil;
+	VkPipelineColorBlendAttachmentState blendAttachment;
+	VkPipelineColorBlendStateCreateInfo colorBlend;
+	VkDynamicState dynamicStates[2];
+	VkPipelineDynamicStateCreateInfo dynamic;
+	VkFormat colorFormat;
+	VkPipelineRenderingCreateInfo rendering;
+	VkGraphicsPipelineCreateInfo info;
+} PipelineState;
+
+static void initPipeline(PipelineState* state)
+{
+	uint32_t i;
+
+	memset(state, 0, sizeof(*state));
+
+	state->specializationEntries[0].constantID = 0;
+	state->specializationEntries[0].size = sizeof(uint32_t);
+	state->specializationEntries[1].constantID = 1;
+	state->specializationEntries[1].offset = sizeof(uint32_t);
+	state->specializationEntries[1].size = sizeof(uint32_t);
+	state->specializationData[0] = 64;
+	state->specializationData[1] = 1;
+	state->specialization.mapEntryCount = 2;
+	state->specialization.pMapEntries = state->specializationEntries;
+	state->specialization.dataSize = sizeof(state->specializationData);
+	state->specialization.pData = state->specializationData;
+
+	for (i = 0; i < 2; ++i)
+	{
+		state->stages[i].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		state->stages[i].module = HANDLE(VkShaderModule, 0x100 + i);
+		state->stages[i].pName = "main";
+	}
+	state->stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+	state->stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+	state->stages[1].pSpecializationInfo = &state->specialization;
+
+	state->bindings[0].stride = 32;
+	state->bindings[1].binding = 1;
+	state->bindings[1].stride = 16;
+	state->bindings[1].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+	for (i = 0; i < 4; ++i)
+	{
+		state->attributes[i].location = i;
+		state->attributes[i].binding = i / 3;
+		state->attributes[i].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+		state->attributes[i].offset = (i % 3) * 16;
+	}
+	state->vertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+	state->vertexInput.vertexBindingDescriptionCount = 2;
+	state->vertexInput.pVertexBindingDescriptions = state->bindings;
+	state->vertexInput.vertexAttributeDescriptionCount = 4;
+	state->vertexInput.pVertexAttributeDescriptions = state->attributes;
+
+	state->inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+	state->inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+	/* viewports and scissors are dynamic */
+	state->viewport.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+	state->viewport.viewportCount = 1;
+	state->viewport.scissorCount = 1;
+
+	state->rasterization.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+	state->rasterization.cullMode = VK_CULL_MODE_BACK_BIT;
+	state->rasterization.lineWidth = 1.0f;
+
+	state->sampleMask = 0xf;
+	state->multisample.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+	state->multisample.rasterizationSamples = VK_SAMPLE_COUNT_4_BIT;
+	state->multisample.pSampleMask = &state->sampleMask;
+
+	state->depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+	state->depthStencil.depthTestEnable = VK_TRUE;
+	state->depthStencil.depthWriteEnable = VK_TRUE;
+	state->depthStencil.depthCompareOp = VK_COMPARE_OP_GREATER;
+	state->depthStencil.maxDepthBounds = 1.0f;
+
+	state->blendAttachment.colorWriteMask = 0xf;
+	state->colorBlend.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+	state->colorBlend.attachmentCount = 1;
+	state->colorBlend.pAttachments = &state->blendAttachment;
+
+	state->dynamicStates[0] = VK_DYNAMIC_STATE_VIEWPORT;
+	state->dynamicStates[1] = VK_DYNAMIC_STATE_SCISSOR;
+	state->dynamic.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+	state->dynamic.dynamicStateCount = 2;
+	state->dynamic.pDynamicStates = state->dynamicStates;
+
+	state->colorFormat = VK_FORMAT_B8G8R8A8_SRGB;
+	state->rendering.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+	state->rendering.colorAttachmentCount = 1;
+	state->rendering.pColorAttachmentFormats = &state->colorFormat;
+	state->rendering.depthAttachmentFormat = VK_FORMAT_D32_SFLOAT;
+
+	state->info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	state->info.pNext = &state->rendering;
+	state->info.stageCount = 2;
+	state->info.pStages = state->stages;
+	state->info.pVertexInputState = &state->vertexInput;
+	state->info.pInputAssemblyState = &state->inputAssembly;
+	state->info.pViewportState = &state->viewport;
+	state->info.pRasterizationState = &state->rasterization;
+	state->info.pMultisampleState = &state->multisample;
+	state->info.pDepthStencilState = &state->depthStencil;
+	state->info.pColorBlendState = &state->colorBlend;
+	state->info.pDynamicState = &state->dynamic;
+	state->info.layout = HANDLE(VkPipelineLayout, 0x200);
+	state->info.basePipelineIndex = -1;
+}
+
+/* Hashes a value of every type and checks that its deep copy, which shares no pointers with it, hashes and compares the same */
+static int hashType(VilcCodecType type)
+{
+	VilcCodecTypeInfo info = vilcCodecGetTypeInfo(type);
+	static TypeStorage value;
+	VilcArena arena;
+	void* copy;
+	size_t i;
+
+	CHECK(info.name && info.size <= MAX_TYPE_SIZE);
+
+	memset(value.bytes, 0, info.size);
+	if (info.flags & VILC_CODEC_TYPE_POINTER_FREE_BIT)
+		for (i = 0; i < info.size; ++i)
+			value.bytes[i] = (uint8_t)(i * 37 + 11);
+	if (info.sType != VK_STRUCTURE_TYPE_MAX_ENUM)
+		memcpy(value.bytes, &info.sType, sizeof(info.sType));
+
+	vilcArenaInit(&arena, arenaMemory, sizeof(arenaMemory));
+	copy = vilcDeepCopyType(&arena, type, value.bytes);
+	CHECK(copy != NULL);
+
+	if (vilcHashType(type, value.bytes) != vilcHashType(type, copy) || !vilcEqualType(type, value.bytes, copy))
+		printf("hash: %s differs from its copy\n", info.name);
+	CHECK(vilcHashType(type, value.bytes) == vilcHashType(type, copy) && vilcEqualType(type, value.bytes, copy));
+	CHECK(vilcEqualType(type, value.bytes, value.bytes));
+	return 0;
+}
+
+static int same(const VkGraphicsPipelineCreateInfo* a, const VkGraphicsPipelineCreateInfo* b)
+{
+	return vilcHash_VkGraphicsPipelineCreateInfo(a) == vilcHash_VkGraphicsPipelineCreateInfo(b) && vilcEqual_VkGraphicsPipelineCreateInfo(a, b);
+}
+
+static int testPipeline(void)
+{
+	static PipelineState state, other;
+	static const char name[] = "main";
+	VkGraphicsPipelineCreateInfo info;
+	VilcArena arena;
+
+	initPipeline(&state);
+	initPipeline(&other);
+
+	/* padding and the addresses of what the create info points to do not matter */
+	memset(&info, 0xee, sizeof(info));
+	info.sType = other.info.sType;
+	info.pNext = other.info.pNext;
+	info.flags = other.info.flags;
+	info.stageCount = other.info.stageCount;
+	info.pStages = other.info.pStages;
+	info.pVertexInputState = other.info.pVertexInputState;
+	info.pInputAssemblyState = other.info.pInputAssemblyState;
+	info.pTessellationState = other.info.pTessellationState;
+	info.pViewportState = other.info.pViewportState;
+	info.pRasterizationState = other.info.pRasterizationState;
+	info.pMultisampleState = other.info.pMultisampleState;
+	info.pDepthStencilState = other.info.pDepthStencilState;
+	info.pColorBlendState = other.info.pColorBlendState;
+	info.pDynamicState = other.info.pDynamicState;
+	info.layout = other.info.layout;
+	info.renderPass = other.info.renderPass;
+	info.subpass = other.info.subpass;
+	info.basePipelineHandle = other.info.basePipelineHandle;
+	info.basePipelineIndex = other.info.basePipelineIndex;
+	other.stages[0].pName = name;
+	CHECK(same(&state.info, &info));
+
+	vilcArenaInit(&arena, arenaMemory, sizeof(arenaMemory));
+	CHECK(same(&state.info, vilcDeepCopy_VkGraphicsPipelineCreateInfo(&arena, &state.info)));
+
+	/* arrays without elements are the same with and without a pointer */
+	other.viewport.pViewports = (const VkViewport*)&other.rendering;
+	other.viewport.viewportCount = 0;
+	state.viewport.viewportCount = 0;
+	CHECK(same(&state.info, &info));
+	state.viewport.viewportCount = 1;
+	other.viewport.pViewports = NULL;
+	other.viewport.viewportCount = 1;
+
+	/* any change that reaches the driver does */
+	other.rasterization.cullMode = VK_CULL_MODE_NONE;
+	CHECK(!vilcEqual_VkGraphicsPipelineCreateInfo(&state.info, &info) && vilcHash_VkGraphicsPipelineCreateInfo(&state.info) != vilcHash_VkGraphicsPipelineCreateInfo(&info));
+	other.rasterization.cullMode = VK_CULL_MODE_BACK_BIT;
+	other.specializationData[0] = 128;
+	CHECK(!vilcEqual_VkGraphicsPipelineCreateInfo(&state.info, &info) && vilcHash_VkGraphicsPipelineCreateInfo(&state.info) != vilcHash_VkGraphicsPipelineCreateInfo(&info));
+	other.specializationData[0] = 64;
+	other.stages[1].pName = "main2";
+	CHECK(!vilcEqual_VkGraphicsPipelineCreateInfo(&state.info, &info) && vilcHash_VkGraphicsPipelineCreateInfo(&state.info) != vilcHash_VkGraphicsPipelineCreateInfo(&info));
+	other.stages[1].pName = name;
+	other.colorFormat = VK_FORMAT_R8G8B8A8_UNORM;
+	CHECK(!vilcEqual_VkGraphicsPipelineCreateInfo(&state.info, &info) && vilcHash_VkGraphicsPipelineCreateInfo(&state.info) != vilcHash_VkGraphicsPipelineCreateInfo(&info));
+	other.colorFormat = VK_FORMAT_B8G8R8A8_SRGB;
+	info.pNext = NULL;
+	CHECK(!vilcEqual_VkGraphicsPipelineCreateInfo(&state.info, &info) && vilcHash_VkGraphicsPipelineCreateInfo(&state.info) != vilcHash_VkGraphicsPipelineCreateInfo(&info));
+	info.pNext = &other.rendering;
+	info.pDepthStencilState = NULL;
+	CHECK(!vilcEqual_VkGraphicsPipelineCreateInfo(&state.info, &info) && vilcHash_VkGraphicsPipelineCreateInfo(&state.info) != vilcHash_VkGraphicsPipelineCreateInfo(&info));
+	info.pDepthStencilState = &other.depthStencil;
+	CHECK(same(&state.info, &info));
+	return 0;
+}
+
+static int testChains(void)
+{
+	static PipelineState state, other;
+	uint32_t sliceOffsets[2] = { 0, 4096 };
+	VkVideoDecodeH264PictureInfoKHR pictureInfo = { VK_STRUCTURE_TYPE_VIDEO_DECODE_H264_PICTURE_INFO_KHR };
+	VkVideoDecodeH264PictureInfoKHR otherPictureInfo = { VK_STRUCTURE_TYPE_VIDEO_DECODE_H264_PICTURE_INFO_KHR };
+	VkBaseInStructure unknown = { VK_STRUCTURE_TYPE_MAX_ENUM };
+	VkBaseInStructure otherUnknown = { VK_STRUCTURE_TYPE_MAX_ENUM };
+
+	initPipeline(&state);
+	initPipeline(&other);
+
+	/* structures without generated functions compare by their bytes, pointers included */
+	pictureInfo.sliceCount = 2;
+	pictureInfo.pSliceOffsets = sliceOffsets;
+	otherPictureInfo = pictureInfo;
+	state.rendering.pNext = &pictureInfo;
+	other.rendering.pNext = &otherPictureInfo;
+	CHECK(same(&state.info, &other.info));
+	otherPictureInfo.sliceCount = 1;
+	CHECK(!vilcEqual_VkGraphicsPipelineCreateInfo(&state.info, &other.info) && vilcHash_VkGraphicsPipelineCreateInfo(&state.info) != vilcHash_VkGraphicsPipelineCreateInfo(&other.info));
+	otherPictureInfo.sliceCount = 2;
+
+	/* and a structure the headers do not know only equals itself */
+	pictureInfo.pNext = &unknown;
+	otherPictureInfo.pNext = &otherUnknown;
+	CHECK(!vilcEqual_VkGraphicsPipelineCreateInfo(&state.info, &other.info));
+	CHECK(vilcHash_VkGraphicsPipelineCreateInfo(&state.info) == vilcHash_VkGraphicsPipelineCreateInfo(&other.info));
+	otherPictureInfo.pNext = &unknown;
+	CHECK(same(&state.info, &other.info));
+	return 0;
+}
+
+static double seconds(clock_t start)
+{
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/* Lookups of a typical graphics pipeline create info in a pipeline cache: a hash and a comparison with the hit */
+static void benchmark(void)
+{
+	static PipelineState state, other;
+	uint64_t hash = 0;
+	double time;
+	clock_t start;
+	int i;
+
+	initPipeline(&state);
+	initPipeline(&other);
+
+	start = clock();
+	for (i = 0; i < BENCHMARK_HASHES; ++i)
+	{
+		state.info.basePipelineIndex = -1 - (i & 1);
+		hash += vilcHash_VkGraphicsPipelineCreateInfo(&state.info);
+	}
+	time = seconds(start);
+	printf("hash: %d pipeline create infos at %.0f ns each (%x)\n", i, time * 1e9 / i, (unsigned)(hash & 0xf));
+
+	state.info.basePipelineIndex = -1;
+	start = clock();
+	for (i = 0; i < BENCHMARK_HASHES; ++i)
+		if (!vilcEqual_VkGraphicsPipelineCreateInfo(&state.info, &other.info))
+			break;
+	time = seconds(start);
+	printf("hash: %d pipeline create info comparisons at %.0f ns each\n", i, i > 0 ? time * 1e9 / i : 0.0);
+}
+
+int main(void)
+{
+	int type;
+
+	for (type = 0; type < VILC_CODEC_TYPE_COUNT; ++type)
+		if (hashType((VilcCodecType)type))
+			return 1;
+
+	if (testPipeline() || testChains())
+		return 1;
+
+	benchmark();
+
+	printf("hash: passed (%d types)\n", VILC_CODEC_TYPE_COUNT);
+	return 0;
+}
@@ -96,5 +96,33 @@ run_volk_test
 popd
 popd
 
+echo
+echo "cmake_vilc_mock_icd =================================================>"
+echo 
+
+pushd test/cmake_vilc_mock_icd
+reset_build
+pushd _build
+cmake .. || exit 1
+cmake --build . || exit 1
+ctest --output-on-failure
+echo "vilc mock icd tests return code: $?"
+popd
+popd
+
+echo
+echo "cmake_vilc_structs ==================================================>"
+echo 
+
+pushd test/cmake_vilc_structs
+reset_build
+pushd _build
+cmake .. || exit 1
+cmake --build . || exit 1
+ctest --output-on-failure
+echo "vilc structs tests return code: $?"
+popd
+popd
+
 popd
 
@@ -0,0 +1,822 @@
+/**
+ * VOLK in Loader's Cloth
+ *
+ * Extension API of the optional VILC modes. Each function is only available when volk.c is built with
+ * VOLK_IN_LOADERS_CLOTH and the define of the corresponding mode (see README.md), e.g. through VILC_DEFINES.
+ *
+ * This file is part of volk library; see volk.h for version/license details
+ */
+/* clang-format off */
+#ifndef VILC_H_
+#define VILC_H_
+
+#ifndef VULKAN_CORE_H_
+#	include <vulkan/vulkan_core.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define VILC_HISTOGRAM_BUCKET_COUNT 65
+
+/**
+ * Log2 histogram; bucket 0 counts zero values, bucket i counts values in [2^(i-1), 2^i).
+ */
+typedef struct VilcHistogram
+{
+	uint64_t count;
+	uint64_t sum;
+	uint64_t min;
+	uint64_t max;
+	uint64_t buckets[VILC_HISTOGRAM_BUCKET_COUNT];
+} VilcHistogram;
+
+typedef enum VilcWorkloadMetric
+{
+	VILC_WORKLOAD_DRAW_VERTEX_COUNT,
+	VILC_WORKLOAD_DRAW_INDEX_COUNT,
+	VILC_WORKLOAD_DRAW_INSTANCE_COUNT,
+	VILC_WORKLOAD_DRAW_INDIRECT_COUNT,
+	VILC_WORKLOAD_DISPATCH_GROUP_COUNT,
+	VILC_WORKLOAD_COPY_BUFFER_BYTES,
+	VILC_WORKLOAD_UPDATE_BUFFER_BYTES,
+	VILC_WORKLOAD_BARRIER_COUNT,
+	VILC_WORKLOAD_METRIC_COUNT
+} VilcWorkloadMetric;
+
+typedef struct VilcWorkloadStats
+{
+	uint64_t frameCount;
+	VilcHistogram metrics[VILC_WORKLOAD_METRIC_COUNT];
+} VilcWorkloadStats;
+
+/**
+ * Get argument histograms of the last frame and of the whole run; frames end at vkQueuePresentKHR.
+ * Either pointer may be NULL.
+ *
+ * Requires VILC_CHARACTERIZE.
+ */
+void vilcGetWorkloadStats(VilcWorkloadStats* lastFrame, VilcWorkloadStats* run);
+
+typedef enum VilcPerfLint
+{
+	VILC_PERF_LINT_MAP_EVERY_FRAME,
+	VILC_PERF_LINT_SMALL_ALLOCATION,
+	VILC_PERF_LINT_SHADER_MODULE_IN_FRAME,
+	VILC_PERF_LINT_PIPELINE_IN_FRAME,
+	VILC_PERF_LINT_REDUNDANT_BIND,
+	VILC_PERF_LINT_SUBMIT_PER_COMMAND_BUFFER,
+	VILC_PERF_LINT_WAIT_IDLE_IN_FRAME,
+	VILC_PERF_LINT_COUNT
+} VilcPerfLint;
+
+#define VILC_PERF_LINT_STACK_DEPTH 16
+
+typedef struct VilcPerfLintEntry
+{
+	uint64_t count;
+	uint64_t firstFrame;
+	uint32_t stackDepth;
+	void* stack[VILC_PERF_LINT_STACK_DEPTH];
+} VilcPerfLintEntry;
+
+/**
+ * Get occurrence counts of each performance lint, with the frame and the call stack of the first occurrence.
+ * The report is also printed to stderr at vkDestroyDevice.
+ *
+ * Requires VILC_PERF_LINT.
+ */
+void vilcGetPerfLintReport(VilcPerfLintEntry entries[VILC_PERF_LINT_COUNT]);
+
+typedef enum VilcGpuTimingKind
+{
+	VILC_GPU_TIMING_RENDER_PASS,
+	VILC_GPU_TIMING_RENDERING,
+	VILC_GPU_TIMING_DISPATCH,
+	VILC_GPU_TIMING_LABEL
+} VilcGpuTimingKind;
+
+#define VILC_GPU_TIMING_LABEL_SIZE 48
+
+/**
+ * GPU execution time of one region of a submitted command buffer.
+ * When calibrated is VK_TRUE, beginNs/endNs are in the CLOCK_MONOTONIC domain of the host; otherwise they are
+ * nanoseconds in the GPU timestamp domain and only differences between them are meaningful.
+ */
+typedef struct VilcGpuTiming
+{
+	VilcGpuTimingKind kind;
+	VkCommandBuffer commandBuffer;
+	char label[VILC_GPU_TIMING_LABEL_SIZE];
+	uint64_t beginNs;
+	uint64_t endNs;
+	VkBool32 calibrated;
+} VilcGpuTiming;
+
+/**
+ * Move up to maxCount of the oldest resolved GPU timings to pTimings; returns the number written.
+ * Timings are resolved once the submission that executed them is known to be complete.
+ *
+ * Requires VILC_GPU_TIMESTAMPS.
+ */
+uint32_t vilcGetGpuTimings(VilcGpuTiming* pTimings, uint32_t maxCount);
+
+#define VILC_HOST_MEMORY_SCOPE_COUNT 5
+#define VILC_HOST_MEMORY_OBJECT_TYPE_COUNT 64
+
+typedef struct VilcHostMemoryCounter
+{
+	uint64_t bytes;
+	uint64_t peakBytes;
+	uint64_t allocationCount;
+	uint64_t totalAllocationCount;
+} VilcHostMemoryCounter;
+
+typedef struct VilcHostMemoryObjectType
+{
+	VkObjectType objectType;
+	VilcHostMemoryCounter counter;
+} VilcHostMemoryObjectType;
+
+/**
+ * Host memory allocated by the driver through VkAllocationCallbacks.
+ * bytes and allocationCount are currently live; totalAllocationCount also counts reallocations and freed blocks.
+ * scopes and internalScopes are indexed by VkSystemAllocationScope; internalScopes are the driver-internal
+ * allocations reported through pfnInternalAllocation and are not part of total.
+ * objectTypes attributes allocations to the object created or destroyed by the call that passed the callbacks;
+ * VK_OBJECT_TYPE_UNKNOWN collects calls that create no single object.
+ */
+typedef struct VilcHostMemoryStats
+{
+	VilcHostMemoryCounter total;
+	VilcHostMemoryCounter scopes[VILC_HOST_MEMORY_SCOPE_COUNT];
+	VilcHostMemoryCounter internalScopes[VILC_HOST_MEMORY_SCOPE_COUNT];
+	uint32_t objectTypeCount;
+	VilcHostMemoryObjectType objectTypes[VILC_HOST_MEMORY_OBJECT_TYPE_COUNT];
+} VilcHostMemoryStats;
+
+/**
+ * Get the host memory allocated by the driver. Application allocation callbacks are wrapped, and calls that pass
+ * pAllocator == NULL get callbacks that allocate from the C heap. The totals are also printed to stderr at
+ * vkDestroyInstance.
+ *
+ * Requires VILC_HOST_MEMORY_STATS.
+ */
+void vilcGetHostMemoryStats(VilcHostMemoryStats* stats);
+
+/**
+ * Device memory of one memory type or heap as seen through vkAllocateMemory/vkFreeMemory and the vkBind*Memory calls.
+ * Bound bytes are the memory requirements of the buffers and images bound to it, until they are destroyed.
+ */
+typedef struct VilcMemoryCounter
+{
+	uint64_t allocatedBytes;
+	uint64_t peakAllocatedBytes;
+	uint64_t boundBytes;
+	uint32_t allocationCount;
+	uint32_t dedicatedAllocationCount;
+	uint32_t boundResourceCount;
+} VilcMemoryCounter;
+
+/**
+ * When driverBudget is VK_TRUE, budget and usage are the heapBudget and heapUsage of VK_EXT_memory_budget, as of the
+ * last vkAllocateMemory, vkFreeMemory or vkQueuePresentKHR; usage then includes other processes.
+ * Otherwise budget is 80% of the heap size and usage is counter.allocatedBytes.
+ */
+typedef struct VilcMemoryHeapBudget
+{
+	VilcMemoryCounter counter;
+	VkDeviceSize size;
+	VkDeviceSize budget;
+	VkDeviceSize usage;
+} VilcMemoryHeapBudget;
+
+typedef struct VilcMemoryBudget
+{
+	VkBool32 driverBudget;
+	uint32_t allocationCount;
+	uint32_t maxMemoryAllocationCount;
+	uint32_t memoryTypeCount;
+	uint32_t memoryHeapCount;
+	VilcMemoryCounter memoryTypes[VK_MAX_MEMORY_TYPES];
+	VilcMemoryHeapBudget memoryHeaps[VK_MAX_MEMORY_HEAPS];
+} VilcMemoryBudget;
+
+/**
+ * Get the device memory counters of the last created device; only atomic loads, so it can be polled every frame.
+ * The totals are also printed to stderr at vkDestroyDevice.
+ *
+ * Requires VILC_MEMORY_BUDGET.
+ */
+void vilcGetMemoryBudget(VilcMemoryBudget* budget);
+
+/**
+ * hits counts vkCreateShaderModule calls answered with a live module, misses the calls that created a cached module,
+ * and uncached the calls passed through as is (pNext chains, other devices, hash collisions).
+ * modules is the number of live cached modules, references the creates not yet matched by a destroy.
+ */
+typedef struct VilcShaderModuleCacheStats
+{
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t uncached;
+	uint32_t modules;
+	uint32_t references;
+} VilcShaderModuleCacheStats;
+
+/**
+ * Get the counters of the shader module cache of the last created device; they are also printed to stderr at
+ * vkDestroyDevice.
+ *
+ * Requires VILC_SHADER_MODULE_CACHE.
+ */
+void vilcGetShaderModuleCacheStats(VilcShaderModuleCacheStats* stats);
+
+/**
+ * hits counts vkCreateSampler calls answered with a live sampler, misses the calls that created a cached sampler,
+ * and uncached the calls passed through as is (pNext structures other than reduction mode, YCbCr conversion and
+ * custom border color, other devices). samplers is the number of live unique samplers, which is what counts
+ * against maxSamplerAllocationCount; references is the number of creates not yet matched by a destroy.
+ */
+typedef struct VilcSamplerCacheStats
+{
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t uncached;
+	uint32_t samplers;
+	uint32_t references;
+} VilcSamplerCacheStats;
+
+/**
+ * Get the counters of the sampler cache of the last created device; only atomic loads, so it can be polled every
+ * frame. They are also printed to stderr at vkDestroyDevice.
+ *
+ * Requires VILC_SAMPLER_CACHE.
+ */
+void vilcGetSamplerCacheStats(VilcSamplerCacheStats* stats);
+
+/**
+ * hits counts create calls answered with a live layout, misses the calls that created a cached layout, and uncached
+ * the calls passed through as is (unknown pNext structures, set layouts from outside the cache, other devices).
+ * layouts is the number of live cached layouts.
+ */
+typedef struct VilcLayoutCacheCounter
+{
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t uncached;
+	uint32_t layouts;
+} VilcLayoutCacheCounter;
+
+typedef struct VilcLayoutCacheStats
+{
+	VilcLayoutCacheCounter setLayouts;
+	VilcLayoutCacheCounter pipelineLayouts;
+} VilcLayoutCacheStats;
+
+/**
+ * Get the counters of the descriptor set layout and pipeline layout cache of the last created device; they are also
+ * printed to stderr at vkDestroyDevice.
+ *
+ * Requires VILC_LAYOUT_CACHE.
+ */
+void vilcGetLayoutCacheStats(VilcLayoutCacheStats* stats);
+
+/**
+ * loadedBytes is the size of the cache data the internal VkPipelineCache was seeded with, savedBytes the size last
+ * written back; rejectedFiles counts cache files ignored for a header or checksum mismatch.
+ */
+typedef struct VilcPipelineCacheStats
+{
+	uint64_t substitutedCalls;
+	uint64_t loadedBytes;
+	uint64_t savedBytes;
+	uint64_t saveCount;
+	uint32_t rejectedFiles;
+} VilcPipelineCacheStats;
+
+/**
+ * Get the counters of the persistent pipeline cache of the current device; they are also printed to stderr at
+ * vkDestroyDevice.
+ *
+ * Requires VILC_PIPELINE_CACHE.
+ */
+void vilcGetPipelineCacheStats(VilcPipelineCacheStats* stats);
+
+/**
+ * splitCalls counts the create calls split across threads and splitPipelines the pipelines they created;
+ * passedThroughCalls counts the calls passed on whole (too small, dependent on creation order, or with allocation
+ * callbacks). threads is the number of workers started, not counting the calling thread.
+ */
+typedef struct VilcParallelPipelineStats
+{
+	uint64_t splitCalls;
+	uint64_t splitPipelines;
+	uint64_t passedThroughCalls;
+	uint32_t threads;
+} VilcParallelPipelineStats;
+
+/**
+ * Get the counters of parallel pipeline creation; they are also printed to stderr at vkDestroyDevice.
+ *
+ * Requires VILC_PARALLEL_PIPELINES.
+ */
+void vilcGetParallelPipelineStats(VilcParallelPipelineStats* stats);
+
+/**
+ * deferredCalls counts the calls made without a VkDeferredOperationKHR that were deferred to an internal one;
+ * joinedOperations also counts vilcJoinDeferredOperation calls, and poolJoins the joins made by pool threads.
+ * threads is the number of pool threads started, not counting the joining thread.
+ */
+typedef struct VilcDeferredHostOperationStats
+{
+	uint64_t deferredCalls;
+	uint64_t joinedOperations;
+	uint64_t poolJoins;
+	uint32_t threads;
+} VilcDeferredHostOperationStats;
+
+/**
+ * Join a deferred operation from the calling thread and up to vkGetDeferredOperationMaxConcurrencyKHR - 1 pool threads
+ * until it completes, and return its result as vkGetDeferredOperationResultKHR would. The operation is not destroyed.
+ * Returns VK_ERROR_EXTENSION_NOT_PRESENT when the device does not expose VK_KHR_deferred_host_operations.
+ *
+ * Requires VILC_DEFERRED_HOST_OPERATIONS.
+ */
+VkResult vilcJoinDeferredOperation(VkDevice device, VkDeferredOperationKHR operation);
+
+/**
+ * Get the counters of deferred host operations; they are also printed to stderr at vkDestroyDevice.
+ *
+ * Requires VILC_DEFERRED_HOST_OPERATIONS.
+ */
+void vilcGetDeferredHostOperationStats(VilcDeferredHostOperationStats* stats);
+
+typedef enum VilcStateFilterCommand
+{
+	VILC_STATE_FILTER_BIND_PIPELINE,
+	VILC_STATE_FILTER_BIND_DESCRIPTOR_SETS,
+	VILC_STATE_FILTER_BIND_VERTEX_BUFFERS,
+	VILC_STATE_FILTER_BIND_INDEX_BUFFER,
+	VILC_STATE_FILTER_SET_VIEWPORT,
+	VILC_STATE_FILTER_SET_SCISSOR,
+	VILC_STATE_FILTER_PUSH_CONSTANTS,
+	VILC_STATE_FILTER_COMMAND_COUNT
+} VilcStateFilterCommand;
+
+/**
+ * calls counts the filtered commands recorded and elidedCalls the ones dropped, per command. Calls are counted when
+ * their command buffer is ended; lastFrameElidedCalls counts those dropped in the command buffers ended between the
+ * last two vkQueuePresentKHR.
+ */
+typedef struct VilcStateFilterStats
+{
+	uint64_t frameCount;
+	uint64_t lastFrameElidedCalls;
+	uint64_t calls[VILC_STATE_FILTER_COMMAND_COUNT];
+	uint64_t elidedCalls[VILC_STATE_FILTER_COMMAND_COUNT];
+} VilcStateFilterStats;
+
+/**
+ * Get the counters of the state filter; the totals are also printed to stderr at vkDestroyDevice.
+ *
+ * Requires VILC_STATE_FILTER.
+ */
+void vilcGetStateFilterStats(VilcStateFilterStats* stats);
+
+/**
+ * barrierCalls counts the barrier commands that were buffered and flushedCalls the barrier commands they were recorded
+ * as; passedThroughCalls counts the barrier commands recorded unchanged, e.g. inside render passes.
+ */
+typedef struct VilcBarrierCoalescingStats
+{
+	uint64_t barrierCalls;
+	uint64_t flushedCalls;
+	uint64_t passedThroughCalls;
+} VilcBarrierCoalescingStats;
+
+/**
+ * Get the counters of barrier coalescing; they are also printed to stderr at vkDestroyDevice.
+ *
+ * Requires VILC_BARRIER_COALESCING.
+ */
+void vilcGetBarrierCoalescingStats(VilcBarrierCoalescingStats* stats);
+
+/**
+ * droppedImageBarriers counts the image barriers that did not change the layout and were recorded as memory barriers,
+ * and mismatchedImageBarriers the ones whose oldLayout contradicted the layout tracked in their command buffer.
+ */
+typedef struct VilcImageLayoutTrackingStats
+{
+	uint64_t imageBarriers;
+	uint64_t droppedImageBarriers;
+	uint64_t mismatchedImageBarriers;
+	uint64_t hostTransitions;
+	uint64_t droppedHostTransitions;
+} VilcImageLayoutTrackingStats;
+
+/**
+ * Get the counters of image layout tracking; they are also printed to stderr at vkDestroyDevice.
+ *
+ * Requires VILC_IMAGE_LAYOUT_TRACKING.
+ */
+void vilcGetImageLayoutTrackingStats(VilcImageLayoutTrackingStats* stats);
+
+/**
+ * Get the layout an image subresource is in after the command buffers submitted so far and host transitions, or
+ * VK_IMAGE_LAYOUT_MAX_ENUM if it is not known.
+ *
+ * Requires VILC_IMAGE_LAYOUT_TRACKING.
+ */
+VkImageLayout vilcGetImageLayout(VkImage image, const VkImageSubresource* subresource);
+
+/**
+ * batchedDraws counts the vkCmdDraw and vkCmdDrawIndexed calls that were recorded as part of the multiDrawCalls
+ * vkCmdDrawMultiEXT and vkCmdDrawMultiIndexedEXT commands; the other draws were recorded unchanged.
+ */
+typedef struct VilcDrawBatchingStats
+{
+	uint64_t drawCalls;
+	uint64_t batchedDraws;
+	uint64_t multiDrawCalls;
+} VilcDrawBatchingStats;
+
+/**
+ * Get the counters of draw batching; they are also printed to stderr at vkDestroyDevice.
+ *
+ * Requires VILC_DRAW_BATCHING.
+ */
+void vilcGetDrawBatchingStats(VilcDrawBatchingStats* stats);
+
+/**
+ * Commands VILC_DEFERRED_COMMANDS records into the stream of a command buffer instead of passing them to the driver.
+ * A stream is a sequence of records that each start with a VilcRecordedCommand; size is the size of the whole record,
+ * a multiple of 8. The fields after the header are the parameters of the command after commandBuffer, except that a
+ * pointer parameter becomes the byte offset from the start of the record of the array it pointed to, which the record
+ * holds after its fields at a multiple of 8.
+ */
+typedef enum VilcRecordedCommandType
+{
+	VILC_RECORDED_BIND_PIPELINE = 1,
+	VILC_RECORDED_BIND_DESCRIPTOR_SETS,
+	VILC_RECORDED_BIND_INDEX_BUFFER,
+	VILC_RECORDED_BIND_VERTEX_BUFFERS,
+	VILC_RECORDED_SET_VIEWPORT,
+	VILC_RECORDED_SET_SCISSOR,
+	VILC_RECORDED_SET_LINE_WIDTH,
+	VILC_RECORDED_PUSH_CONSTANTS,
+	VILC_RECORDED_DRAW,
+	VILC_RECORDED_DRAW_INDEXED,
+	VILC_RECORDED_DRAW_INDIRECT,
+	VILC_RECORDED_DRAW_INDEXED_INDIRECT,
+	VILC_RECORDED_DISPATCH,
+	VILC_RECORDED_DISPATCH_INDIRECT,
+	VILC_RECORDED_COPY_BUFFER,
+	VILC_RECORDED_UPDATE_BUFFER,
+	VILC_RECORDED_FILL_BUFFER
+} VilcRecordedCommandType;
+
+typedef struct VilcRecordedCommand
+{
+	uint32_t type;
+	uint32_t size;
+} VilcRecordedCommand;
+
+typedef struct VilcRecordedBindPipeline
+{
+	VilcRecordedCommand header;
+	VkPipelineBindPoint pipelineBindPoint;
+	VkPipeline pipeline;
+} VilcRecordedBindPipeline;
+
+typedef struct VilcRecordedBindDescriptorSets
+{
+	VilcRecordedCommand header;
+	VkPipelineBindPoint pipelineBindPoint;
+	VkPipelineLayout layout;
+	uint32_t firstSet;
+	uint32_t descriptorSetCount;
+	uint32_t pDescriptorSets;
+	uint32_t dynamicOffsetCount;
+	uint32_t pDynamicOffsets;
+} VilcRecordedBindDescriptorSets;
+
+typedef struct VilcRecordedBindIndexBuffer
+{
+	VilcRecordedCommand header;
+	VkBuffer buffer;
+	VkDeviceSize offset;
+	VkIndexType indexType;
+} VilcRecordedBindIndexBuffer;
+
+typedef struct VilcRecordedBindVertexBuffers
+{
+	VilcRecordedCommand header;
+	uint32_t firstBinding;
+	uint32_t bindingCount;
+	uint32_t pBuffers;
+	uint32_t pOffsets;
+} VilcRecordedBindVertexBuffers;
+
+/* also used for VILC_RECORDED_SET_SCISSOR, with the scissors in place of the viewports */
+typedef struct VilcRecordedSetViewport
+{
+	VilcRecordedCommand header;
+	uint32_t firstViewport;
+	uint32_t viewportCount;
+	uint32_t pViewports;
+} VilcRecordedSetViewport;
+
+typedef struct VilcRecordedSetLineWidth
+{
+	VilcRecordedCommand header;
+	float lineWidth;
+} VilcRecordedSetLineWidth;
+
+typedef struct VilcRecordedPushConstants
+{
+	VilcRecordedCommand header;
+	VkPipelineLayout layout;
+	VkShaderStageFlags stageFlags;
+	uint32_t offset;
+	uint32_t size;
+	uint32_t pValues;
+} VilcRecordedPushConstants;
+
+typedef struct VilcRecordedDraw
+{
+	VilcRecordedCommand header;
+	uint32_t vertexCount;
+	uint32_t instanceCount;
+	uint32_t firstVertex;
+	uint32_t firstInstance;
+} VilcRecordedDraw;
+
+typedef struct VilcRecordedDrawIndexed
+{
+	VilcRecordedCommand header;
+	uint32_t indexCount;
+	uint32_t instanceCount;
+	uint32_t firstIndex;
+	int32_t vertexOffset;
+	uint32_t firstInstance;
+} VilcRecordedDrawIndexed;
+
+/* also used for VILC_RECORDED_DRAW_INDEXED_INDIRECT */
+typedef struct VilcRecordedDrawIndirect
+{
+	VilcRecordedCommand header;
+	VkBuffer buffer;
+	VkDeviceSize offset;
+	uint32_t drawCount;
+	uint32_t stride;
+} VilcRecordedDrawIndirect;
+
+typedef struct VilcRecordedDispatch
+{
+	VilcRecordedCommand header;
+	uint32_t groupCountX;
+	uint32_t groupCountY;
+	uint32_t groupCountZ;
+} VilcRecordedDispatch;
+
+typedef struct VilcRecordedDispatchIndirect
+{
+	VilcRecordedCommand header;
+	VkBuffer buffer;
+	VkDeviceSize offset;
+} VilcRecordedDispatchIndirect;
+
+typedef struct VilcRecordedCopyBuffer
+{
+	VilcRecordedCommand header;
+	VkBuffer srcBuffer;
+	VkBuffer dstBuffer;
+	uint32_t regionCount;
+	uint32_t pRegions;
+} VilcRecordedCopyBuffer;
+
+typedef struct VilcRecordedUpdateBuffer
+{
+	VilcRecordedCommand header;
+	VkBuffer dstBuffer;
+	VkDeviceSize dstOffset;
+	VkDeviceSize dataSize;
+	uint32_t pData;
+} VilcRecordedUpdateBuffer;
+
+typedef struct VilcRecordedFillBuffer
+{
+	VilcRecordedCommand header;
+	VkBuffer dstBuffer;
+	VkDeviceSize dstOffset;
+	VkDeviceSize size;
+	uint32_t data;
+} VilcRecordedFillBuffer;
+
+/**
+ * Device entry point VILC_DEFERRED_COMMANDS looks up with vkGetDeviceProcAddr. An ICD that provides it records a
+ * whole stream of recorded commands into commandBuffer in one call; streams are replayed through the other VILC modes
+ * command by command instead when it is missing or when those modes intercept any of the recorded commands.
+ */
+#define VILC_EXECUTE_RECORDED_COMMANDS_NAME "vilcCmdExecuteRecordedCommands"
+
+typedef void (VKAPI_PTR* PFN_vilcCmdExecuteRecordedCommands)(VkCommandBuffer commandBuffer, const void* pStream, size_t size);
+
+/**
+ * A stream ends at vkEndCommandBuffer, or before the first command that is not recorded; replayedStreams and
+ * executedStreams count the streams replayed command by command and passed to vilcCmdExecuteRecordedCommands.
+ * arenaAllocations counts the times the stream memory of a command buffer had to grow, which stops once recordings
+ * fit in the memory kept from earlier ones.
+ */
+typedef struct VilcDeferredCommandsStats
+{
+	uint64_t recordedCommands;
+	uint64_t replayedStreams;
+	uint64_t executedStreams;
+	uint64_t streamBytes;
+	uint64_t arenaAllocations;
+} VilcDeferredCommandsStats;
+
+/**
+ * Get the counters of deferred command recording; they are also printed to stderr at vkDestroyDevice.
+ *
+ * Requires VILC_DEFERRED_COMMANDS.
+ */
+void vilcGetDeferredCommandsStats(VilcDeferredCommandsStats* stats);
+
+/**
+ * queuedSubmits and queuedPresents count the calls the submission threads made to the driver, passedThroughCalls the
+ * ones made from the calling thread after draining the rings, and drains the waits that found calls still queued.
+ * ringFullWaits counts the calls that waited for a free ring slot, and threads the submission threads started.
+ * callerTime is the nanoseconds a queued call took on the calling thread, queueLatency the nanoseconds from the call
+ * until the driver was called, and driverTime the nanoseconds the driver took on the submission thread.
+ */
+typedef struct VilcSubmitThreadStats
+{
+	uint64_t queuedSubmits;
+	uint64_t queuedPresents;
+	uint64_t passedThroughCalls;
+	uint64_t drains;
+	uint64_t ringFullWaits;
+	uint32_t threads;
+	VilcHistogram callerTime;
+	VilcHistogram queueLatency;
+	VilcHistogram driverTime;
+} VilcSubmitThreadStats;
+
+/**
+ * Get the counters and timings of the submission threads; they are also printed to stderr at vkDestroyDevice.
+ *
+ * Requires VILC_SUBMIT_THREAD.
+ */
+void vilcGetSubmitThreadStats(VilcSubmitThreadStats* stats);
+
+/**
+ * heldCalls counts the vkQueueSubmit(2) calls held to be merged and driverSubmits the driver calls they were made
+ * with; passedThroughCalls counts the calls made as they were. The other counters count the driver calls made for
+ * each cause: a call with a fence, a present, a host wait or query or a call waiting on semaphores on another queue
+ * (syncFlushes), a queue call that has to follow the held ones (orderFlushes), VILC_SUBMIT_MERGING_MAX_CALLS held calls
+ * (countFlushes) and VILC_SUBMIT_MERGING_WINDOW_US passing (timeFlushes).
+ */
+typedef struct VilcSubmitMergingStats
+{
+	uint64_t heldCalls;
+	uint64_t driverSubmits;
+	uint64_t passedThroughCalls;
+	uint64_t fenceFlushes;
+	uint64_t presentFlushes;
+	uint64_t syncFlushes;
+	uint64_t orderFlushes;
+	uint64_t countFlushes;
+	uint64_t timeFlushes;
+} VilcSubmitMergingStats;
+
+/**
+ * Get the counters of submit merging; they are also printed to stderr at vkDestroyDevice.
+ *
+ * Requires VILC_SUBMIT_MERGING.
+ */
+void vilcGetSubmitMergingStats(VilcSubmitMergingStats* stats);
+
+/**
+ * mapCalls counts the vkMapMemory(2) calls answered from cached mappings and driverMaps the mappings the driver made
+ * for them; elidedUnmaps counts the unmaps that did not reach the driver. flushedRanges and invalidatedRanges count the
+ * ranges passed to vkFlushMappedMemoryRanges and vkInvalidateMappedMemoryRanges, and driverFlushes and
+ * driverInvalidates the driver calls made for them. mergedRanges counts the ranges merged into others of the same
+ * allocation and coherentRanges the ranges of host-coherent memory dropped. liveMappings and mappedBytes describe the
+ * mappings currently cached.
+ */
+typedef struct VilcMappingCacheStats
+{
+	uint64_t mapCalls;
+	uint64_t driverMaps;
+	uint64_t elidedUnmaps;
+	uint64_t flushedRanges;
+	uint64_t driverFlushes;
+	uint64_t invalidatedRanges;
+	uint64_t driverInvalidates;
+	uint64_t mergedRanges;
+	uint64_t coherentRanges;
+	uint32_t liveMappings;
+	uint64_t mappedBytes;
+} VilcMappingCacheStats;
+
+/**
+ * Get the counters of the mapping cache; they are also printed to stderr at vkDestroyDevice.
+ *
+ * Requires VILC_MAPPING_CACHE.
+ */
+void vilcGetMappingCacheStats(VilcMappingCacheStats* stats);
+
+/**
+ * suballocations counts the vkAllocateMemory calls served from blocks, passedThroughAllocations the ones that reached
+ * the driver as they were, and blockAllocations the blocks allocated from the driver. The live suballocations take
+ * requestedBytes of the blockBytes of the live blocks, in buddy nodes of usedBytes; usedBytes - requestedBytes is lost
+ * to rounding. largestFreeBytes is the largest free node, so 1 - largestFreeBytes / (blockBytes - usedBytes) measures
+ * how fragmented the free space of the blocks is.
+ */
+typedef struct VilcMemorySuballocatorStats
+{
+	uint64_t suballocations;
+	uint64_t passedThroughAllocations;
+	uint64_t blockAllocations;
+	uint32_t liveSuballocations;
+	uint32_t liveBlocks;
+	uint64_t blockBytes;
+	uint64_t usedBytes;
+	uint64_t requestedBytes;
+	uint64_t largestFreeBytes;
+} VilcMemorySuballocatorStats;
+
+/**
+ * Get the counters of the memory suballocator; they are also printed to stderr at vkDestroyDevice.
+ *
+ * Requires VILC_MEMORY_SUBALLOCATOR.
+ */
+void vilcGetMemorySuballocatorStats(VilcMemorySuballocatorStats* stats);
+
+/**
+ * allocatedSets counts the sets returned by vkAllocateDescriptorSets, recycledSets the ones of them taken from
+ * freelists, and driverAllocations the driver calls made for the others; outOfPoolErrors counts the driver calls that
+ * ran out of pool memory and moved on to the next pool of the chain. grownPools counts the driver pools added to chains,
+ * recycledPools the vkCreateDescriptorPool calls served by a parked chain and passedThroughPools the ones that reached
+ * the driver as they were. livePools and parkedPools count the chains in use and parked, and driverPools the driver
+ * pools of both. allocationTime is the nanoseconds vkAllocateDescriptorSets took.
+ */
+typedef struct VilcDescriptorAllocatorStats
+{
+	uint64_t allocatedSets;
+	uint64_t recycledSets;
+	uint64_t driverAllocations;
+	uint64_t outOfPoolErrors;
+	uint64_t grownPools;
+	uint64_t recycledPools;
+	uint64_t passedThroughPools;
+	uint32_t livePools;
+	uint32_t parkedPools;
+	uint32_t driverPools;
+	VilcHistogram allocationTime;
+} VilcDescriptorAllocatorStats;
+
+/**
+ * Get the counters and timings of the descriptor allocator; they are also printed to stderr at vkDestroyDevice.
+ *
+ * Requires VILC_DESCRIPTOR_ALLOCATOR.
+ */
+void vilcGetDescriptorAllocatorStats(VilcDescriptorAllocatorStats* stats);
+
+/**
+ * allocatedSets counts the sets vkAllocateDescriptorSets returned handles of the mode for, and passedThroughSets the
+ * ones that reached the driver as they were; recordedUpdates counts the writes, copies and template updates stored into
+ * sets. reusedSets counts the first binds of sets that found a driver set with the same layout and content, driverSets
+ * the driver sets allocated for the others and privateSets the ones allocated for sets updated after they were bound.
+ * retiredSets counts the driver sets freed after VILC_DESCRIPTOR_REUSE_FRAMES presents without a set bound as them,
+ * and liveDriverSets the driver sets allocated now.
+ */
+typedef struct VilcDescriptorReuseStats
+{
+	uint64_t allocatedSets;
+	uint64_t passedThroughSets;
+	uint64_t recordedUpdates;
+	uint64_t reusedSets;
+	uint64_t driverSets;
+	uint64_t privateSets;
+	uint64_t retiredSets;
+	uint32_t liveDriverSets;
+} VilcDescriptorReuseStats;
+
+/**
+ * Get the counters of descriptor set reuse; they are also printed to stderr at vkDestroyDevice.
+ *
+ * Requires VILC_DESCRIPTOR_REUSE.
+ */
+void vilcGetDescriptorReuseStats(VilcDescriptorReuseStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // VILC_H_
+/* clang-format on */
@@ -0,0 +1,745 @@
+/**
+ * VOLK in Loader's Cloth
+ *
+ * Functions over Vulkan commands and structures, generated from vk.xml by generate.py. They only need the Vulkan
+ * headers, so applications can use them without the rest of VILC. Define VILC_STRUCTS_IMPLEMENTATION in one source
+ * file before including this header to compile the definitions.
+ *
+ * This file is part of volk library; see volk.h for version/license details
+ */
+/* clang-format off */
+#ifndef VILC_STRUCTS_H_
+#define VILC_STRUCTS_H_
+
+#ifndef VULKAN_CORE_H_
+#	include <vulkan/vulkan_core.h>
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Bump allocator over memory owned by the caller. Allocations are 8-byte aligned and released all at once by
+ * vilcArenaReset; vilcArenaAlloc returns NULL when the memory is exhausted.
+ */
+typedef struct VilcArena
+{
+	uint8_t* data;
+	size_t capacity;
+	size_t size;
+} VilcArena;
+
+void vilcArenaInit(VilcArena* arena, void* data, size_t capacity);
+void* vilcArenaAlloc(VilcArena* arena, size_t size);
+void vilcArenaReset(VilcArena* arena);
+
+/**
+ * Binary encoding of commands and structures, e.g. to pass command streams between processes or to store them.
+ *
+ * Values are written in host byte order without padding: scalars, enums and flags with their C size, non-dispatchable
+ * handles as 64-bit IDs. Dispatchable handles, size_t values, function pointers and host addresses take 64 bits too.
+ * Arrays and optional pointers to one element start with a 32-bit element count, VILC_CODEC_NULL when the pointer is
+ * NULL; strings are arrays of chars with the terminator. A pNext chain is a byte telling whether a structure follows,
+ * then that structure starting with its sType. Unions are written as the member their selector picks, else as their
+ * widest member. Arrays with a stride are written packed, and so is the stride parameter.
+ * Commands are records: the 32-bit VILC_CODEC_COMMAND_<name> ID, the 32-bit size of the parameters, then the parameters.
+ */
+#define VILC_CODEC_NULL 0xffffffffu
+
+/**
+ * Encoders write to memory owned by the caller and never allocate. Once it is full, size keeps counting the bytes the
+ * encoding needs and result is VK_INCOMPLETE. Structures in pNext chains unknown to the codec are left out and make
+ * result VK_ERROR_FORMAT_NOT_SUPPORTED.
+ */
+typedef struct VilcCodecWriter
+{
+	uint8_t* data;
+	size_t capacity;
+	size_t size;
+	VkResult result;
+} VilcCodecWriter;
+
+/**
+ * Decoders allocate the arrays, strings and pNext structures they return from the arena, so decoded values live until
+ * it is reset. The first error stops decoding: result is VK_ERROR_OUT_OF_HOST_MEMORY when the arena is exhausted and
+ * VK_ERROR_FORMAT_NOT_SUPPORTED for truncated or unknown data, and the remaining values decode as zero.
+ */
+typedef struct VilcCodecReader
+{
+	const uint8_t* data;
+	size_t size;
+	size_t offset;
+	size_t recordEnd;
+	VilcArena* arena;
+	VkResult result;
+} VilcCodecReader;
+
+void vilcCodecWriterInit(VilcCodecWriter* writer, void* data, size_t capacity);
+void vilcCodecReaderInit(VilcCodecReader* reader, const void* data, size_t size, VilcArena* arena);
+
+/**
+ * Read the header of the next command record and return its VILC_CODEC_COMMAND_<name> ID, or 0 at the end of the data
+ * and after an error. The record is then read with vilcDecode_<name> or skipped with vilcCodecSkipCommand.
+ */
+uint32_t vilcCodecReadCommand(VilcCodecReader* reader);
+void vilcCodecSkipCommand(VilcCodecReader* reader);
+
+typedef enum VilcCodecType
+{
+	/* VOLK_GENERATE_CODEC_TYPES_H */
+	/* VOLK_GENERATE_CODEC_TYPES_H */
+	VILC_CODEC_TYPE_COUNT
+} VilcCodecType;
+
+#define VILC_CODEC_TYPE_COMMAND_BIT 0x1
+#define VILC_CODEC_TYPE_POINTER_FREE_BIT 0x2
+
+typedef struct VilcCodecTypeInfo
+{
+	const char* name;
+	size_t size;
+	VkStructureType sType;
+	uint32_t flags;
+} VilcCodecTypeInfo;
+
+/**
+ * Type-erased access to every generated type, e.g. to walk all of them in tools and tests. A command type stands for its
+ * VilcCodecArgs_<name> structure and is encoded as a whole record. Types without sType get VK_STRUCTURE_TYPE_MAX_ENUM.
+ */
+VilcCodecTypeInfo vilcCodecGetTypeInfo(VilcCodecType type);
+void vilcEncodeType(VilcCodecWriter* writer, VilcCodecType type, const void* value);
+void vilcDecodeType(VilcCodecReader* reader, VilcCodecType type, void* value);
+
+/* VOLK_GENERATE_CODEC_H */
+/* VOLK_GENERATE_CODEC_H */
+
+/**
+ * Deep copies, e.g. to keep the parameters of calls that are deferred or replayed. vilcDeepCopy_<name> copies a structure
+ * into the arena together with its arrays, strings, the structures it points to and its pNext chain, so the copy lives
+ * until the arena is reset. Host addresses such as pUserData and function pointers are copied as they are.
+ * Structures in a pNext chain that have no generated copy are copied by size, keeping their own pointers.
+ * A copy returns NULL and leaves the arena as it was when the arena is exhausted or a pNext chain holds a structure
+ * unknown to the Vulkan headers, so chains are never cut short.
+ */
+void* vilcDeepCopyChain(VilcArena* arena, const void* next);
+void* vilcDeepCopyType(VilcArena* arena, VilcCodecType type, const void* value);
+
+/* Size of the structure with the sType, 0 for structures unknown to the Vulkan headers */
+size_t vilcGetStructureSize(VkStructureType sType);
+
+/* VOLK_GENERATE_COPY_H */
+/* VOLK_GENERATE_COPY_H */
+
+/**
+ * Structural hashing and equality, e.g. to cache objects by their create infos. vilcHash_<name> and vilcEqual_<name>
+ * follow arrays, strings, the structures a structure points to and its pNext chain in order, and values that compare
+ * equal hash the same. Padding, union members the selector does not pick and array pointers without elements are
+ * ignored; handles, host addresses and floats compare by their bits. Structures in pNext chains without generated
+ * functions compare equal when their bytes after pNext are identical.
+ */
+uint64_t vilcHashType(VilcCodecType type, const void* value);
+VkBool32 vilcEqualType(VilcCodecType type, const void* a, const void* b);
+
+/* VOLK_GENERATE_HASH_H */
+/* VOLK_GENERATE_HASH_H */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VILC_STRUCTS_H_ */
+
+#ifdef VILC_STRUCTS_IMPLEMENTATION
+#undef VILC_STRUCTS_IMPLEMENTATION
+
+#include <string.h>
+
+void vilcArenaInit(VilcArena* arena, void* data, size_t capacity)
+{
+	arena->data = (uint8_t*)data;
+	arena->capacity = capacity;
+	arena->size = 0;
+}
+
+void* vilcArenaAlloc(VilcArena* arena, size_t size)
+{
+	size_t offset = arena->size + ((8 - (((uintptr_t)arena->data + arena->size) & 7)) & 7);
+
+	if (offset > arena->capacity || size > arena->capacity - offset)
+		return NULL;
+	arena->size = offset + size;
+	return arena->data + offset;
+}
+
+void vilcArenaReset(VilcArena* arena)
+{
+	arena->size = 0;
+}
+
+/* errors replace VK_INCOMPLETE, otherwise the first result is kept */
+static void vilc_codecFail(VkResult* result, VkResult error)
+{
+	if (*result == VK_SUCCESS || (*result > 0 && error < 0))
+		*result = error;
+}
+
+void vilcCodecWriterInit(VilcCodecWriter* writer, void* data, size_t capacity)
+{
+	writer->data = (uint8_t*)data;
+	writer->capacity = capacity;
+	writer->size = 0;
+	writer->result = VK_SUCCESS;
+}
+
+static void vilc_codecWrite(VilcCodecWriter* writer, const void* data, size_t size)
+{
+	if (writer->size <= writer->capacity && size <= writer->capacity - writer->size)
+	{
+		if (size)
+			memcpy(writer->data + writer->size, data, size);
+	}
+	else
+		vilc_codecFail(&writer->result, VK_INCOMPLETE);
+	writer->size += size;
+}
+
+static void vilc_codecWriteU64(VilcCodecWriter* writer, uint64_t value)
+{
+	vilc_codecWrite(writer, &value, sizeof(value));
+}
+
+/* returns the number of elements to write after the count, 0 for a NULL pointer */
+static size_t vilc_codecWriteCount(VilcCodecWriter* writer, const void* data, size_t count)
+{
+	uint32_t value = data ? (uint32_t)count : VILC_CODEC_NULL;
+
+	if (data && count >= VILC_CODEC_NULL)
+	{
+		vilc_codecFail(&writer->result, VK_ERROR_FORMAT_NOT_SUPPORTED);
+		value = 0;
+	}
+	vilc_codecWrite(writer, &value, sizeof(value));
+	return data && value != VILC_CODEC_NULL ? value : 0;
+}
+
+static void vilc_codecWriteString(VilcCodecWriter* writer, const char* string)
+{
+	size_t length = vilc_codecWriteCount(writer, string, string ? strlen(string) + 1 : 0);
+
+	vilc_codecWrite(writer, string, length);
+}
+
+static size_t vilc_codecBeginRecord(VilcCodecWriter* writer, uint32_t command)
+{
+	size_t record = writer->size;
+	uint32_t header[2];
+
+	header[0] = command;
+	header[1] = 0;
+	vilc_codecWrite(writer, header, sizeof(header));
+	return record;
+}
+
+static void vilc_codecEndRecord(VilcCodecWriter* writer, size_t record)
+{
+	uint32_t size = (uint32_t)(writer->size - record - 2 * sizeof(uint32_t));
+
+	if (writer->size <= writer->capacity)
+		memcpy(writer->data + record + sizeof(uint32_t), &size, sizeof(size));
+}
+
+void vilcCodecReaderInit(VilcCodecReader* reader, const void* data, size_t size, VilcArena* arena)
+{
+	reader->data = (const uint8_t*)data;
+	reader->size = size;
+	reader->offset = 0;
+	reader->recordEnd = 0;
+	reader->arena = arena;
+	reader->result = VK_SUCCESS;
+}
+
+static void vilc_codecFailRead(VilcCodecReader* reader, VkResult error)
+{
+	vilc_codecFail(&reader->result, error);
+	reader->offset = reader->size;
+	reader->recordEnd = reader->size;
+}
+
+static void vilc_codecRead(VilcCodecReader* reader, void* data, size_t size)
+{
+	if (size > reader->size - reader->offset)
+	{
+		vilc_codecFailRead(reader, VK_ERROR_FORMAT_NOT_SUPPORTED);
+		memset(data, 0, size);
+	}
+	else if (size)
+	{
+		memcpy(data, reader->data + reader->offset, size);
+		reader->offset += size;
+	}
+}
+
+static uint64_t vilc_codecReadU64(VilcCodecReader* reader)
+{
+	uint64_t value;
+
+	vilc_codecRead(reader, &value, sizeof(value));
+	return value;
+}
+
+static void* vilc_codecAlloc(VilcCodecReader* reader, size_t size)
+{
+	void* result = vilcArenaAlloc(reader->arena, size);
+
+	if (!result)
+		vilc_codecFailRead(reader, VK_ERROR_OUT_OF_HOST_MEMORY);
+	return result;
+}
+
+/* reads an element count and allocates the elements; NULL with a count of 0 for a NULL pointer */
+static void* vilc_codecReadArray(VilcCodecReader* reader, size_t elementSize, size_t* count)
+{
+	uint32_t value = VILC_CODEC_NULL;
+	void* result;
+
+	*count = 0;
+	vilc_codecRead(reader, &value, sizeof(value));
+	if (reader->result != VK_SUCCESS || value == VILC_CODEC_NULL)
+		return NULL;
+	/* every element takes at least one byte, which bounds the allocation by the size of the data */
+	if (value > reader->size - reader->offset || value > SIZE_MAX / elementSize)
+	{
+		vilc_codecFailRead(reader, VK_ERROR_FORMAT_NOT_SUPPORTED);
+		return NULL;
+	}
+	result = vilc_codecAlloc(reader, value * elementSize);
+	if (result)
+		*count = value;
+	return result;
+}
+
+static const char* vilc_codecReadString(VilcCodecReader* reader)
+{
+	size_t length = 0;
+	char* string = (char*)vilc_codecReadArray(reader, 1, &length);
+
+	vilc_codecRead(reader, string, length);
+	if (string && (length == 0 || string[length - 1] != '\0'))
+	{
+		vilc_codecFailRead(reader, VK_ERROR_FORMAT_NOT_SUPPORTED);
+		return NULL;
+	}
+	return string;
+}
+
+uint32_t vilcCodecReadCommand(VilcCodecReader* reader)
+{
+	uint32_t header[2];
+
+	if (reader->result != VK_SUCCESS || reader->offset == reader->size)
+		return 0;
+	vilc_codecRead(reader, header, sizeof(header));
+	if (reader->result != VK_SUCCESS)
+		return 0;
+	if (header[1] > reader->size - reader->offset)
+	{
+		vilc_codecFailRead(reader, VK_ERROR_FORMAT_NOT_SUPPORTED);
+		return 0;
+	}
+	reader->recordEnd = reader->offset + header[1];
+	return header[0];
+}
+
+void vilcCodecSkipCommand(VilcCodecReader* reader)
+{
+	if (reader->result == VK_SUCCESS)
+		reader->offset = reader->recordEnd;
+}
+
+static int vilc_codecExpectCommand(VilcCodecReader* reader, uint32_t command)
+{
+	if (vilcCodecReadCommand(reader) == command)
+		return 1;
+	vilc_codecFailRead(reader, VK_ERROR_FORMAT_NOT_SUPPORTED);
+	return 0;
+}
+
+/* the parameters of a record must end exactly at its size */
+static void vilc_codecEndRead(VilcCodecReader* reader)
+{
+	if (reader->offset != reader->recordEnd)
+		vilc_codecFailRead(reader, VK_ERROR_FORMAT_NOT_SUPPORTED);
+}
+
+static void vilc_codecEncodeNext(VilcCodecWriter* writer, const void* next);
+static void* vilc_codecDecodeNext(VilcCodecReader* reader);
+
+/* VOLK_GENERATE_CODEC_C */
+/* VOLK_GENERATE_CODEC_C */
+
+static void vilc_codecEncodeNext(VilcCodecWriter* writer, const void* next)
+{
+	const VkBaseInStructure* base;
+	uint8_t present = 1;
+
+	for (base = (const VkBaseInStructure*)next; base; base = base->pNext)
+	{
+		switch (base->sType)
+		{
+		/* VOLK_GENERATE_CODEC_ENCODE_NEXT_C */
+		/* VOLK_GENERATE_CODEC_ENCODE_NEXT_C */
+		default:
+			break;
+		}
+
+		/* structures the codec does not know are left out of the chain */
+		vilc_codecFail(&writer->result, VK_ERROR_FORMAT_NOT_SUPPORTED);
+	}
+
+	present = 0;
+	vilc_codecWrite(writer, &present, 1);
+}
+
+static void* vilc_codecDecodeNext(VilcCodecReader* reader)
+{
+	uint8_t present = 0;
+	VkStructureType sType;
+	void* next = NULL;
+
+	vilc_codecRead(reader, &present, 1);
+	if (!present)
+		return NULL;
+	if (sizeof(sType) > reader->size - reader->offset)
+	{
+		vilc_codecFailRead(reader, VK_ERROR_FORMAT_NOT_SUPPORTED);
+		return NULL;
+	}
+	memcpy(&sType, reader->data + reader->offset, sizeof(sType));
+
+	switch (sType)
+	{
+	/* VOLK_GENERATE_CODEC_DECODE_NEXT_C */
+	/* VOLK_GENERATE_CODEC_DECODE_NEXT_C */
+	default:
+		vilc_codecFailRead(reader, VK_ERROR_FORMAT_NOT_SUPPORTED);
+		return next;
+	}
+}
+
+VilcCodecTypeInfo vilcCodecGetTypeInfo(VilcCodecType type)
+{
+	VilcCodecTypeInfo info;
+
+	memset(&info, 0, sizeof(info));
+	info.sType = VK_STRUCTURE_TYPE_MAX_ENUM;
+
+	switch (type)
+	{
+	/* VOLK_GENERATE_CODEC_TYPE_INFO_C */
+	/* VOLK_GENERATE_CODEC_TYPE_INFO_C */
+	default:
+		break;
+	}
+
+	return info;
+}
+
+void vilcEncodeType(VilcCodecWriter* writer, VilcCodecType type, const void* value)
+{
+	switch (type)
+	{
+	/* VOLK_GENERATE_CODEC_ENCODE_TYPE_C */
+	/* VOLK_GENERATE_CODEC_ENCODE_TYPE_C */
+	default:
+		vilc_codecFail(&writer->result, VK_ERROR_FORMAT_NOT_SUPPORTED);
+		break;
+	}
+}
+
+void vilcDecodeType(VilcCodecReader* reader, VilcCodecType type, void* value)
+{
+	switch (type)
+	{
+	/* VOLK_GENERATE_CODEC_DECODE_TYPE_C */
+	/* VOLK_GENERATE_CODEC_DECODE_TYPE_C */
+	default:
+		vilc_codecFailRead(reader, VK_ERROR_FORMAT_NOT_SUPPORTED);
+		break;
+	}
+}
+
+static void* vilc_copyBytes(VilcArena* arena, const void* data, size_t size)
+{
+	void* copy = vilcArenaAlloc(arena, size);
+
+	if (copy && size)
+		memcpy(copy, data, size);
+	return copy;
+}
+
+/* VOLK_GENERATE_COPY_DECL_C */
+/* VOLK_GENERATE_COPY_DECL_C */
+
+/* VOLK_GENERATE_COPY_C */
+/* VOLK_GENERATE_COPY_C */
+
+void* vilcDeepCopyChain(VilcArena* arena, const void* next)
+{
+	const VkBaseInStructure* base = (const VkBaseInStructure*)next;
+	VkBaseOutStructure* copy;
+	size_t size, mark;
+
+	if (!base)
+		return NULL;
+
+	switch (base->sType)
+	{
+	/* VOLK_GENERATE_COPY_NEXT_C */
+	/* VOLK_GENERATE_COPY_NEXT_C */
+	default:
+		break;
+	}
+
+	/* structures without a generated copy are copied by size and only their pNext is followed */
+	size = vilcGetStructureSize(base->sType);
+	if (!size)
+		return NULL;
+	mark = arena->size;
+	copy = (VkBaseOutStructure*)vilc_copyBytes(arena, base, size);
+	if (copy && (!base->pNext || (copy->pNext = (VkBaseOutStructure*)vilcDeepCopyChain(arena, base->pNext)) != NULL))
+		return copy;
+	arena->size = mark;
+	return NULL;
+}
+
+void* vilcDeepCopyType(VilcArena* arena, VilcCodecType type, const void* value)
+{
+	size_t mark = arena->size;
+	void* result = NULL;
+
+	switch (type)
+	{
+	/* VOLK_GENERATE_COPY_TYPE_C */
+	/* VOLK_GENERATE_COPY_TYPE_C */
+	default:
+		break;
+	}
+
+	if (!result)
+		arena->size = mark;
+	return result;
+}
+
+size_t vilcGetStructureSize(VkStructureType sType)
+{
+	switch (sType)
+	{
+	/* VOLK_GENERATE_COPY_SIZE_C */
+	/* VOLK_GENERATE_COPY_SIZE_C */
+	default:
+		return 0;
+	}
+}
+
+/* 64-bit hash with the round structure of xxHash64. Four independent lanes over 32-byte stripes keep the multiplies in
+ * flight in parallel, and compilers vectorize the stripe loop where 64-bit vector multiplies exist. The seed chains
+ * calls, so structures are hashed as spans of bytes between the members that are followed.
+ */
+#define VILC_STRUCT_HASH_PRIME1 0x9E3779B185EBCA87ull
+#define VILC_STRUCT_HASH_PRIME2 0xC2B2AE3D27D4EB4Full
+#define VILC_STRUCT_HASH_PRIME3 0x165667B19E3779F9ull
+#define VILC_STRUCT_HASH_PRIME4 0x85EBCA77C2B2AE63ull
+#define VILC_STRUCT_HASH_PRIME5 0x27D4EB2F165667C5ull
+#define VILC_STRUCT_HASH_ROTL(value, bits) (((value) << (bits)) | ((value) >> (64 - (bits))))
+
+static uint64_t vilc_structHashRound(uint64_t accumulator, uint64_t input)
+{
+	accumulator += input * VILC_STRUCT_HASH_PRIME2;
+	accumulator = VILC_STRUCT_HASH_ROTL(accumulator, 31);
+	return accumulator * VILC_STRUCT_HASH_PRIME1;
+}
+
+static uint64_t vilc_structHashBytes(const void* data, size_t size, uint64_t seed)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	const unsigned char* end = bytes + size;
+	uint64_t hash, word;
+	uint32_t half;
+
+	if (size >= 32)
+	{
+		uint64_t lanes[4], stripe[4];
+		int i;
+
+		lanes[0] = seed + VILC_STRUCT_HASH_PRIME1 + VILC_STRUCT_HASH_PRIME2;
+		lanes[1] = seed + VILC_STRUCT_HASH_PRIME2;
+		lanes[2] = seed;
+		lanes[3] = seed - VILC_STRUCT_HASH_PRIME1;
+
+		for (; end - bytes >= 32; bytes += 32)
+		{
+			memcpy(stripe, bytes, 32);
+			for (i = 0; i < 4; ++i)
+				lanes[i] = vilc_structHashRound(lanes[i], stripe[i]);
+		}
+
+		hash = VILC_STRUCT_HASH_ROTL(lanes[0], 1) + VILC_STRUCT_HASH_ROTL(lanes[1], 7) + VILC_STRUCT_HASH_ROTL(lanes[2], 12) + VILC_STRUCT_HASH_ROTL(lanes[3], 18);
+		for (i = 0; i < 4; ++i)
+		{
+			hash ^= vilc_structHashRound(0, lanes[i]);
+			hash = hash * VILC_STRUCT_HASH_PRIME1 + VILC_STRUCT_HASH_PRIME4;
+		}
+	}
+	else
+		hash = seed + VILC_STRUCT_HASH_PRIME5;
+
+	hash += (uint64_t)size;
+
+	for (; end - bytes >= 8; bytes += 8)
+	{
+		memcpy(&word, bytes, 8);
+		hash ^= vilc_structHashRound(0, word);
+		hash = VILC_STRUCT_HASH_ROTL(hash, 27) * VILC_STRUCT_HASH_PRIME1 + VILC_STRUCT_HASH_PRIME4;
+	}
+	if (end - bytes >= 4)
+	{
+		memcpy(&half, bytes, 4);
+		hash ^= (uint64_t)half * VILC_STRUCT_HASH_PRIME1;
+		hash = VILC_STRUCT_HASH_ROTL(hash, 23) * VILC_STRUCT_HASH_PRIME2 + VILC_STRUCT_HASH_PRIME3;
+		bytes += 4;
+	}
+	for (; bytes < end; ++bytes)
+	{
+		hash ^= (uint64_t)*bytes * VILC_STRUCT_HASH_PRIME5;
+		hash = VILC_STRUCT_HASH_ROTL(hash, 11) * VILC_STRUCT_HASH_PRIME1;
+	}
+
+	return hash;
+}
+
+/* most spans are a member or two, which a single round covers once the size is known at the call */
+static uint64_t vilc_structHash(const void* data, size_t size, uint64_t seed)
+{
+	uint64_t word = 0;
+
+	if (size > sizeof(word))
+		return vilc_structHashBytes(data, size, seed);
+
+	if (size)
+		memcpy(&word, data, size);
+	return VILC_STRUCT_HASH_ROTL(vilc_structHashRound(seed + size, word), 27) * VILC_STRUCT_HASH_PRIME1 + VILC_STRUCT_HASH_PRIME4;
+}
+
+/* the spans only mix into the seed, so a hash is avalanched once at the end */
+static uint64_t vilc_structHashFinal(uint64_t hash)
+{
+	hash ^= hash >> 33;
+	hash *= VILC_STRUCT_HASH_PRIME2;
+	hash ^= hash >> 29;
+	hash *= VILC_STRUCT_HASH_PRIME3;
+	hash ^= hash >> 32;
+	return hash;
+}
+
+/* NULL hashes as no characters and "" as its terminator */
+static uint64_t vilc_hashString(const char* string, uint64_t hash)
+{
+	size_t length = string ? strlen(string) + 1 : 0;
+
+	hash = vilc_structHash(&length, sizeof(length), hash);
+	return string ? vilc_structHash(string, length, hash) : hash;
+}
+
+static int vilc_equalString(const char* a, const char* b)
+{
+	return a && b ? strcmp(a, b) == 0 : a == b;
+}
+
+static uint64_t vilc_hashNext(const void* next, uint64_t hash);
+static int vilc_equalNext(const void* a, const void* b);
+
+/* VOLK_GENERATE_HASH_DECL_C */
+/* VOLK_GENERATE_HASH_DECL_C */
+
+/* VOLK_GENERATE_HASH_C */
+/* VOLK_GENERATE_HASH_C */
+
+static uint64_t vilc_hashNext(const void* next, uint64_t hash)
+{
+	const VkBaseInStructure* base = (const VkBaseInStructure*)next;
+	size_t size;
+
+	if (!base)
+		return vilc_structHash(&base, sizeof(base), hash);
+
+	switch (base->sType)
+	{
+	/* VOLK_GENERATE_HASH_NEXT_C */
+	/* VOLK_GENERATE_HASH_NEXT_C */
+	default:
+		break;
+	}
+
+	/* structures without generated functions are hashed as the bytes after pNext */
+	size = vilcGetStructureSize(base->sType);
+	hash = vilc_structHash(&base->sType, sizeof(base->sType), hash);
+	if (size > sizeof(VkBaseInStructure))
+		hash = vilc_structHash(base + 1, size - sizeof(VkBaseInStructure), hash);
+	return vilc_hashNext(base->pNext, hash);
+}
+
+static int vilc_equalNext(const void* a, const void* b)
+{
+	const VkBaseInStructure* baseA = (const VkBaseInStructure*)a;
+	const VkBaseInStructure* baseB = (const VkBaseInStructure*)b;
+	size_t size;
+
+	if (!baseA || !baseB || baseA == baseB)
+		return baseA == baseB;
+	if (baseA->sType != baseB->sType)
+		return 0;
+
+	switch (baseA->sType)
+	{
+	/* VOLK_GENERATE_EQUAL_NEXT_C */
+	/* VOLK_GENERATE_EQUAL_NEXT_C */
+	default:
+		break;
+	}
+
+	/* the bytes of structures unknown to the headers are not known either */
+	size = vilcGetStructureSize(baseA->sType);
+	if (!size)
+		return 0;
+	if (size > sizeof(VkBaseInStructure) && memcmp(baseA + 1, baseB + 1, size - sizeof(VkBaseInStructure)) != 0)
+		return 0;
+	return vilc_equalNext(baseA->pNext, baseB->pNext);
+}
+
+uint64_t vilcHashType(VilcCodecType type, const void* value)
+{
+	switch (type)
+	{
+	/* VOLK_GENERATE_HASH_TYPE_C */
+	/* VOLK_GENERATE_HASH_TYPE_C */
+	default:
+		return 0;
+	}
+}
+
+VkBool32 vilcEqualType(VilcCodecType type, const void* a, const void* b)
+{
+	switch (type)
+	{
+	/* VOLK_GENERATE_EQUAL_TYPE_C */
+	/* VOLK_GENERATE_EQUAL_TYPE_C */
+	default:
+		return VK_FALSE;
+	}
+}
+
+#endif /* VILC_STRUCTS_IMPLEMENTATION */
@@ -23,6 +23,31 @@
 
 #if defined(VOLK_IN_LOADERS_CLOTH)
 #include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "vilc.h"
+#if defined(VILC_PERF_LINT) && (defined(__GLIBC__) || defined(__APPLE__))
+#include <execinfo.h>
+#define VILC_PERF_LINT_BACKTRACE 1
+#endif
+#if defined(VILC_PIPELINE_CACHE)
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+#if defined(VILC_PARALLEL_PIPELINES)
+#include <unistd.h>
+#endif
+#if defined(VILC_DEFERRED_HOST_OPERATIONS)
+#include <sched.h>
+#include <unistd.h>
+#endif
+#if defined(VILC_SUBMIT_THREAD) || defined(VILC_SUBMIT_MERGING)
+#include <time.h>
+#endif
 #endif
 
 #include <string.h>
@@ -1296,6 +1321,15021 @@ static void vilc_initOnce() {
 }
 #endif
 
+#if defined(VOLK_IN_LOADERS_CLOTH)
+/* VILC modes are implemented as layers over the vilc_vk* pointers loaded from the driver.
+ * Each mode saves the pointer it replaces in <layer>_next_<command> and forwards to it,
+ * so modes stack in the order they are installed in vilc_installInstanceLayers/vilc_installDeviceLayers.
+ * Modes are selected at build time through VILC_DEFINES, e.g. -DVILC_DEFINES=VILC_CHARACTERIZE.
+ */
+#define VILC_LAYER_NEXT(layer, name) static PFN_##name layer##_next_##name = NULL;
+#define VILC_LAYER_HOOK(layer, name) \
+	if (vilc_##name) \
+	{ \
+		layer##_next_##name = vilc_##name; \
+		vilc_##name = layer##_##name; \
+	}
+
+#define VILC_ATOMIC_LOAD(ptr) __atomic_load_n(ptr, __ATOMIC_RELAXED)
+#define VILC_ATOMIC_STORE(ptr, value) __atomic_store_n(ptr, value, __ATOMIC_RELAXED)
+#define VILC_ATOMIC_ADD(ptr, value) __atomic_add_fetch(ptr, value, __ATOMIC_RELAXED)
+/* Ordered variants for state that is published to lock-free readers */
+#define VILC_ATOMIC_LOAD_ACQUIRE(ptr) __atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+#define VILC_ATOMIC_STORE_RELEASE(ptr, value) __atomic_store_n(ptr, value, __ATOMIC_RELEASE)
+#define VILC_ATOMIC_SUB_ACQ_REL(ptr, value) __atomic_sub_fetch(ptr, value, __ATOMIC_ACQ_REL)
+#define VILC_ATOMIC_CAS_ACQUIRE(ptr, expected, desired) __atomic_compare_exchange_n(ptr, expected, desired, 1, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)
+/* Sequentially consistent variants for a flag and a counter each checked by the side that writes the other */
+#define VILC_ATOMIC_LOAD_SEQ_CST(ptr) __atomic_load_n(ptr, __ATOMIC_SEQ_CST)
+#define VILC_ATOMIC_STORE_SEQ_CST(ptr, value) __atomic_store_n(ptr, value, __ATOMIC_SEQ_CST)
+#define VILC_ATOMIC_ADD_SEQ_CST(ptr, value) __atomic_add_fetch(ptr, value, __ATOMIC_SEQ_CST)
+#define VILC_ATOMIC_MAX(ptr, value) \
+	do \
+	{ \
+		uint64_t vilc_value_ = (value), vilc_current_ = VILC_ATOMIC_LOAD(ptr); \
+		while (vilc_value_ > vilc_current_ && !__atomic_compare_exchange_n(ptr, &vilc_current_, vilc_value_, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) \
+			; \
+	} while (0)
+
+/* Non-dispatchable handles are pointers on 64-bit platforms and uint64_t elsewhere (e.g. wasm32) */
+#if (defined(VK_USE_64_BIT_PTR_DEFINES) && VK_USE_64_BIT_PTR_DEFINES == 1) || (!defined(VK_USE_64_BIT_PTR_DEFINES) && UINTPTR_MAX == UINT64_MAX)
+#define VILC_OBJECT_KEY(handle) ((uint64_t)(uintptr_t)(handle))
+#else
+#define VILC_OBJECT_KEY(handle) ((uint64_t)(handle))
+#endif
+#define VILC_DISPATCHABLE_KEY(handle) ((uint64_t)(uintptr_t)(handle))
+
+/* Modes that issue Vulkan calls of their own or keep per-object state */
+#if defined(VILC_GPU_TIMESTAMPS) || defined(VILC_MEMORY_BUDGET) || defined(VILC_DRAW_BATCHING) || defined(VILC_DEFERRED_COMMANDS) || defined(VILC_MAPPING_CACHE) || defined(VILC_MEMORY_SUBALLOCATOR) || defined(VILC_DESCRIPTOR_ALLOCATOR)
+#define VILC_DRIVER_TABLES 1
+#define VILC_HANDLE_MAP 1
+#endif
+
+/* Modes that deduplicate objects by content */
+#if defined(VILC_SHADER_MODULE_CACHE) || defined(VILC_SAMPLER_CACHE) || defined(VILC_LAYOUT_CACHE) || defined(VILC_DESCRIPTOR_REUSE)
+#define VILC_HANDLE_MAP 1
+#define VILC_CONTENT_HASH 1
+#endif
+
+/* Modes that persist driver state across runs */
+#if defined(VILC_PIPELINE_CACHE)
+#define VILC_DRIVER_TABLES 1
+#define VILC_CONTENT_HASH 1
+#endif
+
+/* Modes that call the driver directly without tracking objects */
+#if defined(VILC_PARALLEL_PIPELINES) || defined(VILC_DEFERRED_HOST_OPERATIONS)
+#define VILC_DRIVER_TABLES 1
+#endif
+
+/* Modes that make queue calls after they returned */
+#if defined(VILC_SUBMIT_THREAD) || defined(VILC_SUBMIT_MERGING)
+#define VILC_SUBMIT_COPIES 1
+#endif
+
+/* Modes that report log2 histograms */
+#if defined(VILC_CHARACTERIZE) || defined(VILC_SUBMIT_THREAD) || defined(VILC_DESCRIPTOR_ALLOCATOR)
+#define VILC_HISTOGRAMS 1
+#endif
+
+/* Modes that hook every command recorded into a command buffer */
+#if defined(VILC_BARRIER_COALESCING) || defined(VILC_DRAW_BATCHING) || defined(VILC_DEFERRED_COMMANDS)
+#define VILC_DEVICE_COMMAND_LIST 1
+#endif
+
+/* Modes that keep per-object state without calling the driver themselves */
+#if defined(VILC_STATE_FILTER) || defined(VILC_BARRIER_COALESCING) || defined(VILC_IMAGE_LAYOUT_TRACKING)
+#define VILC_HANDLE_MAP 1
+#endif
+
+/* The trampolines pass pAllocator through this, so VILC_HOST_MEMORY_STATS can substitute its own callbacks */
+#if !defined(VILC_HOST_MEMORY_STATS)
+#define VILC_HOST_ALLOCATOR(pAllocator, objectType) (pAllocator)
+#endif
+#endif
+
+#if defined(VOLK_IN_LOADERS_CLOTH) && defined(VILC_DRIVER_TABLES)
+/* Driver entry points for calls VILC makes on its own behalf; these bypass all VILC layers */
+static struct VolkInstanceTable vilc_instance;
+static struct VolkDeviceTable vilc_device;
+#endif
+
+#if defined(VOLK_IN_LOADERS_CLOTH) && (defined(VILC_GPU_TIMESTAMPS) || defined(VILC_MEMORY_BUDGET) || defined(VILC_BARRIER_COALESCING) || defined(VILC_DRAW_BATCHING))
+static int vilc_hasDeviceExtension(const VkDeviceCreateInfo* pCreateInfo, const char* name)
+{
+	uint32_t i;
+	for (i = 0; i < pCreateInfo->enabledExtensionCount; ++i)
+		if (strcmp(pCreateInfo->ppEnabledExtensionNames[i], name) == 0)
+			return 1;
+	return 0;
+}
+#endif
+
+#if defined(VOLK_IN_LOADERS_CLOTH) && defined(VILC_HANDLE_MAP)
+/* Open addressing map from Vulkan handles to mode-owned pointers; key 0 (VK_NULL_HANDLE) marks an empty slot.
+ * Callers are responsible for locking.
+ */
+typedef struct VilcHandleMap
+{
+	uint64_t* keys;
+	void** values;
+	uint32_t capacity;
+	uint32_t count;
+} VilcHandleMap;
+
+static uint64_t vilc_hash64(uint64_t key)
+{
+	key ^= key >> 33;
+	key *= 0xff51afd7ed558ccdull;
+	key ^= key >> 33;
+	key *= 0xc4ceb9fe1a85ec53ull;
+	key ^= key >> 33;
+	return key;
+}
+
+static void* vilc_mapFind(const VilcHandleMap* map, uint64_t key)
+{
+	uint32_t mask = map->capacity - 1, i;
+
+	if (!map->capacity)
+		return NULL;
+
+	for (i = (uint32_t)vilc_hash64(key) & mask; map->keys[i]; i = (i + 1) & mask)
+		if (map->keys[i] == key)
+			return map->values[i];
+
+	return NULL;
+}
+
+static int vilc_mapInsert(VilcHandleMap* map, uint64_t key, void* value)
+{
+	uint32_t mask, i;
+
+	if ((map->count + 1) * 2 > map->capacity)
+	{
+		VilcHandleMap grown;
+		grown.capacity = map->capacity ? map->capacity * 2 : 64;
+		grown.count = 0;
+		grown.keys = (uint64_t*)calloc(grown.capacity, sizeof(uint64_t));
+		grown.values = (void**)calloc(grown.capacity, sizeof(void*));
+		if (!grown.keys || !grown.values)
+		{
+			free(grown.keys);
+			free(grown.values);
+			return 0;
+		}
+
+		for (i = 0; i < map->capacity; ++i)
+			if (map->keys[i])
+				vilc_mapInsert(&grown, map->keys[i], map->values[i]);
+
+		free(map->keys);
+		free(map->values);
+		*map = grown;
+	}
+
+	mask = map->capacity - 1;
+	for (i = (uint32_t)vilc_hash64(key) & mask; map->keys[i] && map->keys[i] != key; i = (i + 1) & mask)
+		;
+
+	map->count += map->keys[i] ? 0 : 1;
+	map->keys[i] = key;
+	map->values[i] = value;
+	return 1;
+}
+
+static void* vilc_mapRemove(VilcHandleMap* map, uint64_t key)
+{
+	uint32_t mask = map->capacity - 1, i, j;
+	void* value;
+
+	if (!map->capacity)
+		return NULL;
+
+	for (i = (uint32_t)vilc_hash64(key) & mask; map->keys[i] != key; i = (i + 1) & mask)
+		if (!map->keys[i])
+			return NULL;
+
+	value = map->values[i];
+	map->count--;
+
+	/* backward shift deletion keeps probe sequences intact without tombstones */
+	for (j = (i + 1) & mask; map->keys[j]; j = (j + 1) & mask)
+	{
+		uint32_t home = (uint32_t)vilc_hash64(map->keys[j]) & mask;
+		if (((j - home) & mask) >= ((j - i) & mask))
+		{
+			map->keys[i] = map->keys[j];
+			map->values[i] = map->values[j];
+			i = j;
+		}
+	}
+	map->keys[i] = 0;
+	map->values[i] = NULL;
+
+	return value;
+}
+
+static void vilc_mapFree(VilcHandleMap* map)
+{
+	free(map->keys);
+	free(map->values);
+	memset(map, 0, sizeof(*map));
+}
+#endif
+
+#if defined(VOLK_IN_LOADERS_CLOTH) && defined(VILC_CONTENT_HASH)
+/* 64-bit content hash with the round structure of xxHash64. Four independent lanes over 32-byte stripes keep the
+ * multiplies in flight in parallel, and compilers vectorize the stripe loop where 64-bit vector multiplies exist.
+ * The seed chains calls, so structures can be hashed field by field.
+ */
+#define VILC_HASH_PRIME1 0x9E3779B185EBCA87ull
+#define VILC_HASH_PRIME2 0xC2B2AE3D27D4EB4Full
+#define VILC_HASH_PRIME3 0x165667B19E3779F9ull
+#define VILC_HASH_PRIME4 0x85EBCA77C2B2AE63ull
+#define VILC_HASH_PRIME5 0x27D4EB2F165667C5ull
+#define VILC_HASH_ROTL(value, bits) (((value) << (bits)) | ((value) >> (64 - (bits))))
+
+static uint64_t vilc_hashRound(uint64_t accumulator, uint64_t input)
+{
+	accumulator += input * VILC_HASH_PRIME2;
+	accumulator = VILC_HASH_ROTL(accumulator, 31);
+	return accumulator * VILC_HASH_PRIME1;
+}
+
+static uint64_t vilc_hashMerge(uint64_t hash, uint64_t lane)
+{
+	hash ^= vilc_hashRound(0, lane);
+	return hash * VILC_HASH_PRIME1 + VILC_HASH_PRIME4;
+}
+
+static uint64_t vilc_hashBytes(const void* data, size_t size, uint64_t seed)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	const unsigned char* end = bytes + size;
+	uint64_t hash, word;
+	uint32_t half;
+
+	if (size >= 32)
+	{
+		uint64_t lanes[4], stripe[4];
+		int i;
+
+		lanes[0] = seed + VILC_HASH_PRIME1 + VILC_HASH_PRIME2;
+		lanes[1] = seed + VILC_HASH_PRIME2;
+		lanes[2] = seed;
+		lanes[3] = seed - VILC_HASH_PRIME1;
+
+		for (; end - bytes >= 32; bytes += 32)
+		{
+			memcpy(stripe, bytes, 32);
+			for (i = 0; i < 4; ++i)
+				lanes[i] = vilc_hashRound(lanes[i], stripe[i]);
+		}
+
+		hash = VILC_HASH_ROTL(lanes[0], 1) + VILC_HASH_ROTL(lanes[1], 7) + VILC_HASH_ROTL(lanes[2], 12) + VILC_HASH_ROTL(lanes[3], 18);
+		for (i = 0; i < 4; ++i)
+			hash = vilc_hashMerge(hash, lanes[i]);
+	}
+	else
+		hash = seed + VILC_HASH_PRIME5;
+
+	hash += (uint64_t)size;
+
+	for (; end - bytes >= 8; bytes += 8)
+	{
+		memcpy(&word, bytes, 8);
+		hash ^= vilc_hashRound(0, word);
+		hash = VILC_HASH_ROTL(hash, 27) * VILC_HASH_PRIME1 + VILC_HASH_PRIME4;
+	}
+	if (end - bytes >= 4)
+	{
+		memcpy(&half, bytes, 4);
+		hash ^= (uint64_t)half * VILC_HASH_PRIME1;
+		hash = VILC_HASH_ROTL(hash, 23) * VILC_HASH_PRIME2 + VILC_HASH_PRIME3;
+		bytes += 4;
+	}
+	for (; bytes < end; ++bytes)
+	{
+		hash ^= (uint64_t)*bytes * VILC_HASH_PRIME5;
+		hash = VILC_HASH_ROTL(hash, 11) * VILC_HASH_PRIME1;
+	}
+
+	hash ^= hash >> 33;
+	hash *= VILC_HASH_PRIME2;
+	hash ^= hash >> 29;
+	hash *= VILC_HASH_PRIME3;
+	hash ^= hash >> 32;
+	return hash;
+}
+#endif
+
+#if defined(VOLK_IN_LOADERS_CLOTH) && (defined(VILC_SUBMIT_COPIES) || defined(VILC_DESCRIPTOR_ALLOCATOR))
+/* CLOCK_MONOTONIC nanoseconds, to time how long calls are held or take */
+static uint64_t vilc_monotonicNow(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+#endif
+
+#if defined(VOLK_IN_LOADERS_CLOTH) && defined(VILC_HISTOGRAMS)
+/* Log2 histograms recorded into without locks; min is stored as ~min so that a zeroed histogram needs no special
+ * initialization, and vilc_histogramExport turns it back for the public VilcHistogram.
+ */
+static void vilc_histogramRecord(VilcHistogram* histogram, uint64_t value)
+{
+	uint32_t bucket = value ? 64 - __builtin_clzll(value) : 0;
+	uint64_t current;
+
+	VILC_ATOMIC_ADD(&histogram->count, 1);
+	VILC_ATOMIC_ADD(&histogram->sum, value);
+	VILC_ATOMIC_ADD(&histogram->buckets[bucket], 1);
+
+	current = VILC_ATOMIC_LOAD(&histogram->max);
+	while (value > current && !__atomic_compare_exchange_n(&histogram->max, &current, value, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+		;
+	current = VILC_ATOMIC_LOAD(&histogram->min);
+	while (~value > current && !__atomic_compare_exchange_n(&histogram->min, &current, ~value, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+		;
+}
+
+/* Loads a histogram that may still be recorded into */
+static void vilc_histogramExport(VilcHistogram* target, const VilcHistogram* source)
+{
+	uint32_t i;
+
+	target->count = VILC_ATOMIC_LOAD(&source->count);
+	target->sum = VILC_ATOMIC_LOAD(&source->sum);
+	target->min = target->count ? ~VILC_ATOMIC_LOAD(&source->min) : 0;
+	target->max = VILC_ATOMIC_LOAD(&source->max);
+	for (i = 0; i < VILC_HISTOGRAM_BUCKET_COUNT; ++i)
+		target->buckets[i] = VILC_ATOMIC_LOAD(&source->buckets[i]);
+}
+
+static uint64_t vilc_histogramPercentile(const VilcHistogram* histogram, uint64_t percent)
+{
+	uint64_t rank = (histogram->count * percent + 99) / 100;
+	uint64_t seen = 0;
+	uint32_t i;
+
+	for (i = 0; i < VILC_HISTOGRAM_BUCKET_COUNT; ++i)
+	{
+		seen += histogram->buckets[i];
+		if (seen >= rank && seen)
+			return i == 0 ? 0 : (i == 64 ? ~0ull : (1ull << i) - 1);
+	}
+
+	return histogram->max;
+}
+
+/* Prints one line for an exported histogram */
+static void vilc_histogramPrint(const char* name, const VilcHistogram* histogram)
+{
+	fprintf(stderr, "vilc:   %-24s calls %10llu min %10llu mean %10llu p50 <=%10llu p90 <=%10llu p99 <=%10llu max %10llu\n",
+	    name, (unsigned long long)histogram->count, (unsigned long long)histogram->min,
+	    (unsigned long long)(histogram->sum / histogram->count),
+	    (unsigned long long)vilc_histogramPercentile(histogram, 50),
+	    (unsigned long long)vilc_histogramPercentile(histogram, 90),
+	    (unsigned long long)vilc_histogramPercentile(histogram, 99),
+	    (unsigned long long)histogram->max);
+}
+#endif
+
+#if defined(VOLK_IN_LOADERS_CLOTH) && defined(VILC_SUBMIT_COPIES)
+/* Copies of submit and present infos for modes that make the driver call after the call has returned. Structures
+ * are copied with the arrays they point to and their pNext chains; measuring returns VILC_SUBMIT_COPY_NONE for chains
+ * with structures not known here, which are passed to the driver as they are instead.
+ */
+#define VILC_SUBMIT_COPY_ALIGN(size) (((size) + 7) & ~(size_t)7)
+#define VILC_SUBMIT_COPY_NONE (~(size_t)0)
+
+/* An array a structure points to, copied with it; elementSize 0 marks pointers that must be NULL to be copied */
+typedef struct VilcSubmitCopyArray
+{
+	uint16_t countOffset;
+	uint16_t pointerOffset;
+	uint16_t elementSize;
+	uint16_t structures; /* elements are structures, which are only copied without pNext chains */
+} VilcSubmitCopyArray;
+
+typedef struct VilcSubmitCopyLayout
+{
+	VkStructureType sType;
+	uint32_t size;
+	VilcSubmitCopyArray arrays[4];
+} VilcSubmitCopyLayout;
+
+#define VILC_SUBMIT_COPY_ARRAY(type, count, pointer, structures) \
+	{ \
+		offsetof(type, count), offsetof(type, pointer), sizeof(*((type*)0)->pointer), structures \
+	}
+
+static const VilcSubmitCopyLayout vilc_submitCopyLayouts[] = {
+	{ VK_STRUCTURE_TYPE_SUBMIT_INFO, sizeof(VkSubmitInfo),
+	    { VILC_SUBMIT_COPY_ARRAY(VkSubmitInfo, waitSemaphoreCount, pWaitSemaphores, 0), VILC_SUBMIT_COPY_ARRAY(VkSubmitInfo, waitSemaphoreCount, pWaitDstStageMask, 0),
+	        VILC_SUBMIT_COPY_ARRAY(VkSubmitInfo, commandBufferCount, pCommandBuffers, 0), VILC_SUBMIT_COPY_ARRAY(VkSubmitInfo, signalSemaphoreCount, pSignalSemaphores, 0) } },
+#if defined(VK_VERSION_1_1)
+	{ VK_STRUCTURE_TYPE_DEVICE_GROUP_SUBMIT_INFO, sizeof(VkDeviceGroupSubmitInfo),
+	    { VILC_SUBMIT_COPY_ARRAY(VkDeviceGroupSubmitInfo, waitSemaphoreCount, pWaitSemaphoreDeviceIndices, 0),
+	        VILC_SUBMIT_COPY_ARRAY(VkDeviceGroupSubmitInfo, commandBufferCount, pCommandBufferDeviceMasks, 0),
+	        VILC_SUBMIT_COPY_ARRAY(VkDeviceGroupSubmitInfo, signalSemaphoreCount, pSignalSemaphoreDeviceIndices, 0) } },
+	{ VK_STRUCTURE_TYPE_PROTECTED_SUBMIT_INFO, sizeof(VkProtectedSubmitInfo), { { 0, 0, 0, 0 } } },
+#endif /* defined(VK_VERSION_1_1) */
+#if defined(VK_VERSION_1_2)
+	{ VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO, sizeof(VkTimelineSemaphoreSubmitInfo),
+	    { VILC_SUBMIT_COPY_ARRAY(VkTimelineSemaphoreSubmitInfo, waitSemaphoreValueCount, pWaitSemaphoreValues, 0),
+	        VILC_SUBMIT_COPY_ARRAY(VkTimelineSemaphoreSubmitInfo, signalSemaphoreValueCount, pSignalSemaphoreValues, 0) } },
+#endif /* defined(VK_VERSION_1_2) */
+#if defined(VK_VERSION_1_3) || defined(VK_KHR_synchronization2)
+	{ VK_STRUCTURE_TYPE_SUBMIT_INFO_2, sizeof(VkSubmitInfo2),
+	    { VILC_SUBMIT_COPY_ARRAY(VkSubmitInfo2, waitSemaphoreInfoCount, pWaitSemaphoreInfos, 1),
+	        VILC_SUBMIT_COPY_ARRAY(VkSubmitInfo2, commandBufferInfoCount, pCommandBufferInfos, 1),
+	        VILC_SUBMIT_COPY_ARRAY(VkSubmitInfo2, signalSemaphoreInfoCount, pSignalSemaphoreInfos, 1) } },
+#endif /* defined(VK_VERSION_1_3) || defined(VK_KHR_synchronization2) */
+#if defined(VK_KHR_performance_query)
+	{ VK_STRUCTURE_TYPE_PERFORMANCE_QUERY_SUBMIT_INFO_KHR, sizeof(VkPerformanceQuerySubmitInfoKHR), { { 0, 0, 0, 0 } } },
+#endif /* defined(VK_KHR_performance_query) */
+#if defined(VK_KHR_swapchain)
+	{ VK_STRUCTURE_TYPE_PRESENT_INFO_KHR, sizeof(VkPresentInfoKHR),
+	    { VILC_SUBMIT_COPY_ARRAY(VkPresentInfoKHR, waitSemaphoreCount, pWaitSemaphores, 0), VILC_SUBMIT_COPY_ARRAY(VkPresentInfoKHR, swapchainCount, pSwapchains, 0),
+	        VILC_SUBMIT_COPY_ARRAY(VkPresentInfoKHR, swapchainCount, pImageIndices, 0),
+	        { offsetof(VkPresentInfoKHR, swapchainCount), offsetof(VkPresentInfoKHR, pResults), 0, 0 } } },
+#endif /* defined(VK_KHR_swapchain) */
+#if defined(VK_KHR_swapchain) && defined(VK_VERSION_1_1)
+	{ VK_STRUCTURE_TYPE_DEVICE_GROUP_PRESENT_INFO_KHR, sizeof(VkDeviceGroupPresentInfoKHR),
+	    { VILC_SUBMIT_COPY_ARRAY(VkDeviceGroupPresentInfoKHR, swapchainCount, pDeviceMasks, 0) } },
+#endif /* defined(VK_KHR_swapchain) && defined(VK_VERSION_1_1) */
+#if defined(VK_KHR_present_id)
+	{ VK_STRUCTURE_TYPE_PRESENT_ID_KHR, sizeof(VkPresentIdKHR), { VILC_SUBMIT_COPY_ARRAY(VkPresentIdKHR, swapchainCount, pPresentIds, 0) } },
+#endif /* defined(VK_KHR_present_id) */
+#if defined(VK_EXT_swapchain_maintenance1)
+	{ VK_STRUCTURE_TYPE_SWAPCHAIN_PRESENT_FENCE_INFO_EXT, sizeof(VkSwapchainPresentFenceInfoEXT),
+	    { VILC_SUBMIT_COPY_ARRAY(VkSwapchainPresentFenceInfoEXT, swapchainCount, pFences, 0) } },
+	{ VK_STRUCTURE_TYPE_SWAPCHAIN_PRESENT_MODE_INFO_EXT, sizeof(VkSwapchainPresentModeInfoEXT),
+	    { VILC_SUBMIT_COPY_ARRAY(VkSwapchainPresentModeInfoEXT, swapchainCount, pPresentModes, 0) } },
+#endif /* defined(VK_EXT_swapchain_maintenance1) */
+#if defined(VK_GOOGLE_display_timing)
+	{ VK_STRUCTURE_TYPE_PRESENT_TIMES_INFO_GOOGLE, sizeof(VkPresentTimesInfoGOOGLE), { VILC_SUBMIT_COPY_ARRAY(VkPresentTimesInfoGOOGLE, swapchainCount, pTimes, 0) } },
+#endif /* defined(VK_GOOGLE_display_timing) */
+};
+
+static const VilcSubmitCopyLayout* vilc_submitCopyLayout(VkStructureType sType)
+{
+	size_t i;
+
+	for (i = 0; i < sizeof(vilc_submitCopyLayouts) / sizeof(vilc_submitCopyLayouts[0]); ++i)
+		if (vilc_submitCopyLayouts[i].sType == sType)
+			return &vilc_submitCopyLayouts[i];
+	return NULL;
+}
+
+/* Returns the bytes needed to copy the arrays of a structure, or VILC_SUBMIT_COPY_NONE */
+static size_t vilc_submitCopyMeasureArrays(const VilcSubmitCopyLayout* layout, const void* structure)
+{
+	const VilcSubmitCopyArray* array;
+	size_t size = 0;
+	uint32_t count, i;
+
+	for (array = layout->arrays; array < layout->arrays + 4 && array->pointerOffset; ++array)
+	{
+		const char* elements = *(const char* const*)((const char*)structure + array->pointerOffset);
+
+		if (!elements)
+			continue;
+		if (!array->elementSize)
+			return VILC_SUBMIT_COPY_NONE;
+
+		count = *(const uint32_t*)((const char*)structure + array->countOffset);
+		for (i = 0; array->structures && i < count; ++i)
+			if (((const VkBaseInStructure*)(elements + (size_t)i * array->elementSize))->pNext)
+				return VILC_SUBMIT_COPY_NONE;
+		size += VILC_SUBMIT_COPY_ALIGN((size_t)count * array->elementSize);
+	}
+
+	return size;
+}
+
+/* Returns the bytes needed to copy count structures of one type with their arrays and pNext chains, or
+ * VILC_SUBMIT_COPY_NONE when one of them is not known here
+ */
+static size_t vilc_submitCopyMeasure(const void* structures, uint32_t count)
+{
+	const VilcSubmitCopyLayout* layout = count ? vilc_submitCopyLayout(((const VkBaseInStructure*)structures)->sType) : NULL;
+	const VkBaseInStructure* next;
+	size_t size, arrays;
+	uint32_t i;
+
+	if (!count)
+		return 0;
+	if (!layout)
+		return VILC_SUBMIT_COPY_NONE;
+
+	size = VILC_SUBMIT_COPY_ALIGN((size_t)count * layout->size);
+	for (i = 0; i < count; ++i)
+	{
+		const VkBaseInStructure* structure = (const VkBaseInStructure*)((const char*)structures + (size_t)i * layout->size);
+
+		if ((arrays = vilc_submitCopyMeasureArrays(layout, structure)) == VILC_SUBMIT_COPY_NONE)
+			return VILC_SUBMIT_COPY_NONE;
+		size += arrays;
+
+		for (next = structure->pNext; next; next = next->pNext)
+		{
+			const VilcSubmitCopyLayout* nextLayout = vilc_submitCopyLayout(next->sType);
+
+			if (!nextLayout || (arrays = vilc_submitCopyMeasureArrays(nextLayout, next)) == VILC_SUBMIT_COPY_NONE)
+				return VILC_SUBMIT_COPY_NONE;
+			size += VILC_SUBMIT_COPY_ALIGN(nextLayout->size) + arrays;
+		}
+	}
+
+	return size;
+}
+
+static void vilc_submitCopyArrays(const VilcSubmitCopyLayout* layout, void* structure, char** arena)
+{
+	const VilcSubmitCopyArray* array;
+
+	for (array = layout->arrays; array < layout->arrays + 4 && array->pointerOffset; ++array)
+	{
+		void** pointer = (void**)((char*)structure + array->pointerOffset);
+		size_t size = (size_t)*(const uint32_t*)((const char*)structure + array->countOffset) * array->elementSize;
+
+		if (!*pointer)
+			continue;
+		memcpy(*arena, *pointer, size);
+		*pointer = *arena;
+		*arena += VILC_SUBMIT_COPY_ALIGN(size);
+	}
+}
+
+/* Copies structures measured by vilc_submitCopyMeasure into the arena */
+static void* vilc_submitCopy(const void* structures, uint32_t count, char** arena)
+{
+	const VilcSubmitCopyLayout* layout = vilc_submitCopyLayout(((const VkBaseInStructure*)structures)->sType);
+	char* copies = *arena;
+	uint32_t i;
+
+	memcpy(copies, structures, (size_t)count * layout->size);
+	*arena += VILC_SUBMIT_COPY_ALIGN((size_t)count * layout->size);
+
+	for (i = 0; i < count; ++i)
+	{
+		VkBaseOutStructure* link = (VkBaseOutStructure*)(copies + (size_t)i * layout->size);
+
+		vilc_submitCopyArrays(layout, link, arena);
+		for (; link->pNext; link = link->pNext)
+		{
+			const VilcSubmitCopyLayout* nextLayout = vilc_submitCopyLayout(link->pNext->sType);
+			VkBaseOutStructure* next = (VkBaseOutStructure*)*arena;
+
+			memcpy(next, link->pNext, nextLayout->size);
+			*arena += VILC_SUBMIT_COPY_ALIGN(nextLayout->size);
+			vilc_submitCopyArrays(nextLayout, next, arena);
+			link->pNext = next;
+		}
+	}
+
+	return copies;
+}
+#endif
+
+#if defined(VOLK_IN_LOADERS_CLOTH) && defined(VILC_DEVICE_COMMAND_LIST)
+/* VILC_DEVICE_COMMANDS(X, X_RESULT) expands X(name, params, args) for every command recorded into a command buffer that
+ * returns void and X_RESULT for the ones that return VkResult; params and args are parenthesized and start with
+ * commandBuffer.
+ */
+/* VOLK_GENERATE_COMMANDS_C_VILC */
+#if defined(VK_VERSION_1_0)
+#define VILC_DEVICE_COMMANDS_115adfca(X, X_RESULT) \
+	X(vkCmdBeginQuery, (VkCommandBuffer commandBuffer, VkQueryPool queryPool, uint32_t query, VkQueryControlFlags flags), (commandBuffer, queryPool, query, flags)) \
+	X(vkCmdBeginRenderPass, (VkCommandBuffer commandBuffer, const VkRenderPassBeginInfo* pRenderPassBegin, VkSubpassContents contents), (commandBuffer, pRenderPassBegin, contents)) \
+	X(vkCmdBindDescriptorSets, (VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout, uint32_t firstSet, uint32_t descriptorSetCount, const VkDescriptorSet* pDescriptorSets, uint32_t dynamicOffsetCount, const uint32_t* pDynamicOffsets), (commandBuffer, pipelineBindPoint, layout, firstSet, descriptorSetCount, pDescriptorSets, dynamicOffsetCount, pDynamicOffsets)) \
+	X(vkCmdBindIndexBuffer, (VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkIndexType indexType), (commandBuffer, buffer, offset, indexType)) \
+	X(vkCmdBindPipeline, (VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipeline pipeline), (commandBuffer, pipelineBindPoint, pipeline)) \
+	X(vkCmdBindVertexBuffers, (VkCommandBuffer commandBuffer, uint32_t firstBinding, uint32_t bindingCount, const VkBuffer* pBuffers, const VkDeviceSize* pOffsets), (commandBuffer, firstBinding, bindingCount, pBuffers, pOffsets)) \
+	X(vkCmdBlitImage, (VkCommandBuffer commandBuffer, VkImage srcImage, VkImageLayout srcImageLayout, VkImage dstImage, VkImageLayout dstImageLayout, uint32_t regionCount, const VkImageBlit* pRegions, VkFilter filter), (commandBuffer, srcImage, srcImageLayout, dstImage, dstImageLayout, regionCount, pRegions, filter)) \
+	X(vkCmdClearAttachments, (VkCommandBuffer commandBuffer, uint32_t attachmentCount, const VkClearAttachment* pAttachments, uint32_t rectCount, const VkClearRect* pRects), (commandBuffer, attachmentCount, pAttachments, rectCount, pRects)) \
+	X(vkCmdClearColorImage, (VkCommandBuffer commandBuffer, VkImage image, VkImageLayout imageLayout, const VkClearColorValue* pColor, uint32_t rangeCount, const VkImageSubresourceRange* pRanges), (commandBuffer, image, imageLayout, pColor, rangeCount, pRanges)) \
+	X(vkCmdClearDepthStencilImage, (VkCommandBuffer commandBuffer, VkImage image, VkImageLayout imageLayout, const VkClearDepthStencilValue* pDepthStencil, uint32_t rangeCount, const VkImageSubresourceRange* pRanges), (commandBuffer, image, imageLayout, pDepthStencil, rangeCount, pRanges)) \
+	X(vkCmdCopyBuffer, (VkCommandBuffer commandBuffer, VkBuffer srcBuffer, VkBuffer dstBuffer, uint32_t regionCount, const VkBufferCopy* pRegions), (commandBuffer, srcBuffer, dstBuffer, regionCount, pRegions)) \
+	X(vkCmdCopyBufferToImage, (VkCommandBuffer commandBuffer, VkBuffer srcBuffer, VkImage dstImage, VkImageLayout dstImageLayout, uint32_t regionCount, const VkBufferImageCopy* pRegions), (commandBuffer, srcBuffer, dstImage, dstImageLayout, regionCount, pRegions)) \
+	X(vkCmdCopyImage, (VkCommandBuffer commandBuffer, VkImage srcImage, VkImageLayout srcImageLayout, VkImage dstImage, VkImageLayout dstImageLayout, uint32_t regionCount, const VkImageCopy* pRegions), (commandBuffer, srcImage, srcImageLayout, dstImage, dstImageLayout, regionCount, pRegions)) \
+	X(vkCmdCopyImageToBuffer, (VkCommandBuffer commandBuffer, VkImage srcImage, VkImageLayout srcImageLayout, VkBuffer dstBuffer, uint32_t regionCount, const VkBufferImageCopy* pRegions), (commandBuffer, srcImage, srcImageLayout, dstBuffer, regionCount, pRegions)) \
+	X(vkCmdCopyQueryPoolResults, (VkCommandBuffer commandBuffer, VkQueryPool queryPool, uint32_t firstQuery, uint32_t queryCount, VkBuffer dstBuffer, VkDeviceSize dstOffset, VkDeviceSize stride, VkQueryResultFlags flags), (commandBuffer, queryPool, firstQuery, queryCount, dstBuffer, dstOffset, stride, flags)) \
+	X(vkCmdDispatch, (VkCommandBuffer commandBuffer, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ), (commandBuffer, groupCountX, groupCountY, groupCountZ)) \
+	X(vkCmdDispatchIndirect, (VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset), (commandBuffer, buffer, offset)) \
+	X(vkCmdDraw, (VkCommandBuffer commandBuffer, uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance), (commandBuffer, vertexCount, instanceCount, firstVertex, firstInstance)) \
+	X(vkCmdDrawIndexed, (VkCommandBuffer commandBuffer, uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance), (commandBuffer, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance)) \
+	X(vkCmdDrawIndexedIndirect, (VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride), (commandBuffer, buffer, offset, drawCount, stride)) \
+	X(vkCmdDrawIndirect, (VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride), (commandBuffer, buffer, offset, drawCount, stride)) \
+	X(vkCmdEndQuery, (VkCommandBuffer commandBuffer, VkQueryPool queryPool, uint32_t query), (commandBuffer, queryPool, query)) \
+	X(vkCmdEndRenderPass, (VkCommandBuffer commandBuffer), (commandBuffer)) \
+	X(vkCmdExecuteCommands, (VkCommandBuffer commandBuffer, uint32_t commandBufferCount, const VkCommandBuffer* pCommandBuffers), (commandBuffer, commandBufferCount, pCommandBuffers)) \
+	X(vkCmdFillBuffer, (VkCommandBuffer commandBuffer, VkBuffer dstBuffer, VkDeviceSize dstOffset, VkDeviceSize size, uint32_t data), (commandBuffer, dstBuffer, dstOffset, size, data)) \
+	X(vkCmdNextSubpass, (VkCommandBuffer commandBuffer, VkSubpassContents contents), (commandBuffer, contents)) \
+	X(vkCmdPipelineBarrier, (VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask, VkDependencyFlags dependencyFlags, uint32_t memoryBarrierCount, const VkMemoryBarrier* pMemoryBarriers, uint32_t bufferMemoryBarrierCount, const VkBufferMemoryBarrier* pBufferMemoryBarriers, uint32_t imageMemoryBarrierCount, const VkImageMemoryBarrier* pImageMemoryBarriers), (commandBuffer, srcStageMask, dstStageMask, dependencyFlags, memoryBarrierCount, pMemoryBarriers, bufferMemoryBarrierCount, pBufferMemoryBarriers, imageMemoryBarrierCount, pImageMemoryBarriers)) \
+	X(vkCmdPushConstants, (VkCommandBuffer commandBuffer, VkPipelineLayout layout, VkShaderStageFlags stageFlags, uint32_t offset, uint32_t size, const void* pValues), (commandBuffer, layout, stageFlags, offset, size, pValues)) \
+	X(vkCmdResetEvent, (VkCommandBuffer commandBuffer, VkEvent event, VkPipelineStageFlags stageMask), (commandBuffer, event, stageMask)) \
+	X(vkCmdResetQueryPool, (VkCommandBuffer commandBuffer, VkQueryPool queryPool, uint32_t firstQuery, uint32_t queryCount), (commandBuffer, queryPool, firstQuery, queryCount)) \
+	X(vkCmdResolveImage, (VkCommandBuffer commandBuffer, VkImage srcImage, VkImageLayout srcImageLayout, VkImage dstImage, VkImageLayout dstImageLayout, uint32_t regionCount, const VkImageResolve* pRegions), (commandBuffer, srcImage, srcImageLayout, dstImage, dstImageLayout, regionCount, pRegions)) \
+	X(vkCmdSetBlendConstants, (VkCommandBuffer commandBuffer, const float blendConstants[4]), (commandBuffer, blendConstants)) \
+	X(vkCmdSetDepthBias, (VkCommandBuffer commandBuffer, float depthBiasConstantFactor, float depthBiasClamp, float depthBiasSlopeFactor), (commandBuffer, depthBiasConstantFactor, depthBiasClamp, depthBiasSlopeFactor)) \
+	X(vkCmdSetDepthBounds, (VkCommandBuffer commandBuffer, float minDepthBounds, float maxDepthBounds), (commandBuffer, minDepthBounds, maxDepthBounds)) \
+	X(vkCmdSetEvent, (VkCommandBuffer commandBuffer, VkEvent event, VkPipelineStageFlags stageMask), (commandBuffer, event, stageMask)) \
+	X(vkCmdSetLineWidth, (VkCommandBuffer commandBuffer, float lineWidth), (commandBuffer, lineWidth)) \
+	X(vkCmdSetScissor, (VkCommandBuffer commandBuffer, uint32_t firstScissor, uint32_t scissorCount, const VkRect2D* pScissors), (commandBuffer, firstScissor, scissorCount, pScissors)) \
+	X(vkCmdSetStencilCompareMask, (VkCommandBuffer commandBuffer, VkStencilFaceFlags faceMask, uint32_t compareMask), (commandBuffer, faceMask, compareMask)) \
+	X(vkCmdSetStencilReference, (VkCommandBuffer commandBuffer, VkStencilFaceFlags faceMask, uint32_t reference), (commandBuffer, faceMask, reference)) \
+	X(vkCmdSetStencilWriteMask, (VkCommandBuffer commandBuffer, VkStencilFaceFlags faceMask, uint32_t writeMask), (commandBuffer, faceMask, writeMask)) \
+	X(vkCmdSetViewport, (VkCommandBuffer commandBuffer, uint32_t firstViewport, uint32_t viewportCount, const VkViewport* pViewports), (commandBuffer, firstViewport, viewportCount, pViewports)) \
+	X(vkCmdUpdateBuffer, (VkCommandBuffer commandBuffer, VkBuffer dstBuffer, VkDeviceSize dstOffset, VkDeviceSize dataSize, const void* pData), (commandBuffer, dstBuffer, dstOffset, dataSize, pData)) \
+	X(vkCmdWaitEvents, (VkCommandBuffer commandBuffer, uint32_t eventCount, const VkEvent* pEvents, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask, uint32_t memoryBarrierCount, const VkMemoryBarrier* pMemoryBarriers, uint32_t bufferMemoryBarrierCount, const VkBufferMemoryBarrier* pBufferMemoryBarriers, uint32_t imageMemoryBarrierCount, const VkImageMemoryBarrier* pImageMemoryBarriers), (commandBuffer, eventCount, pEvents, srcStageMask, dstStageMask, memoryBarrierCount, pMemoryBarriers, bufferMemoryBarrierCount, pBufferMemoryBarriers, imageMemoryBarrierCount, pImageMemoryBarriers)) \
+	X(vkCmdWriteTimestamp, (VkCommandBuffer commandBuffer, VkPipelineStageFlagBits pipelineStage, VkQueryPool queryPool, uint32_t query), (commandBuffer, pipelineStage, queryPool, query))
+#else
+#define VILC_DEVICE_COMMANDS_115adfca(X, X_RESULT)
+#endif /* defined(VK_VERSION_1_0) */
+#if defined(VK_VERSION_1_1)
+#define VILC_DEVICE_COMMANDS_841ee8b(X, X_RESULT) \
+	X(vkCmdDispatchBase, (VkCommandBuffer commandBuffer, uint32_t baseGroupX, uint32_t baseGroupY, uint32_t baseGroupZ, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ), (commandBuffer, baseGroupX, baseGroupY, baseGroupZ, groupCountX, groupCountY, groupCountZ)) \
+	X(vkCmdSetDeviceMask, (VkCommandBuffer commandBuffer, uint32_t deviceMask), (commandBuffer, deviceMask))
+#else
+#define VILC_DEVICE_COMMANDS_841ee8b(X, X_RESULT)
+#endif /* defined(VK_VERSION_1_1) */
+#if defined(VK_VERSION_1_2)
+#define VILC_DEVICE_COMMANDS_236cbd48(X, X_RESULT) \
+	X(vkCmdBeginRenderPass2, (VkCommandBuffer commandBuffer, const VkRenderPassBeginInfo*      pRenderPassBegin, const VkSubpassBeginInfo*      pSubpassBeginInfo), (commandBuffer, pRenderPassBegin, pSubpassBeginInfo)) \
+	X(vkCmdDrawIndexedIndirectCount, (VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkBuffer countBuffer, VkDeviceSize countBufferOffset, uint32_t maxDrawCount, uint32_t stride), (commandBuffer, buffer, offset, countBuffer, countBufferOffset, maxDrawCount, stride)) \
+	X(vkCmdDrawIndirectCount, (VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkBuffer countBuffer, VkDeviceSize countBufferOffset, uint32_t maxDrawCount, uint32_t stride), (commandBuffer, buffer, offset, countBuffer, countBufferOffset, maxDrawCount, stride)) \
+	X(vkCmdEndRenderPass2, (VkCommandBuffer commandBuffer, const VkSubpassEndInfo*        pSubpassEndInfo), (commandBuffer, pSubpassEndInfo)) \
+	X(vkCmdNextSubpass2, (VkCommandBuffer commandBuffer, const VkSubpassBeginInfo*      pSubpassBeginInfo, const VkSubpassEndInfo*        pSubpassEndInfo), (commandBuffer, pSubpassBeginInfo, pSubpassEndInfo))
+#else
+#define VILC_DEVICE_COMMANDS_236cbd48(X, X_RESULT)
+#endif /* defined(VK_VERSION_1_2) */
+#if defined(VK_VERSION_1_3)
+#define VILC_DEVICE_COMMANDS_3a778c09(X, X_RESULT) \
+	X(vkCmdBeginRendering, (VkCommandBuffer                   commandBuffer, const VkRenderingInfo*                              pRenderingInfo), (commandBuffer, pRenderingInfo)) \
+	X(vkCmdBindVertexBuffers2, (VkCommandBuffer commandBuffer, uint32_t firstBinding, uint32_t bindingCount, const VkBuffer* pBuffers, const VkDeviceSize* pOffsets, const VkDeviceSize* pSizes, const VkDeviceSize* pStrides), (commandBuffer, firstBinding, bindingCount, pBuffers, pOffsets, pSizes, pStrides)) \
+	X(vkCmdBlitImage2, (VkCommandBuffer commandBuffer, const VkBlitImageInfo2* pBlitImageInfo), (commandBuffer, pBlitImageInfo)) \
+	X(vkCmdCopyBuffer2, (VkCommandBuffer commandBuffer, const VkCopyBufferInfo2* pCopyBufferInfo), (commandBuffer, pCopyBufferInfo)) \
+	X(vkCmdCopyBufferToImage2, (VkCommandBuffer commandBuffer, const VkCopyBufferToImageInfo2* pCopyBufferToImageInfo), (commandBuffer, pCopyBufferToImageInfo)) \
+	X(vkCmdCopyImage2, (VkCommandBuffer commandBuffer, const VkCopyImageInfo2* pCopyImageInfo), (commandBuffer, pCopyImageInfo)) \
+	X(vkCmdCopyImageToBuffer2, (VkCommandBuffer commandBuffer, const VkCopyImageToBufferInfo2* pCopyImageToBufferInfo), (commandBuffer, pCopyImageToBufferInfo)) \
+	X(vkCmdEndRendering, (VkCommandBuffer                   commandBuffer), (commandBuffer)) \
+	X(vkCmdPipelineBarrier2, (VkCommandBuffer                   commandBuffer, const VkDependencyInfo*                             pDependencyInfo), (commandBuffer, pDependencyInfo)) \
+	X(vkCmdResetEvent2, (VkCommandBuffer                   commandBuffer, VkEvent                                             event, VkPipelineStageFlags2               stageMask), (commandBuffer, event, stageMask)) \
+	X(vkCmdResolveImage2, (VkCommandBuffer commandBuffer, const VkResolveImageInfo2* pResolveImageInfo), (commandBuffer, pResolveImageInfo)) \
+	X(vkCmdSetCullMode, (VkCommandBuffer commandBuffer, VkCullModeFlags cullMode), (commandBuffer, cullMode)) \
+	X(vkCmdSetDepthBiasEnable, (VkCommandBuffer commandBuffer, VkBool32 depthBiasEnable), (commandBuffer, depthBiasEnable)) \
+	X(vkCmdSetDepthBoundsTestEnable, (VkCommandBuffer commandBuffer, VkBool32 depthBoundsTestEnable), (commandBuffer, depthBoundsTestEnable)) \
+	X(vkCmdSetDepthCompareOp, (VkCommandBuffer commandBuffer, VkCompareOp depthCompareOp), (commandBuffer, depthCompareOp)) \
+	X(vkCmdSetDepthTestEnable, (VkCommandBuffer commandBuffer, VkBool32 depthTestEnable), (commandBuffer, depthTestEnable)) \
+	X(vkCmdSetDepthWriteEnable, (VkCommandBuffer commandBuffer, VkBool32 depthWriteEnable), (commandBuffer, depthWriteEnable)) \
+	X(vkCmdSetEvent2, (VkCommandBuffer                   commandBuffer, VkEvent                                             event, const VkDependencyInfo*                             pDependencyInfo), (commandBuffer, event, pDependencyInfo)) \
+	X(vkCmdSetFrontFace, (VkCommandBuffer commandBuffer, VkFrontFace frontFace), (commandBuffer, frontFace)) \
+	X(vkCmdSetPrimitiveRestartEnable, (VkCommandBuffer commandBuffer, VkBool32 primitiveRestartEnable), (commandBuffer, primitiveRestartEnable)) \
+	X(vkCmdSetPrimitiveTopology, (VkCommandBuffer commandBuffer, VkPrimitiveTopology primitiveTopology), (commandBuffer, primitiveTopology)) \
+	X(vkCmdSetRasterizerDiscardEnable, (VkCommandBuffer commandBuffer, VkBool32 rasterizerDiscardEnable), (commandBuffer, rasterizerDiscardEnable)) \
+	X(vkCmdSetScissorWithCount, (VkCommandBuffer commandBuffer, uint32_t scissorCount, const VkRect2D* pScissors), (commandBuffer, scissorCount, pScissors)) \
+	X(vkCmdSetStencilOp, (VkCommandBuffer commandBuffer, VkStencilFaceFlags faceMask, VkStencilOp failOp, VkStencilOp passOp, VkStencilOp depthFailOp, VkCompareOp compareOp), (commandBuffer, faceMask, failOp, passOp, depthFailOp, compareOp)) \
+	X(vkCmdSetStencilTestEnable, (VkCommandBuffer commandBuffer, VkBool32 stencilTestEnable), (commandBuffer, stencilTestEnable)) \
+	X(vkCmdSetViewportWithCount, (VkCommandBuffer commandBuffer, uint32_t viewportCount, const VkViewport* pViewports), (commandBuffer, viewportCount, pViewports)) \
+	X(vkCmdWaitEvents2, (VkCommandBuffer                   commandBuffer, uint32_t                                            eventCount, const VkEvent*                     pEvents, const VkDependencyInfo*            pDependencyInfos), (commandBuffer, eventCount, pEvents, pDependencyInfos)) \
+	X(vkCmdWriteTimestamp2, (VkCommandBuffer                   commandBuffer, VkPipelineStageFlags2               stage, VkQueryPool                                         queryPool, uint32_t                                            query), (commandBuffer, stage, queryPool, query))
+#else
+#define VILC_DEVICE_COMMANDS_3a778c09(X, X_RESULT)
+#endif /* defined(VK_VERSION_1_3) */
+#if defined(VK_VERSION_1_4)
+#define VILC_DEVICE_COMMANDS_75361ace(X, X_RESULT) \
+	X(vkCmdBindDescriptorSets2, (VkCommandBuffer commandBuffer, const VkBindDescriptorSetsInfo*   pBindDescriptorSetsInfo), (commandBuffer, pBindDescriptorSetsInfo)) \
+	X(vkCmdBindIndexBuffer2, (VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, VkIndexType indexType), (commandBuffer, buffer, offset, size, indexType)) \
+	X(vkCmdPushConstants2, (VkCommandBuffer commandBuffer, const VkPushConstantsInfo*        pPushConstantsInfo), (commandBuffer, pPushConstantsInfo)) \
+	X(vkCmdPushDescriptorSet, (VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout, uint32_t set, uint32_t descriptorWriteCount, const VkWriteDescriptorSet* pDescriptorWrites), (commandBuffer, pipelineBindPoint, layout, set, descriptorWriteCount, pDescriptorWrites)) \
+	X(vkCmdPushDescriptorSet2, (VkCommandBuffer commandBuffer, const VkPushDescriptorSetInfo*    pPushDescriptorSetInfo), (commandBuffer, pPushDescriptorSetInfo)) \
+	X(vkCmdPushDescriptorSetWithTemplate, (VkCommandBuffer commandBuffer, VkDescriptorUpdateTemplate descriptorUpdateTemplate, VkPipelineLayout layout, uint32_t set, const void* pData), (commandBuffer, descriptorUpdateTemplate, layout, set, pData)) \
+	X(vkCmdPushDescriptorSetWithTemplate2, (VkCommandBuffer commandBuffer, const VkPushDescriptorSetWithTemplateInfo* pPushDescriptorSetWithTemplateInfo), (commandBuffer, pPushDescriptorSetWithTemplateInfo)) \
+	X(vkCmdSetLineStipple, (VkCommandBuffer commandBuffer, uint32_t lineStippleFactor, uint16_t lineStipplePattern), (commandBuffer, lineStippleFactor, lineStipplePattern)) \
+	X(vkCmdSetRenderingAttachmentLocations, (VkCommandBuffer commandBuffer, const VkRenderingAttachmentLocationInfo* pLocationInfo), (commandBuffer, pLocationInfo)) \
+	X(vkCmdSetRenderingInputAttachmentIndices, (VkCommandBuffer commandBuffer, const VkRenderingInputAttachmentIndexInfo* pInputAttachmentIndexInfo), (commandBuffer, pInputAttachmentIndexInfo))
+#else
+#define VILC_DEVICE_COMMANDS_75361ace(X, X_RESULT)
+#endif /* defined(VK_VERSION_1_4) */
+#if defined(VK_AMDX_shader_enqueue)
+#define VILC_DEVICE_COMMANDS_8b2eda6d(X, X_RESULT) \
+	X(vkCmdDispatchGraphAMDX, (VkCommandBuffer                                 commandBuffer, VkDeviceAddress                                 scratch, VkDeviceSize                                    scratchSize, const VkDispatchGraphCountInfoAMDX*             pCountInfo), (commandBuffer, scratch, scratchSize, pCountInfo)) \
+	X(vkCmdDispatchGraphIndirectAMDX, (VkCommandBuffer                                 commandBuffer, VkDeviceAddress                                 scratch, VkDeviceSize                                    scratchSize, const VkDispatchGraphCountInfoAMDX*             pCountInfo), (commandBuffer, scratch, scratchSize, pCountInfo)) \
+	X(vkCmdDispatchGraphIndirectCountAMDX, (VkCommandBuffer                                 commandBuffer, VkDeviceAddress                                 scratch, VkDeviceSize                                    scratchSize, VkDeviceAddress                                 countInfo), (commandBuffer, scratch, scratchSize, countInfo)) \
+	X(vkCmdInitializeGraphScratchMemoryAMDX, (VkCommandBuffer                                 commandBuffer, VkPipeline                                      executionGraph, VkDeviceAddress                                 scratch, VkDeviceSize                                    scratchSize), (commandBuffer, executionGraph, scratch, scratchSize))
+#else
+#define VILC_DEVICE_COMMANDS_8b2eda6d(X, X_RESULT)
+#endif /* defined(VK_AMDX_shader_enqueue) */
+#if defined(VK_AMD_buffer_marker)
+#define VILC_DEVICE_COMMANDS_5f0a909d(X, X_RESULT) \
+	X(vkCmdWriteBufferMarkerAMD, (VkCommandBuffer commandBuffer, VkPipelineStageFlagBits pipelineStage, VkBuffer dstBuffer, VkDeviceSize dstOffset, uint32_t marker), (commandBuffer, pipelineStage, dstBuffer, dstOffset, marker))
+#else
+#define VILC_DEVICE_COMMANDS_5f0a909d(X, X_RESULT)
+#endif /* defined(VK_AMD_buffer_marker) */
+#if defined(VK_AMD_buffer_marker) && (defined(VK_VERSION_1_3) || defined(VK_KHR_synchronization2))
+#define VILC_DEVICE_COMMANDS_35d1ef70(X, X_RESULT) \
+	X(vkCmdWriteBufferMarker2AMD, (VkCommandBuffer                   commandBuffer, VkPipelineStageFlags2               stage, VkBuffer                                            dstBuffer, VkDeviceSize                                        dstOffset, uint32_t                                            marker), (commandBuffer, stage, dstBuffer, dstOffset, marker))
+#else
+#define VILC_DEVICE_COMMANDS_35d1ef70(X, X_RESULT)
+#endif /* defined(VK_AMD_buffer_marker) && (defined(VK_VERSION_1_3) || defined(VK_KHR_synchronization2)) */
+#if defined(VK_AMD_draw_indirect_count)
+#define VILC_DEVICE_COMMANDS_f897f174(X, X_RESULT) \
+	X(vkCmdDrawIndexedIndirectCountAMD, (VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkBuffer countBuffer, VkDeviceSize countBufferOffset, uint32_t maxDrawCount, uint32_t stride), (commandBuffer, buffer, offset, countBuffer, countBufferOffset, maxDrawCount, stride)) \
+	X(vkCmdDrawIndirectCountAMD, (VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkBuffer countBuffer, VkDeviceSize countBufferOffset, uint32_t maxDrawCount, uint32_t stride), (commandBuffer, buffer, offset, countBuffer, countBufferOffset, maxDrawCount, stride))
+#else
+#define VILC_DEVICE_COMMANDS_f897f174(X, X_RESULT)
+#endif /* defined(VK_AMD_draw_indirect_count) */
+#if defined(VK_ARM_data_graph)
+#define VILC_DEVICE_COMMANDS_6796b198(X, X_RESULT) \
+	X(vkCmdDispatchDataGraphARM, (VkCommandBuffer commandBuffer, VkDataGraphPipelineSessionARM session, const VkDataGraphPipelineDispatchInfoARM* pInfo), (commandBuffer, session, pInfo))
+#else
+#define VILC_DEVICE_COMMANDS_6796b198(X, X_RESULT)
+#endif /* defined(VK_ARM_data_graph) */
+#if defined(VK_ARM_tensors)
+#define VILC_DEVICE_COMMANDS_680d7529(X, X_RESULT) \
+	X(vkCmdCopyTensorARM, (VkCommandBuffer commandBuffer, const VkCopyTensorInfoARM* pCopyTensorInfo), (commandBuffer, pCopyTensorInfo))
+#else
+#define VILC_DEVICE_COMMANDS_680d7529(X, X_RESULT)
+#endif /* defined(VK_ARM_tensors) */
+#if defined(VK_EXT_attachment_feedback_loop_dynamic_state)
+#define VILC_DEVICE_COMMANDS_f2adc574(X, X_RESULT) \
+	X(vkCmdSetAttachmentFeedbackLoopEnableEXT, (VkCommandBuffer commandBuffer, VkImageAspectFlags aspectMask), (commandBuffer, aspectMask))
+#else
+#define VILC_DEVICE_COMMANDS_f2adc574(X, X_RESULT)
+#endif /* defined(VK_EXT_attachment_feedback_loop_dynamic_state) */
+#if defined(VK_EXT_color_write_enable)
+#define VILC_DEVICE_COMMANDS_8a74c2e(X, X_RESULT) \
+	X(vkCmdSetColorWriteEnableEXT, (VkCommandBuffer       commandBuffer, uint32_t                                attachmentCount, const VkBool32*   pColorWriteEnables), (commandBuffer, attachmentCount, pColorWriteEnables))
+#else
+#define VILC_DEVICE_COMMANDS_8a74c2e(X, X_RESULT)
+#endif /* defined(VK_EXT_color_write_enable) */
+#if defined(VK_EXT_conditional_rendering)
+#define VILC_DEVICE_COMMANDS_674622f1(X, X_RESULT) \
+	X(vkCmdBeginConditionalRenderingEXT, (VkCommandBuffer commandBuffer, const VkConditionalRenderingBeginInfoEXT* pConditionalRenderingBegin), (commandBuffer, pConditionalRenderingBegin)) \
+	X(vkCmdEndConditionalRenderingEXT, (VkCommandBuffer commandBuffer), (commandBuffer))
+#else
+#define VILC_DEVICE_COMMANDS_674622f1(X, X_RESULT)
+#endif /* defined(VK_EXT_conditional_rendering) */
+#if defined(VK_EXT_custom_resolve) && (defined(VK_KHR_dynamic_rendering) || defined(VK_VERSION_1_3))
+#define VILC_DEVICE_COMMANDS_7f75bbcb(X, X_RESULT) \
+	X(vkCmdBeginCustomResolveEXT, (VkCommandBuffer commandBuffer, const VkBeginCustomResolveInfoEXT* pBeginCustomResolveInfo), (commandBuffer, pBeginCustomResolveInfo))
+#else
+#define VILC_DEVICE_COMMANDS_7f75bbcb(X, X_RESULT)
+#endif /* defined(VK_EXT_custom_resolve) && (defined(VK_KHR_dynamic_rendering) || defined(VK_VERSION_1_3)) */
+#if defined(VK_EXT_debug_marker)
+#define VILC_DEVICE_COMMANDS_86953ad0(X, X_RESULT) \
+	X(vkCmdDebugMarkerBeginEXT, (VkCommandBuffer commandBuffer, const VkDebugMarkerMarkerInfoEXT* pMarkerInfo), (commandBuffer, pMarkerInfo)) \
+	X(vkCmdDebugMarkerEndEXT, (VkCommandBuffer commandBuffer), (commandBuffer)) \
+	X(vkCmdDebugMarkerInsertEXT, (VkCommandBuffer commandBuffer, const VkDebugMarkerMarkerInfoEXT* pMarkerInfo), (commandBuffer, pMarkerInfo))
+#else
+#define VILC_DEVICE_COMMANDS_86953ad0(X, X_RESULT)
+#endif /* defined(VK_EXT_debug_marker) */
+#if defined(VK_EXT_depth_bias_control)
+#define VILC_DEVICE_COMMANDS_27e9bbf6(X, X_RESULT) \
+	X(vkCmdSetDepthBias2EXT, (VkCommandBuffer commandBuffer, const VkDepthBiasInfoEXT*         pDepthBiasInfo), (commandBuffer, pDepthBiasInfo))
+#else
+#define VILC_DEVICE_COMMANDS_27e9bbf6(X, X_RESULT)
+#endif /* defined(VK_EXT_depth_bias_control) */
+#if defined(VK_EXT_descriptor_buffer)
+#define VILC_DEVICE_COMMANDS_a33890e9(X, X_RESULT) \
+	X(vkCmdBindDescriptorBufferEmbeddedSamplersEXT, (VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout, uint32_t set), (commandBuffer, pipelineBindPoint, layout, set)) \
+	X(vkCmdBindDescriptorBuffersEXT, (VkCommandBuffer commandBuffer, uint32_t bufferCount, const VkDescriptorBufferBindingInfoEXT* pBindingInfos), (commandBuffer, bufferCount, pBindingInfos)) \
+	X(vkCmdSetDescriptorBufferOffsetsEXT, (VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout, uint32_t firstSet, uint32_t setCount, const uint32_t* pBufferIndices, const VkDeviceSize* pOffsets), (commandBuffer, pipelineBindPoint, layout, firstSet, setCount, pBufferIndices, pOffsets))
+#else
+#define VILC_DEVICE_COMMANDS_a33890e9(X, X_RESULT)
+#endif /* defined(VK_EXT_descriptor_buffer) */
+#if defined(VK_EXT_device_generated_commands)
+#define VILC_DEVICE_COMMANDS_8f2e5639(X, X_RESULT) \
+	X(vkCmdExecuteGeneratedCommandsEXT, (VkCommandBuffer commandBuffer, VkBool32 isPreprocessed, const VkGeneratedCommandsInfoEXT* pGeneratedCommandsInfo), (commandBuffer, isPreprocessed, pGeneratedCommandsInfo)) \
+	X(vkCmdPreprocessGeneratedCommandsEXT, (VkCommandBuffer commandBuffer, const VkGeneratedCommandsInfoEXT* pGeneratedCommandsInfo, VkCommandBuffer stateCommandBuffer), (commandBuffer, pGeneratedCommandsInfo, stateCommandBuffer))
+#else
+#define VILC_DEVICE_COMMANDS_8f2e5639(X, X_RESULT)
+#endif /* defined(VK_EXT_device_generated_commands) */
+#if defined(VK_EXT_discard_rectangles)
+#define VILC_DEVICE_COMMANDS_80e2693c(X, X_RESULT) \
+	X(vkCmdSetDiscardRectangleEXT, (VkCommandBuffer commandBuffer, uint32_t firstDiscardRectangle, uint32_t discardRectangleCount, const VkRect2D* pDiscardRectangles), (commandBuffer, firstDiscardRectangle, discardRectangleCount, pDiscardRectangles))
+#else
+#define VILC_DEVICE_COMMANDS_80e2693c(X, X_RESULT)
+#endif /* defined(VK_EXT_discard_rectangles) */
+#if defined(VK_EXT_discard_rectangles) && VK_EXT_DISCARD_RECTANGLES_SPEC_VERSION >= 2
+#define VILC_DEVICE_COMMANDS_7d35fc6f(X, X_RESULT) \
+	X(vkCmdSetDiscardRectangleEnableEXT, (VkCommandBuffer commandBuffer, VkBool32 discardRectangleEnable), (commandBuffer, discardRectangleEnable)) \
+	X(vkCmdSetDiscardRectangleModeEXT, (VkCommandBuffer commandBuffer, VkDiscardRectangleModeEXT discardRectangleMode), (commandBuffer, discardRectangleMode))
+#else
+#define VILC_DEVICE_COMMANDS_7d35fc6f(X, X_RESULT)
+#endif /* defined(VK_EXT_discard_rectangles) && VK_EXT_DISCARD_RECTANGLES_SPEC_VERSION >= 2 */
+#if defined(VK_EXT_fragment_density_map_offset)
+#define VILC_DEVICE_COMMANDS_f04f221e(X, X_RESULT) \
+	X(vkCmdEndRendering2EXT, (VkCommandBuffer                   commandBuffer, const VkRenderingEndInfoKHR*        pRenderingEndInfo), (commandBuffer, pRenderingEndInfo))
+#else
+#define VILC_DEVICE_COMMANDS_f04f221e(X, X_RESULT)
+#endif /* defined(VK_EXT_fragment_density_map_offset) */
+#if defined(VK_EXT_line_rasterization)
+#define VILC_DEVICE_COMMANDS_3ca78d3c(X, X_RESULT) \
+	X(vkCmdSetLineStippleEXT, (VkCommandBuffer commandBuffer, uint32_t lineStippleFactor, uint16_t lineStipplePattern), (commandBuffer, lineStippleFactor, lineStipplePattern))
+#else
+#define VILC_DEVICE_COMMANDS_3ca78d3c(X, X_RESULT)
+#endif /* defined(VK_EXT_line_rasterization) */
+#if defined(VK_EXT_memory_decompression)
+#define VILC_DEVICE_COMMANDS_3b654e1(X, X_RESULT) \
+	X(vkCmdDecompressMemoryEXT, (VkCommandBuffer commandBuffer, const VkDecompressMemoryInfoEXT* pDecompressMemoryInfoEXT), (commandBuffer, pDecompressMemoryInfoEXT)) \
+	X(vkCmdDecompressMemoryIndirectCountEXT, (VkCommandBuffer commandBuffer, VkMemoryDecompressionMethodFlagsEXT decompressionMethod, VkDeviceAddress indirectCommandsAddress, VkDeviceAddress indirectCommandsCountAddress, uint32_t maxDecompressionCount, uint32_t stride), (commandBuffer, decompressionMethod, indirectCommandsAddress, indirectCommandsCountAddress, maxDecompressionCount, stride))
+#else
+#define VILC_DEVICE_COMMANDS_3b654e1(X, X_RESULT)
+#endif /* defined(VK_EXT_memory_decompression) */
+#if defined(VK_EXT_mesh_shader)
+#define VILC_DEVICE_COMMANDS_c9e6a28e(X, X_RESULT) \
+	X(vkCmdDrawMeshTasksEXT, (VkCommandBuffer commandBuffer, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ), (commandBuffer, groupCountX, groupCountY, groupCountZ)) \
+	X(vkCmdDrawMeshTasksIndirectEXT, (VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride), (commandBuffer, buffer, offset, drawCount, stride))
+#else
+#define VILC_DEVICE_COMMANDS_c9e6a28e(X, X_RESULT)
+#endif /* defined(VK_EXT_mesh_shader) */
+#if defined(VK_EXT_mesh_shader) && (defined(VK_VERSION_1_2) || defined(VK_KHR_draw_indirect_count) || defined(VK_AMD_draw_indirect_count))
+#define VILC_DEVICE_COMMANDS_58c3e9cd(X, X_RESULT) \
+	X(vkCmdDrawMeshTasksIndirectCountEXT, (VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkBuffer countBuffer, VkDeviceSize countBufferOffset, uint32_t maxDrawCount, uint32_t stride), (commandBuffer, buffer, offset, countBuffer, countBufferOffset, maxDrawCount, stride))
+#else
+#define VILC_DEVICE_COMMANDS_58c3e9cd(X, X_RESULT)
+#endif /* defined(VK_EXT_mesh_shader) && (defined(VK_VERSION_1_2) || defined(VK_KHR_draw_indirect_count) || defined(VK_AMD_draw_indirect_count)) */
+#if defined(VK_EXT_multi_draw)
+#define VILC_DEVICE_COMMANDS_242c2a41(X, X_RESULT) \
+	X(vkCmdDrawMultiEXT, (VkCommandBuffer commandBuffer, uint32_t drawCount, const VkMultiDrawInfoEXT* pVertexInfo, uint32_t instanceCount, uint32_t firstInstance, uint32_t stride), (commandBuffer, drawCount, pVertexInfo, instanceCount, firstInstance, stride)) \
+	X(vkCmdDrawMultiIndexedEXT, (VkCommandBuffer commandBuffer, uint32_t drawCount, const VkMultiDrawIndexedInfoEXT* pIndexInfo, uint32_t instanceCount, uint32_t firstInstance, uint32_t stride, const int32_t* pVertexOffset), (commandBuffer, drawCount, pIndexInfo, instanceCount, firstInstance, stride, pVertexOffset))
+#else
+#define VILC_DEVICE_COMMANDS_242c2a41(X, X_RESULT)
+#endif /* defined(VK_EXT_multi_draw) */
+#if defined(VK_EXT_opacity_micromap)
+#define VILC_DEVICE_COMMANDS_1343bf61(X, X_RESULT) \
+	X(vkCmdBuildMicromapsEXT, (VkCommandBuffer                                    commandBuffer, uint32_t infoCount, const VkMicromapBuildInfoEXT* pInfos), (commandBuffer, infoCount, pInfos)) \
+	X(vkCmdCopyMemoryToMicromapEXT, (VkCommandBuffer commandBuffer, const VkCopyMemoryToMicromapInfoEXT* pInfo), (commandBuffer, pInfo)) \
+	X(vkCmdCopyMicromapEXT, (VkCommandBuffer commandBuffer, const VkCopyMicromapInfoEXT* pInfo), (commandBuffer, pInfo)) \
+	X(vkCmdCopyMicromapToMemoryEXT, (VkCommandBuffer commandBuffer, const VkCopyMicromapToMemoryInfoEXT* pInfo), (commandBuffer, pInfo)) \
+	X(vkCmdWriteMicromapsPropertiesEXT, (VkCommandBuffer commandBuffer, uint32_t micromapCount, const VkMicromapEXT* pMicromaps, VkQueryType queryType, VkQueryPool queryPool, uint32_t firstQuery), (commandBuffer, micromapCount, pMicromaps, queryType, queryPool, firstQuery))
+#else
+#define VILC_DEVICE_COMMANDS_1343bf61(X, X_RESULT)
+#endif /* defined(VK_EXT_opacity_micromap) */
+#if defined(VK_EXT_sample_locations)
+#define VILC_DEVICE_COMMANDS_1ad4d091(X, X_RESULT) \
+	X(vkCmdSetSampleLocationsEXT, (VkCommandBuffer commandBuffer, const VkSampleLocationsInfoEXT* pSampleLocationsInfo), (commandBuffer, pSampleLocationsInfo))
+#else
+#define VILC_DEVICE_COMMANDS_1ad4d091(X, X_RESULT)
+#endif /* defined(VK_EXT_sample_locations) */
+#if defined(VK_EXT_shader_object)
+#define VILC_DEVICE_COMMANDS_868b54c7(X, X_RESULT) \
+	X(vkCmdBindShadersEXT, (VkCommandBuffer commandBuffer, uint32_t stageCount, const VkShaderStageFlagBits* pStages, const VkShaderEXT* pShaders), (commandBuffer, stageCount, pStages, pShaders))
+#else
+#define VILC_DEVICE_COMMANDS_868b54c7(X, X_RESULT)
+#endif /* defined(VK_EXT_shader_object) */
+#if defined(VK_EXT_transform_feedback)
+#define VILC_DEVICE_COMMANDS_29cf2c8a(X, X_RESULT) \
+	X(vkCmdBeginQueryIndexedEXT, (VkCommandBuffer commandBuffer, VkQueryPool queryPool, uint32_t query, VkQueryControlFlags flags, uint32_t index), (commandBuffer, queryPool, query, flags, index)) \
+	X(vkCmdBeginTransformFeedbackEXT, (VkCommandBuffer commandBuffer, uint32_t firstCounterBuffer, uint32_t counterBufferCount, const VkBuffer* pCounterBuffers, const VkDeviceSize* pCounterBufferOffsets), (commandBuffer, firstCounterBuffer, counterBufferCount, pCounterBuffers, pCounterBufferOffsets)) \
+	X(vkCmdBindTransformFeedbackBuffersEXT, (VkCommandBuffer commandBuffer, uint32_t firstBinding, uint32_t bindingCount, const VkBuffer* pBuffers, const VkDeviceSize* pOffsets, const VkDeviceSize* pSizes), (commandBuffer, firstBinding, bindingCount, pBuffers, pOffsets, pSizes)) \
+	X(vkCmdDrawIndirectByteCountEXT, (VkCommandBuffer commandBuffer, uint32_t instanceCount, uint32_t firstInstance, VkBuffer counterBuffer, VkDeviceSize counterBufferOffset, uint32_t counterOffset, uint32_t vertexStride), (commandBuffer, instanceCount, firstInstance, counterBuffer, counterBufferOffset, counterOffset, vertexStride)) \
+	X(vkCmdEndQueryIndexedEXT, (VkCommandBuffer commandBuffer, VkQueryPool queryPool, uint32_t query, uint32_t index), (commandBuffer, queryPool, query, index)) \
+	X(vkCmdEndTransformFeedbackEXT, (VkCommandBuffer commandBuffer, uint32_t firstCounterBuffer, uint32_t counterBufferCount, const VkBuffer* pCounterBuffers, const VkDeviceSize* pCounterBufferOffsets), (commandBuffer, firstCounterBuffer, counterBufferCount, pCounterBuffers, pCounterBufferOffsets))
+#else
+#define VILC_DEVICE_COMMANDS_29cf2c8a(X, X_RESULT)
+#endif /* defined(VK_EXT_transform_feedback) */
+#if defined(VK_HUAWEI_cluster_culling_shader)
+#define VILC_DEVICE_COMMANDS_6d94e656(X, X_RESULT) \
+	X(vkCmdDrawClusterHUAWEI, (VkCommandBuffer commandBuffer, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ), (commandBuffer, groupCountX, groupCountY, groupCountZ)) \
+	X(vkCmdDrawClusterIndirectHUAWEI, (VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset), (commandBuffer, buffer, offset))
+#else
+#define VILC_DEVICE_COMMANDS_6d94e656(X, X_RESULT)
+#endif /* defined(VK_HUAWEI_cluster_culling_shader) */
+#if defined(VK_HUAWEI_invocation_mask)
+#define VILC_DEVICE_COMMANDS_bac71944(X, X_RESULT) \
+	X(vkCmdBindInvocationMaskHUAWEI, (VkCommandBuffer commandBuffer, VkImageView imageView, VkImageLayout imageLayout), (commandBuffer, imageView, imageLayout))
+#else
+#define VILC_DEVICE_COMMANDS_bac71944(X, X_RESULT)
+#endif /* defined(VK_HUAWEI_invocation_mask) */
+#if defined(VK_HUAWEI_subpass_shading)
+#define VILC_DEVICE_COMMANDS_7da16759(X, X_RESULT) \
+	X(vkCmdSubpassShadingHUAWEI, (VkCommandBuffer commandBuffer), (commandBuffer))
+#else
+#define VILC_DEVICE_COMMANDS_7da16759(X, X_RESULT)
+#endif /* defined(VK_HUAWEI_subpass_shading) */
+#if defined(VK_INTEL_performance_query)
+#define VILC_DEVICE_COMMANDS_c07849ca(X, X_RESULT) \
+	X_RESULT(vkCmdSetPerformanceMarkerINTEL, (VkCommandBuffer commandBuffer, const VkPerformanceMarkerInfoINTEL* pMarkerInfo), (commandBuffer, pMarkerInfo)) \
+	X_RESULT(vkCmdSetPerformanceOverrideINTEL, (VkCommandBuffer commandBuffer, const VkPerformanceOverrideInfoINTEL* pOverrideInfo), (commandBuffer, pOverrideInfo)) \
+	X_RESULT(vkCmdSetPerformanceStreamMarkerINTEL, (VkCommandBuffer commandBuffer, const VkPerformanceStreamMarkerInfoINTEL* pMarkerInfo), (commandBuffer, pMarkerInfo))
+#else
+#define VILC_DEVICE_COMMANDS_c07849ca(X, X_RESULT)
+#endif /* defined(VK_INTEL_performance_query) */
+#if defined(VK_KHR_acceleration_structure)
+#define VILC_DEVICE_COMMANDS_6d320690(X, X_RESULT) \
+	X(vkCmdBuildAccelerationStructuresIndirectKHR, (VkCommandBuffer                  commandBuffer, uint32_t                                           infoCount, const VkAccelerationStructureBuildGeometryInfoKHR* pInfos, const VkDeviceAddress*             pIndirectDeviceAddresses, const uint32_t*                    pIndirectStrides, const uint32_t* const*             ppMaxPrimitiveCounts), (commandBuffer, infoCount, pInfos, pIndirectDeviceAddresses, pIndirectStrides, ppMaxPrimitiveCounts)) \
+	X(vkCmdBuildAccelerationStructuresKHR, (VkCommandBuffer                                    commandBuffer, uint32_t infoCount, const VkAccelerationStructureBuildGeometryInfoKHR* pInfos, const VkAccelerationStructureBuildRangeInfoKHR* const* ppBuildRangeInfos), (commandBuffer, infoCount, pInfos, ppBuildRangeInfos)) \
+	X(vkCmdCopyAccelerationStructureKHR, (VkCommandBuffer commandBuffer, const VkCopyAccelerationStructureInfoKHR* pInfo), (commandBuffer, pInfo)) \
+	X(vkCmdCopyAccelerationStructureToMemoryKHR, (VkCommandBuffer commandBuffer, const VkCopyAccelerationStructureToMemoryInfoKHR* pInfo), (commandBuffer, pInfo)) \
+	X(vkCmdCopyMemoryToAccelerationStructureKHR, (VkCommandBuffer commandBuffer, const VkCopyMemoryToAccelerationStructureInfoKHR* pInfo), (commandBuffer, pInfo)) \
+	X(vkCmdWriteAccelerationStructuresPropertiesKHR, (VkCommandBuffer commandBuffer, uint32_t accelerationStructureCount, const VkAccelerationStructureKHR* pAccelerationStructures, VkQueryType queryType, VkQueryPool queryPool, uint32_t firstQuery), (commandBuffer, accelerationStructureCount, pAccelerationStructures, queryType, queryPool, firstQuery))
+#else
+#define VILC_DEVICE_COMMANDS_6d320690(X, X_RESULT)
+#endif /* defined(VK_KHR_acceleration_structure) */
+#if defined(VK_KHR_copy_commands2)
+#define VILC_DEVICE_COMMANDS_e6199a9e(X, X_RESULT) \
+	X(vkCmdBlitImage2KHR, (VkCommandBuffer commandBuffer, const VkBlitImageInfo2* pBlitImageInfo), (commandBuffer, pBlitImageInfo)) \
+	X(vkCmdCopyBuffer2KHR, (VkCommandBuffer commandBuffer, const VkCopyBufferInfo2* pCopyBufferInfo), (commandBuffer, pCopyBufferInfo)) \
+	X(vkCmdCopyBufferToImage2KHR, (VkCommandBuffer commandBuffer, const VkCopyBufferToImageInfo2* pCopyBufferToImageInfo), (commandBuffer, pCopyBufferToImageInfo)) \
+	X(vkCmdCopyImage2KHR, (VkCommandBuffer commandBuffer, const VkCopyImageInfo2* pCopyImageInfo), (commandBuffer, pCopyImageInfo)) \
+	X(vkCmdCopyImageToBuffer2KHR, (VkCommandBuffer commandBuffer, const VkCopyImageToBufferInfo2* pCopyImageToBufferInfo), (commandBuffer, pCopyImageToBufferInfo)) \
+	X(vkCmdResolveImage2KHR, (VkCommandBuffer commandBuffer, const VkResolveImageInfo2* pResolveImageInfo), (commandBuffer, pResolveImageInfo))
+#else
+#define VILC_DEVICE_COMMANDS_e6199a9e(X, X_RESULT)
+#endif /* defined(VK_KHR_copy_commands2) */
+#if defined(VK_KHR_copy_memory_indirect)
+#define VILC_DEVICE_COMMANDS_3b35756f(X, X_RESULT) \
+	X(vkCmdCopyMemoryIndirectKHR, (VkCommandBuffer commandBuffer, const VkCopyMemoryIndirectInfoKHR* pCopyMemoryIndirectInfo), (commandBuffer, pCopyMemoryIndirectInfo)) \
+	X(vkCmdCopyMemoryToImageIndirectKHR, (VkCommandBuffer commandBuffer, const VkCopyMemoryToImageIndirectInfoKHR* pCopyMemoryToImageIndirectInfo), (commandBuffer, pCopyMemoryToImageIndirectInfo))
+#else
+#define VILC_DEVICE_COMMANDS_3b35756f(X, X_RESULT)
+#endif /* defined(VK_KHR_copy_memory_indirect) */
+#if defined(VK_KHR_create_renderpass2)
+#define VILC_DEVICE_COMMANDS_3c2407aa(X, X_RESULT) \
+	X(vkCmdBeginRenderPass2KHR, (VkCommandBuffer commandBuffer, const VkRenderPassBeginInfo*      pRenderPassBegin, const VkSubpassBeginInfo*      pSubpassBeginInfo), (commandBuffer, pRenderPassBegin, pSubpassBeginInfo)) \
+	X(vkCmdEndRenderPass2KHR, (VkCommandBuffer commandBuffer, const VkSubpassEndInfo*        pSubpassEndInfo), (commandBuffer, pSubpassEndInfo)) \
+	X(vkCmdNextSubpass2KHR, (VkCommandBuffer commandBuffer, const VkSubpassBeginInfo*      pSubpassBeginInfo, const VkSubpassEndInfo*        pSubpassEndInfo), (commandBuffer, pSubpassBeginInfo, pSubpassEndInfo))
+#else
+#define VILC_DEVICE_COMMANDS_3c2407aa(X, X_RESULT)
+#endif /* defined(VK_KHR_create_renderpass2) */
+#if defined(VK_KHR_device_group)
+#define VILC_DEVICE_COMMANDS_21e7e17f(X, X_RESULT) \
+	X(vkCmdDispatchBaseKHR, (VkCommandBuffer commandBuffer, uint32_t baseGroupX, uint32_t baseGroupY, uint32_t baseGroupZ, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ), (commandBuffer, baseGroupX, baseGroupY, baseGroupZ, groupCountX, groupCountY, groupCountZ)) \
+	X(vkCmdSetDeviceMaskKHR, (VkCommandBuffer commandBuffer, uint32_t deviceMask), (commandBuffer, deviceMask))
+#else
+#define VILC_DEVICE_COMMANDS_21e7e17f(X, X_RESULT)
+#endif /* defined(VK_KHR_device_group) */
+#if defined(VK_KHR_draw_indirect_count)
+#define VILC_DEVICE_COMMANDS_b3885a43(X, X_RESULT) \
+	X(vkCmdDrawIndexedIndirectCountKHR, (VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkBuffer countBuffer, VkDeviceSize countBufferOffset, uint32_t maxDrawCount, uint32_t stride), (commandBuffer, buffer, offset, countBuffer, countBufferOffset, maxDrawCount, stride)) \
+	X(vkCmdDrawIndirectCountKHR, (VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkBuffer countBuffer, VkDeviceSize countBufferOffset, uint32_t maxDrawCount, uint32_t stride), (commandBuffer, buffer, offset, countBuffer, countBufferOffset, maxDrawCount, stride))
+#else
+#define VILC_DEVICE_COMMANDS_b3885a43(X, X_RESULT)
+#endif /* defined(VK_KHR_draw_indirect_count) */
+#if defined(VK_KHR_dynamic_rendering)
+#define VILC_DEVICE_COMMANDS_4981896c(X, X_RESULT) \
+	X(vkCmdBeginRenderingKHR, (VkCommandBuffer                   commandBuffer, const VkRenderingInfo*                              pRenderingInfo), (commandBuffer, pRenderingInfo)) \
+	X(vkCmdEndRenderingKHR, (VkCommandBuffer                   commandBuffer), (commandBuffer))
+#else
+#define VILC_DEVICE_COMMANDS_4981896c(X, X_RESULT)
+#endif /* defined(VK_KHR_dynamic_rendering) */
+#if defined(VK_KHR_dynamic_rendering_local_read)
+#define VILC_DEVICE_COMMANDS_904d87b5(X, X_RESULT) \
+	X(vkCmdSetRenderingAttachmentLocationsKHR, (VkCommandBuffer commandBuffer, const VkRenderingAttachmentLocationInfo* pLocationInfo), (commandBuffer, pLocationInfo)) \
+	X(vkCmdSetRenderingInputAttachmentIndicesKHR, (VkCommandBuffer commandBuffer, const VkRenderingInputAttachmentIndexInfo* pInputAttachmentIndexInfo), (commandBuffer, pInputAttachmentIndexInfo))
+#else
+#define VILC_DEVICE_COMMANDS_904d87b5(X, X_RESULT)
+#endif /* defined(VK_KHR_dynamic_rendering_local_read) */
+#if defined(VK_KHR_fragment_shading_rate)
+#define VILC_DEVICE_COMMANDS_4bf8c3d9(X, X_RESULT) \
+	X(vkCmdSetFragmentShadingRateKHR, (VkCommandBuffer           commandBuffer, const VkExtent2D*                           pFragmentSize, const VkFragmentShadingRateCombinerOpKHR    combinerOps[2]), (commandBuffer, pFragmentSize, combinerOps))
+#else
+#define VILC_DEVICE_COMMANDS_4bf8c3d9(X, X_RESULT)
+#endif /* defined(VK_KHR_fragment_shading_rate) */
+#if defined(VK_KHR_line_rasterization)
+#define VILC_DEVICE_COMMANDS_8e1ef3e7(X, X_RESULT) \
+	X(vkCmdSetLineStippleKHR, (VkCommandBuffer commandBuffer, uint32_t lineStippleFactor, uint16_t lineStipplePattern), (commandBuffer, lineStippleFactor, lineStipplePattern))
+#else
+#define VILC_DEVICE_COMMANDS_8e1ef3e7(X, X_RESULT)
+#endif /* defined(VK_KHR_line_rasterization) */
+#if defined(VK_KHR_maintenance10)
+#define VILC_DEVICE_COMMANDS_8d13c4ac(X, X_RESULT) \
+	X(vkCmdEndRendering2KHR, (VkCommandBuffer                   commandBuffer, const VkRenderingEndInfoKHR*        pRenderingEndInfo), (commandBuffer, pRenderingEndInfo))
+#else
+#define VILC_DEVICE_COMMANDS_8d13c4ac(X, X_RESULT)
+#endif /* defined(VK_KHR_maintenance10) */
+#if defined(VK_KHR_maintenance5)
+#define VILC_DEVICE_COMMANDS_14a444d4(X, X_RESULT) \
+	X(vkCmdBindIndexBuffer2KHR, (VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, VkIndexType indexType), (commandBuffer, buffer, offset, size, indexType))
+#else
+#define VILC_DEVICE_COMMANDS_14a444d4(X, X_RESULT)
+#endif /* defined(VK_KHR_maintenance5) */
+#if defined(VK_KHR_maintenance6)
+#define VILC_DEVICE_COMMANDS_3f891717(X, X_RESULT) \
+	X(vkCmdBindDescriptorSets2KHR, (VkCommandBuffer commandBuffer, const VkBindDescriptorSetsInfo*   pBindDescriptorSetsInfo), (commandBuffer, pBindDescriptorSetsInfo)) \
+	X(vkCmdPushConstants2KHR, (VkCommandBuffer commandBuffer, const VkPushConstantsInfo*        pPushConstantsInfo), (commandBuffer, pPushConstantsInfo))
+#else
+#define VILC_DEVICE_COMMANDS_3f891717(X, X_RESULT)
+#endif /* defined(VK_KHR_maintenance6) */
+#if defined(VK_KHR_maintenance6) && defined(VK_KHR_push_descriptor)
+#define VILC_DEVICE_COMMANDS_ca97394(X, X_RESULT) \
+	X(vkCmdPushDescriptorSet2KHR, (VkCommandBuffer commandBuffer, const VkPushDescriptorSetInfo*    pPushDescriptorSetInfo), (commandBuffer, pPushDescriptorSetInfo)) \
+	X(vkCmdPushDescriptorSetWithTemplate2KHR, (VkCommandBuffer commandBuffer, const VkPushDescriptorSetWithTemplateInfo* pPushDescriptorSetWithTemplateInfo), (commandBuffer, pPushDescriptorSetWithTemplateInfo))
+#else
+#define VILC_DEVICE_COMMANDS_ca97394(X, X_RESULT)
+#endif /* defined(VK_KHR_maintenance6) && defined(VK_KHR_push_descriptor) */
+#if defined(VK_KHR_maintenance6) && defined(VK_EXT_descriptor_buffer)
+#define VILC_DEVICE_COMMANDS_63c2604b(X, X_RESULT) \
+	X(vkCmdBindDescriptorBufferEmbeddedSamplers2EXT, (VkCommandBuffer commandBuffer, const VkBindDescriptorBufferEmbeddedSamplersInfoEXT* pBindDescriptorBufferEmbeddedSamplersInfo), (commandBuffer, pBindDescriptorBufferEmbeddedSamplersInfo)) \
+	X(vkCmdSetDescriptorBufferOffsets2EXT, (VkCommandBuffer commandBuffer, const VkSetDescriptorBufferOffsetsInfoEXT* pSetDescriptorBufferOffsetsInfo), (commandBuffer, pSetDescriptorBufferOffsetsInfo))
+#else
+#define VILC_DEVICE_COMMANDS_63c2604b(X, X_RESULT)
+#endif /* defined(VK_KHR_maintenance6) && defined(VK_EXT_descriptor_buffer) */
+#if defined(VK_KHR_push_descriptor)
+#define VILC_DEVICE_COMMANDS_4fad6a7e(X, X_RESULT) \
+	X(vkCmdPushDescriptorSetKHR, (VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout, uint32_t set, uint32_t descriptorWriteCount, const VkWriteDescriptorSet* pDescriptorWrites), (commandBuffer, pipelineBindPoint, layout, set, descriptorWriteCount, pDescriptorWrites))
+#else
+#define VILC_DEVICE_COMMANDS_4fad6a7e(X, X_RESULT)
+#endif /* defined(VK_KHR_push_descriptor) */
+#if defined(VK_KHR_ray_tracing_maintenance1) && defined(VK_KHR_ray_tracing_pipeline)
+#define VILC_DEVICE_COMMANDS_4ea9cf7f(X, X_RESULT) \
+	X(vkCmdTraceRaysIndirect2KHR, (VkCommandBuffer commandBuffer, VkDeviceAddress indirectDeviceAddress), (commandBuffer, indirectDeviceAddress))
+#else
+#define VILC_DEVICE_COMMANDS_4ea9cf7f(X, X_RESULT)
+#endif /* defined(VK_KHR_ray_tracing_maintenance1) && defined(VK_KHR_ray_tracing_pipeline) */
+#if defined(VK_KHR_ray_tracing_pipeline)
+#define VILC_DEVICE_COMMANDS_bc0c4a55(X, X_RESULT) \
+	X(vkCmdSetRayTracingPipelineStackSizeKHR, (VkCommandBuffer commandBuffer, uint32_t pipelineStackSize), (commandBuffer, pipelineStackSize)) \
+	X(vkCmdTraceRaysIndirectKHR, (VkCommandBuffer commandBuffer, const VkStridedDeviceAddressRegionKHR* pRaygenShaderBindingTable, const VkStridedDeviceAddressRegionKHR* pMissShaderBindingTable, const VkStridedDeviceAddressRegionKHR* pHitShaderBindingTable, const VkStridedDeviceAddressRegionKHR* pCallableShaderBindingTable, VkDeviceAddress indirectDeviceAddress), (commandBuffer, pRaygenShaderBindingTable, pMissShaderBindingTable, pHitShaderBindingTable, pCallableShaderBindingTable, indirectDeviceAddress)) \
+	X(vkCmdTraceRaysKHR, (VkCommandBuffer commandBuffer, const VkStridedDeviceAddressRegionKHR* pRaygenShaderBindingTable, const VkStridedDeviceAddressRegionKHR* pMissShaderBindingTable, const VkStridedDeviceAddressRegionKHR* pHitShaderBindingTable, const VkStridedDeviceAddressRegionKHR* pCallableShaderBindingTable, uint32_t width, uint32_t height, uint32_t depth), (commandBuffer, pRaygenShaderBindingTable, pMissShaderBindingTable, pHitShaderBindingTable, pCallableShaderBindingTable, width, height, depth))
+#else
+#define VILC_DEVICE_COMMANDS_bc0c4a55(X, X_RESULT)
+#endif /* defined(VK_KHR_ray_tracing_pipeline) */
+#if defined(VK_KHR_synchronization2)
+#define VILC_DEVICE_COMMANDS_47b17602(X, X_RESULT) \
+	X(vkCmdPipelineBarrier2KHR, (VkCommandBuffer                   commandBuffer, const VkDependencyInfo*                             pDependencyInfo), (commandBuffer, pDependencyInfo)) \
+	X(vkCmdResetEvent2KHR, (VkCommandBuffer                   commandBuffer, VkEvent                                             event, VkPipelineStageFlags2               stageMask), (commandBuffer, event, stageMask)) \
+	X(vkCmdSetEvent2KHR, (VkCommandBuffer                   commandBuffer, VkEvent                                             event, const VkDependencyInfo*                             pDependencyInfo), (commandBuffer, event, pDependencyInfo)) \
+	X(vkCmdWaitEvents2KHR, (VkCommandBuffer                   commandBuffer, uint32_t                                            eventCount, const VkEvent*                     pEvents, const VkDependencyInfo*            pDependencyInfos), (commandBuffer, eventCount, pEvents, pDependencyInfos)) \
+	X(vkCmdWriteTimestamp2KHR, (VkCommandBuffer                   commandBuffer, VkPipelineStageFlags2               stage, VkQueryPool                                         queryPool, uint32_t                                            query), (commandBuffer, stage, queryPool, query))
+#else
+#define VILC_DEVICE_COMMANDS_47b17602(X, X_RESULT)
+#endif /* defined(VK_KHR_synchronization2) */
+#if defined(VK_KHR_video_decode_queue)
+#define VILC_DEVICE_COMMANDS_996c4c6d(X, X_RESULT) \
+	X(vkCmdDecodeVideoKHR, (VkCommandBuffer commandBuffer, const VkVideoDecodeInfoKHR* pDecodeInfo), (commandBuffer, pDecodeInfo))
+#else
+#define VILC_DEVICE_COMMANDS_996c4c6d(X, X_RESULT)
+#endif /* defined(VK_KHR_video_decode_queue) */
+#if defined(VK_KHR_video_encode_queue)
+#define VILC_DEVICE_COMMANDS_356831e6(X, X_RESULT) \
+	X(vkCmdEncodeVideoKHR, (VkCommandBuffer commandBuffer, const VkVideoEncodeInfoKHR* pEncodeInfo), (commandBuffer, pEncodeInfo))
+#else
+#define VILC_DEVICE_COMMANDS_356831e6(X, X_RESULT)
+#endif /* defined(VK_KHR_video_encode_queue) */
+#if defined(VK_KHR_video_queue)
+#define VILC_DEVICE_COMMANDS_8b190428(X, X_RESULT) \
+	X(vkCmdBeginVideoCodingKHR, (VkCommandBuffer commandBuffer, const VkVideoBeginCodingInfoKHR* pBeginInfo), (commandBuffer, pBeginInfo)) \
+	X(vkCmdControlVideoCodingKHR, (VkCommandBuffer commandBuffer, const VkVideoCodingControlInfoKHR* pCodingControlInfo), (commandBuffer, pCodingControlInfo)) \
+	X(vkCmdEndVideoCodingKHR, (VkCommandBuffer commandBuffer, const VkVideoEndCodingInfoKHR* pEndCodingInfo), (commandBuffer, pEndCodingInfo))
+#else
+#define VILC_DEVICE_COMMANDS_8b190428(X, X_RESULT)
+#endif /* defined(VK_KHR_video_queue) */
+#if defined(VK_NVX_binary_import)
+#define VILC_DEVICE_COMMANDS_351a1ef8(X, X_RESULT) \
+	X(vkCmdCuLaunchKernelNVX, (VkCommandBuffer commandBuffer, const VkCuLaunchInfoNVX* pLaunchInfo), (commandBuffer, pLaunchInfo))
+#else
+#define VILC_DEVICE_COMMANDS_351a1ef8(X, X_RESULT)
+#endif /* defined(VK_NVX_binary_import) */
+#if defined(VK_NV_clip_space_w_scaling)
+#define VILC_DEVICE_COMMANDS_9d93d733(X, X_RESULT) \
+	X(vkCmdSetViewportWScalingNV, (VkCommandBuffer commandBuffer, uint32_t firstViewport, uint32_t viewportCount, const VkViewportWScalingNV* pViewportWScalings), (commandBuffer, firstViewport, viewportCount, pViewportWScalings))
+#else
+#define VILC_DEVICE_COMMANDS_9d93d733(X, X_RESULT)
+#endif /* defined(VK_NV_clip_space_w_scaling) */
+#if defined(VK_NV_cluster_acceleration_structure)
+#define VILC_DEVICE_COMMANDS_ff3d3c5b(X, X_RESULT) \
+	X(vkCmdBuildClusterAccelerationStructureIndirectNV, (VkCommandBuffer                     commandBuffer, const VkClusterAccelerationStructureCommandsInfoNV*  pCommandInfos), (commandBuffer, pCommandInfos))
+#else
+#define VILC_DEVICE_COMMANDS_ff3d3c5b(X, X_RESULT)
+#endif /* defined(VK_NV_cluster_acceleration_structure) */
+#if defined(VK_NV_cooperative_vector)
+#define VILC_DEVICE_COMMANDS_5325d69f(X, X_RESULT) \
+	X(vkCmdConvertCooperativeVectorMatrixNV, (VkCommandBuffer commandBuffer, uint32_t infoCount, const VkConvertCooperativeVectorMatrixInfoNV* pInfos), (commandBuffer, infoCount, pInfos))
+#else
+#define VILC_DEVICE_COMMANDS_5325d69f(X, X_RESULT)
+#endif /* defined(VK_NV_cooperative_vector) */
+#if defined(VK_NV_copy_memory_indirect)
+#define VILC_DEVICE_COMMANDS_234482fc(X, X_RESULT) \
+	X(vkCmdCopyMemoryIndirectNV, (VkCommandBuffer commandBuffer, VkDeviceAddress copyBufferAddress, uint32_t copyCount, uint32_t stride), (commandBuffer, copyBufferAddress, copyCount, stride)) \
+	X(vkCmdCopyMemoryToImageIndirectNV, (VkCommandBuffer commandBuffer, VkDeviceAddress copyBufferAddress, uint32_t copyCount, uint32_t stride, VkImage dstImage, VkImageLayout dstImageLayout, const VkImageSubresourceLayers* pImageSubresources), (commandBuffer, copyBufferAddress, copyCount, stride, dstImage, dstImageLayout, pImageSubresources))
+#else
+#define VILC_DEVICE_COMMANDS_234482fc(X, X_RESULT)
+#endif /* defined(VK_NV_copy_memory_indirect) */
+#if defined(VK_NV_cuda_kernel_launch)
+#define VILC_DEVICE_COMMANDS_a603ea43(X, X_RESULT) \
+	X(vkCmdCudaLaunchKernelNV, (VkCommandBuffer commandBuffer, const VkCudaLaunchInfoNV* pLaunchInfo), (commandBuffer, pLaunchInfo))
+#else
+#define VILC_DEVICE_COMMANDS_a603ea43(X, X_RESULT)
+#endif /* defined(VK_NV_cuda_kernel_launch) */
+#if defined(VK_NV_device_diagnostic_checkpoints)
+#define VILC_DEVICE_COMMANDS_a292d39b(X, X_RESULT) \
+	X(vkCmdSetCheckpointNV, (VkCommandBuffer commandBuffer, const void* pCheckpointMarker), (commandBuffer, pCheckpointMarker))
+#else
+#define VILC_DEVICE_COMMANDS_a292d39b(X, X_RESULT)
+#endif /* defined(VK_NV_device_diagnostic_checkpoints) */
+#if defined(VK_NV_device_generated_commands)
+#define VILC_DEVICE_COMMANDS_e75168a3(X, X_RESULT) \
+	X(vkCmdBindPipelineShaderGroupNV, (VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipeline pipeline, uint32_t groupIndex), (commandBuffer, pipelineBindPoint, pipeline, groupIndex)) \
+	X(vkCmdExecuteGeneratedCommandsNV, (VkCommandBuffer commandBuffer, VkBool32 isPreprocessed, const VkGeneratedCommandsInfoNV* pGeneratedCommandsInfo), (commandBuffer, isPreprocessed, pGeneratedCommandsInfo)) \
+	X(vkCmdPreprocessGeneratedCommandsNV, (VkCommandBuffer commandBuffer, const VkGeneratedCommandsInfoNV* pGeneratedCommandsInfo), (commandBuffer, pGeneratedCommandsInfo))
+#else
+#define VILC_DEVICE_COMMANDS_e75168a3(X, X_RESULT)
+#endif /* defined(VK_NV_device_generated_commands) */
+#if defined(VK_NV_device_generated_commands_compute)
+#define VILC_DEVICE_COMMANDS_1c25b7f5(X, X_RESULT) \
+	X(vkCmdUpdatePipelineIndirectBufferNV, (VkCommandBuffer commandBuffer, VkPipelineBindPoint           pipelineBindPoint, VkPipeline                    pipeline), (commandBuffer, pipelineBindPoint, pipeline))
+#else
+#define VILC_DEVICE_COMMANDS_1c25b7f5(X, X_RESULT)
+#endif /* defined(VK_NV_device_generated_commands_compute) */
+#if defined(VK_NV_fragment_shading_rate_enums)
+#define VILC_DEVICE_COMMANDS_393ed979(X, X_RESULT) \
+	X(vkCmdSetFragmentShadingRateEnumNV, (VkCommandBuffer           commandBuffer, VkFragmentShadingRateNV                     shadingRate, const VkFragmentShadingRateCombinerOpKHR    combinerOps[2]), (commandBuffer, shadingRate, combinerOps))
+#else
+#define VILC_DEVICE_COMMANDS_393ed979(X, X_RESULT)
+#endif /* defined(VK_NV_fragment_shading_rate_enums) */
+#if defined(VK_NV_memory_decompression)
+#define VILC_DEVICE_COMMANDS_ceb65124(X, X_RESULT) \
+	X(vkCmdDecompressMemoryIndirectCountNV, (VkCommandBuffer commandBuffer, VkDeviceAddress indirectCommandsAddress, VkDeviceAddress indirectCommandsCountAddress, uint32_t stride), (commandBuffer, indirectCommandsAddress, indirectCommandsCountAddress, stride)) \
+	X(vkCmdDecompressMemoryNV, (VkCommandBuffer commandBuffer, uint32_t decompressRegionCount, const VkDecompressMemoryRegionNV* pDecompressMemoryRegions), (commandBuffer, decompressRegionCount, pDecompressMemoryRegions))
+#else
+#define VILC_DEVICE_COMMANDS_ceb65124(X, X_RESULT)
+#endif /* defined(VK_NV_memory_decompression) */
+#if defined(VK_NV_mesh_shader)
+#define VILC_DEVICE_COMMANDS_7d885f36(X, X_RESULT) \
+	X(vkCmdDrawMeshTasksIndirectNV, (VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride), (commandBuffer, buffer, offset, drawCount, stride)) \
+	X(vkCmdDrawMeshTasksNV, (VkCommandBuffer commandBuffer, uint32_t taskCount, uint32_t firstTask), (commandBuffer, taskCount, firstTask))
+#else
+#define VILC_DEVICE_COMMANDS_7d885f36(X, X_RESULT)
+#endif /* defined(VK_NV_mesh_shader) */
+#if defined(VK_NV_mesh_shader) && (defined(VK_VERSION_1_2) || defined(VK_KHR_draw_indirect_count) || defined(VK_AMD_draw_indirect_count))
+#define VILC_DEVICE_COMMANDS_e16248ab(X, X_RESULT) \
+	X(vkCmdDrawMeshTasksIndirectCountNV, (VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkBuffer countBuffer, VkDeviceSize countBufferOffset, uint32_t maxDrawCount, uint32_t stride), (commandBuffer, buffer, offset, countBuffer, countBufferOffset, maxDrawCount, stride))
+#else
+#define VILC_DEVICE_COMMANDS_e16248ab(X, X_RESULT)
+#endif /* defined(VK_NV_mesh_shader) && (defined(VK_VERSION_1_2) || defined(VK_KHR_draw_indirect_count) || defined(VK_AMD_draw_indirect_count)) */
+#if defined(VK_NV_optical_flow)
+#define VILC_DEVICE_COMMANDS_66c32070(X, X_RESULT) \
+	X(vkCmdOpticalFlowExecuteNV, (VkCommandBuffer commandBuffer, VkOpticalFlowSessionNV session, const VkOpticalFlowExecuteInfoNV* pExecuteInfo), (commandBuffer, session, pExecuteInfo))
+#else
+#define VILC_DEVICE_COMMANDS_66c32070(X, X_RESULT)
+#endif /* defined(VK_NV_optical_flow) */
+#if defined(VK_NV_partitioned_acceleration_structure)
+#define VILC_DEVICE_COMMANDS_440badfa(X, X_RESULT) \
+	X(vkCmdBuildPartitionedAccelerationStructuresNV, (VkCommandBuffer                     commandBuffer, const VkBuildPartitionedAccelerationStructureInfoNV*  pBuildInfo), (commandBuffer, pBuildInfo))
+#else
+#define VILC_DEVICE_COMMANDS_440badfa(X, X_RESULT)
+#endif /* defined(VK_NV_partitioned_acceleration_structure) */
+#if defined(VK_NV_ray_tracing)
+#define VILC_DEVICE_COMMANDS_7881c5df(X, X_RESULT) \
+	X(vkCmdBuildAccelerationStructureNV, (VkCommandBuffer commandBuffer, const VkAccelerationStructureInfoNV* pInfo, VkBuffer instanceData, VkDeviceSize instanceOffset, VkBool32 update, VkAccelerationStructureNV dst, VkAccelerationStructureNV src, VkBuffer scratch, VkDeviceSize scratchOffset), (commandBuffer, pInfo, instanceData, instanceOffset, update, dst, src, scratch, scratchOffset)) \
+	X(vkCmdCopyAccelerationStructureNV, (VkCommandBuffer commandBuffer, VkAccelerationStructureNV dst, VkAccelerationStructureNV src, VkCopyAccelerationStructureModeKHR mode), (commandBuffer, dst, src, mode)) \
+	X(vkCmdTraceRaysNV, (VkCommandBuffer commandBuffer, VkBuffer raygenShaderBindingTableBuffer, VkDeviceSize raygenShaderBindingOffset, VkBuffer missShaderBindingTableBuffer, VkDeviceSize missShaderBindingOffset, VkDeviceSize missShaderBindingStride, VkBuffer hitShaderBindingTableBuffer, VkDeviceSize hitShaderBindingOffset, VkDeviceSize hitShaderBindingStride, VkBuffer callableShaderBindingTableBuffer, VkDeviceSize callableShaderBindingOffset, VkDeviceSize callableShaderBindingStride, uint32_t width, uint32_t height, uint32_t depth), (commandBuffer, raygenShaderBindingTableBuffer, raygenShaderBindingOffset, missShaderBindingTableBuffer, missShaderBindingOffset, missShaderBindingStride, hitShaderBindingTableBuffer, hitShaderBindingOffset, hitShaderBindingStride, callableShaderBindingTableBuffer, callableShaderBindingOffset, callableShaderBindingStride, width, height, depth)) \
+	X(vkCmdWriteAccelerationStructuresPropertiesNV, (VkCommandBuffer commandBuffer, uint32_t accelerationStructureCount, const VkAccelerationStructureNV* pAccelerationStructures, VkQueryType queryType, VkQueryPool queryPool, uint32_t firstQuery), (commandBuffer, accelerationStructureCount, pAccelerationStructures, queryType, queryPool, firstQuery))
+#else
+#define VILC_DEVICE_COMMANDS_7881c5df(X, X_RESULT)
+#endif /* defined(VK_NV_ray_tracing) */
+#if defined(VK_NV_scissor_exclusive) && VK_NV_SCISSOR_EXCLUSIVE_SPEC_VERSION >= 2
+#define VILC_DEVICE_COMMANDS_6d6f7e69(X, X_RESULT) \
+	X(vkCmdSetExclusiveScissorEnableNV, (VkCommandBuffer commandBuffer, uint32_t firstExclusiveScissor, uint32_t exclusiveScissorCount, const VkBool32* pExclusiveScissorEnables), (commandBuffer, firstExclusiveScissor, exclusiveScissorCount, pExclusiveScissorEnables))
+#else
+#define VILC_DEVICE_COMMANDS_6d6f7e69(X, X_RESULT)
+#endif /* defined(VK_NV_scissor_exclusive) && VK_NV_SCISSOR_EXCLUSIVE_SPEC_VERSION >= 2 */
+#if defined(VK_NV_scissor_exclusive)
+#define VILC_DEVICE_COMMANDS_5d59a7ec(X, X_RESULT) \
+	X(vkCmdSetExclusiveScissorNV, (VkCommandBuffer commandBuffer, uint32_t firstExclusiveScissor, uint32_t exclusiveScissorCount, const VkRect2D* pExclusiveScissors), (commandBuffer, firstExclusiveScissor, exclusiveScissorCount, pExclusiveScissors))
+#else
+#define VILC_DEVICE_COMMANDS_5d59a7ec(X, X_RESULT)
+#endif /* defined(VK_NV_scissor_exclusive) */
+#if defined(VK_NV_shading_rate_image)
+#define VILC_DEVICE_COMMANDS_b1c79bf(X, X_RESULT) \
+	X(vkCmdBindShadingRateImageNV, (VkCommandBuffer commandBuffer, VkImageView imageView, VkImageLayout imageLayout), (commandBuffer, imageView, imageLayout)) \
+	X(vkCmdSetCoarseSampleOrderNV, (VkCommandBuffer commandBuffer, VkCoarseSampleOrderTypeNV sampleOrderType, uint32_t customSampleOrderCount, const VkCoarseSampleOrderCustomNV* pCustomSampleOrders), (commandBuffer, sampleOrderType, customSampleOrderCount, pCustomSampleOrders)) \
+	X(vkCmdSetViewportShadingRatePaletteNV, (VkCommandBuffer commandBuffer, uint32_t firstViewport, uint32_t viewportCount, const VkShadingRatePaletteNV* pShadingRatePalettes), (commandBuffer, firstViewport, viewportCount, pShadingRatePalettes))
+#else
+#define VILC_DEVICE_COMMANDS_b1c79bf(X, X_RESULT)
+#endif /* defined(VK_NV_shading_rate_image) */
+#if defined(VK_QCOM_tile_memory_heap)
+#define VILC_DEVICE_COMMANDS_978c3b4e(X, X_RESULT) \
+	X(vkCmdBindTileMemoryQCOM, (VkCommandBuffer commandBuffer, const VkTileMemoryBindInfoQCOM* pTileMemoryBindInfo), (commandBuffer, pTileMemoryBindInfo))
+#else
+#define VILC_DEVICE_COMMANDS_978c3b4e(X, X_RESULT)
+#endif /* defined(VK_QCOM_tile_memory_heap) */
+#if defined(VK_QCOM_tile_shading)
+#define VILC_DEVICE_COMMANDS_262585f9(X, X_RESULT) \
+	X(vkCmdBeginPerTileExecutionQCOM, (VkCommandBuffer commandBuffer, const VkPerTileBeginInfoQCOM* pPerTileBeginInfo), (commandBuffer, pPerTileBeginInfo)) \
+	X(vkCmdDispatchTileQCOM, (VkCommandBuffer commandBuffer, const VkDispatchTileInfoQCOM* pDispatchTileInfo), (commandBuffer, pDispatchTileInfo)) \
+	X(vkCmdEndPerTileExecutionQCOM, (VkCommandBuffer commandBuffer, const VkPerTileEndInfoQCOM* pPerTileEndInfo), (commandBuffer, pPerTileEndInfo))
+#else
+#define VILC_DEVICE_COMMANDS_262585f9(X, X_RESULT)
+#endif /* defined(VK_QCOM_tile_shading) */
+#if (defined(VK_EXT_depth_clamp_control)) || (defined(VK_EXT_shader_object) && defined(VK_EXT_depth_clamp_control))
+#define VILC_DEVICE_COMMANDS_bd5e9f68(X, X_RESULT) \
+	X(vkCmdSetDepthClampRangeEXT, (VkCommandBuffer commandBuffer, VkDepthClampModeEXT depthClampMode, const VkDepthClampRangeEXT* pDepthClampRange), (commandBuffer, depthClampMode, pDepthClampRange))
+#else
+#define VILC_DEVICE_COMMANDS_bd5e9f68(X, X_RESULT)
+#endif /* (defined(VK_EXT_depth_clamp_control)) || (defined(VK_EXT_shader_object) && defined(VK_EXT_depth_clamp_control)) */
+#if (defined(VK_EXT_extended_dynamic_state)) || (defined(VK_EXT_shader_object))
+#define VILC_DEVICE_COMMANDS_b9d827de(X, X_RESULT) \
+	X(vkCmdBindVertexBuffers2EXT, (VkCommandBuffer commandBuffer, uint32_t firstBinding, uint32_t bindingCount, const VkBuffer* pBuffers, const VkDeviceSize* pOffsets, const VkDeviceSize* pSizes, const VkDeviceSize* pStrides), (commandBuffer, firstBinding, bindingCount, pBuffers, pOffsets, pSizes, pStrides)) \
+	X(vkCmdSetCullModeEXT, (VkCommandBuffer commandBuffer, VkCullModeFlags cullMode), (commandBuffer, cullMode)) \
+	X(vkCmdSetDepthBoundsTestEnableEXT, (VkCommandBuffer commandBuffer, VkBool32 depthBoundsTestEnable), (commandBuffer, depthBoundsTestEnable)) \
+	X(vkCmdSetDepthCompareOpEXT, (VkCommandBuffer commandBuffer, VkCompareOp depthCompareOp), (commandBuffer, depthCompareOp)) \
+	X(vkCmdSetDepthTestEnableEXT, (VkCommandBuffer commandBuffer, VkBool32 depthTestEnable), (commandBuffer, depthTestEnable)) \
+	X(vkCmdSetDepthWriteEnableEXT, (VkCommandBuffer commandBuffer, VkBool32 depthWriteEnable), (commandBuffer, depthWriteEnable)) \
+	X(vkCmdSetFrontFaceEXT, (VkCommandBuffer commandBuffer, VkFrontFace frontFace), (commandBuffer, frontFace)) \
+	X(vkCmdSetPrimitiveTopologyEXT, (VkCommandBuffer commandBuffer, VkPrimitiveTopology primitiveTopology), (commandBuffer, primitiveTopology)) \
+	X(vkCmdSetScissorWithCountEXT, (VkCommandBuffer commandBuffer, uint32_t scissorCount, const VkRect2D* pScissors), (commandBuffer, scissorCount, pScissors)) \
+	X(vkCmdSetStencilOpEXT, (VkCommandBuffer commandBuffer, VkStencilFaceFlags faceMask, VkStencilOp failOp, VkStencilOp passOp, VkStencilOp depthFailOp, VkCompareOp compareOp), (commandBuffer, faceMask, failOp, passOp, depthFailOp, compareOp)) \
+	X(vkCmdSetStencilTestEnableEXT, (VkCommandBuffer commandBuffer, VkBool32 stencilTestEnable), (commandBuffer, stencilTestEnable)) \
+	X(vkCmdSetViewportWithCountEXT, (VkCommandBuffer commandBuffer, uint32_t viewportCount, const VkViewport* pViewports), (commandBuffer, viewportCount, pViewports))
+#else
+#define VILC_DEVICE_COMMANDS_b9d827de(X, X_RESULT)
+#endif /* (defined(VK_EXT_extended_dynamic_state)) || (defined(VK_EXT_shader_object)) */
+#if (defined(VK_EXT_extended_dynamic_state2)) || (defined(VK_EXT_shader_object))
+#define VILC_DEVICE_COMMANDS_cd124ed7(X, X_RESULT) \
+	X(vkCmdSetDepthBiasEnableEXT, (VkCommandBuffer commandBuffer, VkBool32 depthBiasEnable), (commandBuffer, depthBiasEnable)) \
+	X(vkCmdSetLogicOpEXT, (VkCommandBuffer commandBuffer, VkLogicOp logicOp), (commandBuffer, logicOp)) \
+	X(vkCmdSetPatchControlPointsEXT, (VkCommandBuffer commandBuffer, uint32_t patchControlPoints), (commandBuffer, patchControlPoints)) \
+	X(vkCmdSetPrimitiveRestartEnableEXT, (VkCommandBuffer commandBuffer, VkBool32 primitiveRestartEnable), (commandBuffer, primitiveRestartEnable)) \
+	X(vkCmdSetRasterizerDiscardEnableEXT, (VkCommandBuffer commandBuffer, VkBool32 rasterizerDiscardEnable), (commandBuffer, rasterizerDiscardEnable))
+#else
+#define VILC_DEVICE_COMMANDS_cd124ed7(X, X_RESULT)
+#endif /* (defined(VK_EXT_extended_dynamic_state2)) || (defined(VK_EXT_shader_object)) */
+#if (defined(VK_EXT_extended_dynamic_state3)) || (defined(VK_EXT_shader_object))
+#define VILC_DEVICE_COMMANDS_409ab335(X, X_RESULT) \
+	X(vkCmdSetAlphaToCoverageEnableEXT, (VkCommandBuffer commandBuffer, VkBool32 alphaToCoverageEnable), (commandBuffer, alphaToCoverageEnable)) \
+	X(vkCmdSetAlphaToOneEnableEXT, (VkCommandBuffer commandBuffer, VkBool32 alphaToOneEnable), (commandBuffer, alphaToOneEnable)) \
+	X(vkCmdSetColorBlendEnableEXT, (VkCommandBuffer commandBuffer, uint32_t firstAttachment, uint32_t attachmentCount, const VkBool32* pColorBlendEnables), (commandBuffer, firstAttachment, attachmentCount, pColorBlendEnables)) \
+	X(vkCmdSetColorBlendEquationEXT, (VkCommandBuffer commandBuffer, uint32_t firstAttachment, uint32_t attachmentCount, const VkColorBlendEquationEXT* pColorBlendEquations), (commandBuffer, firstAttachment, attachmentCount, pColorBlendEquations)) \
+	X(vkCmdSetColorWriteMaskEXT, (VkCommandBuffer commandBuffer, uint32_t firstAttachment, uint32_t attachmentCount, const VkColorComponentFlags* pColorWriteMasks), (commandBuffer, firstAttachment, attachmentCount, pColorWriteMasks)) \
+	X(vkCmdSetDepthClampEnableEXT, (VkCommandBuffer commandBuffer, VkBool32 depthClampEnable), (commandBuffer, depthClampEnable)) \
+	X(vkCmdSetLogicOpEnableEXT, (VkCommandBuffer commandBuffer, VkBool32 logicOpEnable), (commandBuffer, logicOpEnable)) \
+	X(vkCmdSetPolygonModeEXT, (VkCommandBuffer commandBuffer, VkPolygonMode polygonMode), (commandBuffer, polygonMode)) \
+	X(vkCmdSetRasterizationSamplesEXT, (VkCommandBuffer commandBuffer, VkSampleCountFlagBits  rasterizationSamples), (commandBuffer, rasterizationSamples)) \
+	X(vkCmdSetSampleMaskEXT, (VkCommandBuffer commandBuffer, VkSampleCountFlagBits  samples, const VkSampleMask*    pSampleMask), (commandBuffer, samples, pSampleMask))
+#else
+#define VILC_DEVICE_COMMANDS_409ab335(X, X_RESULT)
+#endif /* (defined(VK_EXT_extended_dynamic_state3)) || (defined(VK_EXT_shader_object)) */
+#if (defined(VK_EXT_extended_dynamic_state3) && (defined(VK_KHR_maintenance2) || defined(VK_VERSION_1_1))) || (defined(VK_EXT_shader_object))
+#define VILC_DEVICE_COMMANDS_4458a8ed(X, X_RESULT) \
+	X(vkCmdSetTessellationDomainOriginEXT, (VkCommandBuffer commandBuffer, VkTessellationDomainOrigin domainOrigin), (commandBuffer, domainOrigin))
+#else
+#define VILC_DEVICE_COMMANDS_4458a8ed(X, X_RESULT)
+#endif /* (defined(VK_EXT_extended_dynamic_state3) && (defined(VK_KHR_maintenance2) || defined(VK_VERSION_1_1))) || (defined(VK_EXT_shader_object)) */
+#if (defined(VK_EXT_extended_dynamic_state3) && defined(VK_EXT_transform_feedback)) || (defined(VK_EXT_shader_object) && defined(VK_EXT_transform_feedback))
+#define VILC_DEVICE_COMMANDS_728cccc(X, X_RESULT) \
+	X(vkCmdSetRasterizationStreamEXT, (VkCommandBuffer commandBuffer, uint32_t rasterizationStream), (commandBuffer, rasterizationStream))
+#else
+#define VILC_DEVICE_COMMANDS_728cccc(X, X_RESULT)
+#endif /* (defined(VK_EXT_extended_dynamic_state3) && defined(VK_EXT_transform_feedback)) || (defined(VK_EXT_shader_object) && defined(VK_EXT_transform_feedback)) */
+#if (defined(VK_EXT_extended_dynamic_state3) && defined(VK_EXT_conservative_rasterization)) || (defined(VK_EXT_shader_object) && defined(VK_EXT_conservative_rasterization))
+#define VILC_DEVICE_COMMANDS_bc56398b(X, X_RESULT) \
+	X(vkCmdSetConservativeRasterizationModeEXT, (VkCommandBuffer commandBuffer, VkConservativeRasterizationModeEXT conservativeRasterizationMode), (commandBuffer, conservativeRasterizationMode)) \
+	X(vkCmdSetExtraPrimitiveOverestimationSizeEXT, (VkCommandBuffer commandBuffer, float extraPrimitiveOverestimationSize), (commandBuffer, extraPrimitiveOverestimationSize))
+#else
+#define VILC_DEVICE_COMMANDS_bc56398b(X, X_RESULT)
+#endif /* (defined(VK_EXT_extended_dynamic_state3) && defined(VK_EXT_conservative_rasterization)) || (defined(VK_EXT_shader_object) && defined(VK_EXT_conservative_rasterization)) */
+#if (defined(VK_EXT_extended_dynamic_state3) && defined(VK_EXT_depth_clip_enable)) || (defined(VK_EXT_shader_object) && defined(VK_EXT_depth_clip_enable))
+#define VILC_DEVICE_COMMANDS_8b7fdb3e(X, X_RESULT) \
+	X(vkCmdSetDepthClipEnableEXT, (VkCommandBuffer commandBuffer, VkBool32 depthClipEnable), (commandBuffer, depthClipEnable))
+#else
+#define VILC_DEVICE_COMMANDS_8b7fdb3e(X, X_RESULT)
+#endif /* (defined(VK_EXT_extended_dynamic_state3) && defined(VK_EXT_depth_clip_enable)) || (defined(VK_EXT_shader_object) && defined(VK_EXT_depth_clip_enable)) */
+#if (defined(VK_EXT_extended_dynamic_state3) && defined(VK_EXT_sample_locations)) || (defined(VK_EXT_shader_object) && defined(VK_EXT_sample_locations))
+#define VILC_DEVICE_COMMANDS_d0c25a41(X, X_RESULT) \
+	X(vkCmdSetSampleLocationsEnableEXT, (VkCommandBuffer commandBuffer, VkBool32 sampleLocationsEnable), (commandBuffer, sampleLocationsEnable))
+#else
+#define VILC_DEVICE_COMMANDS_d0c25a41(X, X_RESULT)
+#endif /* (defined(VK_EXT_extended_dynamic_state3) && defined(VK_EXT_sample_locations)) || (defined(VK_EXT_shader_object) && defined(VK_EXT_sample_locations)) */
+#if (defined(VK_EXT_extended_dynamic_state3) && defined(VK_EXT_blend_operation_advanced)) || (defined(VK_EXT_shader_object) && defined(VK_EXT_blend_operation_advanced))
+#define VILC_DEVICE_COMMANDS_fd717396(X, X_RESULT) \
+	X(vkCmdSetColorBlendAdvancedEXT, (VkCommandBuffer commandBuffer, uint32_t firstAttachment, uint32_t attachmentCount, const VkColorBlendAdvancedEXT* pColorBlendAdvanced), (commandBuffer, firstAttachment, attachmentCount, pColorBlendAdvanced))
+#else
+#define VILC_DEVICE_COMMANDS_fd717396(X, X_RESULT)
+#endif /* (defined(VK_EXT_extended_dynamic_state3) && defined(VK_EXT_blend_operation_advanced)) || (defined(VK_EXT_shader_object) && defined(VK_EXT_blend_operation_advanced)) */
+#if (defined(VK_EXT_extended_dynamic_state3) && defined(VK_EXT_provoking_vertex)) || (defined(VK_EXT_shader_object) && defined(VK_EXT_provoking_vertex))
+#define VILC_DEVICE_COMMANDS_39188869(X, X_RESULT) \
+	X(vkCmdSetProvokingVertexModeEXT, (VkCommandBuffer commandBuffer, VkProvokingVertexModeEXT provokingVertexMode), (commandBuffer, provokingVertexMode))
+#else
+#define VILC_DEVICE_COMMANDS_39188869(X, X_RESULT)
+#endif /* (defined(VK_EXT_extended_dynamic_state3) && defined(VK_EXT_provoking_vertex)) || (defined(VK_EXT_shader_object) && defined(VK_EXT_provoking_vertex)) */
+#if (defined(VK_EXT_extended_dynamic_state3) && defined(VK_EXT_line_rasterization)) || (defined(VK_EXT_shader_object) && defined(VK_EXT_line_rasterization))
+#define VILC_DEVICE_COMMANDS_85be1915(X, X_RESULT) \
+	X(vkCmdSetLineRasterizationModeEXT, (VkCommandBuffer commandBuffer, VkLineRasterizationModeEXT lineRasterizationMode), (commandBuffer, lineRasterizationMode)) \
+	X(vkCmdSetLineStippleEnableEXT, (VkCommandBuffer commandBuffer, VkBool32 stippledLineEnable), (commandBuffer, stippledLineEnable))
+#else
+#define VILC_DEVICE_COMMANDS_85be1915(X, X_RESULT)
+#endif /* (defined(VK_EXT_extended_dynamic_state3) && defined(VK_EXT_line_rasterization)) || (defined(VK_EXT_shader_object) && defined(VK_EXT_line_rasterization)) */
+#if (defined(VK_EXT_extended_dynamic_state3) && defined(VK_EXT_depth_clip_control)) || (defined(VK_EXT_shader_object) && defined(VK_EXT_depth_clip_control))
+#define VILC_DEVICE_COMMANDS_5bb00479(X, X_RESULT) \
+	X(vkCmdSetDepthClipNegativeOneToOneEXT, (VkCommandBuffer commandBuffer, VkBool32 negativeOneToOne), (commandBuffer, negativeOneToOne))
+#else
+#define VILC_DEVICE_COMMANDS_5bb00479(X, X_RESULT)
+#endif /* (defined(VK_EXT_extended_dynamic_state3) && defined(VK_EXT_depth_clip_control)) || (defined(VK_EXT_shader_object) && defined(VK_EXT_depth_clip_control)) */
+#if (defined(VK_EXT_extended_dynamic_state3) && defined(VK_NV_clip_space_w_scaling)) || (defined(VK_EXT_shader_object) && defined(VK_NV_clip_space_w_scaling))
+#define VILC_DEVICE_COMMANDS_c42a5eaa(X, X_RESULT) \
+	X(vkCmdSetViewportWScalingEnableNV, (VkCommandBuffer commandBuffer, VkBool32 viewportWScalingEnable), (commandBuffer, viewportWScalingEnable))
+#else
+#define VILC_DEVICE_COMMANDS_c42a5eaa(X, X_RESULT)
+#endif /* (defined(VK_EXT_extended_dynamic_state3) && defined(VK_NV_clip_space_w_scaling)) || (defined(VK_EXT_shader_object) && defined(VK_NV_clip_space_w_scaling)) */
+#if (defined(VK_EXT_extended_dynamic_state3) && defined(VK_NV_viewport_swizzle)) || (defined(VK_EXT_shader_object) && defined(VK_NV_viewport_swizzle))
+#define VILC_DEVICE_COMMANDS_4e0e9c04(X, X_RESULT) \
+	X(vkCmdSetViewportSwizzleNV, (VkCommandBuffer commandBuffer, uint32_t firstViewport, uint32_t viewportCount, const VkViewportSwizzleNV* pViewportSwizzles), (commandBuffer, firstViewport, viewportCount, pViewportSwizzles))
+#else
+#define VILC_DEVICE_COMMANDS_4e0e9c04(X, X_RESULT)
+#endif /* (defined(VK_EXT_extended_dynamic_state3) && defined(VK_NV_viewport_swizzle)) || (defined(VK_EXT_shader_object) && defined(VK_NV_viewport_swizzle)) */
+#if (defined(VK_EXT_extended_dynamic_state3) && defined(VK_NV_fragment_coverage_to_color)) || (defined(VK_EXT_shader_object) && defined(VK_NV_fragment_coverage_to_color))
+#define VILC_DEVICE_COMMANDS_1ae17d64(X, X_RESULT) \
+	X(vkCmdSetCoverageToColorEnableNV, (VkCommandBuffer commandBuffer, VkBool32 coverageToColorEnable), (commandBuffer, coverageToColorEnable)) \
+	X(vkCmdSetCoverageToColorLocationNV, (VkCommandBuffer commandBuffer, uint32_t coverageToColorLocation), (commandBuffer, coverageToColorLocation))
+#else
+#define VILC_DEVICE_COMMANDS_1ae17d64(X, X_RESULT)
+#endif /* (defined(VK_EXT_extended_dynamic_state3) && defined(VK_NV_fragment_coverage_to_color)) || (defined(VK_EXT_shader_object) && defined(VK_NV_fragment_coverage_to_color)) */
+#if (defined(VK_EXT_extended_dynamic_state3) && defined(VK_NV_framebuffer_mixed_samples)) || (defined(VK_EXT_shader_object) && defined(VK_NV_framebuffer_mixed_samples))
+#define VILC_DEVICE_COMMANDS_3ef6ea8c(X, X_RESULT) \
+	X(vkCmdSetCoverageModulationModeNV, (VkCommandBuffer commandBuffer, VkCoverageModulationModeNV coverageModulationMode), (commandBuffer, coverageModulationMode)) \
+	X(vkCmdSetCoverageModulationTableEnableNV, (VkCommandBuffer commandBuffer, VkBool32 coverageModulationTableEnable), (commandBuffer, coverageModulationTableEnable)) \
+	X(vkCmdSetCoverageModulationTableNV, (VkCommandBuffer commandBuffer, uint32_t coverageModulationTableCount, const float* pCoverageModulationTable), (commandBuffer, coverageModulationTableCount, pCoverageModulationTable))
+#else
+#define VILC_DEVICE_COMMANDS_3ef6ea8c(X, X_RESULT)
+#endif /* (defined(VK_EXT_extended_dynamic_state3) && defined(VK_NV_framebuffer_mixed_samples)) || (defined(VK_EXT_shader_object) && defined(VK_NV_framebuffer_mixed_samples)) */
+#if (defined(VK_EXT_extended_dynamic_state3) && defined(VK_NV_shading_rate_image)) || (defined(VK_EXT_shader_object) && defined(VK_NV_shading_rate_image))
+#define VILC_DEVICE_COMMANDS_3508ac1b(X, X_RESULT) \
+	X(vkCmdSetShadingRateImageEnableNV, (VkCommandBuffer commandBuffer, VkBool32 shadingRateImageEnable), (commandBuffer, shadingRateImageEnable))
+#else
+#define VILC_DEVICE_COMMANDS_3508ac1b(X, X_RESULT)
+#endif /* (defined(VK_EXT_extended_dynamic_state3) && defined(VK_NV_shading_rate_image)) || (defined(VK_EXT_shader_object) && defined(VK_NV_shading_rate_image)) */
+#if (defined(VK_EXT_extended_dynamic_state3) && defined(VK_NV_representative_fragment_test)) || (defined(VK_EXT_shader_object) && defined(VK_NV_representative_fragment_test))
+#define VILC_DEVICE_COMMANDS_ccc1dc6b(X, X_RESULT) \
+	X(vkCmdSetRepresentativeFragmentTestEnableNV, (VkCommandBuffer commandBuffer, VkBool32 representativeFragmentTestEnable), (commandBuffer, representativeFragmentTestEnable))
+#else
+#define VILC_DEVICE_COMMANDS_ccc1dc6b(X, X_RESULT)
+#endif /* (defined(VK_EXT_extended_dynamic_state3) && defined(VK_NV_representative_fragment_test)) || (defined(VK_EXT_shader_object) && defined(VK_NV_representative_fragment_test)) */
+#if (defined(VK_EXT_extended_dynamic_state3) && defined(VK_NV_coverage_reduction_mode)) || (defined(VK_EXT_shader_object) && defined(VK_NV_coverage_reduction_mode))
+#define VILC_DEVICE_COMMANDS_33d1c96a(X, X_RESULT) \
+	X(vkCmdSetCoverageReductionModeNV, (VkCommandBuffer commandBuffer, VkCoverageReductionModeNV coverageReductionMode), (commandBuffer, coverageReductionMode))
+#else
+#define VILC_DEVICE_COMMANDS_33d1c96a(X, X_RESULT)
+#endif /* (defined(VK_EXT_extended_dynamic_state3) && defined(VK_NV_coverage_reduction_mode)) || (defined(VK_EXT_shader_object) && defined(VK_NV_coverage_reduction_mode)) */
+#if (defined(VK_EXT_shader_object)) || (defined(VK_EXT_vertex_input_dynamic_state))
+#define VILC_DEVICE_COMMANDS_ac3e866d(X, X_RESULT) \
+	X(vkCmdSetVertexInputEXT, (VkCommandBuffer commandBuffer, uint32_t vertexBindingDescriptionCount, const VkVertexInputBindingDescription2EXT* pVertexBindingDescriptions, uint32_t vertexAttributeDescriptionCount, const VkVertexInputAttributeDescription2EXT* pVertexAttributeDescriptions), (commandBuffer, vertexBindingDescriptionCount, pVertexBindingDescriptions, vertexAttributeDescriptionCount, pVertexAttributeDescriptions))
+#else
+#define VILC_DEVICE_COMMANDS_ac3e866d(X, X_RESULT)
+#endif /* (defined(VK_EXT_shader_object)) || (defined(VK_EXT_vertex_input_dynamic_state)) */
+#if (defined(VK_KHR_descriptor_update_template) && defined(VK_KHR_push_descriptor)) || (defined(VK_KHR_push_descriptor) && (defined(VK_VERSION_1_1) || defined(VK_KHR_descriptor_update_template)))
+#define VILC_DEVICE_COMMANDS_ce013d6d(X, X_RESULT) \
+	X(vkCmdPushDescriptorSetWithTemplateKHR, (VkCommandBuffer commandBuffer, VkDescriptorUpdateTemplate descriptorUpdateTemplate, VkPipelineLayout layout, uint32_t set, const void* pData), (commandBuffer, descriptorUpdateTemplate, layout, set, pData))
+#else
+#define VILC_DEVICE_COMMANDS_ce013d6d(X, X_RESULT)
+#endif /* (defined(VK_KHR_descriptor_update_template) && defined(VK_KHR_push_descriptor)) || (defined(VK_KHR_push_descriptor) && (defined(VK_VERSION_1_1) || defined(VK_KHR_descriptor_update_template))) */
+#define VILC_DEVICE_COMMANDS(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_115adfca(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_841ee8b(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_236cbd48(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_3a778c09(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_75361ace(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_8b2eda6d(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_5f0a909d(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_35d1ef70(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_f897f174(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_6796b198(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_680d7529(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_f2adc574(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_8a74c2e(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_674622f1(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_7f75bbcb(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_86953ad0(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_27e9bbf6(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_a33890e9(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_8f2e5639(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_80e2693c(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_7d35fc6f(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_f04f221e(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_3ca78d3c(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_3b654e1(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_c9e6a28e(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_58c3e9cd(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_242c2a41(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_1343bf61(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_1ad4d091(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_868b54c7(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_29cf2c8a(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_6d94e656(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_bac71944(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_7da16759(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_c07849ca(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_6d320690(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_e6199a9e(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_3b35756f(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_3c2407aa(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_21e7e17f(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_b3885a43(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_4981896c(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_904d87b5(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_4bf8c3d9(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_8e1ef3e7(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_8d13c4ac(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_14a444d4(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_3f891717(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_ca97394(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_63c2604b(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_4fad6a7e(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_4ea9cf7f(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_bc0c4a55(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_47b17602(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_996c4c6d(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_356831e6(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_8b190428(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_351a1ef8(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_9d93d733(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_ff3d3c5b(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_5325d69f(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_234482fc(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_a603ea43(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_a292d39b(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_e75168a3(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_1c25b7f5(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_393ed979(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_ceb65124(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_7d885f36(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_e16248ab(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_66c32070(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_440badfa(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_7881c5df(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_6d6f7e69(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_5d59a7ec(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_b1c79bf(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_978c3b4e(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_262585f9(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_bd5e9f68(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_b9d827de(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_cd124ed7(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_409ab335(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_4458a8ed(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_728cccc(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_bc56398b(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_8b7fdb3e(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_d0c25a41(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_fd717396(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_39188869(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_85be1915(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_5bb00479(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_c42a5eaa(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_4e0e9c04(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_1ae17d64(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_3ef6ea8c(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_3508ac1b(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_ccc1dc6b(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_33d1c96a(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_ac3e866d(X, X_RESULT) \
+	VILC_DEVICE_COMMANDS_ce013d6d(X, X_RESULT)
+/* VOLK_GENERATE_COMMANDS_C_VILC */
+#endif
+
+#if defined(VOLK_IN_LOADERS_CLOTH) && defined(VILC_CHARACTERIZE)
+/* Workload characterization: log2 histograms of the arguments of hot vkCmd* calls.
+ * Two frame slots are flipped at every vkQueuePresentKHR so memory use is constant no matter how long the run is.
+ * A thread records into a slot only while it is counted as a writer of the slot that is still current, and a flip
+ * waits for the writers of the old slot before reading it, so a record that races a flip is read whole in one frame.
+ * The slot flipped in is cleared first, as it has no writers once the frame it was read in is over.
+ */
+static VilcWorkloadStats vilc_characterize_frames[2];
+static VilcWorkloadStats vilc_characterize_lastFrame;
+static VilcWorkloadStats vilc_characterize_run;
+static uint32_t vilc_characterize_slot = 0;
+static uint32_t vilc_characterize_writers[2];
+static int vilc_characterize_reportEvery = 0;
+static pthread_mutex_t vilc_characterize_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void vilc_characterize_record(VilcWorkloadMetric metric, uint64_t value)
+{
+	uint32_t slot = VILC_ATOMIC_LOAD_SEQ_CST(&vilc_characterize_slot);
+
+	for (;;)
+	{
+		uint32_t current;
+
+		VILC_ATOMIC_ADD_SEQ_CST(&vilc_characterize_writers[slot], 1);
+		current = VILC_ATOMIC_LOAD_SEQ_CST(&vilc_characterize_slot);
+		if (current == slot)
+			break;
+		/* flipped since the slot was loaded: the flip may already be reading it */
+		VILC_ATOMIC_SUB_ACQ_REL(&vilc_characterize_writers[slot], 1);
+		slot = current;
+	}
+	vilc_histogramRecord(&vilc_characterize_frames[slot].metrics[metric], value);
+	VILC_ATOMIC_SUB_ACQ_REL(&vilc_characterize_writers[slot], 1);
+}
+
+/* Copies the histogram of a slot flipped out, keeping min stored as ~min */
+static void vilc_characterize_load(VilcHistogram* target, const VilcHistogram* source)
+{
+	uint32_t i;
+
+	target->count = VILC_ATOMIC_LOAD(&source->count);
+	target->sum = VILC_ATOMIC_LOAD(&source->sum);
+	target->min = VILC_ATOMIC_LOAD(&source->min);
+	target->max = VILC_ATOMIC_LOAD(&source->max);
+	for (i = 0; i < VILC_HISTOGRAM_BUCKET_COUNT; ++i)
+		target->buckets[i] = VILC_ATOMIC_LOAD(&source->buckets[i]);
+}
+
+static void vilc_characterize_clear(VilcHistogram* histogram)
+{
+	uint32_t i;
+
+	VILC_ATOMIC_STORE(&histogram->count, 0);
+	VILC_ATOMIC_STORE(&histogram->sum, 0);
+	VILC_ATOMIC_STORE(&histogram->min, 0);
+	VILC_ATOMIC_STORE(&histogram->max, 0);
+	for (i = 0; i < VILC_HISTOGRAM_BUCKET_COUNT; ++i)
+		VILC_ATOMIC_STORE(&histogram->buckets[i], 0);
+}
+
+static void vilc_characterize_merge(VilcHistogram* target, const VilcHistogram* source)
+{
+	uint32_t i;
+
+	if (!source->count)
+		return;
+
+	target->count += source->count;
+	target->sum += source->sum;
+	target->min = target->min > source->min ? target->min : source->min;
+	target->max = target->max > source->max ? target->max : source->max;
+	for (i = 0; i < VILC_HISTOGRAM_BUCKET_COUNT; ++i)
+		target->buckets[i] += source->buckets[i];
+}
+
+static void vilc_characterize_print(const char* title, const VilcWorkloadStats* stats)
+{
+	static const char* names[VILC_WORKLOAD_METRIC_COUNT] = {
+		"draw vertexCount",
+		"draw indexCount",
+		"draw instanceCount",
+		"draw indirect drawCount",
+		"dispatch groups",
+		"copy buffer bytes",
+		"update buffer bytes",
+		"barriers per call",
+	};
+	uint32_t i;
+
+	fprintf(stderr, "vilc: %s (frames: %llu)\n", title, (unsigned long long)stats->frameCount);
+	for (i = 0; i < VILC_WORKLOAD_METRIC_COUNT; ++i)
+		if (stats->metrics[i].count)
+			vilc_histogramPrint(names[i], &stats->metrics[i]);
+}
+
+static void vilc_characterize_endFrame(void)
+{
+	uint32_t slot, i;
+
+	int report;
+
+	pthread_mutex_lock(&vilc_characterize_mutex);
+
+	slot = VILC_ATOMIC_LOAD(&vilc_characterize_slot);
+	for (i = 0; i < VILC_WORKLOAD_METRIC_COUNT; ++i)
+		vilc_characterize_clear(&vilc_characterize_frames[slot ^ 1].metrics[i]);
+	VILC_ATOMIC_STORE_SEQ_CST(&vilc_characterize_slot, slot ^ 1);
+	while (VILC_ATOMIC_LOAD_SEQ_CST(&vilc_characterize_writers[slot]))
+		sched_yield();
+
+	for (i = 0; i < VILC_WORKLOAD_METRIC_COUNT; ++i)
+	{
+		vilc_characterize_load(&vilc_characterize_lastFrame.metrics[i], &vilc_characterize_frames[slot].metrics[i]);
+		vilc_characterize_merge(&vilc_characterize_run.metrics[i], &vilc_characterize_lastFrame.metrics[i]);
+	}
+	vilc_characterize_lastFrame.frameCount = 1;
+	vilc_characterize_run.frameCount++;
+	report = vilc_characterize_reportEvery > 0 && vilc_characterize_run.frameCount % (uint64_t)vilc_characterize_reportEvery == 0;
+
+	pthread_mutex_unlock(&vilc_characterize_mutex);
+
+	if (report)
+	{
+		VilcWorkloadStats lastFrame;
+		vilcGetWorkloadStats(&lastFrame, NULL);
+		vilc_characterize_print("frame workload", &lastFrame);
+	}
+}
+
+static void vilc_characterize_export(VilcWorkloadStats* target, const VilcWorkloadStats* source)
+{
+	uint32_t i;
+
+	target->frameCount = source->frameCount;
+	for (i = 0; i < VILC_WORKLOAD_METRIC_COUNT; ++i)
+		vilc_histogramExport(&target->metrics[i], &source->metrics[i]);
+}
+
+void vilcGetWorkloadStats(VilcWorkloadStats* lastFrame, VilcWorkloadStats* run)
+{
+	pthread_mutex_lock(&vilc_characterize_mutex);
+	if (lastFrame)
+		vilc_characterize_export(lastFrame, &vilc_characterize_lastFrame);
+	if (run)
+		vilc_characterize_export(run, &vilc_characterize_run);
+	pthread_mutex_unlock(&vilc_characterize_mutex);
+}
+
+VILC_LAYER_NEXT(vilc_characterize, vkCmdDraw)
+VILC_LAYER_NEXT(vilc_characterize, vkCmdDrawIndexed)
+VILC_LAYER_NEXT(vilc_characterize, vkCmdDrawIndirect)
+VILC_LAYER_NEXT(vilc_characterize, vkCmdDrawIndexedIndirect)
+VILC_LAYER_NEXT(vilc_characterize, vkCmdDispatch)
+VILC_LAYER_NEXT(vilc_characterize, vkCmdCopyBuffer)
+VILC_LAYER_NEXT(vilc_characterize, vkCmdUpdateBuffer)
+VILC_LAYER_NEXT(vilc_characterize, vkCmdPipelineBarrier)
+VILC_LAYER_NEXT(vilc_characterize, vkDestroyDevice)
+
+static VKAPI_ATTR void VKAPI_CALL vilc_characterize_vkCmdDraw(VkCommandBuffer commandBuffer, uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance)
+{
+	vilc_characterize_record(VILC_WORKLOAD_DRAW_VERTEX_COUNT, vertexCount);
+	vilc_characterize_record(VILC_WORKLOAD_DRAW_INSTANCE_COUNT, instanceCount);
+	vilc_characterize_next_vkCmdDraw(commandBuffer, vertexCount, instanceCount, firstVertex, firstInstance);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_characterize_vkCmdDrawIndexed(VkCommandBuffer commandBuffer, uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance)
+{
+	vilc_characterize_record(VILC_WORKLOAD_DRAW_INDEX_COUNT, indexCount);
+	vilc_characterize_record(VILC_WORKLOAD_DRAW_INSTANCE_COUNT, instanceCount);
+	vilc_characterize_next_vkCmdDrawIndexed(commandBuffer, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_characterize_vkCmdDrawIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride)
+{
+	vilc_characterize_record(VILC_WORKLOAD_DRAW_INDIRECT_COUNT, drawCount);
+	vilc_characterize_next_vkCmdDrawIndirect(commandBuffer, buffer, offset, drawCount, stride);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_characterize_vkCmdDrawIndexedIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride)
+{
+	vilc_characterize_record(VILC_WORKLOAD_DRAW_INDIRECT_COUNT, drawCount);
+	vilc_characterize_next_vkCmdDrawIndexedIndirect(commandBuffer, buffer, offset, drawCount, stride);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_characterize_vkCmdDispatch(VkCommandBuffer commandBuffer, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+{
+	vilc_characterize_record(VILC_WORKLOAD_DISPATCH_GROUP_COUNT, (uint64_t)groupCountX * groupCountY * groupCountZ);
+	vilc_characterize_next_vkCmdDispatch(commandBuffer, groupCountX, groupCountY, groupCountZ);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_characterize_vkCmdCopyBuffer(VkCommandBuffer commandBuffer, VkBuffer srcBuffer, VkBuffer dstBuffer, uint32_t regionCount, const VkBufferCopy* pRegions)
+{
+	uint32_t i;
+	for (i = 0; i < regionCount; ++i)
+		vilc_characterize_record(VILC_WORKLOAD_COPY_BUFFER_BYTES, pRegions[i].size);
+	vilc_characterize_next_vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, regionCount, pRegions);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_characterize_vkCmdUpdateBuffer(VkCommandBuffer commandBuffer, VkBuffer dstBuffer, VkDeviceSize dstOffset, VkDeviceSize dataSize, const void* pData)
+{
+	vilc_characterize_record(VILC_WORKLOAD_UPDATE_BUFFER_BYTES, dataSize);
+	vilc_characterize_next_vkCmdUpdateBuffer(commandBuffer, dstBuffer, dstOffset, dataSize, pData);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_characterize_vkCmdPipelineBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask, VkDependencyFlags dependencyFlags, uint32_t memoryBarrierCount, const VkMemoryBarrier* pMemoryBarriers, uint32_t bufferMemoryBarrierCount, const VkBufferMemoryBarrier* pBufferMemoryBarriers, uint32_t imageMemoryBarrierCount, const VkImageMemoryBarrier* pImageMemoryBarriers)
+{
+	vilc_characterize_record(VILC_WORKLOAD_BARRIER_COUNT, (uint64_t)memoryBarrierCount + bufferMemoryBarrierCount + imageMemoryBarrierCount);
+	vilc_characterize_next_vkCmdPipelineBarrier(commandBuffer, srcStageMask, dstStageMask, dependencyFlags, memoryBarrierCount, pMemoryBarriers, bufferMemoryBarrierCount, pBufferMemoryBarriers, imageMemoryBarrierCount, pImageMemoryBarriers);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_characterize_vkDestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator)
+{
+	VilcWorkloadStats run;
+	vilcGetWorkloadStats(NULL, &run);
+	vilc_characterize_print("run workload", &run);
+	vilc_characterize_next_vkDestroyDevice(device, pAllocator);
+}
+
+#if defined(VK_VERSION_1_2)
+VILC_LAYER_NEXT(vilc_characterize, vkCmdDrawIndirectCount)
+VILC_LAYER_NEXT(vilc_characterize, vkCmdDrawIndexedIndirectCount)
+
+static VKAPI_ATTR void VKAPI_CALL vilc_characterize_vkCmdDrawIndirectCount(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkBuffer countBuffer, VkDeviceSize countBufferOffset, uint32_t maxDrawCount, uint32_t stride)
+{
+	vilc_characterize_record(VILC_WORKLOAD_DRAW_INDIRECT_COUNT, maxDrawCount);
+	vilc_characterize_next_vkCmdDrawIndirectCount(commandBuffer, buffer, offset, countBuffer, countBufferOffset, maxDrawCount, stride);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_characterize_vkCmdDrawIndexedIndirectCount(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkBuffer countBuffer, VkDeviceSize countBufferOffset, uint32_t maxDrawCount, uint32_t stride)
+{
+	vilc_characterize_record(VILC_WORKLOAD_DRAW_INDIRECT_COUNT, maxDrawCount);
+	vilc_characterize_next_vkCmdDrawIndexedIndirectCount(commandBuffer, buffer, offset, countBuffer, countBufferOffset, maxDrawCount, stride);
+}
+#endif /* defined(VK_VERSION_1_2) */
+
+#if defined(VK_VERSION_1_1)
+VILC_LAYER_NEXT(vilc_characterize, vkCmdDispatchBase)
+
+static VKAPI_ATTR void VKAPI_CALL vilc_characterize_vkCmdDispatchBase(VkCommandBuffer commandBuffer, uint32_t baseGroupX, uint32_t baseGroupY, uint32_t baseGroupZ, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+{
+	vilc_characterize_record(VILC_WORKLOAD_DISPATCH_GROUP_COUNT, (uint64_t)groupCountX * groupCountY * groupCountZ);
+	vilc_characterize_next_vkCmdDispatchBase(commandBuffer, baseGroupX, baseGroupY, baseGroupZ, groupCountX, groupCountY, groupCountZ);
+}
+#endif /* defined(VK_VERSION_1_1) */
+
+#if defined(VK_KHR_draw_indirect_count)
+VILC_LAYER_NEXT(vilc_characterize, vkCmdDrawIndirectCountKHR)
+VILC_LAYER_NEXT(vilc_characterize, vkCmdDrawIndexedIndirectCountKHR)
+
+static VKAPI_ATTR void VKAPI_CALL vilc_characterize_vkCmdDrawIndirectCountKHR(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkBuffer countBuffer, VkDeviceSize countBufferOffset, uint32_t maxDrawCount, uint32_t stride)
+{
+	vilc_characterize_record(VILC_WORKLOAD_DRAW_INDIRECT_COUNT, maxDrawCount);
+	vilc_characterize_next_vkCmdDrawIndirectCountKHR(commandBuffer, buffer, offset, countBuffer, countBufferOffset, maxDrawCount, stride);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_characterize_vkCmdDrawIndexedIndirectCountKHR(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkBuffer countBuffer, VkDeviceSize countBufferOffset, uint32_t maxDrawCount, uint32_t stride)
+{
+	vilc_characterize_record(VILC_WORKLOAD_DRAW_INDIRECT_COUNT, maxDrawCount);
+	vilc_characterize_next_vkCmdDrawIndexedIndirectCountKHR(commandBuffer, buffer, offset, countBuffer, countBufferOffset, maxDrawCount, stride);
+}
+#endif /* defined(VK_KHR_draw_indirect_count) */
+
+#if defined(VK_KHR_device_group)
+VILC_LAYER_NEXT(vilc_characterize, vkCmdDispatchBaseKHR)
+
+static VKAPI_ATTR void VKAPI_CALL vilc_characterize_vkCmdDispatchBaseKHR(VkCommandBuffer commandBuffer, uint32_t baseGroupX, uint32_t baseGroupY, uint32_t baseGroupZ, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+{
+	vilc_characterize_record(VILC_WORKLOAD_DISPATCH_GROUP_COUNT, (uint64_t)groupCountX * groupCountY * groupCountZ);
+	vilc_characterize_next_vkCmdDispatchBaseKHR(commandBuffer, baseGroupX, baseGroupY, baseGroupZ, groupCountX, groupCountY, groupCountZ);
+}
+#endif /* defined(VK_KHR_device_group) */
+
+#if defined(VK_VERSION_1_3)
+VILC_LAYER_NEXT(vilc_characterize, vkCmdCopyBuffer2)
+VILC_LAYER_NEXT(vilc_characterize, vkCmdPipelineBarrier2)
+
+static VKAPI_ATTR void VKAPI_CALL vilc_characterize_vkCmdCopyBuffer2(VkCommandBuffer commandBuffer, const VkCopyBufferInfo2* pCopyBufferInfo)
+{
+	uint32_t i;
+	for (i = 0; i < pCopyBufferInfo->regionCount; ++i)
+		vilc_characterize_record(VILC_WORKLOAD_COPY_BUFFER_BYTES, pCopyBufferInfo->pRegions[i].size);
+	vilc_characterize_next_vkCmdCopyBuffer2(commandBuffer, pCopyBufferInfo);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_characterize_vkCmdPipelineBarrier2(VkCommandBuffer commandBuffer, const VkDependencyInfo* pDependencyInfo)
+{
+	vilc_characterize_record(VILC_WORKLOAD_BARRIER_COUNT, (uint64_t)pDependencyInfo->memoryBarrierCount + pDependencyInfo->bufferMemoryBarrierCount + pDependencyInfo->imageMemoryBarrierCount);
+	vilc_characterize_next_vkCmdPipelineBarrier2(commandBuffer, pDependencyInfo);
+}
+#endif /* defined(VK_VERSION_1_3) */
+
+#if defined(VK_KHR_copy_commands2)
+VILC_LAYER_NEXT(vilc_characterize, vkCmdCopyBuffer2KHR)
+
+static VKAPI_ATTR void VKAPI_CALL vilc_characterize_vkCmdCopyBuffer2KHR(VkCommandBuffer commandBuffer, const VkCopyBufferInfo2KHR* pCopyBufferInfo)
+{
+	uint32_t i;
+	for (i = 0; i < pCopyBufferInfo->regionCount; ++i)
+		vilc_characterize_record(VILC_WORKLOAD_COPY_BUFFER_BYTES, pCopyBufferInfo->pRegions[i].size);
+	vilc_characterize_next_vkCmdCopyBuffer2KHR(commandBuffer, pCopyBufferInfo);
+}
+#endif /* defined(VK_KHR_copy_commands2) */
+
+#if defined(VK_KHR_synchronization2)
+VILC_LAYER_NEXT(vilc_characterize, vkCmdPipelineBarrier2KHR)
+
+static VKAPI_ATTR void VKAPI_CALL vilc_characterize_vkCmdPipelineBarrier2KHR(VkCommandBuffer commandBuffer, const VkDependencyInfoKHR* pDependencyInfo)
+{
+	vilc_characterize_record(VILC_WORKLOAD_BARRIER_COUNT, (uint64_t)pDependencyInfo->memoryBarrierCount + pDependencyInfo->bufferMemoryBarrierCount + pDependencyInfo->imageMemoryBarrierCount);
+	vilc_characterize_next_vkCmdPipelineBarrier2KHR(commandBuffer, pDependencyInfo);
+}
+#endif /* defined(VK_KHR_synchronization2) */
+
+#if defined(VK_KHR_swapchain)
+VILC_LAYER_NEXT(vilc_characterize, vkQueuePresentKHR)
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_characterize_vkQueuePresentKHR(VkQueue queue, const VkPresentInfoKHR* pPresentInfo)
+{
+	vilc_characterize_endFrame();
+	return vilc_characterize_next_vkQueuePresentKHR(queue, pPresentInfo);
+}
+#endif /* defined(VK_KHR_swapchain) */
+
+static void vilc_characterize_install(void)
+{
+	const char* reportEvery = getenv("VILC_CHARACTERIZE_REPORT_EVERY");
+	vilc_characterize_reportEvery = reportEvery ? atoi(reportEvery) : 0;
+
+	VILC_LAYER_HOOK(vilc_characterize, vkCmdDraw)
+	VILC_LAYER_HOOK(vilc_characterize, vkCmdDrawIndexed)
+	VILC_LAYER_HOOK(vilc_characterize, vkCmdDrawIndirect)
+	VILC_LAYER_HOOK(vilc_characterize, vkCmdDrawIndexedIndirect)
+	VILC_LAYER_HOOK(vilc_characterize, vkCmdDispatch)
+	VILC_LAYER_HOOK(vilc_characterize, vkCmdCopyBuffer)
+	VILC_LAYER_HOOK(vilc_characterize, vkCmdUpdateBuffer)
+	VILC_LAYER_HOOK(vilc_characterize, vkCmdPipelineBarrier)
+	VILC_LAYER_HOOK(vilc_characterize, vkDestroyDevice)
+#if defined(VK_VERSION_1_1)
+	VILC_LAYER_HOOK(vilc_characterize, vkCmdDispatchBase)
+#endif
+#if defined(VK_VERSION_1_2)
+	VILC_LAYER_HOOK(vilc_characterize, vkCmdDrawIndirectCount)
+	VILC_LAYER_HOOK(vilc_characterize, vkCmdDrawIndexedIndirectCount)
+#endif
+#if defined(VK_KHR_draw_indirect_count)
+	VILC_LAYER_HOOK(vilc_characterize, vkCmdDrawIndirectCountKHR)
+	VILC_LAYER_HOOK(vilc_characterize, vkCmdDrawIndexedIndirectCountKHR)
+#endif
+#if defined(VK_KHR_device_group)
+	VILC_LAYER_HOOK(vilc_characterize, vkCmdDispatchBaseKHR)
+#endif
+#if defined(VK_VERSION_1_3)
+	VILC_LAYER_HOOK(vilc_characterize, vkCmdCopyBuffer2)
+	VILC_LAYER_HOOK(vilc_characterize, vkCmdPipelineBarrier2)
+#endif
+#if defined(VK_KHR_copy_commands2)
+	VILC_LAYER_HOOK(vilc_characterize, vkCmdCopyBuffer2KHR)
+#endif
+#if defined(VK_KHR_synchronization2)
+	VILC_LAYER_HOOK(vilc_characterize, vkCmdPipelineBarrier2KHR)
+#endif
+#if defined(VK_KHR_swapchain)
+	VILC_LAYER_HOOK(vilc_characterize, vkQueuePresentKHR)
+#endif
+}
+#endif /* VILC_CHARACTERIZE */
+
+#if defined(VOLK_IN_LOADERS_CLOTH) && defined(VILC_PERF_LINT)
+/* Performance lint: flags costly call patterns as they happen.
+ * Each lint keeps an occurrence count and the call stack of its first occurrence; per-object state lives in
+ * small direct-mapped tables so the checks stay constant-time and allocation-free. Objects of different threads
+ * can share a table entry, so every entry has a spin lock that is only held to update it.
+ */
+#ifndef VILC_PERF_LINT_SMALL_ALLOCATION_SIZE
+#define VILC_PERF_LINT_SMALL_ALLOCATION_SIZE (256 * 1024)
+#endif
+
+#define VILC_PERF_LINT_MAP_STREAK 3
+#define VILC_PERF_LINT_TABLE_SIZE 1024
+
+typedef struct VilcPerfLintMapping
+{
+	uint32_t lock;
+	VkDeviceMemory memory;
+	uint64_t lastFrame;
+	uint32_t streak;
+} VilcPerfLintMapping;
+
+typedef struct VilcPerfLintBindings
+{
+	uint32_t lock;
+	VkCommandBuffer commandBuffer;
+	VkPipeline pipelines[2];
+	VkBuffer indexBuffer;
+	VkDeviceSize indexOffset;
+	VkIndexType indexType;
+} VilcPerfLintBindings;
+
+static VilcPerfLintEntry vilc_perfLint_entries[VILC_PERF_LINT_COUNT];
+/* Set once firstFrame and the stack of the entry are written */
+static uint32_t vilc_perfLint_published[VILC_PERF_LINT_COUNT];
+static VilcPerfLintMapping vilc_perfLint_mappings[VILC_PERF_LINT_TABLE_SIZE];
+static VilcPerfLintBindings vilc_perfLint_bindings[VILC_PERF_LINT_TABLE_SIZE];
+static uint64_t vilc_perfLint_frame = 0;
+static uint64_t vilc_perfLint_submitFrame = 0;
+static uint32_t vilc_perfLint_singleSubmits = 0;
+
+static uint32_t vilc_perfLint_slot(uint64_t key)
+{
+	return (uint32_t)((key * 0x9E3779B97F4A7C15ull) >> 54) & (VILC_PERF_LINT_TABLE_SIZE - 1);
+}
+
+static void vilc_perfLint_lock(uint32_t* lock)
+{
+	uint32_t expected = 0;
+	while (!VILC_ATOMIC_CAS_ACQUIRE(lock, &expected, 1))
+		expected = 0;
+}
+
+static void vilc_perfLint_unlock(uint32_t* lock)
+{
+	VILC_ATOMIC_STORE_RELEASE(lock, 0);
+}
+
+/* Only the first occurrence writes firstFrame and the stack, and publishes them for readers */
+static void vilc_perfLint_report(VilcPerfLint lint)
+{
+	VilcPerfLintEntry* entry = &vilc_perfLint_entries[lint];
+
+	if (VILC_ATOMIC_ADD(&entry->count, 1) != 1)
+		return;
+
+	entry->firstFrame = VILC_ATOMIC_LOAD(&vilc_perfLint_frame);
+#if defined(VILC_PERF_LINT_BACKTRACE)
+	entry->stackDepth = (uint32_t)backtrace(entry->stack, VILC_PERF_LINT_STACK_DEPTH);
+#else
+	entry->stack[0] = __builtin_return_address(0);
+	entry->stackDepth = 1;
+#endif
+	VILC_ATOMIC_STORE_RELEASE(&vilc_perfLint_published[lint], 1);
+}
+
+/* An occurrence whose stack is still being written is reported without it */
+static void vilc_perfLint_load(VilcPerfLintEntry* target, uint32_t lint)
+{
+	memset(target, 0, sizeof(*target));
+	if (VILC_ATOMIC_LOAD_ACQUIRE(&vilc_perfLint_published[lint]))
+		*target = vilc_perfLint_entries[lint];
+	target->count = VILC_ATOMIC_LOAD(&vilc_perfLint_entries[lint].count);
+}
+
+void vilcGetPerfLintReport(VilcPerfLintEntry entries[VILC_PERF_LINT_COUNT])
+{
+	uint32_t i;
+	for (i = 0; i < VILC_PERF_LINT_COUNT; ++i)
+		vilc_perfLint_load(&entries[i], i);
+}
+
+static void vilc_perfLint_print(void)
+{
+	static const char* descriptions[VILC_PERF_LINT_COUNT] = {
+		"vkMapMemory of the same memory in consecutive frames; keep host-visible memory persistently mapped",
+		"vkAllocateMemory below VILC_PERF_LINT_SMALL_ALLOCATION_SIZE; suballocate from larger blocks",
+		"vkCreateShaderModule after the first present; create shader modules at load time",
+		"vkCreate*Pipelines after the first present; create pipelines at load time or in the background",
+		"bind of the pipeline or index buffer that is already bound in the command buffer",
+		"several vkQueueSubmit calls with a single command buffer in one frame; batch them into one submit",
+		"vkQueueWaitIdle/vkDeviceWaitIdle after the first present; wait on fences instead",
+	};
+	uint32_t i;
+
+	for (i = 0; i < VILC_PERF_LINT_COUNT; ++i)
+	{
+		VilcPerfLintEntry entry;
+		vilc_perfLint_load(&entry, i);
+		if (!entry.count)
+			continue;
+
+		fprintf(stderr, "vilc: perf lint: %s (count: %llu, first in frame %llu)\n", descriptions[i], (unsigned long long)entry.count, (unsigned long long)entry.firstFrame);
+#if defined(VILC_PERF_LINT_BACKTRACE)
+		backtrace_symbols_fd(entry.stack, (int)entry.stackDepth, 2);
+#else
+		if (entry.stackDepth)
+			fprintf(stderr, "vilc:   called from %p\n", entry.stack[0]);
+#endif
+	}
+}
+
+static void vilc_perfLint_map(VkDeviceMemory memory)
+{
+	VilcPerfLintMapping* mapping = &vilc_perfLint_mappings[vilc_perfLint_slot(VILC_OBJECT_KEY(memory))];
+	uint64_t frame = VILC_ATOMIC_LOAD(&vilc_perfLint_frame);
+	uint32_t streak;
+
+	vilc_perfLint_lock(&mapping->lock);
+	if (mapping->memory != memory)
+	{
+		mapping->memory = memory;
+		mapping->streak = 1;
+	}
+	else if (mapping->lastFrame + 1 == frame)
+		mapping->streak++;
+	else if (mapping->lastFrame != frame)
+		mapping->streak = 1;
+	mapping->lastFrame = frame;
+	streak = mapping->streak;
+	vilc_perfLint_unlock(&mapping->lock);
+
+	if (streak >= VILC_PERF_LINT_MAP_STREAK)
+		vilc_perfLint_report(VILC_PERF_LINT_MAP_EVERY_FRAME);
+}
+
+static void vilc_perfLint_submit(uint32_t commandBufferCount)
+{
+	uint64_t frame = VILC_ATOMIC_LOAD(&vilc_perfLint_frame);
+
+	if (commandBufferCount != 1)
+		return;
+
+	if (VILC_ATOMIC_LOAD(&vilc_perfLint_submitFrame) != frame)
+	{
+		VILC_ATOMIC_STORE(&vilc_perfLint_submitFrame, frame);
+		VILC_ATOMIC_STORE(&vilc_perfLint_singleSubmits, 0);
+	}
+
+	if (VILC_ATOMIC_ADD(&vilc_perfLint_singleSubmits, 1) > 1)
+		vilc_perfLint_report(VILC_PERF_LINT_SUBMIT_PER_COMMAND_BUFFER);
+}
+
+static void vilc_perfLint_resetBindings(VilcPerfLintBindings* bindings)
+{
+	memset(bindings->pipelines, 0, sizeof(bindings->pipelines));
+	bindings->indexBuffer = VK_NULL_HANDLE;
+	bindings->indexOffset = 0;
+	bindings->indexType = (VkIndexType)0;
+}
+
+/* Returns the locked entry of the command buffer; release it with vilc_perfLint_unlock */
+static VilcPerfLintBindings* vilc_perfLint_bindingsOf(VkCommandBuffer commandBuffer)
+{
+	VilcPerfLintBindings* bindings = &vilc_perfLint_bindings[vilc_perfLint_slot(VILC_DISPATCHABLE_KEY(commandBuffer))];
+
+	vilc_perfLint_lock(&bindings->lock);
+	if (bindings->commandBuffer != commandBuffer)
+	{
+		vilc_perfLint_resetBindings(bindings);
+		bindings->commandBuffer = commandBuffer;
+	}
+
+	return bindings;
+}
+
+VILC_LAYER_NEXT(vilc_perfLint, vkMapMemory)
+VILC_LAYER_NEXT(vilc_perfLint, vkAllocateMemory)
+VILC_LAYER_NEXT(vilc_perfLint, vkCreateShaderModule)
+VILC_LAYER_NEXT(vilc_perfLint, vkCreateGraphicsPipelines)
+VILC_LAYER_NEXT(vilc_perfLint, vkCreateComputePipelines)
+VILC_LAYER_NEXT(vilc_perfLint, vkBeginCommandBuffer)
+VILC_LAYER_NEXT(vilc_perfLint, vkCmdBindPipeline)
+VILC_LAYER_NEXT(vilc_perfLint, vkCmdBindIndexBuffer)
+VILC_LAYER_NEXT(vilc_perfLint, vkQueueSubmit)
+VILC_LAYER_NEXT(vilc_perfLint, vkQueueWaitIdle)
+VILC_LAYER_NEXT(vilc_perfLint, vkDeviceWaitIdle)
+VILC_LAYER_NEXT(vilc_perfLint, vkDestroyDevice)
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_perfLint_vkMapMemory(VkDevice device, VkDeviceMemory memory, VkDeviceSize offset, VkDeviceSize size, VkMemoryMapFlags flags, void** ppData)
+{
+	vilc_perfLint_map(memory);
+	return vilc_perfLint_next_vkMapMemory(device, memory, offset, size, flags, ppData);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_perfLint_vkAllocateMemory(VkDevice device, const VkMemoryAllocateInfo* pAllocateInfo, const VkAllocationCallbacks* pAllocator, VkDeviceMemory* pMemory)
+{
+	if (pAllocateInfo->allocationSize < VILC_PERF_LINT_SMALL_ALLOCATION_SIZE)
+		vilc_perfLint_report(VILC_PERF_LINT_SMALL_ALLOCATION);
+	return vilc_perfLint_next_vkAllocateMemory(device, pAllocateInfo, pAllocator, pMemory);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_perfLint_vkCreateShaderModule(VkDevice device, const VkShaderModuleCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkShaderModule* pShaderModule)
+{
+	if (VILC_ATOMIC_LOAD(&vilc_perfLint_frame) > 0)
+		vilc_perfLint_report(VILC_PERF_LINT_SHADER_MODULE_IN_FRAME);
+	return vilc_perfLint_next_vkCreateShaderModule(device, pCreateInfo, pAllocator, pShaderModule);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_perfLint_vkCreateGraphicsPipelines(VkDevice device, VkPipelineCache pipelineCache, uint32_t createInfoCount, const VkGraphicsPipelineCreateInfo* pCreateInfos, const VkAllocationCallbacks* pAllocator, VkPipeline* pPipelines)
+{
+	if (VILC_ATOMIC_LOAD(&vilc_perfLint_frame) > 0)
+		vilc_perfLint_report(VILC_PERF_LINT_PIPELINE_IN_FRAME);
+	return vilc_perfLint_next_vkCreateGraphicsPipelines(device, pipelineCache, createInfoCount, pCreateInfos, pAllocator, pPipelines);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_perfLint_vkCreateComputePipelines(VkDevice device, VkPipelineCache pipelineCache, uint32_t createInfoCount, const VkComputePipelineCreateInfo* pCreateInfos, const VkAllocationCallbacks* pAllocator, VkPipeline* pPipelines)
+{
+	if (VILC_ATOMIC_LOAD(&vilc_perfLint_frame) > 0)
+		vilc_perfLint_report(VILC_PERF_LINT_PIPELINE_IN_FRAME);
+	return vilc_perfLint_next_vkCreateComputePipelines(device, pipelineCache, createInfoCount, pCreateInfos, pAllocator, pPipelines);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_perfLint_vkBeginCommandBuffer(VkCommandBuffer commandBuffer, const VkCommandBufferBeginInfo* pBeginInfo)
+{
+	VilcPerfLintBindings* bindings = vilc_perfLint_bindingsOf(commandBuffer);
+	vilc_perfLint_resetBindings(bindings);
+	vilc_perfLint_unlock(&bindings->lock);
+	return vilc_perfLint_next_vkBeginCommandBuffer(commandBuffer, pBeginInfo);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_perfLint_vkCmdBindPipeline(VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipeline pipeline)
+{
+	if (pipelineBindPoint == VK_PIPELINE_BIND_POINT_GRAPHICS || pipelineBindPoint == VK_PIPELINE_BIND_POINT_COMPUTE)
+	{
+		VilcPerfLintBindings* bindings = vilc_perfLint_bindingsOf(commandBuffer);
+		int redundant = bindings->pipelines[pipelineBindPoint] == pipeline;
+		bindings->pipelines[pipelineBindPoint] = pipeline;
+		vilc_perfLint_unlock(&bindings->lock);
+		if (redundant)
+			vilc_perfLint_report(VILC_PERF_LINT_REDUNDANT_BIND);
+	}
+	vilc_perfLint_next_vkCmdBindPipeline(commandBuffer, pipelineBindPoint, pipeline);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_perfLint_vkCmdBindIndexBuffer(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkIndexType indexType)
+{
+	VilcPerfLintBindings* bindings = vilc_perfLint_bindingsOf(commandBuffer);
+	int redundant = bindings->indexBuffer == buffer && bindings->indexOffset == offset && bindings->indexType == indexType && buffer;
+	bindings->indexBuffer = buffer;
+	bindings->indexOffset = offset;
+	bindings->indexType = indexType;
+	vilc_perfLint_unlock(&bindings->lock);
+	if (redundant)
+		vilc_perfLint_report(VILC_PERF_LINT_REDUNDANT_BIND);
+	vilc_perfLint_next_vkCmdBindIndexBuffer(commandBuffer, buffer, offset, indexType);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_perfLint_vkQueueSubmit(VkQueue queue, uint32_t submitCount, const VkSubmitInfo* pSubmits, VkFence fence)
+{
+	uint32_t commandBufferCount = 0, i;
+	for (i = 0; i < submitCount; ++i)
+		commandBufferCount += pSubmits[i].commandBufferCount;
+	vilc_perfLint_submit(commandBufferCount);
+	return vilc_perfLint_next_vkQueueSubmit(queue, submitCount, pSubmits, fence);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_perfLint_vkQueueWaitIdle(VkQueue queue)
+{
+	if (VILC_ATOMIC_LOAD(&vilc_perfLint_frame) > 0)
+		vilc_perfLint_report(VILC_PERF_LINT_WAIT_IDLE_IN_FRAME);
+	return vilc_perfLint_next_vkQueueWaitIdle(queue);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_perfLint_vkDeviceWaitIdle(VkDevice device)
+{
+	if (VILC_ATOMIC_LOAD(&vilc_perfLint_frame) > 0)
+		vilc_perfLint_report(VILC_PERF_LINT_WAIT_IDLE_IN_FRAME);
+	return vilc_perfLint_next_vkDeviceWaitIdle(device);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_perfLint_vkDestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator)
+{
+	vilc_perfLint_print();
+	vilc_perfLint_next_vkDestroyDevice(device, pAllocator);
+}
+
+#if defined(VK_VERSION_1_3)
+VILC_LAYER_NEXT(vilc_perfLint, vkQueueSubmit2)
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_perfLint_vkQueueSubmit2(VkQueue queue, uint32_t submitCount, const VkSubmitInfo2* pSubmits, VkFence fence)
+{
+	uint32_t commandBufferCount = 0, i;
+	for (i = 0; i < submitCount; ++i)
+		commandBufferCount += pSubmits[i].commandBufferInfoCount;
+	vilc_perfLint_submit(commandBufferCount);
+	return vilc_perfLint_next_vkQueueSubmit2(queue, submitCount, pSubmits, fence);
+}
+#endif /* defined(VK_VERSION_1_3) */
+
+#if defined(VK_KHR_synchronization2)
+VILC_LAYER_NEXT(vilc_perfLint, vkQueueSubmit2KHR)
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_perfLint_vkQueueSubmit2KHR(VkQueue queue, uint32_t submitCount, const VkSubmitInfo2KHR* pSubmits, VkFence fence)
+{
+	uint32_t commandBufferCount = 0, i;
+	for (i = 0; i < submitCount; ++i)
+		commandBufferCount += pSubmits[i].commandBufferInfoCount;
+	vilc_perfLint_submit(commandBufferCount);
+	return vilc_perfLint_next_vkQueueSubmit2KHR(queue, submitCount, pSubmits, fence);
+}
+#endif /* defined(VK_KHR_synchronization2) */
+
+#if defined(VK_VERSION_1_4)
+VILC_LAYER_NEXT(vilc_perfLint, vkMapMemory2)
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_perfLint_vkMapMemory2(VkDevice device, const VkMemoryMapInfo* pMemoryMapInfo, void** ppData)
+{
+	vilc_perfLint_map(pMemoryMapInfo->memory);
+	return vilc_perfLint_next_vkMapMemory2(device, pMemoryMapInfo, ppData);
+}
+#endif /* defined(VK_VERSION_1_4) */
+
+#if defined(VK_KHR_swapchain)
+VILC_LAYER_NEXT(vilc_perfLint, vkQueuePresentKHR)
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_perfLint_vkQueuePresentKHR(VkQueue queue, const VkPresentInfoKHR* pPresentInfo)
+{
+	VILC_ATOMIC_ADD(&vilc_perfLint_frame, 1);
+	return vilc_perfLint_next_vkQueuePresentKHR(queue, pPresentInfo);
+}
+#endif /* defined(VK_KHR_swapchain) */
+
+static void vilc_perfLint_install(void)
+{
+	VILC_LAYER_HOOK(vilc_perfLint, vkMapMemory)
+	VILC_LAYER_HOOK(vilc_perfLint, vkAllocateMemory)
+	VILC_LAYER_HOOK(vilc_perfLint, vkCreateShaderModule)
+	VILC_LAYER_HOOK(vilc_perfLint, vkCreateGraphicsPipelines)
+	VILC_LAYER_HOOK(vilc_perfLint, vkCreateComputePipelines)
+	VILC_LAYER_HOOK(vilc_perfLint, vkBeginCommandBuffer)
+	VILC_LAYER_HOOK(vilc_perfLint, vkCmdBindPipeline)
+	VILC_LAYER_HOOK(vilc_perfLint, vkCmdBindIndexBuffer)
+	VILC_LAYER_HOOK(vilc_perfLint, vkQueueSubmit)
+	VILC_LAYER_HOOK(vilc_perfLint, vkQueueWaitIdle)
+	VILC_LAYER_HOOK(vilc_perfLint, vkDeviceWaitIdle)
+	VILC_LAYER_HOOK(vilc_perfLint, vkDestroyDevice)
+#if defined(VK_VERSION_1_3)
+	VILC_LAYER_HOOK(vilc_perfLint, vkQueueSubmit2)
+#endif
+#if defined(VK_KHR_synchronization2)
+	VILC_LAYER_HOOK(vilc_perfLint, vkQueueSubmit2KHR)
+#endif
+#if defined(VK_VERSION_1_4)
+	VILC_LAYER_HOOK(vilc_perfLint, vkMapMemory2)
+#endif
+#if defined(VK_KHR_swapchain)
+	VILC_LAYER_HOOK(vilc_perfLint, vkQueuePresentKHR)
+#endif
+}
+#endif /* VILC_PERF_LINT */
+
+#if defined(VOLK_IN_LOADERS_CLOTH) && defined(VILC_GPU_TIMESTAMPS)
+/* GPU timestamps: brackets render passes, dynamic rendering, dispatches and debug label regions of primary command
+ * buffers with timestamp writes into one internal query pool. Queries are handed out to command buffers in chunks that
+ * are reset when acquired, always outside of render passes. After each submit of timed command buffers an empty submit
+ * signals an internal fence; results are read back without waiting once it is signaled, or when the command buffer is
+ * re-recorded, reset or freed, which the application may only do after its execution completed.
+ */
+#define VILC_GPU_TIMESTAMPS_CHUNK_SIZE 64
+#define VILC_GPU_TIMESTAMPS_CHUNK_COUNT 128
+#define VILC_GPU_TIMESTAMPS_CHUNKS_PER_COMMAND_BUFFER 16
+#define VILC_GPU_TIMESTAMPS_LABEL_DEPTH 16
+#define VILC_GPU_TIMESTAMPS_FENCE_COUNT 64
+#define VILC_GPU_TIMESTAMPS_RING_SIZE 4096
+#define VILC_GPU_TIMESTAMPS_NONE (~0u)
+
+typedef struct VilcGpuTimestampsRegion
+{
+	VilcGpuTimingKind kind;
+	char label[VILC_GPU_TIMING_LABEL_SIZE];
+	/* query indices local to the command buffer: chunk slot * VILC_GPU_TIMESTAMPS_CHUNK_SIZE + offset */
+	uint32_t begin;
+	uint32_t end;
+} VilcGpuTimestampsRegion;
+
+typedef struct VilcGpuTimestampsCommandBuffer
+{
+	VkCommandBuffer commandBuffer;
+	VkCommandPool commandPool;
+	uint32_t chunks[VILC_GPU_TIMESTAMPS_CHUNKS_PER_COMMAND_BUFFER];
+	uint32_t chunkCount;
+	uint32_t chunkUsed;
+	VilcGpuTimestampsRegion* regions;
+	uint32_t regionCount;
+	uint32_t regionCapacity;
+	uint32_t labels[VILC_GPU_TIMESTAMPS_LABEL_DEPTH];
+	uint32_t labelDepth;
+	uint32_t labelOverflow;
+	uint32_t renderPass;
+	int inRenderPass;
+	int recording;
+} VilcGpuTimestampsCommandBuffer;
+
+/* Completed regions of one submitted execution of a command buffer */
+typedef struct VilcGpuTimestampsPending
+{
+	uint32_t fence;
+	VkCommandBuffer commandBuffer;
+	uint32_t chunks[VILC_GPU_TIMESTAMPS_CHUNKS_PER_COMMAND_BUFFER];
+	uint32_t chunkCount;
+	VilcGpuTimestampsRegion* regions;
+	uint32_t regionCount;
+} VilcGpuTimestampsPending;
+
+static pthread_mutex_t vilc_gpuTimestamps_mutex = PTHREAD_MUTEX_INITIALIZER;
+static VkDevice vilc_gpuTimestamps_device = VK_NULL_HANDLE;
+static uint32_t vilc_gpuTimestamps_families = 0;
+static double vilc_gpuTimestamps_period = 1.0;
+static int vilc_gpuTimestamps_sync2 = 0;
+static int vilc_gpuTimestamps_sync2KHR = 0;
+static int vilc_gpuTimestamps_calibrationKHR = 0;
+static int vilc_gpuTimestamps_calibrationEXT = 0;
+#if defined(VK_KHR_synchronization2)
+static PFN_vkCmdWriteTimestamp2KHR vilc_gpuTimestamps_writeTimestamp2 = NULL;
+#endif
+#if defined(VK_KHR_calibrated_timestamps)
+static PFN_vkGetCalibratedTimestampsKHR vilc_gpuTimestamps_getCalibratedTimestamps = NULL;
+#endif
+
+static VkQueryPool vilc_gpuTimestamps_queryPool = VK_NULL_HANDLE;
+static uint32_t vilc_gpuTimestamps_freeChunks[VILC_GPU_TIMESTAMPS_CHUNK_COUNT];
+static uint32_t vilc_gpuTimestamps_freeChunkCount = 0;
+static VkFence vilc_gpuTimestamps_fences[VILC_GPU_TIMESTAMPS_FENCE_COUNT];
+static int vilc_gpuTimestamps_fenceBusy[VILC_GPU_TIMESTAMPS_FENCE_COUNT];
+static VilcHandleMap vilc_gpuTimestamps_commandBuffers;
+static VilcHandleMap vilc_gpuTimestamps_commandPools;
+static VilcGpuTimestampsPending* vilc_gpuTimestamps_pending = NULL;
+static uint32_t vilc_gpuTimestamps_pendingCount = 0;
+static uint32_t vilc_gpuTimestamps_pendingCapacity = 0;
+
+static VilcGpuTiming vilc_gpuTimestamps_ring[VILC_GPU_TIMESTAMPS_RING_SIZE];
+static uint32_t vilc_gpuTimestamps_ringHead = 0;
+static uint32_t vilc_gpuTimestamps_ringCount = 0;
+static uint64_t vilc_gpuTimestamps_resolved = 0;
+static uint64_t vilc_gpuTimestamps_dropped = 0;
+
+/* Returns the local index of the next query of the command buffer, acquiring and resetting a new chunk when the current
+ * one is used up; NONE when no queries are left.
+ */
+static uint32_t vilc_gpuTimestamps_query(VilcGpuTimestampsCommandBuffer* state)
+{
+	uint32_t chunk = VILC_GPU_TIMESTAMPS_NONE;
+
+	if (state->chunkCount && state->chunkUsed < VILC_GPU_TIMESTAMPS_CHUNK_SIZE)
+		return (state->chunkCount - 1) * VILC_GPU_TIMESTAMPS_CHUNK_SIZE + state->chunkUsed++;
+
+	if (state->inRenderPass || state->chunkCount == VILC_GPU_TIMESTAMPS_CHUNKS_PER_COMMAND_BUFFER)
+		return VILC_GPU_TIMESTAMPS_NONE;
+
+	pthread_mutex_lock(&vilc_gpuTimestamps_mutex);
+	if (!vilc_gpuTimestamps_queryPool)
+	{
+		VkQueryPoolCreateInfo createInfo;
+		memset(&createInfo, 0, sizeof(createInfo));
+		createInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		createInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		createInfo.queryCount = VILC_GPU_TIMESTAMPS_CHUNK_COUNT * VILC_GPU_TIMESTAMPS_CHUNK_SIZE;
+		if (vilc_device.vkCreateQueryPool(vilc_gpuTimestamps_device, &createInfo, NULL, &vilc_gpuTimestamps_queryPool) == VK_SUCCESS)
+			for (vilc_gpuTimestamps_freeChunkCount = 0; vilc_gpuTimestamps_freeChunkCount < VILC_GPU_TIMESTAMPS_CHUNK_COUNT; ++vilc_gpuTimestamps_freeChunkCount)
+				vilc_gpuTimestamps_freeChunks[vilc_gpuTimestamps_freeChunkCount] = VILC_GPU_TIMESTAMPS_CHUNK_COUNT - 1 - vilc_gpuTimestamps_freeChunkCount;
+	}
+	if (vilc_gpuTimestamps_freeChunkCount)
+		chunk = vilc_gpuTimestamps_freeChunks[--vilc_gpuTimestamps_freeChunkCount];
+	pthread_mutex_unlock(&vilc_gpuTimestamps_mutex);
+
+	if (chunk == VILC_GPU_TIMESTAMPS_NONE)
+		return VILC_GPU_TIMESTAMPS_NONE;
+
+	vilc_device.vkCmdResetQueryPool(state->commandBuffer, vilc_gpuTimestamps_queryPool, chunk * VILC_GPU_TIMESTAMPS_CHUNK_SIZE, VILC_GPU_TIMESTAMPS_CHUNK_SIZE);
+	state->chunks[state->chunkCount++] = chunk;
+	state->chunkUsed = 1;
+	return (state->chunkCount - 1) * VILC_GPU_TIMESTAMPS_CHUNK_SIZE;
+}
+
+static void vilc_gpuTimestamps_write(VilcGpuTimestampsCommandBuffer* state, uint32_t query, int end)
+{
+	uint32_t index = state->chunks[query / VILC_GPU_TIMESTAMPS_CHUNK_SIZE] * VILC_GPU_TIMESTAMPS_CHUNK_SIZE + query % VILC_GPU_TIMESTAMPS_CHUNK_SIZE;
+
+#if defined(VK_KHR_synchronization2)
+	if (vilc_gpuTimestamps_writeTimestamp2)
+	{
+		vilc_gpuTimestamps_writeTimestamp2(state->commandBuffer, end ? VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT_KHR : VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT_KHR, vilc_gpuTimestamps_queryPool, index);
+		return;
+	}
+#endif
+	vilc_device.vkCmdWriteTimestamp(state->commandBuffer, end ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, vilc_gpuTimestamps_queryPool, index);
+}
+
+/* Opens a region and returns its index, or NONE when it could not be timed */
+static uint32_t vilc_gpuTimestamps_begin(VilcGpuTimestampsCommandBuffer* state, VilcGpuTimingKind kind, const char* label)
+{
+	VilcGpuTimestampsRegion* region;
+	uint32_t query;
+
+	if (state->regionCount == state->regionCapacity)
+	{
+		uint32_t capacity = state->regionCapacity ? state->regionCapacity * 2 : 16;
+		VilcGpuTimestampsRegion* regions = (VilcGpuTimestampsRegion*)realloc(state->regions, capacity * sizeof(VilcGpuTimestampsRegion));
+		if (!regions)
+			return VILC_GPU_TIMESTAMPS_NONE;
+		state->regions = regions;
+		state->regionCapacity = capacity;
+	}
+
+	query = vilc_gpuTimestamps_query(state);
+	if (query == VILC_GPU_TIMESTAMPS_NONE)
+	{
+		VILC_ATOMIC_ADD(&vilc_gpuTimestamps_dropped, 1);
+		return VILC_GPU_TIMESTAMPS_NONE;
+	}
+
+	region = &state->regions[state->regionCount];
+	region->kind = kind;
+	region->label[0] = 0;
+	if (label)
+		strncat(region->label, label, VILC_GPU_TIMING_LABEL_SIZE - 1);
+	region->begin = query;
+	region->end = VILC_GPU_TIMESTAMPS_NONE;
+	vilc_gpuTimestamps_write(state, query, 0);
+
+	return state->regionCount++;
+}
+
+static void vilc_gpuTimestamps_end(VilcGpuTimestampsCommandBuffer* state, uint32_t region)
+{
+	uint32_t query;
+
+	if (region == VILC_GPU_TIMESTAMPS_NONE)
+		return;
+
+	query = vilc_gpuTimestamps_query(state);
+	if (query == VILC_GPU_TIMESTAMPS_NONE)
+	{
+		VILC_ATOMIC_ADD(&vilc_gpuTimestamps_dropped, 1);
+		return;
+	}
+
+	state->regions[region].end = query;
+	vilc_gpuTimestamps_write(state, query, 1);
+}
+
+/* Returns the state of a command buffer that is being recorded with timing enabled */
+static VilcGpuTimestampsCommandBuffer* vilc_gpuTimestamps_recording(VkCommandBuffer commandBuffer)
+{
+	VilcGpuTimestampsCommandBuffer* state;
+
+	pthread_mutex_lock(&vilc_gpuTimestamps_mutex);
+	state = (VilcGpuTimestampsCommandBuffer*)vilc_mapFind(&vilc_gpuTimestamps_commandBuffers, VILC_DISPATCHABLE_KEY(commandBuffer));
+	pthread_mutex_unlock(&vilc_gpuTimestamps_mutex);
+
+	return state && state->recording ? state : NULL;
+}
+
+/* Gets a pair of GPU and CLOCK_MONOTONIC timestamps sampled at the same time; returns 0 when calibration is not available */
+static int vilc_gpuTimestamps_calibrate(uint64_t* gpuTicks, uint64_t* cpuNs)
+{
+#if defined(VK_KHR_calibrated_timestamps)
+	VkCalibratedTimestampInfoKHR infos[2];
+	uint64_t timestamps[2], maxDeviation;
+
+	memset(infos, 0, sizeof(infos));
+	infos[0].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_KHR;
+	infos[0].timeDomain = VK_TIME_DOMAIN_DEVICE_KHR;
+	infos[1].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_KHR;
+	infos[1].timeDomain = VK_TIME_DOMAIN_CLOCK_MONOTONIC_KHR;
+	if (vilc_gpuTimestamps_getCalibratedTimestamps && vilc_gpuTimestamps_getCalibratedTimestamps(vilc_gpuTimestamps_device, 2, infos, timestamps, &maxDeviation) == VK_SUCCESS)
+	{
+		*gpuTicks = timestamps[0];
+		*cpuNs = timestamps[1];
+		return 1;
+	}
+#endif
+	(void)gpuTicks;
+	(void)cpuNs;
+	return 0;
+}
+
+/* Reads back the queries of a pending execution and appends its regions to the ring; called with the mutex held */
+static void vilc_gpuTimestamps_resolve(const VilcGpuTimestampsPending* pending)
+{
+	uint64_t* results = (uint64_t*)malloc(pending->chunkCount * VILC_GPU_TIMESTAMPS_CHUNK_SIZE * 2 * sizeof(uint64_t));
+	uint64_t gpuTicks = 0, cpuNs = 0;
+	int calibrated;
+	uint32_t i;
+
+	if (!results)
+	{
+		VILC_ATOMIC_ADD(&vilc_gpuTimestamps_dropped, pending->regionCount);
+		return;
+	}
+
+	/* VK_NOT_READY is expected for queries of the last chunk that were never written */
+	for (i = 0; i < pending->chunkCount; ++i)
+		vilc_device.vkGetQueryPoolResults(vilc_gpuTimestamps_device, vilc_gpuTimestamps_queryPool, pending->chunks[i] * VILC_GPU_TIMESTAMPS_CHUNK_SIZE, VILC_GPU_TIMESTAMPS_CHUNK_SIZE,
+		    VILC_GPU_TIMESTAMPS_CHUNK_SIZE * 2 * sizeof(uint64_t), results + i * VILC_GPU_TIMESTAMPS_CHUNK_SIZE * 2, 2 * sizeof(uint64_t),
+		    VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+	calibrated = vilc_gpuTimestamps_calibrate(&gpuTicks, &cpuNs);
+
+	for (i = 0; i < pending->regionCount; ++i)
+	{
+		const VilcGpuTimestampsRegion* region = &pending->regions[i];
+		const uint64_t* begin = &results[region->begin * 2];
+		const uint64_t* end = &results[region->end * 2];
+		VilcGpuTiming* timing;
+
+		if (!begin[1] || !end[1])
+		{
+			VILC_ATOMIC_ADD(&vilc_gpuTimestamps_dropped, 1);
+			continue;
+		}
+
+		if (vilc_gpuTimestamps_ringCount == VILC_GPU_TIMESTAMPS_RING_SIZE)
+		{
+			vilc_gpuTimestamps_ringHead = (vilc_gpuTimestamps_ringHead + 1) % VILC_GPU_TIMESTAMPS_RING_SIZE;
+			vilc_gpuTimestamps_ringCount--;
+			VILC_ATOMIC_ADD(&vilc_gpuTimestamps_dropped, 1);
+		}
+
+		timing = &vilc_gpuTimestamps_ring[(vilc_gpuTimestamps_ringHead + vilc_gpuTimestamps_ringCount++) % VILC_GPU_TIMESTAMPS_RING_SIZE];
+		timing->kind = region->kind;
+		timing->commandBuffer = pending->commandBuffer;
+		memcpy(timing->label, region->label, sizeof(timing->label));
+		if (calibrated)
+		{
+			timing->beginNs = cpuNs + (uint64_t)(int64_t)((double)(int64_t)(begin[0] - gpuTicks) * vilc_gpuTimestamps_period);
+			timing->endNs = cpuNs + (uint64_t)(int64_t)((double)(int64_t)(end[0] - gpuTicks) * vilc_gpuTimestamps_period);
+		}
+		else
+		{
+			timing->beginNs = (uint64_t)((double)begin[0] * vilc_gpuTimestamps_period);
+			timing->endNs = (uint64_t)((double)end[0] * vilc_gpuTimestamps_period);
+		}
+		timing->calibrated = calibrated ? VK_TRUE : VK_FALSE;
+		vilc_gpuTimestamps_resolved++;
+	}
+
+	free(results);
+}
+
+static void vilc_gpuTimestamps_removePending(uint32_t index)
+{
+	free(vilc_gpuTimestamps_pending[index].regions);
+	vilc_gpuTimestamps_pending[index] = vilc_gpuTimestamps_pending[--vilc_gpuTimestamps_pendingCount];
+}
+
+/* Resolves executions whose internal fence is signaled; called with the mutex held */
+static void vilc_gpuTimestamps_poll(void)
+{
+	uint32_t i, j;
+
+	for (i = 0; i < VILC_GPU_TIMESTAMPS_FENCE_COUNT; ++i)
+	{
+		if (!vilc_gpuTimestamps_fenceBusy[i] || vilc_device.vkGetFenceStatus(vilc_gpuTimestamps_device, vilc_gpuTimestamps_fences[i]) != VK_SUCCESS)
+			continue;
+
+		for (j = vilc_gpuTimestamps_pendingCount; j-- > 0;)
+			if (vilc_gpuTimestamps_pending[j].fence == i)
+			{
+				vilc_gpuTimestamps_resolve(&vilc_gpuTimestamps_pending[j]);
+				vilc_gpuTimestamps_removePending(j);
+			}
+
+		vilc_device.vkResetFences(vilc_gpuTimestamps_device, 1, &vilc_gpuTimestamps_fences[i]);
+		vilc_gpuTimestamps_fenceBusy[i] = 0;
+	}
+}
+
+/* Resolves all executions of a command buffer that the application guarantees to be complete; called with the mutex held */
+static void vilc_gpuTimestamps_complete(VkCommandBuffer commandBuffer)
+{
+	uint32_t i;
+
+	for (i = vilc_gpuTimestamps_pendingCount; i-- > 0;)
+		if (vilc_gpuTimestamps_pending[i].commandBuffer == commandBuffer)
+		{
+			vilc_gpuTimestamps_resolve(&vilc_gpuTimestamps_pending[i]);
+			vilc_gpuTimestamps_removePending(i);
+		}
+}
+
+/* Returns the chunks of a command buffer to the pool and forgets its regions; called with the mutex held */
+static void vilc_gpuTimestamps_reset(VilcGpuTimestampsCommandBuffer* state)
+{
+	vilc_gpuTimestamps_complete(state->commandBuffer);
+
+	while (state->chunkCount)
+		vilc_gpuTimestamps_freeChunks[vilc_gpuTimestamps_freeChunkCount++] = state->chunks[--state->chunkCount];
+
+	state->chunkUsed = 0;
+	state->regionCount = 0;
+	state->labelDepth = 0;
+	state->labelOverflow = 0;
+	state->renderPass = VILC_GPU_TIMESTAMPS_NONE;
+	state->inRenderPass = 0;
+	state->recording = 0;
+}
+
+static uint32_t vilc_gpuTimestamps_acquireFence(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < VILC_GPU_TIMESTAMPS_FENCE_COUNT; ++i)
+	{
+		if (vilc_gpuTimestamps_fenceBusy[i])
+			continue;
+
+		if (!vilc_gpuTimestamps_fences[i])
+		{
+			VkFenceCreateInfo createInfo;
+			memset(&createInfo, 0, sizeof(createInfo));
+			createInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+			if (vilc_device.vkCreateFence(vilc_gpuTimestamps_device, &createInfo, NULL, &vilc_gpuTimestamps_fences[i]) != VK_SUCCESS)
+				return VILC_GPU_TIMESTAMPS_NONE;
+		}
+
+		vilc_gpuTimestamps_fenceBusy[i] = 1;
+		return i;
+	}
+
+	return VILC_GPU_TIMESTAMPS_NONE;
+}
+
+/* Records a submitted execution of a command buffer; called with the mutex held */
+static void vilc_gpuTimestamps_track(VkCommandBuffer commandBuffer, uint32_t* fence)
+{
+	VilcGpuTimestampsCommandBuffer* state = (VilcGpuTimestampsCommandBuffer*)vilc_mapFind(&vilc_gpuTimestamps_commandBuffers, VILC_DISPATCHABLE_KEY(commandBuffer));
+	VilcGpuTimestampsPending* pending;
+	uint32_t complete = 0, i;
+
+	if (!state)
+		return;
+
+	for (i = 0; i < state->regionCount; ++i)
+		complete += state->regions[i].end != VILC_GPU_TIMESTAMPS_NONE;
+
+	if (!complete)
+		return;
+
+	/* polling may retire pending executions, so it has to happen before a slot is taken */
+	if (*fence == VILC_GPU_TIMESTAMPS_NONE)
+	{
+		vilc_gpuTimestamps_poll();
+		*fence = vilc_gpuTimestamps_acquireFence();
+	}
+
+	if (vilc_gpuTimestamps_pendingCount == vilc_gpuTimestamps_pendingCapacity)
+	{
+		uint32_t capacity = vilc_gpuTimestamps_pendingCapacity ? vilc_gpuTimestamps_pendingCapacity * 2 : 64;
+		VilcGpuTimestampsPending* grown = (VilcGpuTimestampsPending*)realloc(vilc_gpuTimestamps_pending, capacity * sizeof(VilcGpuTimestampsPending));
+		if (!grown)
+			return;
+		vilc_gpuTimestamps_pending = grown;
+		vilc_gpuTimestamps_pendingCapacity = capacity;
+	}
+
+	pending = &vilc_gpuTimestamps_pending[vilc_gpuTimestamps_pendingCount];
+	pending->regions = (VilcGpuTimestampsRegion*)malloc(complete * sizeof(VilcGpuTimestampsRegion));
+	if (!pending->regions)
+		return;
+
+	pending->fence = *fence;
+	pending->commandBuffer = commandBuffer;
+	memcpy(pending->chunks, state->chunks, sizeof(pending->chunks));
+	pending->chunkCount = state->chunkCount;
+	pending->regionCount = 0;
+	for (i = 0; i < state->regionCount; ++i)
+		if (state->regions[i].end != VILC_GPU_TIMESTAMPS_NONE)
+			pending->regions[pending->regionCount++] = state->regions[i];
+	vilc_gpuTimestamps_pendingCount++;
+}
+
+/* Signals the internal fence after the work that was just submitted; called with the mutex held */
+static void vilc_gpuTimestamps_signal(VkQueue queue, uint32_t fence)
+{
+	uint32_t i;
+
+	if (fence == VILC_GPU_TIMESTAMPS_NONE)
+		return;
+
+	if (vilc_device.vkQueueSubmit(queue, 0, NULL, vilc_gpuTimestamps_fences[fence]) == VK_SUCCESS)
+		return;
+
+	/* without the fence the executions are still resolved when their command buffers are re-recorded or freed */
+	for (i = 0; i < vilc_gpuTimestamps_pendingCount; ++i)
+		if (vilc_gpuTimestamps_pending[i].fence == fence)
+			vilc_gpuTimestamps_pending[i].fence = VILC_GPU_TIMESTAMPS_NONE;
+	vilc_gpuTimestamps_fenceBusy[fence] = 0;
+}
+
+static void vilc_gpuTimestamps_freeCommandBuffer(VilcGpuTimestampsCommandBuffer* state)
+{
+	vilc_gpuTimestamps_reset(state);
+	free(state->regions);
+	free(state);
+}
+
+uint32_t vilcGetGpuTimings(VilcGpuTiming* pTimings, uint32_t maxCount)
+{
+	uint32_t count = 0;
+
+	pthread_mutex_lock(&vilc_gpuTimestamps_mutex);
+	if (vilc_gpuTimestamps_device)
+		vilc_gpuTimestamps_poll();
+	while (count < maxCount && vilc_gpuTimestamps_ringCount)
+	{
+		pTimings[count++] = vilc_gpuTimestamps_ring[vilc_gpuTimestamps_ringHead];
+		vilc_gpuTimestamps_ringHead = (vilc_gpuTimestamps_ringHead + 1) % VILC_GPU_TIMESTAMPS_RING_SIZE;
+		vilc_gpuTimestamps_ringCount--;
+	}
+	pthread_mutex_unlock(&vilc_gpuTimestamps_mutex);
+
+	return count;
+}
+
+static void vilc_gpuTimestamps_setup(VkPhysicalDevice physicalDevice, const VkDeviceCreateInfo* pCreateInfo, VkDevice device)
+{
+	VkPhysicalDeviceProperties properties;
+	VkQueueFamilyProperties families[32];
+	uint32_t familyCount = 32, i;
+	const VkBaseInStructure* next;
+
+	vilc_instance.vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+	vilc_instance.vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, families);
+
+	vilc_gpuTimestamps_device = device;
+	vilc_gpuTimestamps_period = properties.limits.timestampPeriod;
+	vilc_gpuTimestamps_families = 0;
+	for (i = 0; i < familyCount; ++i)
+		if (families[i].timestampValidBits)
+			vilc_gpuTimestamps_families |= 1u << i;
+
+	vilc_gpuTimestamps_sync2 = 0;
+	vilc_gpuTimestamps_sync2KHR = vilc_hasDeviceExtension(pCreateInfo, VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+	for (next = (const VkBaseInStructure*)pCreateInfo->pNext; next; next = next->pNext)
+	{
+#if defined(VK_VERSION_1_3)
+		if (next->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES)
+			vilc_gpuTimestamps_sync2 |= ((const VkPhysicalDeviceVulkan13Features*)next)->synchronization2;
+#endif
+#if defined(VK_KHR_synchronization2)
+		if (next->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR)
+			vilc_gpuTimestamps_sync2 |= ((const VkPhysicalDeviceSynchronization2FeaturesKHR*)next)->synchronization2;
+#endif
+	}
+
+	vilc_gpuTimestamps_calibrationKHR = 0;
+	vilc_gpuTimestamps_calibrationEXT = 0;
+#if defined(VK_KHR_calibrated_timestamps)
+	{
+		int khr = vilc_hasDeviceExtension(pCreateInfo, VK_KHR_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+		int ext = vilc_hasDeviceExtension(pCreateInfo, VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+		PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsKHR getTimeDomains = khr ? vilc_instance.vkGetPhysicalDeviceCalibrateableTimeDomainsKHR : ext ? vilc_instance.vkGetPhysicalDeviceCalibrateableTimeDomainsEXT : NULL;
+		VkTimeDomainKHR domains[8];
+		uint32_t domainCount = 8, found = 0;
+
+		if (getTimeDomains && getTimeDomains(physicalDevice, &domainCount, domains) >= VK_SUCCESS)
+			for (i = 0; i < domainCount; ++i)
+				found |= domains[i] == VK_TIME_DOMAIN_DEVICE_KHR ? 1 : domains[i] == VK_TIME_DOMAIN_CLOCK_MONOTONIC_KHR ? 2 : 0;
+
+		vilc_gpuTimestamps_calibrationKHR = khr && found == 3;
+		vilc_gpuTimestamps_calibrationEXT = !khr && ext && found == 3;
+	}
+#endif
+}
+
+VILC_LAYER_NEXT(vilc_gpuTimestamps, vkCreateDevice)
+VILC_LAYER_NEXT(vilc_gpuTimestamps, vkDestroyDevice)
+VILC_LAYER_NEXT(vilc_gpuTimestamps, vkCreateCommandPool)
+VILC_LAYER_NEXT(vilc_gpuTimestamps, vkDestroyCommandPool)
+VILC_LAYER_NEXT(vilc_gpuTimestamps, vkResetCommandPool)
+VILC_LAYER_NEXT(vilc_gpuTimestamps, vkAllocateCommandBuffers)
+VILC_LAYER_NEXT(vilc_gpuTimestamps, vkFreeCommandBuffers)
+VILC_LAYER_NEXT(vilc_gpuTimestamps, vkBeginCommandBuffer)
+VILC_LAYER_NEXT(vilc_gpuTimestamps, vkEndCommandBuffer)
+VILC_LAYER_NEXT(vilc_gpuTimestamps, vkResetCommandBuffer)
+VILC_LAYER_NEXT(vilc_gpuTimestamps, vkCmdBeginRenderPass)
+VILC_LAYER_NEXT(vilc_gpuTimestamps, vkCmdEndRenderPass)
+VILC_LAYER_NEXT(vilc_gpuTimestamps, vkCmdDispatch)
+VILC_LAYER_NEXT(vilc_gpuTimestamps, vkCmdDispatchIndirect)
+VILC_LAYER_NEXT(vilc_gpuTimestamps, vkQueueSubmit)
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_gpuTimestamps_vkCreateDevice(VkPhysicalDevice physicalDevice, const VkDeviceCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDevice* pDevice)
+{
+	VkResult result = vilc_gpuTimestamps_next_vkCreateDevice(physicalDevice, pCreateInfo, pAllocator, pDevice);
+	if (result == VK_SUCCESS)
+		vilc_gpuTimestamps_setup(physicalDevice, pCreateInfo, *pDevice);
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_gpuTimestamps_vkDestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator)
+{
+	uint32_t i;
+
+	pthread_mutex_lock(&vilc_gpuTimestamps_mutex);
+	if (device == vilc_gpuTimestamps_device)
+	{
+		/* all submitted work is complete by now */
+		for (i = 0; i < vilc_gpuTimestamps_commandBuffers.capacity; ++i)
+			if (vilc_gpuTimestamps_commandBuffers.keys[i])
+				vilc_gpuTimestamps_freeCommandBuffer((VilcGpuTimestampsCommandBuffer*)vilc_gpuTimestamps_commandBuffers.values[i]);
+		while (vilc_gpuTimestamps_pendingCount)
+		{
+			vilc_gpuTimestamps_resolve(&vilc_gpuTimestamps_pending[0]);
+			vilc_gpuTimestamps_removePending(0);
+		}
+		vilc_mapFree(&vilc_gpuTimestamps_commandBuffers);
+		vilc_mapFree(&vilc_gpuTimestamps_commandPools);
+
+		for (i = 0; i < VILC_GPU_TIMESTAMPS_FENCE_COUNT; ++i)
+			if (vilc_gpuTimestamps_fences[i])
+			{
+				vilc_device.vkDestroyFence(device, vilc_gpuTimestamps_fences[i], NULL);
+				vilc_gpuTimestamps_fences[i] = VK_NULL_HANDLE;
+				vilc_gpuTimestamps_fenceBusy[i] = 0;
+			}
+		if (vilc_gpuTimestamps_queryPool)
+			vilc_device.vkDestroyQueryPool(device, vilc_gpuTimestamps_queryPool, NULL);
+		vilc_gpuTimestamps_queryPool = VK_NULL_HANDLE;
+		vilc_gpuTimestamps_freeChunkCount = 0;
+		vilc_gpuTimestamps_device = VK_NULL_HANDLE;
+
+		fprintf(stderr, "vilc: gpu timestamps: %llu regions resolved, %llu dropped\n", (unsigned long long)vilc_gpuTimestamps_resolved, (unsigned long long)vilc_gpuTimestamps_dropped);
+	}
+	pthread_mutex_unlock(&vilc_gpuTimestamps_mutex);
+
+	vilc_gpuTimestamps_next_vkDestroyDevice(device, pAllocator);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_gpuTimestamps_vkCreateCommandPool(VkDevice device, const VkCommandPoolCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkCommandPool* pCommandPool)
+{
+	VkResult result = vilc_gpuTimestamps_next_vkCreateCommandPool(device, pCreateInfo, pAllocator, pCommandPool);
+
+	if (result == VK_SUCCESS && device == vilc_gpuTimestamps_device && pCreateInfo->queueFamilyIndex < 32 && (vilc_gpuTimestamps_families & (1u << pCreateInfo->queueFamilyIndex)))
+	{
+		pthread_mutex_lock(&vilc_gpuTimestamps_mutex);
+		vilc_mapInsert(&vilc_gpuTimestamps_commandPools, VILC_OBJECT_KEY(*pCommandPool), (void*)(uintptr_t)(pCreateInfo->queueFamilyIndex + 1));
+		pthread_mutex_unlock(&vilc_gpuTimestamps_mutex);
+	}
+	return result;
+}
+
+/* Applies vilc_gpuTimestamps_reset to the command buffers of a pool, freeing their state as well when destroy is set */
+static void vilc_gpuTimestamps_resetPool(VkCommandPool commandPool, int destroy)
+{
+	VkCommandBuffer* commandBuffers;
+	uint32_t count = 0, i;
+
+	pthread_mutex_lock(&vilc_gpuTimestamps_mutex);
+	commandBuffers = (VkCommandBuffer*)malloc((vilc_gpuTimestamps_commandBuffers.count + 1) * sizeof(VkCommandBuffer));
+	for (i = 0; commandBuffers && i < vilc_gpuTimestamps_commandBuffers.capacity; ++i)
+	{
+		VilcGpuTimestampsCommandBuffer* state = (VilcGpuTimestampsCommandBuffer*)vilc_gpuTimestamps_commandBuffers.values[i];
+		if (vilc_gpuTimestamps_commandBuffers.keys[i] && state->commandPool == commandPool)
+			commandBuffers[count++] = state->commandBuffer;
+	}
+	for (i = 0; i < count; ++i)
+	{
+		if (destroy)
+			vilc_gpuTimestamps_freeCommandBuffer((VilcGpuTimestampsCommandBuffer*)vilc_mapRemove(&vilc_gpuTimestamps_commandBuffers, VILC_DISPATCHABLE_KEY(commandBuffers[i])));
+		else
+			vilc_gpuTimestamps_reset((VilcGpuTimestampsCommandBuffer*)vilc_mapFind(&vilc_gpuTimestamps_commandBuffers, VILC_DISPATCHABLE_KEY(commandBuffers[i])));
+	}
+	if (destroy)
+		vilc_mapRemove(&vilc_gpuTimestamps_commandPools, VILC_OBJECT_KEY(commandPool));
+	pthread_mutex_unlock(&vilc_gpuTimestamps_mutex);
+
+	free(commandBuffers);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_gpuTimestamps_vkDestroyCommandPool(VkDevice device, VkCommandPool commandPool, const VkAllocationCallbacks* pAllocator)
+{
+	if (commandPool)
+		vilc_gpuTimestamps_resetPool(commandPool, 1);
+	vilc_gpuTimestamps_next_vkDestroyCommandPool(device, commandPool, pAllocator);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_gpuTimestamps_vkResetCommandPool(VkDevice device, VkCommandPool commandPool, VkCommandPoolResetFlags flags)
+{
+	vilc_gpuTimestamps_resetPool(commandPool, 0);
+	return vilc_gpuTimestamps_next_vkResetCommandPool(device, commandPool, flags);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_gpuTimestamps_vkAllocateCommandBuffers(VkDevice device, const VkCommandBufferAllocateInfo* pAllocateInfo, VkCommandBuffer* pCommandBuffers)
+{
+	VkResult result = vilc_gpuTimestamps_next_vkAllocateCommandBuffers(device, pAllocateInfo, pCommandBuffers);
+	uint32_t i;
+
+	/* secondary command buffers are covered by the render pass or label regions of the primary that executes them */
+	if (result != VK_SUCCESS || pAllocateInfo->level != VK_COMMAND_BUFFER_LEVEL_PRIMARY)
+		return result;
+
+	pthread_mutex_lock(&vilc_gpuTimestamps_mutex);
+	if (vilc_mapFind(&vilc_gpuTimestamps_commandPools, VILC_OBJECT_KEY(pAllocateInfo->commandPool)))
+		for (i = 0; i < pAllocateInfo->commandBufferCount; ++i)
+		{
+			VilcGpuTimestampsCommandBuffer* state = (VilcGpuTimestampsCommandBuffer*)calloc(1, sizeof(VilcGpuTimestampsCommandBuffer));
+			if (!state)
+				break;
+			state->commandBuffer = pCommandBuffers[i];
+			state->commandPool = pAllocateInfo->commandPool;
+			state->renderPass = VILC_GPU_TIMESTAMPS_NONE;
+			if (!vilc_mapInsert(&vilc_gpuTimestamps_commandBuffers, VILC_DISPATCHABLE_KEY(pCommandBuffers[i]), state))
+				free(state);
+		}
+	pthread_mutex_unlock(&vilc_gpuTimestamps_mutex);
+
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_gpuTimestamps_vkFreeCommandBuffers(VkDevice device, VkCommandPool commandPool, uint32_t commandBufferCount, const VkCommandBuffer* pCommandBuffers)
+{
+	uint32_t i;
+
+	pthread_mutex_lock(&vilc_gpuTimestamps_mutex);
+	for (i = 0; i < commandBufferCount; ++i)
+	{
+		VilcGpuTimestampsCommandBuffer* state = pCommandBuffers[i] ? (VilcGpuTimestampsCommandBuffer*)vilc_mapRemove(&vilc_gpuTimestamps_commandBuffers, VILC_DISPATCHABLE_KEY(pCommandBuffers[i])) : NULL;
+		if (state)
+			vilc_gpuTimestamps_freeCommandBuffer(state);
+	}
+	pthread_mutex_unlock(&vilc_gpuTimestamps_mutex);
+
+	vilc_gpuTimestamps_next_vkFreeCommandBuffers(device, commandPool, commandBufferCount, pCommandBuffers);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_gpuTimestamps_vkBeginCommandBuffer(VkCommandBuffer commandBuffer, const VkCommandBufferBeginInfo* pBeginInfo)
+{
+	VilcGpuTimestampsCommandBuffer* state;
+	VkResult result = vilc_gpuTimestamps_next_vkBeginCommandBuffer(commandBuffer, pBeginInfo);
+
+	pthread_mutex_lock(&vilc_gpuTimestamps_mutex);
+	state = (VilcGpuTimestampsCommandBuffer*)vilc_mapFind(&vilc_gpuTimestamps_commandBuffers, VILC_DISPATCHABLE_KEY(commandBuffer));
+	if (state)
+	{
+		vilc_gpuTimestamps_reset(state);
+		state->recording = result == VK_SUCCESS;
+	}
+	pthread_mutex_unlock(&vilc_gpuTimestamps_mutex);
+
+	return result;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_gpuTimestamps_vkEndCommandBuffer(VkCommandBuffer commandBuffer)
+{
+	VilcGpuTimestampsCommandBuffer* state = vilc_gpuTimestamps_recording(commandBuffer);
+
+	/* label regions left open continue in another command buffer and cannot be timed */
+	if (state)
+	{
+		VILC_ATOMIC_ADD(&vilc_gpuTimestamps_dropped, state->labelDepth);
+		state->recording = 0;
+	}
+
+	return vilc_gpuTimestamps_next_vkEndCommandBuffer(commandBuffer);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_gpuTimestamps_vkResetCommandBuffer(VkCommandBuffer commandBuffer, VkCommandBufferResetFlags flags)
+{
+	VilcGpuTimestampsCommandBuffer* state;
+
+	pthread_mutex_lock(&vilc_gpuTimestamps_mutex);
+	state = (VilcGpuTimestampsCommandBuffer*)vilc_mapFind(&vilc_gpuTimestamps_commandBuffers, VILC_DISPATCHABLE_KEY(commandBuffer));
+	if (state)
+		vilc_gpuTimestamps_reset(state);
+	pthread_mutex_unlock(&vilc_gpuTimestamps_mutex);
+
+	return vilc_gpuTimestamps_next_vkResetCommandBuffer(commandBuffer, flags);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_gpuTimestamps_vkCmdBeginRenderPass(VkCommandBuffer commandBuffer, const VkRenderPassBeginInfo* pRenderPassBegin, VkSubpassContents contents)
+{
+	VilcGpuTimestampsCommandBuffer* state = vilc_gpuTimestamps_recording(commandBuffer);
+
+	if (state)
+		state->renderPass = vilc_gpuTimestamps_begin(state, VILC_GPU_TIMING_RENDER_PASS, NULL);
+	vilc_gpuTimestamps_next_vkCmdBeginRenderPass(commandBuffer, pRenderPassBegin, contents);
+	if (state)
+		state->inRenderPass = 1;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_gpuTimestamps_vkCmdEndRenderPass(VkCommandBuffer commandBuffer)
+{
+	VilcGpuTimestampsCommandBuffer* state = vilc_gpuTimestamps_recording(commandBuffer);
+
+	vilc_gpuTimestamps_next_vkCmdEndRenderPass(commandBuffer);
+	if (state)
+	{
+		state->inRenderPass = 0;
+		vilc_gpuTimestamps_end(state, state->renderPass);
+		state->renderPass = VILC_GPU_TIMESTAMPS_NONE;
+	}
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_gpuTimestamps_vkCmdDispatch(VkCommandBuffer commandBuffer, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+{
+	VilcGpuTimestampsCommandBuffer* state = vilc_gpuTimestamps_recording(commandBuffer);
+	uint32_t region = state ? vilc_gpuTimestamps_begin(state, VILC_GPU_TIMING_DISPATCH, NULL) : VILC_GPU_TIMESTAMPS_NONE;
+
+	vilc_gpuTimestamps_next_vkCmdDispatch(commandBuffer, groupCountX, groupCountY, groupCountZ);
+	if (state)
+		vilc_gpuTimestamps_end(state, region);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_gpuTimestamps_vkCmdDispatchIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset)
+{
+	VilcGpuTimestampsCommandBuffer* state = vilc_gpuTimestamps_recording(commandBuffer);
+	uint32_t region = state ? vilc_gpuTimestamps_begin(state, VILC_GPU_TIMING_DISPATCH, NULL) : VILC_GPU_TIMESTAMPS_NONE;
+
+	vilc_gpuTimestamps_next_vkCmdDispatchIndirect(commandBuffer, buffer, offset);
+	if (state)
+		vilc_gpuTimestamps_end(state, region);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_gpuTimestamps_vkQueueSubmit(VkQueue queue, uint32_t submitCount, const VkSubmitInfo* pSubmits, VkFence fence)
+{
+	VkResult result = vilc_gpuTimestamps_next_vkQueueSubmit(queue, submitCount, pSubmits, fence);
+	uint32_t internalFence = VILC_GPU_TIMESTAMPS_NONE, i, j;
+
+	if (result != VK_SUCCESS)
+		return result;
+
+	pthread_mutex_lock(&vilc_gpuTimestamps_mutex);
+	for (i = 0; i < submitCount; ++i)
+		for (j = 0; j < pSubmits[i].commandBufferCount; ++j)
+			vilc_gpuTimestamps_track(pSubmits[i].pCommandBuffers[j], &internalFence);
+	vilc_gpuTimestamps_signal(queue, internalFence);
+	pthread_mutex_unlock(&vilc_gpuTimestamps_mutex);
+
+	return result;
+}
+
+#if defined(VK_VERSION_1_1)
+VILC_LAYER_NEXT(vilc_gpuTimestamps, vkCmdDispatchBase)
+
+static VKAPI_ATTR void VKAPI_CALL vilc_gpuTimestamps_vkCmdDispatchBase(VkCommandBuffer commandBuffer, uint32_t baseGroupX, uint32_t baseGroupY, uint32_t baseGroupZ, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+{
+	VilcGpuTimestampsCommandBuffer* state = vilc_gpuTimestamps_recording(commandBuffer);
+	uint32_t region = state ? vilc_gpuTimestamps_begin(state, VILC_GPU_TIMING_DISPATCH, NULL) : VILC_GPU_TIMESTAMPS_NONE;
+
+	vilc_gpuTimestamps_next_vkCmdDispatchBase(commandBuffer, baseGroupX, baseGroupY, baseGroupZ, groupCountX, groupCountY, groupCountZ);
+	if (state)
+		vilc_gpuTimestamps_end(state, region);
+}
+#endif /* defined(VK_VERSION_1_1) */
+
+#if defined(VK_VERSION_1_2)
+VILC_LAYER_NEXT(vilc_gpuTimestamps, vkCmdBeginRenderPass2)
+VILC_LAYER_NEXT(vilc_gpuTimestamps, vkCmdEndRenderPass2)
+
+static VKAPI_ATTR void VKAPI_CALL vilc_gpuTimestamps_vkCmdBeginRenderPass2(VkCommandBuffer commandBuffer, const VkRenderPassBeginInfo* pRenderPassBegin, const VkSubpassBeginInfo* pSubpassBeginInfo)
+{
+	VilcGpuTimestampsCommandBuffer* state = vilc_gpuTimestamps_recording(commandBuffer);
+
+	if (state)
+		state->renderPass = vilc_gpuTimestamps_begin(state, VILC_GPU_TIMING_RENDER_PASS, NULL);
+	vilc_gpuTimestamps_next_vkCmdBeginRenderPass2(commandBuffer, pRenderPassBegin, pSubpassBeginInfo);
+	if (state)
+		state->inRenderPass = 1;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_gpuTimestamps_vkCmdEndRenderPass2(VkCommandBuffer commandBuffer, const VkSubpassEndInfo* pSubpassEndInfo)
+{
+	VilcGpuTimestampsCommandBuffer* state = vilc_gpuTimestamps_recording(commandBuffer);
+
+	vilc_gpuTimestamps_next_vkCmdEndRenderPass2(commandBuffer, pSubpassEndInfo);
+	if (state)
+	{
+		state->inRenderPass = 0;
+		vilc_gpuTimestamps_end(state, state->renderPass);
+		state->renderPass = VILC_GPU_TIMESTAMPS_NONE;
+	}
+}
+#endif /* defined(VK_VERSION_1_2) */
+
+#if defined(VK_VERSION_1_3)
+VILC_LAYER_NEXT(vilc_gpuTimestamps, vkCmdBeginRendering)
+VILC_LAYER_NEXT(vilc_gpuTimestamps, vkCmdEndRendering)
+VILC_LAYER_NEXT(vilc_gpuTimestamps, vkQueueSubmit2)
+
+static VKAPI_ATTR void VKAPI_CALL vilc_gpuTimestamps_vkCmdBeginRendering(VkCommandBuffer commandBuffer, const VkRenderingInfo* pRenderingInfo)
+{
+	VilcGpuTimestampsCommandBuffer* state = vilc_gpuTimestamps_recording(commandBuffer);
+
+	/* nothing may be recorded between suspended and resumed render pass instances */
+	if (state && !(pRenderingInfo->flags & (VK_RENDERING_SUSPENDING_BIT | VK_RENDERING_RESUMING_BIT)))
+		state->renderPass = vilc_gpuTimestamps_begin(state, VILC_GPU_TIMING_RENDERING, NULL);
+	vilc_gpuTimestamps_next_vkCmdBeginRendering(commandBuffer, pRenderingInfo);
+	if (state)
+		state->inRenderPass = 1;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_gpuTimestamps_vkCmdEndRendering(VkCommandBuffer commandBuffer)
+{
+	VilcGpuTimestampsCommandBuffer* state = vilc_gpuTimestamps_recording(commandBuffer);
+
+	vilc_gpuTimestamps_next_vkCmdEndRendering(commandBuffer);
+	if (state)
+	{
+		state->inRenderPass = 0;
+		vilc_gpuTimestamps_end(state, state->renderPass);
+		state->renderPass = VILC_GPU_TIMESTAMPS_NONE;
+	}
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_gpuTimestamps_vkQueueSubmit2(VkQueue queue, uint32_t submitCount, const VkSubmitInfo2* pSubmits, VkFence fence)
+{
+	VkResult result = vilc_gpuTimestamps_next_vkQueueSubmit2(queue, submitCount, pSubmits, fence);
+	uint32_t internalFence = VILC_GPU_TIMESTAMPS_NONE, i, j;
+
+	if (result != VK_SUCCESS)
+		return result;
+
+	pthread_mutex_lock(&vilc_gpuTimestamps_mutex);
+	for (i = 0; i < submitCount; ++i)
+		for (j = 0; j < pSubmits[i].commandBufferInfoCount; ++j)
+			vilc_gpuTimestamps_track(pSubmits[i].pCommandBufferInfos[j].commandBuffer, &internalFence);
+	vilc_gpuTimestamps_signal(queue, internalFence);
+	pthread_mutex_unlock(&vilc_gpuTimestamps_mutex);
+
+	return result;
+}
+#endif /* defined(VK_VERSION_1_3) */
+
+#if defined(VK_KHR_create_renderpass2)
+VILC_LAYER_NEXT(vilc_gpuTimestamps, vkCmdBeginRenderPass2KHR)
+VILC_LAYER_NEXT(vilc_gpuTimestamps, vkCmdEndRenderPass2KHR)
+
+static VKAPI_ATTR void VKAPI_CALL vilc_gpuTimestamps_vkCmdBeginRenderPass2KHR(VkCommandBuffer commandBuffer, const VkRenderPassBeginInfo* pRenderPassBegin, const VkSubpassBeginInfoKHR* pSubpassBeginInfo)
+{
+	VilcGpuTimestampsCommandBuffer* state = vilc_gpuTimestamps_recording(commandBuffer);
+
+	if (state)
+		state->renderPass = vilc_gpuTimestamps_begin(state, VILC_GPU_TIMING_RENDER_PASS, NULL);
+	vilc_gpuTimestamps_next_vkCmdBeginRenderPass2KHR(commandBuffer, pRenderPassBegin, pSubpassBeginInfo);
+	if (state)
+		state->inRenderPass = 1;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_gpuTimestamps_vkCmdEndRenderPass2KHR(VkCommandBuffer commandBuffer, const VkSubpassEndInfoKHR* pSubpassEndInfo)
+{
+	VilcGpuTimestampsCommandBuffer* state = vilc_gpuTimestamps_recording(commandBuffer);
+
+	vilc_gpuTimestamps_next_vkCmdEndRenderPass2KHR(commandBuffer, pSubpassEndInfo);
+	if (state)
+	{
+		state->inRenderPass = 0;
+		vilc_gpuTimestamps_end(state, state->renderPass);
+		state->renderPass = VILC_GPU_TIMESTAMPS_NONE;
+	}
+}
+#endif /* defined(VK_KHR_create_renderpass2) */
+
+#if defined(VK_KHR_device_group)
+VILC_LAYER_NEXT(vilc_gpuTimestamps, vkCmdDispatchBaseKHR)
+
+static VKAPI_ATTR void VKAPI_CALL vilc_gpuTimestamps_vkCmdDispatchBaseKHR(VkCommandBuffer commandBuffer, uint32_t baseGroupX, uint32_t baseGroupY, uint32_t baseGroupZ, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+{
+	VilcGpuTimestampsCommandBuffer* state = vilc_gpuTimestamps_recording(commandBuffer);
+	uint32_t region = state ? vilc_gpuTimestamps_begin(state, VILC_GPU_TIMING_DISPATCH, NULL) : VILC_GPU_TIMESTAMPS_NONE;
+
+	vilc_gpuTimestamps_next_vkCmdDispatchBaseKHR(commandBuffer, baseGroupX, baseGroupY, baseGroupZ, groupCountX, groupCountY, groupCountZ);
+	if (state)
+		vilc_gpuTimestamps_end(state, region);
+}
+#endif /* defined(VK_KHR_device_group) */
+
+#if defined(VK_KHR_dynamic_rendering)
+VILC_LAYER_NEXT(vilc_gpuTimestamps, vkCmdBeginRenderingKHR)
+VILC_LAYER_NEXT(vilc_gpuTimestamps, vkCmdEndRenderingKHR)
+
+static VKAPI_ATTR void VKAPI_CALL vilc_gpuTimestamps_vkCmdBeginRenderingKHR(VkCommandBuffer commandBuffer, const VkRenderingInfoKHR* pRenderingInfo)
+{
+	VilcGpuTimestampsCommandBuffer* state = vilc_gpuTimestamps_recording(commandBuffer);
+
+	if (state && !(pRenderingInfo->flags & (VK_RENDERING_SUSPENDING_BIT_KHR | VK_RENDERING_RESUMING_BIT_KHR)))
+		state->renderPass = vilc_gpuTimestamps_begin(state, VILC_GPU_TIMING_RENDERING, NULL);
+	vilc_gpuTimestamps_next_vkCmdBeginRenderingKHR(commandBuffer, pRenderingInfo);
+	if (state)
+		state->inRenderPass = 1;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_gpuTimestamps_vkCmdEndRenderingKHR(VkCommandBuffer commandBuffer)
+{
+	VilcGpuTimestampsCommandBuffer* state = vilc_gpuTimestamps_recording(commandBuffer);
+
+	vilc_gpuTimestamps_next_vkCmdEndRenderingKHR(commandBuffer);
+	if (state)
+	{
+		state->inRenderPass = 0;
+		vilc_gpuTimestamps_end(state, state->renderPass);
+		state->renderPass = VILC_GPU_TIMESTAMPS_NONE;
+	}
+}
+#endif /* defined(VK_KHR_dynamic_rendering) */
+
+#if defined(VK_KHR_synchronization2)
+VILC_LAYER_NEXT(vilc_gpuTimestamps, vkQueueSubmit2KHR)
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_gpuTimestamps_vkQueueSubmit2KHR(VkQueue queue, uint32_t submitCount, const VkSubmitInfo2KHR* pSubmits, VkFence fence)
+{
+	VkResult result = vilc_gpuTimestamps_next_vkQueueSubmit2KHR(queue, submitCount, pSubmits, fence);
+	uint32_t internalFence = VILC_GPU_TIMESTAMPS_NONE, i, j;
+
+	if (result != VK_SUCCESS)
+		return result;
+
+	pthread_mutex_lock(&vilc_gpuTimestamps_mutex);
+	for (i = 0; i < submitCount; ++i)
+		for (j = 0; j < pSubmits[i].commandBufferInfoCount; ++j)
+			vilc_gpuTimestamps_track(pSubmits[i].pCommandBufferInfos[j].commandBuffer, &internalFence);
+	vilc_gpuTimestamps_signal(queue, internalFence);
+	pthread_mutex_unlock(&vilc_gpuTimestamps_mutex);
+
+	return result;
+}
+#endif /* defined(VK_KHR_synchronization2) */
+
+#if defined(VK_KHR_swapchain)
+VILC_LAYER_NEXT(vilc_gpuTimestamps, vkQueuePresentKHR)
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_gpuTimestamps_vkQueuePresentKHR(VkQueue queue, const VkPresentInfoKHR* pPresentInfo)
+{
+	pthread_mutex_lock(&vilc_gpuTimestamps_mutex);
+	vilc_gpuTimestamps_poll();
+	pthread_mutex_unlock(&vilc_gpuTimestamps_mutex);
+
+	return vilc_gpuTimestamps_next_vkQueuePresentKHR(queue, pPresentInfo);
+}
+#endif /* defined(VK_KHR_swapchain) */
+
+#if defined(VK_EXT_debug_utils)
+VILC_LAYER_NEXT(vilc_gpuTimestamps, vkCmdBeginDebugUtilsLabelEXT)
+VILC_LAYER_NEXT(vilc_gpuTimestamps, vkCmdEndDebugUtilsLabelEXT)
+
+/* Labels are only timed outside of render passes, where timestamp writes need no per-view queries */
+static VKAPI_ATTR void VKAPI_CALL vilc_gpuTimestamps_vkCmdBeginDebugUtilsLabelEXT(VkCommandBuffer commandBuffer, const VkDebugUtilsLabelEXT* pLabelInfo)
+{
+	VilcGpuTimestampsCommandBuffer* state = vilc_gpuTimestamps_recording(commandBuffer);
+
+	if (state && state->labelDepth == VILC_GPU_TIMESTAMPS_LABEL_DEPTH)
+		state->labelOverflow++;
+	else if (state)
+		state->labels[state->labelDepth++] = state->inRenderPass ? VILC_GPU_TIMESTAMPS_NONE : vilc_gpuTimestamps_begin(state, VILC_GPU_TIMING_LABEL, pLabelInfo->pLabelName);
+	vilc_gpuTimestamps_next_vkCmdBeginDebugUtilsLabelEXT(commandBuffer, pLabelInfo);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_gpuTimestamps_vkCmdEndDebugUtilsLabelEXT(VkCommandBuffer commandBuffer)
+{
+	VilcGpuTimestampsCommandBuffer* state = vilc_gpuTimestamps_recording(commandBuffer);
+
+	vilc_gpuTimestamps_next_vkCmdEndDebugUtilsLabelEXT(commandBuffer);
+	if (state && state->labelOverflow)
+		state->labelOverflow--;
+	else if (state && state->labelDepth)
+	{
+		uint32_t region = state->labels[--state->labelDepth];
+		if (region != VILC_GPU_TIMESTAMPS_NONE && state->inRenderPass)
+			VILC_ATOMIC_ADD(&vilc_gpuTimestamps_dropped, 1);
+		else
+			vilc_gpuTimestamps_end(state, region);
+	}
+}
+#endif /* defined(VK_EXT_debug_utils) */
+
+static void vilc_gpuTimestamps_installInstance(void)
+{
+	VILC_LAYER_HOOK(vilc_gpuTimestamps, vkCreateDevice)
+#if defined(VK_EXT_debug_utils)
+	VILC_LAYER_HOOK(vilc_gpuTimestamps, vkCmdBeginDebugUtilsLabelEXT)
+	VILC_LAYER_HOOK(vilc_gpuTimestamps, vkCmdEndDebugUtilsLabelEXT)
+#endif
+}
+
+static void vilc_gpuTimestamps_installDevice(void)
+{
+#if defined(VK_KHR_synchronization2)
+	vilc_gpuTimestamps_writeTimestamp2 = NULL;
+#if defined(VK_VERSION_1_3)
+	if (vilc_gpuTimestamps_sync2 && !vilc_gpuTimestamps_sync2KHR)
+		vilc_gpuTimestamps_writeTimestamp2 = vilc_device.vkCmdWriteTimestamp2;
+#endif
+	if (vilc_gpuTimestamps_sync2 && vilc_gpuTimestamps_sync2KHR)
+		vilc_gpuTimestamps_writeTimestamp2 = vilc_device.vkCmdWriteTimestamp2KHR;
+#endif
+#if defined(VK_KHR_calibrated_timestamps)
+	vilc_gpuTimestamps_getCalibratedTimestamps = vilc_gpuTimestamps_calibrationKHR ? vilc_device.vkGetCalibratedTimestampsKHR : vilc_gpuTimestamps_calibrationEXT ? vilc_device.vkGetCalibratedTimestampsEXT : NULL;
+#endif
+
+	VILC_LAYER_HOOK(vilc_gpuTimestamps, vkDestroyDevice)
+	VILC_LAYER_HOOK(vilc_gpuTimestamps, vkCreateCommandPool)
+	VILC_LAYER_HOOK(vilc_gpuTimestamps, vkDestroyCommandPool)
+	VILC_LAYER_HOOK(vilc_gpuTimestamps, vkResetCommandPool)
+	VILC_LAYER_HOOK(vilc_gpuTimestamps, vkAllocateCommandBuffers)
+	VILC_LAYER_HOOK(vilc_gpuTimestamps, vkFreeCommandBuffers)
+	VILC_LAYER_HOOK(vilc_gpuTimestamps, vkBeginCommandBuffer)
+	VILC_LAYER_HOOK(vilc_gpuTimestamps, vkEndCommandBuffer)
+	VILC_LAYER_HOOK(vilc_gpuTimestamps, vkResetCommandBuffer)
+	VILC_LAYER_HOOK(vilc_gpuTimestamps, vkCmdBeginRenderPass)
+	VILC_LAYER_HOOK(vilc_gpuTimestamps, vkCmdEndRenderPass)
+	VILC_LAYER_HOOK(vilc_gpuTimestamps, vkCmdDispatch)
+	VILC_LAYER_HOOK(vilc_gpuTimestamps, vkCmdDispatchIndirect)
+	VILC_LAYER_HOOK(vilc_gpuTimestamps, vkQueueSubmit)
+#if defined(VK_VERSION_1_1)
+	VILC_LAYER_HOOK(vilc_gpuTimestamps, vkCmdDispatchBase)
+#endif
+#if defined(VK_VERSION_1_2)
+	VILC_LAYER_HOOK(vilc_gpuTimestamps, vkCmdBeginRenderPass2)
+	VILC_LAYER_HOOK(vilc_gpuTimestamps, vkCmdEndRenderPass2)
+#endif
+#if defined(VK_VERSION_1_3)
+	VILC_LAYER_HOOK(vilc_gpuTimestamps, vkCmdBeginRendering)
+	VILC_LAYER_HOOK(vilc_gpuTimestamps, vkCmdEndRendering)
+	VILC_LAYER_HOOK(vilc_gpuTimestamps, vkQueueSubmit2)
+#endif
+#if defined(VK_KHR_create_renderpass2)
+	VILC_LAYER_HOOK(vilc_gpuTimestamps, vkCmdBeginRenderPass2KHR)
+	VILC_LAYER_HOOK(vilc_gpuTimestamps, vkCmdEndRenderPass2KHR)
+#endif
+#if defined(VK_KHR_device_group)
+	VILC_LAYER_HOOK(vilc_gpuTimestamps, vkCmdDispatchBaseKHR)
+#endif
+#if defined(VK_KHR_dynamic_rendering)
+	VILC_LAYER_HOOK(vilc_gpuTimestamps, vkCmdBeginRenderingKHR)
+	VILC_LAYER_HOOK(vilc_gpuTimestamps, vkCmdEndRenderingKHR)
+#endif
+#if defined(VK_KHR_synchronization2)
+	VILC_LAYER_HOOK(vilc_gpuTimestamps, vkQueueSubmit2KHR)
+#endif
+#if defined(VK_KHR_swapchain)
+	VILC_LAYER_HOOK(vilc_gpuTimestamps, vkQueuePresentKHR)
+#endif
+}
+#endif /* VILC_GPU_TIMESTAMPS */
+
+#if defined(VOLK_IN_LOADERS_CLOTH) && defined(VILC_HOST_MEMORY_STATS)
+/* Host memory accounting: the trampolines replace pAllocator with callbacks that count every driver allocation per
+ * VkSystemAllocationScope and per object type, then forward to the application callbacks or, for pAllocator == NULL,
+ * to the C heap. A header in front of each block remembers what to subtract when the driver frees it.
+ * One set of callbacks exists per object type and application allocator, so the callbacks passed at destruction are
+ * the ones passed at creation, as Vulkan requires. They are never freed since the driver may keep them.
+ */
+#define VILC_HOST_ALLOCATOR(pAllocator, objectType) vilc_hostMemory_allocator(pAllocator, objectType)
+
+typedef struct VilcHostMemoryHeader
+{
+	uint64_t size;
+	uint32_t offset;
+	uint16_t scope;
+	uint16_t objectType; /* index into vilc_hostMemory_stats.objectTypes */
+} VilcHostMemoryHeader;
+
+typedef struct VilcHostMemoryAllocator
+{
+	VkAllocationCallbacks callbacks; /* passed to the driver; pUserData points back to the allocator */
+	VkAllocationCallbacks app; /* all NULL when the application passed no callbacks */
+	uint32_t objectType;
+	struct VilcHostMemoryAllocator* next;
+} VilcHostMemoryAllocator;
+
+static pthread_mutex_t vilc_hostMemory_mutex = PTHREAD_MUTEX_INITIALIZER;
+static VilcHostMemoryAllocator* vilc_hostMemory_allocators[VILC_HOST_MEMORY_OBJECT_TYPE_COUNT]; /* per stats slot */
+static VilcHostMemoryStats vilc_hostMemory_stats;
+
+VILC_LAYER_NEXT(vilc_hostMemory, vkDestroyInstance)
+
+static void vilc_hostMemory_count(VilcHostMemoryCounter* counter, uint64_t size, int sign)
+{
+	if (sign > 0)
+	{
+		VILC_ATOMIC_ADD(&counter->allocationCount, 1);
+		VILC_ATOMIC_ADD(&counter->totalAllocationCount, 1);
+		VILC_ATOMIC_MAX(&counter->peakBytes, VILC_ATOMIC_ADD(&counter->bytes, size));
+	}
+	else
+	{
+		VILC_ATOMIC_ADD(&counter->bytes, (uint64_t)0 - size);
+		VILC_ATOMIC_ADD(&counter->allocationCount, (uint64_t)0 - 1);
+	}
+}
+
+static void vilc_hostMemory_account(const VilcHostMemoryHeader* header, int sign)
+{
+	vilc_hostMemory_count(&vilc_hostMemory_stats.total, header->size, sign);
+	vilc_hostMemory_count(&vilc_hostMemory_stats.scopes[header->scope], header->size, sign);
+	vilc_hostMemory_count(&vilc_hostMemory_stats.objectTypes[header->objectType].counter, header->size, sign);
+}
+
+/* The header ends right before the returned block; blocks are at least 8-aligned so the header is too */
+static size_t vilc_hostMemory_alignment(size_t alignment)
+{
+	return alignment > 8 ? alignment : 8;
+}
+
+static void* vilc_hostMemory_block(VilcHostMemoryAllocator* allocator, char* base, size_t offset, size_t size, VkSystemAllocationScope scope)
+{
+	VilcHostMemoryHeader* header;
+
+	if (!base)
+		return NULL;
+
+	header = (VilcHostMemoryHeader*)(base + offset) - 1;
+	header->size = size;
+	header->offset = (uint32_t)offset;
+	header->scope = (uint16_t)(scope < VILC_HOST_MEMORY_SCOPE_COUNT ? scope : VK_SYSTEM_ALLOCATION_SCOPE_OBJECT);
+	header->objectType = (uint16_t)allocator->objectType;
+	vilc_hostMemory_account(header, 1);
+
+	return base + offset;
+}
+
+static void* VKAPI_PTR vilc_hostMemory_allocation(void* pUserData, size_t size, size_t alignment, VkSystemAllocationScope scope)
+{
+	VilcHostMemoryAllocator* allocator = (VilcHostMemoryAllocator*)pUserData;
+	size_t offset = alignment > sizeof(VilcHostMemoryHeader) ? alignment : sizeof(VilcHostMemoryHeader);
+	void* base = NULL;
+
+	if (allocator->app.pfnAllocation)
+		base = allocator->app.pfnAllocation(allocator->app.pUserData, offset + size, vilc_hostMemory_alignment(alignment), scope);
+	else if (posix_memalign(&base, vilc_hostMemory_alignment(alignment), offset + size) != 0)
+		base = NULL;
+
+	return vilc_hostMemory_block(allocator, (char*)base, offset, size, scope);
+}
+
+static void VKAPI_PTR vilc_hostMemory_free(void* pUserData, void* pMemory)
+{
+	VilcHostMemoryAllocator* allocator = (VilcHostMemoryAllocator*)pUserData;
+	VilcHostMemoryHeader* header = (VilcHostMemoryHeader*)pMemory - 1;
+
+	if (!pMemory)
+		return;
+
+	vilc_hostMemory_account(header, -1);
+	if (allocator->app.pfnFree)
+		allocator->app.pfnFree(allocator->app.pUserData, (char*)pMemory - header->offset);
+	else
+		free((char*)pMemory - header->offset);
+}
+
+static void* VKAPI_PTR vilc_hostMemory_reallocation(void* pUserData, void* pOriginal, size_t size, size_t alignment, VkSystemAllocationScope scope)
+{
+	VilcHostMemoryAllocator* allocator = (VilcHostMemoryAllocator*)pUserData;
+	VilcHostMemoryHeader original;
+	void* base = NULL;
+
+	if (!pOriginal)
+		return vilc_hostMemory_allocation(pUserData, size, alignment, scope);
+
+	if (!size)
+	{
+		vilc_hostMemory_free(pUserData, pOriginal);
+		return NULL;
+	}
+
+	/* reallocation keeps the alignment of the original allocation, and with it the header offset */
+	original = *((VilcHostMemoryHeader*)pOriginal - 1);
+	if (allocator->app.pfnReallocation)
+		base = allocator->app.pfnReallocation(allocator->app.pUserData, (char*)pOriginal - original.offset, original.offset + size, vilc_hostMemory_alignment(alignment), scope);
+	else if (posix_memalign(&base, vilc_hostMemory_alignment(alignment), original.offset + size) == 0)
+	{
+		memcpy(base, (char*)pOriginal - original.offset, original.offset + (size < original.size ? size : (size_t)original.size));
+		free((char*)pOriginal - original.offset);
+	}
+	else
+		base = NULL;
+
+	if (!base)
+		return NULL;
+
+	vilc_hostMemory_account(&original, -1);
+	return vilc_hostMemory_block(allocator, (char*)base, original.offset, size, scope);
+}
+
+static void VKAPI_PTR vilc_hostMemory_internalAllocation(void* pUserData, size_t size, VkInternalAllocationType allocationType, VkSystemAllocationScope scope)
+{
+	VilcHostMemoryAllocator* allocator = (VilcHostMemoryAllocator*)pUserData;
+
+	if (scope < VILC_HOST_MEMORY_SCOPE_COUNT)
+		vilc_hostMemory_count(&vilc_hostMemory_stats.internalScopes[scope], size, 1);
+	if (allocator->app.pfnInternalAllocation)
+		allocator->app.pfnInternalAllocation(allocator->app.pUserData, size, allocationType, scope);
+}
+
+static void VKAPI_PTR vilc_hostMemory_internalFree(void* pUserData, size_t size, VkInternalAllocationType allocationType, VkSystemAllocationScope scope)
+{
+	VilcHostMemoryAllocator* allocator = (VilcHostMemoryAllocator*)pUserData;
+
+	if (scope < VILC_HOST_MEMORY_SCOPE_COUNT)
+		vilc_hostMemory_count(&vilc_hostMemory_stats.internalScopes[scope], size, -1);
+	if (allocator->app.pfnInternalFree)
+		allocator->app.pfnInternalFree(allocator->app.pUserData, size, allocationType, scope);
+}
+
+/* Returns the index of the stats slot of objectType, or VILC_HOST_MEMORY_OBJECT_TYPE_COUNT when all are taken */
+static uint32_t vilc_hostMemory_objectType(VkObjectType objectType)
+{
+	uint32_t count = vilc_hostMemory_stats.objectTypeCount, i;
+
+	for (i = 0; i < count; ++i)
+		if (vilc_hostMemory_stats.objectTypes[i].objectType == objectType)
+			return i;
+
+	if (count < VILC_HOST_MEMORY_OBJECT_TYPE_COUNT)
+	{
+		vilc_hostMemory_stats.objectTypes[count].objectType = objectType;
+		VILC_ATOMIC_STORE(&vilc_hostMemory_stats.objectTypeCount, count + 1);
+	}
+
+	return count;
+}
+
+static const VkAllocationCallbacks* vilc_hostMemory_allocator(const VkAllocationCallbacks* pAllocator, VkObjectType objectType)
+{
+	VilcHostMemoryAllocator* allocator = NULL;
+	VkAllocationCallbacks app;
+	uint32_t index;
+
+	memset(&app, 0, sizeof(app));
+	if (pAllocator)
+		app = *pAllocator;
+
+	pthread_mutex_lock(&vilc_hostMemory_mutex);
+
+	index = vilc_hostMemory_objectType(objectType);
+	if (index < VILC_HOST_MEMORY_OBJECT_TYPE_COUNT)
+	{
+		for (allocator = vilc_hostMemory_allocators[index]; allocator && memcmp(&allocator->app, &app, sizeof(app)) != 0; allocator = allocator->next)
+			;
+
+		if (!allocator && (allocator = (VilcHostMemoryAllocator*)calloc(1, sizeof(VilcHostMemoryAllocator))) != NULL)
+		{
+			allocator->callbacks.pUserData = allocator;
+			allocator->callbacks.pfnAllocation = vilc_hostMemory_allocation;
+			allocator->callbacks.pfnReallocation = vilc_hostMemory_reallocation;
+			allocator->callbacks.pfnFree = vilc_hostMemory_free;
+			allocator->callbacks.pfnInternalAllocation = vilc_hostMemory_internalAllocation;
+			allocator->callbacks.pfnInternalFree = vilc_hostMemory_internalFree;
+			allocator->app = app;
+			allocator->objectType = index;
+			allocator->next = vilc_hostMemory_allocators[index];
+			vilc_hostMemory_allocators[index] = allocator;
+		}
+	}
+
+	pthread_mutex_unlock(&vilc_hostMemory_mutex);
+
+	/* without a slot the call goes through unaccounted */
+	return allocator ? &allocator->callbacks : pAllocator;
+}
+
+static void vilc_hostMemory_load(VilcHostMemoryCounter* counter, VilcHostMemoryCounter* source)
+{
+	counter->bytes = VILC_ATOMIC_LOAD(&source->bytes);
+	counter->peakBytes = VILC_ATOMIC_LOAD(&source->peakBytes);
+	counter->allocationCount = VILC_ATOMIC_LOAD(&source->allocationCount);
+	counter->totalAllocationCount = VILC_ATOMIC_LOAD(&source->totalAllocationCount);
+}
+
+void vilcGetHostMemoryStats(VilcHostMemoryStats* stats)
+{
+	uint32_t i;
+
+	memset(stats, 0, sizeof(*stats));
+	vilc_hostMemory_load(&stats->total, &vilc_hostMemory_stats.total);
+	for (i = 0; i < VILC_HOST_MEMORY_SCOPE_COUNT; ++i)
+	{
+		vilc_hostMemory_load(&stats->scopes[i], &vilc_hostMemory_stats.scopes[i]);
+		vilc_hostMemory_load(&stats->internalScopes[i], &vilc_hostMemory_stats.internalScopes[i]);
+	}
+
+	pthread_mutex_lock(&vilc_hostMemory_mutex);
+	stats->objectTypeCount = vilc_hostMemory_stats.objectTypeCount;
+	for (i = 0; i < stats->objectTypeCount; ++i)
+	{
+		stats->objectTypes[i].objectType = vilc_hostMemory_stats.objectTypes[i].objectType;
+		vilc_hostMemory_load(&stats->objectTypes[i].counter, &vilc_hostMemory_stats.objectTypes[i].counter);
+	}
+	pthread_mutex_unlock(&vilc_hostMemory_mutex);
+}
+
+static void vilc_hostMemory_print(void)
+{
+	VilcHostMemoryStats stats;
+	uint32_t i;
+
+	vilcGetHostMemoryStats(&stats);
+	fprintf(stderr, "vilc: host memory: %llu bytes in %llu allocations live, peak %llu bytes, %llu allocations total\n",
+	    (unsigned long long)stats.total.bytes, (unsigned long long)stats.total.allocationCount,
+	    (unsigned long long)stats.total.peakBytes, (unsigned long long)stats.total.totalAllocationCount);
+
+	for (i = 0; i < stats.objectTypeCount; ++i)
+	{
+		const VilcHostMemoryCounter* counter = &stats.objectTypes[i].counter;
+		if (!counter->totalAllocationCount)
+			continue;
+
+		fprintf(stderr, "vilc:   object type %-10d live %10llu bytes %8llu allocations peak %10llu bytes total %8llu allocations\n",
+		    (int)stats.objectTypes[i].objectType, (unsigned long long)counter->bytes, (unsigned long long)counter->allocationCount,
+		    (unsigned long long)counter->peakBytes, (unsigned long long)counter->totalAllocationCount);
+	}
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_hostMemory_vkDestroyInstance(VkInstance instance, const VkAllocationCallbacks* pAllocator)
+{
+	vilc_hostMemory_next_vkDestroyInstance(instance, pAllocator);
+	/* after the driver freed the instance, anything left is leaked by the application or the driver */
+	vilc_hostMemory_print();
+}
+
+static void vilc_hostMemory_install(void)
+{
+	VILC_LAYER_HOOK(vilc_hostMemory, vkDestroyInstance)
+}
+#endif /* VILC_HOST_MEMORY_STATS */
+
+#if defined(VOLK_IN_LOADERS_CLOTH) && defined(VILC_MEMORY_BUDGET)
+/* Device memory budget: per memory type and per heap counters of allocated and bound bytes, updated with atomics so
+ * that vilcGetMemoryBudget is only loads. Allocations and bound resources are remembered in handle maps, so frees and
+ * destroys subtract exactly what was added. With VK_EXT_memory_budget enabled, the driver budget is refreshed after
+ * every allocation and free and at every present.
+ */
+#define VILC_MEMORY_BUDGET_WARN_PERCENT 90
+
+typedef struct VilcMemoryBudgetEntry
+{
+	VkDeviceSize size;
+	uint32_t memoryType;
+	uint32_t dedicated;
+} VilcMemoryBudgetEntry;
+
+static pthread_mutex_t vilc_memoryBudget_mutex = PTHREAD_MUTEX_INITIALIZER;
+static VkDevice vilc_memoryBudget_device;
+static VkPhysicalDevice vilc_memoryBudget_physicalDevice;
+static VkPhysicalDeviceMemoryProperties vilc_memoryBudget_properties;
+static uint32_t vilc_memoryBudget_maxAllocationCount;
+static uint32_t vilc_memoryBudget_allocationCount;
+static VilcMemoryCounter vilc_memoryBudget_types[VK_MAX_MEMORY_TYPES];
+static VilcMemoryCounter vilc_memoryBudget_heaps[VK_MAX_MEMORY_HEAPS];
+static VkDeviceSize vilc_memoryBudget_heapBudget[VK_MAX_MEMORY_HEAPS];
+static VkDeviceSize vilc_memoryBudget_heapUsage[VK_MAX_MEMORY_HEAPS];
+static VilcHandleMap vilc_memoryBudget_memories;
+static VilcHandleMap vilc_memoryBudget_buffers;
+static VilcHandleMap vilc_memoryBudget_images;
+#if defined(VK_EXT_memory_budget) && defined(VK_VERSION_1_1)
+static PFN_vkGetPhysicalDeviceMemoryProperties2 vilc_memoryBudget_getProperties2;
+#endif
+
+VILC_LAYER_NEXT(vilc_memoryBudget, vkCreateDevice)
+VILC_LAYER_NEXT(vilc_memoryBudget, vkDestroyDevice)
+VILC_LAYER_NEXT(vilc_memoryBudget, vkAllocateMemory)
+VILC_LAYER_NEXT(vilc_memoryBudget, vkFreeMemory)
+VILC_LAYER_NEXT(vilc_memoryBudget, vkBindBufferMemory)
+VILC_LAYER_NEXT(vilc_memoryBudget, vkBindImageMemory)
+VILC_LAYER_NEXT(vilc_memoryBudget, vkDestroyBuffer)
+VILC_LAYER_NEXT(vilc_memoryBudget, vkDestroyImage)
+#if defined(VK_VERSION_1_1)
+VILC_LAYER_NEXT(vilc_memoryBudget, vkBindBufferMemory2)
+VILC_LAYER_NEXT(vilc_memoryBudget, vkBindImageMemory2)
+#endif
+#if defined(VK_KHR_bind_memory2)
+VILC_LAYER_NEXT(vilc_memoryBudget, vkBindBufferMemory2KHR)
+VILC_LAYER_NEXT(vilc_memoryBudget, vkBindImageMemory2KHR)
+#endif
+#if defined(VK_KHR_swapchain)
+VILC_LAYER_NEXT(vilc_memoryBudget, vkQueuePresentKHR)
+#endif
+
+static void vilc_memoryBudget_refresh(void)
+{
+#if defined(VK_EXT_memory_budget) && defined(VK_VERSION_1_1)
+	VkPhysicalDeviceMemoryBudgetPropertiesEXT budget;
+	VkPhysicalDeviceMemoryProperties2 properties;
+	uint32_t i;
+
+	if (!vilc_memoryBudget_getProperties2)
+		return;
+
+	memset(&budget, 0, sizeof(budget));
+	budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+	memset(&properties, 0, sizeof(properties));
+	properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+	properties.pNext = &budget;
+	vilc_memoryBudget_getProperties2(vilc_memoryBudget_physicalDevice, &properties);
+
+	for (i = 0; i < VK_MAX_MEMORY_HEAPS; ++i)
+	{
+		VILC_ATOMIC_STORE(&vilc_memoryBudget_heapBudget[i], budget.heapBudget[i]);
+		VILC_ATOMIC_STORE(&vilc_memoryBudget_heapUsage[i], budget.heapUsage[i]);
+	}
+#endif
+}
+
+static void vilc_memoryBudget_setup(VkPhysicalDevice physicalDevice, const VkDeviceCreateInfo* pCreateInfo, VkDevice device)
+{
+	VkPhysicalDeviceProperties properties;
+
+	vilc_instance.vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+	vilc_instance.vkGetPhysicalDeviceMemoryProperties(physicalDevice, &vilc_memoryBudget_properties);
+
+	vilc_memoryBudget_device = device;
+	vilc_memoryBudget_physicalDevice = physicalDevice;
+	vilc_memoryBudget_maxAllocationCount = properties.limits.maxMemoryAllocationCount;
+	VILC_ATOMIC_STORE(&vilc_memoryBudget_allocationCount, 0);
+	memset(vilc_memoryBudget_types, 0, sizeof(vilc_memoryBudget_types));
+	memset(vilc_memoryBudget_heaps, 0, sizeof(vilc_memoryBudget_heaps));
+
+#if defined(VK_EXT_memory_budget) && defined(VK_VERSION_1_1)
+	vilc_memoryBudget_getProperties2 = NULL;
+	if (vilc_hasDeviceExtension(pCreateInfo, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME))
+	{
+		if (properties.apiVersion >= VK_API_VERSION_1_1)
+			vilc_memoryBudget_getProperties2 = vilc_instance.vkGetPhysicalDeviceMemoryProperties2;
+#if defined(VK_KHR_get_physical_device_properties2)
+		if (!vilc_memoryBudget_getProperties2)
+			vilc_memoryBudget_getProperties2 = vilc_instance.vkGetPhysicalDeviceMemoryProperties2KHR;
+#endif
+	}
+	vilc_memoryBudget_refresh();
+#endif
+}
+
+static uint32_t vilc_memoryBudget_dedicated(const void* pNext)
+{
+	const VkBaseInStructure* next;
+
+	for (next = (const VkBaseInStructure*)pNext; next; next = next->pNext)
+	{
+#if defined(VK_VERSION_1_1)
+		if (next->sType == VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO)
+			return 1;
+#elif defined(VK_KHR_dedicated_allocation)
+		if (next->sType == VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO_KHR)
+			return 1;
+#endif
+	}
+	return 0;
+}
+
+/* Counters of a memory type and of its heap move together */
+static void vilc_memoryBudget_count(const VilcMemoryBudgetEntry* entry, int sign)
+{
+	VilcMemoryCounter* counters[2];
+	uint32_t i;
+
+	counters[0] = &vilc_memoryBudget_types[entry->memoryType];
+	counters[1] = &vilc_memoryBudget_heaps[vilc_memoryBudget_properties.memoryTypes[entry->memoryType].heapIndex];
+
+	for (i = 0; i < 2; ++i)
+	{
+		if (sign > 0)
+		{
+			VILC_ATOMIC_MAX(&counters[i]->peakAllocatedBytes, VILC_ATOMIC_ADD(&counters[i]->allocatedBytes, entry->size));
+			VILC_ATOMIC_ADD(&counters[i]->allocationCount, 1);
+		}
+		else
+		{
+			VILC_ATOMIC_ADD(&counters[i]->allocatedBytes, (uint64_t)0 - entry->size);
+			VILC_ATOMIC_ADD(&counters[i]->allocationCount, (uint32_t)0 - 1);
+		}
+		if (entry->dedicated)
+			VILC_ATOMIC_ADD(&counters[i]->dedicatedAllocationCount, sign > 0 ? 1 : (uint32_t)0 - 1);
+	}
+}
+
+static void vilc_memoryBudget_countBound(const VilcMemoryBudgetEntry* entry, int sign)
+{
+	VilcMemoryCounter* counters[2];
+	uint32_t i;
+
+	counters[0] = &vilc_memoryBudget_types[entry->memoryType];
+	counters[1] = &vilc_memoryBudget_heaps[vilc_memoryBudget_properties.memoryTypes[entry->memoryType].heapIndex];
+
+	for (i = 0; i < 2; ++i)
+	{
+		VILC_ATOMIC_ADD(&counters[i]->boundBytes, sign > 0 ? entry->size : (uint64_t)0 - entry->size);
+		VILC_ATOMIC_ADD(&counters[i]->boundResourceCount, sign > 0 ? 1 : (uint32_t)0 - 1);
+	}
+}
+
+/* Remembers a buffer or image bound to memory with the size of its memory requirements */
+static void vilc_memoryBudget_bind(VilcHandleMap* resources, uint64_t key, VkDeviceMemory memory, VkDeviceSize size)
+{
+	VilcMemoryBudgetEntry* allocation;
+	VilcMemoryBudgetEntry* entry = NULL;
+
+	pthread_mutex_lock(&vilc_memoryBudget_mutex);
+	allocation = (VilcMemoryBudgetEntry*)vilc_mapFind(&vilc_memoryBudget_memories, VILC_OBJECT_KEY(memory));
+	/* planes of disjoint images are bound separately; the first bind accounts for the whole image */
+	if (allocation && !vilc_mapFind(resources, key) && (entry = (VilcMemoryBudgetEntry*)malloc(sizeof(VilcMemoryBudgetEntry))) != NULL)
+	{
+		entry->size = size;
+		entry->memoryType = allocation->memoryType;
+		entry->dedicated = 0;
+		if (!vilc_mapInsert(resources, key, entry))
+		{
+			free(entry);
+			entry = NULL;
+		}
+	}
+	pthread_mutex_unlock(&vilc_memoryBudget_mutex);
+
+	if (entry)
+		vilc_memoryBudget_countBound(entry, 1);
+}
+
+static void vilc_memoryBudget_unbind(VilcHandleMap* resources, uint64_t key)
+{
+	VilcMemoryBudgetEntry* entry;
+
+	pthread_mutex_lock(&vilc_memoryBudget_mutex);
+	entry = (VilcMemoryBudgetEntry*)vilc_mapRemove(resources, key);
+	pthread_mutex_unlock(&vilc_memoryBudget_mutex);
+
+	if (entry)
+	{
+		vilc_memoryBudget_countBound(entry, -1);
+		free(entry);
+	}
+}
+
+static void vilc_memoryBudget_bindBuffer(VkDevice device, VkBuffer buffer, VkDeviceMemory memory)
+{
+	VkMemoryRequirements requirements;
+
+	if (device != vilc_memoryBudget_device)
+		return;
+
+	vilc_device.vkGetBufferMemoryRequirements(device, buffer, &requirements);
+	vilc_memoryBudget_bind(&vilc_memoryBudget_buffers, VILC_OBJECT_KEY(buffer), memory, requirements.size);
+}
+
+static void vilc_memoryBudget_bindImage(VkDevice device, VkImage image, VkDeviceMemory memory)
+{
+	VkMemoryRequirements requirements;
+
+	if (device != vilc_memoryBudget_device)
+		return;
+
+	vilc_device.vkGetImageMemoryRequirements(device, image, &requirements);
+	vilc_memoryBudget_bind(&vilc_memoryBudget_images, VILC_OBJECT_KEY(image), memory, requirements.size);
+}
+
+static void vilc_memoryBudget_freeEntries(VilcHandleMap* map)
+{
+	uint32_t i;
+	for (i = 0; i < map->capacity; ++i)
+		free(map->values[i]);
+	vilc_mapFree(map);
+}
+
+static void vilc_memoryBudget_loadCounter(VilcMemoryCounter* counter, VilcMemoryCounter* source)
+{
+	counter->allocatedBytes = VILC_ATOMIC_LOAD(&source->allocatedBytes);
+	counter->peakAllocatedBytes = VILC_ATOMIC_LOAD(&source->peakAllocatedBytes);
+	counter->boundBytes = VILC_ATOMIC_LOAD(&source->boundBytes);
+	counter->allocationCount = VILC_ATOMIC_LOAD(&source->allocationCount);
+	counter->dedicatedAllocationCount = VILC_ATOMIC_LOAD(&source->dedicatedAllocationCount);
+	counter->boundResourceCount = VILC_ATOMIC_LOAD(&source->boundResourceCount);
+}
+
+void vilcGetMemoryBudget(VilcMemoryBudget* budget)
+{
+	uint32_t i;
+
+	memset(budget, 0, sizeof(*budget));
+	budget->allocationCount = VILC_ATOMIC_LOAD(&vilc_memoryBudget_allocationCount);
+	budget->maxMemoryAllocationCount = vilc_memoryBudget_maxAllocationCount;
+	budget->memoryTypeCount = vilc_memoryBudget_properties.memoryTypeCount;
+	budget->memoryHeapCount = vilc_memoryBudget_properties.memoryHeapCount;
+#if defined(VK_EXT_memory_budget) && defined(VK_VERSION_1_1)
+	budget->driverBudget = vilc_memoryBudget_getProperties2 != NULL;
+#endif
+
+	for (i = 0; i < budget->memoryTypeCount; ++i)
+		vilc_memoryBudget_loadCounter(&budget->memoryTypes[i], &vilc_memoryBudget_types[i]);
+
+	for (i = 0; i < budget->memoryHeapCount; ++i)
+	{
+		VilcMemoryHeapBudget* heap = &budget->memoryHeaps[i];
+
+		vilc_memoryBudget_loadCounter(&heap->counter, &vilc_memoryBudget_heaps[i]);
+		heap->size = vilc_memoryBudget_properties.memoryHeaps[i].size;
+		heap->budget = budget->driverBudget ? VILC_ATOMIC_LOAD(&vilc_memoryBudget_heapBudget[i]) : heap->size / 10 * 8;
+		heap->usage = budget->driverBudget ? VILC_ATOMIC_LOAD(&vilc_memoryBudget_heapUsage[i]) : heap->counter.allocatedBytes;
+	}
+}
+
+static void vilc_memoryBudget_print(void)
+{
+	VilcMemoryBudget budget;
+	uint32_t i;
+
+	vilcGetMemoryBudget(&budget);
+	fprintf(stderr, "vilc: memory budget: %u allocations live (max %u)\n", budget.allocationCount, budget.maxMemoryAllocationCount);
+
+	for (i = 0; i < budget.memoryHeapCount; ++i)
+	{
+		const VilcMemoryHeapBudget* heap = &budget.memoryHeaps[i];
+		fprintf(stderr, "vilc:   heap %u: allocated %llu peak %llu bound %llu usage %llu budget %llu size %llu\n", i,
+		    (unsigned long long)heap->counter.allocatedBytes, (unsigned long long)heap->counter.peakAllocatedBytes,
+		    (unsigned long long)heap->counter.boundBytes, (unsigned long long)heap->usage, (unsigned long long)heap->budget,
+		    (unsigned long long)heap->size);
+	}
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_memoryBudget_vkCreateDevice(VkPhysicalDevice physicalDevice, const VkDeviceCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDevice* pDevice)
+{
+	VkResult result = vilc_memoryBudget_next_vkCreateDevice(physicalDevice, pCreateInfo, pAllocator, pDevice);
+	if (result == VK_SUCCESS)
+		vilc_memoryBudget_setup(physicalDevice, pCreateInfo, *pDevice);
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_memoryBudget_vkDestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator)
+{
+	if (device && device == vilc_memoryBudget_device)
+	{
+		vilc_memoryBudget_print();
+
+		pthread_mutex_lock(&vilc_memoryBudget_mutex);
+		vilc_memoryBudget_freeEntries(&vilc_memoryBudget_memories);
+		vilc_memoryBudget_freeEntries(&vilc_memoryBudget_buffers);
+		vilc_memoryBudget_freeEntries(&vilc_memoryBudget_images);
+		vilc_memoryBudget_device = VK_NULL_HANDLE;
+		pthread_mutex_unlock(&vilc_memoryBudget_mutex);
+	}
+
+	vilc_memoryBudget_next_vkDestroyDevice(device, pAllocator);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_memoryBudget_vkAllocateMemory(VkDevice device, const VkMemoryAllocateInfo* pAllocateInfo, const VkAllocationCallbacks* pAllocator, VkDeviceMemory* pMemory)
+{
+	VkResult result = vilc_memoryBudget_next_vkAllocateMemory(device, pAllocateInfo, pAllocator, pMemory);
+	VilcMemoryBudgetEntry* entry;
+	uint32_t count;
+
+	if (result != VK_SUCCESS || device != vilc_memoryBudget_device || pAllocateInfo->memoryTypeIndex >= vilc_memoryBudget_properties.memoryTypeCount)
+		return result;
+
+	entry = (VilcMemoryBudgetEntry*)malloc(sizeof(VilcMemoryBudgetEntry));
+	if (!entry)
+		return result;
+
+	entry->size = pAllocateInfo->allocationSize;
+	entry->memoryType = pAllocateInfo->memoryTypeIndex;
+	entry->dedicated = vilc_memoryBudget_dedicated(pAllocateInfo->pNext);
+
+	pthread_mutex_lock(&vilc_memoryBudget_mutex);
+	if (!vilc_mapInsert(&vilc_memoryBudget_memories, VILC_OBJECT_KEY(*pMemory), entry))
+	{
+		free(entry);
+		entry = NULL;
+	}
+	pthread_mutex_unlock(&vilc_memoryBudget_mutex);
+
+	if (entry)
+	{
+		vilc_memoryBudget_count(entry, 1);
+		count = VILC_ATOMIC_ADD(&vilc_memoryBudget_allocationCount, 1);
+		if ((uint64_t)count * 100 == (uint64_t)vilc_memoryBudget_maxAllocationCount * VILC_MEMORY_BUDGET_WARN_PERCENT)
+			fprintf(stderr, "vilc: memory budget: %u of maxMemoryAllocationCount %u allocations are live\n", count, vilc_memoryBudget_maxAllocationCount);
+		vilc_memoryBudget_refresh();
+	}
+
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_memoryBudget_vkFreeMemory(VkDevice device, VkDeviceMemory memory, const VkAllocationCallbacks* pAllocator)
+{
+	VilcMemoryBudgetEntry* entry = NULL;
+
+	vilc_memoryBudget_next_vkFreeMemory(device, memory, pAllocator);
+
+	if (memory && device == vilc_memoryBudget_device)
+	{
+		pthread_mutex_lock(&vilc_memoryBudget_mutex);
+		entry = (VilcMemoryBudgetEntry*)vilc_mapRemove(&vilc_memoryBudget_memories, VILC_OBJECT_KEY(memory));
+		pthread_mutex_unlock(&vilc_memoryBudget_mutex);
+	}
+
+	if (entry)
+	{
+		vilc_memoryBudget_count(entry, -1);
+		VILC_ATOMIC_ADD(&vilc_memoryBudget_allocationCount, (uint32_t)0 - 1);
+		free(entry);
+		vilc_memoryBudget_refresh();
+	}
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_memoryBudget_vkBindBufferMemory(VkDevice device, VkBuffer buffer, VkDeviceMemory memory, VkDeviceSize memoryOffset)
+{
+	VkResult result = vilc_memoryBudget_next_vkBindBufferMemory(device, buffer, memory, memoryOffset);
+	if (result == VK_SUCCESS)
+		vilc_memoryBudget_bindBuffer(device, buffer, memory);
+	return result;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_memoryBudget_vkBindImageMemory(VkDevice device, VkImage image, VkDeviceMemory memory, VkDeviceSize memoryOffset)
+{
+	VkResult result = vilc_memoryBudget_next_vkBindImageMemory(device, image, memory, memoryOffset);
+	if (result == VK_SUCCESS)
+		vilc_memoryBudget_bindImage(device, image, memory);
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_memoryBudget_vkDestroyBuffer(VkDevice device, VkBuffer buffer, const VkAllocationCallbacks* pAllocator)
+{
+	vilc_memoryBudget_next_vkDestroyBuffer(device, buffer, pAllocator);
+	if (buffer && device == vilc_memoryBudget_device)
+		vilc_memoryBudget_unbind(&vilc_memoryBudget_buffers, VILC_OBJECT_KEY(buffer));
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_memoryBudget_vkDestroyImage(VkDevice device, VkImage image, const VkAllocationCallbacks* pAllocator)
+{
+	vilc_memoryBudget_next_vkDestroyImage(device, image, pAllocator);
+	if (image && device == vilc_memoryBudget_device)
+		vilc_memoryBudget_unbind(&vilc_memoryBudget_images, VILC_OBJECT_KEY(image));
+}
+
+#if defined(VK_VERSION_1_1)
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_memoryBudget_vkBindBufferMemory2(VkDevice device, uint32_t bindInfoCount, const VkBindBufferMemoryInfo* pBindInfos)
+{
+	VkResult result = vilc_memoryBudget_next_vkBindBufferMemory2(device, bindInfoCount, pBindInfos);
+	uint32_t i;
+	if (result == VK_SUCCESS)
+		for (i = 0; i < bindInfoCount; ++i)
+			vilc_memoryBudget_bindBuffer(device, pBindInfos[i].buffer, pBindInfos[i].memory);
+	return result;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_memoryBudget_vkBindImageMemory2(VkDevice device, uint32_t bindInfoCount, const VkBindImageMemoryInfo* pBindInfos)
+{
+	VkResult result = vilc_memoryBudget_next_vkBindImageMemory2(device, bindInfoCount, pBindInfos);
+	uint32_t i;
+	if (result == VK_SUCCESS)
+		for (i = 0; i < bindInfoCount; ++i)
+			vilc_memoryBudget_bindImage(device, pBindInfos[i].image, pBindInfos[i].memory);
+	return result;
+}
+#endif
+
+#if defined(VK_KHR_bind_memory2)
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_memoryBudget_vkBindBufferMemory2KHR(VkDevice device, uint32_t bindInfoCount, const VkBindBufferMemoryInfoKHR* pBindInfos)
+{
+	VkResult result = vilc_memoryBudget_next_vkBindBufferMemory2KHR(device, bindInfoCount, pBindInfos);
+	uint32_t i;
+	if (result == VK_SUCCESS)
+		for (i = 0; i < bindInfoCount; ++i)
+			vilc_memoryBudget_bindBuffer(device, pBindInfos[i].buffer, pBindInfos[i].memory);
+	return result;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_memoryBudget_vkBindImageMemory2KHR(VkDevice device, uint32_t bindInfoCount, const VkBindImageMemoryInfoKHR* pBindInfos)
+{
+	VkResult result = vilc_memoryBudget_next_vkBindImageMemory2KHR(device, bindInfoCount, pBindInfos);
+	uint32_t i;
+	if (result == VK_SUCCESS)
+		for (i = 0; i < bindInfoCount; ++i)
+			vilc_memoryBudget_bindImage(device, pBindInfos[i].image, pBindInfos[i].memory);
+	return result;
+}
+#endif
+
+#if defined(VK_KHR_swapchain)
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_memoryBudget_vkQueuePresentKHR(VkQueue queue, const VkPresentInfoKHR* pPresentInfo)
+{
+	vilc_memoryBudget_refresh();
+	return vilc_memoryBudget_next_vkQueuePresentKHR(queue, pPresentInfo);
+}
+#endif
+
+static void vilc_memoryBudget_installInstance(void)
+{
+	VILC_LAYER_HOOK(vilc_memoryBudget, vkCreateDevice)
+}
+
+static void vilc_memoryBudget_installDevice(void)
+{
+	VILC_LAYER_HOOK(vilc_memoryBudget, vkDestroyDevice)
+	VILC_LAYER_HOOK(vilc_memoryBudget, vkAllocateMemory)
+	VILC_LAYER_HOOK(vilc_memoryBudget, vkFreeMemory)
+	VILC_LAYER_HOOK(vilc_memoryBudget, vkBindBufferMemory)
+	VILC_LAYER_HOOK(vilc_memoryBudget, vkBindImageMemory)
+	VILC_LAYER_HOOK(vilc_memoryBudget, vkDestroyBuffer)
+	VILC_LAYER_HOOK(vilc_memoryBudget, vkDestroyImage)
+#if defined(VK_VERSION_1_1)
+	VILC_LAYER_HOOK(vilc_memoryBudget, vkBindBufferMemory2)
+	VILC_LAYER_HOOK(vilc_memoryBudget, vkBindImageMemory2)
+#endif
+#if defined(VK_KHR_bind_memory2)
+	VILC_LAYER_HOOK(vilc_memoryBudget, vkBindBufferMemory2KHR)
+	VILC_LAYER_HOOK(vilc_memoryBudget, vkBindImageMemory2KHR)
+#endif
+#if defined(VK_KHR_swapchain)
+	VILC_LAYER_HOOK(vilc_memoryBudget, vkQueuePresentKHR)
+#endif
+}
+#endif /* VILC_MEMORY_BUDGET */
+
+#if defined(VOLK_IN_LOADERS_CLOTH) && defined(VILC_SHADER_MODULE_CACHE)
+/* Shader module deduplication: vkCreateShaderModule with SPIR-V, flags and allocation callbacks equal to those of a
+ * live module returns that module again, and vkDestroyShaderModule only destroys it with the last reference.
+ * Modules are found by content hash and confirmed against a copy of the SPIR-V; create infos with a pNext chain and
+ * the rare module whose hash is taken by different content go straight to the driver, uncached.
+ */
+typedef struct VilcShaderModule
+{
+	VkShaderModule module;
+	uint64_t hash;
+	uint32_t references;
+	VkShaderModuleCreateFlags flags;
+	int hasAllocator;
+	VkAllocationCallbacks allocator;
+	size_t codeSize;
+	uint32_t code[1];
+} VilcShaderModule;
+
+static pthread_mutex_t vilc_shaderModuleCache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static VkDevice vilc_shaderModuleCache_device;
+static VilcHandleMap vilc_shaderModuleCache_hashes; /* content hash -> VilcShaderModule */
+static VilcHandleMap vilc_shaderModuleCache_modules; /* VkShaderModule -> VilcShaderModule */
+static VilcShaderModuleCacheStats vilc_shaderModuleCache_stats;
+
+VILC_LAYER_NEXT(vilc_shaderModuleCache, vkCreateDevice)
+VILC_LAYER_NEXT(vilc_shaderModuleCache, vkDestroyDevice)
+VILC_LAYER_NEXT(vilc_shaderModuleCache, vkCreateShaderModule)
+VILC_LAYER_NEXT(vilc_shaderModuleCache, vkDestroyShaderModule)
+
+static int vilc_shaderModuleCache_equal(const VilcShaderModule* entry, const VkShaderModuleCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator)
+{
+	if (entry->codeSize != pCreateInfo->codeSize || entry->flags != pCreateInfo->flags || entry->hasAllocator != (pAllocator != NULL))
+		return 0;
+	if (pAllocator && memcmp(&entry->allocator, pAllocator, sizeof(VkAllocationCallbacks)) != 0)
+		return 0;
+	return memcmp(entry->code, pCreateInfo->pCode, pCreateInfo->codeSize) == 0;
+}
+
+/* Takes a reference on the cached module equal to the create info, if any; caller locks */
+static VilcShaderModule* vilc_shaderModuleCache_acquire(uint64_t hash, const VkShaderModuleCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator)
+{
+	VilcShaderModule* entry = (VilcShaderModule*)vilc_mapFind(&vilc_shaderModuleCache_hashes, hash);
+
+	if (!entry || !vilc_shaderModuleCache_equal(entry, pCreateInfo, pAllocator))
+		return NULL;
+
+	entry->references++;
+	vilc_shaderModuleCache_stats.hits++;
+	vilc_shaderModuleCache_stats.references++;
+	return entry;
+}
+
+void vilcGetShaderModuleCacheStats(VilcShaderModuleCacheStats* stats)
+{
+	pthread_mutex_lock(&vilc_shaderModuleCache_mutex);
+	*stats = vilc_shaderModuleCache_stats;
+	pthread_mutex_unlock(&vilc_shaderModuleCache_mutex);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_shaderModuleCache_vkCreateDevice(VkPhysicalDevice physicalDevice, const VkDeviceCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDevice* pDevice)
+{
+	VkResult result = vilc_shaderModuleCache_next_vkCreateDevice(physicalDevice, pCreateInfo, pAllocator, pDevice);
+	if (result == VK_SUCCESS)
+	{
+		pthread_mutex_lock(&vilc_shaderModuleCache_mutex);
+		vilc_shaderModuleCache_device = *pDevice;
+		pthread_mutex_unlock(&vilc_shaderModuleCache_mutex);
+	}
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_shaderModuleCache_vkDestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator)
+{
+	uint32_t i;
+
+	pthread_mutex_lock(&vilc_shaderModuleCache_mutex);
+	if (device && device == vilc_shaderModuleCache_device)
+	{
+		/* modules the application did not destroy go away with the device */
+		for (i = 0; i < vilc_shaderModuleCache_modules.capacity; ++i)
+			free(vilc_shaderModuleCache_modules.values[i]);
+		vilc_mapFree(&vilc_shaderModuleCache_modules);
+		vilc_mapFree(&vilc_shaderModuleCache_hashes);
+		vilc_shaderModuleCache_device = VK_NULL_HANDLE;
+
+		fprintf(stderr, "vilc: shader module cache: %llu hits, %llu misses, %llu uncached\n", (unsigned long long)vilc_shaderModuleCache_stats.hits,
+		    (unsigned long long)vilc_shaderModuleCache_stats.misses, (unsigned long long)vilc_shaderModuleCache_stats.uncached);
+		vilc_shaderModuleCache_stats.modules = 0;
+		vilc_shaderModuleCache_stats.references = 0;
+	}
+	pthread_mutex_unlock(&vilc_shaderModuleCache_mutex);
+
+	vilc_shaderModuleCache_next_vkDestroyDevice(device, pAllocator);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_shaderModuleCache_vkCreateShaderModule(VkDevice device, const VkShaderModuleCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkShaderModule* pShaderModule)
+{
+	VilcShaderModule *entry, *existing;
+	int cached = 0;
+	uint64_t hash;
+	VkResult result;
+
+	if (pCreateInfo->pNext || device != vilc_shaderModuleCache_device)
+	{
+		VILC_ATOMIC_ADD(&vilc_shaderModuleCache_stats.uncached, 1);
+		return vilc_shaderModuleCache_next_vkCreateShaderModule(device, pCreateInfo, pAllocator, pShaderModule);
+	}
+
+	/* key 0 marks empty map slots */
+	hash = vilc_hashBytes(pCreateInfo->pCode, pCreateInfo->codeSize, pCreateInfo->flags);
+	hash = hash ? hash : 1;
+
+	pthread_mutex_lock(&vilc_shaderModuleCache_mutex);
+	existing = vilc_shaderModuleCache_acquire(hash, pCreateInfo, pAllocator);
+	if (existing)
+		*pShaderModule = existing->module;
+	pthread_mutex_unlock(&vilc_shaderModuleCache_mutex);
+
+	if (existing)
+		return VK_SUCCESS;
+
+	/* the driver call runs unlocked so that different modules are still created in parallel */
+	result = vilc_shaderModuleCache_next_vkCreateShaderModule(device, pCreateInfo, pAllocator, pShaderModule);
+	if (result != VK_SUCCESS)
+		return result;
+
+	entry = (VilcShaderModule*)malloc(offsetof(VilcShaderModule, code) + pCreateInfo->codeSize);
+	if (entry)
+	{
+		memset(entry, 0, offsetof(VilcShaderModule, code));
+		entry->module = *pShaderModule;
+		entry->hash = hash;
+		entry->references = 1;
+		entry->flags = pCreateInfo->flags;
+		entry->hasAllocator = pAllocator != NULL;
+		if (pAllocator)
+			entry->allocator = *pAllocator;
+		entry->codeSize = pCreateInfo->codeSize;
+		memcpy(entry->code, pCreateInfo->pCode, pCreateInfo->codeSize);
+	}
+
+	pthread_mutex_lock(&vilc_shaderModuleCache_mutex);
+	/* another thread may have created the same module meanwhile; the first one wins */
+	existing = vilc_shaderModuleCache_acquire(hash, pCreateInfo, pAllocator);
+	if (existing)
+		*pShaderModule = existing->module;
+	else if (entry && !vilc_mapFind(&vilc_shaderModuleCache_hashes, hash) && vilc_mapInsert(&vilc_shaderModuleCache_modules, VILC_OBJECT_KEY(entry->module), entry))
+	{
+		if (vilc_mapInsert(&vilc_shaderModuleCache_hashes, hash, entry))
+		{
+			vilc_shaderModuleCache_stats.misses++;
+			vilc_shaderModuleCache_stats.modules++;
+			vilc_shaderModuleCache_stats.references++;
+			cached = 1;
+		}
+		else
+			vilc_mapRemove(&vilc_shaderModuleCache_modules, VILC_OBJECT_KEY(entry->module));
+	}
+	if (!existing && !cached)
+		vilc_shaderModuleCache_stats.uncached++;
+	pthread_mutex_unlock(&vilc_shaderModuleCache_mutex);
+
+	if (existing && entry)
+		vilc_shaderModuleCache_next_vkDestroyShaderModule(device, entry->module, pAllocator);
+	if (!cached)
+		free(entry);
+
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_shaderModuleCache_vkDestroyShaderModule(VkDevice device, VkShaderModule shaderModule, const VkAllocationCallbacks* pAllocator)
+{
+	VilcShaderModule* entry = NULL;
+	int cached = 0;
+
+	pthread_mutex_lock(&vilc_shaderModuleCache_mutex);
+	if (shaderModule && device == vilc_shaderModuleCache_device)
+		entry = (VilcShaderModule*)vilc_mapFind(&vilc_shaderModuleCache_modules, VILC_OBJECT_KEY(shaderModule));
+	if (entry)
+	{
+		cached = 1;
+		vilc_shaderModuleCache_stats.references--;
+		if (--entry->references == 0)
+		{
+			vilc_mapRemove(&vilc_shaderModuleCache_modules, VILC_OBJECT_KEY(shaderModule));
+			vilc_mapRemove(&vilc_shaderModuleCache_hashes, entry->hash);
+			vilc_shaderModuleCache_stats.modules--;
+		}
+		else
+			entry = NULL;
+	}
+	pthread_mutex_unlock(&vilc_shaderModuleCache_mutex);
+
+	if (!cached)
+		vilc_shaderModuleCache_next_vkDestroyShaderModule(device, shaderModule, pAllocator);
+	else if (entry)
+	{
+		/* the last reference may be released with other callbacks than the module was created with */
+		vilc_shaderModuleCache_next_vkDestroyShaderModule(device, entry->module, entry->hasAllocator ? &entry->allocator : NULL);
+		free(entry);
+	}
+}
+
+static void vilc_shaderModuleCache_installInstance(void)
+{
+	VILC_LAYER_HOOK(vilc_shaderModuleCache, vkCreateDevice)
+}
+
+static void vilc_shaderModuleCache_installDevice(void)
+{
+	VILC_LAYER_HOOK(vilc_shaderModuleCache, vkDestroyDevice)
+	VILC_LAYER_HOOK(vilc_shaderModuleCache, vkCreateShaderModule)
+	VILC_LAYER_HOOK(vilc_shaderModuleCache, vkDestroyShaderModule)
+}
+#endif /* VILC_SHADER_MODULE_CACHE */
+
+#if defined(VOLK_IN_LOADERS_CLOTH) && defined(VILC_SAMPLER_CACHE)
+/* Sampler interning: vkCreateSampler returns the live sampler with the same state, so applications that create a
+ * sampler per material stay far below maxSamplerAllocationCount. The state is reduced to a canonical key that
+ * ignores the order of the pNext chain; chains with structures the key does not know are passed through uncached.
+ *
+ * Hits never take a lock. Each shard keeps a list that only grows while the device lives; entries whose last
+ * reference is gone are recycled for new states instead of being freed. A reader takes a reference by incrementing
+ * a non-zero count and only then compares the key, so it can not keep an entry that was recycled under it.
+ */
+#define VILC_SAMPLER_CACHE_SHARD_COUNT 16
+
+typedef struct VilcSamplerKey
+{
+	VkSamplerCreateInfo info; /* sType and pNext are zero */
+	uint32_t reductionMode;
+	uint32_t customBorderColor[4];
+	uint32_t customBorderColorFormat;
+	uint64_t ycbcrConversion;
+	VkBool32 hasAllocator;
+	VkAllocationCallbacks allocator;
+} VilcSamplerKey;
+
+typedef struct VilcSampler
+{
+	struct VilcSampler* next; /* immutable once the entry is published */
+	uint64_t hash; /* 0 while the entry is free */
+	uint32_t references; /* 0 while the entry is free or being destroyed */
+	VkSampler sampler;
+	VilcSamplerKey key;
+} VilcSampler;
+
+typedef struct VilcSamplerShard
+{
+	pthread_mutex_t mutex; /* serializes misses and the last release */
+	VilcSampler* head;
+} VilcSamplerShard;
+
+static VilcSamplerShard vilc_samplerCache_shards[VILC_SAMPLER_CACHE_SHARD_COUNT];
+static pthread_once_t vilc_samplerCache_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t vilc_samplerCache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static VkDevice vilc_samplerCache_device;
+static VilcHandleMap vilc_samplerCache_samplers; /* VkSampler -> VilcSampler, under vilc_samplerCache_mutex */
+static VilcSamplerCacheStats vilc_samplerCache_stats;
+
+VILC_LAYER_NEXT(vilc_samplerCache, vkCreateDevice)
+VILC_LAYER_NEXT(vilc_samplerCache, vkDestroyDevice)
+VILC_LAYER_NEXT(vilc_samplerCache, vkCreateSampler)
+VILC_LAYER_NEXT(vilc_samplerCache, vkDestroySampler)
+
+static void vilc_samplerCache_init(void)
+{
+	uint32_t i;
+	for (i = 0; i < VILC_SAMPLER_CACHE_SHARD_COUNT; ++i)
+		pthread_mutex_init(&vilc_samplerCache_shards[i].mutex, NULL);
+}
+
+/* Fills the canonical key of a create info; returns 0 if the pNext chain has structures the key does not cover */
+static int vilc_samplerCache_key(const VkSamplerCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VilcSamplerKey* key)
+{
+	const VkBaseInStructure* ext;
+
+	/* the key is hashed and compared as bytes, so padding must be zero */
+	memset(key, 0, sizeof(*key));
+	memcpy(&key->info.flags, &pCreateInfo->flags, sizeof(VkSamplerCreateInfo) - offsetof(VkSamplerCreateInfo, flags));
+	key->hasAllocator = pAllocator != NULL;
+	if (pAllocator)
+		key->allocator = *pAllocator;
+
+	for (ext = (const VkBaseInStructure*)pCreateInfo->pNext; ext; ext = ext->pNext)
+	{
+		switch (ext->sType)
+		{
+#if defined(VK_VERSION_1_2)
+		case VK_STRUCTURE_TYPE_SAMPLER_REDUCTION_MODE_CREATE_INFO:
+			/* weighted average is the default, so it gets the same key as no structure at all */
+			key->reductionMode = (uint32_t)((const VkSamplerReductionModeCreateInfo*)ext)->reductionMode;
+			break;
+#endif
+#if defined(VK_VERSION_1_1)
+		case VK_STRUCTURE_TYPE_SAMPLER_YCBCR_CONVERSION_INFO:
+			key->ycbcrConversion = VILC_OBJECT_KEY(((const VkSamplerYcbcrConversionInfo*)ext)->conversion);
+			break;
+#endif
+#if defined(VK_EXT_custom_border_color)
+		case VK_STRUCTURE_TYPE_SAMPLER_CUSTOM_BORDER_COLOR_CREATE_INFO_EXT:
+			memcpy(key->customBorderColor, &((const VkSamplerCustomBorderColorCreateInfoEXT*)ext)->customBorderColor, sizeof(key->customBorderColor));
+			key->customBorderColorFormat = (uint32_t)((const VkSamplerCustomBorderColorCreateInfoEXT*)ext)->format;
+			break;
+#endif
+		default:
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+/* Takes a reference unless the count already dropped to zero */
+static int vilc_samplerCache_retain(VilcSampler* entry)
+{
+	uint32_t references = VILC_ATOMIC_LOAD(&entry->references);
+	while (references && !VILC_ATOMIC_CAS_ACQUIRE(&entry->references, &references, references + 1))
+		;
+	return references != 0;
+}
+
+static void vilc_samplerCache_release(VkDevice device, VilcSampler* entry)
+{
+	VilcSamplerShard* shard;
+
+	if (VILC_ATOMIC_SUB_ACQ_REL(&entry->references, 1) != 0)
+		return;
+
+	/* a count of zero never goes up again, so the entry is ours to destroy and recycle */
+	shard = &vilc_samplerCache_shards[entry->hash % VILC_SAMPLER_CACHE_SHARD_COUNT];
+	pthread_mutex_lock(&shard->mutex);
+
+	/* unmapped before the driver can hand the handle out again */
+	pthread_mutex_lock(&vilc_samplerCache_mutex);
+	vilc_mapRemove(&vilc_samplerCache_samplers, VILC_OBJECT_KEY(entry->sampler));
+	pthread_mutex_unlock(&vilc_samplerCache_mutex);
+
+	vilc_samplerCache_next_vkDestroySampler(device, entry->sampler, entry->key.hasAllocator ? &entry->key.allocator : NULL);
+	VILC_ATOMIC_STORE(&entry->hash, 0);
+	VILC_ATOMIC_ADD(&vilc_samplerCache_stats.samplers, (uint32_t)0 - 1);
+
+	pthread_mutex_unlock(&shard->mutex);
+}
+
+/* Lock-free; the key is compared only once the reference pins the entry to its current state */
+static VilcSampler* vilc_samplerCache_acquire(VkDevice device, VilcSamplerShard* shard, uint64_t hash, const VilcSamplerKey* key)
+{
+	VilcSampler* entry;
+
+	for (entry = VILC_ATOMIC_LOAD_ACQUIRE(&shard->head); entry; entry = entry->next)
+	{
+		if (VILC_ATOMIC_LOAD(&entry->hash) != hash || !vilc_samplerCache_retain(entry))
+			continue;
+		if (memcmp(&entry->key, key, sizeof(*key)) == 0)
+			return entry;
+		vilc_samplerCache_release(device, entry);
+	}
+
+	return NULL;
+}
+
+/* Same as vilc_samplerCache_acquire for callers holding the shard mutex, under which keys do not change */
+static VilcSampler* vilc_samplerCache_acquireLocked(VilcSamplerShard* shard, uint64_t hash, const VilcSamplerKey* key, VilcSampler** recycled)
+{
+	VilcSampler* entry;
+
+	*recycled = NULL;
+	for (entry = shard->head; entry; entry = entry->next)
+	{
+		uint64_t entryHash = VILC_ATOMIC_LOAD(&entry->hash);
+		if (entryHash == 0 && !*recycled)
+			*recycled = entry;
+		else if (entryHash == hash && memcmp(&entry->key, key, sizeof(*key)) == 0 && vilc_samplerCache_retain(entry))
+			return entry;
+	}
+
+	return NULL;
+}
+
+void vilcGetSamplerCacheStats(VilcSamplerCacheStats* stats)
+{
+	stats->hits = VILC_ATOMIC_LOAD(&vilc_samplerCache_stats.hits);
+	stats->misses = VILC_ATOMIC_LOAD(&vilc_samplerCache_stats.misses);
+	stats->uncached = VILC_ATOMIC_LOAD(&vilc_samplerCache_stats.uncached);
+	stats->samplers = VILC_ATOMIC_LOAD(&vilc_samplerCache_stats.samplers);
+	stats->references = VILC_ATOMIC_LOAD(&vilc_samplerCache_stats.references);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_samplerCache_vkCreateDevice(VkPhysicalDevice physicalDevice, const VkDeviceCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDevice* pDevice)
+{
+	VkResult result = vilc_samplerCache_next_vkCreateDevice(physicalDevice, pCreateInfo, pAllocator, pDevice);
+	if (result == VK_SUCCESS)
+	{
+		pthread_once(&vilc_samplerCache_once, vilc_samplerCache_init);
+		pthread_mutex_lock(&vilc_samplerCache_mutex);
+		vilc_samplerCache_device = *pDevice;
+		pthread_mutex_unlock(&vilc_samplerCache_mutex);
+	}
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_samplerCache_vkDestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator)
+{
+	uint32_t i;
+
+	pthread_mutex_lock(&vilc_samplerCache_mutex);
+	if (device && device == vilc_samplerCache_device)
+	{
+		/* no other call may use the device any more, so the shard lists can go without the shard mutexes */
+		for (i = 0; i < VILC_SAMPLER_CACHE_SHARD_COUNT; ++i)
+		{
+			VilcSampler* entry = vilc_samplerCache_shards[i].head;
+			while (entry)
+			{
+				VilcSampler* next = entry->next;
+				free(entry);
+				entry = next;
+			}
+			vilc_samplerCache_shards[i].head = NULL;
+		}
+		vilc_mapFree(&vilc_samplerCache_samplers);
+		vilc_samplerCache_device = VK_NULL_HANDLE;
+
+		fprintf(stderr, "vilc: sampler cache: %llu hits, %llu misses, %llu uncached\n", (unsigned long long)vilc_samplerCache_stats.hits,
+		    (unsigned long long)vilc_samplerCache_stats.misses, (unsigned long long)vilc_samplerCache_stats.uncached);
+		vilc_samplerCache_stats.samplers = 0;
+		vilc_samplerCache_stats.references = 0;
+	}
+	pthread_mutex_unlock(&vilc_samplerCache_mutex);
+
+	vilc_samplerCache_next_vkDestroyDevice(device, pAllocator);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_samplerCache_vkCreateSampler(VkDevice device, const VkSamplerCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkSampler* pSampler)
+{
+	VilcSamplerKey key;
+	VilcSamplerShard* shard;
+	VilcSampler *entry, *recycled;
+	uint64_t hash;
+	VkResult result;
+	int cached = 0;
+
+	if (device != vilc_samplerCache_device || !vilc_samplerCache_key(pCreateInfo, pAllocator, &key))
+	{
+		VILC_ATOMIC_ADD(&vilc_samplerCache_stats.uncached, 1);
+		return vilc_samplerCache_next_vkCreateSampler(device, pCreateInfo, pAllocator, pSampler);
+	}
+
+	/* hash 0 marks free entries */
+	hash = vilc_hashBytes(&key, sizeof(key), 0);
+	hash = hash ? hash : 1;
+	shard = &vilc_samplerCache_shards[hash % VILC_SAMPLER_CACHE_SHARD_COUNT];
+
+	entry = vilc_samplerCache_acquire(device, shard, hash, &key);
+	if (entry)
+	{
+		VILC_ATOMIC_ADD(&vilc_samplerCache_stats.hits, 1);
+		VILC_ATOMIC_ADD(&vilc_samplerCache_stats.references, 1);
+		*pSampler = entry->sampler;
+		return VK_SUCCESS;
+	}
+
+	pthread_mutex_lock(&shard->mutex);
+
+	/* another thread may have created the same state since the lock-free lookup */
+	entry = vilc_samplerCache_acquireLocked(shard, hash, &key, &recycled);
+	if (entry)
+	{
+		pthread_mutex_unlock(&shard->mutex);
+		VILC_ATOMIC_ADD(&vilc_samplerCache_stats.hits, 1);
+		VILC_ATOMIC_ADD(&vilc_samplerCache_stats.references, 1);
+		*pSampler = entry->sampler;
+		return VK_SUCCESS;
+	}
+
+	result = vilc_samplerCache_next_vkCreateSampler(device, pCreateInfo, pAllocator, pSampler);
+	if (result == VK_SUCCESS)
+	{
+		entry = recycled ? recycled : (VilcSampler*)calloc(1, sizeof(VilcSampler));
+		if (entry)
+		{
+			entry->sampler = *pSampler;
+			entry->key = key;
+
+			pthread_mutex_lock(&vilc_samplerCache_mutex);
+			cached = vilc_mapInsert(&vilc_samplerCache_samplers, VILC_OBJECT_KEY(*pSampler), entry);
+			pthread_mutex_unlock(&vilc_samplerCache_mutex);
+		}
+
+		if (cached)
+		{
+			/* the release store publishes the key to readers that take a reference */
+			VILC_ATOMIC_STORE(&entry->hash, hash);
+			VILC_ATOMIC_STORE_RELEASE(&entry->references, 1);
+			if (entry != recycled)
+			{
+				entry->next = shard->head;
+				VILC_ATOMIC_STORE_RELEASE(&shard->head, entry);
+			}
+		}
+		else if (entry != recycled)
+			free(entry);
+	}
+
+	pthread_mutex_unlock(&shard->mutex);
+
+	if (cached)
+	{
+		VILC_ATOMIC_ADD(&vilc_samplerCache_stats.misses, 1);
+		VILC_ATOMIC_ADD(&vilc_samplerCache_stats.samplers, 1);
+		VILC_ATOMIC_ADD(&vilc_samplerCache_stats.references, 1);
+	}
+	else if (result == VK_SUCCESS)
+		VILC_ATOMIC_ADD(&vilc_samplerCache_stats.uncached, 1);
+
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_samplerCache_vkDestroySampler(VkDevice device, VkSampler sampler, const VkAllocationCallbacks* pAllocator)
+{
+	VilcSampler* entry = NULL;
+
+	if (sampler && device == vilc_samplerCache_device)
+	{
+		pthread_mutex_lock(&vilc_samplerCache_mutex);
+		entry = (VilcSampler*)vilc_mapFind(&vilc_samplerCache_samplers, VILC_OBJECT_KEY(sampler));
+		pthread_mutex_unlock(&vilc_samplerCache_mutex);
+	}
+
+	if (entry)
+	{
+		VILC_ATOMIC_ADD(&vilc_samplerCache_stats.references, (uint32_t)0 - 1);
+		vilc_samplerCache_release(device, entry);
+	}
+	else
+		vilc_samplerCache_next_vkDestroySampler(device, sampler, pAllocator);
+}
+
+static void vilc_samplerCache_installInstance(void)
+{
+	VILC_LAYER_HOOK(vilc_samplerCache, vkCreateDevice)
+}
+
+static void vilc_samplerCache_installDevice(void)
+{
+	VILC_LAYER_HOOK(vilc_samplerCache, vkDestroyDevice)
+	VILC_LAYER_HOOK(vilc_samplerCache, vkCreateSampler)
+	VILC_LAYER_HOOK(vilc_samplerCache, vkDestroySampler)
+}
+#endif /* VILC_SAMPLER_CACHE */
+
+#if defined(VOLK_IN_LOADERS_CLOTH) && defined(VILC_LAYOUT_CACHE)
+/* Layout interning: vkCreateDescriptorSetLayout and vkCreatePipelineLayout return the live layout with the same
+ * structure, reference counted like VILC_SHADER_MODULE_CACHE. Create infos are serialized into a canonical key:
+ * set layout bindings in binding order with their binding flags, immutable samplers by handle, and pipeline layouts
+ * with their set layout handles, so interned set layouts make pipeline layouts equal in turn.
+ * A cached pipeline layout holds a reference on its set layouts, so their handles can not be reused by the driver
+ * while its key names them; pipeline layouts with set layouts from outside the cache are not cached.
+ */
+typedef struct VilcLayout
+{
+	VkObjectType objectType;
+	VkDescriptorSetLayout setLayout;
+	VkPipelineLayout pipelineLayout;
+	uint64_t hash;
+	uint32_t references;
+	uint32_t setLayoutCount;
+	struct VilcLayout** setLayouts;
+	int hasAllocator;
+	VkAllocationCallbacks allocator;
+	size_t keySize;
+	unsigned char key[1];
+} VilcLayout;
+
+/* Appends to data, or only measures the key while data is NULL */
+typedef struct VilcLayoutWriter
+{
+	unsigned char* data;
+	size_t size;
+} VilcLayoutWriter;
+
+static pthread_mutex_t vilc_layoutCache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static VkDevice vilc_layoutCache_device;
+static VilcHandleMap vilc_layoutCache_hashes; /* key hash -> VilcLayout of either type */
+static VilcHandleMap vilc_layoutCache_setLayouts; /* VkDescriptorSetLayout -> VilcLayout */
+static VilcHandleMap vilc_layoutCache_pipelineLayouts; /* VkPipelineLayout -> VilcLayout */
+static VilcLayoutCacheStats vilc_layoutCache_stats;
+
+VILC_LAYER_NEXT(vilc_layoutCache, vkCreateDevice)
+VILC_LAYER_NEXT(vilc_layoutCache, vkDestroyDevice)
+VILC_LAYER_NEXT(vilc_layoutCache, vkCreateDescriptorSetLayout)
+VILC_LAYER_NEXT(vilc_layoutCache, vkDestroyDescriptorSetLayout)
+VILC_LAYER_NEXT(vilc_layoutCache, vkCreatePipelineLayout)
+VILC_LAYER_NEXT(vilc_layoutCache, vkDestroyPipelineLayout)
+
+static void vilc_layoutCache_write(VilcLayoutWriter* writer, const void* data, size_t size)
+{
+	if (writer->data)
+		memcpy(writer->data + writer->size, data, size);
+	writer->size += size;
+}
+
+static void vilc_layoutCache_write32(VilcLayoutWriter* writer, uint32_t value)
+{
+	vilc_layoutCache_write(writer, &value, sizeof(value));
+}
+
+static void vilc_layoutCache_write64(VilcLayoutWriter* writer, uint64_t value)
+{
+	vilc_layoutCache_write(writer, &value, sizeof(value));
+}
+
+static void vilc_layoutCache_writeSetLayout(VilcLayoutWriter* writer, const VkDescriptorSetLayoutCreateInfo* pCreateInfo, const VkDescriptorBindingFlags* pBindingFlags, const uint32_t* order)
+{
+	uint32_t i, j;
+
+	vilc_layoutCache_write32(writer, pCreateInfo->flags);
+	vilc_layoutCache_write32(writer, pCreateInfo->bindingCount);
+
+	for (i = 0; i < pCreateInfo->bindingCount; ++i)
+	{
+		const VkDescriptorSetLayoutBinding* binding = &pCreateInfo->pBindings[order[i]];
+		/* immutable samplers are ignored for other descriptor types */
+		int immutable = binding->pImmutableSamplers && (binding->descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER || binding->descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+
+		vilc_layoutCache_write32(writer, binding->binding);
+		vilc_layoutCache_write32(writer, (uint32_t)binding->descriptorType);
+		vilc_layoutCache_write32(writer, binding->descriptorCount);
+		vilc_layoutCache_write32(writer, binding->stageFlags);
+		vilc_layoutCache_write32(writer, pBindingFlags ? pBindingFlags[order[i]] : 0);
+		vilc_layoutCache_write32(writer, immutable);
+		for (j = 0; immutable && j < binding->descriptorCount; ++j)
+			vilc_layoutCache_write64(writer, VILC_OBJECT_KEY(binding->pImmutableSamplers[j]));
+	}
+}
+
+static void vilc_layoutCache_writePipelineLayout(VilcLayoutWriter* writer, const VkPipelineLayoutCreateInfo* pCreateInfo)
+{
+	uint32_t i;
+
+	vilc_layoutCache_write32(writer, pCreateInfo->flags);
+	vilc_layoutCache_write32(writer, pCreateInfo->setLayoutCount);
+	for (i = 0; i < pCreateInfo->setLayoutCount; ++i)
+		vilc_layoutCache_write64(writer, VILC_OBJECT_KEY(pCreateInfo->pSetLayouts[i]));
+
+	vilc_layoutCache_write32(writer, pCreateInfo->pushConstantRangeCount);
+	for (i = 0; i < pCreateInfo->pushConstantRangeCount; ++i)
+	{
+		vilc_layoutCache_write32(writer, pCreateInfo->pPushConstantRanges[i].stageFlags);
+		vilc_layoutCache_write32(writer, pCreateInfo->pPushConstantRanges[i].offset);
+		vilc_layoutCache_write32(writer, pCreateInfo->pPushConstantRanges[i].size);
+	}
+}
+
+/* Allocates an entry sized for the key the writer measured; the caller writes the key into it */
+static VilcLayout* vilc_layoutCache_allocate(VkObjectType objectType, size_t keySize, const VkAllocationCallbacks* pAllocator)
+{
+	VilcLayout* entry = (VilcLayout*)malloc(offsetof(VilcLayout, key) + keySize);
+	if (!entry)
+		return NULL;
+
+	memset(entry, 0, offsetof(VilcLayout, key));
+	entry->objectType = objectType;
+	entry->references = 1;
+	entry->hasAllocator = pAllocator != NULL;
+	if (pAllocator)
+		entry->allocator = *pAllocator;
+	entry->keySize = keySize;
+	return entry;
+}
+
+static void vilc_layoutCache_hash(VilcLayout* entry)
+{
+	entry->hash = vilc_hashBytes(entry->key, entry->keySize, (uint64_t)entry->objectType);
+	entry->hash = entry->hash ? entry->hash : 1;
+}
+
+/* Takes a reference on the cached layout equal to entry, if any; caller locks */
+static VilcLayout* vilc_layoutCache_acquire(const VilcLayout* entry)
+{
+	VilcLayout* existing = (VilcLayout*)vilc_mapFind(&vilc_layoutCache_hashes, entry->hash);
+
+	if (!existing || existing->objectType != entry->objectType || existing->keySize != entry->keySize || existing->hasAllocator != entry->hasAllocator)
+		return NULL;
+	if (entry->hasAllocator && memcmp(&existing->allocator, &entry->allocator, sizeof(VkAllocationCallbacks)) != 0)
+		return NULL;
+	if (memcmp(existing->key, entry->key, entry->keySize) != 0)
+		return NULL;
+
+	existing->references++;
+	return existing;
+}
+
+/* Caller locks; returns 0 if the entry could not be cached, e.g. for a hash collision */
+static int vilc_layoutCache_insert(VilcHandleMap* handles, uint64_t handle, VilcLayout* entry)
+{
+	if (vilc_mapFind(&vilc_layoutCache_hashes, entry->hash) || !vilc_mapInsert(handles, handle, entry))
+		return 0;
+	if (!vilc_mapInsert(&vilc_layoutCache_hashes, entry->hash, entry))
+	{
+		vilc_mapRemove(handles, handle);
+		return 0;
+	}
+	return 1;
+}
+
+/* Drops a reference and destroys the layout with the last one; caller locks */
+static void vilc_layoutCache_release(VkDevice device, VilcLayout* entry)
+{
+	const VkAllocationCallbacks* pAllocator = entry->hasAllocator ? &entry->allocator : NULL;
+	uint32_t i;
+
+	if (--entry->references)
+		return;
+
+	vilc_mapRemove(&vilc_layoutCache_hashes, entry->hash);
+	if (entry->objectType == VK_OBJECT_TYPE_PIPELINE_LAYOUT)
+	{
+		vilc_mapRemove(&vilc_layoutCache_pipelineLayouts, VILC_OBJECT_KEY(entry->pipelineLayout));
+		vilc_layoutCache_next_vkDestroyPipelineLayout(device, entry->pipelineLayout, pAllocator);
+		vilc_layoutCache_stats.pipelineLayouts.layouts--;
+
+		for (i = 0; i < entry->setLayoutCount; ++i)
+			if (entry->setLayouts[i])
+				vilc_layoutCache_release(device, entry->setLayouts[i]);
+		free(entry->setLayouts);
+	}
+	else
+	{
+		vilc_mapRemove(&vilc_layoutCache_setLayouts, VILC_OBJECT_KEY(entry->setLayout));
+		vilc_layoutCache_next_vkDestroyDescriptorSetLayout(device, entry->setLayout, pAllocator);
+		vilc_layoutCache_stats.setLayouts.layouts--;
+	}
+
+	free(entry);
+}
+
+static void vilc_layoutCache_freeAll(VilcHandleMap* map)
+{
+	uint32_t i;
+
+	for (i = 0; i < map->capacity; ++i)
+	{
+		VilcLayout* entry = (VilcLayout*)map->values[i];
+		if (entry)
+		{
+			free(entry->setLayouts);
+			free(entry);
+		}
+	}
+	vilc_mapFree(map);
+}
+
+void vilcGetLayoutCacheStats(VilcLayoutCacheStats* stats)
+{
+	pthread_mutex_lock(&vilc_layoutCache_mutex);
+	*stats = vilc_layoutCache_stats;
+	pthread_mutex_unlock(&vilc_layoutCache_mutex);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_layoutCache_vkCreateDevice(VkPhysicalDevice physicalDevice, const VkDeviceCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDevice* pDevice)
+{
+	VkResult result = vilc_layoutCache_next_vkCreateDevice(physicalDevice, pCreateInfo, pAllocator, pDevice);
+	if (result == VK_SUCCESS)
+	{
+		pthread_mutex_lock(&vilc_layoutCache_mutex);
+		vilc_layoutCache_device = *pDevice;
+		pthread_mutex_unlock(&vilc_layoutCache_mutex);
+	}
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_layoutCache_vkDestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator)
+{
+	pthread_mutex_lock(&vilc_layoutCache_mutex);
+	if (device && device == vilc_layoutCache_device)
+	{
+		/* layouts the application did not destroy go away with the device */
+		vilc_layoutCache_freeAll(&vilc_layoutCache_pipelineLayouts);
+		vilc_layoutCache_freeAll(&vilc_layoutCache_setLayouts);
+		vilc_mapFree(&vilc_layoutCache_hashes);
+		vilc_layoutCache_device = VK_NULL_HANDLE;
+
+		fprintf(stderr, "vilc: layout cache: set layouts %llu hits, %llu misses, %llu uncached; pipeline layouts %llu hits, %llu misses, %llu uncached\n",
+		    (unsigned long long)vilc_layoutCache_stats.setLayouts.hits, (unsigned long long)vilc_layoutCache_stats.setLayouts.misses,
+		    (unsigned long long)vilc_layoutCache_stats.setLayouts.uncached, (unsigned long long)vilc_layoutCache_stats.pipelineLayouts.hits,
+		    (unsigned long long)vilc_layoutCache_stats.pipelineLayouts.misses, (unsigned long long)vilc_layoutCache_stats.pipelineLayouts.uncached);
+		vilc_layoutCache_stats.setLayouts.layouts = 0;
+		vilc_layoutCache_stats.pipelineLayouts.layouts = 0;
+	}
+	pthread_mutex_unlock(&vilc_layoutCache_mutex);
+
+	vilc_layoutCache_next_vkDestroyDevice(device, pAllocator);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_layoutCache_vkCreateDescriptorSetLayout(VkDevice device, const VkDescriptorSetLayoutCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDescriptorSetLayout* pSetLayout)
+{
+	const VkBaseInStructure* ext;
+	const VkDescriptorBindingFlags* pBindingFlags = NULL;
+	VilcLayoutWriter writer = { NULL, 0 };
+	VilcLayout *entry = NULL, *existing;
+	uint32_t* order = NULL;
+	uint32_t i, j;
+	int cached = 0;
+	VkResult result;
+
+	for (ext = (const VkBaseInStructure*)pCreateInfo->pNext; ext; ext = ext->pNext)
+	{
+#if defined(VK_VERSION_1_2)
+		if (ext->sType == VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO)
+		{
+			const VkDescriptorSetLayoutBindingFlagsCreateInfo* flagsInfo = (const VkDescriptorSetLayoutBindingFlagsCreateInfo*)ext;
+			if (flagsInfo->bindingCount == 0 || flagsInfo->bindingCount == pCreateInfo->bindingCount)
+			{
+				pBindingFlags = flagsInfo->bindingCount ? flagsInfo->pBindingFlags : NULL;
+				continue;
+			}
+		}
+#endif
+		break;
+	}
+
+	/* bindings are keyed in binding order, so the order of pBindings does not matter */
+	if (!ext && device == vilc_layoutCache_device && (pCreateInfo->bindingCount == 0 || (order = (uint32_t*)malloc(pCreateInfo->bindingCount * sizeof(uint32_t))) != NULL))
+	{
+		for (i = 0; i < pCreateInfo->bindingCount; ++i)
+		{
+			for (j = i; j > 0 && pCreateInfo->pBindings[order[j - 1]].binding > pCreateInfo->pBindings[i].binding; --j)
+				order[j] = order[j - 1];
+			order[j] = i;
+		}
+
+		vilc_layoutCache_writeSetLayout(&writer, pCreateInfo, pBindingFlags, order);
+		entry = vilc_layoutCache_allocate(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, writer.size, pAllocator);
+		if (entry)
+		{
+			writer.data = entry->key;
+			writer.size = 0;
+			vilc_layoutCache_writeSetLayout(&writer, pCreateInfo, pBindingFlags, order);
+			vilc_layoutCache_hash(entry);
+		}
+		free(order);
+	}
+
+	if (!entry)
+	{
+		pthread_mutex_lock(&vilc_layoutCache_mutex);
+		vilc_layoutCache_stats.setLayouts.uncached++;
+		pthread_mutex_unlock(&vilc_layoutCache_mutex);
+		return vilc_layoutCache_next_vkCreateDescriptorSetLayout(device, pCreateInfo, pAllocator, pSetLayout);
+	}
+
+	pthread_mutex_lock(&vilc_layoutCache_mutex);
+	existing = vilc_layoutCache_acquire(entry);
+	if (existing)
+	{
+		vilc_layoutCache_stats.setLayouts.hits++;
+		*pSetLayout = existing->setLayout;
+		result = VK_SUCCESS;
+	}
+	else
+	{
+		result = vilc_layoutCache_next_vkCreateDescriptorSetLayout(device, pCreateInfo, pAllocator, pSetLayout);
+		if (result == VK_SUCCESS)
+		{
+			entry->setLayout = *pSetLayout;
+			cached = vilc_layoutCache_insert(&vilc_layoutCache_setLayouts, VILC_OBJECT_KEY(*pSetLayout), entry);
+			if (cached)
+			{
+				vilc_layoutCache_stats.setLayouts.misses++;
+				vilc_layoutCache_stats.setLayouts.layouts++;
+			}
+			else
+				vilc_layoutCache_stats.setLayouts.uncached++;
+		}
+	}
+	pthread_mutex_unlock(&vilc_layoutCache_mutex);
+
+	if (!cached)
+		free(entry);
+
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_layoutCache_vkDestroyDescriptorSetLayout(VkDevice device, VkDescriptorSetLayout descriptorSetLayout, const VkAllocationCallbacks* pAllocator)
+{
+	VilcLayout* entry = NULL;
+
+	pthread_mutex_lock(&vilc_layoutCache_mutex);
+	if (descriptorSetLayout && device == vilc_layoutCache_device)
+		entry = (VilcLayout*)vilc_mapFind(&vilc_layoutCache_setLayouts, VILC_OBJECT_KEY(descriptorSetLayout));
+	if (entry)
+		vilc_layoutCache_release(device, entry);
+	pthread_mutex_unlock(&vilc_layoutCache_mutex);
+
+	if (!entry)
+		vilc_layoutCache_next_vkDestroyDescriptorSetLayout(device, descriptorSetLayout, pAllocator);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_layoutCache_vkCreatePipelineLayout(VkDevice device, const VkPipelineLayoutCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkPipelineLayout* pPipelineLayout)
+{
+	VilcLayoutWriter writer = { NULL, 0 };
+	VilcLayout *entry = NULL, *existing;
+	uint32_t i;
+	int cached = 0;
+	VkResult result;
+
+	if (!pCreateInfo->pNext && device == vilc_layoutCache_device)
+	{
+		vilc_layoutCache_writePipelineLayout(&writer, pCreateInfo);
+		entry = vilc_layoutCache_allocate(VK_OBJECT_TYPE_PIPELINE_LAYOUT, writer.size, pAllocator);
+		if (entry && pCreateInfo->setLayoutCount)
+		{
+			entry->setLayoutCount = pCreateInfo->setLayoutCount;
+			entry->setLayouts = (VilcLayout**)calloc(pCreateInfo->setLayoutCount, sizeof(VilcLayout*));
+			if (!entry->setLayouts)
+			{
+				free(entry);
+				entry = NULL;
+			}
+		}
+		if (entry)
+		{
+			writer.data = entry->key;
+			writer.size = 0;
+			vilc_layoutCache_writePipelineLayout(&writer, pCreateInfo);
+			vilc_layoutCache_hash(entry);
+		}
+	}
+
+	pthread_mutex_lock(&vilc_layoutCache_mutex);
+	existing = entry ? vilc_layoutCache_acquire(entry) : NULL;
+	if (existing)
+	{
+		vilc_layoutCache_stats.pipelineLayouts.hits++;
+		*pPipelineLayout = existing->pipelineLayout;
+		result = VK_SUCCESS;
+	}
+	else
+	{
+		/* only set layouts the cache keeps alive may be part of a key; VK_NULL_HANDLE sets are fine */
+		for (i = 0; entry && i < entry->setLayoutCount; ++i)
+			if (pCreateInfo->pSetLayouts[i] && !(entry->setLayouts[i] = (VilcLayout*)vilc_mapFind(&vilc_layoutCache_setLayouts, VILC_OBJECT_KEY(pCreateInfo->pSetLayouts[i]))))
+				break;
+
+		result = vilc_layoutCache_next_vkCreatePipelineLayout(device, pCreateInfo, pAllocator, pPipelineLayout);
+		if (result == VK_SUCCESS && entry && i == entry->setLayoutCount)
+		{
+			entry->pipelineLayout = *pPipelineLayout;
+			cached = vilc_layoutCache_insert(&vilc_layoutCache_pipelineLayouts, VILC_OBJECT_KEY(*pPipelineLayout), entry);
+		}
+
+		if (cached)
+		{
+			for (i = 0; i < entry->setLayoutCount; ++i)
+				if (entry->setLayouts[i])
+					entry->setLayouts[i]->references++;
+			vilc_layoutCache_stats.pipelineLayouts.misses++;
+			vilc_layoutCache_stats.pipelineLayouts.layouts++;
+		}
+		else if (result == VK_SUCCESS)
+			vilc_layoutCache_stats.pipelineLayouts.uncached++;
+	}
+	pthread_mutex_unlock(&vilc_layoutCache_mutex);
+
+	if (entry && !cached)
+	{
+		free(entry->setLayouts);
+		free(entry);
+	}
+
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_layoutCache_vkDestroyPipelineLayout(VkDevice device, VkPipelineLayout pipelineLayout, const VkAllocationCallbacks* pAllocator)
+{
+	VilcLayout* entry = NULL;
+
+	pthread_mutex_lock(&vilc_layoutCache_mutex);
+	if (pipelineLayout && device == vilc_layoutCache_device)
+		entry = (VilcLayout*)vilc_mapFind(&vilc_layoutCache_pipelineLayouts, VILC_OBJECT_KEY(pipelineLayout));
+	if (entry)
+		vilc_layoutCache_release(device, entry);
+	pthread_mutex_unlock(&vilc_layoutCache_mutex);
+
+	if (!entry)
+		vilc_layoutCache_next_vkDestroyPipelineLayout(device, pipelineLayout, pAllocator);
+}
+
+static void vilc_layoutCache_installInstance(void)
+{
+	VILC_LAYER_HOOK(vilc_layoutCache, vkCreateDevice)
+}
+
+static void vilc_layoutCache_installDevice(void)
+{
+	VILC_LAYER_HOOK(vilc_layoutCache, vkDestroyDevice)
+	VILC_LAYER_HOOK(vilc_layoutCache, vkCreateDescriptorSetLayout)
+	VILC_LAYER_HOOK(vilc_layoutCache, vkDestroyDescriptorSetLayout)
+	VILC_LAYER_HOOK(vilc_layoutCache, vkCreatePipelineLayout)
+	VILC_LAYER_HOOK(vilc_layoutCache, vkDestroyPipelineLayout)
+}
+#endif /* VILC_LAYOUT_CACHE */
+
+#if defined(VOLK_IN_LOADERS_CLOTH) && defined(VILC_PIPELINE_CACHE)
+/* Persistent pipeline cache: vkCreateGraphicsPipelines/vkCreateComputePipelines calls without a VkPipelineCache use
+ * an internal one instead. It is seeded from a file mapped at vkCreateDevice, named after the vendor and device IDs,
+ * the driver version and pipelineCacheUUID, and written back from vkGetPipelineCacheData at vkDestroyDevice and
+ * every VILC_PIPELINE_CACHE_FLUSH_MS milliseconds (30000 by default, 0 disables) by a background thread.
+ * Files go to VILC_PIPELINE_CACHE_DIR, else $XDG_CACHE_HOME or $HOME/.cache. They are replaced by rename, so readers
+ * never see a partial file, and a file whose header or checksum does not match is ignored.
+ */
+#define VILC_PIPELINE_CACHE_MAGIC 0x434c4956u /* "VILC" */
+#define VILC_PIPELINE_CACHE_VERSION 1
+#define VILC_PIPELINE_CACHE_FLUSH_MS 30000
+
+typedef struct VilcPipelineCacheHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t vendorID;
+	uint32_t deviceID;
+	uint32_t driverVersion;
+	uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+	uint32_t reserved;
+	/* everything above must match the device; the data follows the header */
+	uint64_t dataSize;
+	uint64_t dataHash;
+} VilcPipelineCacheHeader;
+
+static pthread_mutex_t vilc_pipelineCache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t vilc_pipelineCache_wake = PTHREAD_COND_INITIALIZER;
+static pthread_t vilc_pipelineCache_thread;
+static int vilc_pipelineCache_threadRunning;
+static int vilc_pipelineCache_stop;
+static VkDevice vilc_pipelineCache_device;
+static VkPipelineCache vilc_pipelineCache_cache;
+static int vilc_pipelineCache_createFailed;
+static VilcPipelineCacheHeader vilc_pipelineCache_header;
+static char vilc_pipelineCache_path[1024];
+static const VilcPipelineCacheHeader* vilc_pipelineCache_mapping;
+static size_t vilc_pipelineCache_mappingSize;
+static size_t vilc_pipelineCache_persistedSize;
+static VilcPipelineCacheStats vilc_pipelineCache_stats;
+
+VILC_LAYER_NEXT(vilc_pipelineCache, vkCreateDevice)
+VILC_LAYER_NEXT(vilc_pipelineCache, vkDestroyDevice)
+VILC_LAYER_NEXT(vilc_pipelineCache, vkCreateGraphicsPipelines)
+VILC_LAYER_NEXT(vilc_pipelineCache, vkCreateComputePipelines)
+
+static void vilc_pipelineCache_setPath(const VkPhysicalDeviceProperties* properties)
+{
+	const char* directory = getenv("VILC_PIPELINE_CACHE_DIR");
+	const char* home = getenv("HOME");
+	char defaultDirectory[512];
+	char uuid[VK_UUID_SIZE * 2 + 1];
+	uint32_t i;
+
+	if (!directory || !directory[0])
+		directory = getenv("XDG_CACHE_HOME");
+	if ((!directory || !directory[0]) && home && home[0])
+	{
+		snprintf(defaultDirectory, sizeof(defaultDirectory), "%s/.cache", home);
+		directory = defaultDirectory;
+	}
+
+	vilc_pipelineCache_path[0] = 0;
+	if (!directory || !directory[0])
+		return;
+
+	for (i = 0; i < VK_UUID_SIZE; ++i)
+		snprintf(uuid + i * 2, 3, "%02x", properties->pipelineCacheUUID[i]);
+	if (snprintf(vilc_pipelineCache_path, sizeof(vilc_pipelineCache_path), "%s/vilc-pipeline-cache-%04x-%04x-%08x-%s.bin", directory,
+	        properties->vendorID, properties->deviceID, properties->driverVersion, uuid) >= (int)sizeof(vilc_pipelineCache_path))
+		vilc_pipelineCache_path[0] = 0;
+}
+
+/* Maps the cache file of the device if it is intact; the mapping is dropped once the VkPipelineCache is created */
+static void vilc_pipelineCache_load(void)
+{
+	const VilcPipelineCacheHeader* header;
+	struct stat status;
+	void* mapping;
+	int fd;
+
+	if (!vilc_pipelineCache_path[0] || (fd = open(vilc_pipelineCache_path, O_RDONLY)) < 0)
+		return;
+
+	if (fstat(fd, &status) == 0 && (uint64_t)status.st_size > sizeof(VilcPipelineCacheHeader) &&
+	    (mapping = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, fd, 0)) != MAP_FAILED)
+	{
+		header = (const VilcPipelineCacheHeader*)mapping;
+		if (memcmp(header, &vilc_pipelineCache_header, offsetof(VilcPipelineCacheHeader, dataSize)) == 0 &&
+		    header->dataSize == (uint64_t)status.st_size - sizeof(VilcPipelineCacheHeader) && header->dataHash == vilc_hashBytes(header + 1, (size_t)header->dataSize, 0))
+		{
+			vilc_pipelineCache_mapping = header;
+			vilc_pipelineCache_mappingSize = (size_t)status.st_size;
+		}
+		else
+		{
+			munmap(mapping, (size_t)status.st_size);
+			vilc_pipelineCache_stats.rejectedFiles++;
+			fprintf(stderr, "vilc: pipeline cache: ignoring %s, it does not match the device or is corrupt\n", vilc_pipelineCache_path);
+		}
+	}
+	close(fd);
+}
+
+static void vilc_pipelineCache_unmap(void)
+{
+	if (vilc_pipelineCache_mapping)
+		munmap((void*)vilc_pipelineCache_mapping, vilc_pipelineCache_mappingSize);
+	vilc_pipelineCache_mapping = NULL;
+	vilc_pipelineCache_mappingSize = 0;
+}
+
+/* Writes the cache if it grew since it was loaded or last written; caller locks */
+static void vilc_pipelineCache_save(void)
+{
+	VilcPipelineCacheHeader header = vilc_pipelineCache_header;
+	char temporary[sizeof(vilc_pipelineCache_path) + 32];
+	unsigned char* data;
+	size_t size = 0;
+	FILE* file;
+	int written = 0;
+
+	if (!vilc_pipelineCache_cache || !vilc_pipelineCache_path[0])
+		return;
+	if (vilc_device.vkGetPipelineCacheData(vilc_pipelineCache_device, vilc_pipelineCache_cache, &size, NULL) != VK_SUCCESS || size == 0 || size == vilc_pipelineCache_persistedSize)
+		return;
+
+	data = (unsigned char*)malloc(sizeof(header) + size);
+	if (!data)
+		return;
+
+	/* VK_INCOMPLETE means the cache grew in between; the next flush gets it */
+	if (vilc_device.vkGetPipelineCacheData(vilc_pipelineCache_device, vilc_pipelineCache_cache, &size, data + sizeof(header)) == VK_SUCCESS)
+	{
+		header.dataSize = size;
+		header.dataHash = vilc_hashBytes(data + sizeof(header), size, 0);
+		memcpy(data, &header, sizeof(header));
+
+		snprintf(temporary, sizeof(temporary), "%s.%d.tmp", vilc_pipelineCache_path, (int)getpid());
+		file = fopen(temporary, "wb");
+		if (file)
+		{
+			written = fwrite(data, 1, sizeof(header) + size, file) == sizeof(header) + size;
+			written = fclose(file) == 0 && written;
+		}
+		if (written && rename(temporary, vilc_pipelineCache_path) == 0)
+		{
+			vilc_pipelineCache_persistedSize = size;
+			vilc_pipelineCache_stats.savedBytes = size;
+			vilc_pipelineCache_stats.saveCount++;
+		}
+		else
+		{
+			remove(temporary);
+			fprintf(stderr, "vilc: pipeline cache: failed to write %s\n", vilc_pipelineCache_path);
+		}
+	}
+
+	free(data);
+}
+
+static void* vilc_pipelineCache_flushThread(void* interval)
+{
+	uint32_t intervalMs = (uint32_t)(uintptr_t)interval;
+	struct timespec deadline;
+
+	pthread_mutex_lock(&vilc_pipelineCache_mutex);
+	while (!vilc_pipelineCache_stop)
+	{
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		deadline.tv_sec += intervalMs / 1000;
+		deadline.tv_nsec += (long)(intervalMs % 1000) * 1000000;
+		if (deadline.tv_nsec >= 1000000000)
+		{
+			deadline.tv_sec++;
+			deadline.tv_nsec -= 1000000000;
+		}
+
+		if (pthread_cond_timedwait(&vilc_pipelineCache_wake, &vilc_pipelineCache_mutex, &deadline) == ETIMEDOUT && !vilc_pipelineCache_stop)
+			vilc_pipelineCache_save();
+	}
+	pthread_mutex_unlock(&vilc_pipelineCache_mutex);
+
+	return NULL;
+}
+
+/* Returns the internal cache, created on first use since the device table is only loaded after vkCreateDevice */
+static VkPipelineCache vilc_pipelineCache_substitute(void)
+{
+	VkPipelineCache cache = VILC_ATOMIC_LOAD_ACQUIRE(&vilc_pipelineCache_cache);
+	VkPipelineCacheCreateInfo createInfo;
+
+	if (cache)
+	{
+		VILC_ATOMIC_ADD(&vilc_pipelineCache_stats.substitutedCalls, 1);
+		return cache;
+	}
+
+	pthread_mutex_lock(&vilc_pipelineCache_mutex);
+	if (!vilc_pipelineCache_cache && !vilc_pipelineCache_createFailed)
+	{
+		memset(&createInfo, 0, sizeof(createInfo));
+		createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		if (vilc_pipelineCache_mapping)
+		{
+			createInfo.initialDataSize = (size_t)vilc_pipelineCache_mapping->dataSize;
+			createInfo.pInitialData = vilc_pipelineCache_mapping + 1;
+		}
+
+		/* drivers ignore initial data they can not use, but do not count on it */
+		if (vilc_device.vkCreatePipelineCache(vilc_pipelineCache_device, &createInfo, NULL, &cache) != VK_SUCCESS && createInfo.initialDataSize)
+		{
+			createInfo.initialDataSize = 0;
+			createInfo.pInitialData = NULL;
+			vilc_device.vkCreatePipelineCache(vilc_pipelineCache_device, &createInfo, NULL, &cache);
+		}
+
+		vilc_pipelineCache_createFailed = !cache;
+		vilc_pipelineCache_stats.loadedBytes = cache ? createInfo.initialDataSize : 0;
+		vilc_pipelineCache_persistedSize = vilc_pipelineCache_stats.loadedBytes;
+		vilc_pipelineCache_unmap();
+		VILC_ATOMIC_STORE_RELEASE(&vilc_pipelineCache_cache, cache);
+	}
+	cache = vilc_pipelineCache_cache;
+	if (cache)
+		VILC_ATOMIC_ADD(&vilc_pipelineCache_stats.substitutedCalls, 1);
+	pthread_mutex_unlock(&vilc_pipelineCache_mutex);
+
+	return cache;
+}
+
+void vilcGetPipelineCacheStats(VilcPipelineCacheStats* stats)
+{
+	pthread_mutex_lock(&vilc_pipelineCache_mutex);
+	*stats = vilc_pipelineCache_stats;
+	stats->substitutedCalls = VILC_ATOMIC_LOAD(&vilc_pipelineCache_stats.substitutedCalls);
+	pthread_mutex_unlock(&vilc_pipelineCache_mutex);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_pipelineCache_vkCreateDevice(VkPhysicalDevice physicalDevice, const VkDeviceCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDevice* pDevice)
+{
+	VkPhysicalDeviceProperties properties;
+	const char* flush = getenv("VILC_PIPELINE_CACHE_FLUSH_MS");
+	uint32_t intervalMs = flush ? (uint32_t)strtoul(flush, NULL, 10) : VILC_PIPELINE_CACHE_FLUSH_MS;
+	VkResult result;
+
+	result = vilc_pipelineCache_next_vkCreateDevice(physicalDevice, pCreateInfo, pAllocator, pDevice);
+	if (result != VK_SUCCESS)
+		return result;
+
+	vilc_instance.vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+	pthread_mutex_lock(&vilc_pipelineCache_mutex);
+	/* a second device is passed through; its pipelines simply miss the persistent cache */
+	if (!vilc_pipelineCache_device)
+	{
+		vilc_pipelineCache_device = *pDevice;
+		memset(&vilc_pipelineCache_stats, 0, sizeof(vilc_pipelineCache_stats));
+		memset(&vilc_pipelineCache_header, 0, sizeof(vilc_pipelineCache_header));
+		vilc_pipelineCache_header.magic = VILC_PIPELINE_CACHE_MAGIC;
+		vilc_pipelineCache_header.version = VILC_PIPELINE_CACHE_VERSION;
+		vilc_pipelineCache_header.vendorID = properties.vendorID;
+		vilc_pipelineCache_header.deviceID = properties.deviceID;
+		vilc_pipelineCache_header.driverVersion = properties.driverVersion;
+		memcpy(vilc_pipelineCache_header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+
+		vilc_pipelineCache_setPath(&properties);
+		vilc_pipelineCache_load();
+
+		vilc_pipelineCache_stop = 0;
+		if (intervalMs && vilc_pipelineCache_path[0])
+			vilc_pipelineCache_threadRunning = pthread_create(&vilc_pipelineCache_thread, NULL, vilc_pipelineCache_flushThread, (void*)(uintptr_t)intervalMs) == 0;
+	}
+	pthread_mutex_unlock(&vilc_pipelineCache_mutex);
+
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_pipelineCache_vkDestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator)
+{
+	int current;
+
+	pthread_mutex_lock(&vilc_pipelineCache_mutex);
+	current = device && device == vilc_pipelineCache_device;
+	if (current)
+	{
+		vilc_pipelineCache_stop = 1;
+		pthread_cond_signal(&vilc_pipelineCache_wake);
+	}
+	pthread_mutex_unlock(&vilc_pipelineCache_mutex);
+
+	if (current && vilc_pipelineCache_threadRunning)
+	{
+		pthread_join(vilc_pipelineCache_thread, NULL);
+		vilc_pipelineCache_threadRunning = 0;
+	}
+
+	if (current)
+	{
+		pthread_mutex_lock(&vilc_pipelineCache_mutex);
+		vilc_pipelineCache_save();
+		if (vilc_pipelineCache_cache)
+			vilc_device.vkDestroyPipelineCache(device, vilc_pipelineCache_cache, NULL);
+		vilc_pipelineCache_unmap();
+		vilc_pipelineCache_cache = VK_NULL_HANDLE;
+		vilc_pipelineCache_createFailed = 0;
+		vilc_pipelineCache_device = VK_NULL_HANDLE;
+
+		fprintf(stderr, "vilc: pipeline cache: %llu calls substituted, %llu bytes loaded, %llu bytes saved\n",
+		    (unsigned long long)vilc_pipelineCache_stats.substitutedCalls, (unsigned long long)vilc_pipelineCache_stats.loadedBytes,
+		    (unsigned long long)vilc_pipelineCache_stats.savedBytes);
+		pthread_mutex_unlock(&vilc_pipelineCache_mutex);
+	}
+
+	vilc_pipelineCache_next_vkDestroyDevice(device, pAllocator);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_pipelineCache_vkCreateGraphicsPipelines(VkDevice device, VkPipelineCache pipelineCache, uint32_t createInfoCount, const VkGraphicsPipelineCreateInfo* pCreateInfos, const VkAllocationCallbacks* pAllocator, VkPipeline* pPipelines)
+{
+	if (!pipelineCache && device == vilc_pipelineCache_device)
+		pipelineCache = vilc_pipelineCache_substitute();
+	return vilc_pipelineCache_next_vkCreateGraphicsPipelines(device, pipelineCache, createInfoCount, pCreateInfos, pAllocator, pPipelines);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_pipelineCache_vkCreateComputePipelines(VkDevice device, VkPipelineCache pipelineCache, uint32_t createInfoCount, const VkComputePipelineCreateInfo* pCreateInfos, const VkAllocationCallbacks* pAllocator, VkPipeline* pPipelines)
+{
+	if (!pipelineCache && device == vilc_pipelineCache_device)
+		pipelineCache = vilc_pipelineCache_substitute();
+	return vilc_pipelineCache_next_vkCreateComputePipelines(device, pipelineCache, createInfoCount, pCreateInfos, pAllocator, pPipelines);
+}
+
+static void vilc_pipelineCache_installInstance(void)
+{
+	VILC_LAYER_HOOK(vilc_pipelineCache, vkCreateDevice)
+}
+
+static void vilc_pipelineCache_installDevice(void)
+{
+	VILC_LAYER_HOOK(vilc_pipelineCache, vkDestroyDevice)
+	VILC_LAYER_HOOK(vilc_pipelineCache, vkCreateGraphicsPipelines)
+	VILC_LAYER_HOOK(vilc_pipelineCache, vkCreateComputePipelines)
+}
+#endif /* VILC_PIPELINE_CACHE */
+
+#if defined(VOLK_IN_LOADERS_CLOTH) && defined(VILC_PARALLEL_PIPELINES)
+/* Parallel pipeline creation: vkCreateGraphicsPipelines/vkCreateComputePipelines calls with at least
+ * VILC_PARALLEL_PIPELINES_MIN_BATCH create infos (8 by default) are split into chunks that a pool of worker threads
+ * and the calling thread pass to the driver concurrently. VILC_PARALLEL_PIPELINES_THREADS sets the number of workers,
+ * by default one less than the number of online cores.
+ * With a VkPipelineCache, each thread creates its chunks with a private cache seeded from the application cache, so
+ * they do not contend on it, and the private caches are merged back with vkMergePipelineCaches before returning.
+ * Pipelines are written in place, so their order is unchanged. The call returns the error of the first failing chunk,
+ * else VK_PIPELINE_COMPILE_REQUIRED if any chunk returned it. Calls whose result depends on creation order
+ * (basePipelineIndex, VK_PIPELINE_CREATE_EARLY_RETURN_ON_FAILURE_BIT) or that pass allocation callbacks, which must
+ * not be called from other threads, are passed through whole.
+ */
+#define VILC_PARALLEL_PIPELINES_MIN_BATCH 8
+#define VILC_PARALLEL_PIPELINES_MAX_THREADS 64
+/* several chunks per thread, so threads that get quick pipelines take over more of the batch */
+#define VILC_PARALLEL_PIPELINES_CHUNKS_PER_THREAD 2
+
+typedef struct VilcPipelineBatch
+{
+	struct VilcPipelineBatch* next;
+	VkDevice device;
+	VkPipelineCache pipelineCache;
+	const void* seedData;
+	size_t seedSize;
+	const VkGraphicsPipelineCreateInfo* graphicsInfos;
+	const VkComputePipelineCreateInfo* computeInfos;
+	VkPipeline* pPipelines;
+	uint32_t createInfoCount;
+	uint32_t chunkSize;
+	uint32_t chunkCount;
+	uint32_t nextChunk; /* claimed atomically; the fields below are protected by vilc_parallelPipelines_mutex */
+	uint32_t completedChunks;
+	uint32_t users; /* workers that took the batch from the queue and may still access it */
+	int cacheFailed;
+	VkResult* chunkResults;
+	VkPipelineCache* caches; /* private cache of each thread, indexed by worker slot; slot 0 is the calling thread */
+} VilcPipelineBatch;
+
+static pthread_mutex_t vilc_parallelPipelines_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t vilc_parallelPipelines_work = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t vilc_parallelPipelines_done = PTHREAD_COND_INITIALIZER;
+static pthread_t vilc_parallelPipelines_threads[VILC_PARALLEL_PIPELINES_MAX_THREADS];
+static uint32_t vilc_parallelPipelines_threadCount;
+static uint32_t vilc_parallelPipelines_minBatch;
+static int vilc_parallelPipelines_started;
+static int vilc_parallelPipelines_stop;
+static VilcPipelineBatch* vilc_parallelPipelines_queue;
+static VilcParallelPipelineStats vilc_parallelPipelines_stats;
+
+VILC_LAYER_NEXT(vilc_parallelPipelines, vkDestroyDevice)
+VILC_LAYER_NEXT(vilc_parallelPipelines, vkCreateGraphicsPipelines)
+VILC_LAYER_NEXT(vilc_parallelPipelines, vkCreateComputePipelines)
+
+/* Returns whether the pipeline refers to an earlier create info of the call, or must stop later ones on failure */
+static int vilc_parallelPipelines_ordered(VkPipelineCreateFlags flags, const void* pNext, int32_t basePipelineIndex)
+{
+	uint64_t allFlags = flags;
+#if defined(VK_KHR_maintenance5)
+	const VkBaseInStructure* ext;
+
+	/* VkPipelineCreateFlags2CreateInfoKHR replaces flags; the bits below have the same values in both */
+	for (ext = (const VkBaseInStructure*)pNext; ext; ext = ext->pNext)
+		if (ext->sType == VK_STRUCTURE_TYPE_PIPELINE_CREATE_FLAGS_2_CREATE_INFO_KHR)
+			allFlags = ((const VkPipelineCreateFlags2CreateInfoKHR*)ext)->flags;
+#endif
+
+	if ((allFlags & VK_PIPELINE_CREATE_DERIVATIVE_BIT) && basePipelineIndex >= 0)
+		return 1;
+	return (allFlags & VK_PIPELINE_CREATE_EARLY_RETURN_ON_FAILURE_BIT) != 0;
+}
+
+static void vilc_parallelPipelines_dequeue(VilcPipelineBatch* batch)
+{
+	VilcPipelineBatch** link = &vilc_parallelPipelines_queue;
+
+	while (*link && *link != batch)
+		link = &(*link)->next;
+	if (*link)
+		*link = batch->next;
+}
+
+/* Creates chunks until all are claimed; returns the number created */
+static uint32_t vilc_parallelPipelines_createChunks(VilcPipelineBatch* batch, uint32_t slot)
+{
+	VkPipelineCache cache = batch->pipelineCache;
+	VkPipelineCacheCreateInfo createInfo;
+	uint32_t chunk, first, count, completed = 0;
+
+	if (cache)
+	{
+		if (VILC_ATOMIC_LOAD(&batch->nextChunk) >= batch->chunkCount)
+			return 0;
+
+		if (!batch->caches[slot])
+		{
+			memset(&createInfo, 0, sizeof(createInfo));
+			createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+			createInfo.initialDataSize = batch->seedSize;
+			createInfo.pInitialData = batch->seedData;
+			if (vilc_device.vkCreatePipelineCache(batch->device, &createInfo, NULL, &batch->caches[slot]) != VK_SUCCESS)
+				batch->caches[slot] = VK_NULL_HANDLE;
+		}
+
+		/* the application cache may be externally synchronized, so only the calling thread falls back to it */
+		if (batch->caches[slot])
+			cache = batch->caches[slot];
+		else if (slot)
+			return 0;
+	}
+
+	while ((chunk = VILC_ATOMIC_ADD(&batch->nextChunk, 1) - 1) < batch->chunkCount)
+	{
+		first = chunk * batch->chunkSize;
+		count = batch->createInfoCount - first < batch->chunkSize ? batch->createInfoCount - first : batch->chunkSize;
+		if (batch->graphicsInfos)
+			batch->chunkResults[chunk] = vilc_parallelPipelines_next_vkCreateGraphicsPipelines(batch->device, cache, count, batch->graphicsInfos + first, NULL, batch->pPipelines + first);
+		else
+			batch->chunkResults[chunk] = vilc_parallelPipelines_next_vkCreateComputePipelines(batch->device, cache, count, batch->computeInfos + first, NULL, batch->pPipelines + first);
+		completed++;
+	}
+
+	return completed;
+}
+
+static void* vilc_parallelPipelines_worker(void* slot)
+{
+	VilcPipelineBatch* batch;
+	uint32_t completed;
+
+	pthread_mutex_lock(&vilc_parallelPipelines_mutex);
+	while (!vilc_parallelPipelines_stop)
+	{
+		batch = vilc_parallelPipelines_queue;
+		if (!batch)
+		{
+			pthread_cond_wait(&vilc_parallelPipelines_work, &vilc_parallelPipelines_mutex);
+			continue;
+		}
+
+		/* the threads that claimed the last chunks finish the batch */
+		if (batch->cacheFailed || VILC_ATOMIC_LOAD(&batch->nextChunk) >= batch->chunkCount)
+		{
+			vilc_parallelPipelines_dequeue(batch);
+			continue;
+		}
+
+		batch->users++;
+		pthread_mutex_unlock(&vilc_parallelPipelines_mutex);
+		completed = vilc_parallelPipelines_createChunks(batch, (uint32_t)(uintptr_t)slot);
+		pthread_mutex_lock(&vilc_parallelPipelines_mutex);
+
+		batch->cacheFailed |= batch->pipelineCache && !batch->caches[(uintptr_t)slot];
+		batch->completedChunks += completed;
+		batch->users--;
+		pthread_cond_broadcast(&vilc_parallelPipelines_done);
+	}
+	pthread_mutex_unlock(&vilc_parallelPipelines_mutex);
+
+	return NULL;
+}
+
+/* Starts the workers on first use; called with vilc_parallelPipelines_mutex held */
+static void vilc_parallelPipelines_start(void)
+{
+	const char* threads = getenv("VILC_PARALLEL_PIPELINES_THREADS");
+	const char* minBatch = getenv("VILC_PARALLEL_PIPELINES_MIN_BATCH");
+	long count = threads ? strtol(threads, NULL, 10) : sysconf(_SC_NPROCESSORS_ONLN) - 1;
+	uint32_t i;
+
+	if (vilc_parallelPipelines_started)
+		return;
+
+	count = count < 0 ? 0 : count > VILC_PARALLEL_PIPELINES_MAX_THREADS ? VILC_PARALLEL_PIPELINES_MAX_THREADS : count;
+	vilc_parallelPipelines_minBatch = minBatch ? (uint32_t)strtoul(minBatch, NULL, 10) : VILC_PARALLEL_PIPELINES_MIN_BATCH;
+	vilc_parallelPipelines_minBatch = vilc_parallelPipelines_minBatch < 2 ? 2 : vilc_parallelPipelines_minBatch;
+
+	vilc_parallelPipelines_stop = 0;
+	vilc_parallelPipelines_threadCount = 0;
+	for (i = 0; i < (uint32_t)count; ++i)
+	{
+		/* worker slots start at 1 */
+		if (pthread_create(&vilc_parallelPipelines_threads[i], NULL, vilc_parallelPipelines_worker, (void*)(uintptr_t)(i + 1)) != 0)
+			break;
+		vilc_parallelPipelines_threadCount++;
+	}
+	vilc_parallelPipelines_stats.threads = vilc_parallelPipelines_threadCount;
+	vilc_parallelPipelines_started = 1;
+}
+
+static void vilc_parallelPipelines_stopWorkers(void)
+{
+	uint32_t i, threadCount;
+
+	pthread_mutex_lock(&vilc_parallelPipelines_mutex);
+	threadCount = vilc_parallelPipelines_started ? vilc_parallelPipelines_threadCount : 0;
+	vilc_parallelPipelines_stop = 1;
+	pthread_cond_broadcast(&vilc_parallelPipelines_work);
+	pthread_mutex_unlock(&vilc_parallelPipelines_mutex);
+
+	/* workers finish the chunks they claimed first; batches still running complete on their calling threads */
+	for (i = 0; i < threadCount; ++i)
+		pthread_join(vilc_parallelPipelines_threads[i], NULL);
+
+	pthread_mutex_lock(&vilc_parallelPipelines_mutex);
+	vilc_parallelPipelines_started = 0;
+	vilc_parallelPipelines_threadCount = 0;
+	pthread_mutex_unlock(&vilc_parallelPipelines_mutex);
+}
+
+/* Reads the application cache the private caches are seeded from; NULL when it is empty or can not be read */
+static void* vilc_parallelPipelines_readCache(VkDevice device, VkPipelineCache pipelineCache, size_t* pSize)
+{
+	void* data;
+	VkResult result;
+
+	*pSize = 0;
+	if (vilc_device.vkGetPipelineCacheData(device, pipelineCache, pSize, NULL) != VK_SUCCESS || !*pSize)
+		return NULL;
+
+	data = malloc(*pSize);
+	if (!data)
+		return NULL;
+
+	/* the cache can only grow in the meantime, and an incomplete read still yields valid data */
+	result = vilc_device.vkGetPipelineCacheData(device, pipelineCache, pSize, data);
+	if (result != VK_SUCCESS && result != VK_INCOMPLETE)
+	{
+		free(data);
+		return NULL;
+	}
+	return data;
+}
+
+/* Creates the pipelines of the batch across the workers; returns 0 when the call has to be passed through whole */
+static int vilc_parallelPipelines_create(VilcPipelineBatch* batch, VkResult* pResult)
+{
+	VilcPipelineBatch** link;
+	uint32_t threadCount, chunkCount, mergeCount = 0, completed, i;
+	VkResult result = VK_SUCCESS;
+	void* seed = NULL;
+
+	pthread_mutex_lock(&vilc_parallelPipelines_mutex);
+	vilc_parallelPipelines_start();
+	threadCount = vilc_parallelPipelines_stop ? 0 : vilc_parallelPipelines_threadCount;
+	threadCount = batch->createInfoCount < vilc_parallelPipelines_minBatch ? 0 : threadCount;
+	pthread_mutex_unlock(&vilc_parallelPipelines_mutex);
+
+	if (!threadCount)
+		return 0;
+
+	chunkCount = (threadCount + 1) * VILC_PARALLEL_PIPELINES_CHUNKS_PER_THREAD;
+	batch->chunkSize = (batch->createInfoCount + chunkCount - 1) / chunkCount;
+	batch->chunkCount = (batch->createInfoCount + batch->chunkSize - 1) / batch->chunkSize;
+	batch->chunkResults = (VkResult*)calloc(batch->chunkCount, sizeof(VkResult));
+	batch->caches = (VkPipelineCache*)calloc(threadCount + 1, sizeof(VkPipelineCache));
+	if (!batch->chunkResults || !batch->caches)
+	{
+		free(batch->chunkResults);
+		free(batch->caches);
+		return 0;
+	}
+
+	if (batch->pipelineCache)
+	{
+		seed = vilc_parallelPipelines_readCache(batch->device, batch->pipelineCache, &batch->seedSize);
+		batch->seedData = seed;
+	}
+
+	pthread_mutex_lock(&vilc_parallelPipelines_mutex);
+	for (link = &vilc_parallelPipelines_queue; *link; link = &(*link)->next)
+		;
+	*link = batch;
+	pthread_cond_broadcast(&vilc_parallelPipelines_work);
+	pthread_mutex_unlock(&vilc_parallelPipelines_mutex);
+
+	completed = vilc_parallelPipelines_createChunks(batch, 0);
+
+	pthread_mutex_lock(&vilc_parallelPipelines_mutex);
+	batch->completedChunks += completed;
+	while (batch->completedChunks < batch->chunkCount || batch->users)
+		pthread_cond_wait(&vilc_parallelPipelines_done, &vilc_parallelPipelines_mutex);
+	vilc_parallelPipelines_dequeue(batch);
+	vilc_parallelPipelines_stats.splitCalls++;
+	vilc_parallelPipelines_stats.splitPipelines += batch->createInfoCount;
+	pthread_mutex_unlock(&vilc_parallelPipelines_mutex);
+
+	for (i = 0; i <= threadCount; ++i)
+		if (batch->caches[i])
+			batch->caches[mergeCount++] = batch->caches[i];
+	if (mergeCount)
+		vilc_device.vkMergePipelineCaches(batch->device, batch->pipelineCache, mergeCount, batch->caches);
+	for (i = 0; i < mergeCount; ++i)
+		vilc_device.vkDestroyPipelineCache(batch->device, batch->caches[i], NULL);
+
+	/* the first error in create info order, as if the driver had stopped at it; compile required only without errors */
+	for (i = 0; i < batch->chunkCount && result >= 0; ++i)
+		if (batch->chunkResults[i] < 0 || batch->chunkResults[i] == VK_PIPELINE_COMPILE_REQUIRED)
+			result = batch->chunkResults[i];
+
+	free(seed);
+	free(batch->chunkResults);
+	free(batch->caches);
+	*pResult = result;
+	return 1;
+}
+
+void vilcGetParallelPipelineStats(VilcParallelPipelineStats* stats)
+{
+	pthread_mutex_lock(&vilc_parallelPipelines_mutex);
+	*stats = vilc_parallelPipelines_stats;
+	stats->passedThroughCalls = VILC_ATOMIC_LOAD(&vilc_parallelPipelines_stats.passedThroughCalls);
+	pthread_mutex_unlock(&vilc_parallelPipelines_mutex);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_parallelPipelines_vkDestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator)
+{
+	/* workers call through the device table, so they do not outlive the device; the next split restarts them */
+	vilc_parallelPipelines_stopWorkers();
+
+	pthread_mutex_lock(&vilc_parallelPipelines_mutex);
+	fprintf(stderr, "vilc: parallel pipelines: %llu calls split across %u threads (%llu pipelines), %llu passed through\n",
+	    (unsigned long long)vilc_parallelPipelines_stats.splitCalls, vilc_parallelPipelines_stats.threads + 1,
+	    (unsigned long long)vilc_parallelPipelines_stats.splitPipelines, (unsigned long long)VILC_ATOMIC_LOAD(&vilc_parallelPipelines_stats.passedThroughCalls));
+	pthread_mutex_unlock(&vilc_parallelPipelines_mutex);
+
+	vilc_parallelPipelines_next_vkDestroyDevice(device, pAllocator);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_parallelPipelines_vkCreateGraphicsPipelines(VkDevice device, VkPipelineCache pipelineCache, uint32_t createInfoCount, const VkGraphicsPipelineCreateInfo* pCreateInfos, const VkAllocationCallbacks* pAllocator, VkPipeline* pPipelines)
+{
+	VilcPipelineBatch batch;
+	VkResult result;
+	int split = !pAllocator && createInfoCount > 1;
+	uint32_t i;
+
+	for (i = 0; split && i < createInfoCount; ++i)
+		split = !vilc_parallelPipelines_ordered(pCreateInfos[i].flags, pCreateInfos[i].pNext, pCreateInfos[i].basePipelineIndex);
+
+	memset(&batch, 0, sizeof(batch));
+	batch.device = device;
+	batch.pipelineCache = pipelineCache;
+	batch.graphicsInfos = pCreateInfos;
+	batch.pPipelines = pPipelines;
+	batch.createInfoCount = createInfoCount;
+	if (split && vilc_parallelPipelines_create(&batch, &result))
+		return result;
+
+	VILC_ATOMIC_ADD(&vilc_parallelPipelines_stats.passedThroughCalls, 1);
+	return vilc_parallelPipelines_next_vkCreateGraphicsPipelines(device, pipelineCache, createInfoCount, pCreateInfos, pAllocator, pPipelines);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_parallelPipelines_vkCreateComputePipelines(VkDevice device, VkPipelineCache pipelineCache, uint32_t createInfoCount, const VkComputePipelineCreateInfo* pCreateInfos, const VkAllocationCallbacks* pAllocator, VkPipeline* pPipelines)
+{
+	VilcPipelineBatch batch;
+	VkResult result;
+	int split = !pAllocator && createInfoCount > 1;
+	uint32_t i;
+
+	for (i = 0; split && i < createInfoCount; ++i)
+		split = !vilc_parallelPipelines_ordered(pCreateInfos[i].flags, pCreateInfos[i].pNext, pCreateInfos[i].basePipelineIndex);
+
+	memset(&batch, 0, sizeof(batch));
+	batch.device = device;
+	batch.pipelineCache = pipelineCache;
+	batch.computeInfos = pCreateInfos;
+	batch.pPipelines = pPipelines;
+	batch.createInfoCount = createInfoCount;
+	if (split && vilc_parallelPipelines_create(&batch, &result))
+		return result;
+
+	VILC_ATOMIC_ADD(&vilc_parallelPipelines_stats.passedThroughCalls, 1);
+	return vilc_parallelPipelines_next_vkCreateComputePipelines(device, pipelineCache, createInfoCount, pCreateInfos, pAllocator, pPipelines);
+}
+
+static void vilc_parallelPipelines_install(void)
+{
+	VILC_LAYER_HOOK(vilc_parallelPipelines, vkDestroyDevice)
+	VILC_LAYER_HOOK(vilc_parallelPipelines, vkCreateGraphicsPipelines)
+	VILC_LAYER_HOOK(vilc_parallelPipelines, vkCreateComputePipelines)
+}
+#endif /* VILC_PARALLEL_PIPELINES */
+
+#if defined(VOLK_IN_LOADERS_CLOTH) && defined(VILC_DEFERRED_HOST_OPERATIONS)
+/* Deferred host operations: vkCreateRayTracingPipelinesKHR and vkBuildAccelerationStructuresKHR calls made without a
+ * VkDeferredOperationKHR are given one, which the calling thread and up to vkGetDeferredOperationMaxConcurrencyKHR - 1
+ * pool threads join with vkDeferredOperationJoinKHR. The call then returns the result of the operation, as if it had
+ * not been deferred. vilcJoinDeferredOperation offers the pool to applications that defer operations themselves.
+ * VILC_DEFERRED_HOST_OPERATIONS_THREADS sets the number of pool threads, by default one less than the online cores.
+ */
+#define VILC_DEFERRED_HOST_OPERATIONS_MAX_THREADS 64
+
+typedef struct VilcDeferredJoin
+{
+	struct VilcDeferredJoin* next;
+	VkDevice device;
+	VkDeferredOperationKHR operation;
+	uint32_t helpers; /* pool threads still to join; protected by vilc_deferredOps_mutex, as is active */
+	uint32_t active;
+} VilcDeferredJoin;
+
+static pthread_mutex_t vilc_deferredOps_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t vilc_deferredOps_work = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t vilc_deferredOps_done = PTHREAD_COND_INITIALIZER;
+static pthread_t vilc_deferredOps_threads[VILC_DEFERRED_HOST_OPERATIONS_MAX_THREADS];
+static uint32_t vilc_deferredOps_threadCount;
+static int vilc_deferredOps_started;
+static int vilc_deferredOps_stop;
+static VilcDeferredJoin* vilc_deferredOps_queue;
+static VilcDeferredHostOperationStats vilc_deferredOps_stats;
+
+VILC_LAYER_NEXT(vilc_deferredOps, vkDestroyDevice)
+VILC_LAYER_NEXT(vilc_deferredOps, vkCreateRayTracingPipelinesKHR)
+VILC_LAYER_NEXT(vilc_deferredOps, vkBuildAccelerationStructuresKHR)
+
+static void vilc_deferredOps_dequeue(VilcDeferredJoin* join)
+{
+	VilcDeferredJoin** link = &vilc_deferredOps_queue;
+
+	while (*link && *link != join)
+		link = &(*link)->next;
+	if (*link)
+		*link = join->next;
+}
+
+/* Joins until the operation has no more work for this thread */
+static VkResult vilc_deferredOps_joinThread(VkDevice device, VkDeferredOperationKHR operation)
+{
+	VkResult result;
+
+	while ((result = vilc_device.vkDeferredOperationJoinKHR(device, operation)) == VK_THREAD_IDLE_KHR)
+		sched_yield();
+	return result;
+}
+
+static void* vilc_deferredOps_worker(void* unused)
+{
+	VilcDeferredJoin* join;
+
+	(void)unused;
+	pthread_mutex_lock(&vilc_deferredOps_mutex);
+	while (!vilc_deferredOps_stop)
+	{
+		join = vilc_deferredOps_queue;
+		if (!join)
+		{
+			pthread_cond_wait(&vilc_deferredOps_work, &vilc_deferredOps_mutex);
+			continue;
+		}
+
+		if (--join->helpers == 0)
+			vilc_deferredOps_dequeue(join);
+		join->active++;
+		pthread_mutex_unlock(&vilc_deferredOps_mutex);
+		vilc_deferredOps_joinThread(join->device, join->operation);
+		pthread_mutex_lock(&vilc_deferredOps_mutex);
+
+		vilc_deferredOps_stats.poolJoins++;
+		join->active--;
+		pthread_cond_broadcast(&vilc_deferredOps_done);
+	}
+	pthread_mutex_unlock(&vilc_deferredOps_mutex);
+
+	return NULL;
+}
+
+/* Starts the pool threads on first use; called with vilc_deferredOps_mutex held */
+static void vilc_deferredOps_start(void)
+{
+	const char* threads = getenv("VILC_DEFERRED_HOST_OPERATIONS_THREADS");
+	long count = threads ? strtol(threads, NULL, 10) : sysconf(_SC_NPROCESSORS_ONLN) - 1;
+	uint32_t i;
+
+	if (vilc_deferredOps_started)
+		return;
+
+	count = count < 0 ? 0 : count > VILC_DEFERRED_HOST_OPERATIONS_MAX_THREADS ? VILC_DEFERRED_HOST_OPERATIONS_MAX_THREADS : count;
+	vilc_deferredOps_stop = 0;
+	vilc_deferredOps_threadCount = 0;
+	for (i = 0; i < (uint32_t)count; ++i)
+	{
+		if (pthread_create(&vilc_deferredOps_threads[i], NULL, vilc_deferredOps_worker, NULL) != 0)
+			break;
+		vilc_deferredOps_threadCount++;
+	}
+	vilc_deferredOps_stats.threads = vilc_deferredOps_threadCount;
+	vilc_deferredOps_started = 1;
+}
+
+static void vilc_deferredOps_stopThreads(void)
+{
+	uint32_t i, threadCount;
+
+	pthread_mutex_lock(&vilc_deferredOps_mutex);
+	threadCount = vilc_deferredOps_started ? vilc_deferredOps_threadCount : 0;
+	vilc_deferredOps_stop = 1;
+	pthread_cond_broadcast(&vilc_deferredOps_work);
+	pthread_mutex_unlock(&vilc_deferredOps_mutex);
+
+	for (i = 0; i < threadCount; ++i)
+		pthread_join(vilc_deferredOps_threads[i], NULL);
+
+	pthread_mutex_lock(&vilc_deferredOps_mutex);
+	vilc_deferredOps_started = 0;
+	vilc_deferredOps_threadCount = 0;
+	pthread_mutex_unlock(&vilc_deferredOps_mutex);
+}
+
+/* Joins the operation from the calling thread and the pool until it completes; returns its result */
+static VkResult vilc_deferredOps_join(VkDevice device, VkDeferredOperationKHR operation)
+{
+	uint32_t concurrency = vilc_device.vkGetDeferredOperationMaxConcurrencyKHR(device, operation);
+	VilcDeferredJoin join;
+	VilcDeferredJoin** link;
+	VkResult result;
+
+	memset(&join, 0, sizeof(join));
+	join.device = device;
+	join.operation = operation;
+
+	pthread_mutex_lock(&vilc_deferredOps_mutex);
+	vilc_deferredOps_start();
+	if (concurrency > 1 && !vilc_deferredOps_stop)
+		join.helpers = concurrency - 1 < vilc_deferredOps_threadCount ? concurrency - 1 : vilc_deferredOps_threadCount;
+	if (join.helpers)
+	{
+		for (link = &vilc_deferredOps_queue; *link; link = &(*link)->next)
+			;
+		*link = &join;
+		pthread_cond_broadcast(&vilc_deferredOps_work);
+	}
+	vilc_deferredOps_stats.joinedOperations++;
+	pthread_mutex_unlock(&vilc_deferredOps_mutex);
+
+	vilc_deferredOps_joinThread(device, operation);
+
+	/* pool threads that have not picked the operation up yet are no longer needed */
+	pthread_mutex_lock(&vilc_deferredOps_mutex);
+	vilc_deferredOps_dequeue(&join);
+	while (join.active)
+		pthread_cond_wait(&vilc_deferredOps_done, &vilc_deferredOps_mutex);
+	pthread_mutex_unlock(&vilc_deferredOps_mutex);
+
+	/* a thread can run out of work before the operation completes; keep joining until it has */
+	while ((result = vilc_device.vkGetDeferredOperationResultKHR(device, operation)) == VK_NOT_READY)
+		if (vilc_deferredOps_joinThread(device, operation) == VK_THREAD_DONE_KHR)
+			sched_yield();
+
+	return result;
+}
+
+/* Returns the operation to defer a call to, or VK_NULL_HANDLE to pass the call through */
+static VkDeferredOperationKHR vilc_deferredOps_create(VkDevice device)
+{
+	VkDeferredOperationKHR operation = VK_NULL_HANDLE;
+
+	if (!vilc_device.vkCreateDeferredOperationKHR || vilc_device.vkCreateDeferredOperationKHR(device, NULL, &operation) != VK_SUCCESS)
+		return VK_NULL_HANDLE;
+	return operation;
+}
+
+/* Waits for the operation a call was deferred to and destroys it; returns the result of the call */
+static VkResult vilc_deferredOps_complete(VkDevice device, VkDeferredOperationKHR operation, VkResult result)
+{
+	if (result == VK_OPERATION_DEFERRED_KHR)
+	{
+		VILC_ATOMIC_ADD(&vilc_deferredOps_stats.deferredCalls, 1);
+		result = vilc_deferredOps_join(device, operation);
+	}
+	else if (result == VK_OPERATION_NOT_DEFERRED_KHR)
+		result = vilc_device.vkGetDeferredOperationResultKHR(device, operation);
+
+	vilc_device.vkDestroyDeferredOperationKHR(device, operation, NULL);
+	return result;
+}
+
+VkResult vilcJoinDeferredOperation(VkDevice device, VkDeferredOperationKHR operation)
+{
+	if (!vilc_device.vkDeferredOperationJoinKHR)
+		return VK_ERROR_EXTENSION_NOT_PRESENT;
+	return vilc_deferredOps_join(device, operation);
+}
+
+void vilcGetDeferredHostOperationStats(VilcDeferredHostOperationStats* stats)
+{
+	pthread_mutex_lock(&vilc_deferredOps_mutex);
+	*stats = vilc_deferredOps_stats;
+	stats->deferredCalls = VILC_ATOMIC_LOAD(&vilc_deferredOps_stats.deferredCalls);
+	pthread_mutex_unlock(&vilc_deferredOps_mutex);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_deferredOps_vkDestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator)
+{
+	/* pool threads call through the device table, so they do not outlive the device; the next join restarts them */
+	vilc_deferredOps_stopThreads();
+
+	pthread_mutex_lock(&vilc_deferredOps_mutex);
+	fprintf(stderr, "vilc: deferred host operations: %llu calls deferred, %llu operations joined, %llu pool joins\n",
+	    (unsigned long long)VILC_ATOMIC_LOAD(&vilc_deferredOps_stats.deferredCalls), (unsigned long long)vilc_deferredOps_stats.joinedOperations,
+	    (unsigned long long)vilc_deferredOps_stats.poolJoins);
+	pthread_mutex_unlock(&vilc_deferredOps_mutex);
+
+	vilc_deferredOps_next_vkDestroyDevice(device, pAllocator);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_deferredOps_vkCreateRayTracingPipelinesKHR(VkDevice device, VkDeferredOperationKHR deferredOperation, VkPipelineCache pipelineCache, uint32_t createInfoCount, const VkRayTracingPipelineCreateInfoKHR* pCreateInfos, const VkAllocationCallbacks* pAllocator, VkPipeline* pPipelines)
+{
+	VkDeferredOperationKHR operation = deferredOperation ? VK_NULL_HANDLE : vilc_deferredOps_create(device);
+	VkResult result;
+
+	if (!operation)
+		return vilc_deferredOps_next_vkCreateRayTracingPipelinesKHR(device, deferredOperation, pipelineCache, createInfoCount, pCreateInfos, pAllocator, pPipelines);
+
+	result = vilc_deferredOps_next_vkCreateRayTracingPipelinesKHR(device, operation, pipelineCache, createInfoCount, pCreateInfos, pAllocator, pPipelines);
+	return vilc_deferredOps_complete(device, operation, result);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_deferredOps_vkBuildAccelerationStructuresKHR(VkDevice device, VkDeferredOperationKHR deferredOperation, uint32_t infoCount, const VkAccelerationStructureBuildGeometryInfoKHR* pInfos, const VkAccelerationStructureBuildRangeInfoKHR* const* ppBuildRangeInfos)
+{
+	VkDeferredOperationKHR operation = deferredOperation ? VK_NULL_HANDLE : vilc_deferredOps_create(device);
+	VkResult result;
+
+	if (!operation)
+		return vilc_deferredOps_next_vkBuildAccelerationStructuresKHR(device, deferredOperation, infoCount, pInfos, ppBuildRangeInfos);
+
+	result = vilc_deferredOps_next_vkBuildAccelerationStructuresKHR(device, operation, infoCount, pInfos, ppBuildRangeInfos);
+	return vilc_deferredOps_complete(device, operation, result);
+}
+
+static void vilc_deferredOps_install(void)
+{
+	VILC_LAYER_HOOK(vilc_deferredOps, vkDestroyDevice)
+	VILC_LAYER_HOOK(vilc_deferredOps, vkCreateRayTracingPipelinesKHR)
+	VILC_LAYER_HOOK(vilc_deferredOps, vkBuildAccelerationStructuresKHR)
+}
+#endif /* VILC_DEFERRED_HOST_OPERATIONS */
+
+#if defined(VOLK_IN_LOADERS_CLOTH) && defined(VILC_STATE_FILTER)
+/* State filter: drops vkCmdBindPipeline, vkCmdBindDescriptorSets, vkCmdBindVertexBuffers, vkCmdBindIndexBuffer,
+ * vkCmdSetViewport/Scissor and vkCmdPushConstants calls that leave the state of the command buffer unchanged.
+ * Each command buffer keeps a shadow of the state it set, which is unknown after vkBeginCommandBuffer, render pass
+ * begins and vkCmdExecuteCommands; only calls that match known state are dropped. Pipeline layouts are compared by
+ * handle, so sets bound with another layout become unknown even when the layouts are compatible. Other commands that
+ * bind state invalidate the parts they touch. Rebinding a graphics pipeline restores its static state, so the rebind
+ * is only dropped when no state it declares static was set since; dynamic state commands other than the Vulkan 1.0
+ * ones are not tracked and are assumed to only set state the bound pipeline declares dynamic.
+ */
+#define VILC_STATE_FILTER_SET_COUNT 8
+#define VILC_STATE_FILTER_DYNAMIC_OFFSET_COUNT 16
+#define VILC_STATE_FILTER_VERTEX_BINDING_COUNT 16
+#define VILC_STATE_FILTER_VIEWPORT_COUNT 16
+#define VILC_STATE_FILTER_PUSH_CONSTANT_SIZE 128
+
+/* Parts of the shadow state */
+#define VILC_STATE_FILTER_SHADOW_PIPELINES 0x1u
+#define VILC_STATE_FILTER_SHADOW_DESCRIPTOR_SETS 0x2u
+#define VILC_STATE_FILTER_SHADOW_VERTEX_BUFFERS 0x4u
+#define VILC_STATE_FILTER_SHADOW_INDEX_BUFFER 0x8u
+#define VILC_STATE_FILTER_SHADOW_VIEWPORTS 0x10u
+#define VILC_STATE_FILTER_SHADOW_SCISSORS 0x20u
+#define VILC_STATE_FILTER_SHADOW_PUSH_CONSTANTS 0x40u
+#define VILC_STATE_FILTER_SHADOW_ALL 0x7fu
+
+/* Bits of a range of count entries from first; count is at most 16 */
+#define VILC_STATE_FILTER_RANGE(first, count) (((1u << (count)) - 1) << (first))
+
+typedef struct VilcStateFilterSets
+{
+	VkDescriptorSet sets[VILC_STATE_FILTER_SET_COUNT];
+	VkPipelineLayout layouts[VILC_STATE_FILTER_SET_COUNT]; /* VK_NULL_HANDLE when the set is unknown */
+	/* dynamic offsets of the last bind that had any; dynamicSetCount is 0 when they are unknown */
+	uint32_t dynamicFirstSet;
+	uint32_t dynamicSetCount;
+	uint32_t dynamicOffsetCount;
+	uint32_t dynamicOffsets[VILC_STATE_FILTER_DYNAMIC_OFFSET_COUNT];
+} VilcStateFilterSets;
+
+typedef struct VilcStateFilterShadow
+{
+	VkPipeline pipelines[2]; /* graphics and compute; VK_NULL_HANDLE when unknown */
+	uint32_t dynamicStatesSet; /* 1 << VkDynamicState of the states set since the graphics pipeline was bound */
+	VilcStateFilterSets sets[2];
+	VkBuffer vertexBuffers[VILC_STATE_FILTER_VERTEX_BINDING_COUNT];
+	VkDeviceSize vertexOffsets[VILC_STATE_FILTER_VERTEX_BINDING_COUNT];
+	uint32_t vertexBufferMask;
+	int indexBufferKnown;
+	VkBuffer indexBuffer;
+	VkDeviceSize indexOffset;
+	VkIndexType indexType;
+	VkViewport viewports[VILC_STATE_FILTER_VIEWPORT_COUNT];
+	VkRect2D scissors[VILC_STATE_FILTER_VIEWPORT_COUNT];
+	uint32_t viewportMask;
+	uint32_t scissorMask;
+	VkPipelineLayout pushConstantLayout;
+	uint8_t pushConstantStages[VILC_STATE_FILTER_PUSH_CONSTANT_SIZE]; /* stages each byte was pushed for; 0 when unknown */
+	uint8_t pushConstants[VILC_STATE_FILTER_PUSH_CONSTANT_SIZE];
+} VilcStateFilterShadow;
+
+typedef struct VilcStateFilterCommandBuffer
+{
+	VkCommandBuffer commandBuffer;
+	VkCommandPool commandPool;
+	VilcStateFilterShadow shadow;
+	/* counted while recording and added to the totals at vkEndCommandBuffer */
+	uint32_t calls[VILC_STATE_FILTER_COMMAND_COUNT];
+	uint32_t elidedCalls[VILC_STATE_FILTER_COMMAND_COUNT];
+} VilcStateFilterCommandBuffer;
+
+static pthread_mutex_t vilc_stateFilter_mutex = PTHREAD_MUTEX_INITIALIZER;
+static VilcHandleMap vilc_stateFilter_commandBuffers;
+/* graphics pipelines that declare any of the tracked dynamic states, to 1 << VkDynamicState of those states */
+static VilcHandleMap vilc_stateFilter_pipelines;
+static uint64_t vilc_stateFilter_calls[VILC_STATE_FILTER_COMMAND_COUNT];
+static uint64_t vilc_stateFilter_elidedCalls[VILC_STATE_FILTER_COMMAND_COUNT];
+static uint64_t vilc_stateFilter_frameElidedCalls = 0;
+static uint64_t vilc_stateFilter_lastFrameElidedCalls = 0;
+static uint64_t vilc_stateFilter_frameCount = 0;
+
+VILC_LAYER_NEXT(vilc_stateFilter, vkDestroyDevice)
+VILC_LAYER_NEXT(vilc_stateFilter, vkDestroyCommandPool)
+VILC_LAYER_NEXT(vilc_stateFilter, vkAllocateCommandBuffers)
+VILC_LAYER_NEXT(vilc_stateFilter, vkFreeCommandBuffers)
+VILC_LAYER_NEXT(vilc_stateFilter, vkBeginCommandBuffer)
+VILC_LAYER_NEXT(vilc_stateFilter, vkEndCommandBuffer)
+VILC_LAYER_NEXT(vilc_stateFilter, vkCreateGraphicsPipelines)
+VILC_LAYER_NEXT(vilc_stateFilter, vkDestroyPipeline)
+VILC_LAYER_NEXT(vilc_stateFilter, vkCmdBindPipeline)
+VILC_LAYER_NEXT(vilc_stateFilter, vkCmdBindDescriptorSets)
+VILC_LAYER_NEXT(vilc_stateFilter, vkCmdBindVertexBuffers)
+VILC_LAYER_NEXT(vilc_stateFilter, vkCmdBindIndexBuffer)
+VILC_LAYER_NEXT(vilc_stateFilter, vkCmdSetViewport)
+VILC_LAYER_NEXT(vilc_stateFilter, vkCmdSetScissor)
+VILC_LAYER_NEXT(vilc_stateFilter, vkCmdPushConstants)
+
+static VilcStateFilterCommandBuffer* vilc_stateFilter_find(VkCommandBuffer commandBuffer)
+{
+	VilcStateFilterCommandBuffer* state;
+
+	pthread_mutex_lock(&vilc_stateFilter_mutex);
+	state = (VilcStateFilterCommandBuffer*)vilc_mapFind(&vilc_stateFilter_commandBuffers, VILC_DISPATCHABLE_KEY(commandBuffer));
+	pthread_mutex_unlock(&vilc_stateFilter_mutex);
+
+	return state;
+}
+
+static void vilc_stateFilter_invalidate(VilcStateFilterShadow* shadow, uint32_t parts)
+{
+	uint32_t i;
+
+	if (parts & VILC_STATE_FILTER_SHADOW_PIPELINES)
+	{
+		shadow->pipelines[0] = shadow->pipelines[1] = VK_NULL_HANDLE;
+		shadow->dynamicStatesSet = 0;
+	}
+	if (parts & VILC_STATE_FILTER_SHADOW_DESCRIPTOR_SETS)
+		for (i = 0; i < 2; ++i)
+		{
+			memset(shadow->sets[i].layouts, 0, sizeof(shadow->sets[i].layouts));
+			shadow->sets[i].dynamicSetCount = 0;
+		}
+	if (parts & VILC_STATE_FILTER_SHADOW_VERTEX_BUFFERS)
+		shadow->vertexBufferMask = 0;
+	if (parts & VILC_STATE_FILTER_SHADOW_INDEX_BUFFER)
+		shadow->indexBufferKnown = 0;
+	if (parts & VILC_STATE_FILTER_SHADOW_VIEWPORTS)
+		shadow->viewportMask = 0;
+	if (parts & VILC_STATE_FILTER_SHADOW_SCISSORS)
+		shadow->scissorMask = 0;
+	if (parts & VILC_STATE_FILTER_SHADOW_PUSH_CONSTANTS)
+	{
+		shadow->pushConstantLayout = VK_NULL_HANDLE;
+		memset(shadow->pushConstantStages, 0, sizeof(shadow->pushConstantStages));
+	}
+}
+
+static void vilc_stateFilter_invalidateCommandBuffer(VkCommandBuffer commandBuffer, uint32_t parts)
+{
+	VilcStateFilterCommandBuffer* state = vilc_stateFilter_find(commandBuffer);
+	if (state)
+		vilc_stateFilter_invalidate(&state->shadow, parts);
+}
+
+/* Counts a filtered call; returns redundant, i.e. whether the call is dropped */
+static int vilc_stateFilter_count(VilcStateFilterCommandBuffer* state, VilcStateFilterCommand command, int redundant)
+{
+	state->calls[command]++;
+	state->elidedCalls[command] += redundant ? 1 : 0;
+	return redundant;
+}
+
+static void vilc_stateFilter_freeCommandBuffer(VilcStateFilterCommandBuffer* state)
+{
+	free(state);
+}
+
+void vilcGetStateFilterStats(VilcStateFilterStats* stats)
+{
+	uint32_t i;
+
+	stats->frameCount = VILC_ATOMIC_LOAD(&vilc_stateFilter_frameCount);
+	stats->lastFrameElidedCalls = VILC_ATOMIC_LOAD(&vilc_stateFilter_lastFrameElidedCalls);
+	for (i = 0; i < VILC_STATE_FILTER_COMMAND_COUNT; ++i)
+	{
+		stats->calls[i] = VILC_ATOMIC_LOAD(&vilc_stateFilter_calls[i]);
+		stats->elidedCalls[i] = VILC_ATOMIC_LOAD(&vilc_stateFilter_elidedCalls[i]);
+	}
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_stateFilter_vkDestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator)
+{
+	VilcStateFilterStats stats;
+	uint64_t calls = 0, elidedCalls = 0;
+	uint32_t i;
+
+	pthread_mutex_lock(&vilc_stateFilter_mutex);
+	for (i = 0; i < vilc_stateFilter_commandBuffers.capacity; ++i)
+		if (vilc_stateFilter_commandBuffers.keys[i])
+			vilc_stateFilter_freeCommandBuffer((VilcStateFilterCommandBuffer*)vilc_stateFilter_commandBuffers.values[i]);
+	vilc_mapFree(&vilc_stateFilter_commandBuffers);
+	vilc_mapFree(&vilc_stateFilter_pipelines);
+	pthread_mutex_unlock(&vilc_stateFilter_mutex);
+
+	vilcGetStateFilterStats(&stats);
+	for (i = 0; i < VILC_STATE_FILTER_COMMAND_COUNT; ++i)
+	{
+		calls += stats.calls[i];
+		elidedCalls += stats.elidedCalls[i];
+	}
+	fprintf(stderr, "vilc: state filter: %llu of %llu calls elided, %.1f per frame over %llu frames\n", (unsigned long long)elidedCalls,
+	    (unsigned long long)calls, stats.frameCount ? (double)elidedCalls / (double)stats.frameCount : 0.0, (unsigned long long)stats.frameCount);
+
+	vilc_stateFilter_next_vkDestroyDevice(device, pAllocator);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_stateFilter_vkDestroyCommandPool(VkDevice device, VkCommandPool commandPool, const VkAllocationCallbacks* pAllocator)
+{
+	uint32_t i = 0;
+
+	pthread_mutex_lock(&vilc_stateFilter_mutex);
+	/* removal shifts later entries back into the scanned slot, so it is scanned again */
+	while (commandPool && i < vilc_stateFilter_commandBuffers.capacity)
+	{
+		VilcStateFilterCommandBuffer* state = (VilcStateFilterCommandBuffer*)vilc_stateFilter_commandBuffers.values[i];
+		if (vilc_stateFilter_commandBuffers.keys[i] && state->commandPool == commandPool)
+			vilc_stateFilter_freeCommandBuffer((VilcStateFilterCommandBuffer*)vilc_mapRemove(&vilc_stateFilter_commandBuffers, vilc_stateFilter_commandBuffers.keys[i]));
+		else
+			++i;
+	}
+	pthread_mutex_unlock(&vilc_stateFilter_mutex);
+
+	vilc_stateFilter_next_vkDestroyCommandPool(device, commandPool, pAllocator);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_stateFilter_vkAllocateCommandBuffers(VkDevice device, const VkCommandBufferAllocateInfo* pAllocateInfo, VkCommandBuffer* pCommandBuffers)
+{
+	VkResult result = vilc_stateFilter_next_vkAllocateCommandBuffers(device, pAllocateInfo, pCommandBuffers);
+	uint32_t i;
+
+	if (result != VK_SUCCESS)
+		return result;
+
+	pthread_mutex_lock(&vilc_stateFilter_mutex);
+	for (i = 0; i < pAllocateInfo->commandBufferCount; ++i)
+	{
+		VilcStateFilterCommandBuffer* state = (VilcStateFilterCommandBuffer*)calloc(1, sizeof(VilcStateFilterCommandBuffer));
+		if (!state)
+			break;
+		state->commandBuffer = pCommandBuffers[i];
+		state->commandPool = pAllocateInfo->commandPool;
+		if (!vilc_mapInsert(&vilc_stateFilter_commandBuffers, VILC_DISPATCHABLE_KEY(pCommandBuffers[i]), state))
+			free(state);
+	}
+	pthread_mutex_unlock(&vilc_stateFilter_mutex);
+
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_stateFilter_vkFreeCommandBuffers(VkDevice device, VkCommandPool commandPool, uint32_t commandBufferCount, const VkCommandBuffer* pCommandBuffers)
+{
+	uint32_t i;
+
+	pthread_mutex_lock(&vilc_stateFilter_mutex);
+	for (i = 0; i < commandBufferCount; ++i)
+		if (pCommandBuffers[i])
+			vilc_stateFilter_freeCommandBuffer((VilcStateFilterCommandBuffer*)vilc_mapRemove(&vilc_stateFilter_commandBuffers, VILC_DISPATCHABLE_KEY(pCommandBuffers[i])));
+	pthread_mutex_unlock(&vilc_stateFilter_mutex);
+
+	vilc_stateFilter_next_vkFreeCommandBuffers(device, commandPool, commandBufferCount, pCommandBuffers);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_stateFilter_vkBeginCommandBuffer(VkCommandBuffer commandBuffer, const VkCommandBufferBeginInfo* pBeginInfo)
+{
+	VilcStateFilterCommandBuffer* state = vilc_stateFilter_find(commandBuffer);
+
+	/* counts of a recording that was never ended are dropped with it */
+	if (state)
+	{
+		vilc_stateFilter_invalidate(&state->shadow, VILC_STATE_FILTER_SHADOW_ALL);
+		memset(state->calls, 0, sizeof(state->calls));
+		memset(state->elidedCalls, 0, sizeof(state->elidedCalls));
+	}
+	return vilc_stateFilter_next_vkBeginCommandBuffer(commandBuffer, pBeginInfo);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_stateFilter_vkEndCommandBuffer(VkCommandBuffer commandBuffer)
+{
+	VilcStateFilterCommandBuffer* state = vilc_stateFilter_find(commandBuffer);
+	uint64_t elidedCalls = 0;
+	uint32_t i;
+
+	if (state)
+	{
+		for (i = 0; i < VILC_STATE_FILTER_COMMAND_COUNT; ++i)
+		{
+			VILC_ATOMIC_ADD(&vilc_stateFilter_calls[i], state->calls[i]);
+			VILC_ATOMIC_ADD(&vilc_stateFilter_elidedCalls[i], state->elidedCalls[i]);
+			elidedCalls += state->elidedCalls[i];
+		}
+		VILC_ATOMIC_ADD(&vilc_stateFilter_frameElidedCalls, elidedCalls);
+		memset(state->calls, 0, sizeof(state->calls));
+		memset(state->elidedCalls, 0, sizeof(state->elidedCalls));
+	}
+	return vilc_stateFilter_next_vkEndCommandBuffer(commandBuffer);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_stateFilter_vkCreateGraphicsPipelines(VkDevice device, VkPipelineCache pipelineCache, uint32_t createInfoCount, const VkGraphicsPipelineCreateInfo* pCreateInfos, const VkAllocationCallbacks* pAllocator, VkPipeline* pPipelines)
+{
+	VkResult result = vilc_stateFilter_next_vkCreateGraphicsPipelines(device, pipelineCache, createInfoCount, pCreateInfos, pAllocator, pPipelines);
+	uint32_t i, j;
+
+	/* pipelines that were created are valid even when others failed */
+	pthread_mutex_lock(&vilc_stateFilter_mutex);
+	for (i = 0; i < createInfoCount; ++i)
+	{
+		const VkPipelineDynamicStateCreateInfo* dynamicState = pCreateInfos[i].pDynamicState;
+		uint32_t dynamicStates = 0;
+
+		for (j = 0; pPipelines[i] && dynamicState && j < dynamicState->dynamicStateCount; ++j)
+			if (dynamicState->pDynamicStates[j] <= VK_DYNAMIC_STATE_STENCIL_REFERENCE)
+				dynamicStates |= 1u << dynamicState->pDynamicStates[j];
+		if (dynamicStates)
+			vilc_mapInsert(&vilc_stateFilter_pipelines, VILC_OBJECT_KEY(pPipelines[i]), (void*)(uintptr_t)dynamicStates);
+	}
+	pthread_mutex_unlock(&vilc_stateFilter_mutex);
+
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_stateFilter_vkDestroyPipeline(VkDevice device, VkPipeline pipeline, const VkAllocationCallbacks* pAllocator)
+{
+	if (pipeline)
+	{
+		pthread_mutex_lock(&vilc_stateFilter_mutex);
+		vilc_mapRemove(&vilc_stateFilter_pipelines, VILC_OBJECT_KEY(pipeline));
+		pthread_mutex_unlock(&vilc_stateFilter_mutex);
+	}
+	vilc_stateFilter_next_vkDestroyPipeline(device, pipeline, pAllocator);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_stateFilter_vkCmdBindPipeline(VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipeline pipeline)
+{
+	VilcStateFilterCommandBuffer* state;
+	VilcStateFilterShadow* shadow;
+	uint32_t dynamicStates = 0;
+
+	pthread_mutex_lock(&vilc_stateFilter_mutex);
+	state = (VilcStateFilterCommandBuffer*)vilc_mapFind(&vilc_stateFilter_commandBuffers, VILC_DISPATCHABLE_KEY(commandBuffer));
+	if (state && pipelineBindPoint == VK_PIPELINE_BIND_POINT_GRAPHICS)
+		dynamicStates = (uint32_t)(uintptr_t)vilc_mapFind(&vilc_stateFilter_pipelines, VILC_OBJECT_KEY(pipeline));
+	pthread_mutex_unlock(&vilc_stateFilter_mutex);
+
+	if (state && (pipelineBindPoint == VK_PIPELINE_BIND_POINT_GRAPHICS || pipelineBindPoint == VK_PIPELINE_BIND_POINT_COMPUTE))
+	{
+		shadow = &state->shadow;
+		if (vilc_stateFilter_count(state, VILC_STATE_FILTER_BIND_PIPELINE, shadow->pipelines[pipelineBindPoint] == pipeline &&
+		    (pipelineBindPoint == VK_PIPELINE_BIND_POINT_COMPUTE || (shadow->dynamicStatesSet & ~dynamicStates) == 0)))
+			return;
+
+		shadow->pipelines[pipelineBindPoint] = pipeline;
+		/* binding a graphics pipeline overwrites the state it does not declare dynamic */
+		if (pipelineBindPoint == VK_PIPELINE_BIND_POINT_GRAPHICS)
+		{
+			if (!(dynamicStates & (1u << VK_DYNAMIC_STATE_VIEWPORT)))
+				shadow->viewportMask = 0;
+			if (!(dynamicStates & (1u << VK_DYNAMIC_STATE_SCISSOR)))
+				shadow->scissorMask = 0;
+			shadow->dynamicStatesSet = 0;
+		}
+	}
+	vilc_stateFilter_next_vkCmdBindPipeline(commandBuffer, pipelineBindPoint, pipeline);
+}
+
+/* Whether binding the sets would leave the bound sets and their dynamic offsets unchanged */
+static int vilc_stateFilter_setsBound(const VilcStateFilterSets* bound, VkPipelineLayout layout, uint32_t firstSet, uint32_t descriptorSetCount, const VkDescriptorSet* pDescriptorSets, uint32_t dynamicOffsetCount, const uint32_t* pDynamicOffsets)
+{
+	uint32_t i;
+
+	for (i = 0; i < descriptorSetCount; ++i)
+		if (bound->layouts[firstSet + i] != layout || bound->sets[firstSet + i] != pDescriptorSets[i])
+			return 0;
+
+	/* sets bound without dynamic offsets have no dynamic descriptors, whatever they were bound with before */
+	return dynamicOffsetCount == 0 || (bound->dynamicSetCount && bound->dynamicFirstSet == firstSet && bound->dynamicSetCount == descriptorSetCount &&
+	    bound->dynamicOffsetCount == dynamicOffsetCount && memcmp(bound->dynamicOffsets, pDynamicOffsets, dynamicOffsetCount * sizeof(uint32_t)) == 0);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_stateFilter_vkCmdBindDescriptorSets(VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout, uint32_t firstSet, uint32_t descriptorSetCount, const VkDescriptorSet* pDescriptorSets, uint32_t dynamicOffsetCount, const uint32_t* pDynamicOffsets)
+{
+	VilcStateFilterCommandBuffer* state = vilc_stateFilter_find(commandBuffer);
+	VilcStateFilterSets* bound;
+	uint32_t i;
+
+	if (state && (pipelineBindPoint == VK_PIPELINE_BIND_POINT_GRAPHICS || pipelineBindPoint == VK_PIPELINE_BIND_POINT_COMPUTE))
+	{
+		bound = &state->shadow.sets[pipelineBindPoint];
+		if (firstSet > VILC_STATE_FILTER_SET_COUNT || descriptorSetCount > VILC_STATE_FILTER_SET_COUNT - firstSet || dynamicOffsetCount > VILC_STATE_FILTER_DYNAMIC_OFFSET_COUNT)
+		{
+			vilc_stateFilter_count(state, VILC_STATE_FILTER_BIND_DESCRIPTOR_SETS, 0);
+			memset(bound->layouts, 0, sizeof(bound->layouts));
+			bound->dynamicSetCount = 0;
+		}
+		else if (vilc_stateFilter_count(state, VILC_STATE_FILTER_BIND_DESCRIPTOR_SETS, vilc_stateFilter_setsBound(bound, layout, firstSet, descriptorSetCount, pDescriptorSets, dynamicOffsetCount, pDynamicOffsets)))
+			return;
+		else
+		{
+			/* other sets stay bound when the layouts are compatible, which is only known for the same layout */
+			for (i = 0; i < VILC_STATE_FILTER_SET_COUNT; ++i)
+				if (i >= firstSet && i < firstSet + descriptorSetCount)
+				{
+					bound->sets[i] = pDescriptorSets[i - firstSet];
+					bound->layouts[i] = layout;
+				}
+				else if (bound->layouts[i] != layout)
+					bound->layouts[i] = VK_NULL_HANDLE;
+
+			if (dynamicOffsetCount)
+			{
+				bound->dynamicFirstSet = firstSet;
+				bound->dynamicSetCount = descriptorSetCount;
+				bound->dynamicOffsetCount = dynamicOffsetCount;
+				memcpy(bound->dynamicOffsets, pDynamicOffsets, dynamicOffsetCount * sizeof(uint32_t));
+			}
+			else if (firstSet < bound->dynamicFirstSet + bound->dynamicSetCount && bound->dynamicFirstSet < firstSet + descriptorSetCount)
+				bound->dynamicSetCount = 0;
+		}
+	}
+	vilc_stateFilter_next_vkCmdBindDescriptorSets(commandBuffer, pipelineBindPoint, layout, firstSet, descriptorSetCount, pDescriptorSets, dynamicOffsetCount, pDynamicOffsets);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_stateFilter_vkCmdBindVertexBuffers(VkCommandBuffer commandBuffer, uint32_t firstBinding, uint32_t bindingCount, const VkBuffer* pBuffers, const VkDeviceSize* pOffsets)
+{
+	VilcStateFilterCommandBuffer* state = vilc_stateFilter_find(commandBuffer);
+	VilcStateFilterShadow* shadow;
+	uint32_t range, i;
+
+	if (state)
+	{
+		shadow = &state->shadow;
+		if (firstBinding > VILC_STATE_FILTER_VERTEX_BINDING_COUNT || bindingCount > VILC_STATE_FILTER_VERTEX_BINDING_COUNT - firstBinding)
+		{
+			vilc_stateFilter_count(state, VILC_STATE_FILTER_BIND_VERTEX_BUFFERS, 0);
+			shadow->vertexBufferMask = 0;
+		}
+		else
+		{
+			int redundant;
+
+			range = VILC_STATE_FILTER_RANGE(firstBinding, bindingCount);
+			redundant = (shadow->vertexBufferMask & range) == range;
+			for (i = 0; redundant && i < bindingCount; ++i)
+				redundant = shadow->vertexBuffers[firstBinding + i] == pBuffers[i] && shadow->vertexOffsets[firstBinding + i] == pOffsets[i];
+			if (vilc_stateFilter_count(state, VILC_STATE_FILTER_BIND_VERTEX_BUFFERS, redundant))
+				return;
+
+			memcpy(&shadow->vertexBuffers[firstBinding], pBuffers, bindingCount * sizeof(VkBuffer));
+			memcpy(&shadow->vertexOffsets[firstBinding], pOffsets, bindingCount * sizeof(VkDeviceSize));
+			shadow->vertexBufferMask |= range;
+		}
+	}
+	vilc_stateFilter_next_vkCmdBindVertexBuffers(commandBuffer, firstBinding, bindingCount, pBuffers, pOffsets);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_stateFilter_vkCmdBindIndexBuffer(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkIndexType indexType)
+{
+	VilcStateFilterCommandBuffer* state = vilc_stateFilter_find(commandBuffer);
+	VilcStateFilterShadow* shadow;
+
+	if (state)
+	{
+		shadow = &state->shadow;
+		if (vilc_stateFilter_count(state, VILC_STATE_FILTER_BIND_INDEX_BUFFER, shadow->indexBufferKnown && shadow->indexBuffer == buffer && shadow->indexOffset == offset && shadow->indexType == indexType))
+			return;
+
+		shadow->indexBufferKnown = 1;
+		shadow->indexBuffer = buffer;
+		shadow->indexOffset = offset;
+		shadow->indexType = indexType;
+	}
+	vilc_stateFilter_next_vkCmdBindIndexBuffer(commandBuffer, buffer, offset, indexType);
+}
+
+/* Filters a vkCmdSetViewport or vkCmdSetScissor of count elements of size bytes against the known elements; returns
+ * whether the call is dropped, and records the elements when it is not
+ */
+static int vilc_stateFilter_setElements(VilcStateFilterCommandBuffer* state, VilcStateFilterCommand command, VkDynamicState dynamicState, void* elements, uint32_t* mask, size_t size, uint32_t first, uint32_t count, const void* pElements)
+{
+	uint32_t range;
+
+	if (first > VILC_STATE_FILTER_VIEWPORT_COUNT || count > VILC_STATE_FILTER_VIEWPORT_COUNT - first)
+	{
+		vilc_stateFilter_count(state, command, 0);
+		state->shadow.dynamicStatesSet |= 1u << dynamicState;
+		*mask = 0;
+		return 0;
+	}
+
+	range = VILC_STATE_FILTER_RANGE(first, count);
+	if (vilc_stateFilter_count(state, command, (*mask & range) == range && memcmp((char*)elements + first * size, pElements, count * size) == 0))
+		return 1;
+
+	state->shadow.dynamicStatesSet |= 1u << dynamicState;
+	memcpy((char*)elements + first * size, pElements, count * size);
+	*mask |= range;
+	return 0;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_stateFilter_vkCmdSetViewport(VkCommandBuffer commandBuffer, uint32_t firstViewport, uint32_t viewportCount, const VkViewport* pViewports)
+{
+	VilcStateFilterCommandBuffer* state = vilc_stateFilter_find(commandBuffer);
+
+	if (state && vilc_stateFilter_setElements(state, VILC_STATE_FILTER_SET_VIEWPORT, VK_DYNAMIC_STATE_VIEWPORT, state->shadow.viewports, &state->shadow.viewportMask, sizeof(VkViewport), firstViewport, viewportCount, pViewports))
+		return;
+	vilc_stateFilter_next_vkCmdSetViewport(commandBuffer, firstViewport, viewportCount, pViewports);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_stateFilter_vkCmdSetScissor(VkCommandBuffer commandBuffer, uint32_t firstScissor, uint32_t scissorCount, const VkRect2D* pScissors)
+{
+	VilcStateFilterCommandBuffer* state = vilc_stateFilter_find(commandBuffer);
+
+	if (state && vilc_stateFilter_setElements(state, VILC_STATE_FILTER_SET_SCISSOR, VK_DYNAMIC_STATE_SCISSOR, state->shadow.scissors, &state->shadow.scissorMask, sizeof(VkRect2D), firstScissor, scissorCount, pScissors))
+		return;
+	vilc_stateFilter_next_vkCmdSetScissor(commandBuffer, firstScissor, scissorCount, pScissors);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_stateFilter_vkCmdPushConstants(VkCommandBuffer commandBuffer, VkPipelineLayout layout, VkShaderStageFlags stageFlags, uint32_t offset, uint32_t size, const void* pValues)
+{
+	VilcStateFilterCommandBuffer* state = vilc_stateFilter_find(commandBuffer);
+	VilcStateFilterShadow* shadow;
+	uint32_t i;
+
+	if (state)
+	{
+		shadow = &state->shadow;
+		/* byte stages are 8 bits wide, which covers the graphics, compute, task and mesh stages */
+		if (stageFlags > 0xff || offset > VILC_STATE_FILTER_PUSH_CONSTANT_SIZE || size > VILC_STATE_FILTER_PUSH_CONSTANT_SIZE - offset)
+		{
+			vilc_stateFilter_count(state, VILC_STATE_FILTER_PUSH_CONSTANTS, 0);
+			vilc_stateFilter_invalidate(shadow, VILC_STATE_FILTER_SHADOW_PUSH_CONSTANTS);
+		}
+		else
+		{
+			int redundant = shadow->pushConstantLayout == layout && memcmp(&shadow->pushConstants[offset], pValues, size) == 0;
+
+			for (i = 0; redundant && i < size; ++i)
+				redundant = shadow->pushConstantStages[offset + i] == stageFlags;
+			if (vilc_stateFilter_count(state, VILC_STATE_FILTER_PUSH_CONSTANTS, redundant))
+				return;
+
+			/* values pushed with another layout are kept for compatible layouts, which is only known for the same one */
+			if (shadow->pushConstantLayout != layout)
+				vilc_stateFilter_invalidate(shadow, VILC_STATE_FILTER_SHADOW_PUSH_CONSTANTS);
+			shadow->pushConstantLayout = layout;
+			memset(&shadow->pushConstantStages[offset], (int)stageFlags, size);
+			memcpy(&shadow->pushConstants[offset], pValues, size);
+		}
+	}
+	vilc_stateFilter_next_vkCmdPushConstants(commandBuffer, layout, stageFlags, offset, size, pValues);
+}
+
+/* Commands that are not filtered but change state the shadow tracks */
+#define VILC_STATE_FILTER_INVALIDATING(name, parts, params, args) \
+	VILC_LAYER_NEXT(vilc_stateFilter, name) \
+	static VKAPI_ATTR void VKAPI_CALL vilc_stateFilter_##name params \
+	{ \
+		vilc_stateFilter_invalidateCommandBuffer(commandBuffer, parts); \
+		vilc_stateFilter_next_##name args; \
+	}
+
+/* Dynamic state commands that are not filtered, so a later rebind of the graphics pipeline can restore static state */
+#define VILC_STATE_FILTER_DYNAMIC(name, dynamicState, params, args) \
+	VILC_LAYER_NEXT(vilc_stateFilter, name) \
+	static VKAPI_ATTR void VKAPI_CALL vilc_stateFilter_##name params \
+	{ \
+		VilcStateFilterCommandBuffer* state = vilc_stateFilter_find(commandBuffer); \
+		if (state) \
+			state->shadow.dynamicStatesSet |= 1u << dynamicState; \
+		vilc_stateFilter_next_##name args; \
+	}
+
+VILC_STATE_FILTER_INVALIDATING(vkCmdBeginRenderPass, VILC_STATE_FILTER_SHADOW_ALL, (VkCommandBuffer commandBuffer, const VkRenderPassBeginInfo* pRenderPassBegin, VkSubpassContents contents), (commandBuffer, pRenderPassBegin, contents))
+VILC_STATE_FILTER_INVALIDATING(vkCmdExecuteCommands, VILC_STATE_FILTER_SHADOW_ALL, (VkCommandBuffer commandBuffer, uint32_t commandBufferCount, const VkCommandBuffer* pCommandBuffers), (commandBuffer, commandBufferCount, pCommandBuffers))
+VILC_STATE_FILTER_DYNAMIC(vkCmdSetLineWidth, VK_DYNAMIC_STATE_LINE_WIDTH, (VkCommandBuffer commandBuffer, float lineWidth), (commandBuffer, lineWidth))
+VILC_STATE_FILTER_DYNAMIC(vkCmdSetDepthBias, VK_DYNAMIC_STATE_DEPTH_BIAS, (VkCommandBuffer commandBuffer, float depthBiasConstantFactor, float depthBiasClamp, float depthBiasSlopeFactor), (commandBuffer, depthBiasConstantFactor, depthBiasClamp, depthBiasSlopeFactor))
+VILC_STATE_FILTER_DYNAMIC(vkCmdSetBlendConstants, VK_DYNAMIC_STATE_BLEND_CONSTANTS, (VkCommandBuffer commandBuffer, const float blendConstants[4]), (commandBuffer, blendConstants))
+VILC_STATE_FILTER_DYNAMIC(vkCmdSetDepthBounds, VK_DYNAMIC_STATE_DEPTH_BOUNDS, (VkCommandBuffer commandBuffer, float minDepthBounds, float maxDepthBounds), (commandBuffer, minDepthBounds, maxDepthBounds))
+VILC_STATE_FILTER_DYNAMIC(vkCmdSetStencilCompareMask, VK_DYNAMIC_STATE_STENCIL_COMPARE_MASK, (VkCommandBuffer commandBuffer, VkStencilFaceFlags faceMask, uint32_t compareMask), (commandBuffer, faceMask, compareMask))
+VILC_STATE_FILTER_DYNAMIC(vkCmdSetStencilWriteMask, VK_DYNAMIC_STATE_STENCIL_WRITE_MASK, (VkCommandBuffer commandBuffer, VkStencilFaceFlags faceMask, uint32_t writeMask), (commandBuffer, faceMask, writeMask))
+VILC_STATE_FILTER_DYNAMIC(vkCmdSetStencilReference, VK_DYNAMIC_STATE_STENCIL_REFERENCE, (VkCommandBuffer commandBuffer, VkStencilFaceFlags faceMask, uint32_t reference), (commandBuffer, faceMask, reference))
+
+#if defined(VK_VERSION_1_2)
+VILC_STATE_FILTER_INVALIDATING(vkCmdBeginRenderPass2, VILC_STATE_FILTER_SHADOW_ALL, (VkCommandBuffer commandBuffer, const VkRenderPassBeginInfo* pRenderPassBegin, const VkSubpassBeginInfo* pSubpassBeginInfo), (commandBuffer, pRenderPassBegin, pSubpassBeginInfo))
+#endif /* defined(VK_VERSION_1_2) */
+
+#if defined(VK_VERSION_1_3)
+VILC_STATE_FILTER_INVALIDATING(vkCmdBeginRendering, VILC_STATE_FILTER_SHADOW_ALL, (VkCommandBuffer commandBuffer, const VkRenderingInfo* pRenderingInfo), (commandBuffer, pRenderingInfo))
+VILC_STATE_FILTER_INVALIDATING(vkCmdBindVertexBuffers2, VILC_STATE_FILTER_SHADOW_VERTEX_BUFFERS, (VkCommandBuffer commandBuffer, uint32_t firstBinding, uint32_t bindingCount, const VkBuffer* pBuffers, const VkDeviceSize* pOffsets, const VkDeviceSize* pSizes, const VkDeviceSize* pStrides), (commandBuffer, firstBinding, bindingCount, pBuffers, pOffsets, pSizes, pStrides))
+VILC_STATE_FILTER_INVALIDATING(vkCmdSetViewportWithCount, VILC_STATE_FILTER_SHADOW_VIEWPORTS, (VkCommandBuffer commandBuffer, uint32_t viewportCount, const VkViewport* pViewports), (commandBuffer, viewportCount, pViewports))
+VILC_STATE_FILTER_INVALIDATING(vkCmdSetScissorWithCount, VILC_STATE_FILTER_SHADOW_SCISSORS, (VkCommandBuffer commandBuffer, uint32_t scissorCount, const VkRect2D* pScissors), (commandBuffer, scissorCount, pScissors))
+#endif /* defined(VK_VERSION_1_3) */
+
+#if defined(VK_VERSION_1_4)
+VILC_STATE_FILTER_INVALIDATING(vkCmdBindIndexBuffer2, VILC_STATE_FILTER_SHADOW_INDEX_BUFFER, (VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, VkIndexType indexType), (commandBuffer, buffer, offset, size, indexType))
+VILC_STATE_FILTER_INVALIDATING(vkCmdBindDescriptorSets2, VILC_STATE_FILTER_SHADOW_DESCRIPTOR_SETS, (VkCommandBuffer commandBuffer, const VkBindDescriptorSetsInfo* pBindDescriptorSetsInfo), (commandBuffer, pBindDescriptorSetsInfo))
+VILC_STATE_FILTER_INVALIDATING(vkCmdPushConstants2, VILC_STATE_FILTER_SHADOW_PUSH_CONSTANTS, (VkCommandBuffer commandBuffer, const VkPushConstantsInfo* pPushConstantsInfo), (commandBuffer, pPushConstantsInfo))
+VILC_STATE_FILTER_INVALIDATING(vkCmdPushDescriptorSet, VILC_STATE_FILTER_SHADOW_DESCRIPTOR_SETS, (VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout, uint32_t set, uint32_t descriptorWriteCount, const VkWriteDescriptorSet* pDescriptorWrites), (commandBuffer, pipelineBindPoint, layout, set, descriptorWriteCount, pDescriptorWrites))
+VILC_STATE_FILTER_INVALIDATING(vkCmdPushDescriptorSetWithTemplate, VILC_STATE_FILTER_SHADOW_DESCRIPTOR_SETS, (VkCommandBuffer commandBuffer, VkDescriptorUpdateTemplate descriptorUpdateTemplate, VkPipelineLayout layout, uint32_t set, const void* pData), (commandBuffer, descriptorUpdateTemplate, layout, set, pData))
+VILC_STATE_FILTER_INVALIDATING(vkCmdPushDescriptorSet2, VILC_STATE_FILTER_SHADOW_DESCRIPTOR_SETS, (VkCommandBuffer commandBuffer, const VkPushDescriptorSetInfo* pPushDescriptorSetInfo), (commandBuffer, pPushDescriptorSetInfo))
+VILC_STATE_FILTER_INVALIDATING(vkCmdPushDescriptorSetWithTemplate2, VILC_STATE_FILTER_SHADOW_DESCRIPTOR_SETS, (VkCommandBuffer commandBuffer, const VkPushDescriptorSetWithTemplateInfo* pPushDescriptorSetWithTemplateInfo), (commandBuffer, pPushDescriptorSetWithTemplateInfo))
+#endif /* defined(VK_VERSION_1_4) */
+
+#if defined(VK_KHR_create_renderpass2)
+VILC_STATE_FILTER_INVALIDATING(vkCmdBeginRenderPass2KHR, VILC_STATE_FILTER_SHADOW_ALL, (VkCommandBuffer commandBuffer, const VkRenderPassBeginInfo* pRenderPassBegin, const VkSubpassBeginInfo* pSubpassBeginInfo), (commandBuffer, pRenderPassBegin, pSubpassBeginInfo))
+#endif /* defined(VK_KHR_create_renderpass2) */
+
+#if defined(VK_KHR_dynamic_rendering)
+VILC_STATE_FILTER_INVALIDATING(vkCmdBeginRenderingKHR, VILC_STATE_FILTER_SHADOW_ALL, (VkCommandBuffer commandBuffer, const VkRenderingInfo* pRenderingInfo), (commandBuffer, pRenderingInfo))
+#endif /* defined(VK_KHR_dynamic_rendering) */
+
+#if defined(VK_KHR_maintenance5)
+VILC_STATE_FILTER_INVALIDATING(vkCmdBindIndexBuffer2KHR, VILC_STATE_FILTER_SHADOW_INDEX_BUFFER, (VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, VkIndexType indexType), (commandBuffer, buffer, offset, size, indexType))
+#endif /* defined(VK_KHR_maintenance5) */
+
+#if defined(VK_KHR_maintenance6)
+VILC_STATE_FILTER_INVALIDATING(vkCmdBindDescriptorSets2KHR, VILC_STATE_FILTER_SHADOW_DESCRIPTOR_SETS, (VkCommandBuffer commandBuffer, const VkBindDescriptorSetsInfo* pBindDescriptorSetsInfo), (commandBuffer, pBindDescriptorSetsInfo))
+VILC_STATE_FILTER_INVALIDATING(vkCmdPushConstants2KHR, VILC_STATE_FILTER_SHADOW_PUSH_CONSTANTS, (VkCommandBuffer commandBuffer, const VkPushConstantsInfo* pPushConstantsInfo), (commandBuffer, pPushConstantsInfo))
+#endif /* defined(VK_KHR_maintenance6) */
+
+#if defined(VK_KHR_maintenance6) && defined(VK_KHR_push_descriptor)
+VILC_STATE_FILTER_INVALIDATING(vkCmdPushDescriptorSet2KHR, VILC_STATE_FILTER_SHADOW_DESCRIPTOR_SETS, (VkCommandBuffer commandBuffer, const VkPushDescriptorSetInfo* pPushDescriptorSetInfo), (commandBuffer, pPushDescriptorSetInfo))
+VILC_STATE_FILTER_INVALIDATING(vkCmdPushDescriptorSetWithTemplate2KHR, VILC_STATE_FILTER_SHADOW_DESCRIPTOR_SETS, (VkCommandBuffer commandBuffer, const VkPushDescriptorSetWithTemplateInfo* pPushDescriptorSetWithTemplateInfo), (commandBuffer, pPushDescriptorSetWithTemplateInfo))
+#endif /* defined(VK_KHR_maintenance6) && defined(VK_KHR_push_descriptor) */
+
+#if defined(VK_KHR_push_descriptor)
+VILC_STATE_FILTER_INVALIDATING(vkCmdPushDescriptorSetKHR, VILC_STATE_FILTER_SHADOW_DESCRIPTOR_SETS, (VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout, uint32_t set, uint32_t descriptorWriteCount, const VkWriteDescriptorSet* pDescriptorWrites), (commandBuffer, pipelineBindPoint, layout, set, descriptorWriteCount, pDescriptorWrites))
+#endif /* defined(VK_KHR_push_descriptor) */
+
+#if (defined(VK_KHR_descriptor_update_template) && defined(VK_KHR_push_descriptor)) || (defined(VK_KHR_push_descriptor) && (defined(VK_VERSION_1_1) || defined(VK_KHR_descriptor_update_template)))
+VILC_STATE_FILTER_INVALIDATING(vkCmdPushDescriptorSetWithTemplateKHR, VILC_STATE_FILTER_SHADOW_DESCRIPTOR_SETS, (VkCommandBuffer commandBuffer, VkDescriptorUpdateTemplate descriptorUpdateTemplate, VkPipelineLayout layout, uint32_t set, const void* pData), (commandBuffer, descriptorUpdateTemplate, layout, set, pData))
+#endif /* (defined(VK_KHR_descriptor_update_template) && defined(VK_KHR_push_descriptor)) || (defined(VK_KHR_push_descriptor) && (defined(VK_VERSION_1_1) || defined(VK_KHR_descriptor_update_template))) */
+
+#if defined(VK_EXT_descriptor_buffer)
+VILC_STATE_FILTER_INVALIDATING(vkCmdSetDescriptorBufferOffsetsEXT, VILC_STATE_FILTER_SHADOW_DESCRIPTOR_SETS, (VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout, uint32_t firstSet, uint32_t setCount, const uint32_t* pBufferIndices, const VkDeviceSize* pOffsets), (commandBuffer, pipelineBindPoint, layout, firstSet, setCount, pBufferIndices, pOffsets))
+VILC_STATE_FILTER_INVALIDATING(vkCmdBindDescriptorBufferEmbeddedSamplersEXT, VILC_STATE_FILTER_SHADOW_DESCRIPTOR_SETS, (VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout, uint32_t set), (commandBuffer, pipelineBindPoint, layout, set))
+#endif /* defined(VK_EXT_descriptor_buffer) */
+
+#if defined(VK_KHR_maintenance6) && defined(VK_EXT_descriptor_buffer)
+VILC_STATE_FILTER_INVALIDATING(vkCmdSetDescriptorBufferOffsets2EXT, VILC_STATE_FILTER_SHADOW_DESCRIPTOR_SETS, (VkCommandBuffer commandBuffer, const VkSetDescriptorBufferOffsetsInfoEXT* pSetDescriptorBufferOffsetsInfo), (commandBuffer, pSetDescriptorBufferOffsetsInfo))
+VILC_STATE_FILTER_INVALIDATING(vkCmdBindDescriptorBufferEmbeddedSamplers2EXT, VILC_STATE_FILTER_SHADOW_DESCRIPTOR_SETS, (VkCommandBuffer commandBuffer, const VkBindDescriptorBufferEmbeddedSamplersInfoEXT* pBindDescriptorBufferEmbeddedSamplersInfo), (commandBuffer, pBindDescriptorBufferEmbeddedSamplersInfo))
+#endif /* defined(VK_KHR_maintenance6) && defined(VK_EXT_descriptor_buffer) */
+
+#if (defined(VK_EXT_extended_dynamic_state)) || (defined(VK_EXT_shader_object))
+VILC_STATE_FILTER_INVALIDATING(vkCmdBindVertexBuffers2EXT, VILC_STATE_FILTER_SHADOW_VERTEX_BUFFERS, (VkCommandBuffer commandBuffer, uint32_t firstBinding, uint32_t bindingCount, const VkBuffer* pBuffers, const VkDeviceSize* pOffsets, const VkDeviceSize* pSizes, const VkDeviceSize* pStrides), (commandBuffer, firstBinding, bindingCount, pBuffers, pOffsets, pSizes, pStrides))
+VILC_STATE_FILTER_INVALIDATING(vkCmdSetViewportWithCountEXT, VILC_STATE_FILTER_SHADOW_VIEWPORTS, (VkCommandBuffer commandBuffer, uint32_t viewportCount, const VkViewport* pViewports), (commandBuffer, viewportCount, pViewports))
+VILC_STATE_FILTER_INVALIDATING(vkCmdSetScissorWithCountEXT, VILC_STATE_FILTER_SHADOW_SCISSORS, (VkCommandBuffer commandBuffer, uint32_t scissorCount, const VkRect2D* pScissors), (commandBuffer, scissorCount, pScissors))
+#endif /* (defined(VK_EXT_extended_dynamic_state)) || (defined(VK_EXT_shader_object)) */
+
+#if defined(VK_EXT_shader_object)
+VILC_STATE_FILTER_INVALIDATING(vkCmdBindShadersEXT, VILC_STATE_FILTER_SHADOW_PIPELINES, (VkCommandBuffer commandBuffer, uint32_t stageCount, const VkShaderStageFlagBits* pStages, const VkShaderEXT* pShaders), (commandBuffer, stageCount, pStages, pShaders))
+#endif /* defined(VK_EXT_shader_object) */
+
+#if defined(VK_KHR_swapchain)
+VILC_LAYER_NEXT(vilc_stateFilter, vkQueuePresentKHR)
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_stateFilter_vkQueuePresentKHR(VkQueue queue, const VkPresentInfoKHR* pPresentInfo)
+{
+	/* calls are counted when their command buffer is ended, so a frame holds the command buffers ended since the last present */
+	uint64_t elidedCalls = VILC_ATOMIC_LOAD(&vilc_stateFilter_frameElidedCalls);
+
+	VILC_ATOMIC_ADD(&vilc_stateFilter_frameElidedCalls, (uint64_t)0 - elidedCalls);
+	VILC_ATOMIC_STORE(&vilc_stateFilter_lastFrameElidedCalls, elidedCalls);
+	VILC_ATOMIC_ADD(&vilc_stateFilter_frameCount, 1);
+	return vilc_stateFilter_next_vkQueuePresentKHR(queue, pPresentInfo);
+}
+#endif /* defined(VK_KHR_swapchain) */
+
+static void vilc_stateFilter_install(void)
+{
+	VILC_LAYER_HOOK(vilc_stateFilter, vkDestroyDevice)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkDestroyCommandPool)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkAllocateCommandBuffers)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkFreeCommandBuffers)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkBeginCommandBuffer)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkEndCommandBuffer)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCreateGraphicsPipelines)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkDestroyPipeline)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdBindPipeline)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdBindDescriptorSets)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdBindVertexBuffers)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdBindIndexBuffer)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdSetViewport)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdSetScissor)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdPushConstants)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdBeginRenderPass)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdExecuteCommands)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdSetLineWidth)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdSetDepthBias)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdSetBlendConstants)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdSetDepthBounds)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdSetStencilCompareMask)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdSetStencilWriteMask)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdSetStencilReference)
+#if defined(VK_VERSION_1_2)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdBeginRenderPass2)
+#endif
+#if defined(VK_VERSION_1_3)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdBeginRendering)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdBindVertexBuffers2)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdSetViewportWithCount)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdSetScissorWithCount)
+#endif
+#if defined(VK_VERSION_1_4)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdBindIndexBuffer2)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdBindDescriptorSets2)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdPushConstants2)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdPushDescriptorSet)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdPushDescriptorSetWithTemplate)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdPushDescriptorSet2)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdPushDescriptorSetWithTemplate2)
+#endif
+#if defined(VK_KHR_create_renderpass2)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdBeginRenderPass2KHR)
+#endif
+#if defined(VK_KHR_dynamic_rendering)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdBeginRenderingKHR)
+#endif
+#if defined(VK_KHR_maintenance5)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdBindIndexBuffer2KHR)
+#endif
+#if defined(VK_KHR_maintenance6)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdBindDescriptorSets2KHR)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdPushConstants2KHR)
+#endif
+#if defined(VK_KHR_maintenance6) && defined(VK_KHR_push_descriptor)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdPushDescriptorSet2KHR)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdPushDescriptorSetWithTemplate2KHR)
+#endif
+#if defined(VK_KHR_push_descriptor)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdPushDescriptorSetKHR)
+#endif
+#if (defined(VK_KHR_descriptor_update_template) && defined(VK_KHR_push_descriptor)) || (defined(VK_KHR_push_descriptor) && (defined(VK_VERSION_1_1) || defined(VK_KHR_descriptor_update_template)))
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdPushDescriptorSetWithTemplateKHR)
+#endif
+#if defined(VK_EXT_descriptor_buffer)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdSetDescriptorBufferOffsetsEXT)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdBindDescriptorBufferEmbeddedSamplersEXT)
+#endif
+#if defined(VK_KHR_maintenance6) && defined(VK_EXT_descriptor_buffer)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdSetDescriptorBufferOffsets2EXT)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdBindDescriptorBufferEmbeddedSamplers2EXT)
+#endif
+#if (defined(VK_EXT_extended_dynamic_state)) || (defined(VK_EXT_shader_object))
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdBindVertexBuffers2EXT)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdSetViewportWithCountEXT)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdSetScissorWithCountEXT)
+#endif
+#if defined(VK_EXT_shader_object)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkCmdBindShadersEXT)
+#endif
+#if defined(VK_KHR_swapchain)
+	VILC_LAYER_HOOK(vilc_stateFilter, vkQueuePresentKHR)
+#endif
+}
+#endif /* VILC_STATE_FILTER */
+
+#if defined(VOLK_IN_LOADERS_CLOTH) && defined(VILC_BARRIER_COALESCING)
+/* Barrier coalescing: runs of vkCmdPipelineBarrier/vkCmdPipelineBarrier2 calls are buffered per command buffer and
+ * recorded as one barrier command before the next other command, or at vkEndCommandBuffer. Every barrier of the merged
+ * command gets the union of the stage masks, so execution dependency chains between the buffered calls are kept, and
+ * the global memory barrier, when there is one, the union of all access masks, so memory dependency chains through it
+ * are kept too. A barrier on a buffer or image that already has one pending, or with other dependency flags, flushes
+ * the pending ones first, which keeps layout transitions and queue family ownership transfers in order. Barriers inside
+ * render pass instances and barriers with pNext chains are recorded unchanged. The merged command is a
+ * vkCmdPipelineBarrier2 when synchronization2 is enabled on the device created last, and a vkCmdPipelineBarrier
+ * otherwise.
+ */
+#define VILC_BARRIER_COALESCING_BARRIER_COUNT 32
+
+typedef struct VilcBarrierCoalescingCommandBuffer
+{
+	VkCommandBuffer commandBuffer;
+	VkCommandPool commandPool;
+	int insideRenderPass;
+	/* barrier commands buffered since the last flush, and the union of their masks */
+	uint32_t pendingCalls;
+	VkDependencyFlags dependencyFlags;
+	VkPipelineStageFlags2 srcStageMask;
+	VkPipelineStageFlags2 dstStageMask;
+	VkAccessFlags2 srcAccessMask;
+	VkAccessFlags2 dstAccessMask;
+	int memoryBarrier;
+	uint32_t bufferBarrierCount;
+	uint32_t imageBarrierCount;
+	VkBufferMemoryBarrier2 bufferBarriers[VILC_BARRIER_COALESCING_BARRIER_COUNT];
+	VkImageMemoryBarrier2 imageBarriers[VILC_BARRIER_COALESCING_BARRIER_COUNT];
+} VilcBarrierCoalescingCommandBuffer;
+
+static pthread_mutex_t vilc_barrierCoalescing_mutex = PTHREAD_MUTEX_INITIALIZER;
+static VilcHandleMap vilc_barrierCoalescing_commandBuffers;
+/* command buffers with buffered barriers; other commands skip the lookup while there are none */
+static uint32_t vilc_barrierCoalescing_pendingCommandBuffers = 0;
+static int vilc_barrierCoalescing_sync2 = 0;
+static int vilc_barrierCoalescing_sync2KHR = 0;
+#if defined(VK_VERSION_1_3) || defined(VK_KHR_synchronization2)
+static PFN_vkCmdPipelineBarrier2KHR vilc_barrierCoalescing_pipelineBarrier2 = NULL;
+#endif
+static uint64_t vilc_barrierCoalescing_barrierCalls = 0;
+static uint64_t vilc_barrierCoalescing_flushedCalls = 0;
+static uint64_t vilc_barrierCoalescing_passedThroughCalls = 0;
+
+VILC_LAYER_NEXT(vilc_barrierCoalescing, vkCreateDevice)
+VILC_LAYER_NEXT(vilc_barrierCoalescing, vkDestroyDevice)
+VILC_LAYER_NEXT(vilc_barrierCoalescing, vkDestroyCommandPool)
+VILC_LAYER_NEXT(vilc_barrierCoalescing, vkAllocateCommandBuffers)
+VILC_LAYER_NEXT(vilc_barrierCoalescing, vkFreeCommandBuffers)
+VILC_LAYER_NEXT(vilc_barrierCoalescing, vkBeginCommandBuffer)
+VILC_LAYER_NEXT(vilc_barrierCoalescing, vkEndCommandBuffer)
+VILC_LAYER_NEXT(vilc_barrierCoalescing, vkCmdPipelineBarrier)
+
+/* Every command recorded into a command buffer first flushes its pending barriers, through a layer of its own that is
+ * installed under the barrier hooks; the merged barrier is recorded through it too, after the pending ones are taken.
+ */
+#define VILC_BARRIER_COALESCING_FLUSH(name, params, args) \
+	VILC_LAYER_NEXT(vilc_barrierCoalescingFlush, name) \
+	static VKAPI_ATTR void VKAPI_CALL vilc_barrierCoalescingFlush_##name params \
+	{ \
+		vilc_barrierCoalescing_flush(commandBuffer); \
+		vilc_barrierCoalescingFlush_next_##name args; \
+	}
+#define VILC_BARRIER_COALESCING_FLUSH_RESULT(name, params, args) \
+	VILC_LAYER_NEXT(vilc_barrierCoalescingFlush, name) \
+	static VKAPI_ATTR VkResult VKAPI_CALL vilc_barrierCoalescingFlush_##name params \
+	{ \
+		vilc_barrierCoalescing_flush(commandBuffer); \
+		return vilc_barrierCoalescingFlush_next_##name args; \
+	}
+
+static void vilc_barrierCoalescing_flush(VkCommandBuffer commandBuffer);
+
+VILC_DEVICE_COMMANDS(VILC_BARRIER_COALESCING_FLUSH, VILC_BARRIER_COALESCING_FLUSH_RESULT)
+#undef VILC_BARRIER_COALESCING_FLUSH
+#undef VILC_BARRIER_COALESCING_FLUSH_RESULT
+
+static VilcBarrierCoalescingCommandBuffer* vilc_barrierCoalescing_find(VkCommandBuffer commandBuffer)
+{
+	VilcBarrierCoalescingCommandBuffer* state;
+
+	pthread_mutex_lock(&vilc_barrierCoalescing_mutex);
+	state = (VilcBarrierCoalescingCommandBuffer*)vilc_mapFind(&vilc_barrierCoalescing_commandBuffers, VILC_DISPATCHABLE_KEY(commandBuffer));
+	pthread_mutex_unlock(&vilc_barrierCoalescing_mutex);
+
+	return state;
+}
+
+static void vilc_barrierCoalescing_discard(VilcBarrierCoalescingCommandBuffer* state)
+{
+	if (state->pendingCalls)
+		VILC_ATOMIC_ADD(&vilc_barrierCoalescing_pendingCommandBuffers, (uint32_t)-1);
+	state->pendingCalls = 0;
+	state->srcStageMask = state->dstStageMask = 0;
+	state->srcAccessMask = state->dstAccessMask = 0;
+	state->memoryBarrier = 0;
+	state->bufferBarrierCount = state->imageBarrierCount = 0;
+}
+
+/* Records the pending barriers as one barrier command */
+static void vilc_barrierCoalescing_record(VilcBarrierCoalescingCommandBuffer* state)
+{
+	VkMemoryBarrier memoryBarrier;
+	VkBufferMemoryBarrier bufferBarriers[VILC_BARRIER_COALESCING_BARRIER_COUNT];
+	VkImageMemoryBarrier imageBarriers[VILC_BARRIER_COALESCING_BARRIER_COUNT];
+	uint32_t i;
+
+	for (i = 0; i < state->bufferBarrierCount; ++i)
+	{
+		state->bufferBarriers[i].srcStageMask = state->srcStageMask;
+		state->bufferBarriers[i].dstStageMask = state->dstStageMask;
+	}
+	for (i = 0; i < state->imageBarrierCount; ++i)
+	{
+		state->imageBarriers[i].srcStageMask = state->srcStageMask;
+		state->imageBarriers[i].dstStageMask = state->dstStageMask;
+	}
+
+#if defined(VK_VERSION_1_3) || defined(VK_KHR_synchronization2)
+	if (vilc_barrierCoalescing_pipelineBarrier2)
+	{
+		VkMemoryBarrier2 memoryBarrier2;
+		VkDependencyInfo dependencyInfo;
+
+		memset(&memoryBarrier2, 0, sizeof(memoryBarrier2));
+		memoryBarrier2.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+		memoryBarrier2.srcStageMask = state->srcStageMask;
+		memoryBarrier2.srcAccessMask = state->srcAccessMask;
+		memoryBarrier2.dstStageMask = state->dstStageMask;
+		memoryBarrier2.dstAccessMask = state->dstAccessMask;
+		memset(&dependencyInfo, 0, sizeof(dependencyInfo));
+		dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+		dependencyInfo.dependencyFlags = state->dependencyFlags;
+		dependencyInfo.memoryBarrierCount = state->memoryBarrier ? 1 : 0;
+		dependencyInfo.pMemoryBarriers = &memoryBarrier2;
+		dependencyInfo.bufferMemoryBarrierCount = state->bufferBarrierCount;
+		dependencyInfo.pBufferMemoryBarriers = state->bufferBarriers;
+		dependencyInfo.imageMemoryBarrierCount = state->imageBarrierCount;
+		dependencyInfo.pImageMemoryBarriers = state->imageBarriers;
+		vilc_barrierCoalescing_pipelineBarrier2(state->commandBuffer, &dependencyInfo);
+		return;
+	}
+#endif
+
+	/* without synchronization2 only vkCmdPipelineBarrier calls were buffered, so the masks fit */
+	memset(&memoryBarrier, 0, sizeof(memoryBarrier));
+	memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	memoryBarrier.srcAccessMask = (VkAccessFlags)state->srcAccessMask;
+	memoryBarrier.dstAccessMask = (VkAccessFlags)state->dstAccessMask;
+	for (i = 0; i < state->bufferBarrierCount; ++i)
+	{
+		const VkBufferMemoryBarrier2* barrier = &state->bufferBarriers[i];
+		VkBufferMemoryBarrier* legacy = &bufferBarriers[i];
+
+		legacy->sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		legacy->pNext = NULL;
+		legacy->srcAccessMask = (VkAccessFlags)barrier->srcAccessMask;
+		legacy->dstAccessMask = (VkAccessFlags)barrier->dstAccessMask;
+		legacy->srcQueueFamilyIndex = barrier->srcQueueFamilyIndex;
+		legacy->dstQueueFamilyIndex = barrier->dstQueueFamilyIndex;
+		legacy->buffer = barrier->buffer;
+		legacy->offset = barrier->offset;
+		legacy->size = barrier->size;
+	}
+	for (i = 0; i < state->imageBarrierCount; ++i)
+	{
+		const VkImageMemoryBarrier2* barrier = &state->imageBarriers[i];
+		VkImageMemoryBarrier* legacy = &imageBarriers[i];
+
+		legacy->sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		legacy->pNext = NULL;
+		legacy->srcAccessMask = (VkAccessFlags)barrier->srcAccessMask;
+		legacy->dstAccessMask = (VkAccessFlags)barrier->dstAccessMask;
+		legacy->oldLayout = barrier->oldLayout;
+		legacy->newLayout = barrier->newLayout;
+		legacy->srcQueueFamilyIndex = barrier->srcQueueFamilyIndex;
+		legacy->dstQueueFamilyIndex = barrier->dstQueueFamilyIndex;
+		legacy->image = barrier->image;
+		legacy->subresourceRange = barrier->subresourceRange;
+	}
+	vilc_barrierCoalescingFlush_next_vkCmdPipelineBarrier(state->commandBuffer, (VkPipelineStageFlags)state->srcStageMask, (VkPipelineStageFlags)state->dstStageMask,
+	    state->dependencyFlags, state->memoryBarrier ? 1 : 0, &memoryBarrier, state->bufferBarrierCount, bufferBarriers, state->imageBarrierCount, imageBarriers);
+}
+
+static void vilc_barrierCoalescing_flushState(VilcBarrierCoalescingCommandBuffer* state)
+{
+	if (!state->pendingCalls)
+		return;
+
+	vilc_barrierCoalescing_record(state);
+	VILC_ATOMIC_ADD(&vilc_barrierCoalescing_flushedCalls, 1);
+	vilc_barrierCoalescing_discard(state);
+}
+
+static void vilc_barrierCoalescing_flush(VkCommandBuffer commandBuffer)
+{
+	VilcBarrierCoalescingCommandBuffer* state;
+
+	if (!VILC_ATOMIC_LOAD(&vilc_barrierCoalescing_pendingCommandBuffers))
+		return;
+
+	state = vilc_barrierCoalescing_find(commandBuffer);
+	if (state)
+		vilc_barrierCoalescing_flushState(state);
+}
+
+/* Whether the barrier command can be buffered at all; when it cannot, it is recorded after the pending ones */
+static int vilc_barrierCoalescing_canBuffer(const VilcBarrierCoalescingCommandBuffer* state, int chained, uint32_t bufferBarrierCount, uint32_t imageBarrierCount)
+{
+	return state && !state->insideRenderPass && !chained && bufferBarrierCount <= VILC_BARRIER_COALESCING_BARRIER_COUNT &&
+	    imageBarrierCount <= VILC_BARRIER_COALESCING_BARRIER_COUNT;
+}
+
+static void vilc_barrierCoalescing_passThrough(VilcBarrierCoalescingCommandBuffer* state)
+{
+	if (state)
+		vilc_barrierCoalescing_flushState(state);
+	VILC_ATOMIC_ADD(&vilc_barrierCoalescing_passedThroughCalls, 1);
+}
+
+/* A buffer or image with a pending barrier gets its next barrier in a later command, so transitions stay in order */
+static int vilc_barrierCoalescing_pendingBuffer(const VilcBarrierCoalescingCommandBuffer* state, VkBuffer buffer)
+{
+	uint32_t i;
+	for (i = 0; i < state->bufferBarrierCount; ++i)
+		if (state->bufferBarriers[i].buffer == buffer)
+			return 1;
+	return 0;
+}
+
+static int vilc_barrierCoalescing_pendingImage(const VilcBarrierCoalescingCommandBuffer* state, VkImage image)
+{
+	uint32_t i;
+	for (i = 0; i < state->imageBarrierCount; ++i)
+		if (state->imageBarriers[i].image == image)
+			return 1;
+	return 0;
+}
+
+/* Flushes the pending barriers when the next barrier command cannot be merged with them, then adds it to the count */
+static void vilc_barrierCoalescing_addCall(VilcBarrierCoalescingCommandBuffer* state, VkDependencyFlags dependencyFlags, uint32_t bufferBarrierCount, uint32_t imageBarrierCount, int conflict)
+{
+	conflict |= dependencyFlags != state->dependencyFlags;
+	conflict |= state->bufferBarrierCount + bufferBarrierCount > VILC_BARRIER_COALESCING_BARRIER_COUNT;
+	conflict |= state->imageBarrierCount + imageBarrierCount > VILC_BARRIER_COALESCING_BARRIER_COUNT;
+	if (state->pendingCalls && conflict)
+		vilc_barrierCoalescing_flushState(state);
+
+	if (!state->pendingCalls)
+		VILC_ATOMIC_ADD(&vilc_barrierCoalescing_pendingCommandBuffers, 1);
+	state->pendingCalls++;
+	state->dependencyFlags = dependencyFlags;
+	VILC_ATOMIC_ADD(&vilc_barrierCoalescing_barrierCalls, 1);
+}
+
+static void vilc_barrierCoalescing_addMasks(VilcBarrierCoalescingCommandBuffer* state, VkPipelineStageFlags2 srcStageMask, VkAccessFlags2 srcAccessMask,
+    VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask)
+{
+	state->srcStageMask |= srcStageMask;
+	state->srcAccessMask |= srcAccessMask;
+	state->dstStageMask |= dstStageMask;
+	state->dstAccessMask |= dstAccessMask;
+}
+
+void vilcGetBarrierCoalescingStats(VilcBarrierCoalescingStats* stats)
+{
+	stats->barrierCalls = VILC_ATOMIC_LOAD(&vilc_barrierCoalescing_barrierCalls);
+	stats->flushedCalls = VILC_ATOMIC_LOAD(&vilc_barrierCoalescing_flushedCalls);
+	stats->passedThroughCalls = VILC_ATOMIC_LOAD(&vilc_barrierCoalescing_passedThroughCalls);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_barrierCoalescing_vkCreateDevice(VkPhysicalDevice physicalDevice, const VkDeviceCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDevice* pDevice)
+{
+	VkResult result = vilc_barrierCoalescing_next_vkCreateDevice(physicalDevice, pCreateInfo, pAllocator, pDevice);
+	const VkBaseInStructure* next;
+
+	if (result != VK_SUCCESS)
+		return result;
+
+	vilc_barrierCoalescing_sync2 = 0;
+	vilc_barrierCoalescing_sync2KHR = 0;
+#if defined(VK_KHR_synchronization2)
+	vilc_barrierCoalescing_sync2KHR = vilc_hasDeviceExtension(pCreateInfo, VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+#endif
+	for (next = (const VkBaseInStructure*)pCreateInfo->pNext; next; next = next->pNext)
+	{
+#if defined(VK_VERSION_1_3)
+		if (next->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES)
+			vilc_barrierCoalescing_sync2 |= ((const VkPhysicalDeviceVulkan13Features*)next)->synchronization2;
+#endif
+#if defined(VK_KHR_synchronization2)
+		if (next->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR)
+			vilc_barrierCoalescing_sync2 |= ((const VkPhysicalDeviceSynchronization2FeaturesKHR*)next)->synchronization2;
+#endif
+	}
+
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_barrierCoalescing_vkDestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator)
+{
+	VilcBarrierCoalescingStats stats;
+	uint32_t i;
+
+	pthread_mutex_lock(&vilc_barrierCoalescing_mutex);
+	for (i = 0; i < vilc_barrierCoalescing_commandBuffers.capacity; ++i)
+		if (vilc_barrierCoalescing_commandBuffers.keys[i])
+			free(vilc_barrierCoalescing_commandBuffers.values[i]);
+	vilc_mapFree(&vilc_barrierCoalescing_commandBuffers);
+	VILC_ATOMIC_STORE(&vilc_barrierCoalescing_pendingCommandBuffers, 0);
+	pthread_mutex_unlock(&vilc_barrierCoalescing_mutex);
+
+	vilcGetBarrierCoalescingStats(&stats);
+	fprintf(stderr, "vilc: barrier coalescing: %llu barrier calls recorded as %llu, %llu passed through\n", (unsigned long long)stats.barrierCalls,
+	    (unsigned long long)stats.flushedCalls, (unsigned long long)stats.passedThroughCalls);
+
+	vilc_barrierCoalescing_next_vkDestroyDevice(device, pAllocator);
+}
+
+static void vilc_barrierCoalescing_freeCommandBuffer(VilcBarrierCoalescingCommandBuffer* state)
+{
+	if (state)
+		vilc_barrierCoalescing_discard(state);
+	free(state);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_barrierCoalescing_vkDestroyCommandPool(VkDevice device, VkCommandPool commandPool, const VkAllocationCallbacks* pAllocator)
+{
+	uint32_t i = 0;
+
+	pthread_mutex_lock(&vilc_barrierCoalescing_mutex);
+	/* removal shifts later entries back into the scanned slot, so it is scanned again */
+	while (commandPool && i < vilc_barrierCoalescing_commandBuffers.capacity)
+	{
+		VilcBarrierCoalescingCommandBuffer* state = (VilcBarrierCoalescingCommandBuffer*)vilc_barrierCoalescing_commandBuffers.values[i];
+		if (vilc_barrierCoalescing_commandBuffers.keys[i] && state->commandPool == commandPool)
+			vilc_barrierCoalescing_freeCommandBuffer((VilcBarrierCoalescingCommandBuffer*)vilc_mapRemove(&vilc_barrierCoalescing_commandBuffers, vilc_barrierCoalescing_commandBuffers.keys[i]));
+		else
+			++i;
+	}
+	pthread_mutex_unlock(&vilc_barrierCoalescing_mutex);
+
+	vilc_barrierCoalescing_next_vkDestroyCommandPool(device, commandPool, pAllocator);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_barrierCoalescing_vkAllocateCommandBuffers(VkDevice device, const VkCommandBufferAllocateInfo* pAllocateInfo, VkCommandBuffer* pCommandBuffers)
+{
+	VkResult result = vilc_barrierCoalescing_next_vkAllocateCommandBuffers(device, pAllocateInfo, pCommandBuffers);
+	uint32_t i;
+
+	if (result != VK_SUCCESS)
+		return result;
+
+	pthread_mutex_lock(&vilc_barrierCoalescing_mutex);
+	for (i = 0; i < pAllocateInfo->commandBufferCount; ++i)
+	{
+		VilcBarrierCoalescingCommandBuffer* state = (VilcBarrierCoalescingCommandBuffer*)calloc(1, sizeof(VilcBarrierCoalescingCommandBuffer));
+		if (!state)
+			break;
+		state->commandBuffer = pCommandBuffers[i];
+		state->commandPool = pAllocateInfo->commandPool;
+		if (!vilc_mapInsert(&vilc_barrierCoalescing_commandBuffers, VILC_DISPATCHABLE_KEY(pCommandBuffers[i]), state))
+			free(state);
+	}
+	pthread_mutex_unlock(&vilc_barrierCoalescing_mutex);
+
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_barrierCoalescing_vkFreeCommandBuffers(VkDevice device, VkCommandPool commandPool, uint32_t commandBufferCount, const VkCommandBuffer* pCommandBuffers)
+{
+	uint32_t i;
+
+	pthread_mutex_lock(&vilc_barrierCoalescing_mutex);
+	for (i = 0; i < commandBufferCount; ++i)
+		if (pCommandBuffers[i])
+			vilc_barrierCoalescing_freeCommandBuffer((VilcBarrierCoalescingCommandBuffer*)vilc_mapRemove(&vilc_barrierCoalescing_commandBuffers, VILC_DISPATCHABLE_KEY(pCommandBuffers[i])));
+	pthread_mutex_unlock(&vilc_barrierCoalescing_mutex);
+
+	vilc_barrierCoalescing_next_vkFreeCommandBuffers(device, commandPool, commandBufferCount, pCommandBuffers);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_barrierCoalescing_vkBeginCommandBuffer(VkCommandBuffer commandBuffer, const VkCommandBufferBeginInfo* pBeginInfo)
+{
+	VilcBarrierCoalescingCommandBuffer* state = vilc_barrierCoalescing_find(commandBuffer);
+
+	/* barriers of a recording that was never ended are dropped with it; secondary command buffers that continue a
+	 * render pass are inside it from the start (the flag is ignored for primary ones, which then just pass through)
+	 */
+	if (state)
+	{
+		vilc_barrierCoalescing_discard(state);
+		state->insideRenderPass = (pBeginInfo->flags & VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT) != 0;
+	}
+	return vilc_barrierCoalescing_next_vkBeginCommandBuffer(commandBuffer, pBeginInfo);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_barrierCoalescing_vkEndCommandBuffer(VkCommandBuffer commandBuffer)
+{
+	vilc_barrierCoalescing_flush(commandBuffer);
+	return vilc_barrierCoalescing_next_vkEndCommandBuffer(commandBuffer);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_barrierCoalescing_vkCmdPipelineBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask,
+    VkDependencyFlags dependencyFlags, uint32_t memoryBarrierCount, const VkMemoryBarrier* pMemoryBarriers, uint32_t bufferMemoryBarrierCount,
+    const VkBufferMemoryBarrier* pBufferMemoryBarriers, uint32_t imageMemoryBarrierCount, const VkImageMemoryBarrier* pImageMemoryBarriers)
+{
+	VilcBarrierCoalescingCommandBuffer* state = vilc_barrierCoalescing_find(commandBuffer);
+	int chained = 0, conflict = 0;
+	uint32_t i;
+
+	for (i = 0; i < memoryBarrierCount; ++i)
+		chained |= pMemoryBarriers[i].pNext != NULL;
+	for (i = 0; i < bufferMemoryBarrierCount; ++i)
+		chained |= pBufferMemoryBarriers[i].pNext != NULL;
+	for (i = 0; i < imageMemoryBarrierCount; ++i)
+		chained |= pImageMemoryBarriers[i].pNext != NULL;
+
+	if (!vilc_barrierCoalescing_canBuffer(state, chained, bufferMemoryBarrierCount, imageMemoryBarrierCount))
+	{
+		vilc_barrierCoalescing_passThrough(state);
+		vilc_barrierCoalescing_next_vkCmdPipelineBarrier(commandBuffer, srcStageMask, dstStageMask, dependencyFlags, memoryBarrierCount, pMemoryBarriers,
+		    bufferMemoryBarrierCount, pBufferMemoryBarriers, imageMemoryBarrierCount, pImageMemoryBarriers);
+		return;
+	}
+
+	for (i = 0; i < bufferMemoryBarrierCount; ++i)
+		conflict |= vilc_barrierCoalescing_pendingBuffer(state, pBufferMemoryBarriers[i].buffer);
+	for (i = 0; i < imageMemoryBarrierCount; ++i)
+		conflict |= vilc_barrierCoalescing_pendingImage(state, pImageMemoryBarriers[i].image);
+	vilc_barrierCoalescing_addCall(state, dependencyFlags, bufferMemoryBarrierCount, imageMemoryBarrierCount, conflict);
+	vilc_barrierCoalescing_addMasks(state, srcStageMask, 0, dstStageMask, 0);
+
+	/* the stage masks apply to the whole call, so a call without barriers is an execution dependency on its own */
+	state->memoryBarrier |= memoryBarrierCount || (!bufferMemoryBarrierCount && !imageMemoryBarrierCount);
+	for (i = 0; i < memoryBarrierCount; ++i)
+		vilc_barrierCoalescing_addMasks(state, 0, pMemoryBarriers[i].srcAccessMask, 0, pMemoryBarriers[i].dstAccessMask);
+	for (i = 0; i < bufferMemoryBarrierCount; ++i)
+	{
+		const VkBufferMemoryBarrier* barrier = &pBufferMemoryBarriers[i];
+		VkBufferMemoryBarrier2* pending = &state->bufferBarriers[state->bufferBarrierCount++];
+
+		memset(pending, 0, sizeof(*pending));
+		pending->sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+		pending->srcAccessMask = barrier->srcAccessMask;
+		pending->dstAccessMask = barrier->dstAccessMask;
+		pending->srcQueueFamilyIndex = barrier->srcQueueFamilyIndex;
+		pending->dstQueueFamilyIndex = barrier->dstQueueFamilyIndex;
+		pending->buffer = barrier->buffer;
+		pending->offset = barrier->offset;
+		pending->size = barrier->size;
+		vilc_barrierCoalescing_addMasks(state, 0, barrier->srcAccessMask, 0, barrier->dstAccessMask);
+	}
+	for (i = 0; i < imageMemoryBarrierCount; ++i)
+	{
+		const VkImageMemoryBarrier* barrier = &pImageMemoryBarriers[i];
+		VkImageMemoryBarrier2* pending = &state->imageBarriers[state->imageBarrierCount++];
+
+		memset(pending, 0, sizeof(*pending));
+		pending->sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+		pending->srcAccessMask = barrier->srcAccessMask;
+		pending->dstAccessMask = barrier->dstAccessMask;
+		pending->oldLayout = barrier->oldLayout;
+		pending->newLayout = barrier->newLayout;
+		pending->srcQueueFamilyIndex = barrier->srcQueueFamilyIndex;
+		pending->dstQueueFamilyIndex = barrier->dstQueueFamilyIndex;
+		pending->image = barrier->image;
+		pending->subresourceRange = barrier->subresourceRange;
+		vilc_barrierCoalescing_addMasks(state, 0, barrier->srcAccessMask, 0, barrier->dstAccessMask);
+	}
+}
+
+#if defined(VK_VERSION_1_3) || defined(VK_KHR_synchronization2)
+static int vilc_barrierCoalescing_pipelineBarrier2Buffered(VkCommandBuffer commandBuffer, const VkDependencyInfo* pDependencyInfo)
+{
+	VilcBarrierCoalescingCommandBuffer* state = vilc_barrierCoalescing_find(commandBuffer);
+	int chained = pDependencyInfo->pNext != NULL, conflict = 0;
+	uint32_t i;
+
+	for (i = 0; i < pDependencyInfo->memoryBarrierCount; ++i)
+		chained |= pDependencyInfo->pMemoryBarriers[i].pNext != NULL;
+	for (i = 0; i < pDependencyInfo->bufferMemoryBarrierCount; ++i)
+		chained |= pDependencyInfo->pBufferMemoryBarriers[i].pNext != NULL;
+	for (i = 0; i < pDependencyInfo->imageMemoryBarrierCount; ++i)
+		chained |= pDependencyInfo->pImageMemoryBarriers[i].pNext != NULL;
+
+	/* the merged command is recorded with the entry point chosen for the device */
+	if (!vilc_barrierCoalescing_pipelineBarrier2 || !vilc_barrierCoalescing_canBuffer(state, chained, pDependencyInfo->bufferMemoryBarrierCount, pDependencyInfo->imageMemoryBarrierCount))
+	{
+		vilc_barrierCoalescing_passThrough(state);
+		return 0;
+	}
+
+	for (i = 0; i < pDependencyInfo->bufferMemoryBarrierCount; ++i)
+		conflict |= vilc_barrierCoalescing_pendingBuffer(state, pDependencyInfo->pBufferMemoryBarriers[i].buffer);
+	for (i = 0; i < pDependencyInfo->imageMemoryBarrierCount; ++i)
+		conflict |= vilc_barrierCoalescing_pendingImage(state, pDependencyInfo->pImageMemoryBarriers[i].image);
+	vilc_barrierCoalescing_addCall(state, pDependencyInfo->dependencyFlags, pDependencyInfo->bufferMemoryBarrierCount, pDependencyInfo->imageMemoryBarrierCount, conflict);
+
+	state->memoryBarrier |= pDependencyInfo->memoryBarrierCount != 0;
+	for (i = 0; i < pDependencyInfo->memoryBarrierCount; ++i)
+	{
+		const VkMemoryBarrier2* barrier = &pDependencyInfo->pMemoryBarriers[i];
+		vilc_barrierCoalescing_addMasks(state, barrier->srcStageMask, barrier->srcAccessMask, barrier->dstStageMask, barrier->dstAccessMask);
+	}
+	for (i = 0; i < pDependencyInfo->bufferMemoryBarrierCount; ++i)
+	{
+		const VkBufferMemoryBarrier2* barrier = &pDependencyInfo->pBufferMemoryBarriers[i];
+		state->bufferBarriers[state->bufferBarrierCount++] = *barrier;
+		vilc_barrierCoalescing_addMasks(state, barrier->srcStageMask, barrier->srcAccessMask, barrier->dstStageMask, barrier->dstAccessMask);
+	}
+	for (i = 0; i < pDependencyInfo->imageMemoryBarrierCount; ++i)
+	{
+		const VkImageMemoryBarrier2* barrier = &pDependencyInfo->pImageMemoryBarriers[i];
+		state->imageBarriers[state->imageBarrierCount++] = *barrier;
+		vilc_barrierCoalescing_addMasks(state, barrier->srcStageMask, barrier->srcAccessMask, barrier->dstStageMask, barrier->dstAccessMask);
+	}
+
+	return 1;
+}
+#endif /* defined(VK_VERSION_1_3) || defined(VK_KHR_synchronization2) */
+
+#if defined(VK_VERSION_1_3)
+VILC_LAYER_NEXT(vilc_barrierCoalescing, vkCmdPipelineBarrier2)
+
+static VKAPI_ATTR void VKAPI_CALL vilc_barrierCoalescing_vkCmdPipelineBarrier2(VkCommandBuffer commandBuffer, const VkDependencyInfo* pDependencyInfo)
+{
+	if (!vilc_barrierCoalescing_pipelineBarrier2Buffered(commandBuffer, pDependencyInfo))
+		vilc_barrierCoalescing_next_vkCmdPipelineBarrier2(commandBuffer, pDependencyInfo);
+}
+#endif /* defined(VK_VERSION_1_3) */
+
+#if defined(VK_KHR_synchronization2)
+VILC_LAYER_NEXT(vilc_barrierCoalescing, vkCmdPipelineBarrier2KHR)
+
+static VKAPI_ATTR void VKAPI_CALL vilc_barrierCoalescing_vkCmdPipelineBarrier2KHR(VkCommandBuffer commandBuffer, const VkDependencyInfo* pDependencyInfo)
+{
+	if (!vilc_barrierCoalescing_pipelineBarrier2Buffered(commandBuffer, pDependencyInfo))
+		vilc_barrierCoalescing_next_vkCmdPipelineBarrier2KHR(commandBuffer, pDependencyInfo);
+}
+#endif /* defined(VK_KHR_synchronization2) */
+
+/* Render pass instances are tracked so barriers inside them, which must match a subpass self-dependency, pass through */
+#define VILC_BARRIER_COALESCING_RENDER_PASS(name, inside, params, args) \
+	VILC_LAYER_NEXT(vilc_barrierCoalescing, name) \
+	static VKAPI_ATTR void VKAPI_CALL vilc_barrierCoalescing_##name params \
+	{ \
+		VilcBarrierCoalescingCommandBuffer* state = vilc_barrierCoalescing_find(commandBuffer); \
+		if (state) \
+			state->insideRenderPass = inside; \
+		vilc_barrierCoalescing_next_##name args; \
+	}
+
+VILC_BARRIER_COALESCING_RENDER_PASS(vkCmdBeginRenderPass, 1, (VkCommandBuffer commandBuffer, const VkRenderPassBeginInfo* pRenderPassBegin, VkSubpassContents contents), (commandBuffer, pRenderPassBegin, contents))
+VILC_BARRIER_COALESCING_RENDER_PASS(vkCmdEndRenderPass, 0, (VkCommandBuffer commandBuffer), (commandBuffer))
+
+#if defined(VK_VERSION_1_2)
+VILC_BARRIER_COALESCING_RENDER_PASS(vkCmdBeginRenderPass2, 1, (VkCommandBuffer commandBuffer, const VkRenderPassBeginInfo* pRenderPassBegin, const VkSubpassBeginInfo* pSubpassBeginInfo), (commandBuffer, pRenderPassBegin, pSubpassBeginInfo))
+VILC_BARRIER_COALESCING_RENDER_PASS(vkCmdEndRenderPass2, 0, (VkCommandBuffer commandBuffer, const VkSubpassEndInfo* pSubpassEndInfo), (commandBuffer, pSubpassEndInfo))
+#endif /* defined(VK_VERSION_1_2) */
+
+#if defined(VK_VERSION_1_3)
+VILC_BARRIER_COALESCING_RENDER_PASS(vkCmdBeginRendering, 1, (VkCommandBuffer commandBuffer, const VkRenderingInfo* pRenderingInfo), (commandBuffer, pRenderingInfo))
+VILC_BARRIER_COALESCING_RENDER_PASS(vkCmdEndRendering, 0, (VkCommandBuffer commandBuffer), (commandBuffer))
+#endif /* defined(VK_VERSION_1_3) */
+
+#if defined(VK_KHR_create_renderpass2)
+VILC_BARRIER_COALESCING_RENDER_PASS(vkCmdBeginRenderPass2KHR, 1, (VkCommandBuffer commandBuffer, const VkRenderPassBeginInfo* pRenderPassBegin, const VkSubpassBeginInfo* pSubpassBeginInfo), (commandBuffer, pRenderPassBegin, pSubpassBeginInfo))
+VILC_BARRIER_COALESCING_RENDER_PASS(vkCmdEndRenderPass2KHR, 0, (VkCommandBuffer commandBuffer, const VkSubpassEndInfo* pSubpassEndInfo), (commandBuffer, pSubpassEndInfo))
+#endif /* defined(VK_KHR_create_renderpass2) */
+
+#if defined(VK_KHR_dynamic_rendering)
+VILC_BARRIER_COALESCING_RENDER_PASS(vkCmdBeginRenderingKHR, 1, (VkCommandBuffer commandBuffer, const VkRenderingInfo* pRenderingInfo), (commandBuffer, pRenderingInfo))
+VILC_BARRIER_COALESCING_RENDER_PASS(vkCmdEndRenderingKHR, 0, (VkCommandBuffer commandBuffer), (commandBuffer))
+#endif /* defined(VK_KHR_dynamic_rendering) */
+
+#if defined(VK_EXT_fragment_density_map_offset)
+VILC_BARRIER_COALESCING_RENDER_PASS(vkCmdEndRendering2EXT, 0, (VkCommandBuffer commandBuffer, const VkRenderingEndInfoKHR* pRenderingEndInfo), (commandBuffer, pRenderingEndInfo))
+#endif /* defined(VK_EXT_fragment_density_map_offset) */
+
+#if defined(VK_KHR_maintenance10)
+VILC_BARRIER_COALESCING_RENDER_PASS(vkCmdEndRendering2KHR, 0, (VkCommandBuffer commandBuffer, const VkRenderingEndInfoKHR* pRenderingEndInfo), (commandBuffer, pRenderingEndInfo))
+#endif /* defined(VK_KHR_maintenance10) */
+
+static void vilc_barrierCoalescing_installInstance(void)
+{
+	VILC_LAYER_HOOK(vilc_barrierCoalescing, vkCreateDevice)
+}
+
+static void vilc_barrierCoalescing_installDevice(void)
+{
+#define VILC_BARRIER_COALESCING_HOOK(name, params, args) VILC_LAYER_HOOK(vilc_barrierCoalescingFlush, name)
+	VILC_DEVICE_COMMANDS(VILC_BARRIER_COALESCING_HOOK, VILC_BARRIER_COALESCING_HOOK)
+#undef VILC_BARRIER_COALESCING_HOOK
+
+#if defined(VK_VERSION_1_3) || defined(VK_KHR_synchronization2)
+	vilc_barrierCoalescing_pipelineBarrier2 = NULL;
+#if defined(VK_VERSION_1_3)
+	if (vilc_barrierCoalescing_sync2 && !vilc_barrierCoalescing_sync2KHR)
+		vilc_barrierCoalescing_pipelineBarrier2 = vilc_barrierCoalescingFlush_next_vkCmdPipelineBarrier2;
+#endif
+#if defined(VK_KHR_synchronization2)
+	if (vilc_barrierCoalescing_sync2 && vilc_barrierCoalescing_sync2KHR)
+		vilc_barrierCoalescing_pipelineBarrier2 = vilc_barrierCoalescingFlush_next_vkCmdPipelineBarrier2KHR;
+#endif
+#endif
+
+	VILC_LAYER_HOOK(vilc_barrierCoalescing, vkDestroyDevice)
+	VILC_LAYER_HOOK(vilc_barrierCoalescing, vkDestroyCommandPool)
+	VILC_LAYER_HOOK(vilc_barrierCoalescing, vkAllocateCommandBuffers)
+	VILC_LAYER_HOOK(vilc_barrierCoalescing, vkFreeCommandBuffers)
+	VILC_LAYER_HOOK(vilc_barrierCoalescing, vkBeginCommandBuffer)
+	VILC_LAYER_HOOK(vilc_barrierCoalescing, vkEndCommandBuffer)
+	VILC_LAYER_HOOK(vilc_barrierCoalescing, vkCmdPipelineBarrier)
+	VILC_LAYER_HOOK(vilc_barrierCoalescing, vkCmdBeginRenderPass)
+	VILC_LAYER_HOOK(vilc_barrierCoalescing, vkCmdEndRenderPass)
+#if defined(VK_VERSION_1_2)
+	VILC_LAYER_HOOK(vilc_barrierCoalescing, vkCmdBeginRenderPass2)
+	VILC_LAYER_HOOK(vilc_barrierCoalescing, vkCmdEndRenderPass2)
+#endif
+#if defined(VK_VERSION_1_3)
+	VILC_LAYER_HOOK(vilc_barrierCoalescing, vkCmdPipelineBarrier2)
+	VILC_LAYER_HOOK(vilc_barrierCoalescing, vkCmdBeginRendering)
+	VILC_LAYER_HOOK(vilc_barrierCoalescing, vkCmdEndRendering)
+#endif
+#if defined(VK_KHR_create_renderpass2)
+	VILC_LAYER_HOOK(vilc_barrierCoalescing, vkCmdBeginRenderPass2KHR)
+	VILC_LAYER_HOOK(vilc_barrierCoalescing, vkCmdEndRenderPass2KHR)
+#endif
+#if defined(VK_KHR_dynamic_rendering)
+	VILC_LAYER_HOOK(vilc_barrierCoalescing, vkCmdBeginRenderingKHR)
+	VILC_LAYER_HOOK(vilc_barrierCoalescing, vkCmdEndRenderingKHR)
+#endif
+#if defined(VK_KHR_synchronization2)
+	VILC_LAYER_HOOK(vilc_barrierCoalescing, vkCmdPipelineBarrier2KHR)
+#endif
+#if defined(VK_EXT_fragment_density_map_offset)
+	VILC_LAYER_HOOK(vilc_barrierCoalescing, vkCmdEndRendering2EXT)
+#endif
+#if defined(VK_KHR_maintenance10)
+	VILC_LAYER_HOOK(vilc_barrierCoalescing, vkCmdEndRendering2KHR)
+#endif
+}
+#endif /* VILC_BARRIER_COALESCING */
+
+#if defined(VOLK_IN_LOADERS_CLOTH) && defined(VILC_IMAGE_LAYOUT_TRACKING)
+/* Image layout tracking: the layouts of image subresources are tracked per command buffer from image barriers, render
+ * pass final layouts and executed secondary command buffers, and applied to the layouts of the images in submission
+ * order; vkTransitionImageLayout applies to those directly. Image barriers outside render pass instances that neither
+ * change the layout nor transfer queue family ownership are dropped, and the memory dependency they carry is kept as a
+ * memory barrier with the same masks, which covers every resource. Barriers whose oldLayout contradicts a layout known
+ * in the command buffer are recorded unchanged and counted. Transitions from VK_IMAGE_LAYOUT_UNDEFINED are always kept:
+ * after memory aliasing they are what reinitializes the image.
+ *
+ * Subresources are numbered aspect by aspect (color, depth, stencil), then mip level by mip level, then array layer, and
+ * layouts are kept as sorted runs of subresources, so a range over whole mip levels is one run however many layers the
+ * image has.
+ */
+#define VILC_IMAGE_LAYOUT_TRACKING_ASPECTS (VK_IMAGE_ASPECT_COLOR_BIT | VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT)
+#define VILC_IMAGE_LAYOUT_TRACKING_MIP_LEVELS 32
+/* a subresource range is one run per aspect and mip level at most */
+#define VILC_IMAGE_LAYOUT_TRACKING_RANGE_RUNS (3 * VILC_IMAGE_LAYOUT_TRACKING_MIP_LEVELS)
+/* layout of subresources that changed in a way that is not tracked */
+#define VILC_IMAGE_LAYOUT_TRACKING_UNKNOWN VK_IMAGE_LAYOUT_MAX_ENUM
+/* barrier commands and host transitions with more barriers than this are tracked, but recorded unchanged */
+#define VILC_IMAGE_LAYOUT_TRACKING_BARRIER_COUNT 32
+
+typedef struct VilcLayoutRun
+{
+	uint32_t begin;
+	uint32_t end;
+	VkImageLayout layout;
+} VilcLayoutRun;
+
+/* Disjoint runs sorted by subresource, with adjacent runs of the same layout merged */
+typedef struct VilcLayoutRuns
+{
+	VilcLayoutRun* runs;
+	uint32_t count;
+	uint32_t capacity;
+} VilcLayoutRuns;
+
+typedef struct VilcImageLayoutTrackingImage
+{
+	uint32_t mipLevels;
+	uint32_t arrayLayers;
+	/* layouts after the command buffers submitted so far and host transitions */
+	VilcLayoutRuns layouts;
+} VilcImageLayoutTrackingImage;
+
+typedef struct VilcImageLayoutTrackingView
+{
+	VkImage image;
+	VkImageSubresourceRange subresourceRange;
+} VilcImageLayoutTrackingView;
+
+/* Final layouts of a render pass, and of a framebuffer its attachments; both arrays follow the struct */
+typedef struct VilcImageLayoutTrackingRenderPass
+{
+	uint32_t attachmentCount;
+	VkImageLayout* finalLayouts;
+	VkImageLayout* stencilFinalLayouts;
+} VilcImageLayoutTrackingRenderPass;
+
+typedef struct VilcImageLayoutTrackingFramebuffer
+{
+	int imageless;
+	uint32_t attachmentCount;
+	VkImageView* attachments;
+} VilcImageLayoutTrackingFramebuffer;
+
+typedef struct VilcImageLayoutTrackingAttachment
+{
+	VkImage image;
+	VkImageSubresourceRange subresourceRange;
+	VkImageLayout finalLayout;
+	VkImageLayout stencilFinalLayout;
+} VilcImageLayoutTrackingAttachment;
+
+typedef struct VilcImageLayoutTrackingCommandBuffer
+{
+	VkCommandBuffer commandBuffer;
+	VkCommandPool commandPool;
+	int insideRenderPass;
+	/* all layouts may have changed before the ones below, e.g. in a render pass instance that is not tracked */
+	int forgetAll;
+	/* layouts set by the commands recorded so far, as VilcLayoutRuns by image; other images keep theirs */
+	VilcHandleMap images;
+	/* attachments the render pass instance being recorded leaves in their final layouts */
+	VilcImageLayoutTrackingAttachment* attachments;
+	uint32_t attachmentCount;
+	uint32_t attachmentCapacity;
+	int attachmentsUnknown;
+} VilcImageLayoutTrackingCommandBuffer;
+
+static pthread_mutex_t vilc_imageLayoutTracking_mutex = PTHREAD_MUTEX_INITIALIZER;
+static VilcHandleMap vilc_imageLayoutTracking_commandBuffers;
+static VilcHandleMap vilc_imageLayoutTracking_images;
+static VilcHandleMap vilc_imageLayoutTracking_views;
+static VilcHandleMap vilc_imageLayoutTracking_renderPasses;
+static VilcHandleMap vilc_imageLayoutTracking_framebuffers;
+static uint64_t vilc_imageLayoutTracking_imageBarriers = 0;
+static uint64_t vilc_imageLayoutTracking_droppedImageBarriers = 0;
+static uint64_t vilc_imageLayoutTracking_mismatchedImageBarriers = 0;
+static uint64_t vilc_imageLayoutTracking_hostTransitions = 0;
+static uint64_t vilc_imageLayoutTracking_droppedHostTransitions = 0;
+
+VILC_LAYER_NEXT(vilc_imageLayoutTracking, vkDestroyDevice)
+VILC_LAYER_NEXT(vilc_imageLayoutTracking, vkCreateImage)
+VILC_LAYER_NEXT(vilc_imageLayoutTracking, vkDestroyImage)
+VILC_LAYER_NEXT(vilc_imageLayoutTracking, vkCreateImageView)
+VILC_LAYER_NEXT(vilc_imageLayoutTracking, vkDestroyImageView)
+VILC_LAYER_NEXT(vilc_imageLayoutTracking, vkCreateRenderPass)
+VILC_LAYER_NEXT(vilc_imageLayoutTracking, vkDestroyRenderPass)
+VILC_LAYER_NEXT(vilc_imageLayoutTracking, vkCreateFramebuffer)
+VILC_LAYER_NEXT(vilc_imageLayoutTracking, vkDestroyFramebuffer)
+VILC_LAYER_NEXT(vilc_imageLayoutTracking, vkDestroyCommandPool)
+VILC_LAYER_NEXT(vilc_imageLayoutTracking, vkAllocateCommandBuffers)
+VILC_LAYER_NEXT(vilc_imageLayoutTracking, vkFreeCommandBuffers)
+VILC_LAYER_NEXT(vilc_imageLayoutTracking, vkBeginCommandBuffer)
+VILC_LAYER_NEXT(vilc_imageLayoutTracking, vkCmdPipelineBarrier)
+VILC_LAYER_NEXT(vilc_imageLayoutTracking, vkCmdWaitEvents)
+VILC_LAYER_NEXT(vilc_imageLayoutTracking, vkCmdBeginRenderPass)
+VILC_LAYER_NEXT(vilc_imageLayoutTracking, vkCmdEndRenderPass)
+VILC_LAYER_NEXT(vilc_imageLayoutTracking, vkCmdExecuteCommands)
+VILC_LAYER_NEXT(vilc_imageLayoutTracking, vkQueueSubmit)
+
+/* Index of the first run that ends after the subresource */
+static uint32_t vilc_layoutRuns_lowerBound(const VilcLayoutRuns* runs, uint32_t subresource)
+{
+	uint32_t low = 0, high = runs->count;
+
+	while (low < high)
+	{
+		uint32_t middle = low + (high - low) / 2;
+		if (runs->runs[middle].end <= subresource)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	return low;
+}
+
+/* Sets the layout of subresources [begin, end), or forgets it when keep is 0; returns 0 when out of memory, with the
+ * runs unchanged
+ */
+static int vilc_layoutRuns_set(VilcLayoutRuns* runs, uint32_t begin, uint32_t end, VkImageLayout layout, int keep)
+{
+	/* a run split on both sides and the neighbours it may merge with, around the new run */
+	VilcLayoutRun replacement[5];
+	uint32_t first = vilc_layoutRuns_lowerBound(runs, begin), last = first, count = 0, merged = 0, i;
+
+	while (last < runs->count && runs->runs[last].begin < end)
+		++last;
+	first -= first > 0 ? 1 : 0;
+	last += last < runs->count ? 1 : 0;
+
+	for (i = first; i < last; ++i)
+		if (runs->runs[i].begin < begin)
+		{
+			replacement[count] = runs->runs[i];
+			replacement[count].end = runs->runs[i].end < begin ? runs->runs[i].end : begin;
+			count++;
+		}
+	if (keep)
+	{
+		replacement[count].begin = begin;
+		replacement[count].end = end;
+		replacement[count].layout = layout;
+		count++;
+	}
+	for (i = first; i < last; ++i)
+		if (runs->runs[i].end > end)
+		{
+			replacement[count] = runs->runs[i];
+			replacement[count].begin = runs->runs[i].begin > end ? runs->runs[i].begin : end;
+			count++;
+		}
+
+	for (i = 0; i < count; ++i)
+	{
+		if (merged && replacement[merged - 1].end == replacement[i].begin && replacement[merged - 1].layout == replacement[i].layout)
+			replacement[merged - 1].end = replacement[i].end;
+		else
+			replacement[merged++] = replacement[i];
+	}
+
+	if (runs->count - (last - first) + merged > runs->capacity)
+	{
+		uint32_t capacity = runs->capacity ? runs->capacity * 2 : 4;
+		VilcLayoutRun* grown = (VilcLayoutRun*)realloc(runs->runs, capacity * sizeof(VilcLayoutRun));
+		if (!grown)
+			return 0;
+		runs->runs = grown;
+		runs->capacity = capacity;
+	}
+
+	memmove(&runs->runs[first + merged], &runs->runs[last], (runs->count - last) * sizeof(VilcLayoutRun));
+	memcpy(&runs->runs[first], replacement, merged * sizeof(VilcLayoutRun));
+	runs->count = runs->count - (last - first) + merged;
+	return 1;
+}
+
+/* Whether some of the subresources [begin, end) are known to be in another layout */
+static int vilc_layoutRuns_contradicts(const VilcLayoutRuns* runs, uint32_t begin, uint32_t end, VkImageLayout layout)
+{
+	uint32_t i;
+
+	for (i = vilc_layoutRuns_lowerBound(runs, begin); i < runs->count && runs->runs[i].begin < end; ++i)
+		if (runs->runs[i].layout != layout && runs->runs[i].layout != VILC_IMAGE_LAYOUT_TRACKING_UNKNOWN)
+			return 1;
+
+	return 0;
+}
+
+/* Splits a subresource range into runs of subresources; returns 0 when it is out of the image or has aspects that are not
+ * tracked, like planes, which alias the color aspect
+ */
+static uint32_t vilc_imageLayoutTracking_ranges(uint32_t mipLevels, uint32_t arrayLayers, const VkImageSubresourceRange* range, uint32_t* begins, uint32_t* ends)
+{
+	uint32_t levelCount, layerCount, count = 0, aspect, level;
+
+	if (!range->aspectMask || (range->aspectMask & ~VILC_IMAGE_LAYOUT_TRACKING_ASPECTS) || range->baseMipLevel >= mipLevels || range->baseArrayLayer >= arrayLayers)
+		return 0;
+
+	levelCount = range->levelCount == VK_REMAINING_MIP_LEVELS ? mipLevels - range->baseMipLevel : range->levelCount;
+	layerCount = range->layerCount == VK_REMAINING_ARRAY_LAYERS ? arrayLayers - range->baseArrayLayer : range->layerCount;
+	if (!levelCount || !layerCount || levelCount > mipLevels - range->baseMipLevel || layerCount > arrayLayers - range->baseArrayLayer)
+		return 0;
+
+	for (aspect = 0; aspect < 3; ++aspect)
+	{
+		uint32_t first = (aspect * mipLevels + range->baseMipLevel) * arrayLayers;
+
+		if (!(range->aspectMask & (VK_IMAGE_ASPECT_COLOR_BIT << aspect)))
+			continue;
+
+		/* whole mip levels are contiguous */
+		if (layerCount == arrayLayers)
+		{
+			begins[count] = first;
+			ends[count++] = first + levelCount * arrayLayers;
+			continue;
+		}
+		for (level = 0; level < levelCount; ++level)
+		{
+			begins[count] = first + level * arrayLayers + range->baseArrayLayer;
+			ends[count] = begins[count] + layerCount;
+			count++;
+		}
+	}
+
+	return count;
+}
+
+static VilcImageLayoutTrackingCommandBuffer* vilc_imageLayoutTracking_find(VkCommandBuffer commandBuffer)
+{
+	VilcImageLayoutTrackingCommandBuffer* state;
+
+	pthread_mutex_lock(&vilc_imageLayoutTracking_mutex);
+	state = (VilcImageLayoutTrackingCommandBuffer*)vilc_mapFind(&vilc_imageLayoutTracking_commandBuffers, VILC_DISPATCHABLE_KEY(commandBuffer));
+	pthread_mutex_unlock(&vilc_imageLayoutTracking_mutex);
+
+	return state;
+}
+
+/* Gets the dimensions of a tracked image; images created before the mode was installed, e.g. swapchain images, are not */
+static int vilc_imageLayoutTracking_image(VkImage image, uint32_t* mipLevels, uint32_t* arrayLayers)
+{
+	VilcImageLayoutTrackingImage* tracked;
+
+	pthread_mutex_lock(&vilc_imageLayoutTracking_mutex);
+	tracked = (VilcImageLayoutTrackingImage*)vilc_mapFind(&vilc_imageLayoutTracking_images, VILC_OBJECT_KEY(image));
+	if (tracked)
+	{
+		*mipLevels = tracked->mipLevels;
+		*arrayLayers = tracked->arrayLayers;
+	}
+	pthread_mutex_unlock(&vilc_imageLayoutTracking_mutex);
+
+	return tracked != NULL;
+}
+
+static void vilc_imageLayoutTracking_freeLayouts(VilcHandleMap* images)
+{
+	uint32_t i;
+
+	for (i = 0; i < images->capacity; ++i)
+		if (images->keys[i])
+		{
+			free(((VilcLayoutRuns*)images->values[i])->runs);
+			free(images->values[i]);
+		}
+	vilc_mapFree(images);
+}
+
+/* Forgets the layouts set in the command buffer, and that the ones before them are known */
+static void vilc_imageLayoutTracking_forget(VilcImageLayoutTrackingCommandBuffer* state)
+{
+	vilc_imageLayoutTracking_freeLayouts(&state->images);
+	state->forgetAll = 1;
+}
+
+static VilcLayoutRuns* vilc_imageLayoutTracking_layouts(VilcImageLayoutTrackingCommandBuffer* state, uint64_t image)
+{
+	VilcLayoutRuns* layouts = (VilcLayoutRuns*)vilc_mapFind(&state->images, image);
+
+	if (layouts)
+		return layouts;
+
+	layouts = (VilcLayoutRuns*)calloc(1, sizeof(VilcLayoutRuns));
+	if (layouts && !vilc_mapInsert(&state->images, image, layouts))
+	{
+		free(layouts);
+		layouts = NULL;
+	}
+	return layouts;
+}
+
+/* Sets the layout of a subresource range in the command buffer; returns whether oldLayout contradicts the layout the
+ * subresources were known to be in, which VK_IMAGE_LAYOUT_UNDEFINED never does
+ */
+static int vilc_imageLayoutTracking_transition(VilcImageLayoutTrackingCommandBuffer* state, VkImage image, const VkImageSubresourceRange* range, VkImageLayout oldLayout,
+    VkImageLayout newLayout)
+{
+	uint32_t begins[VILC_IMAGE_LAYOUT_TRACKING_RANGE_RUNS], ends[VILC_IMAGE_LAYOUT_TRACKING_RANGE_RUNS];
+	uint32_t mipLevels, arrayLayers, count, i;
+	VilcLayoutRuns* layouts;
+	int contradicts = 0, set = 1;
+
+	if (!vilc_imageLayoutTracking_image(image, &mipLevels, &arrayLayers))
+		return 0;
+
+	layouts = vilc_imageLayoutTracking_layouts(state, VILC_OBJECT_KEY(image));
+	if (!layouts)
+	{
+		vilc_imageLayoutTracking_forget(state);
+		return 0;
+	}
+
+	count = vilc_imageLayoutTracking_ranges(mipLevels, arrayLayers, range, begins, ends);
+	if (!count)
+		set = vilc_layoutRuns_set(layouts, 0, 3 * mipLevels * arrayLayers, VILC_IMAGE_LAYOUT_TRACKING_UNKNOWN, 1);
+	for (i = 0; i < count && oldLayout != VK_IMAGE_LAYOUT_UNDEFINED; ++i)
+		contradicts |= vilc_layoutRuns_contradicts(layouts, begins[i], ends[i], oldLayout);
+	for (i = 0; i < count && set; ++i)
+		set = vilc_layoutRuns_set(layouts, begins[i], ends[i], newLayout, 1);
+
+	if (!set)
+		vilc_imageLayoutTracking_forget(state);
+	return contradicts;
+}
+
+/* Tracks an image barrier recorded outside render pass instances, and returns whether it can be dropped */
+static int vilc_imageLayoutTracking_barrier(VilcImageLayoutTrackingCommandBuffer* state, VkImage image, const VkImageSubresourceRange* range, VkImageLayout oldLayout,
+    VkImageLayout newLayout, uint32_t srcQueueFamilyIndex, uint32_t dstQueueFamilyIndex, int chained)
+{
+	int contradicts = vilc_imageLayoutTracking_transition(state, image, range, oldLayout, newLayout);
+
+	VILC_ATOMIC_ADD(&vilc_imageLayoutTracking_imageBarriers, 1);
+	if (contradicts)
+		VILC_ATOMIC_ADD(&vilc_imageLayoutTracking_mismatchedImageBarriers, 1);
+
+	return oldLayout == newLayout && srcQueueFamilyIndex == dstQueueFamilyIndex && !chained && !contradicts;
+}
+
+/* Applies the layouts set by a command buffer to the ones known before it, submitted or in the primary command buffer
+ * executing it; unknown layouts carry over as such into command buffers, and are forgotten in images
+ */
+static int vilc_imageLayoutTracking_apply(VilcLayoutRuns* layouts, const VilcLayoutRuns* changes, int keepUnknown)
+{
+	uint32_t i;
+
+	for (i = 0; i < changes->count; ++i)
+	{
+		const VilcLayoutRun* run = &changes->runs[i];
+		if (!vilc_layoutRuns_set(layouts, run->begin, run->end, run->layout, keepUnknown || run->layout != VILC_IMAGE_LAYOUT_TRACKING_UNKNOWN))
+			return 0;
+	}
+
+	return 1;
+}
+
+/* Applies the layouts of a submitted command buffer to the images; callers hold the mutex */
+static void vilc_imageLayoutTracking_submit(VkCommandBuffer commandBuffer)
+{
+	VilcImageLayoutTrackingCommandBuffer* state = (VilcImageLayoutTrackingCommandBuffer*)vilc_mapFind(&vilc_imageLayoutTracking_commandBuffers, VILC_DISPATCHABLE_KEY(commandBuffer));
+	uint32_t i;
+
+	for (i = 0; i < vilc_imageLayoutTracking_images.capacity; ++i)
+		if (vilc_imageLayoutTracking_images.keys[i] && (!state || state->forgetAll))
+			((VilcImageLayoutTrackingImage*)vilc_imageLayoutTracking_images.values[i])->layouts.count = 0;
+	if (!state)
+		return;
+
+	for (i = 0; i < state->images.capacity; ++i)
+	{
+		VilcImageLayoutTrackingImage* image;
+
+		if (!state->images.keys[i])
+			continue;
+		/* destroyed images cannot be in submitted command buffers, but their handles can be reused */
+		image = (VilcImageLayoutTrackingImage*)vilc_mapFind(&vilc_imageLayoutTracking_images, state->images.keys[i]);
+		if (image && !vilc_imageLayoutTracking_apply(&image->layouts, (const VilcLayoutRuns*)state->images.values[i], 0))
+			image->layouts.count = 0;
+	}
+}
+
+void vilcGetImageLayoutTrackingStats(VilcImageLayoutTrackingStats* stats)
+{
+	stats->imageBarriers = VILC_ATOMIC_LOAD(&vilc_imageLayoutTracking_imageBarriers);
+	stats->droppedImageBarriers = VILC_ATOMIC_LOAD(&vilc_imageLayoutTracking_droppedImageBarriers);
+	stats->mismatchedImageBarriers = VILC_ATOMIC_LOAD(&vilc_imageLayoutTracking_mismatchedImageBarriers);
+	stats->hostTransitions = VILC_ATOMIC_LOAD(&vilc_imageLayoutTracking_hostTransitions);
+	stats->droppedHostTransitions = VILC_ATOMIC_LOAD(&vilc_imageLayoutTracking_droppedHostTransitions);
+}
+
+VkImageLayout vilcGetImageLayout(VkImage image, const VkImageSubresource* subresource)
+{
+	VilcImageLayoutTrackingImage* tracked;
+	VkImageLayout layout = VILC_IMAGE_LAYOUT_TRACKING_UNKNOWN;
+	VkImageSubresourceRange range;
+	uint32_t begin, end, i;
+
+	range.aspectMask = subresource->aspectMask;
+	range.baseMipLevel = subresource->mipLevel;
+	range.levelCount = 1;
+	range.baseArrayLayer = subresource->arrayLayer;
+	range.layerCount = 1;
+
+	pthread_mutex_lock(&vilc_imageLayoutTracking_mutex);
+	tracked = (VilcImageLayoutTrackingImage*)vilc_mapFind(&vilc_imageLayoutTracking_images, VILC_OBJECT_KEY(image));
+	if (tracked && vilc_imageLayoutTracking_ranges(tracked->mipLevels, tracked->arrayLayers, &range, &begin, &end) == 1)
+	{
+		i = vilc_layoutRuns_lowerBound(&tracked->layouts, begin);
+		if (i < tracked->layouts.count && tracked->layouts.runs[i].begin <= begin)
+			layout = tracked->layouts.runs[i].layout;
+	}
+	pthread_mutex_unlock(&vilc_imageLayoutTracking_mutex);
+
+	return layout;
+}
+
+static void vilc_imageLayoutTracking_freeCommandBuffer(VilcImageLayoutTrackingCommandBuffer* state)
+{
+	if (!state)
+		return;
+
+	vilc_imageLayoutTracking_freeLayouts(&state->images);
+	free(state->attachments);
+	free(state);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_imageLayoutTracking_vkDestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator)
+{
+	VilcImageLayoutTrackingStats stats;
+	uint32_t i;
+
+	pthread_mutex_lock(&vilc_imageLayoutTracking_mutex);
+	for (i = 0; i < vilc_imageLayoutTracking_commandBuffers.capacity; ++i)
+		if (vilc_imageLayoutTracking_commandBuffers.keys[i])
+			vilc_imageLayoutTracking_freeCommandBuffer((VilcImageLayoutTrackingCommandBuffer*)vilc_imageLayoutTracking_commandBuffers.values[i]);
+	for (i = 0; i < vilc_imageLayoutTracking_images.capacity; ++i)
+		if (vilc_imageLayoutTracking_images.keys[i])
+		{
+			free(((VilcImageLayoutTrackingImage*)vilc_imageLayoutTracking_images.values[i])->layouts.runs);
+			free(vilc_imageLayoutTracking_images.values[i]);
+		}
+	for (i = 0; i < vilc_imageLayoutTracking_views.capacity; ++i)
+		if (vilc_imageLayoutTracking_views.keys[i])
+			free(vilc_imageLayoutTracking_views.values[i]);
+	for (i = 0; i < vilc_imageLayoutTracking_renderPasses.capacity; ++i)
+		if (vilc_imageLayoutTracking_renderPasses.keys[i])
+			free(vilc_imageLayoutTracking_renderPasses.values[i]);
+	for (i = 0; i < vilc_imageLayoutTracking_framebuffers.capacity; ++i)
+		if (vilc_imageLayoutTracking_framebuffers.keys[i])
+			free(vilc_imageLayoutTracking_framebuffers.values[i]);
+	vilc_mapFree(&vilc_imageLayoutTracking_commandBuffers);
+	vilc_mapFree(&vilc_imageLayoutTracking_images);
+	vilc_mapFree(&vilc_imageLayoutTracking_views);
+	vilc_mapFree(&vilc_imageLayoutTracking_renderPasses);
+	vilc_mapFree(&vilc_imageLayoutTracking_framebuffers);
+	pthread_mutex_unlock(&vilc_imageLayoutTracking_mutex);
+
+	vilcGetImageLayoutTrackingStats(&stats);
+	fprintf(stderr, "vilc: image layout tracking: %llu of %llu image barriers dropped, %llu mismatched; %llu of %llu host transitions dropped\n",
+	    (unsigned long long)stats.droppedImageBarriers, (unsigned long long)stats.imageBarriers, (unsigned long long)stats.mismatchedImageBarriers,
+	    (unsigned long long)stats.droppedHostTransitions, (unsigned long long)stats.hostTransitions);
+
+	vilc_imageLayoutTracking_next_vkDestroyDevice(device, pAllocator);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_imageLayoutTracking_vkCreateImage(VkDevice device, const VkImageCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkImage* pImage)
+{
+	VkResult result = vilc_imageLayoutTracking_next_vkCreateImage(device, pCreateInfo, pAllocator, pImage);
+	VilcImageLayoutTrackingImage* image;
+
+	/* subresources are numbered in 32 bits */
+	if (result != VK_SUCCESS || pCreateInfo->mipLevels > VILC_IMAGE_LAYOUT_TRACKING_MIP_LEVELS || pCreateInfo->arrayLayers > UINT32_MAX / VILC_IMAGE_LAYOUT_TRACKING_RANGE_RUNS)
+		return result;
+
+	image = (VilcImageLayoutTrackingImage*)calloc(1, sizeof(VilcImageLayoutTrackingImage));
+	if (!image)
+		return result;
+	image->mipLevels = pCreateInfo->mipLevels;
+	image->arrayLayers = pCreateInfo->arrayLayers;
+	vilc_layoutRuns_set(&image->layouts, 0, 3 * image->mipLevels * image->arrayLayers, pCreateInfo->initialLayout, 1);
+
+	pthread_mutex_lock(&vilc_imageLayoutTracking_mutex);
+	if (!vilc_mapInsert(&vilc_imageLayoutTracking_images, VILC_OBJECT_KEY(*pImage), image))
+	{
+		free(image->layouts.runs);
+		free(image);
+	}
+	pthread_mutex_unlock(&vilc_imageLayoutTracking_mutex);
+
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_imageLayoutTracking_vkDestroyImage(VkDevice device, VkImage image, const VkAllocationCallbacks* pAllocator)
+{
+	VilcImageLayoutTrackingImage* tracked = NULL;
+
+	pthread_mutex_lock(&vilc_imageLayoutTracking_mutex);
+	if (image)
+		tracked = (VilcImageLayoutTrackingImage*)vilc_mapRemove(&vilc_imageLayoutTracking_images, VILC_OBJECT_KEY(image));
+	pthread_mutex_unlock(&vilc_imageLayoutTracking_mutex);
+
+	if (tracked)
+		free(tracked->layouts.runs);
+	free(tracked);
+
+	vilc_imageLayoutTracking_next_vkDestroyImage(device, image, pAllocator);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_imageLayoutTracking_vkCreateImageView(VkDevice device, const VkImageViewCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkImageView* pView)
+{
+	VkResult result = vilc_imageLayoutTracking_next_vkCreateImageView(device, pCreateInfo, pAllocator, pView);
+	VilcImageLayoutTrackingView* view;
+
+	if (result != VK_SUCCESS)
+		return result;
+
+	view = (VilcImageLayoutTrackingView*)malloc(sizeof(VilcImageLayoutTrackingView));
+	if (!view)
+		return result;
+	view->image = pCreateInfo->image;
+	view->subresourceRange = pCreateInfo->subresourceRange;
+
+	pthread_mutex_lock(&vilc_imageLayoutTracking_mutex);
+	if (!vilc_mapInsert(&vilc_imageLayoutTracking_views, VILC_OBJECT_KEY(*pView), view))
+		free(view);
+	pthread_mutex_unlock(&vilc_imageLayoutTracking_mutex);
+
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_imageLayoutTracking_vkDestroyImageView(VkDevice device, VkImageView imageView, const VkAllocationCallbacks* pAllocator)
+{
+	pthread_mutex_lock(&vilc_imageLayoutTracking_mutex);
+	if (imageView)
+		free(vilc_mapRemove(&vilc_imageLayoutTracking_views, VILC_OBJECT_KEY(imageView)));
+	pthread_mutex_unlock(&vilc_imageLayoutTracking_mutex);
+
+	vilc_imageLayoutTracking_next_vkDestroyImageView(device, imageView, pAllocator);
+}
+
+static VilcImageLayoutTrackingRenderPass* vilc_imageLayoutTracking_allocateRenderPass(uint32_t attachmentCount)
+{
+	VilcImageLayoutTrackingRenderPass* renderPass =
+	    (VilcImageLayoutTrackingRenderPass*)malloc(sizeof(VilcImageLayoutTrackingRenderPass) + 2 * attachmentCount * sizeof(VkImageLayout));
+
+	if (!renderPass)
+		return NULL;
+
+	renderPass->attachmentCount = attachmentCount;
+	renderPass->finalLayouts = (VkImageLayout*)(renderPass + 1);
+	renderPass->stencilFinalLayouts = renderPass->finalLayouts + attachmentCount;
+	return renderPass;
+}
+
+static void vilc_imageLayoutTracking_insertRenderPass(VkRenderPass handle, VilcImageLayoutTrackingRenderPass* renderPass)
+{
+	pthread_mutex_lock(&vilc_imageLayoutTracking_mutex);
+	if (!vilc_mapInsert(&vilc_imageLayoutTracking_renderPasses, VILC_OBJECT_KEY(handle), renderPass))
+		free(renderPass);
+	pthread_mutex_unlock(&vilc_imageLayoutTracking_mutex);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_imageLayoutTracking_vkCreateRenderPass(VkDevice device, const VkRenderPassCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkRenderPass* pRenderPass)
+{
+	VkResult result = vilc_imageLayoutTracking_next_vkCreateRenderPass(device, pCreateInfo, pAllocator, pRenderPass);
+	VilcImageLayoutTrackingRenderPass* renderPass;
+	uint32_t i;
+
+	if (result != VK_SUCCESS)
+		return result;
+
+	renderPass = vilc_imageLayoutTracking_allocateRenderPass(pCreateInfo->attachmentCount);
+	if (!renderPass)
+		return result;
+	for (i = 0; i < pCreateInfo->attachmentCount; ++i)
+		renderPass->finalLayouts[i] = renderPass->stencilFinalLayouts[i] = pCreateInfo->pAttachments[i].finalLayout;
+	vilc_imageLayoutTracking_insertRenderPass(*pRenderPass, renderPass);
+
+	return result;
+}
+
+#if defined(VK_VERSION_1_2) || defined(VK_KHR_create_renderpass2)
+static void vilc_imageLayoutTracking_createRenderPass2(const VkRenderPassCreateInfo2* pCreateInfo, VkRenderPass handle)
+{
+	VilcImageLayoutTrackingRenderPass* renderPass = vilc_imageLayoutTracking_allocateRenderPass(pCreateInfo->attachmentCount);
+	uint32_t i;
+
+	if (!renderPass)
+		return;
+
+	for (i = 0; i < pCreateInfo->attachmentCount; ++i)
+	{
+		const VkBaseInStructure* next;
+
+		renderPass->finalLayouts[i] = renderPass->stencilFinalLayouts[i] = pCreateInfo->pAttachments[i].finalLayout;
+#if defined(VK_VERSION_1_2) || defined(VK_KHR_separate_depth_stencil_layouts)
+		for (next = (const VkBaseInStructure*)pCreateInfo->pAttachments[i].pNext; next; next = next->pNext)
+			if (next->sType == VK_STRUCTURE_TYPE_ATTACHMENT_DESCRIPTION_STENCIL_LAYOUT)
+				renderPass->stencilFinalLayouts[i] = ((const VkAttachmentDescriptionStencilLayout*)next)->stencilFinalLayout;
+#else
+		(void)next;
+#endif
+	}
+	vilc_imageLayoutTracking_insertRenderPass(handle, renderPass);
+}
+#endif /* defined(VK_VERSION_1_2) || defined(VK_KHR_create_renderpass2) */
+
+static VKAPI_ATTR void VKAPI_CALL vilc_imageLayoutTracking_vkDestroyRenderPass(VkDevice device, VkRenderPass renderPass, const VkAllocationCallbacks* pAllocator)
+{
+	pthread_mutex_lock(&vilc_imageLayoutTracking_mutex);
+	if (renderPass)
+		free(vilc_mapRemove(&vilc_imageLayoutTracking_renderPasses, VILC_OBJECT_KEY(renderPass)));
+	pthread_mutex_unlock(&vilc_imageLayoutTracking_mutex);
+
+	vilc_imageLayoutTracking_next_vkDestroyRenderPass(device, renderPass, pAllocator);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_imageLayoutTracking_vkCreateFramebuffer(VkDevice device, const VkFramebufferCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkFramebuffer* pFramebuffer)
+{
+	VkResult result = vilc_imageLayoutTracking_next_vkCreateFramebuffer(device, pCreateInfo, pAllocator, pFramebuffer);
+	VilcImageLayoutTrackingFramebuffer* framebuffer;
+
+	if (result != VK_SUCCESS)
+		return result;
+
+	framebuffer = (VilcImageLayoutTrackingFramebuffer*)malloc(sizeof(VilcImageLayoutTrackingFramebuffer) + pCreateInfo->attachmentCount * sizeof(VkImageView));
+	if (!framebuffer)
+		return result;
+	framebuffer->imageless = 0;
+#if defined(VK_VERSION_1_2) || defined(VK_KHR_imageless_framebuffer)
+	framebuffer->imageless = (pCreateInfo->flags & VK_FRAMEBUFFER_CREATE_IMAGELESS_BIT) != 0;
+#endif
+	framebuffer->attachmentCount = pCreateInfo->attachmentCount;
+	framebuffer->attachments = (VkImageView*)(framebuffer + 1);
+	if (!framebuffer->imageless && pCreateInfo->attachmentCount)
+		memcpy(framebuffer->attachments, pCreateInfo->pAttachments, pCreateInfo->attachmentCount * sizeof(VkImageView));
+
+	pthread_mutex_lock(&vilc_imageLayoutTracking_mutex);
+	if (!vilc_mapInsert(&vilc_imageLayoutTracking_framebuffers, VILC_OBJECT_KEY(*pFramebuffer), framebuffer))
+		free(framebuffer);
+	pthread_mutex_unlock(&vilc_imageLayoutTracking_mutex);
+
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_imageLayoutTracking_vkDestroyFramebuffer(VkDevice device, VkFramebuffer framebuffer, const VkAllocationCallbacks* pAllocator)
+{
+	pthread_mutex_lock(&vilc_imageLayoutTracking_mutex);
+	if (framebuffer)
+		free(vilc_mapRemove(&vilc_imageLayoutTracking_framebuffers, VILC_OBJECT_KEY(framebuffer)));
+	pthread_mutex_unlock(&vilc_imageLayoutTracking_mutex);
+
+	vilc_imageLayoutTracking_next_vkDestroyFramebuffer(device, framebuffer, pAllocator);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_imageLayoutTracking_vkDestroyCommandPool(VkDevice device, VkCommandPool commandPool, const VkAllocationCallbacks* pAllocator)
+{
+	uint32_t i = 0;
+
+	pthread_mutex_lock(&vilc_imageLayoutTracking_mutex);
+	/* removal shifts later entries back into the scanned slot, so it is scanned again */
+	while (commandPool && i < vilc_imageLayoutTracking_commandBuffers.capacity)
+	{
+		VilcImageLayoutTrackingCommandBuffer* state = (VilcImageLayoutTrackingCommandBuffer*)vilc_imageLayoutTracking_commandBuffers.values[i];
+		if (vilc_imageLayoutTracking_commandBuffers.keys[i] && state->commandPool == commandPool)
+			vilc_imageLayoutTracking_freeCommandBuffer((VilcImageLayoutTrackingCommandBuffer*)vilc_mapRemove(&vilc_imageLayoutTracking_commandBuffers, vilc_imageLayoutTracking_commandBuffers.keys[i]));
+		else
+			++i;
+	}
+	pthread_mutex_unlock(&vilc_imageLayoutTracking_mutex);
+
+	vilc_imageLayoutTracking_next_vkDestroyCommandPool(device, commandPool, pAllocator);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_imageLayoutTracking_vkAllocateCommandBuffers(VkDevice device, const VkCommandBufferAllocateInfo* pAllocateInfo, VkCommandBuffer* pCommandBuffers)
+{
+	VkResult result = vilc_imageLayoutTracking_next_vkAllocateCommandBuffers(device, pAllocateInfo, pCommandBuffers);
+	uint32_t i;
+
+	if (result != VK_SUCCESS)
+		return result;
+
+	pthread_mutex_lock(&vilc_imageLayoutTracking_mutex);
+	for (i = 0; i < pAllocateInfo->commandBufferCount; ++i)
+	{
+		VilcImageLayoutTrackingCommandBuffer* state = (VilcImageLayoutTrackingCommandBuffer*)calloc(1, sizeof(VilcImageLayoutTrackingCommandBuffer));
+		if (!state)
+			break;
+		state->commandBuffer = pCommandBuffers[i];
+		state->commandPool = pAllocateInfo->commandPool;
+		if (!vilc_mapInsert(&vilc_imageLayoutTracking_commandBuffers, VILC_DISPATCHABLE_KEY(pCommandBuffers[i]), state))
+			free(state);
+	}
+	pthread_mutex_unlock(&vilc_imageLayoutTracking_mutex);
+
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_imageLayoutTracking_vkFreeCommandBuffers(VkDevice device, VkCommandPool commandPool, uint32_t commandBufferCount, const VkCommandBuffer* pCommandBuffers)
+{
+	uint32_t i;
+
+	pthread_mutex_lock(&vilc_imageLayoutTracking_mutex);
+	for (i = 0; i < commandBufferCount; ++i)
+		if (pCommandBuffers[i])
+			vilc_imageLayoutTracking_freeCommandBuffer((VilcImageLayoutTrackingCommandBuffer*)vilc_mapRemove(&vilc_imageLayoutTracking_commandBuffers, VILC_DISPATCHABLE_KEY(pCommandBuffers[i])));
+	pthread_mutex_unlock(&vilc_imageLayoutTracking_mutex);
+
+	vilc_imageLayoutTracking_next_vkFreeCommandBuffers(device, commandPool, commandBufferCount, pCommandBuffers);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_imageLayoutTracking_vkBeginCommandBuffer(VkCommandBuffer commandBuffer, const VkCommandBufferBeginInfo* pBeginInfo)
+{
+	VilcImageLayoutTrackingCommandBuffer* state = vilc_imageLayoutTracking_find(commandBuffer);
+
+	/* secondary command buffers that continue a render pass are inside it from the start (the flag is ignored for
+	 * primary ones, whose barriers are then just not dropped)
+	 */
+	if (state)
+	{
+		vilc_imageLayoutTracking_freeLayouts(&state->images);
+		state->forgetAll = 0;
+		state->insideRenderPass = (pBeginInfo->flags & VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT) != 0;
+	}
+	return vilc_imageLayoutTracking_next_vkBeginCommandBuffer(commandBuffer, pBeginInfo);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_imageLayoutTracking_vkCmdPipelineBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask,
+    VkDependencyFlags dependencyFlags, uint32_t memoryBarrierCount, const VkMemoryBarrier* pMemoryBarriers, uint32_t bufferMemoryBarrierCount,
+    const VkBufferMemoryBarrier* pBufferMemoryBarriers, uint32_t imageMemoryBarrierCount, const VkImageMemoryBarrier* pImageMemoryBarriers)
+{
+	VilcImageLayoutTrackingCommandBuffer* state = vilc_imageLayoutTracking_find(commandBuffer);
+	VkMemoryBarrier memoryBarriers[VILC_IMAGE_LAYOUT_TRACKING_BARRIER_COUNT + 1];
+	VkImageMemoryBarrier imageBarriers[VILC_IMAGE_LAYOUT_TRACKING_BARRIER_COUNT];
+	VkAccessFlags srcAccessMask = 0, dstAccessMask = 0;
+	uint32_t imageCount = 0, dropped = 0, i;
+	int rewrite = memoryBarrierCount <= VILC_IMAGE_LAYOUT_TRACKING_BARRIER_COUNT && imageMemoryBarrierCount <= VILC_IMAGE_LAYOUT_TRACKING_BARRIER_COUNT;
+
+	if (!state || state->insideRenderPass)
+	{
+		vilc_imageLayoutTracking_next_vkCmdPipelineBarrier(commandBuffer, srcStageMask, dstStageMask, dependencyFlags, memoryBarrierCount, pMemoryBarriers,
+		    bufferMemoryBarrierCount, pBufferMemoryBarriers, imageMemoryBarrierCount, pImageMemoryBarriers);
+		return;
+	}
+
+	/* the stage masks of the call apply to all barriers, so the dropped ones only leave their access masks */
+	for (i = 0; i < imageMemoryBarrierCount; ++i)
+	{
+		const VkImageMemoryBarrier* barrier = &pImageMemoryBarriers[i];
+
+		if (vilc_imageLayoutTracking_barrier(state, barrier->image, &barrier->subresourceRange, barrier->oldLayout, barrier->newLayout, barrier->srcQueueFamilyIndex,
+		        barrier->dstQueueFamilyIndex, barrier->pNext != NULL) &&
+		    rewrite)
+		{
+			srcAccessMask |= barrier->srcAccessMask;
+			dstAccessMask |= barrier->dstAccessMask;
+			dropped++;
+		}
+		else if (rewrite)
+		{
+			imageBarriers[imageCount++] = *barrier;
+		}
+	}
+
+	if (!dropped)
+	{
+		vilc_imageLayoutTracking_next_vkCmdPipelineBarrier(commandBuffer, srcStageMask, dstStageMask, dependencyFlags, memoryBarrierCount, pMemoryBarriers,
+		    bufferMemoryBarrierCount, pBufferMemoryBarriers, imageMemoryBarrierCount, pImageMemoryBarriers);
+		return;
+	}
+
+	VILC_ATOMIC_ADD(&vilc_imageLayoutTracking_droppedImageBarriers, dropped);
+	if (memoryBarrierCount)
+		memcpy(memoryBarriers, pMemoryBarriers, memoryBarrierCount * sizeof(VkMemoryBarrier));
+	if (srcAccessMask || dstAccessMask)
+	{
+		memset(&memoryBarriers[memoryBarrierCount], 0, sizeof(VkMemoryBarrier));
+		memoryBarriers[memoryBarrierCount].sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		memoryBarriers[memoryBarrierCount].srcAccessMask = srcAccessMask;
+		memoryBarriers[memoryBarrierCount].dstAccessMask = dstAccessMask;
+		memoryBarrierCount++;
+	}
+	vilc_imageLayoutTracking_next_vkCmdPipelineBarrier(commandBuffer, srcStageMask, dstStageMask, dependencyFlags, memoryBarrierCount, memoryBarriers,
+	    bufferMemoryBarrierCount, pBufferMemoryBarriers, imageCount, imageBarriers);
+}
+
+#if defined(VK_VERSION_1_3) || defined(VK_KHR_synchronization2)
+/* Tracks the image barriers of a dependency; when some can be dropped, fills in a copy of it with those replaced by
+ * memory barriers with their masks, and returns 1
+ */
+static int vilc_imageLayoutTracking_dependency(VilcImageLayoutTrackingCommandBuffer* state, const VkDependencyInfo* pDependencyInfo, VkDependencyInfo* dependencyInfo,
+    VkMemoryBarrier2* memoryBarriers, VkImageMemoryBarrier2* imageBarriers)
+{
+	uint32_t memoryCount = pDependencyInfo->memoryBarrierCount, imageCount = 0, dropped = 0, i, j;
+	int rewrite = pDependencyInfo->memoryBarrierCount <= VILC_IMAGE_LAYOUT_TRACKING_BARRIER_COUNT &&
+	    pDependencyInfo->imageMemoryBarrierCount <= VILC_IMAGE_LAYOUT_TRACKING_BARRIER_COUNT;
+
+	if (rewrite && memoryCount)
+		memcpy(memoryBarriers, pDependencyInfo->pMemoryBarriers, memoryCount * sizeof(VkMemoryBarrier2));
+
+	for (i = 0; i < pDependencyInfo->imageMemoryBarrierCount; ++i)
+	{
+		const VkImageMemoryBarrier2* barrier = &pDependencyInfo->pImageMemoryBarriers[i];
+
+		if (!vilc_imageLayoutTracking_barrier(state, barrier->image, &barrier->subresourceRange, barrier->oldLayout, barrier->newLayout, barrier->srcQueueFamilyIndex,
+		        barrier->dstQueueFamilyIndex, barrier->pNext != NULL) ||
+		    !rewrite)
+		{
+			if (rewrite)
+				imageBarriers[imageCount++] = *barrier;
+			continue;
+		}
+
+		/* defensive transitions of many images tend to share their masks */
+		dropped++;
+		for (j = pDependencyInfo->memoryBarrierCount; j < memoryCount; ++j)
+			if (memoryBarriers[j].srcStageMask == barrier->srcStageMask && memoryBarriers[j].srcAccessMask == barrier->srcAccessMask &&
+			    memoryBarriers[j].dstStageMask == barrier->dstStageMask && memoryBarriers[j].dstAccessMask == barrier->dstAccessMask)
+				break;
+		if (j < memoryCount)
+			continue;
+		memset(&memoryBarriers[memoryCount], 0, sizeof(VkMemoryBarrier2));
+		memoryBarriers[memoryCount].sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+		memoryBarriers[memoryCount].srcStageMask = barrier->srcStageMask;
+		memoryBarriers[memoryCount].srcAccessMask = barrier->srcAccessMask;
+		memoryBarriers[memoryCount].dstStageMask = barrier->dstStageMask;
+		memoryBarriers[memoryCount].dstAccessMask = barrier->dstAccessMask;
+		memoryCount++;
+	}
+
+	if (!dropped)
+		return 0;
+
+	VILC_ATOMIC_ADD(&vilc_imageLayoutTracking_droppedImageBarriers, dropped);
+	*dependencyInfo = *pDependencyInfo;
+	dependencyInfo->memoryBarrierCount = memoryCount;
+	dependencyInfo->pMemoryBarriers = memoryBarriers;
+	dependencyInfo->imageMemoryBarrierCount = imageCount;
+	dependencyInfo->pImageMemoryBarriers = imageBarriers;
+	return 1;
+}
+
+/* Barriers of vkCmdWaitEvents2 are only tracked */
+static void vilc_imageLayoutTracking_waitEvents2(VkCommandBuffer commandBuffer, uint32_t eventCount, const VkDependencyInfo* pDependencyInfos)
+{
+	VilcImageLayoutTrackingCommandBuffer* state = vilc_imageLayoutTracking_find(commandBuffer);
+	uint32_t i, j;
+
+	for (i = 0; state && !state->insideRenderPass && i < eventCount; ++i)
+		for (j = 0; j < pDependencyInfos[i].imageMemoryBarrierCount; ++j)
+		{
+			const VkImageMemoryBarrier2* barrier = &pDependencyInfos[i].pImageMemoryBarriers[j];
+			vilc_imageLayoutTracking_transition(state, barrier->image, &barrier->subresourceRange, barrier->oldLayout, barrier->newLayout);
+		}
+}
+#endif /* defined(VK_VERSION_1_3) || defined(VK_KHR_synchronization2) */
+
+#if defined(VK_VERSION_1_3)
+VILC_LAYER_NEXT(vilc_imageLayoutTracking, vkCmdPipelineBarrier2)
+VILC_LAYER_NEXT(vilc_imageLayoutTracking, vkCmdWaitEvents2)
+
+static VKAPI_ATTR void VKAPI_CALL vilc_imageLayoutTracking_vkCmdPipelineBarrier2(VkCommandBuffer commandBuffer, const VkDependencyInfo* pDependencyInfo)
+{
+	VilcImageLayoutTrackingCommandBuffer* state = vilc_imageLayoutTracking_find(commandBuffer);
+	VkMemoryBarrier2 memoryBarriers[2 * VILC_IMAGE_LAYOUT_TRACKING_BARRIER_COUNT];
+	VkImageMemoryBarrier2 imageBarriers[VILC_IMAGE_LAYOUT_TRACKING_BARRIER_COUNT];
+	VkDependencyInfo dependencyInfo;
+
+	if (state && !state->insideRenderPass && vilc_imageLayoutTracking_dependency(state, pDependencyInfo, &dependencyInfo, memoryBarriers, imageBarriers))
+		pDependencyInfo = &dependencyInfo;
+	vilc_imageLayoutTracking_next_vkCmdPipelineBarrier2(commandBuffer, pDependencyInfo);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_imageLayoutTracking_vkCmdWaitEvents2(VkCommandBuffer commandBuffer, uint32_t eventCount, const VkEvent* pEvents, const VkDependencyInfo* pDependencyInfos)
+{
+	vilc_imageLayoutTracking_waitEvents2(commandBuffer, eventCount, pDependencyInfos);
+	vilc_imageLayoutTracking_next_vkCmdWaitEvents2(commandBuffer, eventCount, pEvents, pDependencyInfos);
+}
+#endif /* defined(VK_VERSION_1_3) */
+
+#if defined(VK_KHR_synchronization2)
+VILC_LAYER_NEXT(vilc_imageLayoutTracking, vkCmdPipelineBarrier2KHR)
+VILC_LAYER_NEXT(vilc_imageLayoutTracking, vkCmdWaitEvents2KHR)
+
+static VKAPI_ATTR void VKAPI_CALL vilc_imageLayoutTracking_vkCmdPipelineBarrier2KHR(VkCommandBuffer commandBuffer, const VkDependencyInfo* pDependencyInfo)
+{
+	VilcImageLayoutTrackingCommandBuffer* state = vilc_imageLayoutTracking_find(commandBuffer);
+	VkMemoryBarrier2 memoryBarriers[2 * VILC_IMAGE_LAYOUT_TRACKING_BARRIER_COUNT];
+	VkImageMemoryBarrier2 imageBarriers[VILC_IMAGE_LAYOUT_TRACKING_BARRIER_COUNT];
+	VkDependencyInfo dependencyInfo;
+
+	if (state && !state->insideRenderPass && vilc_imageLayoutTracking_dependency(state, pDependencyInfo, &dependencyInfo, memoryBarriers, imageBarriers))
+		pDependencyInfo = &dependencyInfo;
+	vilc_imageLayoutTracking_next_vkCmdPipelineBarrier2KHR(commandBuffer, pDependencyInfo);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_imageLayoutTracking_vkCmdWaitEvents2KHR(VkCommandBuffer commandBuffer, uint32_t eventCount, const VkEvent* pEvents, const VkDependencyInfo* pDependencyInfos)
+{
+	vilc_imageLayoutTracking_waitEvents2(commandBuffer, eventCount, pDependencyInfos);
+	vilc_imageLayoutTracking_next_vkCmdWaitEvents2KHR(commandBuffer, eventCount, pEvents, pDependencyInfos);
+}
+#endif /* defined(VK_KHR_synchronization2) */
+
+static VKAPI_ATTR void VKAPI_CALL vilc_imageLayoutTracking_vkCmdWaitEvents(VkCommandBuffer commandBuffer, uint32_t eventCount, const VkEvent* pEvents, VkPipelineStageFlags srcStageMask,
+    VkPipelineStageFlags dstStageMask, uint32_t memoryBarrierCount, const VkMemoryBarrier* pMemoryBarriers, uint32_t bufferMemoryBarrierCount,
+    const VkBufferMemoryBarrier* pBufferMemoryBarriers, uint32_t imageMemoryBarrierCount, const VkImageMemoryBarrier* pImageMemoryBarriers)
+{
+	VilcImageLayoutTrackingCommandBuffer* state = vilc_imageLayoutTracking_find(commandBuffer);
+	uint32_t i;
+
+	for (i = 0; state && !state->insideRenderPass && i < imageMemoryBarrierCount; ++i)
+		vilc_imageLayoutTracking_transition(state, pImageMemoryBarriers[i].image, &pImageMemoryBarriers[i].subresourceRange, pImageMemoryBarriers[i].oldLayout,
+		    pImageMemoryBarriers[i].newLayout);
+	vilc_imageLayoutTracking_next_vkCmdWaitEvents(commandBuffer, eventCount, pEvents, srcStageMask, dstStageMask, memoryBarrierCount, pMemoryBarriers,
+	    bufferMemoryBarrierCount, pBufferMemoryBarriers, imageMemoryBarrierCount, pImageMemoryBarriers);
+}
+
+/* Looks up the attachments of a render pass instance and their final layouts; the layouts of all images are forgotten at
+ * its end when one of them is not known, which takes render passes and framebuffers created before the mode
+ */
+static void vilc_imageLayoutTracking_beginRenderPass(VkCommandBuffer commandBuffer, const VkRenderPassBeginInfo* pRenderPassBegin)
+{
+	VilcImageLayoutTrackingCommandBuffer* state = vilc_imageLayoutTracking_find(commandBuffer);
+	const VilcImageLayoutTrackingRenderPass* renderPass;
+	const VilcImageLayoutTrackingFramebuffer* framebuffer;
+	const VkImageView* attachments;
+	uint32_t i;
+
+	if (!state)
+		return;
+
+	state->insideRenderPass = 1;
+	state->attachmentCount = 0;
+
+	pthread_mutex_lock(&vilc_imageLayoutTracking_mutex);
+	renderPass = (const VilcImageLayoutTrackingRenderPass*)vilc_mapFind(&vilc_imageLayoutTracking_renderPasses, VILC_OBJECT_KEY(pRenderPassBegin->renderPass));
+	framebuffer = (const VilcImageLayoutTrackingFramebuffer*)vilc_mapFind(&vilc_imageLayoutTracking_framebuffers, VILC_OBJECT_KEY(pRenderPassBegin->framebuffer));
+	attachments = framebuffer ? framebuffer->attachments : NULL;
+#if defined(VK_VERSION_1_2) || defined(VK_KHR_imageless_framebuffer)
+	if (framebuffer && framebuffer->imageless)
+	{
+		const VkBaseInStructure* next;
+
+		attachments = NULL;
+		for (next = (const VkBaseInStructure*)pRenderPassBegin->pNext; next; next = next->pNext)
+			if (next->sType == VK_STRUCTURE_TYPE_RENDER_PASS_ATTACHMENT_BEGIN_INFO)
+				attachments = ((const VkRenderPassAttachmentBeginInfo*)next)->pAttachments;
+	}
+#endif
+	state->attachmentsUnknown = !renderPass || !attachments || renderPass->attachmentCount != framebuffer->attachmentCount;
+
+	if (!state->attachmentsUnknown && renderPass->attachmentCount > state->attachmentCapacity)
+	{
+		VilcImageLayoutTrackingAttachment* grown =
+		    (VilcImageLayoutTrackingAttachment*)realloc(state->attachments, renderPass->attachmentCount * sizeof(VilcImageLayoutTrackingAttachment));
+		if (grown)
+		{
+			state->attachments = grown;
+			state->attachmentCapacity = renderPass->attachmentCount;
+		}
+		else
+		{
+			state->attachmentsUnknown = 1;
+		}
+	}
+
+	for (i = 0; !state->attachmentsUnknown && i < renderPass->attachmentCount; ++i)
+	{
+		const VilcImageLayoutTrackingView* view = (const VilcImageLayoutTrackingView*)vilc_mapFind(&vilc_imageLayoutTracking_views, VILC_OBJECT_KEY(attachments[i]));
+		VilcImageLayoutTrackingAttachment* attachment = &state->attachments[state->attachmentCount++];
+
+		if (!view)
+		{
+			state->attachmentsUnknown = 1;
+			break;
+		}
+		attachment->image = view->image;
+		attachment->subresourceRange = view->subresourceRange;
+		attachment->finalLayout = renderPass->finalLayouts[i];
+		attachment->stencilFinalLayout = renderPass->stencilFinalLayouts[i];
+	}
+	pthread_mutex_unlock(&vilc_imageLayoutTracking_mutex);
+}
+
+static void vilc_imageLayoutTracking_endRenderPass(VkCommandBuffer commandBuffer)
+{
+	VilcImageLayoutTrackingCommandBuffer* state = vilc_imageLayoutTracking_find(commandBuffer);
+	uint32_t i;
+
+	if (!state)
+		return;
+
+	state->insideRenderPass = 0;
+	if (state->attachmentsUnknown)
+	{
+		vilc_imageLayoutTracking_forget(state);
+		return;
+	}
+
+	for (i = 0; i < state->attachmentCount; ++i)
+	{
+		const VilcImageLayoutTrackingAttachment* attachment = &state->attachments[i];
+		VkImageSubresourceRange range = attachment->subresourceRange;
+
+		if (attachment->stencilFinalLayout != attachment->finalLayout && (range.aspectMask & VK_IMAGE_ASPECT_STENCIL_BIT))
+		{
+			range.aspectMask = VK_IMAGE_ASPECT_STENCIL_BIT;
+			vilc_imageLayoutTracking_transition(state, attachment->image, &range, VK_IMAGE_LAYOUT_UNDEFINED, attachment->stencilFinalLayout);
+			range.aspectMask = attachment->subresourceRange.aspectMask & ~VK_IMAGE_ASPECT_STENCIL_BIT;
+			if (!range.aspectMask)
+				continue;
+		}
+		vilc_imageLayoutTracking_transition(state, attachment->image, &range, VK_IMAGE_LAYOUT_UNDEFINED, attachment->finalLayout);
+	}
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_imageLayoutTracking_vkCmdBeginRenderPass(VkCommandBuffer commandBuffer, const VkRenderPassBeginInfo* pRenderPassBegin, VkSubpassContents contents)
+{
+	vilc_imageLayoutTracking_beginRenderPass(commandBuffer, pRenderPassBegin);
+	vilc_imageLayoutTracking_next_vkCmdBeginRenderPass(commandBuffer, pRenderPassBegin, contents);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_imageLayoutTracking_vkCmdEndRenderPass(VkCommandBuffer commandBuffer)
+{
+	vilc_imageLayoutTracking_next_vkCmdEndRenderPass(commandBuffer);
+	vilc_imageLayoutTracking_endRenderPass(commandBuffer);
+}
+
+#if defined(VK_VERSION_1_2)
+VILC_LAYER_NEXT(vilc_imageLayoutTracking, vkCreateRenderPass2)
+VILC_LAYER_NEXT(vilc_imageLayoutTracking, vkCmdBeginRenderPass2)
+VILC_LAYER_NEXT(vilc_imageLayoutTracking, vkCmdEndRenderPass2)
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_imageLayoutTracking_vkCreateRenderPass2(VkDevice device, const VkRenderPassCreateInfo2* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkRenderPass* pRenderPass)
+{
+	VkResult result = vilc_imageLayoutTracking_next_vkCreateRenderPass2(device, pCreateInfo, pAllocator, pRenderPass);
+	if (result == VK_SUCCESS)
+		vilc_imageLayoutTracking_createRenderPass2(pCreateInfo, *pRenderPass);
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_imageLayoutTracking_vkCmdBeginRenderPass2(VkCommandBuffer commandBuffer, const VkRenderPassBeginInfo* pRenderPassBegin, const VkSubpassBeginInfo* pSubpassBeginInfo)
+{
+	vilc_imageLayoutTracking_beginRenderPass(commandBuffer, pRenderPassBegin);
+	vilc_imageLayoutTracking_next_vkCmdBeginRenderPass2(commandBuffer, pRenderPassBegin, pSubpassBeginInfo);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_imageLayoutTracking_vkCmdEndRenderPass2(VkCommandBuffer commandBuffer, const VkSubpassEndInfo* pSubpassEndInfo)
+{
+	vilc_imageLayoutTracking_next_vkCmdEndRenderPass2(commandBuffer, pSubpassEndInfo);
+	vilc_imageLayoutTracking_endRenderPass(commandBuffer);
+}
+#endif /* defined(VK_VERSION_1_2) */
+
+#if defined(VK_KHR_create_renderpass2)
+VILC_LAYER_NEXT(vilc_imageLayoutTracking, vkCreateRenderPass2KHR)
+VILC_LAYER_NEXT(vilc_imageLayoutTracking, vkCmdBeginRenderPass2KHR)
+VILC_LAYER_NEXT(vilc_imageLayoutTracking, vkCmdEndRenderPass2KHR)
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_imageLayoutTracking_vkCreateRenderPass2KHR(VkDevice device, const VkRenderPassCreateInfo2* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkRenderPass* pRenderPass)
+{
+	VkResult result = vilc_imageLayoutTracking_next_vkCreateRenderPass2KHR(device, pCreateInfo, pAllocator, pRenderPass);
+	if (result == VK_SUCCESS)
+		vilc_imageLayoutTracking_createRenderPass2(pCreateInfo, *pRenderPass);
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_imageLayoutTracking_vkCmdBeginRenderPass2KHR(VkCommandBuffer commandBuffer, const VkRenderPassBeginInfo* pRenderPassBegin, const VkSubpassBeginInfo* pSubpassBeginInfo)
+{
+	vilc_imageLayoutTracking_beginRenderPass(commandBuffer, pRenderPassBegin);
+	vilc_imageLayoutTracking_next_vkCmdBeginRenderPass2KHR(commandBuffer, pRenderPassBegin, pSubpassBeginInfo);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_imageLayoutTracking_vkCmdEndRenderPass2KHR(VkCommandBuffer commandBuffer, const VkSubpassEndInfo* pSubpassEndInfo)
+{
+	vilc_imageLayoutTracking_next_vkCmdEndRenderPass2KHR(commandBuffer, pSubpassEndInfo);
+	vilc_imageLayoutTracking_endRenderPass(commandBuffer);
+}
+#endif /* defined(VK_KHR_create_renderpass2) */
+
+/* Dynamic rendering does not change layouts; barriers inside it are only recorded unchanged */
+#define VILC_IMAGE_LAYOUT_TRACKING_RENDERING(name, inside, params, args) \
+	VILC_LAYER_NEXT(vilc_imageLayoutTracking, name) \
+	static VKAPI_ATTR void VKAPI_CALL vilc_imageLayoutTracking_##name params \
+	{ \
+		VilcImageLayoutTrackingCommandBuffer* state = vilc_imageLayoutTracking_find(commandBuffer); \
+		if (state) \
+			state->insideRenderPass = inside; \
+		vilc_imageLayoutTracking_next_##name args; \
+	}
+
+#if defined(VK_VERSION_1_3)
+VILC_IMAGE_LAYOUT_TRACKING_RENDERING(vkCmdBeginRendering, 1, (VkCommandBuffer commandBuffer, const VkRenderingInfo* pRenderingInfo), (commandBuffer, pRenderingInfo))
+VILC_IMAGE_LAYOUT_TRACKING_RENDERING(vkCmdEndRendering, 0, (VkCommandBuffer commandBuffer), (commandBuffer))
+#endif /* defined(VK_VERSION_1_3) */
+
+#if defined(VK_KHR_dynamic_rendering)
+VILC_IMAGE_LAYOUT_TRACKING_RENDERING(vkCmdBeginRenderingKHR, 1, (VkCommandBuffer commandBuffer, const VkRenderingInfo* pRenderingInfo), (commandBuffer, pRenderingInfo))
+VILC_IMAGE_LAYOUT_TRACKING_RENDERING(vkCmdEndRenderingKHR, 0, (VkCommandBuffer commandBuffer), (commandBuffer))
+#endif /* defined(VK_KHR_dynamic_rendering) */
+
+#if defined(VK_EXT_fragment_density_map_offset)
+VILC_IMAGE_LAYOUT_TRACKING_RENDERING(vkCmdEndRendering2EXT, 0, (VkCommandBuffer commandBuffer, const VkRenderingEndInfoKHR* pRenderingEndInfo), (commandBuffer, pRenderingEndInfo))
+#endif /* defined(VK_EXT_fragment_density_map_offset) */
+
+#if defined(VK_KHR_maintenance10)
+VILC_IMAGE_LAYOUT_TRACKING_RENDERING(vkCmdEndRendering2KHR, 0, (VkCommandBuffer commandBuffer, const VkRenderingEndInfoKHR* pRenderingEndInfo), (commandBuffer, pRenderingEndInfo))
+#endif /* defined(VK_KHR_maintenance10) */
+
+/* Secondary command buffers are executable by now, so their layouts apply on top of the ones set before them */
+static VKAPI_ATTR void VKAPI_CALL vilc_imageLayoutTracking_vkCmdExecuteCommands(VkCommandBuffer commandBuffer, uint32_t commandBufferCount, const VkCommandBuffer* pCommandBuffers)
+{
+	VilcImageLayoutTrackingCommandBuffer* state = vilc_imageLayoutTracking_find(commandBuffer);
+	uint32_t i, j;
+
+	for (i = 0; state && i < commandBufferCount; ++i)
+	{
+		const VilcImageLayoutTrackingCommandBuffer* secondary = vilc_imageLayoutTracking_find(pCommandBuffers[i]);
+
+		if (!secondary || secondary->forgetAll)
+			vilc_imageLayoutTracking_forget(state);
+		for (j = 0; secondary && j < secondary->images.capacity; ++j)
+		{
+			VilcLayoutRuns* layouts;
+
+			if (!secondary->images.keys[j])
+				continue;
+			layouts = vilc_imageLayoutTracking_layouts(state, secondary->images.keys[j]);
+			if (!layouts || !vilc_imageLayoutTracking_apply(layouts, (const VilcLayoutRuns*)secondary->images.values[j], 1))
+			{
+				vilc_imageLayoutTracking_forget(state);
+				break;
+			}
+		}
+	}
+
+	vilc_imageLayoutTracking_next_vkCmdExecuteCommands(commandBuffer, commandBufferCount, pCommandBuffers);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_imageLayoutTracking_vkQueueSubmit(VkQueue queue, uint32_t submitCount, const VkSubmitInfo* pSubmits, VkFence fence)
+{
+	VkResult result = vilc_imageLayoutTracking_next_vkQueueSubmit(queue, submitCount, pSubmits, fence);
+	uint32_t i, j;
+
+	if (result != VK_SUCCESS)
+		return result;
+
+	pthread_mutex_lock(&vilc_imageLayoutTracking_mutex);
+	for (i = 0; i < submitCount; ++i)
+		for (j = 0; j < pSubmits[i].commandBufferCount; ++j)
+			vilc_imageLayoutTracking_submit(pSubmits[i].pCommandBuffers[j]);
+	pthread_mutex_unlock(&vilc_imageLayoutTracking_mutex);
+
+	return result;
+}
+
+#if defined(VK_VERSION_1_3) || defined(VK_KHR_synchronization2)
+static void vilc_imageLayoutTracking_submit2(uint32_t submitCount, const VkSubmitInfo2* pSubmits)
+{
+	uint32_t i, j;
+
+	pthread_mutex_lock(&vilc_imageLayoutTracking_mutex);
+	for (i = 0; i < submitCount; ++i)
+		for (j = 0; j < pSubmits[i].commandBufferInfoCount; ++j)
+			vilc_imageLayoutTracking_submit(pSubmits[i].pCommandBufferInfos[j].commandBuffer);
+	pthread_mutex_unlock(&vilc_imageLayoutTracking_mutex);
+}
+#endif /* defined(VK_VERSION_1_3) || defined(VK_KHR_synchronization2) */
+
+#if defined(VK_VERSION_1_3)
+VILC_LAYER_NEXT(vilc_imageLayoutTracking, vkQueueSubmit2)
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_imageLayoutTracking_vkQueueSubmit2(VkQueue queue, uint32_t submitCount, const VkSubmitInfo2* pSubmits, VkFence fence)
+{
+	VkResult result = vilc_imageLayoutTracking_next_vkQueueSubmit2(queue, submitCount, pSubmits, fence);
+	if (result == VK_SUCCESS)
+		vilc_imageLayoutTracking_submit2(submitCount, pSubmits);
+	return result;
+}
+#endif /* defined(VK_VERSION_1_3) */
+
+#if defined(VK_KHR_synchronization2)
+VILC_LAYER_NEXT(vilc_imageLayoutTracking, vkQueueSubmit2KHR)
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_imageLayoutTracking_vkQueueSubmit2KHR(VkQueue queue, uint32_t submitCount, const VkSubmitInfo2* pSubmits, VkFence fence)
+{
+	VkResult result = vilc_imageLayoutTracking_next_vkQueueSubmit2KHR(queue, submitCount, pSubmits, fence);
+	if (result == VK_SUCCESS)
+		vilc_imageLayoutTracking_submit2(submitCount, pSubmits);
+	return result;
+}
+#endif /* defined(VK_KHR_synchronization2) */
+
+#if defined(VK_VERSION_1_4) || defined(VK_EXT_host_image_copy)
+/* Host transitions that do not change the layout are dropped; returns the number of the others, copied to transitions */
+static uint32_t vilc_imageLayoutTracking_filterHostTransitions(uint32_t transitionCount, const VkHostImageLayoutTransitionInfo* pTransitions, VkHostImageLayoutTransitionInfo* transitions)
+{
+	uint32_t count = 0, i;
+
+	VILC_ATOMIC_ADD(&vilc_imageLayoutTracking_hostTransitions, transitionCount);
+	if (transitionCount > VILC_IMAGE_LAYOUT_TRACKING_BARRIER_COUNT)
+		return ~0u;
+
+	for (i = 0; i < transitionCount; ++i)
+		if (pTransitions[i].oldLayout != pTransitions[i].newLayout || pTransitions[i].pNext)
+			transitions[count++] = pTransitions[i];
+
+	VILC_ATOMIC_ADD(&vilc_imageLayoutTracking_droppedHostTransitions, transitionCount - count);
+	return count;
+}
+
+/* Host transitions happen at the call, so they apply to the images directly */
+static void vilc_imageLayoutTracking_applyHostTransitions(uint32_t transitionCount, const VkHostImageLayoutTransitionInfo* pTransitions)
+{
+	uint32_t begins[VILC_IMAGE_LAYOUT_TRACKING_RANGE_RUNS], ends[VILC_IMAGE_LAYOUT_TRACKING_RANGE_RUNS];
+	uint32_t count, i, j;
+
+	pthread_mutex_lock(&vilc_imageLayoutTracking_mutex);
+	for (i = 0; i < transitionCount; ++i)
+	{
+		VilcImageLayoutTrackingImage* image = (VilcImageLayoutTrackingImage*)vilc_mapFind(&vilc_imageLayoutTracking_images, VILC_OBJECT_KEY(pTransitions[i].image));
+
+		if (!image)
+			continue;
+		count = vilc_imageLayoutTracking_ranges(image->mipLevels, image->arrayLayers, &pTransitions[i].subresourceRange, begins, ends);
+		if (!count)
+			image->layouts.count = 0;
+		for (j = 0; j < count; ++j)
+			if (!vilc_layoutRuns_set(&image->layouts, begins[j], ends[j], pTransitions[i].newLayout, 1))
+				image->layouts.count = 0;
+	}
+	pthread_mutex_unlock(&vilc_imageLayoutTracking_mutex);
+}
+#endif /* defined(VK_VERSION_1_4) || defined(VK_EXT_host_image_copy) */
+
+#if defined(VK_VERSION_1_4)
+VILC_LAYER_NEXT(vilc_imageLayoutTracking, vkTransitionImageLayout)
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_imageLayoutTracking_vkTransitionImageLayout(VkDevice device, uint32_t transitionCount, const VkHostImageLayoutTransitionInfo* pTransitions)
+{
+	VkHostImageLayoutTransitionInfo transitions[VILC_IMAGE_LAYOUT_TRACKING_BARRIER_COUNT];
+	uint32_t count = vilc_imageLayoutTracking_filterHostTransitions(transitionCount, pTransitions, transitions);
+	VkResult result = VK_SUCCESS;
+
+	if (count == ~0u)
+		result = vilc_imageLayoutTracking_next_vkTransitionImageLayout(device, transitionCount, pTransitions);
+	else if (count)
+		result = vilc_imageLayoutTracking_next_vkTransitionImageLayout(device, count, transitions);
+	if (result == VK_SUCCESS)
+		vilc_imageLayoutTracking_applyHostTransitions(transitionCount, pTransitions);
+	return result;
+}
+#endif /* defined(VK_VERSION_1_4) */
+
+#if defined(VK_EXT_host_image_copy)
+VILC_LAYER_NEXT(vilc_imageLayoutTracking, vkTransitionImageLayoutEXT)
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_imageLayoutTracking_vkTransitionImageLayoutEXT(VkDevice device, uint32_t transitionCount, const VkHostImageLayoutTransitionInfo* pTransitions)
+{
+	VkHostImageLayoutTransitionInfo transitions[VILC_IMAGE_LAYOUT_TRACKING_BARRIER_COUNT];
+	uint32_t count = vilc_imageLayoutTracking_filterHostTransitions(transitionCount, pTransitions, transitions);
+	VkResult result = VK_SUCCESS;
+
+	if (count == ~0u)
+		result = vilc_imageLayoutTracking_next_vkTransitionImageLayoutEXT(device, transitionCount, pTransitions);
+	else if (count)
+		result = vilc_imageLayoutTracking_next_vkTransitionImageLayoutEXT(device, count, transitions);
+	if (result == VK_SUCCESS)
+		vilc_imageLayoutTracking_applyHostTransitions(transitionCount, pTransitions);
+	return result;
+}
+#endif /* defined(VK_EXT_host_image_copy) */
+
+static void vilc_imageLayoutTracking_install(void)
+{
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkDestroyDevice)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkCreateImage)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkDestroyImage)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkCreateImageView)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkDestroyImageView)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkCreateRenderPass)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkDestroyRenderPass)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkCreateFramebuffer)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkDestroyFramebuffer)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkDestroyCommandPool)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkAllocateCommandBuffers)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkFreeCommandBuffers)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkBeginCommandBuffer)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkCmdPipelineBarrier)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkCmdWaitEvents)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkCmdBeginRenderPass)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkCmdEndRenderPass)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkCmdExecuteCommands)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkQueueSubmit)
+#if defined(VK_VERSION_1_2)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkCreateRenderPass2)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkCmdBeginRenderPass2)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkCmdEndRenderPass2)
+#endif
+#if defined(VK_VERSION_1_3)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkCmdPipelineBarrier2)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkCmdWaitEvents2)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkCmdBeginRendering)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkCmdEndRendering)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkQueueSubmit2)
+#endif
+#if defined(VK_VERSION_1_4)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkTransitionImageLayout)
+#endif
+#if defined(VK_KHR_create_renderpass2)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkCreateRenderPass2KHR)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkCmdBeginRenderPass2KHR)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkCmdEndRenderPass2KHR)
+#endif
+#if defined(VK_KHR_dynamic_rendering)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkCmdBeginRenderingKHR)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkCmdEndRenderingKHR)
+#endif
+#if defined(VK_KHR_synchronization2)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkCmdPipelineBarrier2KHR)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkCmdWaitEvents2KHR)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkQueueSubmit2KHR)
+#endif
+#if defined(VK_EXT_host_image_copy)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkTransitionImageLayoutEXT)
+#endif
+#if defined(VK_EXT_fragment_density_map_offset)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkCmdEndRendering2EXT)
+#endif
+#if defined(VK_KHR_maintenance10)
+	VILC_LAYER_HOOK(vilc_imageLayoutTracking, vkCmdEndRendering2KHR)
+#endif
+}
+#endif /* VILC_IMAGE_LAYOUT_TRACKING */
+
+#if defined(VOLK_IN_LOADERS_CLOTH) && defined(VILC_DRAW_BATCHING)
+/* Draw batching: runs of vkCmdDraw or vkCmdDrawIndexed calls with the same instanceCount and firstInstance are
+ * buffered per command buffer and recorded as one vkCmdDrawMultiEXT or vkCmdDrawMultiIndexedEXT before the next other
+ * command, or at vkEndCommandBuffer, when VK_EXT_multi_draw and its multiDraw feature are enabled on the device created
+ * last. The draws of a multi draw command see consecutive DrawIndex values where separate draws see 0, so draws are
+ * only buffered while the bound graphics pipeline was created from SPIR-V that does not decorate anything as DrawIndex;
+ * pipelines linked from libraries or created from module identifiers, and shader objects, are never batched. A run of
+ * one draw is recorded unchanged.
+ */
+#define VILC_DRAW_BATCHING_DRAW_COUNT 256
+
+/* The SPIR-V that identifies DrawIndex; decorations come before the first OpFunction */
+#define VILC_SPIRV_MAGIC 0x07230203u
+#define VILC_SPIRV_HEADER_WORDS 5
+#define VILC_SPIRV_OP_DECORATE 71
+#define VILC_SPIRV_OP_MEMBER_DECORATE 72
+#define VILC_SPIRV_OP_FUNCTION 54
+#define VILC_SPIRV_DECORATION_BUILT_IN 11
+#define VILC_SPIRV_BUILT_IN_DRAW_INDEX 4426
+
+typedef struct VilcDrawBatchingCommandBuffer
+{
+	VkCommandBuffer commandBuffer;
+	VkCommandPool commandPool;
+	/* whether the bound graphics pipeline is known not to read DrawIndex */
+	int batchable;
+	/* draws buffered since the last flush, which share the kind and instance range */
+	uint32_t drawCount;
+	int indexed;
+	uint32_t instanceCount;
+	uint32_t firstInstance;
+	VkMultiDrawInfoEXT draws[VILC_DRAW_BATCHING_DRAW_COUNT];
+	VkMultiDrawIndexedInfoEXT indexedDraws[VILC_DRAW_BATCHING_DRAW_COUNT];
+} VilcDrawBatchingCommandBuffer;
+
+static pthread_mutex_t vilc_drawBatching_mutex = PTHREAD_MUTEX_INITIALIZER;
+static VilcHandleMap vilc_drawBatching_commandBuffers;
+/* shader modules and graphics pipelines known not to read DrawIndex */
+static VilcHandleMap vilc_drawBatching_shaderModules;
+static VilcHandleMap vilc_drawBatching_pipelines;
+/* command buffers with buffered draws; other commands skip the lookup while there are none */
+static uint32_t vilc_drawBatching_pendingCommandBuffers = 0;
+/* most draws one multi draw command takes on the device created last, 0 when multiDraw is not enabled there */
+static uint32_t vilc_drawBatching_maxDrawCount = 0;
+static PFN_vkCmdDrawMultiEXT vilc_drawBatching_drawMulti = NULL;
+static PFN_vkCmdDrawMultiIndexedEXT vilc_drawBatching_drawMultiIndexed = NULL;
+static uint64_t vilc_drawBatching_drawCalls = 0;
+static uint64_t vilc_drawBatching_batchedDraws = 0;
+static uint64_t vilc_drawBatching_multiDrawCalls = 0;
+
+VILC_LAYER_NEXT(vilc_drawBatching, vkCreateDevice)
+VILC_LAYER_NEXT(vilc_drawBatching, vkDestroyDevice)
+VILC_LAYER_NEXT(vilc_drawBatching, vkCreateShaderModule)
+VILC_LAYER_NEXT(vilc_drawBatching, vkDestroyShaderModule)
+VILC_LAYER_NEXT(vilc_drawBatching, vkCreateGraphicsPipelines)
+VILC_LAYER_NEXT(vilc_drawBatching, vkDestroyPipeline)
+VILC_LAYER_NEXT(vilc_drawBatching, vkDestroyCommandPool)
+VILC_LAYER_NEXT(vilc_drawBatching, vkAllocateCommandBuffers)
+VILC_LAYER_NEXT(vilc_drawBatching, vkFreeCommandBuffers)
+VILC_LAYER_NEXT(vilc_drawBatching, vkBeginCommandBuffer)
+VILC_LAYER_NEXT(vilc_drawBatching, vkEndCommandBuffer)
+VILC_LAYER_NEXT(vilc_drawBatching, vkCmdBindPipeline)
+VILC_LAYER_NEXT(vilc_drawBatching, vkCmdExecuteCommands)
+VILC_LAYER_NEXT(vilc_drawBatching, vkCmdDraw)
+VILC_LAYER_NEXT(vilc_drawBatching, vkCmdDrawIndexed)
+
+/* Every command recorded into a command buffer first flushes its pending draws, through a layer of its own that is
+ * installed under the draw hooks; runs of one draw are recorded through it too, after the pending ones are taken.
+ */
+#define VILC_DRAW_BATCHING_FLUSH(name, params, args) \
+	VILC_LAYER_NEXT(vilc_drawBatchingFlush, name) \
+	static VKAPI_ATTR void VKAPI_CALL vilc_drawBatchingFlush_##name params \
+	{ \
+		vilc_drawBatching_flush(commandBuffer); \
+		vilc_drawBatchingFlush_next_##name args; \
+	}
+#define VILC_DRAW_BATCHING_FLUSH_RESULT(name, params, args) \
+	VILC_LAYER_NEXT(vilc_drawBatchingFlush, name) \
+	static VKAPI_ATTR VkResult VKAPI_CALL vilc_drawBatchingFlush_##name params \
+	{ \
+		vilc_drawBatching_flush(commandBuffer); \
+		return vilc_drawBatchingFlush_next_##name args; \
+	}
+
+static void vilc_drawBatching_flush(VkCommandBuffer commandBuffer);
+
+VILC_DEVICE_COMMANDS(VILC_DRAW_BATCHING_FLUSH, VILC_DRAW_BATCHING_FLUSH_RESULT)
+#undef VILC_DRAW_BATCHING_FLUSH
+#undef VILC_DRAW_BATCHING_FLUSH_RESULT
+
+static VilcDrawBatchingCommandBuffer* vilc_drawBatching_find(VkCommandBuffer commandBuffer)
+{
+	VilcDrawBatchingCommandBuffer* state;
+
+	pthread_mutex_lock(&vilc_drawBatching_mutex);
+	state = (VilcDrawBatchingCommandBuffer*)vilc_mapFind(&vilc_drawBatching_commandBuffers, VILC_DISPATCHABLE_KEY(commandBuffer));
+	pthread_mutex_unlock(&vilc_drawBatching_mutex);
+
+	return state;
+}
+
+static void vilc_drawBatching_discard(VilcDrawBatchingCommandBuffer* state)
+{
+	if (state->drawCount)
+		VILC_ATOMIC_ADD(&vilc_drawBatching_pendingCommandBuffers, (uint32_t)-1);
+	state->drawCount = 0;
+}
+
+/* Records the pending draws as one draw command */
+static void vilc_drawBatching_record(VilcDrawBatchingCommandBuffer* state)
+{
+	const VkMultiDrawInfoEXT* draw = &state->draws[0];
+	const VkMultiDrawIndexedInfoEXT* indexedDraw = &state->indexedDraws[0];
+
+	if (state->drawCount == 1 && !state->indexed)
+		vilc_drawBatchingFlush_next_vkCmdDraw(state->commandBuffer, draw->vertexCount, state->instanceCount, draw->firstVertex, state->firstInstance);
+	else if (state->drawCount == 1)
+		vilc_drawBatchingFlush_next_vkCmdDrawIndexed(state->commandBuffer, indexedDraw->indexCount, state->instanceCount, indexedDraw->firstIndex,
+		    indexedDraw->vertexOffset, state->firstInstance);
+	else if (!state->indexed)
+		vilc_drawBatching_drawMulti(state->commandBuffer, state->drawCount, state->draws, state->instanceCount, state->firstInstance, sizeof(VkMultiDrawInfoEXT));
+	else
+		vilc_drawBatching_drawMultiIndexed(state->commandBuffer, state->drawCount, state->indexedDraws, state->instanceCount, state->firstInstance,
+		    sizeof(VkMultiDrawIndexedInfoEXT), NULL);
+
+	if (state->drawCount > 1)
+	{
+		VILC_ATOMIC_ADD(&vilc_drawBatching_batchedDraws, state->drawCount);
+		VILC_ATOMIC_ADD(&vilc_drawBatching_multiDrawCalls, 1);
+	}
+}
+
+static void vilc_drawBatching_flushState(VilcDrawBatchingCommandBuffer* state)
+{
+	if (!state->drawCount)
+		return;
+
+	vilc_drawBatching_record(state);
+	vilc_drawBatching_discard(state);
+}
+
+static void vilc_drawBatching_flush(VkCommandBuffer commandBuffer)
+{
+	VilcDrawBatchingCommandBuffer* state;
+
+	if (!VILC_ATOMIC_LOAD(&vilc_drawBatching_pendingCommandBuffers))
+		return;
+
+	state = vilc_drawBatching_find(commandBuffer);
+	if (state)
+		vilc_drawBatching_flushState(state);
+}
+
+/* Adds a draw to the pending ones, flushing them first when it cannot join them; returns NULL when the draw is to be
+ * recorded unchanged instead
+ */
+static VilcDrawBatchingCommandBuffer* vilc_drawBatching_add(VkCommandBuffer commandBuffer, int indexed, uint32_t instanceCount, uint32_t firstInstance)
+{
+	VilcDrawBatchingCommandBuffer* state;
+
+	VILC_ATOMIC_ADD(&vilc_drawBatching_drawCalls, 1);
+	if (!vilc_drawBatching_maxDrawCount || (indexed ? !vilc_drawBatching_drawMultiIndexed : !vilc_drawBatching_drawMulti))
+		return NULL;
+
+	state = vilc_drawBatching_find(commandBuffer);
+	if (!state || !state->batchable)
+		return NULL;
+
+	if (state->drawCount && (state->indexed != indexed || state->instanceCount != instanceCount || state->firstInstance != firstInstance ||
+	    state->drawCount == vilc_drawBatching_maxDrawCount))
+		vilc_drawBatching_flushState(state);
+
+	if (!state->drawCount)
+		VILC_ATOMIC_ADD(&vilc_drawBatching_pendingCommandBuffers, 1);
+	state->drawCount++;
+	state->indexed = indexed;
+	state->instanceCount = instanceCount;
+	state->firstInstance = firstInstance;
+	return state;
+}
+
+/* Whether SPIR-V code decorates a variable or block member as DrawIndex; code that cannot be parsed is assumed to */
+static int vilc_drawBatching_readsDrawIndex(const uint32_t* code, size_t codeSize)
+{
+	size_t wordCount = codeSize / sizeof(uint32_t), i = VILC_SPIRV_HEADER_WORDS;
+
+	if (!code || wordCount < VILC_SPIRV_HEADER_WORDS || code[0] != VILC_SPIRV_MAGIC)
+		return 1;
+
+	while (i < wordCount)
+	{
+		uint32_t opcode = code[i] & 0xffff, length = code[i] >> 16;
+
+		if (!length || length > wordCount - i)
+			return 1;
+		if (opcode == VILC_SPIRV_OP_FUNCTION)
+			return 0;
+		if (opcode == VILC_SPIRV_OP_DECORATE && length >= 4 && code[i + 2] == VILC_SPIRV_DECORATION_BUILT_IN && code[i + 3] == VILC_SPIRV_BUILT_IN_DRAW_INDEX)
+			return 1;
+		if (opcode == VILC_SPIRV_OP_MEMBER_DECORATE && length >= 5 && code[i + 3] == VILC_SPIRV_DECORATION_BUILT_IN && code[i + 4] == VILC_SPIRV_BUILT_IN_DRAW_INDEX)
+			return 1;
+		i += length;
+	}
+
+	return 0;
+}
+
+/* Whether every shader stage of a graphics pipeline is known not to read DrawIndex; called with the mutex held */
+static int vilc_drawBatching_pipelineBatchable(const VkGraphicsPipelineCreateInfo* pCreateInfo)
+{
+	const VkBaseInStructure* next;
+	uint32_t i;
+
+	/* the stages of pipelines linked from libraries are not in their create info */
+	if (!pCreateInfo->stageCount)
+		return 0;
+#if defined(VK_KHR_pipeline_library)
+	for (next = (const VkBaseInStructure*)pCreateInfo->pNext; next; next = next->pNext)
+		if (next->sType == VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR)
+			return 0;
+#endif
+
+	for (i = 0; i < pCreateInfo->stageCount; ++i)
+	{
+		const VkPipelineShaderStageCreateInfo* stage = &pCreateInfo->pStages[i];
+		const VkShaderModuleCreateInfo* moduleInfo = NULL;
+
+		if (stage->module)
+		{
+			if (!vilc_mapFind(&vilc_drawBatching_shaderModules, VILC_OBJECT_KEY(stage->module)))
+				return 0;
+			continue;
+		}
+
+		/* without a module, the stage has its code chained, or a module identifier that tells nothing about it */
+		for (next = (const VkBaseInStructure*)stage->pNext; next; next = next->pNext)
+			if (next->sType == VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO)
+				moduleInfo = (const VkShaderModuleCreateInfo*)next;
+		if (!moduleInfo || vilc_drawBatching_readsDrawIndex(moduleInfo->pCode, moduleInfo->codeSize))
+			return 0;
+	}
+
+	return 1;
+}
+
+void vilcGetDrawBatchingStats(VilcDrawBatchingStats* stats)
+{
+	stats->drawCalls = VILC_ATOMIC_LOAD(&vilc_drawBatching_drawCalls);
+	stats->batchedDraws = VILC_ATOMIC_LOAD(&vilc_drawBatching_batchedDraws);
+	stats->multiDrawCalls = VILC_ATOMIC_LOAD(&vilc_drawBatching_multiDrawCalls);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_drawBatching_vkCreateDevice(VkPhysicalDevice physicalDevice, const VkDeviceCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDevice* pDevice)
+{
+	VkResult result = vilc_drawBatching_next_vkCreateDevice(physicalDevice, pCreateInfo, pAllocator, pDevice);
+	VkPhysicalDeviceProperties properties;
+	VkPhysicalDeviceProperties2 properties2;
+	VkPhysicalDeviceMultiDrawPropertiesEXT multiDrawProperties;
+	PFN_vkGetPhysicalDeviceProperties2 getProperties2 = NULL;
+	const VkBaseInStructure* next;
+	VkBool32 multiDraw = VK_FALSE;
+
+	if (result != VK_SUCCESS)
+		return result;
+
+	vilc_drawBatching_maxDrawCount = 0;
+	for (next = (const VkBaseInStructure*)pCreateInfo->pNext; next; next = next->pNext)
+		if (next->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTI_DRAW_FEATURES_EXT)
+			multiDraw |= ((const VkPhysicalDeviceMultiDrawFeaturesEXT*)next)->multiDraw;
+	if (!multiDraw || !vilc_hasDeviceExtension(pCreateInfo, VK_EXT_MULTI_DRAW_EXTENSION_NAME))
+		return result;
+
+	vilc_instance.vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+	if (properties.apiVersion >= VK_API_VERSION_1_1)
+		getProperties2 = vilc_instance.vkGetPhysicalDeviceProperties2;
+#if defined(VK_KHR_get_physical_device_properties2)
+	if (!getProperties2)
+		getProperties2 = vilc_instance.vkGetPhysicalDeviceProperties2KHR;
+#endif
+	if (!getProperties2)
+		return result;
+
+	memset(&multiDrawProperties, 0, sizeof(multiDrawProperties));
+	multiDrawProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTI_DRAW_PROPERTIES_EXT;
+	memset(&properties2, 0, sizeof(properties2));
+	properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	properties2.pNext = &multiDrawProperties;
+	getProperties2(physicalDevice, &properties2);
+
+	/* drawCount must be less than maxMultiDrawCount */
+	if (multiDrawProperties.maxMultiDrawCount > 2)
+		vilc_drawBatching_maxDrawCount = multiDrawProperties.maxMultiDrawCount - 1 < VILC_DRAW_BATCHING_DRAW_COUNT ? multiDrawProperties.maxMultiDrawCount - 1 : VILC_DRAW_BATCHING_DRAW_COUNT;
+
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_drawBatching_vkDestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator)
+{
+	VilcDrawBatchingStats stats;
+	uint32_t i;
+
+	pthread_mutex_lock(&vilc_drawBatching_mutex);
+	for (i = 0; i < vilc_drawBatching_commandBuffers.capacity; ++i)
+		if (vilc_drawBatching_commandBuffers.keys[i])
+			free(vilc_drawBatching_commandBuffers.values[i]);
+	vilc_mapFree(&vilc_drawBatching_commandBuffers);
+	vilc_mapFree(&vilc_drawBatching_shaderModules);
+	vilc_mapFree(&vilc_drawBatching_pipelines);
+	VILC_ATOMIC_STORE(&vilc_drawBatching_pendingCommandBuffers, 0);
+	pthread_mutex_unlock(&vilc_drawBatching_mutex);
+
+	vilcGetDrawBatchingStats(&stats);
+	fprintf(stderr, "vilc: draw batching: %llu of %llu draws recorded as %llu multi draw commands\n", (unsigned long long)stats.batchedDraws,
+	    (unsigned long long)stats.drawCalls, (unsigned long long)stats.multiDrawCalls);
+
+	vilc_drawBatching_next_vkDestroyDevice(device, pAllocator);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_drawBatching_vkCreateShaderModule(VkDevice device, const VkShaderModuleCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkShaderModule* pShaderModule)
+{
+	VkResult result = vilc_drawBatching_next_vkCreateShaderModule(device, pCreateInfo, pAllocator, pShaderModule);
+
+	if (result == VK_SUCCESS && !vilc_drawBatching_readsDrawIndex(pCreateInfo->pCode, pCreateInfo->codeSize))
+	{
+		pthread_mutex_lock(&vilc_drawBatching_mutex);
+		vilc_mapInsert(&vilc_drawBatching_shaderModules, VILC_OBJECT_KEY(*pShaderModule), (void*)(uintptr_t)1);
+		pthread_mutex_unlock(&vilc_drawBatching_mutex);
+	}
+
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_drawBatching_vkDestroyShaderModule(VkDevice device, VkShaderModule shaderModule, const VkAllocationCallbacks* pAllocator)
+{
+	if (shaderModule)
+	{
+		pthread_mutex_lock(&vilc_drawBatching_mutex);
+		vilc_mapRemove(&vilc_drawBatching_shaderModules, VILC_OBJECT_KEY(shaderModule));
+		pthread_mutex_unlock(&vilc_drawBatching_mutex);
+	}
+	vilc_drawBatching_next_vkDestroyShaderModule(device, shaderModule, pAllocator);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_drawBatching_vkCreateGraphicsPipelines(VkDevice device, VkPipelineCache pipelineCache, uint32_t createInfoCount, const VkGraphicsPipelineCreateInfo* pCreateInfos, const VkAllocationCallbacks* pAllocator, VkPipeline* pPipelines)
+{
+	VkResult result = vilc_drawBatching_next_vkCreateGraphicsPipelines(device, pipelineCache, createInfoCount, pCreateInfos, pAllocator, pPipelines);
+	uint32_t i;
+
+	/* pipelines that were created are valid even when others failed */
+	pthread_mutex_lock(&vilc_drawBatching_mutex);
+	for (i = 0; i < createInfoCount; ++i)
+		if (pPipelines[i] && vilc_drawBatching_pipelineBatchable(&pCreateInfos[i]))
+			vilc_mapInsert(&vilc_drawBatching_pipelines, VILC_OBJECT_KEY(pPipelines[i]), (void*)(uintptr_t)1);
+	pthread_mutex_unlock(&vilc_drawBatching_mutex);
+
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_drawBatching_vkDestroyPipeline(VkDevice device, VkPipeline pipeline, const VkAllocationCallbacks* pAllocator)
+{
+	if (pipeline)
+	{
+		pthread_mutex_lock(&vilc_drawBatching_mutex);
+		vilc_mapRemove(&vilc_drawBatching_pipelines, VILC_OBJECT_KEY(pipeline));
+		pthread_mutex_unlock(&vilc_drawBatching_mutex);
+	}
+	vilc_drawBatching_next_vkDestroyPipeline(device, pipeline, pAllocator);
+}
+
+static void vilc_drawBatching_freeCommandBuffer(VilcDrawBatchingCommandBuffer* state)
+{
+	if (state)
+		vilc_drawBatching_discard(state);
+	free(state);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_drawBatching_vkDestroyCommandPool(VkDevice device, VkCommandPool commandPool, const VkAllocationCallbacks* pAllocator)
+{
+	uint32_t i = 0;
+
+	pthread_mutex_lock(&vilc_drawBatching_mutex);
+	/* removal shifts later entries back into the scanned slot, so it is scanned again */
+	while (commandPool && i < vilc_drawBatching_commandBuffers.capacity)
+	{
+		VilcDrawBatchingCommandBuffer* state = (VilcDrawBatchingCommandBuffer*)vilc_drawBatching_commandBuffers.values[i];
+		if (vilc_drawBatching_commandBuffers.keys[i] && state->commandPool == commandPool)
+			vilc_drawBatching_freeCommandBuffer((VilcDrawBatchingCommandBuffer*)vilc_mapRemove(&vilc_drawBatching_commandBuffers, vilc_drawBatching_commandBuffers.keys[i]));
+		else
+			++i;
+	}
+	pthread_mutex_unlock(&vilc_drawBatching_mutex);
+
+	vilc_drawBatching_next_vkDestroyCommandPool(device, commandPool, pAllocator);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_drawBatching_vkAllocateCommandBuffers(VkDevice device, const VkCommandBufferAllocateInfo* pAllocateInfo, VkCommandBuffer* pCommandBuffers)
+{
+	VkResult result = vilc_drawBatching_next_vkAllocateCommandBuffers(device, pAllocateInfo, pCommandBuffers);
+	uint32_t i;
+
+	if (result != VK_SUCCESS)
+		return result;
+
+	pthread_mutex_lock(&vilc_drawBatching_mutex);
+	for (i = 0; i < pAllocateInfo->commandBufferCount; ++i)
+	{
+		VilcDrawBatchingCommandBuffer* state = (VilcDrawBatchingCommandBuffer*)calloc(1, sizeof(VilcDrawBatchingCommandBuffer));
+		if (!state)
+			break;
+		state->commandBuffer = pCommandBuffers[i];
+		state->commandPool = pAllocateInfo->commandPool;
+		if (!vilc_mapInsert(&vilc_drawBatching_commandBuffers, VILC_DISPATCHABLE_KEY(pCommandBuffers[i]), state))
+			free(state);
+	}
+	pthread_mutex_unlock(&vilc_drawBatching_mutex);
+
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_drawBatching_vkFreeCommandBuffers(VkDevice device, VkCommandPool commandPool, uint32_t commandBufferCount, const VkCommandBuffer* pCommandBuffers)
+{
+	uint32_t i;
+
+	pthread_mutex_lock(&vilc_drawBatching_mutex);
+	for (i = 0; i < commandBufferCount; ++i)
+		if (pCommandBuffers[i])
+			vilc_drawBatching_freeCommandBuffer((VilcDrawBatchingCommandBuffer*)vilc_mapRemove(&vilc_drawBatching_commandBuffers, VILC_DISPATCHABLE_KEY(pCommandBuffers[i])));
+	pthread_mutex_unlock(&vilc_drawBatching_mutex);
+
+	vilc_drawBatching_next_vkFreeCommandBuffers(device, commandPool, commandBufferCount, pCommandBuffers);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_drawBatching_vkBeginCommandBuffer(VkCommandBuffer commandBuffer, const VkCommandBufferBeginInfo* pBeginInfo)
+{
+	VilcDrawBatchingCommandBuffer* state = vilc_drawBatching_find(commandBuffer);
+
+	/* draws of a recording that was never ended are dropped with it; no pipeline is bound at the start */
+	if (state)
+	{
+		vilc_drawBatching_discard(state);
+		state->batchable = 0;
+	}
+	return vilc_drawBatching_next_vkBeginCommandBuffer(commandBuffer, pBeginInfo);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_drawBatching_vkEndCommandBuffer(VkCommandBuffer commandBuffer)
+{
+	vilc_drawBatching_flush(commandBuffer);
+	return vilc_drawBatching_next_vkEndCommandBuffer(commandBuffer);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_drawBatching_vkCmdBindPipeline(VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipeline pipeline)
+{
+	VilcDrawBatchingCommandBuffer* state;
+
+	if (pipelineBindPoint == VK_PIPELINE_BIND_POINT_GRAPHICS && vilc_drawBatching_maxDrawCount)
+	{
+		pthread_mutex_lock(&vilc_drawBatching_mutex);
+		state = (VilcDrawBatchingCommandBuffer*)vilc_mapFind(&vilc_drawBatching_commandBuffers, VILC_DISPATCHABLE_KEY(commandBuffer));
+		if (state)
+			state->batchable = vilc_mapFind(&vilc_drawBatching_pipelines, VILC_OBJECT_KEY(pipeline)) != NULL;
+		pthread_mutex_unlock(&vilc_drawBatching_mutex);
+	}
+	vilc_drawBatching_next_vkCmdBindPipeline(commandBuffer, pipelineBindPoint, pipeline);
+}
+
+/* The bound state is undefined after secondary command buffers execute, until the next bind */
+static VKAPI_ATTR void VKAPI_CALL vilc_drawBatching_vkCmdExecuteCommands(VkCommandBuffer commandBuffer, uint32_t commandBufferCount, const VkCommandBuffer* pCommandBuffers)
+{
+	VilcDrawBatchingCommandBuffer* state = vilc_drawBatching_find(commandBuffer);
+
+	if (state)
+		state->batchable = 0;
+	vilc_drawBatching_next_vkCmdExecuteCommands(commandBuffer, commandBufferCount, pCommandBuffers);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_drawBatching_vkCmdDraw(VkCommandBuffer commandBuffer, uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance)
+{
+	VilcDrawBatchingCommandBuffer* state = vilc_drawBatching_add(commandBuffer, 0, instanceCount, firstInstance);
+	VkMultiDrawInfoEXT* draw;
+
+	if (!state)
+	{
+		vilc_drawBatching_next_vkCmdDraw(commandBuffer, vertexCount, instanceCount, firstVertex, firstInstance);
+		return;
+	}
+
+	draw = &state->draws[state->drawCount - 1];
+	draw->firstVertex = firstVertex;
+	draw->vertexCount = vertexCount;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_drawBatching_vkCmdDrawIndexed(VkCommandBuffer commandBuffer, uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance)
+{
+	VilcDrawBatchingCommandBuffer* state = vilc_drawBatching_add(commandBuffer, 1, instanceCount, firstInstance);
+	VkMultiDrawIndexedInfoEXT* draw;
+
+	if (!state)
+	{
+		vilc_drawBatching_next_vkCmdDrawIndexed(commandBuffer, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+		return;
+	}
+
+	draw = &state->indexedDraws[state->drawCount - 1];
+	draw->firstIndex = firstIndex;
+	draw->indexCount = indexCount;
+	draw->vertexOffset = vertexOffset;
+}
+
+#if defined(VK_EXT_shader_object)
+VILC_LAYER_NEXT(vilc_drawBatching, vkCmdBindShadersEXT)
+
+/* Shader objects replace the stages of the bound pipeline, and their code is not known here */
+static VKAPI_ATTR void VKAPI_CALL vilc_drawBatching_vkCmdBindShadersEXT(VkCommandBuffer commandBuffer, uint32_t stageCount, const VkShaderStageFlagBits* pStages, const VkShaderEXT* pShaders)
+{
+	VilcDrawBatchingCommandBuffer* state = vilc_drawBatching_find(commandBuffer);
+
+	if (state)
+		state->batchable = 0;
+	vilc_drawBatching_next_vkCmdBindShadersEXT(commandBuffer, stageCount, pStages, pShaders);
+}
+#endif /* defined(VK_EXT_shader_object) */
+
+#if defined(VK_EXT_debug_utils)
+VILC_LAYER_NEXT(vilc_drawBatching, vkCmdBeginDebugUtilsLabelEXT)
+VILC_LAYER_NEXT(vilc_drawBatching, vkCmdEndDebugUtilsLabelEXT)
+VILC_LAYER_NEXT(vilc_drawBatching, vkCmdInsertDebugUtilsLabelEXT)
+
+/* Labels are loaded with the instance, so they are not in the flush layer; draws stay inside the labels they were in */
+static VKAPI_ATTR void VKAPI_CALL vilc_drawBatching_vkCmdBeginDebugUtilsLabelEXT(VkCommandBuffer commandBuffer, const VkDebugUtilsLabelEXT* pLabelInfo)
+{
+	vilc_drawBatching_flush(commandBuffer);
+	vilc_drawBatching_next_vkCmdBeginDebugUtilsLabelEXT(commandBuffer, pLabelInfo);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_drawBatching_vkCmdEndDebugUtilsLabelEXT(VkCommandBuffer commandBuffer)
+{
+	vilc_drawBatching_flush(commandBuffer);
+	vilc_drawBatching_next_vkCmdEndDebugUtilsLabelEXT(commandBuffer);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_drawBatching_vkCmdInsertDebugUtilsLabelEXT(VkCommandBuffer commandBuffer, const VkDebugUtilsLabelEXT* pLabelInfo)
+{
+	vilc_drawBatching_flush(commandBuffer);
+	vilc_drawBatching_next_vkCmdInsertDebugUtilsLabelEXT(commandBuffer, pLabelInfo);
+}
+#endif /* defined(VK_EXT_debug_utils) */
+
+static void vilc_drawBatching_installInstance(void)
+{
+	VILC_LAYER_HOOK(vilc_drawBatching, vkCreateDevice)
+#if defined(VK_EXT_debug_utils)
+	VILC_LAYER_HOOK(vilc_drawBatching, vkCmdBeginDebugUtilsLabelEXT)
+	VILC_LAYER_HOOK(vilc_drawBatching, vkCmdEndDebugUtilsLabelEXT)
+	VILC_LAYER_HOOK(vilc_drawBatching, vkCmdInsertDebugUtilsLabelEXT)
+#endif
+}
+
+static void vilc_drawBatching_installDevice(void)
+{
+	/* multi draws are recorded under the flush layer, which would otherwise flush them again */
+	vilc_drawBatching_drawMulti = vilc_vkCmdDrawMultiEXT;
+	vilc_drawBatching_drawMultiIndexed = vilc_vkCmdDrawMultiIndexedEXT;
+
+#define VILC_DRAW_BATCHING_HOOK(name, params, args) VILC_LAYER_HOOK(vilc_drawBatchingFlush, name)
+	VILC_DEVICE_COMMANDS(VILC_DRAW_BATCHING_HOOK, VILC_DRAW_BATCHING_HOOK)
+#undef VILC_DRAW_BATCHING_HOOK
+
+	VILC_LAYER_HOOK(vilc_drawBatching, vkDestroyDevice)
+	VILC_LAYER_HOOK(vilc_drawBatching, vkCreateShaderModule)
+	VILC_LAYER_HOOK(vilc_drawBatching, vkDestroyShaderModule)
+	VILC_LAYER_HOOK(vilc_drawBatching, vkCreateGraphicsPipelines)
+	VILC_LAYER_HOOK(vilc_drawBatching, vkDestroyPipeline)
+	VILC_LAYER_HOOK(vilc_drawBatching, vkDestroyCommandPool)
+	VILC_LAYER_HOOK(vilc_drawBatching, vkAllocateCommandBuffers)
+	VILC_LAYER_HOOK(vilc_drawBatching, vkFreeCommandBuffers)
+	VILC_LAYER_HOOK(vilc_drawBatching, vkBeginCommandBuffer)
+	VILC_LAYER_HOOK(vilc_drawBatching, vkEndCommandBuffer)
+	VILC_LAYER_HOOK(vilc_drawBatching, vkCmdBindPipeline)
+	VILC_LAYER_HOOK(vilc_drawBatching, vkCmdExecuteCommands)
+	VILC_LAYER_HOOK(vilc_drawBatching, vkCmdDraw)
+	VILC_LAYER_HOOK(vilc_drawBatching, vkCmdDrawIndexed)
+#if defined(VK_EXT_shader_object)
+	VILC_LAYER_HOOK(vilc_drawBatching, vkCmdBindShadersEXT)
+#endif
+}
+#endif /* VILC_DRAW_BATCHING */
+
+#if defined(VOLK_IN_LOADERS_CLOTH) && defined(VILC_DEFERRED_COMMANDS)
+/* Deferred commands: the state, draw, dispatch and buffer transfer commands listed in vilc.h are recorded into a stream
+ * per command buffer, with the arrays they point to copied into it, and replayed in one loop at vkEndCommandBuffer or
+ * before the next command that is not recorded. When the device created last provides vilcCmdExecuteRecordedCommands
+ * and no other mode intercepts the recorded commands, the stream is passed to it in one call instead. The memory of a
+ * stream is kept for the next recording of its command buffer and only released by resets that release resources, so
+ * recording the same work again allocates nothing.
+ */
+#define VILC_DEFERRED_COMMANDS_ARENA_SIZE 4096
+#define VILC_DEFERRED_COMMANDS_ALIGN(size) (((size_t)(size) + 7) & ~(size_t)7)
+#define VILC_DEFERRED_COMMANDS_ARRAY(type, record, field) ((const type*)((const char*)(record) + (record)->field))
+
+#define VILC_DEFERRED_COMMANDS_RECORDED(X) \
+	X(vkCmdBindPipeline) \
+	X(vkCmdBindDescriptorSets) \
+	X(vkCmdBindIndexBuffer) \
+	X(vkCmdBindVertexBuffers) \
+	X(vkCmdSetViewport) \
+	X(vkCmdSetScissor) \
+	X(vkCmdSetLineWidth) \
+	X(vkCmdPushConstants) \
+	X(vkCmdDraw) \
+	X(vkCmdDrawIndexed) \
+	X(vkCmdDrawIndirect) \
+	X(vkCmdDrawIndexedIndirect) \
+	X(vkCmdDispatch) \
+	X(vkCmdDispatchIndirect) \
+	X(vkCmdCopyBuffer) \
+	X(vkCmdUpdateBuffer) \
+	X(vkCmdFillBuffer)
+
+typedef struct VilcDeferredCommandsCommandBuffer
+{
+	VkCommandBuffer commandBuffer;
+	VkCommandPool commandPool;
+	/* whether commands are recorded, between vkBeginCommandBuffer and vkEndCommandBuffer */
+	int recording;
+	/* the stream starts at the start of the arena */
+	unsigned char* arena;
+	size_t size;
+	size_t capacity;
+} VilcDeferredCommandsCommandBuffer;
+
+static pthread_mutex_t vilc_deferredCommands_mutex = PTHREAD_MUTEX_INITIALIZER;
+static VilcHandleMap vilc_deferredCommands_commandBuffers;
+/* command buffers with recorded commands; other commands skip the lookup while there are none */
+static uint32_t vilc_deferredCommands_pendingCommandBuffers = 0;
+/* the ICD entry of the device created last, and whether the recorded commands reach the driver unchanged */
+static PFN_vilcCmdExecuteRecordedCommands vilc_deferredCommands_execute = NULL;
+static int vilc_deferredCommands_direct = 0;
+static uint64_t vilc_deferredCommands_recordedCommands = 0;
+static uint64_t vilc_deferredCommands_replayedStreams = 0;
+static uint64_t vilc_deferredCommands_executedStreams = 0;
+static uint64_t vilc_deferredCommands_streamBytes = 0;
+static uint64_t vilc_deferredCommands_arenaAllocations = 0;
+
+VILC_LAYER_NEXT(vilc_deferredCommands, vkCreateDevice)
+VILC_LAYER_NEXT(vilc_deferredCommands, vkDestroyDevice)
+VILC_LAYER_NEXT(vilc_deferredCommands, vkDestroyCommandPool)
+VILC_LAYER_NEXT(vilc_deferredCommands, vkResetCommandPool)
+VILC_LAYER_NEXT(vilc_deferredCommands, vkAllocateCommandBuffers)
+VILC_LAYER_NEXT(vilc_deferredCommands, vkFreeCommandBuffers)
+VILC_LAYER_NEXT(vilc_deferredCommands, vkResetCommandBuffer)
+VILC_LAYER_NEXT(vilc_deferredCommands, vkBeginCommandBuffer)
+VILC_LAYER_NEXT(vilc_deferredCommands, vkEndCommandBuffer)
+#define VILC_DEFERRED_COMMANDS_NEXT(name) VILC_LAYER_NEXT(vilc_deferredCommands, name)
+VILC_DEFERRED_COMMANDS_RECORDED(VILC_DEFERRED_COMMANDS_NEXT)
+#undef VILC_DEFERRED_COMMANDS_NEXT
+
+/* Every command recorded into a command buffer first replays the stream recorded so far, through a layer of its own that
+ * is installed under the recording hooks; streams are replayed through it too, and recorded commands that cannot be
+ * added to the stream are passed to it.
+ */
+#define VILC_DEFERRED_COMMANDS_FLUSH(name, params, args) \
+	VILC_LAYER_NEXT(vilc_deferredCommandsFlush, name) \
+	static VKAPI_ATTR void VKAPI_CALL vilc_deferredCommandsFlush_##name params \
+	{ \
+		vilc_deferredCommands_flush(commandBuffer); \
+		vilc_deferredCommandsFlush_next_##name args; \
+	}
+#define VILC_DEFERRED_COMMANDS_FLUSH_RESULT(name, params, args) \
+	VILC_LAYER_NEXT(vilc_deferredCommandsFlush, name) \
+	static VKAPI_ATTR VkResult VKAPI_CALL vilc_deferredCommandsFlush_##name params \
+	{ \
+		vilc_deferredCommands_flush(commandBuffer); \
+		return vilc_deferredCommandsFlush_next_##name args; \
+	}
+
+static void vilc_deferredCommands_flush(VkCommandBuffer commandBuffer);
+
+VILC_DEVICE_COMMANDS(VILC_DEFERRED_COMMANDS_FLUSH, VILC_DEFERRED_COMMANDS_FLUSH_RESULT)
+#undef VILC_DEFERRED_COMMANDS_FLUSH
+#undef VILC_DEFERRED_COMMANDS_FLUSH_RESULT
+
+static VilcDeferredCommandsCommandBuffer* vilc_deferredCommands_find(VkCommandBuffer commandBuffer)
+{
+	VilcDeferredCommandsCommandBuffer* state;
+
+	pthread_mutex_lock(&vilc_deferredCommands_mutex);
+	state = (VilcDeferredCommandsCommandBuffer*)vilc_mapFind(&vilc_deferredCommands_commandBuffers, VILC_DISPATCHABLE_KEY(commandBuffer));
+	pthread_mutex_unlock(&vilc_deferredCommands_mutex);
+
+	return state;
+}
+
+static void vilc_deferredCommands_discard(VilcDeferredCommandsCommandBuffer* state)
+{
+	if (state->size)
+		VILC_ATOMIC_ADD(&vilc_deferredCommands_pendingCommandBuffers, (uint32_t)-1);
+	state->size = 0;
+}
+
+/* Records the commands of a stream into the command buffer one by one */
+static void vilc_deferredCommands_replay(VkCommandBuffer commandBuffer, const unsigned char* stream, size_t size)
+{
+	size_t offset;
+
+	for (offset = 0; offset < size; offset += ((const VilcRecordedCommand*)(stream + offset))->size)
+	{
+		const VilcRecordedCommand* record = (const VilcRecordedCommand*)(stream + offset);
+
+		switch (record->type)
+		{
+		case VILC_RECORDED_BIND_PIPELINE:
+		{
+			const VilcRecordedBindPipeline* command = (const VilcRecordedBindPipeline*)record;
+			vilc_deferredCommandsFlush_next_vkCmdBindPipeline(commandBuffer, command->pipelineBindPoint, command->pipeline);
+			break;
+		}
+		case VILC_RECORDED_BIND_DESCRIPTOR_SETS:
+		{
+			const VilcRecordedBindDescriptorSets* command = (const VilcRecordedBindDescriptorSets*)record;
+			vilc_deferredCommandsFlush_next_vkCmdBindDescriptorSets(commandBuffer, command->pipelineBindPoint, command->layout, command->firstSet, command->descriptorSetCount,
+			    VILC_DEFERRED_COMMANDS_ARRAY(VkDescriptorSet, command, pDescriptorSets), command->dynamicOffsetCount,
+			    VILC_DEFERRED_COMMANDS_ARRAY(uint32_t, command, pDynamicOffsets));
+			break;
+		}
+		case VILC_RECORDED_BIND_INDEX_BUFFER:
+		{
+			const VilcRecordedBindIndexBuffer* command = (const VilcRecordedBindIndexBuffer*)record;
+			vilc_deferredCommandsFlush_next_vkCmdBindIndexBuffer(commandBuffer, command->buffer, command->offset, command->indexType);
+			break;
+		}
+		case VILC_RECORDED_BIND_VERTEX_BUFFERS:
+		{
+			const VilcRecordedBindVertexBuffers* command = (const VilcRecordedBindVertexBuffers*)record;
+			vilc_deferredCommandsFlush_next_vkCmdBindVertexBuffers(commandBuffer, command->firstBinding, command->bindingCount,
+			    VILC_DEFERRED_COMMANDS_ARRAY(VkBuffer, command, pBuffers), VILC_DEFERRED_COMMANDS_ARRAY(VkDeviceSize, command, pOffsets));
+			break;
+		}
+		case VILC_RECORDED_SET_VIEWPORT:
+		{
+			const VilcRecordedSetViewport* command = (const VilcRecordedSetViewport*)record;
+			vilc_deferredCommandsFlush_next_vkCmdSetViewport(commandBuffer, command->firstViewport, command->viewportCount,
+			    VILC_DEFERRED_COMMANDS_ARRAY(VkViewport, command, pViewports));
+			break;
+		}
+		case VILC_RECORDED_SET_SCISSOR:
+		{
+			const VilcRecordedSetViewport* command = (const VilcRecordedSetViewport*)record;
+			vilc_deferredCommandsFlush_next_vkCmdSetScissor(commandBuffer, command->firstViewport, command->viewportCount,
+			    VILC_DEFERRED_COMMANDS_ARRAY(VkRect2D, command, pViewports));
+			break;
+		}
+		case VILC_RECORDED_SET_LINE_WIDTH:
+			vilc_deferredCommandsFlush_next_vkCmdSetLineWidth(commandBuffer, ((const VilcRecordedSetLineWidth*)record)->lineWidth);
+			break;
+		case VILC_RECORDED_PUSH_CONSTANTS:
+		{
+			const VilcRecordedPushConstants* command = (const VilcRecordedPushConstants*)record;
+			vilc_deferredCommandsFlush_next_vkCmdPushConstants(commandBuffer, command->layout, command->stageFlags, command->offset, command->size,
+			    VILC_DEFERRED_COMMANDS_ARRAY(void, command, pValues));
+			break;
+		}
+		case VILC_RECORDED_DRAW:
+		{
+			const VilcRecordedDraw* command = (const VilcRecordedDraw*)record;
+			vilc_deferredCommandsFlush_next_vkCmdDraw(commandBuffer, command->vertexCount, command->instanceCount, command->firstVertex, command->firstInstance);
+			break;
+		}
+		case VILC_RECORDED_DRAW_INDEXED:
+		{
+			const VilcRecordedDrawIndexed* command = (const VilcRecordedDrawIndexed*)record;
+			vilc_deferredCommandsFlush_next_vkCmdDrawIndexed(commandBuffer, command->indexCount, command->instanceCount, command->firstIndex, command->vertexOffset,
+			    command->firstInstance);
+			break;
+		}
+		case VILC_RECORDED_DRAW_INDIRECT:
+		{
+			const VilcRecordedDrawIndirect* command = (const VilcRecordedDrawIndirect*)record;
+			vilc_deferredCommandsFlush_next_vkCmdDrawIndirect(commandBuffer, command->buffer, command->offset, command->drawCount, command->stride);
+			break;
+		}
+		case VILC_RECORDED_DRAW_INDEXED_INDIRECT:
+		{
+			const VilcRecordedDrawIndirect* command = (const VilcRecordedDrawIndirect*)record;
+			vilc_deferredCommandsFlush_next_vkCmdDrawIndexedIndirect(commandBuffer, command->buffer, command->offset, command->drawCount, command->stride);
+			break;
+		}
+		case VILC_RECORDED_DISPATCH:
+		{
+			const VilcRecordedDispatch* command = (const VilcRecordedDispatch*)record;
+			vilc_deferredCommandsFlush_next_vkCmdDispatch(commandBuffer, command->groupCountX, command->groupCountY, command->groupCountZ);
+			break;
+		}
+		case VILC_RECORDED_DISPATCH_INDIRECT:
+		{
+			const VilcRecordedDispatchIndirect* command = (const VilcRecordedDispatchIndirect*)record;
+			vilc_deferredCommandsFlush_next_vkCmdDispatchIndirect(commandBuffer, command->buffer, command->offset);
+			break;
+		}
+		case VILC_RECORDED_COPY_BUFFER:
+		{
+			const VilcRecordedCopyBuffer* command = (const VilcRecordedCopyBuffer*)record;
+			vilc_deferredCommandsFlush_next_vkCmdCopyBuffer(commandBuffer, command->srcBuffer, command->dstBuffer, command->regionCount,
+			    VILC_DEFERRED_COMMANDS_ARRAY(VkBufferCopy, command, pRegions));
+			break;
+		}
+		case VILC_RECORDED_UPDATE_BUFFER:
+		{
+			const VilcRecordedUpdateBuffer* command = (const VilcRecordedUpdateBuffer*)record;
+			vilc_deferredCommandsFlush_next_vkCmdUpdateBuffer(commandBuffer, command->dstBuffer, command->dstOffset, command->dataSize,
+			    VILC_DEFERRED_COMMANDS_ARRAY(void, command, pData));
+			break;
+		}
+		case VILC_RECORDED_FILL_BUFFER:
+		{
+			const VilcRecordedFillBuffer* command = (const VilcRecordedFillBuffer*)record;
+			vilc_deferredCommandsFlush_next_vkCmdFillBuffer(commandBuffer, command->dstBuffer, command->dstOffset, command->size, command->data);
+			break;
+		}
+		}
+	}
+}
+
+static void vilc_deferredCommands_flushState(VilcDeferredCommandsCommandBuffer* state)
+{
+	if (!state->size)
+		return;
+
+	if (vilc_deferredCommands_execute && vilc_deferredCommands_direct)
+	{
+		vilc_deferredCommands_execute(state->commandBuffer, state->arena, state->size);
+		VILC_ATOMIC_ADD(&vilc_deferredCommands_executedStreams, 1);
+	}
+	else
+	{
+		vilc_deferredCommands_replay(state->commandBuffer, state->arena, state->size);
+		VILC_ATOMIC_ADD(&vilc_deferredCommands_replayedStreams, 1);
+	}
+	VILC_ATOMIC_ADD(&vilc_deferredCommands_streamBytes, state->size);
+	vilc_deferredCommands_discard(state);
+}
+
+static void vilc_deferredCommands_flush(VkCommandBuffer commandBuffer)
+{
+	VilcDeferredCommandsCommandBuffer* state;
+
+	if (!VILC_ATOMIC_LOAD(&vilc_deferredCommands_pendingCommandBuffers))
+		return;
+
+	state = vilc_deferredCommands_find(commandBuffer);
+	if (state)
+		vilc_deferredCommands_flushState(state);
+}
+
+/* Appends a zeroed record of size bytes, a multiple of 8, to the stream of a recording command buffer; returns NULL
+ * when the command is to be passed on instead, which replays the stream before it
+ */
+static void* vilc_deferredCommands_record(VkCommandBuffer commandBuffer, VilcRecordedCommandType type, size_t size)
+{
+	VilcDeferredCommandsCommandBuffer* state = vilc_deferredCommands_find(commandBuffer);
+	VilcRecordedCommand* record;
+
+	if (!state || !state->recording || size > UINT32_MAX)
+		return NULL;
+
+	if (state->capacity - state->size < size)
+	{
+		size_t capacity = state->capacity ? state->capacity : VILC_DEFERRED_COMMANDS_ARENA_SIZE;
+		unsigned char* arena;
+
+		while (capacity - state->size < size)
+			capacity *= 2;
+		arena = (unsigned char*)realloc(state->arena, capacity);
+		if (!arena)
+			return NULL;
+		state->arena = arena;
+		state->capacity = capacity;
+		VILC_ATOMIC_ADD(&vilc_deferredCommands_arenaAllocations, 1);
+	}
+
+	if (!state->size)
+		VILC_ATOMIC_ADD(&vilc_deferredCommands_pendingCommandBuffers, 1);
+	record = (VilcRecordedCommand*)(state->arena + state->size);
+	state->size += size;
+	memset(record, 0, size);
+	record->type = type;
+	record->size = (uint32_t)size;
+	VILC_ATOMIC_ADD(&vilc_deferredCommands_recordedCommands, 1);
+	return record;
+}
+
+/* Copies an array into a record at *offset, which it advances past the array, and stores the offset in field */
+static void vilc_deferredCommands_copy(void* record, uint32_t* field, size_t* offset, const void* data, size_t size)
+{
+	*field = (uint32_t)*offset;
+	if (size)
+		memcpy((char*)record + *offset, data, size);
+	*offset += VILC_DEFERRED_COMMANDS_ALIGN(size);
+}
+
+void vilcGetDeferredCommandsStats(VilcDeferredCommandsStats* stats)
+{
+	stats->recordedCommands = VILC_ATOMIC_LOAD(&vilc_deferredCommands_recordedCommands);
+	stats->replayedStreams = VILC_ATOMIC_LOAD(&vilc_deferredCommands_replayedStreams);
+	stats->executedStreams = VILC_ATOMIC_LOAD(&vilc_deferredCommands_executedStreams);
+	stats->streamBytes = VILC_ATOMIC_LOAD(&vilc_deferredCommands_streamBytes);
+	stats->arenaAllocations = VILC_ATOMIC_LOAD(&vilc_deferredCommands_arenaAllocations);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_deferredCommands_vkCreateDevice(VkPhysicalDevice physicalDevice, const VkDeviceCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDevice* pDevice)
+{
+	VkResult result = vilc_deferredCommands_next_vkCreateDevice(physicalDevice, pCreateInfo, pAllocator, pDevice);
+
+	if (result == VK_SUCCESS)
+		vilc_deferredCommands_execute = (PFN_vilcCmdExecuteRecordedCommands)vilc_instance.vkGetDeviceProcAddr(*pDevice, VILC_EXECUTE_RECORDED_COMMANDS_NAME);
+	return result;
+}
+
+static void vilc_deferredCommands_freeCommandBuffer(VilcDeferredCommandsCommandBuffer* state)
+{
+	if (state)
+	{
+		vilc_deferredCommands_discard(state);
+		free(state->arena);
+	}
+	free(state);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_deferredCommands_vkDestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator)
+{
+	VilcDeferredCommandsStats stats;
+	uint32_t i;
+
+	pthread_mutex_lock(&vilc_deferredCommands_mutex);
+	for (i = 0; i < vilc_deferredCommands_commandBuffers.capacity; ++i)
+		if (vilc_deferredCommands_commandBuffers.keys[i])
+			vilc_deferredCommands_freeCommandBuffer((VilcDeferredCommandsCommandBuffer*)vilc_deferredCommands_commandBuffers.values[i]);
+	vilc_mapFree(&vilc_deferredCommands_commandBuffers);
+	VILC_ATOMIC_STORE(&vilc_deferredCommands_pendingCommandBuffers, 0);
+	pthread_mutex_unlock(&vilc_deferredCommands_mutex);
+
+	vilcGetDeferredCommandsStats(&stats);
+	fprintf(stderr, "vilc: deferred commands: %llu commands recorded into %llu bytes; %llu streams replayed, %llu executed by the ICD; %llu arena allocations\n",
+	    (unsigned long long)stats.recordedCommands, (unsigned long long)stats.streamBytes, (unsigned long long)stats.replayedStreams,
+	    (unsigned long long)stats.executedStreams, (unsigned long long)stats.arenaAllocations);
+
+	vilc_deferredCommands_next_vkDestroyDevice(device, pAllocator);
+}
+
+/* Drops the stream of a command buffer that is reset, and its memory when the reset releases resources */
+static void vilc_deferredCommands_reset(VilcDeferredCommandsCommandBuffer* state, int release)
+{
+	vilc_deferredCommands_discard(state);
+	state->recording = 0;
+	if (release)
+	{
+		free(state->arena);
+		state->arena = NULL;
+		state->capacity = 0;
+	}
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_deferredCommands_vkDestroyCommandPool(VkDevice device, VkCommandPool commandPool, const VkAllocationCallbacks* pAllocator)
+{
+	uint32_t i = 0;
+
+	pthread_mutex_lock(&vilc_deferredCommands_mutex);
+	/* removal shifts later entries back into the scanned slot, so it is scanned again */
+	while (commandPool && i < vilc_deferredCommands_commandBuffers.capacity)
+	{
+		VilcDeferredCommandsCommandBuffer* state = (VilcDeferredCommandsCommandBuffer*)vilc_deferredCommands_commandBuffers.values[i];
+		if (vilc_deferredCommands_commandBuffers.keys[i] && state->commandPool == commandPool)
+			vilc_deferredCommands_freeCommandBuffer((VilcDeferredCommandsCommandBuffer*)vilc_mapRemove(&vilc_deferredCommands_commandBuffers, vilc_deferredCommands_commandBuffers.keys[i]));
+		else
+			++i;
+	}
+	pthread_mutex_unlock(&vilc_deferredCommands_mutex);
+
+	vilc_deferredCommands_next_vkDestroyCommandPool(device, commandPool, pAllocator);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_deferredCommands_vkResetCommandPool(VkDevice device, VkCommandPool commandPool, VkCommandPoolResetFlags flags)
+{
+	uint32_t i;
+
+	pthread_mutex_lock(&vilc_deferredCommands_mutex);
+	for (i = 0; i < vilc_deferredCommands_commandBuffers.capacity; ++i)
+	{
+		VilcDeferredCommandsCommandBuffer* state = (VilcDeferredCommandsCommandBuffer*)vilc_deferredCommands_commandBuffers.values[i];
+		if (vilc_deferredCommands_commandBuffers.keys[i] && state->commandPool == commandPool)
+			vilc_deferredCommands_reset(state, (flags & VK_COMMAND_POOL_RESET_RELEASE_RESOURCES_BIT) != 0);
+	}
+	pthread_mutex_unlock(&vilc_deferredCommands_mutex);
+
+	return vilc_deferredCommands_next_vkResetCommandPool(device, commandPool, flags);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_deferredCommands_vkAllocateCommandBuffers(VkDevice device, const VkCommandBufferAllocateInfo* pAllocateInfo, VkCommandBuffer* pCommandBuffers)
+{
+	VkResult result = vilc_deferredCommands_next_vkAllocateCommandBuffers(device, pAllocateInfo, pCommandBuffers);
+	uint32_t i;
+
+	if (result != VK_SUCCESS)
+		return result;
+
+	pthread_mutex_lock(&vilc_deferredCommands_mutex);
+	for (i = 0; i < pAllocateInfo->commandBufferCount; ++i)
+	{
+		VilcDeferredCommandsCommandBuffer* state = (VilcDeferredCommandsCommandBuffer*)calloc(1, sizeof(VilcDeferredCommandsCommandBuffer));
+		if (!state)
+			break;
+		state->commandBuffer = pCommandBuffers[i];
+		state->commandPool = pAllocateInfo->commandPool;
+		if (!vilc_mapInsert(&vilc_deferredCommands_commandBuffers, VILC_DISPATCHABLE_KEY(pCommandBuffers[i]), state))
+			free(state);
+	}
+	pthread_mutex_unlock(&vilc_deferredCommands_mutex);
+
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_deferredCommands_vkFreeCommandBuffers(VkDevice device, VkCommandPool commandPool, uint32_t commandBufferCount, const VkCommandBuffer* pCommandBuffers)
+{
+	uint32_t i;
+
+	pthread_mutex_lock(&vilc_deferredCommands_mutex);
+	for (i = 0; i < commandBufferCount; ++i)
+		if (pCommandBuffers[i])
+			vilc_deferredCommands_freeCommandBuffer((VilcDeferredCommandsCommandBuffer*)vilc_mapRemove(&vilc_deferredCommands_commandBuffers, VILC_DISPATCHABLE_KEY(pCommandBuffers[i])));
+	pthread_mutex_unlock(&vilc_deferredCommands_mutex);
+
+	vilc_deferredCommands_next_vkFreeCommandBuffers(device, commandPool, commandBufferCount, pCommandBuffers);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_deferredCommands_vkResetCommandBuffer(VkCommandBuffer commandBuffer, VkCommandBufferResetFlags flags)
+{
+	VilcDeferredCommandsCommandBuffer* state = vilc_deferredCommands_find(commandBuffer);
+
+	if (state)
+		vilc_deferredCommands_reset(state, (flags & VK_COMMAND_BUFFER_RESET_RELEASE_RESOURCES_BIT) != 0);
+	return vilc_deferredCommands_next_vkResetCommandBuffer(commandBuffer, flags);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_deferredCommands_vkBeginCommandBuffer(VkCommandBuffer commandBuffer, const VkCommandBufferBeginInfo* pBeginInfo)
+{
+	VilcDeferredCommandsCommandBuffer* state = vilc_deferredCommands_find(commandBuffer);
+	VkResult result = vilc_deferredCommands_next_vkBeginCommandBuffer(commandBuffer, pBeginInfo);
+
+	/* the commands of a recording that was never ended are dropped with it, which keeps their memory */
+	if (state)
+	{
+		vilc_deferredCommands_discard(state);
+		state->recording = result == VK_SUCCESS;
+	}
+	return result;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_deferredCommands_vkEndCommandBuffer(VkCommandBuffer commandBuffer)
+{
+	VilcDeferredCommandsCommandBuffer* state = vilc_deferredCommands_find(commandBuffer);
+
+	if (state)
+	{
+		vilc_deferredCommands_flushState(state);
+		state->recording = 0;
+	}
+	return vilc_deferredCommands_next_vkEndCommandBuffer(commandBuffer);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_deferredCommands_vkCmdBindPipeline(VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipeline pipeline)
+{
+	VilcRecordedBindPipeline* record = (VilcRecordedBindPipeline*)vilc_deferredCommands_record(commandBuffer, VILC_RECORDED_BIND_PIPELINE,
+	    VILC_DEFERRED_COMMANDS_ALIGN(sizeof(VilcRecordedBindPipeline)));
+
+	if (!record)
+	{
+		vilc_deferredCommands_next_vkCmdBindPipeline(commandBuffer, pipelineBindPoint, pipeline);
+		return;
+	}
+
+	record->pipelineBindPoint = pipelineBindPoint;
+	record->pipeline = pipeline;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_deferredCommands_vkCmdBindDescriptorSets(VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout, uint32_t firstSet, uint32_t descriptorSetCount, const VkDescriptorSet* pDescriptorSets, uint32_t dynamicOffsetCount, const uint32_t* pDynamicOffsets)
+{
+	size_t offset = VILC_DEFERRED_COMMANDS_ALIGN(sizeof(VilcRecordedBindDescriptorSets));
+	VilcRecordedBindDescriptorSets* record = (VilcRecordedBindDescriptorSets*)vilc_deferredCommands_record(commandBuffer, VILC_RECORDED_BIND_DESCRIPTOR_SETS,
+	    offset + VILC_DEFERRED_COMMANDS_ALIGN(descriptorSetCount * sizeof(VkDescriptorSet)) + VILC_DEFERRED_COMMANDS_ALIGN(dynamicOffsetCount * sizeof(uint32_t)));
+
+	if (!record)
+	{
+		vilc_deferredCommands_next_vkCmdBindDescriptorSets(commandBuffer, pipelineBindPoint, layout, firstSet, descriptorSetCount, pDescriptorSets, dynamicOffsetCount,
+		    pDynamicOffsets);
+		return;
+	}
+
+	record->pipelineBindPoint = pipelineBindPoint;
+	record->layout = layout;
+	record->firstSet = firstSet;
+	record->descriptorSetCount = descriptorSetCount;
+	record->dynamicOffsetCount = dynamicOffsetCount;
+	vilc_deferredCommands_copy(record, &record->pDescriptorSets, &offset, pDescriptorSets, descriptorSetCount * sizeof(VkDescriptorSet));
+	vilc_deferredCommands_copy(record, &record->pDynamicOffsets, &offset, pDynamicOffsets, dynamicOffsetCount * sizeof(uint32_t));
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_deferredCommands_vkCmdBindIndexBuffer(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkIndexType indexType)
+{
+	VilcRecordedBindIndexBuffer* record = (VilcRecordedBindIndexBuffer*)vilc_deferredCommands_record(commandBuffer, VILC_RECORDED_BIND_INDEX_BUFFER,
+	    VILC_DEFERRED_COMMANDS_ALIGN(sizeof(VilcRecordedBindIndexBuffer)));
+
+	if (!record)
+	{
+		vilc_deferredCommands_next_vkCmdBindIndexBuffer(commandBuffer, buffer, offset, indexType);
+		return;
+	}
+
+	record->buffer = buffer;
+	record->offset = offset;
+	record->indexType = indexType;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_deferredCommands_vkCmdBindVertexBuffers(VkCommandBuffer commandBuffer, uint32_t firstBinding, uint32_t bindingCount, const VkBuffer* pBuffers, const VkDeviceSize* pOffsets)
+{
+	size_t offset = VILC_DEFERRED_COMMANDS_ALIGN(sizeof(VilcRecordedBindVertexBuffers));
+	VilcRecordedBindVertexBuffers* record = (VilcRecordedBindVertexBuffers*)vilc_deferredCommands_record(commandBuffer, VILC_RECORDED_BIND_VERTEX_BUFFERS,
+	    offset + VILC_DEFERRED_COMMANDS_ALIGN(bindingCount * sizeof(VkBuffer)) + VILC_DEFERRED_COMMANDS_ALIGN(bindingCount * sizeof(VkDeviceSize)));
+
+	if (!record)
+	{
+		vilc_deferredCommands_next_vkCmdBindVertexBuffers(commandBuffer, firstBinding, bindingCount, pBuffers, pOffsets);
+		return;
+	}
+
+	record->firstBinding = firstBinding;
+	record->bindingCount = bindingCount;
+	vilc_deferredCommands_copy(record, &record->pBuffers, &offset, pBuffers, bindingCount * sizeof(VkBuffer));
+	vilc_deferredCommands_copy(record, &record->pOffsets, &offset, pOffsets, bindingCount * sizeof(VkDeviceSize));
+}
+
+/* Viewports and scissors share the record layout */
+static int vilc_deferredCommands_recordRectangles(VkCommandBuffer commandBuffer, VilcRecordedCommandType type, uint32_t first, uint32_t count, const void* data, size_t elementSize)
+{
+	size_t offset = VILC_DEFERRED_COMMANDS_ALIGN(sizeof(VilcRecordedSetViewport));
+	VilcRecordedSetViewport* record = (VilcRecordedSetViewport*)vilc_deferredCommands_record(commandBuffer, type, offset + VILC_DEFERRED_COMMANDS_ALIGN(count * elementSize));
+
+	if (!record)
+		return 0;
+
+	record->firstViewport = first;
+	record->viewportCount = count;
+	vilc_deferredCommands_copy(record, &record->pViewports, &offset, data, count * elementSize);
+	return 1;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_deferredCommands_vkCmdSetViewport(VkCommandBuffer commandBuffer, uint32_t firstViewport, uint32_t viewportCount, const VkViewport* pViewports)
+{
+	if (!vilc_deferredCommands_recordRectangles(commandBuffer, VILC_RECORDED_SET_VIEWPORT, firstViewport, viewportCount, pViewports, sizeof(VkViewport)))
+		vilc_deferredCommands_next_vkCmdSetViewport(commandBuffer, firstViewport, viewportCount, pViewports);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_deferredCommands_vkCmdSetScissor(VkCommandBuffer commandBuffer, uint32_t firstScissor, uint32_t scissorCount, const VkRect2D* pScissors)
+{
+	if (!vilc_deferredCommands_recordRectangles(commandBuffer, VILC_RECORDED_SET_SCISSOR, firstScissor, scissorCount, pScissors, sizeof(VkRect2D)))
+		vilc_deferredCommands_next_vkCmdSetScissor(commandBuffer, firstScissor, scissorCount, pScissors);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_deferredCommands_vkCmdSetLineWidth(VkCommandBuffer commandBuffer, float lineWidth)
+{
+	VilcRecordedSetLineWidth* record = (VilcRecordedSetLineWidth*)vilc_deferredCommands_record(commandBuffer, VILC_RECORDED_SET_LINE_WIDTH,
+	    VILC_DEFERRED_COMMANDS_ALIGN(sizeof(VilcRecordedSetLineWidth)));
+
+	if (!record)
+	{
+		vilc_deferredCommands_next_vkCmdSetLineWidth(commandBuffer, lineWidth);
+		return;
+	}
+
+	record->lineWidth = lineWidth;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_deferredCommands_vkCmdPushConstants(VkCommandBuffer commandBuffer, VkPipelineLayout layout, VkShaderStageFlags stageFlags, uint32_t offset, uint32_t size, const void* pValues)
+{
+	size_t valuesOffset = VILC_DEFERRED_COMMANDS_ALIGN(sizeof(VilcRecordedPushConstants));
+	VilcRecordedPushConstants* record = (VilcRecordedPushConstants*)vilc_deferredCommands_record(commandBuffer, VILC_RECORDED_PUSH_CONSTANTS,
+	    valuesOffset + VILC_DEFERRED_COMMANDS_ALIGN(size));
+
+	if (!record)
+	{
+		vilc_deferredCommands_next_vkCmdPushConstants(commandBuffer, layout, stageFlags, offset, size, pValues);
+		return;
+	}
+
+	record->layout = layout;
+	record->stageFlags = stageFlags;
+	record->offset = offset;
+	record->size = size;
+	vilc_deferredCommands_copy(record, &record->pValues, &valuesOffset, pValues, size);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_deferredCommands_vkCmdDraw(VkCommandBuffer commandBuffer, uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance)
+{
+	VilcRecordedDraw* record = (VilcRecordedDraw*)vilc_deferredCommands_record(commandBuffer, VILC_RECORDED_DRAW, VILC_DEFERRED_COMMANDS_ALIGN(sizeof(VilcRecordedDraw)));
+
+	if (!record)
+	{
+		vilc_deferredCommands_next_vkCmdDraw(commandBuffer, vertexCount, instanceCount, firstVertex, firstInstance);
+		return;
+	}
+
+	record->vertexCount = vertexCount;
+	record->instanceCount = instanceCount;
+	record->firstVertex = firstVertex;
+	record->firstInstance = firstInstance;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_deferredCommands_vkCmdDrawIndexed(VkCommandBuffer commandBuffer, uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance)
+{
+	VilcRecordedDrawIndexed* record = (VilcRecordedDrawIndexed*)vilc_deferredCommands_record(commandBuffer, VILC_RECORDED_DRAW_INDEXED,
+	    VILC_DEFERRED_COMMANDS_ALIGN(sizeof(VilcRecordedDrawIndexed)));
+
+	if (!record)
+	{
+		vilc_deferredCommands_next_vkCmdDrawIndexed(commandBuffer, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+		return;
+	}
+
+	record->indexCount = indexCount;
+	record->instanceCount = instanceCount;
+	record->firstIndex = firstIndex;
+	record->vertexOffset = vertexOffset;
+	record->firstInstance = firstInstance;
+}
+
+static int vilc_deferredCommands_recordDrawIndirect(VkCommandBuffer commandBuffer, VilcRecordedCommandType type, VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride)
+{
+	VilcRecordedDrawIndirect* record = (VilcRecordedDrawIndirect*)vilc_deferredCommands_record(commandBuffer, type, VILC_DEFERRED_COMMANDS_ALIGN(sizeof(VilcRecordedDrawIndirect)));
+
+	if (!record)
+		return 0;
+
+	record->buffer = buffer;
+	record->offset = offset;
+	record->drawCount = drawCount;
+	record->stride = stride;
+	return 1;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_deferredCommands_vkCmdDrawIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride)
+{
+	if (!vilc_deferredCommands_recordDrawIndirect(commandBuffer, VILC_RECORDED_DRAW_INDIRECT, buffer, offset, drawCount, stride))
+		vilc_deferredCommands_next_vkCmdDrawIndirect(commandBuffer, buffer, offset, drawCount, stride);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_deferredCommands_vkCmdDrawIndexedIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride)
+{
+	if (!vilc_deferredCommands_recordDrawIndirect(commandBuffer, VILC_RECORDED_DRAW_INDEXED_INDIRECT, buffer, offset, drawCount, stride))
+		vilc_deferredCommands_next_vkCmdDrawIndexedIndirect(commandBuffer, buffer, offset, drawCount, stride);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_deferredCommands_vkCmdDispatch(VkCommandBuffer commandBuffer, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+{
+	VilcRecordedDispatch* record = (VilcRecordedDispatch*)vilc_deferredCommands_record(commandBuffer, VILC_RECORDED_DISPATCH, VILC_DEFERRED_COMMANDS_ALIGN(sizeof(VilcRecordedDispatch)));
+
+	if (!record)
+	{
+		vilc_deferredCommands_next_vkCmdDispatch(commandBuffer, groupCountX, groupCountY, groupCountZ);
+		return;
+	}
+
+	record->groupCountX = groupCountX;
+	record->groupCountY = groupCountY;
+	record->groupCountZ = groupCountZ;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_deferredCommands_vkCmdDispatchIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset)
+{
+	VilcRecordedDispatchIndirect* record = (VilcRecordedDispatchIndirect*)vilc_deferredCommands_record(commandBuffer, VILC_RECORDED_DISPATCH_INDIRECT,
+	    VILC_DEFERRED_COMMANDS_ALIGN(sizeof(VilcRecordedDispatchIndirect)));
+
+	if (!record)
+	{
+		vilc_deferredCommands_next_vkCmdDispatchIndirect(commandBuffer, buffer, offset);
+		return;
+	}
+
+	record->buffer = buffer;
+	record->offset = offset;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_deferredCommands_vkCmdCopyBuffer(VkCommandBuffer commandBuffer, VkBuffer srcBuffer, VkBuffer dstBuffer, uint32_t regionCount, const VkBufferCopy* pRegions)
+{
+	size_t offset = VILC_DEFERRED_COMMANDS_ALIGN(sizeof(VilcRecordedCopyBuffer));
+	VilcRecordedCopyBuffer* record = (VilcRecordedCopyBuffer*)vilc_deferredCommands_record(commandBuffer, VILC_RECORDED_COPY_BUFFER,
+	    offset + VILC_DEFERRED_COMMANDS_ALIGN(regionCount * sizeof(VkBufferCopy)));
+
+	if (!record)
+	{
+		vilc_deferredCommands_next_vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, regionCount, pRegions);
+		return;
+	}
+
+	record->srcBuffer = srcBuffer;
+	record->dstBuffer = dstBuffer;
+	record->regionCount = regionCount;
+	vilc_deferredCommands_copy(record, &record->pRegions, &offset, pRegions, regionCount * sizeof(VkBufferCopy));
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_deferredCommands_vkCmdUpdateBuffer(VkCommandBuffer commandBuffer, VkBuffer dstBuffer, VkDeviceSize dstOffset, VkDeviceSize dataSize, const void* pData)
+{
+	size_t offset = VILC_DEFERRED_COMMANDS_ALIGN(sizeof(VilcRecordedUpdateBuffer));
+	/* dataSize is at most 65536 */
+	VilcRecordedUpdateBuffer* record = dataSize > 65536 ? NULL : (VilcRecordedUpdateBuffer*)vilc_deferredCommands_record(commandBuffer, VILC_RECORDED_UPDATE_BUFFER,
+	    offset + VILC_DEFERRED_COMMANDS_ALIGN(dataSize));
+
+	if (!record)
+	{
+		vilc_deferredCommands_next_vkCmdUpdateBuffer(commandBuffer, dstBuffer, dstOffset, dataSize, pData);
+		return;
+	}
+
+	record->dstBuffer = dstBuffer;
+	record->dstOffset = dstOffset;
+	record->dataSize = dataSize;
+	vilc_deferredCommands_copy(record, &record->pData, &offset, pData, (size_t)dataSize);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_deferredCommands_vkCmdFillBuffer(VkCommandBuffer commandBuffer, VkBuffer dstBuffer, VkDeviceSize dstOffset, VkDeviceSize size, uint32_t data)
+{
+	VilcRecordedFillBuffer* record = (VilcRecordedFillBuffer*)vilc_deferredCommands_record(commandBuffer, VILC_RECORDED_FILL_BUFFER,
+	    VILC_DEFERRED_COMMANDS_ALIGN(sizeof(VilcRecordedFillBuffer)));
+
+	if (!record)
+	{
+		vilc_deferredCommands_next_vkCmdFillBuffer(commandBuffer, dstBuffer, dstOffset, size, data);
+		return;
+	}
+
+	record->dstBuffer = dstBuffer;
+	record->dstOffset = dstOffset;
+	record->size = size;
+	record->data = data;
+}
+
+#if defined(VK_EXT_debug_utils)
+VILC_LAYER_NEXT(vilc_deferredCommands, vkCmdBeginDebugUtilsLabelEXT)
+VILC_LAYER_NEXT(vilc_deferredCommands, vkCmdEndDebugUtilsLabelEXT)
+VILC_LAYER_NEXT(vilc_deferredCommands, vkCmdInsertDebugUtilsLabelEXT)
+
+/* Labels are loaded with the instance, so they are not in the flush layer; commands stay inside the labels they were in */
+static VKAPI_ATTR void VKAPI_CALL vilc_deferredCommands_vkCmdBeginDebugUtilsLabelEXT(VkCommandBuffer commandBuffer, const VkDebugUtilsLabelEXT* pLabelInfo)
+{
+	vilc_deferredCommands_flush(commandBuffer);
+	vilc_deferredCommands_next_vkCmdBeginDebugUtilsLabelEXT(commandBuffer, pLabelInfo);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_deferredCommands_vkCmdEndDebugUtilsLabelEXT(VkCommandBuffer commandBuffer)
+{
+	vilc_deferredCommands_flush(commandBuffer);
+	vilc_deferredCommands_next_vkCmdEndDebugUtilsLabelEXT(commandBuffer);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_deferredCommands_vkCmdInsertDebugUtilsLabelEXT(VkCommandBuffer commandBuffer, const VkDebugUtilsLabelEXT* pLabelInfo)
+{
+	vilc_deferredCommands_flush(commandBuffer);
+	vilc_deferredCommands_next_vkCmdInsertDebugUtilsLabelEXT(commandBuffer, pLabelInfo);
+}
+#endif /* defined(VK_EXT_debug_utils) */
+
+static void vilc_deferredCommands_installInstance(void)
+{
+	VILC_LAYER_HOOK(vilc_deferredCommands, vkCreateDevice)
+#if defined(VK_EXT_debug_utils)
+	VILC_LAYER_HOOK(vilc_deferredCommands, vkCmdBeginDebugUtilsLabelEXT)
+	VILC_LAYER_HOOK(vilc_deferredCommands, vkCmdEndDebugUtilsLabelEXT)
+	VILC_LAYER_HOOK(vilc_deferredCommands, vkCmdInsertDebugUtilsLabelEXT)
+#endif
+}
+
+static void vilc_deferredCommands_installDevice(void)
+{
+	/* streams bypass the modes installed so far when they go to the ICD, so that is only done while none of them
+	 * intercepts a recorded command
+	 */
+	vilc_deferredCommands_direct = 1;
+#define VILC_DEFERRED_COMMANDS_DIRECT(name) vilc_deferredCommands_direct &= vilc_##name == vilc_device.name;
+	VILC_DEFERRED_COMMANDS_RECORDED(VILC_DEFERRED_COMMANDS_DIRECT)
+#undef VILC_DEFERRED_COMMANDS_DIRECT
+
+#define VILC_DEFERRED_COMMANDS_FLUSH_HOOK(name, params, args) VILC_LAYER_HOOK(vilc_deferredCommandsFlush, name)
+	VILC_DEVICE_COMMANDS(VILC_DEFERRED_COMMANDS_FLUSH_HOOK, VILC_DEFERRED_COMMANDS_FLUSH_HOOK)
+#undef VILC_DEFERRED_COMMANDS_FLUSH_HOOK
+
+	VILC_LAYER_HOOK(vilc_deferredCommands, vkDestroyDevice)
+	VILC_LAYER_HOOK(vilc_deferredCommands, vkDestroyCommandPool)
+	VILC_LAYER_HOOK(vilc_deferredCommands, vkResetCommandPool)
+	VILC_LAYER_HOOK(vilc_deferredCommands, vkAllocateCommandBuffers)
+	VILC_LAYER_HOOK(vilc_deferredCommands, vkFreeCommandBuffers)
+	VILC_LAYER_HOOK(vilc_deferredCommands, vkResetCommandBuffer)
+	VILC_LAYER_HOOK(vilc_deferredCommands, vkBeginCommandBuffer)
+	VILC_LAYER_HOOK(vilc_deferredCommands, vkEndCommandBuffer)
+#define VILC_DEFERRED_COMMANDS_HOOK(name) VILC_LAYER_HOOK(vilc_deferredCommands, name)
+	VILC_DEFERRED_COMMANDS_RECORDED(VILC_DEFERRED_COMMANDS_HOOK)
+#undef VILC_DEFERRED_COMMANDS_HOOK
+}
+#endif /* VILC_DEFERRED_COMMANDS */
+
+#if defined(VOLK_IN_LOADERS_CLOTH) && defined(VILC_SUBMIT_THREAD)
+/* Submission thread: vkQueueSubmit(2) and vkQueuePresentKHR calls are deep-copied into a single-producer ring per
+ * VkQueue and return right away, while a thread per queue makes the driver calls in order. The modes installed under
+ * this one run on that thread too. A call that waits on semaphores is only made once the calls queued on other queues
+ * before it have been made, so binary semaphores still reach the driver signaled before they are waited on.
+ * Fence, semaphore and idle waits, vkDestroySwapchainKHR and the other queue calls drain the rings first. Results the
+ * driver returns after the call has returned are reported by the next call on the queue: errors by any submit,
+ * present or queue wait, and present results such as VK_SUBOPTIMAL_KHR by the next present. Calls with pNext chains
+ * that are not known here and presents with pResults are made from the calling thread once all rings are drained.
+ */
+#define VILC_SUBMIT_THREAD_MAX_QUEUES 64
+#define VILC_SUBMIT_THREAD_RING_SIZE 16
+/* Copies up to this size are kept in the ring slot; larger ones are allocated */
+#define VILC_SUBMIT_THREAD_INLINE_SIZE 1024
+
+typedef enum VilcSubmitThreadCall
+{
+	VILC_SUBMIT_THREAD_SUBMIT,
+	VILC_SUBMIT_THREAD_SUBMIT2,
+	VILC_SUBMIT_THREAD_SUBMIT2_KHR,
+	VILC_SUBMIT_THREAD_PRESENT
+} VilcSubmitThreadCall;
+
+typedef struct VilcSubmitThreadItem
+{
+	VilcSubmitThreadCall call;
+	uint32_t count;
+	VkFence fence;
+	void* infos; /* the copied VkSubmitInfo or VkSubmitInfo2 array, or VkPresentInfoKHR */
+	void* allocation; /* holds the copy when it does not fit into storage */
+	const uint64_t* waitFor; /* queued counts of the first waitForCount queues to wait for */
+	uint32_t waitForCount;
+	uint64_t enqueued; /* CLOCK_MONOTONIC nanoseconds at the call */
+	uint64_t storage[VILC_SUBMIT_THREAD_INLINE_SIZE / sizeof(uint64_t)];
+} VilcSubmitThreadItem;
+
+typedef struct VilcSubmitThreadQueue
+{
+	VkQueue queue;
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t work;
+	pthread_cond_t done;
+	uint32_t head; /* advanced by the thread with the mutex held, as is completed */
+	uint32_t tail; /* advanced by the calling thread, as is queued */
+	uint64_t queued;
+	uint64_t completed;
+	int sleeping;
+	int stop;
+	VkResult result; /* first error not reported yet; written with the mutex held, as is presentResult */
+	VkResult presentResult;
+	VilcSubmitThreadItem ring[VILC_SUBMIT_THREAD_RING_SIZE];
+} VilcSubmitThreadQueue;
+
+/* Queues are appended with vilc_submitThread_mutex held and published through vilc_submitThread_queueCount */
+static pthread_mutex_t vilc_submitThread_mutex = PTHREAD_MUTEX_INITIALIZER;
+static VilcSubmitThreadQueue* vilc_submitThread_queues[VILC_SUBMIT_THREAD_MAX_QUEUES];
+static uint32_t vilc_submitThread_queueCount;
+static VilcSubmitThreadStats vilc_submitThread_stats;
+
+VILC_LAYER_NEXT(vilc_submitThread, vkDestroyDevice)
+VILC_LAYER_NEXT(vilc_submitThread, vkQueueSubmit)
+VILC_LAYER_NEXT(vilc_submitThread, vkQueueWaitIdle)
+VILC_LAYER_NEXT(vilc_submitThread, vkQueueBindSparse)
+VILC_LAYER_NEXT(vilc_submitThread, vkDeviceWaitIdle)
+VILC_LAYER_NEXT(vilc_submitThread, vkWaitForFences)
+#if defined(VK_VERSION_1_2)
+VILC_LAYER_NEXT(vilc_submitThread, vkWaitSemaphores)
+#endif
+#if defined(VK_VERSION_1_3)
+VILC_LAYER_NEXT(vilc_submitThread, vkQueueSubmit2)
+#endif
+#if defined(VK_KHR_synchronization2)
+VILC_LAYER_NEXT(vilc_submitThread, vkQueueSubmit2KHR)
+#endif
+#if defined(VK_KHR_timeline_semaphore)
+VILC_LAYER_NEXT(vilc_submitThread, vkWaitSemaphoresKHR)
+#endif
+#if defined(VK_KHR_swapchain)
+VILC_LAYER_NEXT(vilc_submitThread, vkQueuePresentKHR)
+VILC_LAYER_NEXT(vilc_submitThread, vkDestroySwapchainKHR)
+#endif
+#if defined(VK_EXT_debug_utils)
+VILC_LAYER_NEXT(vilc_submitThread, vkQueueBeginDebugUtilsLabelEXT)
+VILC_LAYER_NEXT(vilc_submitThread, vkQueueEndDebugUtilsLabelEXT)
+VILC_LAYER_NEXT(vilc_submitThread, vkQueueInsertDebugUtilsLabelEXT)
+#endif
+
+/* Waits until the driver was called for the first count calls queued on the queue; returns 1 if it had to wait */
+static int vilc_submitThread_wait(VilcSubmitThreadQueue* state, uint64_t count)
+{
+	if (VILC_ATOMIC_LOAD_ACQUIRE(&state->completed) >= count)
+		return 0;
+
+	pthread_mutex_lock(&state->mutex);
+	while (state->completed < count)
+		pthread_cond_wait(&state->done, &state->mutex);
+	pthread_mutex_unlock(&state->mutex);
+	return 1;
+}
+
+static void vilc_submitThread_drain(VilcSubmitThreadQueue* state)
+{
+	if (state && vilc_submitThread_wait(state, VILC_ATOMIC_LOAD(&state->queued)))
+		VILC_ATOMIC_ADD(&vilc_submitThread_stats.drains, 1);
+}
+
+static void vilc_submitThread_drainAll(void)
+{
+	uint32_t count = VILC_ATOMIC_LOAD_ACQUIRE(&vilc_submitThread_queueCount), i;
+
+	for (i = 0; i < count; ++i)
+		vilc_submitThread_drain(vilc_submitThread_queues[i]);
+}
+
+/* Drains all rings before a queue call is made from the calling thread; any of them may hold the semaphore signals
+ * the call waits on
+ */
+static void vilc_submitThread_passThrough(void)
+{
+	vilc_submitThread_drainAll();
+	VILC_ATOMIC_ADD(&vilc_submitThread_stats.passedThroughCalls, 1);
+}
+
+/* Returns the first error reported for the calls queued on the queue since the last one returned, then the first
+ * present result when the call is a present
+ */
+static VkResult vilc_submitThread_result(VilcSubmitThreadQueue* state, int present)
+{
+	VkResult result;
+
+	if (!state || (VILC_ATOMIC_LOAD(&state->result) == VK_SUCCESS && (!present || VILC_ATOMIC_LOAD(&state->presentResult) == VK_SUCCESS)))
+		return VK_SUCCESS;
+
+	pthread_mutex_lock(&state->mutex);
+	result = state->result;
+	VILC_ATOMIC_STORE(&state->result, VK_SUCCESS);
+	if (present && result == VK_SUCCESS)
+	{
+		result = state->presentResult;
+		VILC_ATOMIC_STORE(&state->presentResult, VK_SUCCESS);
+	}
+	pthread_mutex_unlock(&state->mutex);
+
+	return result;
+}
+
+/* Copies a call into the ring of the queue; returns 0 when it has to be made from the calling thread instead */
+static int vilc_submitThread_push(VilcSubmitThreadQueue* state, VilcSubmitThreadCall call, const void* infos, uint32_t count, VkFence fence, int waits, uint64_t start)
+{
+	uint64_t waitFor[VILC_SUBMIT_THREAD_MAX_QUEUES];
+	size_t size = vilc_submitCopyMeasure(infos, count);
+	uint32_t tail = VILC_ATOMIC_LOAD(&state->tail), waitForCount = 0, i;
+	VilcSubmitThreadItem* item;
+	char* arena;
+
+	if (size == VILC_SUBMIT_COPY_NONE)
+		return 0;
+
+	/* the other queues are counted before this call is, so no two calls can end up waiting for each other */
+	if (waits)
+	{
+		waitForCount = VILC_ATOMIC_LOAD_ACQUIRE(&vilc_submitThread_queueCount);
+		for (i = 0; i < waitForCount; ++i)
+			waitFor[i] = vilc_submitThread_queues[i] == state ? 0 : VILC_ATOMIC_LOAD_SEQ_CST(&vilc_submitThread_queues[i]->queued);
+		size += waitForCount * sizeof(uint64_t);
+	}
+
+	if (tail - VILC_ATOMIC_LOAD_ACQUIRE(&state->head) == VILC_SUBMIT_THREAD_RING_SIZE)
+	{
+		VILC_ATOMIC_ADD(&vilc_submitThread_stats.ringFullWaits, 1);
+		pthread_mutex_lock(&state->mutex);
+		while (tail - state->head == VILC_SUBMIT_THREAD_RING_SIZE)
+			pthread_cond_wait(&state->done, &state->mutex);
+		pthread_mutex_unlock(&state->mutex);
+	}
+
+	item = &state->ring[tail % VILC_SUBMIT_THREAD_RING_SIZE];
+	item->allocation = size > sizeof(item->storage) ? malloc(size) : NULL;
+	if (size > sizeof(item->storage) && !item->allocation)
+		return 0;
+	arena = item->allocation ? (char*)item->allocation : (char*)item->storage;
+
+	item->call = call;
+	item->count = count;
+	item->fence = fence;
+	item->infos = count ? vilc_submitCopy(infos, count, &arena) : NULL;
+	item->waitFor = (const uint64_t*)arena;
+	item->waitForCount = waitForCount;
+	memcpy(arena, waitFor, waitForCount * sizeof(uint64_t));
+	item->enqueued = start;
+
+	VILC_ATOMIC_STORE_SEQ_CST(&state->queued, VILC_ATOMIC_LOAD(&state->queued) + 1);
+	VILC_ATOMIC_STORE_SEQ_CST(&state->tail, tail + 1);
+
+	/* the thread sets sleeping before it checks tail a last time, so it either sees the item or gets signaled */
+	if (VILC_ATOMIC_LOAD_SEQ_CST(&state->sleeping))
+	{
+		pthread_mutex_lock(&state->mutex);
+		pthread_cond_signal(&state->work);
+		pthread_mutex_unlock(&state->mutex);
+	}
+
+	vilc_histogramRecord(&vilc_submitThread_stats.callerTime, vilc_monotonicNow() - start);
+	return 1;
+}
+
+static VkResult vilc_submitThread_call(VkQueue queue, const VilcSubmitThreadItem* item)
+{
+	switch (item->call)
+	{
+#if defined(VK_VERSION_1_3)
+	case VILC_SUBMIT_THREAD_SUBMIT2:
+		return vilc_submitThread_next_vkQueueSubmit2(queue, item->count, (const VkSubmitInfo2*)item->infos, item->fence);
+#endif /* defined(VK_VERSION_1_3) */
+#if defined(VK_KHR_synchronization2)
+	case VILC_SUBMIT_THREAD_SUBMIT2_KHR:
+		return vilc_submitThread_next_vkQueueSubmit2KHR(queue, item->count, (const VkSubmitInfo2*)item->infos, item->fence);
+#endif /* defined(VK_KHR_synchronization2) */
+#if defined(VK_KHR_swapchain)
+	case VILC_SUBMIT_THREAD_PRESENT:
+		return vilc_submitThread_next_vkQueuePresentKHR(queue, (const VkPresentInfoKHR*)item->infos);
+#endif /* defined(VK_KHR_swapchain) */
+	default:
+		return vilc_submitThread_next_vkQueueSubmit(queue, item->count, (const VkSubmitInfo*)item->infos, item->fence);
+	}
+}
+
+static void* vilc_submitThread_run(void* context)
+{
+	VilcSubmitThreadQueue* state = (VilcSubmitThreadQueue*)context;
+	VilcSubmitThreadItem* item;
+	uint64_t start, end;
+	uint32_t head = 0, i;
+	VkResult result;
+	int stop = 0;
+
+	while (!stop)
+	{
+		if (head == VILC_ATOMIC_LOAD_ACQUIRE(&state->tail))
+		{
+			pthread_mutex_lock(&state->mutex);
+			VILC_ATOMIC_STORE_SEQ_CST(&state->sleeping, 1);
+			while (!state->stop && head == VILC_ATOMIC_LOAD_SEQ_CST(&state->tail))
+				pthread_cond_wait(&state->work, &state->mutex);
+			VILC_ATOMIC_STORE(&state->sleeping, 0);
+			stop = state->stop && head == VILC_ATOMIC_LOAD_ACQUIRE(&state->tail);
+			pthread_mutex_unlock(&state->mutex);
+			continue;
+		}
+
+		item = &state->ring[head % VILC_SUBMIT_THREAD_RING_SIZE];
+		for (i = 0; i < item->waitForCount; ++i)
+			vilc_submitThread_wait(vilc_submitThread_queues[i], item->waitFor[i]);
+
+		start = vilc_monotonicNow();
+		result = vilc_submitThread_call(state->queue, item);
+		end = vilc_monotonicNow();
+
+		vilc_histogramRecord(&vilc_submitThread_stats.queueLatency, start - item->enqueued);
+		vilc_histogramRecord(&vilc_submitThread_stats.driverTime, end - start);
+		VILC_ATOMIC_ADD(item->call == VILC_SUBMIT_THREAD_PRESENT ? &vilc_submitThread_stats.queuedPresents : &vilc_submitThread_stats.queuedSubmits, 1);
+		free(item->allocation);
+
+		pthread_mutex_lock(&state->mutex);
+		/* errors a submit can return too are reported by any call, the others only by the next present */
+		if (item->call == VILC_SUBMIT_THREAD_PRESENT && result != VK_ERROR_OUT_OF_HOST_MEMORY && result != VK_ERROR_OUT_OF_DEVICE_MEMORY &&
+		    result != VK_ERROR_DEVICE_LOST)
+		{
+			if (state->presentResult == VK_SUCCESS || (state->presentResult > 0 && result < 0))
+				VILC_ATOMIC_STORE(&state->presentResult, result);
+		}
+		else if (state->result == VK_SUCCESS)
+			VILC_ATOMIC_STORE(&state->result, result);
+		VILC_ATOMIC_STORE_RELEASE(&state->head, ++head);
+		VILC_ATOMIC_STORE_RELEASE(&state->completed, state->completed + 1);
+		pthread_cond_broadcast(&state->done);
+		pthread_mutex_unlock(&state->mutex);
+	}
+
+	return NULL;
+}
+
+/* Returns the state of a queue, starting its thread on the first call when create is set; NULL when the queue has
+ * none, or when no more threads can be started
+ */
+static VilcSubmitThreadQueue* vilc_submitThread_queue(VkQueue queue, int create)
+{
+	uint32_t count = VILC_ATOMIC_LOAD_ACQUIRE(&vilc_submitThread_queueCount), i;
+	VilcSubmitThreadQueue* state = NULL;
+
+	for (i = 0; i < count; ++i)
+		if (vilc_submitThread_queues[i]->queue == queue)
+			return vilc_submitThread_queues[i];
+	if (!create)
+		return NULL;
+
+	pthread_mutex_lock(&vilc_submitThread_mutex);
+	count = vilc_submitThread_queueCount;
+	for (i = 0; i < count && !state; ++i)
+		if (vilc_submitThread_queues[i]->queue == queue)
+			state = vilc_submitThread_queues[i];
+
+	if (!state && count < VILC_SUBMIT_THREAD_MAX_QUEUES && (state = (VilcSubmitThreadQueue*)calloc(1, sizeof(VilcSubmitThreadQueue))) != NULL)
+	{
+		state->queue = queue;
+		pthread_mutex_init(&state->mutex, NULL);
+		pthread_cond_init(&state->work, NULL);
+		pthread_cond_init(&state->done, NULL);
+		if (pthread_create(&state->thread, NULL, vilc_submitThread_run, state) == 0)
+		{
+			vilc_submitThread_queues[count] = state;
+			VILC_ATOMIC_STORE_RELEASE(&vilc_submitThread_queueCount, count + 1);
+			vilc_submitThread_stats.threads++;
+		}
+		else
+		{
+			pthread_cond_destroy(&state->done);
+			pthread_cond_destroy(&state->work);
+			pthread_mutex_destroy(&state->mutex);
+			free(state);
+			state = NULL;
+		}
+	}
+	pthread_mutex_unlock(&vilc_submitThread_mutex);
+
+	return state;
+}
+
+/* The rings are empty once each thread stops, so the calls made before vkDestroyDevice all reach the driver */
+static void vilc_submitThread_stopThreads(void)
+{
+	uint32_t i;
+
+	pthread_mutex_lock(&vilc_submitThread_mutex);
+	for (i = 0; i < vilc_submitThread_queueCount; ++i)
+	{
+		VilcSubmitThreadQueue* state = vilc_submitThread_queues[i];
+
+		pthread_mutex_lock(&state->mutex);
+		state->stop = 1;
+		pthread_cond_signal(&state->work);
+		pthread_mutex_unlock(&state->mutex);
+		pthread_join(state->thread, NULL);
+	}
+
+	/* only freed once all threads stopped, as calls on one queue may wait for the others */
+	for (i = 0; i < vilc_submitThread_queueCount; ++i)
+	{
+		VilcSubmitThreadQueue* state = vilc_submitThread_queues[i];
+
+		pthread_cond_destroy(&state->done);
+		pthread_cond_destroy(&state->work);
+		pthread_mutex_destroy(&state->mutex);
+		free(state);
+		vilc_submitThread_queues[i] = NULL;
+	}
+	VILC_ATOMIC_STORE_RELEASE(&vilc_submitThread_queueCount, 0);
+	pthread_mutex_unlock(&vilc_submitThread_mutex);
+}
+
+void vilcGetSubmitThreadStats(VilcSubmitThreadStats* stats)
+{
+	pthread_mutex_lock(&vilc_submitThread_mutex);
+	stats->queuedSubmits = VILC_ATOMIC_LOAD(&vilc_submitThread_stats.queuedSubmits);
+	stats->queuedPresents = VILC_ATOMIC_LOAD(&vilc_submitThread_stats.queuedPresents);
+	stats->passedThroughCalls = VILC_ATOMIC_LOAD(&vilc_submitThread_stats.passedThroughCalls);
+	stats->drains = VILC_ATOMIC_LOAD(&vilc_submitThread_stats.drains);
+	stats->ringFullWaits = VILC_ATOMIC_LOAD(&vilc_submitThread_stats.ringFullWaits);
+	stats->threads = vilc_submitThread_stats.threads;
+	vilc_histogramExport(&stats->callerTime, &vilc_submitThread_stats.callerTime);
+	vilc_histogramExport(&stats->queueLatency, &vilc_submitThread_stats.queueLatency);
+	vilc_histogramExport(&stats->driverTime, &vilc_submitThread_stats.driverTime);
+	pthread_mutex_unlock(&vilc_submitThread_mutex);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_submitThread_vkDestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator)
+{
+	VilcSubmitThreadStats stats;
+
+	/* submission threads call into the device, so they do not outlive it; the next submit restarts them */
+	vilc_submitThread_stopThreads();
+
+	vilcGetSubmitThreadStats(&stats);
+	fprintf(stderr, "vilc: submit thread: %llu submits and %llu presents queued on %u threads, %llu calls passed through, %llu drains, %llu full ring waits\n",
+	    (unsigned long long)stats.queuedSubmits, (unsigned long long)stats.queuedPresents, stats.threads, (unsigned long long)stats.passedThroughCalls,
+	    (unsigned long long)stats.drains, (unsigned long long)stats.ringFullWaits);
+	if (stats.callerTime.count)
+		vilc_histogramPrint("caller time (ns)", &stats.callerTime);
+	if (stats.queueLatency.count)
+		vilc_histogramPrint("queue latency (ns)", &stats.queueLatency);
+	if (stats.driverTime.count)
+		vilc_histogramPrint("driver time (ns)", &stats.driverTime);
+
+	vilc_submitThread_next_vkDestroyDevice(device, pAllocator);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_submitThread_vkQueueSubmit(VkQueue queue, uint32_t submitCount, const VkSubmitInfo* pSubmits, VkFence fence)
+{
+	uint64_t start = vilc_monotonicNow();
+	VilcSubmitThreadQueue* state = vilc_submitThread_queue(queue, 1);
+	uint32_t waits = 0, i;
+
+	for (i = 0; i < submitCount; ++i)
+		waits |= pSubmits[i].waitSemaphoreCount;
+	if (!state || !vilc_submitThread_push(state, VILC_SUBMIT_THREAD_SUBMIT, pSubmits, submitCount, fence, waits != 0, start))
+	{
+		vilc_submitThread_passThrough();
+		return vilc_submitThread_next_vkQueueSubmit(queue, submitCount, pSubmits, fence);
+	}
+	return vilc_submitThread_result(state, 0);
+}
+
+#if defined(VK_VERSION_1_3) || defined(VK_KHR_synchronization2)
+/* Returns 0 when the call has to be made from the calling thread */
+static int vilc_submitThread_submit2(VkQueue queue, VilcSubmitThreadCall call, uint32_t submitCount, const VkSubmitInfo2* pSubmits, VkFence fence, VkResult* result)
+{
+	uint64_t start = vilc_monotonicNow();
+	VilcSubmitThreadQueue* state = vilc_submitThread_queue(queue, 1);
+	uint32_t waits = 0, i;
+
+	for (i = 0; i < submitCount; ++i)
+		waits |= pSubmits[i].waitSemaphoreInfoCount;
+	if (!state || !vilc_submitThread_push(state, call, pSubmits, submitCount, fence, waits != 0, start))
+	{
+		vilc_submitThread_passThrough();
+		return 0;
+	}
+	*result = vilc_submitThread_result(state, 0);
+	return 1;
+}
+#endif /* defined(VK_VERSION_1_3) || defined(VK_KHR_synchronization2) */
+
+#if defined(VK_VERSION_1_3)
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_submitThread_vkQueueSubmit2(VkQueue queue, uint32_t submitCount, const VkSubmitInfo2* pSubmits, VkFence fence)
+{
+	VkResult result;
+
+	if (vilc_submitThread_submit2(queue, VILC_SUBMIT_THREAD_SUBMIT2, submitCount, pSubmits, fence, &result))
+		return result;
+	return vilc_submitThread_next_vkQueueSubmit2(queue, submitCount, pSubmits, fence);
+}
+#endif /* defined(VK_VERSION_1_3) */
+
+#if defined(VK_KHR_synchronization2)
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_submitThread_vkQueueSubmit2KHR(VkQueue queue, uint32_t submitCount, const VkSubmitInfo2* pSubmits, VkFence fence)
+{
+	VkResult result;
+
+	if (vilc_submitThread_submit2(queue, VILC_SUBMIT_THREAD_SUBMIT2_KHR, submitCount, pSubmits, fence, &result))
+		return result;
+	return vilc_submitThread_next_vkQueueSubmit2KHR(queue, submitCount, pSubmits, fence);
+}
+#endif /* defined(VK_KHR_synchronization2) */
+
+#if defined(VK_KHR_swapchain)
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_submitThread_vkQueuePresentKHR(VkQueue queue, const VkPresentInfoKHR* pPresentInfo)
+{
+	uint64_t start = vilc_monotonicNow();
+	VilcSubmitThreadQueue* state = vilc_submitThread_queue(queue, 1);
+
+	if (!state || !vilc_submitThread_push(state, VILC_SUBMIT_THREAD_PRESENT, pPresentInfo, 1, VK_NULL_HANDLE, pPresentInfo->waitSemaphoreCount != 0, start))
+	{
+		vilc_submitThread_passThrough();
+		return vilc_submitThread_next_vkQueuePresentKHR(queue, pPresentInfo);
+	}
+	return vilc_submitThread_result(state, 1);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_submitThread_vkDestroySwapchainKHR(VkDevice device, VkSwapchainKHR swapchain, const VkAllocationCallbacks* pAllocator)
+{
+	vilc_submitThread_drainAll();
+	vilc_submitThread_next_vkDestroySwapchainKHR(device, swapchain, pAllocator);
+}
+#endif /* defined(VK_KHR_swapchain) */
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_submitThread_vkQueueWaitIdle(VkQueue queue)
+{
+	VilcSubmitThreadQueue* state = vilc_submitThread_queue(queue, 0);
+	VkResult result;
+
+	vilc_submitThread_drain(state);
+	result = vilc_submitThread_result(state, 0);
+	return result != VK_SUCCESS ? result : vilc_submitThread_next_vkQueueWaitIdle(queue);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_submitThread_vkQueueBindSparse(VkQueue queue, uint32_t bindInfoCount, const VkBindSparseInfo* pBindInfo, VkFence fence)
+{
+	vilc_submitThread_passThrough();
+	return vilc_submitThread_next_vkQueueBindSparse(queue, bindInfoCount, pBindInfo, fence);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_submitThread_vkDeviceWaitIdle(VkDevice device)
+{
+	vilc_submitThread_drainAll();
+	return vilc_submitThread_next_vkDeviceWaitIdle(device);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_submitThread_vkWaitForFences(VkDevice device, uint32_t fenceCount, const VkFence* pFences, VkBool32 waitAll, uint64_t timeout)
+{
+	vilc_submitThread_drainAll();
+	return vilc_submitThread_next_vkWaitForFences(device, fenceCount, pFences, waitAll, timeout);
+}
+
+#if defined(VK_VERSION_1_2)
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_submitThread_vkWaitSemaphores(VkDevice device, const VkSemaphoreWaitInfo* pWaitInfo, uint64_t timeout)
+{
+	vilc_submitThread_drainAll();
+	return vilc_submitThread_next_vkWaitSemaphores(device, pWaitInfo, timeout);
+}
+#endif /* defined(VK_VERSION_1_2) */
+
+#if defined(VK_KHR_timeline_semaphore)
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_submitThread_vkWaitSemaphoresKHR(VkDevice device, const VkSemaphoreWaitInfo* pWaitInfo, uint64_t timeout)
+{
+	vilc_submitThread_drainAll();
+	return vilc_submitThread_next_vkWaitSemaphoresKHR(device, pWaitInfo, timeout);
+}
+#endif /* defined(VK_KHR_timeline_semaphore) */
+
+#if defined(VK_EXT_debug_utils)
+/* Labels bracket the calls made on the queue, so the queued ones are made first */
+static VKAPI_ATTR void VKAPI_CALL vilc_submitThread_vkQueueBeginDebugUtilsLabelEXT(VkQueue queue, const VkDebugUtilsLabelEXT* pLabelInfo)
+{
+	vilc_submitThread_drain(vilc_submitThread_queue(queue, 0));
+	vilc_submitThread_next_vkQueueBeginDebugUtilsLabelEXT(queue, pLabelInfo);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_submitThread_vkQueueEndDebugUtilsLabelEXT(VkQueue queue)
+{
+	vilc_submitThread_drain(vilc_submitThread_queue(queue, 0));
+	vilc_submitThread_next_vkQueueEndDebugUtilsLabelEXT(queue);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_submitThread_vkQueueInsertDebugUtilsLabelEXT(VkQueue queue, const VkDebugUtilsLabelEXT* pLabelInfo)
+{
+	vilc_submitThread_drain(vilc_submitThread_queue(queue, 0));
+	vilc_submitThread_next_vkQueueInsertDebugUtilsLabelEXT(queue, pLabelInfo);
+}
+#endif /* defined(VK_EXT_debug_utils) */
+
+static void vilc_submitThread_installInstance(void)
+{
+#if defined(VK_EXT_debug_utils)
+	VILC_LAYER_HOOK(vilc_submitThread, vkQueueBeginDebugUtilsLabelEXT)
+	VILC_LAYER_HOOK(vilc_submitThread, vkQueueEndDebugUtilsLabelEXT)
+	VILC_LAYER_HOOK(vilc_submitThread, vkQueueInsertDebugUtilsLabelEXT)
+#endif
+}
+
+static void vilc_submitThread_installDevice(void)
+{
+	VILC_LAYER_HOOK(vilc_submitThread, vkDestroyDevice)
+	VILC_LAYER_HOOK(vilc_submitThread, vkQueueSubmit)
+	VILC_LAYER_HOOK(vilc_submitThread, vkQueueWaitIdle)
+	VILC_LAYER_HOOK(vilc_submitThread, vkQueueBindSparse)
+	VILC_LAYER_HOOK(vilc_submitThread, vkDeviceWaitIdle)
+	VILC_LAYER_HOOK(vilc_submitThread, vkWaitForFences)
+#if defined(VK_VERSION_1_2)
+	VILC_LAYER_HOOK(vilc_submitThread, vkWaitSemaphores)
+#endif
+#if defined(VK_VERSION_1_3)
+	VILC_LAYER_HOOK(vilc_submitThread, vkQueueSubmit2)
+#endif
+#if defined(VK_KHR_synchronization2)
+	VILC_LAYER_HOOK(vilc_submitThread, vkQueueSubmit2KHR)
+#endif
+#if defined(VK_KHR_timeline_semaphore)
+	VILC_LAYER_HOOK(vilc_submitThread, vkWaitSemaphoresKHR)
+#endif
+#if defined(VK_KHR_swapchain)
+	VILC_LAYER_HOOK(vilc_submitThread, vkQueuePresentKHR)
+	VILC_LAYER_HOOK(vilc_submitThread, vkDestroySwapchainKHR)
+#endif
+}
+#endif /* VILC_SUBMIT_THREAD */
+
+#if defined(VOLK_IN_LOADERS_CLOTH) && defined(VILC_SUBMIT_MERGING)
+/* Submit merging: vkQueueSubmit and vkQueueSubmit2(KHR) calls are copied and held per VkQueue, and their batches are
+ * made as one driver call of the same entry point once a call comes with a fence, at the next present, host wait or
+ * query on fences, semaphores, events or queries, idle wait, or call waiting on semaphores on another queue, once
+ * VILC_SUBMIT_MERGING_MAX_CALLS calls (16 by default) are held, or VILC_SUBMIT_MERGING_WINDOW_US microseconds (1000 by
+ * default, 0 disables) after the first one was held, by a background thread. Batches of one call execute in order
+ * with the same semaphore operations as they would across calls, and the fence of the call signals after all of them
+ * like it would after the calls before it, so only the number of driver calls changes. A call waiting on semaphores
+ * makes the calls held on the other queues first, so binary semaphores are still signaled in driver order before
+ * they are waited on. Calls with pNext chains not known here are made as they are after the ones held on the queue.
+ * Errors the driver returns for held calls are returned by the next submit, present or vkQueueWaitIdle on the queue.
+ */
+#define VILC_SUBMIT_MERGING_MAX_QUEUES 64
+#define VILC_SUBMIT_MERGING_MAX_CALLS 16
+#define VILC_SUBMIT_MERGING_WINDOW_US 1000
+
+typedef enum VilcSubmitMergingCall
+{
+	VILC_SUBMIT_MERGING_SUBMIT,
+	VILC_SUBMIT_MERGING_SUBMIT2,
+	VILC_SUBMIT_MERGING_SUBMIT2_KHR
+} VilcSubmitMergingCall;
+
+typedef struct VilcSubmitMergingQueue
+{
+	VkQueue queue;
+	pthread_mutex_t mutex;
+	VilcSubmitMergingCall call; /* entry point of the held calls */
+	char* infos; /* VkSubmitInfo or VkSubmitInfo2 batches of the held calls */
+	uint32_t infoCount;
+	uint32_t infoCapacity;
+	void** copies; /* one allocation per held call, with the arrays and pNext chains of its batches */
+	uint32_t callCount;
+	uint32_t callCapacity;
+	uint64_t heldSince; /* CLOCK_MONOTONIC nanoseconds of the first held call, 0 when none are held */
+	VkResult result; /* first error not reported yet */
+} VilcSubmitMergingQueue;
+
+/* Queues are appended with vilc_submitMerging_mutex held and published through vilc_submitMerging_queueCount; the
+ * mutex also guards the timer thread state, and is never locked after a queue mutex by the timer thread
+ */
+static pthread_mutex_t vilc_submitMerging_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t vilc_submitMerging_wake = PTHREAD_COND_INITIALIZER;
+static VilcSubmitMergingQueue* vilc_submitMerging_queues[VILC_SUBMIT_MERGING_MAX_QUEUES];
+static uint32_t vilc_submitMerging_queueCount;
+static uint32_t vilc_submitMerging_maxCalls;
+static uint64_t vilc_submitMerging_window; /* nanoseconds */
+static pthread_t vilc_submitMerging_thread;
+static int vilc_submitMerging_threadRunning;
+static int vilc_submitMerging_stop;
+static int vilc_submitMerging_held; /* set when a queue started holding calls since the timer thread last looked */
+static VilcSubmitMergingStats vilc_submitMerging_stats;
+
+VILC_LAYER_NEXT(vilc_submitMerging, vkDestroyDevice)
+VILC_LAYER_NEXT(vilc_submitMerging, vkQueueSubmit)
+VILC_LAYER_NEXT(vilc_submitMerging, vkQueueWaitIdle)
+VILC_LAYER_NEXT(vilc_submitMerging, vkQueueBindSparse)
+VILC_LAYER_NEXT(vilc_submitMerging, vkDeviceWaitIdle)
+VILC_LAYER_NEXT(vilc_submitMerging, vkWaitForFences)
+VILC_LAYER_NEXT(vilc_submitMerging, vkGetEventStatus)
+VILC_LAYER_NEXT(vilc_submitMerging, vkGetQueryPoolResults)
+#if defined(VK_VERSION_1_2)
+VILC_LAYER_NEXT(vilc_submitMerging, vkWaitSemaphores)
+VILC_LAYER_NEXT(vilc_submitMerging, vkGetSemaphoreCounterValue)
+#endif
+#if defined(VK_VERSION_1_3)
+VILC_LAYER_NEXT(vilc_submitMerging, vkQueueSubmit2)
+#endif
+#if defined(VK_KHR_synchronization2)
+VILC_LAYER_NEXT(vilc_submitMerging, vkQueueSubmit2KHR)
+#endif
+#if defined(VK_KHR_timeline_semaphore)
+VILC_LAYER_NEXT(vilc_submitMerging, vkWaitSemaphoresKHR)
+VILC_LAYER_NEXT(vilc_submitMerging, vkGetSemaphoreCounterValueKHR)
+#endif
+#if defined(VK_KHR_swapchain)
+VILC_LAYER_NEXT(vilc_submitMerging, vkQueuePresentKHR)
+#endif
+#if defined(VK_EXT_debug_utils)
+VILC_LAYER_NEXT(vilc_submitMerging, vkQueueBeginDebugUtilsLabelEXT)
+VILC_LAYER_NEXT(vilc_submitMerging, vkQueueEndDebugUtilsLabelEXT)
+VILC_LAYER_NEXT(vilc_submitMerging, vkQueueInsertDebugUtilsLabelEXT)
+#endif
+
+static size_t vilc_submitMerging_infoSize(VilcSubmitMergingCall call)
+{
+#if defined(VK_VERSION_1_3) || defined(VK_KHR_synchronization2)
+	if (call != VILC_SUBMIT_MERGING_SUBMIT)
+		return sizeof(VkSubmitInfo2);
+#endif /* defined(VK_VERSION_1_3) || defined(VK_KHR_synchronization2) */
+	(void)call;
+	return sizeof(VkSubmitInfo);
+}
+
+static VkResult vilc_submitMerging_call(VkQueue queue, VilcSubmitMergingCall call, uint32_t count, const void* infos, VkFence fence)
+{
+	switch (call)
+	{
+#if defined(VK_VERSION_1_3)
+	case VILC_SUBMIT_MERGING_SUBMIT2:
+		return vilc_submitMerging_next_vkQueueSubmit2(queue, count, (const VkSubmitInfo2*)infos, fence);
+#endif /* defined(VK_VERSION_1_3) */
+#if defined(VK_KHR_synchronization2)
+	case VILC_SUBMIT_MERGING_SUBMIT2_KHR:
+		return vilc_submitMerging_next_vkQueueSubmit2KHR(queue, count, (const VkSubmitInfo2*)infos, fence);
+#endif /* defined(VK_KHR_synchronization2) */
+	default:
+		return vilc_submitMerging_next_vkQueueSubmit(queue, count, (const VkSubmitInfo*)infos, fence);
+	}
+}
+
+/* Makes the held calls as one driver call with the fence of the call that ends them, if any, and counts it for its
+ * cause; called with the queue mutex held. Returns the result of the driver call, VK_SUCCESS when none was made.
+ */
+static VkResult vilc_submitMerging_flush(VilcSubmitMergingQueue* state, VkFence fence, uint64_t* cause)
+{
+	VkResult result;
+	uint32_t i;
+
+	if (!state->callCount)
+		return VK_SUCCESS;
+
+	result = vilc_submitMerging_call(state->queue, state->call, state->infoCount, state->infos, fence);
+	VILC_ATOMIC_ADD(&vilc_submitMerging_stats.driverSubmits, 1);
+	VILC_ATOMIC_ADD(cause, 1);
+
+	for (i = 0; i < state->callCount; ++i)
+		free(state->copies[i]);
+	state->infoCount = 0;
+	state->callCount = 0;
+	VILC_ATOMIC_STORE(&state->heldSince, 0);
+
+	return result;
+}
+
+/* Flushes the held calls for a cause other than a call on the queue, keeping an error for the next one; called with
+ * the queue mutex held
+ */
+static void vilc_submitMerging_flushHeld(VilcSubmitMergingQueue* state, uint64_t* cause)
+{
+	VkResult result = vilc_submitMerging_flush(state, VK_NULL_HANDLE, cause);
+
+	if (result < 0 && state->result == VK_SUCCESS)
+		state->result = result;
+}
+
+static void vilc_submitMerging_flushQueue(VilcSubmitMergingQueue* state, uint64_t* cause)
+{
+	if (!state || !VILC_ATOMIC_LOAD(&state->heldSince))
+		return;
+
+	pthread_mutex_lock(&state->mutex);
+	vilc_submitMerging_flushHeld(state, cause);
+	pthread_mutex_unlock(&state->mutex);
+}
+
+/* Flushes all queues but the one given, which may be NULL */
+static void vilc_submitMerging_flushOthers(const VilcSubmitMergingQueue* except, uint64_t* cause)
+{
+	uint32_t count = VILC_ATOMIC_LOAD_ACQUIRE(&vilc_submitMerging_queueCount), i;
+
+	for (i = 0; i < count; ++i)
+		if (vilc_submitMerging_queues[i] != except)
+			vilc_submitMerging_flushQueue(vilc_submitMerging_queues[i], cause);
+}
+
+/* Returns the first error kept for the queue since the last one was returned */
+static VkResult vilc_submitMerging_result(VilcSubmitMergingQueue* state)
+{
+	VkResult result;
+
+	if (!state)
+		return VK_SUCCESS;
+
+	pthread_mutex_lock(&state->mutex);
+	result = state->result;
+	state->result = VK_SUCCESS;
+	pthread_mutex_unlock(&state->mutex);
+
+	return result;
+}
+
+/* Flushes the calls held longer than the window and returns the time the next held calls are due, 0 when none are */
+static uint64_t vilc_submitMerging_flushExpired(void)
+{
+	uint32_t count = VILC_ATOMIC_LOAD_ACQUIRE(&vilc_submitMerging_queueCount), i;
+	uint64_t now = vilc_monotonicNow(), next = 0, heldSince;
+
+	for (i = 0; i < count; ++i)
+	{
+		VilcSubmitMergingQueue* state = vilc_submitMerging_queues[i];
+
+		heldSince = VILC_ATOMIC_LOAD(&state->heldSince);
+		if (heldSince && now - heldSince >= vilc_submitMerging_window)
+			vilc_submitMerging_flushQueue(state, &vilc_submitMerging_stats.timeFlushes);
+		else if (heldSince && (!next || heldSince + vilc_submitMerging_window < next))
+			next = heldSince + vilc_submitMerging_window;
+	}
+
+	return next;
+}
+
+static void* vilc_submitMerging_timer(void* context)
+{
+	struct timespec deadline;
+	uint64_t next, wait;
+
+	(void)context;
+	pthread_mutex_lock(&vilc_submitMerging_mutex);
+	while (!vilc_submitMerging_stop)
+	{
+		vilc_submitMerging_held = 0;
+		pthread_mutex_unlock(&vilc_submitMerging_mutex);
+		next = vilc_submitMerging_flushExpired();
+		pthread_mutex_lock(&vilc_submitMerging_mutex);
+
+		if (vilc_submitMerging_stop || vilc_submitMerging_held)
+			continue;
+		if (!next)
+		{
+			pthread_cond_wait(&vilc_submitMerging_wake, &vilc_submitMerging_mutex);
+			continue;
+		}
+
+		/* the condition variable waits on CLOCK_REALTIME */
+		wait = next - vilc_monotonicNow();
+		wait = wait > vilc_submitMerging_window ? 0 : wait;
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		deadline.tv_sec += (time_t)(wait / 1000000000ull);
+		deadline.tv_nsec += (long)(wait % 1000000000ull);
+		if (deadline.tv_nsec >= 1000000000l)
+		{
+			deadline.tv_sec++;
+			deadline.tv_nsec -= 1000000000l;
+		}
+		pthread_cond_timedwait(&vilc_submitMerging_wake, &vilc_submitMerging_mutex, &deadline);
+	}
+	pthread_mutex_unlock(&vilc_submitMerging_mutex);
+
+	return NULL;
+}
+
+/* Returns the state of a queue, creating it on the first call when create is set; NULL when the queue has none, or
+ * when no more queues can be tracked
+ */
+static VilcSubmitMergingQueue* vilc_submitMerging_queue(VkQueue queue, int create)
+{
+	uint32_t count = VILC_ATOMIC_LOAD_ACQUIRE(&vilc_submitMerging_queueCount), i;
+	VilcSubmitMergingQueue* state = NULL;
+
+	for (i = 0; i < count; ++i)
+		if (vilc_submitMerging_queues[i]->queue == queue)
+			return vilc_submitMerging_queues[i];
+	if (!create)
+		return NULL;
+
+	pthread_mutex_lock(&vilc_submitMerging_mutex);
+	count = vilc_submitMerging_queueCount;
+	for (i = 0; i < count && !state; ++i)
+		if (vilc_submitMerging_queues[i]->queue == queue)
+			state = vilc_submitMerging_queues[i];
+
+	if (!state && count < VILC_SUBMIT_MERGING_MAX_QUEUES && (state = (VilcSubmitMergingQueue*)calloc(1, sizeof(VilcSubmitMergingQueue))) != NULL)
+	{
+		state->queue = queue;
+		pthread_mutex_init(&state->mutex, NULL);
+		vilc_submitMerging_queues[count] = state;
+		VILC_ATOMIC_STORE_RELEASE(&vilc_submitMerging_queueCount, count + 1);
+	}
+
+	/* without the timer thread held calls wait for the next flush of another cause */
+	if (state && vilc_submitMerging_window && !vilc_submitMerging_threadRunning)
+	{
+		vilc_submitMerging_stop = 0;
+		vilc_submitMerging_threadRunning = pthread_create(&vilc_submitMerging_thread, NULL, vilc_submitMerging_timer, NULL) == 0;
+	}
+	pthread_mutex_unlock(&vilc_submitMerging_mutex);
+
+	return state;
+}
+
+/* Copies a call into the held calls of the queue; called with the queue mutex held. Returns 0 when it has to be made
+ * as it is instead.
+ */
+static int vilc_submitMerging_hold(VilcSubmitMergingQueue* state, VilcSubmitMergingCall call, const void* infos, uint32_t count)
+{
+	size_t infoSize = vilc_submitMerging_infoSize(call);
+	size_t size = vilc_submitCopyMeasure(infos, count);
+	char* arena;
+	void* copy;
+
+	if (size == VILC_SUBMIT_COPY_NONE)
+		return 0;
+
+	if (state->infoCount + count > state->infoCapacity)
+	{
+		uint32_t capacity = state->infoCapacity ? state->infoCapacity : 16;
+		char* grown;
+
+		while (capacity < state->infoCount + count)
+			capacity *= 2;
+		/* infos are only compacted after a flush, when the copies they point to are freed */
+		if (!(grown = (char*)realloc(state->infos, capacity * infoSize)))
+			return 0;
+		state->infos = grown;
+		state->infoCapacity = capacity;
+	}
+	if (state->callCount == state->callCapacity)
+	{
+		uint32_t capacity = state->callCapacity ? state->callCapacity * 2 : 16;
+		void** grown = (void**)realloc(state->copies, capacity * sizeof(void*));
+
+		if (!grown)
+			return 0;
+		state->copies = grown;
+		state->callCapacity = capacity;
+	}
+	if (!(arena = (char*)malloc(size ? size : 1)))
+		return 0;
+
+	copy = arena;
+	if (count)
+		memcpy(state->infos + (size_t)state->infoCount * infoSize, vilc_submitCopy(infos, count, &arena), (size_t)count * infoSize);
+	state->copies[state->callCount++] = copy;
+	state->infoCount += count;
+	state->call = call;
+	return 1;
+}
+
+/* Holds a submit or makes it with the held ones; returns 0 when it has to be made as it is by the caller, after the
+ * calls held on the queue
+ */
+static int vilc_submitMerging_submit(VkQueue queue, VilcSubmitMergingCall call, const void* infos, uint32_t count, VkFence fence, int waits, VkResult* result)
+{
+	VilcSubmitMergingQueue* state = vilc_submitMerging_queue(queue, 1);
+	int first;
+
+	/* the semaphores waited on may be signaled by calls held on any queue */
+	if (waits)
+		vilc_submitMerging_flushOthers(state, &vilc_submitMerging_stats.syncFlushes);
+	if (!state)
+	{
+		VILC_ATOMIC_ADD(&vilc_submitMerging_stats.passedThroughCalls, 1);
+		return 0;
+	}
+
+	pthread_mutex_lock(&state->mutex);
+	if (state->callCount && state->call != call)
+		vilc_submitMerging_flushHeld(state, &vilc_submitMerging_stats.orderFlushes);
+	first = !state->callCount;
+
+	if (!vilc_submitMerging_hold(state, call, infos, count))
+	{
+		vilc_submitMerging_flushHeld(state, &vilc_submitMerging_stats.orderFlushes);
+		pthread_mutex_unlock(&state->mutex);
+		VILC_ATOMIC_ADD(&vilc_submitMerging_stats.passedThroughCalls, 1);
+		return 0;
+	}
+	VILC_ATOMIC_ADD(&vilc_submitMerging_stats.heldCalls, 1);
+
+	if (fence)
+		*result = vilc_submitMerging_flush(state, fence, &vilc_submitMerging_stats.fenceFlushes);
+	else if (state->callCount >= vilc_submitMerging_maxCalls)
+		*result = vilc_submitMerging_flush(state, VK_NULL_HANDLE, &vilc_submitMerging_stats.countFlushes);
+	else
+	{
+		*result = VK_SUCCESS;
+		if (first)
+			VILC_ATOMIC_STORE(&state->heldSince, vilc_monotonicNow());
+	}
+	if (*result == VK_SUCCESS)
+		*result = state->result;
+	state->result = VK_SUCCESS;
+	pthread_mutex_unlock(&state->mutex);
+
+	/* the timer thread may be waiting without a deadline */
+	if (first && vilc_submitMerging_window && VILC_ATOMIC_LOAD(&state->heldSince))
+	{
+		pthread_mutex_lock(&vilc_submitMerging_mutex);
+		vilc_submitMerging_held = 1;
+		pthread_cond_signal(&vilc_submitMerging_wake);
+		pthread_mutex_unlock(&vilc_submitMerging_mutex);
+	}
+	return 1;
+}
+
+/* Returns the result of a call made as it is, or the error kept for the held calls made before it */
+static VkResult vilc_submitMerging_passedThrough(VkQueue queue, VkResult result)
+{
+	VkResult kept = vilc_submitMerging_result(vilc_submitMerging_queue(queue, 0));
+
+	return kept != VK_SUCCESS ? kept : result;
+}
+
+static void vilc_submitMerging_stopThread(void)
+{
+	pthread_mutex_lock(&vilc_submitMerging_mutex);
+	vilc_submitMerging_stop = 1;
+	pthread_cond_signal(&vilc_submitMerging_wake);
+	pthread_mutex_unlock(&vilc_submitMerging_mutex);
+
+	if (vilc_submitMerging_threadRunning)
+	{
+		pthread_join(vilc_submitMerging_thread, NULL);
+		vilc_submitMerging_threadRunning = 0;
+	}
+}
+
+void vilcGetSubmitMergingStats(VilcSubmitMergingStats* stats)
+{
+	stats->heldCalls = VILC_ATOMIC_LOAD(&vilc_submitMerging_stats.heldCalls);
+	stats->driverSubmits = VILC_ATOMIC_LOAD(&vilc_submitMerging_stats.driverSubmits);
+	stats->passedThroughCalls = VILC_ATOMIC_LOAD(&vilc_submitMerging_stats.passedThroughCalls);
+	stats->fenceFlushes = VILC_ATOMIC_LOAD(&vilc_submitMerging_stats.fenceFlushes);
+	stats->presentFlushes = VILC_ATOMIC_LOAD(&vilc_submitMerging_stats.presentFlushes);
+	stats->syncFlushes = VILC_ATOMIC_LOAD(&vilc_submitMerging_stats.syncFlushes);
+	stats->orderFlushes = VILC_ATOMIC_LOAD(&vilc_submitMerging_stats.orderFlushes);
+	stats->countFlushes = VILC_ATOMIC_LOAD(&vilc_submitMerging_stats.countFlushes);
+	stats->timeFlushes = VILC_ATOMIC_LOAD(&vilc_submitMerging_stats.timeFlushes);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_submitMerging_vkDestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator)
+{
+	VilcSubmitMergingStats stats;
+	uint32_t i;
+
+	/* the calls made before vkDestroyDevice all reach the driver, before the timer thread stops */
+	vilc_submitMerging_flushOthers(NULL, &vilc_submitMerging_stats.syncFlushes);
+	vilc_submitMerging_stopThread();
+
+	pthread_mutex_lock(&vilc_submitMerging_mutex);
+	for (i = 0; i < vilc_submitMerging_queueCount; ++i)
+	{
+		VilcSubmitMergingQueue* state = vilc_submitMerging_queues[i];
+
+		pthread_mutex_destroy(&state->mutex);
+		free(state->infos);
+		free(state->copies);
+		free(state);
+		vilc_submitMerging_queues[i] = NULL;
+	}
+	VILC_ATOMIC_STORE_RELEASE(&vilc_submitMerging_queueCount, 0);
+	pthread_mutex_unlock(&vilc_submitMerging_mutex);
+
+	vilcGetSubmitMergingStats(&stats);
+	fprintf(stderr, "vilc: submit merging: %llu submit calls made as %llu driver calls, %llu calls passed through\n",
+	    (unsigned long long)stats.heldCalls, (unsigned long long)stats.driverSubmits, (unsigned long long)stats.passedThroughCalls);
+	fprintf(stderr, "vilc:   flushed by %llu fences, %llu presents, %llu syncs, %llu ordered queue calls, %llu full batches, %llu timeouts\n",
+	    (unsigned long long)stats.fenceFlushes, (unsigned long long)stats.presentFlushes, (unsigned long long)stats.syncFlushes,
+	    (unsigned long long)stats.orderFlushes, (unsigned long long)stats.countFlushes, (unsigned long long)stats.timeFlushes);
+
+	vilc_submitMerging_next_vkDestroyDevice(device, pAllocator);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_submitMerging_vkQueueSubmit(VkQueue queue, uint32_t submitCount, const VkSubmitInfo* pSubmits, VkFence fence)
+{
+	uint32_t waits = 0, i;
+	VkResult result;
+
+	for (i = 0; i < submitCount; ++i)
+		waits |= pSubmits[i].waitSemaphoreCount;
+	if (vilc_submitMerging_submit(queue, VILC_SUBMIT_MERGING_SUBMIT, pSubmits, submitCount, fence, waits != 0, &result))
+		return result;
+	return vilc_submitMerging_passedThrough(queue, vilc_submitMerging_next_vkQueueSubmit(queue, submitCount, pSubmits, fence));
+}
+
+#if defined(VK_VERSION_1_3) || defined(VK_KHR_synchronization2)
+static int vilc_submitMerging_submit2(VkQueue queue, VilcSubmitMergingCall call, uint32_t submitCount, const VkSubmitInfo2* pSubmits, VkFence fence, VkResult* result)
+{
+	uint32_t waits = 0, i;
+
+	for (i = 0; i < submitCount; ++i)
+		waits |= pSubmits[i].waitSemaphoreInfoCount;
+	return vilc_submitMerging_submit(queue, call, pSubmits, submitCount, fence, waits != 0, result);
+}
+#endif /* defined(VK_VERSION_1_3) || defined(VK_KHR_synchronization2) */
+
+#if defined(VK_VERSION_1_3)
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_submitMerging_vkQueueSubmit2(VkQueue queue, uint32_t submitCount, const VkSubmitInfo2* pSubmits, VkFence fence)
+{
+	VkResult result;
+
+	if (vilc_submitMerging_submit2(queue, VILC_SUBMIT_MERGING_SUBMIT2, submitCount, pSubmits, fence, &result))
+		return result;
+	return vilc_submitMerging_passedThrough(queue, vilc_submitMerging_next_vkQueueSubmit2(queue, submitCount, pSubmits, fence));
+}
+#endif /* defined(VK_VERSION_1_3) */
+
+#if defined(VK_KHR_synchronization2)
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_submitMerging_vkQueueSubmit2KHR(VkQueue queue, uint32_t submitCount, const VkSubmitInfo2* pSubmits, VkFence fence)
+{
+	VkResult result;
+
+	if (vilc_submitMerging_submit2(queue, VILC_SUBMIT_MERGING_SUBMIT2_KHR, submitCount, pSubmits, fence, &result))
+		return result;
+	return vilc_submitMerging_passedThrough(queue, vilc_submitMerging_next_vkQueueSubmit2KHR(queue, submitCount, pSubmits, fence));
+}
+#endif /* defined(VK_KHR_synchronization2) */
+
+#if defined(VK_KHR_swapchain)
+/* A present ends the frame, and may wait on semaphores signaled on any queue */
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_submitMerging_vkQueuePresentKHR(VkQueue queue, const VkPresentInfoKHR* pPresentInfo)
+{
+	vilc_submitMerging_flushOthers(NULL, &vilc_submitMerging_stats.presentFlushes);
+	return vilc_submitMerging_passedThrough(queue, vilc_submitMerging_next_vkQueuePresentKHR(queue, pPresentInfo));
+}
+#endif /* defined(VK_KHR_swapchain) */
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_submitMerging_vkQueueWaitIdle(VkQueue queue)
+{
+	vilc_submitMerging_flushQueue(vilc_submitMerging_queue(queue, 0), &vilc_submitMerging_stats.syncFlushes);
+	return vilc_submitMerging_passedThrough(queue, vilc_submitMerging_next_vkQueueWaitIdle(queue));
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_submitMerging_vkQueueBindSparse(VkQueue queue, uint32_t bindInfoCount, const VkBindSparseInfo* pBindInfo, VkFence fence)
+{
+	uint32_t waits = 0, i;
+
+	for (i = 0; i < bindInfoCount; ++i)
+		waits |= pBindInfo[i].waitSemaphoreCount;
+	if (waits)
+		vilc_submitMerging_flushOthers(NULL, &vilc_submitMerging_stats.syncFlushes);
+	else
+		vilc_submitMerging_flushQueue(vilc_submitMerging_queue(queue, 0), &vilc_submitMerging_stats.orderFlushes);
+	return vilc_submitMerging_passedThrough(queue, vilc_submitMerging_next_vkQueueBindSparse(queue, bindInfoCount, pBindInfo, fence));
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_submitMerging_vkDeviceWaitIdle(VkDevice device)
+{
+	vilc_submitMerging_flushOthers(NULL, &vilc_submitMerging_stats.syncFlushes);
+	return vilc_submitMerging_next_vkDeviceWaitIdle(device);
+}
+
+/* Held calls never have a fence, but the host may wait on one to learn that the work submitted before it finished */
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_submitMerging_vkWaitForFences(VkDevice device, uint32_t fenceCount, const VkFence* pFences, VkBool32 waitAll, uint64_t timeout)
+{
+	vilc_submitMerging_flushOthers(NULL, &vilc_submitMerging_stats.syncFlushes);
+	return vilc_submitMerging_next_vkWaitForFences(device, fenceCount, pFences, waitAll, timeout);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_submitMerging_vkGetEventStatus(VkDevice device, VkEvent event)
+{
+	vilc_submitMerging_flushOthers(NULL, &vilc_submitMerging_stats.syncFlushes);
+	return vilc_submitMerging_next_vkGetEventStatus(device, event);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_submitMerging_vkGetQueryPoolResults(VkDevice device, VkQueryPool queryPool, uint32_t firstQuery, uint32_t queryCount, size_t dataSize, void* pData, VkDeviceSize stride, VkQueryResultFlags flags)
+{
+	vilc_submitMerging_flushOthers(NULL, &vilc_submitMerging_stats.syncFlushes);
+	return vilc_submitMerging_next_vkGetQueryPoolResults(device, queryPool, firstQuery, queryCount, dataSize, pData, stride, flags);
+}
+
+#if defined(VK_VERSION_1_2)
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_submitMerging_vkWaitSemaphores(VkDevice device, const VkSemaphoreWaitInfo* pWaitInfo, uint64_t timeout)
+{
+	vilc_submitMerging_flushOthers(NULL, &vilc_submitMerging_stats.syncFlushes);
+	return vilc_submitMerging_next_vkWaitSemaphores(device, pWaitInfo, timeout);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_submitMerging_vkGetSemaphoreCounterValue(VkDevice device, VkSemaphore semaphore, uint64_t* pValue)
+{
+	vilc_submitMerging_flushOthers(NULL, &vilc_submitMerging_stats.syncFlushes);
+	return vilc_submitMerging_next_vkGetSemaphoreCounterValue(device, semaphore, pValue);
+}
+#endif /* defined(VK_VERSION_1_2) */
+
+#if defined(VK_KHR_timeline_semaphore)
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_submitMerging_vkWaitSemaphoresKHR(VkDevice device, const VkSemaphoreWaitInfo* pWaitInfo, uint64_t timeout)
+{
+	vilc_submitMerging_flushOthers(NULL, &vilc_submitMerging_stats.syncFlushes);
+	return vilc_submitMerging_next_vkWaitSemaphoresKHR(device, pWaitInfo, timeout);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_submitMerging_vkGetSemaphoreCounterValueKHR(VkDevice device, VkSemaphore semaphore, uint64_t* pValue)
+{
+	vilc_submitMerging_flushOthers(NULL, &vilc_submitMerging_stats.syncFlushes);
+	return vilc_submitMerging_next_vkGetSemaphoreCounterValueKHR(device, semaphore, pValue);
+}
+#endif /* defined(VK_KHR_timeline_semaphore) */
+
+#if defined(VK_EXT_debug_utils)
+/* Labels bracket the calls made on the queue, so the held ones are made first */
+static VKAPI_ATTR void VKAPI_CALL vilc_submitMerging_vkQueueBeginDebugUtilsLabelEXT(VkQueue queue, const VkDebugUtilsLabelEXT* pLabelInfo)
+{
+	vilc_submitMerging_flushQueue(vilc_submitMerging_queue(queue, 0), &vilc_submitMerging_stats.orderFlushes);
+	vilc_submitMerging_next_vkQueueBeginDebugUtilsLabelEXT(queue, pLabelInfo);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_submitMerging_vkQueueEndDebugUtilsLabelEXT(VkQueue queue)
+{
+	vilc_submitMerging_flushQueue(vilc_submitMerging_queue(queue, 0), &vilc_submitMerging_stats.orderFlushes);
+	vilc_submitMerging_next_vkQueueEndDebugUtilsLabelEXT(queue);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_submitMerging_vkQueueInsertDebugUtilsLabelEXT(VkQueue queue, const VkDebugUtilsLabelEXT* pLabelInfo)
+{
+	vilc_submitMerging_flushQueue(vilc_submitMerging_queue(queue, 0), &vilc_submitMerging_stats.orderFlushes);
+	vilc_submitMerging_next_vkQueueInsertDebugUtilsLabelEXT(queue, pLabelInfo);
+}
+#endif /* defined(VK_EXT_debug_utils) */
+
+static void vilc_submitMerging_installInstance(void)
+{
+#if defined(VK_EXT_debug_utils)
+	VILC_LAYER_HOOK(vilc_submitMerging, vkQueueBeginDebugUtilsLabelEXT)
+	VILC_LAYER_HOOK(vilc_submitMerging, vkQueueEndDebugUtilsLabelEXT)
+	VILC_LAYER_HOOK(vilc_submitMerging, vkQueueInsertDebugUtilsLabelEXT)
+#endif
+}
+
+static void vilc_submitMerging_installDevice(void)
+{
+	const char* maxCalls = getenv("VILC_SUBMIT_MERGING_MAX_CALLS");
+	const char* window = getenv("VILC_SUBMIT_MERGING_WINDOW_US");
+
+	vilc_submitMerging_maxCalls = maxCalls ? (uint32_t)strtoul(maxCalls, NULL, 10) : VILC_SUBMIT_MERGING_MAX_CALLS;
+	vilc_submitMerging_maxCalls = vilc_submitMerging_maxCalls < 1 ? 1 : vilc_submitMerging_maxCalls;
+	vilc_submitMerging_window = (window ? strtoull(window, NULL, 10) : VILC_SUBMIT_MERGING_WINDOW_US) * 1000ull;
+
+	VILC_LAYER_HOOK(vilc_submitMerging, vkDestroyDevice)
+	VILC_LAYER_HOOK(vilc_submitMerging, vkQueueSubmit)
+	VILC_LAYER_HOOK(vilc_submitMerging, vkQueueWaitIdle)
+	VILC_LAYER_HOOK(vilc_submitMerging, vkQueueBindSparse)
+	VILC_LAYER_HOOK(vilc_submitMerging, vkDeviceWaitIdle)
+	VILC_LAYER_HOOK(vilc_submitMerging, vkWaitForFences)
+	VILC_LAYER_HOOK(vilc_submitMerging, vkGetEventStatus)
+	VILC_LAYER_HOOK(vilc_submitMerging, vkGetQueryPoolResults)
+#if defined(VK_VERSION_1_2)
+	VILC_LAYER_HOOK(vilc_submitMerging, vkWaitSemaphores)
+	VILC_LAYER_HOOK(vilc_submitMerging, vkGetSemaphoreCounterValue)
+#endif
+#if defined(VK_VERSION_1_3)
+	VILC_LAYER_HOOK(vilc_submitMerging, vkQueueSubmit2)
+#endif
+#if defined(VK_KHR_synchronization2)
+	VILC_LAYER_HOOK(vilc_submitMerging, vkQueueSubmit2KHR)
+#endif
+#if defined(VK_KHR_timeline_semaphore)
+	VILC_LAYER_HOOK(vilc_submitMerging, vkWaitSemaphoresKHR)
+	VILC_LAYER_HOOK(vilc_submitMerging, vkGetSemaphoreCounterValueKHR)
+#endif
+#if defined(VK_KHR_swapchain)
+	VILC_LAYER_HOOK(vilc_submitMerging, vkQueuePresentKHR)
+#endif
+}
+#endif /* VILC_SUBMIT_MERGING */
+
+#if defined(VOLK_IN_LOADERS_CLOTH) && defined(VILC_MAPPING_CACHE)
+/* Mapping cache: host-visible allocations are mapped whole by the driver at their first vkMapMemory(2) and stay
+ * mapped until vkFreeMemory, which unmaps them implicitly. Maps return a pointer into that mapping at the offset
+ * asked for and unmaps only mark the allocation unmapped, so the pointers the application sees are the same as with
+ * a map of its own range. vkFlushMappedMemoryRanges calls are held and made as one driver call before the next queue
+ * submit or sparse binding, the only calls through which the device reads the memory, or the next host signal of an
+ * event or semaphore, which can release work already submitted to read it, with ranges of the same allocation merged
+ * where they touch; held ranges are flushed before any invalidation, so no host write is dropped.
+ * Flushes and invalidations of host-coherent memory have no effect and do not reach the driver. Maps with flags or
+ * pNext structures pass through, as does vkUnmapMemory2 with flags, which unmaps the cached mapping.
+ */
+typedef struct VilcMappingCacheMemory
+{
+	VkDeviceSize size;
+	int coherent;
+	int mapped; /* by the application */
+	char* data; /* the mapping of the whole allocation, NULL until the first map */
+} VilcMappingCacheMemory;
+
+static pthread_mutex_t vilc_mappingCache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static VkDevice vilc_mappingCache_device;
+static VkPhysicalDeviceMemoryProperties vilc_mappingCache_properties;
+static VilcHandleMap vilc_mappingCache_memories;
+/* flush ranges held until the next submit, with sizes resolved; pendingCount is read without the mutex */
+static VkMappedMemoryRange* vilc_mappingCache_pending;
+static uint32_t vilc_mappingCache_pendingCount;
+static uint32_t vilc_mappingCache_pendingCapacity;
+static VilcMappingCacheStats vilc_mappingCache_stats;
+
+VILC_LAYER_NEXT(vilc_mappingCache, vkCreateDevice)
+VILC_LAYER_NEXT(vilc_mappingCache, vkDestroyDevice)
+VILC_LAYER_NEXT(vilc_mappingCache, vkAllocateMemory)
+VILC_LAYER_NEXT(vilc_mappingCache, vkFreeMemory)
+VILC_LAYER_NEXT(vilc_mappingCache, vkMapMemory)
+VILC_LAYER_NEXT(vilc_mappingCache, vkUnmapMemory)
+VILC_LAYER_NEXT(vilc_mappingCache, vkFlushMappedMemoryRanges)
+VILC_LAYER_NEXT(vilc_mappingCache, vkInvalidateMappedMemoryRanges)
+VILC_LAYER_NEXT(vilc_mappingCache, vkQueueSubmit)
+VILC_LAYER_NEXT(vilc_mappingCache, vkQueueBindSparse)
+VILC_LAYER_NEXT(vilc_mappingCache, vkSetEvent)
+#if defined(VK_VERSION_1_2)
+VILC_LAYER_NEXT(vilc_mappingCache, vkSignalSemaphore)
+#endif
+#if defined(VK_VERSION_1_3)
+VILC_LAYER_NEXT(vilc_mappingCache, vkQueueSubmit2)
+#endif
+#if defined(VK_VERSION_1_4)
+VILC_LAYER_NEXT(vilc_mappingCache, vkMapMemory2)
+VILC_LAYER_NEXT(vilc_mappingCache, vkUnmapMemory2)
+#endif
+#if defined(VK_KHR_synchronization2)
+VILC_LAYER_NEXT(vilc_mappingCache, vkQueueSubmit2KHR)
+#endif
+#if defined(VK_KHR_map_memory2)
+VILC_LAYER_NEXT(vilc_mappingCache, vkMapMemory2KHR)
+VILC_LAYER_NEXT(vilc_mappingCache, vkUnmapMemory2KHR)
+#endif
+#if defined(VK_KHR_timeline_semaphore)
+VILC_LAYER_NEXT(vilc_mappingCache, vkSignalSemaphoreKHR)
+#endif
+
+static int vilc_mappingCache_compareRanges(const void* left, const void* right)
+{
+	const VkMappedMemoryRange* a = (const VkMappedMemoryRange*)left;
+	const VkMappedMemoryRange* b = (const VkMappedMemoryRange*)right;
+
+	if (VILC_OBJECT_KEY(a->memory) != VILC_OBJECT_KEY(b->memory))
+		return VILC_OBJECT_KEY(a->memory) < VILC_OBJECT_KEY(b->memory) ? -1 : 1;
+	return a->offset < b->offset ? -1 : a->offset > b->offset ? 1 : 0;
+}
+
+/* Sorts ranges with resolved sizes and merges the ones of the same allocation that overlap or touch; returns the new
+ * count. Merged ranges cover exactly the bytes of the ranges they were merged from.
+ */
+static uint32_t vilc_mappingCache_mergeRanges(VkMappedMemoryRange* ranges, uint32_t count)
+{
+	uint32_t merged = 0, i;
+
+	qsort(ranges, count, sizeof(VkMappedMemoryRange), vilc_mappingCache_compareRanges);
+	for (i = 0; i < count; ++i)
+	{
+		VkMappedMemoryRange* last = merged ? &ranges[merged - 1] : NULL;
+
+		if (last && last->memory == ranges[i].memory && ranges[i].offset <= last->offset + last->size)
+		{
+			if (ranges[i].offset + ranges[i].size > last->offset + last->size)
+				last->size = ranges[i].offset + ranges[i].size - last->offset;
+		}
+		else
+			ranges[merged++] = ranges[i];
+	}
+
+	VILC_ATOMIC_ADD(&vilc_mappingCache_stats.mergedRanges, count - merged);
+	return merged;
+}
+
+/* Makes the held flushes; called with the mutex held */
+static VkResult vilc_mappingCache_flushPending(void)
+{
+	VkResult result;
+	uint32_t count;
+
+	if (!vilc_mappingCache_pendingCount)
+		return VK_SUCCESS;
+
+	count = vilc_mappingCache_mergeRanges(vilc_mappingCache_pending, vilc_mappingCache_pendingCount);
+	result = vilc_mappingCache_next_vkFlushMappedMemoryRanges(vilc_mappingCache_device, count, vilc_mappingCache_pending);
+	VILC_ATOMIC_STORE(&vilc_mappingCache_pendingCount, 0);
+	VILC_ATOMIC_ADD(&vilc_mappingCache_stats.driverFlushes, 1);
+	return result;
+}
+
+/* Drops the held flushes of an allocation that is freed or unmapped; called with the mutex held */
+static void vilc_mappingCache_dropPending(VkDeviceMemory memory)
+{
+	uint32_t kept = 0, i;
+
+	for (i = 0; i < vilc_mappingCache_pendingCount; ++i)
+		if (vilc_mappingCache_pending[i].memory != memory)
+			vilc_mappingCache_pending[kept++] = vilc_mappingCache_pending[i];
+	VILC_ATOMIC_STORE(&vilc_mappingCache_pendingCount, kept);
+}
+
+/* Makes the held flushes before the device may read the memory they cover */
+static VkResult vilc_mappingCache_beforeQueueCall(void)
+{
+	VkResult result;
+
+	if (!VILC_ATOMIC_LOAD(&vilc_mappingCache_pendingCount))
+		return VK_SUCCESS;
+
+	pthread_mutex_lock(&vilc_mappingCache_mutex);
+	result = vilc_mappingCache_flushPending();
+	pthread_mutex_unlock(&vilc_mappingCache_mutex);
+	return result;
+}
+
+/* Returns a pointer into the cached mapping, mapping the allocation on the first call; VK_INCOMPLETE when the call has
+ * to be passed through
+ */
+static VkResult vilc_mappingCache_map(VkDevice device, VkDeviceMemory memory, VkDeviceSize offset, void** ppData)
+{
+	VilcMappingCacheMemory* entry;
+	VkResult result = VK_INCOMPLETE;
+	void* data;
+
+	if (device != vilc_mappingCache_device)
+		return VK_INCOMPLETE;
+
+	pthread_mutex_lock(&vilc_mappingCache_mutex);
+	entry = (VilcMappingCacheMemory*)vilc_mapFind(&vilc_mappingCache_memories, VILC_OBJECT_KEY(memory));
+	if (entry && !entry->data)
+	{
+		result = vilc_mappingCache_next_vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, &data);
+		if (result == VK_SUCCESS)
+		{
+			entry->data = (char*)data;
+			VILC_ATOMIC_ADD(&vilc_mappingCache_stats.driverMaps, 1);
+			VILC_ATOMIC_ADD(&vilc_mappingCache_stats.liveMappings, 1);
+			VILC_ATOMIC_ADD(&vilc_mappingCache_stats.mappedBytes, entry->size);
+		}
+	}
+	if (entry && entry->data)
+	{
+		*ppData = entry->data + offset;
+		entry->mapped = 1;
+		result = VK_SUCCESS;
+		VILC_ATOMIC_ADD(&vilc_mappingCache_stats.mapCalls, 1);
+	}
+	pthread_mutex_unlock(&vilc_mappingCache_mutex);
+
+	return result;
+}
+
+/* Marks the allocation unmapped; returns 0 when it is not cached and the call has to be passed through */
+static int vilc_mappingCache_unmap(VkDevice device, VkDeviceMemory memory)
+{
+	VilcMappingCacheMemory* entry;
+
+	if (device != vilc_mappingCache_device)
+		return 0;
+
+	pthread_mutex_lock(&vilc_mappingCache_mutex);
+	entry = (VilcMappingCacheMemory*)vilc_mapFind(&vilc_mappingCache_memories, VILC_OBJECT_KEY(memory));
+	if (entry && entry->data)
+	{
+		entry->mapped = 0;
+		VILC_ATOMIC_ADD(&vilc_mappingCache_stats.elidedUnmaps, 1);
+	}
+	pthread_mutex_unlock(&vilc_mappingCache_mutex);
+
+	return entry && entry->data;
+}
+
+/* Forgets the cached mapping before the driver unmaps it; called with the mutex held */
+static void vilc_mappingCache_forget(VkDeviceMemory memory, VilcMappingCacheMemory* entry)
+{
+	if (!entry->data)
+		return;
+
+	vilc_mappingCache_dropPending(memory);
+	entry->data = NULL;
+	entry->mapped = 0;
+	VILC_ATOMIC_ADD(&vilc_mappingCache_stats.liveMappings, (uint32_t)0 - 1);
+	VILC_ATOMIC_ADD(&vilc_mappingCache_stats.mappedBytes, (uint64_t)0 - entry->size);
+}
+
+void vilcGetMappingCacheStats(VilcMappingCacheStats* stats)
+{
+	stats->mapCalls = VILC_ATOMIC_LOAD(&vilc_mappingCache_stats.mapCalls);
+	stats->driverMaps = VILC_ATOMIC_LOAD(&vilc_mappingCache_stats.driverMaps);
+	stats->elidedUnmaps = VILC_ATOMIC_LOAD(&vilc_mappingCache_stats.elidedUnmaps);
+	stats->flushedRanges = VILC_ATOMIC_LOAD(&vilc_mappingCache_stats.flushedRanges);
+	stats->driverFlushes = VILC_ATOMIC_LOAD(&vilc_mappingCache_stats.driverFlushes);
+	stats->invalidatedRanges = VILC_ATOMIC_LOAD(&vilc_mappingCache_stats.invalidatedRanges);
+	stats->driverInvalidates = VILC_ATOMIC_LOAD(&vilc_mappingCache_stats.driverInvalidates);
+	stats->mergedRanges = VILC_ATOMIC_LOAD(&vilc_mappingCache_stats.mergedRanges);
+	stats->coherentRanges = VILC_ATOMIC_LOAD(&vilc_mappingCache_stats.coherentRanges);
+	stats->liveMappings = VILC_ATOMIC_LOAD(&vilc_mappingCache_stats.liveMappings);
+	stats->mappedBytes = VILC_ATOMIC_LOAD(&vilc_mappingCache_stats.mappedBytes);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_mappingCache_vkCreateDevice(VkPhysicalDevice physicalDevice, const VkDeviceCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDevice* pDevice)
+{
+	VkResult result = vilc_mappingCache_next_vkCreateDevice(physicalDevice, pCreateInfo, pAllocator, pDevice);
+
+	pthread_mutex_lock(&vilc_mappingCache_mutex);
+	/* a second device is passed through */
+	if (result == VK_SUCCESS && !vilc_mappingCache_device)
+	{
+		vilc_instance.vkGetPhysicalDeviceMemoryProperties(physicalDevice, &vilc_mappingCache_properties);
+		vilc_mappingCache_device = *pDevice;
+	}
+	pthread_mutex_unlock(&vilc_mappingCache_mutex);
+
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_mappingCache_vkDestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator)
+{
+	VilcMappingCacheStats stats;
+	uint32_t i;
+
+	if (device && device == vilc_mappingCache_device)
+	{
+		pthread_mutex_lock(&vilc_mappingCache_mutex);
+		for (i = 0; i < vilc_mappingCache_memories.capacity; ++i)
+			free(vilc_mappingCache_memories.values[i]);
+		vilc_mapFree(&vilc_mappingCache_memories);
+		free(vilc_mappingCache_pending);
+		vilc_mappingCache_pending = NULL;
+		vilc_mappingCache_pendingCount = 0;
+		vilc_mappingCache_pendingCapacity = 0;
+		vilc_mappingCache_device = VK_NULL_HANDLE;
+		pthread_mutex_unlock(&vilc_mappingCache_mutex);
+
+		vilcGetMappingCacheStats(&stats);
+		fprintf(stderr, "vilc: mapping cache: %llu maps made with %llu driver maps, %llu unmaps elided, %llu flushed ranges made with %llu driver flushes, %llu invalidated ranges with %llu driver invalidations, %llu ranges merged, %llu coherent ranges dropped\n",
+		    (unsigned long long)stats.mapCalls, (unsigned long long)stats.driverMaps, (unsigned long long)stats.elidedUnmaps,
+		    (unsigned long long)stats.flushedRanges, (unsigned long long)stats.driverFlushes, (unsigned long long)stats.invalidatedRanges,
+		    (unsigned long long)stats.driverInvalidates, (unsigned long long)stats.mergedRanges, (unsigned long long)stats.coherentRanges);
+	}
+
+	vilc_mappingCache_next_vkDestroyDevice(device, pAllocator);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_mappingCache_vkAllocateMemory(VkDevice device, const VkMemoryAllocateInfo* pAllocateInfo, const VkAllocationCallbacks* pAllocator, VkDeviceMemory* pMemory)
+{
+	VkResult result = vilc_mappingCache_next_vkAllocateMemory(device, pAllocateInfo, pAllocator, pMemory);
+	VkMemoryPropertyFlags flags;
+	VilcMappingCacheMemory* entry;
+
+	if (result != VK_SUCCESS || device != vilc_mappingCache_device || pAllocateInfo->memoryTypeIndex >= vilc_mappingCache_properties.memoryTypeCount)
+		return result;
+
+	flags = vilc_mappingCache_properties.memoryTypes[pAllocateInfo->memoryTypeIndex].propertyFlags;
+	if (!(flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) || (entry = (VilcMappingCacheMemory*)calloc(1, sizeof(VilcMappingCacheMemory))) == NULL)
+		return result;
+
+	entry->size = pAllocateInfo->allocationSize;
+	entry->coherent = (flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+
+	pthread_mutex_lock(&vilc_mappingCache_mutex);
+	if (!vilc_mapInsert(&vilc_mappingCache_memories, VILC_OBJECT_KEY(*pMemory), entry))
+		free(entry);
+	pthread_mutex_unlock(&vilc_mappingCache_mutex);
+
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_mappingCache_vkFreeMemory(VkDevice device, VkDeviceMemory memory, const VkAllocationCallbacks* pAllocator)
+{
+	VilcMappingCacheMemory* entry = NULL;
+
+	if (memory && device == vilc_mappingCache_device)
+	{
+		pthread_mutex_lock(&vilc_mappingCache_mutex);
+		entry = (VilcMappingCacheMemory*)vilc_mapRemove(&vilc_mappingCache_memories, VILC_OBJECT_KEY(memory));
+		if (entry)
+			vilc_mappingCache_forget(memory, entry);
+		pthread_mutex_unlock(&vilc_mappingCache_mutex);
+		free(entry);
+	}
+
+	/* freeing unmaps the allocation */
+	vilc_mappingCache_next_vkFreeMemory(device, memory, pAllocator);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_mappingCache_vkMapMemory(VkDevice device, VkDeviceMemory memory, VkDeviceSize offset, VkDeviceSize size, VkMemoryMapFlags flags, void** ppData)
+{
+	VkResult result = flags ? VK_INCOMPLETE : vilc_mappingCache_map(device, memory, offset, ppData);
+
+	if (result == VK_INCOMPLETE)
+		return vilc_mappingCache_next_vkMapMemory(device, memory, offset, size, flags, ppData);
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_mappingCache_vkUnmapMemory(VkDevice device, VkDeviceMemory memory)
+{
+	if (!vilc_mappingCache_unmap(device, memory))
+		vilc_mappingCache_next_vkUnmapMemory(device, memory);
+}
+
+/* Headers that define VK_VERSION_1_4 also define VK_KHR_map_memory2, whose structures the core ones alias */
+#if defined(VK_KHR_map_memory2)
+/* Returns VK_INCOMPLETE when the call has to be passed through */
+static VkResult vilc_mappingCache_map2(VkDevice device, const VkMemoryMapInfoKHR* pMemoryMapInfo, void** ppData)
+{
+	if (pMemoryMapInfo->flags || pMemoryMapInfo->pNext)
+		return VK_INCOMPLETE;
+	return vilc_mappingCache_map(device, pMemoryMapInfo->memory, pMemoryMapInfo->offset, ppData);
+}
+
+/* Returns 0 when the call has to be passed through, after the cached mapping was forgotten when it had flags */
+static int vilc_mappingCache_unmap2(VkDevice device, const VkMemoryUnmapInfoKHR* pMemoryUnmapInfo)
+{
+	VilcMappingCacheMemory* entry;
+
+	if (!pMemoryUnmapInfo->flags && !pMemoryUnmapInfo->pNext)
+		return vilc_mappingCache_unmap(device, pMemoryUnmapInfo->memory);
+
+	if (device == vilc_mappingCache_device)
+	{
+		/* the driver unmaps the whole allocation, so flushes held for it are made first */
+		pthread_mutex_lock(&vilc_mappingCache_mutex);
+		entry = (VilcMappingCacheMemory*)vilc_mapFind(&vilc_mappingCache_memories, VILC_OBJECT_KEY(pMemoryUnmapInfo->memory));
+		if (entry && entry->data)
+		{
+			vilc_mappingCache_flushPending();
+			vilc_mappingCache_forget(pMemoryUnmapInfo->memory, entry);
+		}
+		pthread_mutex_unlock(&vilc_mappingCache_mutex);
+	}
+	return 0;
+}
+#endif /* defined(VK_KHR_map_memory2) */
+
+#if defined(VK_VERSION_1_4)
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_mappingCache_vkMapMemory2(VkDevice device, const VkMemoryMapInfo* pMemoryMapInfo, void** ppData)
+{
+	VkResult result = vilc_mappingCache_map2(device, pMemoryMapInfo, ppData);
+
+	if (result == VK_INCOMPLETE)
+		return vilc_mappingCache_next_vkMapMemory2(device, pMemoryMapInfo, ppData);
+	return result;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_mappingCache_vkUnmapMemory2(VkDevice device, const VkMemoryUnmapInfo* pMemoryUnmapInfo)
+{
+	if (vilc_mappingCache_unmap2(device, pMemoryUnmapInfo))
+		return VK_SUCCESS;
+	return vilc_mappingCache_next_vkUnmapMemory2(device, pMemoryUnmapInfo);
+}
+#endif /* defined(VK_VERSION_1_4) */
+
+#if defined(VK_KHR_map_memory2)
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_mappingCache_vkMapMemory2KHR(VkDevice device, const VkMemoryMapInfoKHR* pMemoryMapInfo, void** ppData)
+{
+	VkResult result = vilc_mappingCache_map2(device, pMemoryMapInfo, ppData);
+
+	if (result == VK_INCOMPLETE)
+		return vilc_mappingCache_next_vkMapMemory2KHR(device, pMemoryMapInfo, ppData);
+	return result;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_mappingCache_vkUnmapMemory2KHR(VkDevice device, const VkMemoryUnmapInfoKHR* pMemoryUnmapInfo)
+{
+	if (vilc_mappingCache_unmap2(device, pMemoryUnmapInfo))
+		return VK_SUCCESS;
+	return vilc_mappingCache_next_vkUnmapMemory2KHR(device, pMemoryUnmapInfo);
+}
+#endif /* defined(VK_KHR_map_memory2) */
+
+/* Copies the ranges of cached mappings that are not host-coherent with their sizes resolved; returns how many were
+ * copied, or ~0u when one of the ranges is not in a cached mapping and the call has to be passed through
+ */
+static uint32_t vilc_mappingCache_resolveRanges(uint32_t memoryRangeCount, const VkMappedMemoryRange* pMemoryRanges, VkMappedMemoryRange* ranges)
+{
+	uint32_t count = 0, i;
+
+	for (i = 0; i < memoryRangeCount; ++i)
+	{
+		const VilcMappingCacheMemory* entry = (const VilcMappingCacheMemory*)vilc_mapFind(&vilc_mappingCache_memories, VILC_OBJECT_KEY(pMemoryRanges[i].memory));
+
+		if (!entry || !entry->data || pMemoryRanges[i].pNext)
+			return ~0u;
+		if (entry->coherent)
+			continue;
+
+		ranges[count] = pMemoryRanges[i];
+		/* VK_WHOLE_SIZE ends at the end of the mapping of the application, which ends at most where this one does */
+		if (ranges[count].size == VK_WHOLE_SIZE)
+			ranges[count].size = entry->size - ranges[count].offset;
+		count++;
+	}
+
+	VILC_ATOMIC_ADD(&vilc_mappingCache_stats.coherentRanges, memoryRangeCount - count);
+	return count;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_mappingCache_vkFlushMappedMemoryRanges(VkDevice device, uint32_t memoryRangeCount, const VkMappedMemoryRange* pMemoryRanges)
+{
+	uint32_t capacity, count;
+
+	if (device != vilc_mappingCache_device)
+		return vilc_mappingCache_next_vkFlushMappedMemoryRanges(device, memoryRangeCount, pMemoryRanges);
+
+	pthread_mutex_lock(&vilc_mappingCache_mutex);
+	if (vilc_mappingCache_pendingCount + memoryRangeCount > vilc_mappingCache_pendingCapacity)
+	{
+		VkMappedMemoryRange* grown;
+
+		for (capacity = vilc_mappingCache_pendingCapacity ? vilc_mappingCache_pendingCapacity : 64; capacity < vilc_mappingCache_pendingCount + memoryRangeCount;)
+			capacity *= 2;
+		grown = (VkMappedMemoryRange*)realloc(vilc_mappingCache_pending, capacity * sizeof(VkMappedMemoryRange));
+		if (!grown)
+		{
+			pthread_mutex_unlock(&vilc_mappingCache_mutex);
+			return vilc_mappingCache_next_vkFlushMappedMemoryRanges(device, memoryRangeCount, pMemoryRanges);
+		}
+		vilc_mappingCache_pending = grown;
+		vilc_mappingCache_pendingCapacity = capacity;
+	}
+
+	count = vilc_mappingCache_resolveRanges(memoryRangeCount, pMemoryRanges, vilc_mappingCache_pending + vilc_mappingCache_pendingCount);
+	if (count == ~0u)
+	{
+		pthread_mutex_unlock(&vilc_mappingCache_mutex);
+		return vilc_mappingCache_next_vkFlushMappedMemoryRanges(device, memoryRangeCount, pMemoryRanges);
+	}
+	VILC_ATOMIC_STORE(&vilc_mappingCache_pendingCount, vilc_mappingCache_pendingCount + count);
+	VILC_ATOMIC_ADD(&vilc_mappingCache_stats.flushedRanges, memoryRangeCount);
+	pthread_mutex_unlock(&vilc_mappingCache_mutex);
+
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_mappingCache_vkInvalidateMappedMemoryRanges(VkDevice device, uint32_t memoryRangeCount, const VkMappedMemoryRange* pMemoryRanges)
+{
+	VkMappedMemoryRange* ranges;
+	VkResult result;
+	uint32_t count;
+
+	if (device != vilc_mappingCache_device || !(ranges = (VkMappedMemoryRange*)malloc((memoryRangeCount ? memoryRangeCount : 1) * sizeof(VkMappedMemoryRange))))
+		return vilc_mappingCache_next_vkInvalidateMappedMemoryRanges(device, memoryRangeCount, pMemoryRanges);
+
+	pthread_mutex_lock(&vilc_mappingCache_mutex);
+	/* invalidation drops host writes that were not flushed yet */
+	result = vilc_mappingCache_flushPending();
+	count = vilc_mappingCache_resolveRanges(memoryRangeCount, pMemoryRanges, ranges);
+	if (result == VK_SUCCESS && count == ~0u)
+		result = vilc_mappingCache_next_vkInvalidateMappedMemoryRanges(device, memoryRangeCount, pMemoryRanges);
+	else if (result == VK_SUCCESS)
+	{
+		VILC_ATOMIC_ADD(&vilc_mappingCache_stats.invalidatedRanges, memoryRangeCount);
+		count = vilc_mappingCache_mergeRanges(ranges, count);
+		if (count)
+		{
+			result = vilc_mappingCache_next_vkInvalidateMappedMemoryRanges(device, count, ranges);
+			VILC_ATOMIC_ADD(&vilc_mappingCache_stats.driverInvalidates, 1);
+		}
+	}
+	pthread_mutex_unlock(&vilc_mappingCache_mutex);
+
+	free(ranges);
+	return result;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_mappingCache_vkQueueSubmit(VkQueue queue, uint32_t submitCount, const VkSubmitInfo* pSubmits, VkFence fence)
+{
+	VkResult result = vilc_mappingCache_beforeQueueCall();
+
+	return result != VK_SUCCESS ? result : vilc_mappingCache_next_vkQueueSubmit(queue, submitCount, pSubmits, fence);
+}
+
+#if defined(VK_VERSION_1_3)
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_mappingCache_vkQueueSubmit2(VkQueue queue, uint32_t submitCount, const VkSubmitInfo2* pSubmits, VkFence fence)
+{
+	VkResult result = vilc_mappingCache_beforeQueueCall();
+
+	return result != VK_SUCCESS ? result : vilc_mappingCache_next_vkQueueSubmit2(queue, submitCount, pSubmits, fence);
+}
+#endif /* defined(VK_VERSION_1_3) */
+
+#if defined(VK_KHR_synchronization2)
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_mappingCache_vkQueueSubmit2KHR(VkQueue queue, uint32_t submitCount, const VkSubmitInfo2* pSubmits, VkFence fence)
+{
+	VkResult result = vilc_mappingCache_beforeQueueCall();
+
+	return result != VK_SUCCESS ? result : vilc_mappingCache_next_vkQueueSubmit2KHR(queue, submitCount, pSubmits, fence);
+}
+#endif /* defined(VK_KHR_synchronization2) */
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_mappingCache_vkQueueBindSparse(VkQueue queue, uint32_t bindInfoCount, const VkBindSparseInfo* pBindInfo, VkFence fence)
+{
+	VkResult result = vilc_mappingCache_beforeQueueCall();
+
+	return result != VK_SUCCESS ? result : vilc_mappingCache_next_vkQueueBindSparse(queue, bindInfoCount, pBindInfo, fence);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_mappingCache_vkSetEvent(VkDevice device, VkEvent event)
+{
+	VkResult result = vilc_mappingCache_beforeQueueCall();
+
+	return result != VK_SUCCESS ? result : vilc_mappingCache_next_vkSetEvent(device, event);
+}
+
+#if defined(VK_VERSION_1_2)
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_mappingCache_vkSignalSemaphore(VkDevice device, const VkSemaphoreSignalInfo* pSignalInfo)
+{
+	VkResult result = vilc_mappingCache_beforeQueueCall();
+
+	return result != VK_SUCCESS ? result : vilc_mappingCache_next_vkSignalSemaphore(device, pSignalInfo);
+}
+#endif
+
+#if defined(VK_KHR_timeline_semaphore)
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_mappingCache_vkSignalSemaphoreKHR(VkDevice device, const VkSemaphoreSignalInfo* pSignalInfo)
+{
+	VkResult result = vilc_mappingCache_beforeQueueCall();
+
+	return result != VK_SUCCESS ? result : vilc_mappingCache_next_vkSignalSemaphoreKHR(device, pSignalInfo);
+}
+#endif
+
+static void vilc_mappingCache_installInstance(void)
+{
+	VILC_LAYER_HOOK(vilc_mappingCache, vkCreateDevice)
+}
+
+static void vilc_mappingCache_installDevice(void)
+{
+	VILC_LAYER_HOOK(vilc_mappingCache, vkDestroyDevice)
+	VILC_LAYER_HOOK(vilc_mappingCache, vkAllocateMemory)
+	VILC_LAYER_HOOK(vilc_mappingCache, vkFreeMemory)
+	VILC_LAYER_HOOK(vilc_mappingCache, vkMapMemory)
+	VILC_LAYER_HOOK(vilc_mappingCache, vkUnmapMemory)
+	VILC_LAYER_HOOK(vilc_mappingCache, vkFlushMappedMemoryRanges)
+	VILC_LAYER_HOOK(vilc_mappingCache, vkInvalidateMappedMemoryRanges)
+	VILC_LAYER_HOOK(vilc_mappingCache, vkQueueSubmit)
+	VILC_LAYER_HOOK(vilc_mappingCache, vkQueueBindSparse)
+	VILC_LAYER_HOOK(vilc_mappingCache, vkSetEvent)
+#if defined(VK_VERSION_1_2)
+	VILC_LAYER_HOOK(vilc_mappingCache, vkSignalSemaphore)
+#endif
+#if defined(VK_VERSION_1_3)
+	VILC_LAYER_HOOK(vilc_mappingCache, vkQueueSubmit2)
+#endif
+#if defined(VK_VERSION_1_4)
+	VILC_LAYER_HOOK(vilc_mappingCache, vkMapMemory2)
+	VILC_LAYER_HOOK(vilc_mappingCache, vkUnmapMemory2)
+#endif
+#if defined(VK_KHR_synchronization2)
+	VILC_LAYER_HOOK(vilc_mappingCache, vkQueueSubmit2KHR)
+#endif
+#if defined(VK_KHR_map_memory2)
+	VILC_LAYER_HOOK(vilc_mappingCache, vkMapMemory2KHR)
+	VILC_LAYER_HOOK(vilc_mappingCache, vkUnmapMemory2KHR)
+#endif
+#if defined(VK_KHR_timeline_semaphore)
+	VILC_LAYER_HOOK(vilc_mappingCache, vkSignalSemaphoreKHR)
+#endif
+}
+#endif /* VILC_MAPPING_CACHE */
+
+
+#if defined(VOLK_IN_LOADERS_CLOTH) && defined(VILC_MEMORY_SUBALLOCATOR)
+/* Memory suballocator: vkAllocateMemory calls of up to an eighth of a block are served from blocks of
+ * VILC_MEMORY_SUBALLOCATOR_BLOCK_SIZE bytes (64 MiB by default, at most an eighth of the heap) allocated from the
+ * driver per memory type, each split by a buddy allocator. The application gets the address of the suballocation as its
+ * VkDeviceMemory handle, which the calls that take one translate to the block and the offset of the suballocation in it.
+ * Buddy nodes are powers of two of at least a page, bufferImageGranularity and nonCoherentAtomSize, aligned to their
+ * size, so a resource bound at an offset aligned as its memory requirements ask stays aligned in the block as long as
+ * that alignment is not larger than the allocation, and resources of different allocations never share a page.
+ * Blocks are mapped whole at the first map of one of their suballocations and stay mapped until they are freed.
+ * Allocations with pNext structures other than VkMemoryAllocateFlagsInfo asking for device addresses only (dedicated,
+ * imported, exported, with a priority...) and allocations of lazily allocated memory pass through, as do allocations
+ * when a block cannot be allocated. A block whose last suballocation is freed is kept while it is the only empty block
+ * of its memory type.
+ */
+#define VILC_MEMORY_SUBALLOCATOR_BLOCK_SIZE (64ull << 20)
+#define VILC_MEMORY_SUBALLOCATOR_MIN_NODE_SIZE 4096
+/* suballocations and blocks are at most this many orders smaller than their heap and block */
+#define VILC_MEMORY_SUBALLOCATOR_ORDERS 3
+
+typedef struct VilcMemorySuballocatorBlock
+{
+	VkDeviceMemory memory;
+	struct VilcMemorySuballocatorBlock* next;
+	char* data; /* the mapping of the whole block, NULL until the first map */
+	uint32_t liveCount;
+	/* per buddy node, 1 + the order of the largest free node under it or 0; node 1 is the block, node i has the
+	 * children 2i and 2i + 1, and nodes of order o are vilc_memorySuballocator_nodeSize << o bytes
+	 */
+	uint8_t tree[1];
+} VilcMemorySuballocatorBlock;
+
+typedef struct VilcMemorySuballocation
+{
+	VilcMemorySuballocatorBlock* block;
+	VkDeviceSize offset;
+	VkDeviceSize size;
+	uint32_t order;
+	uint32_t pool;
+} VilcMemorySuballocation;
+
+static pthread_mutex_t vilc_memorySuballocator_mutex = PTHREAD_MUTEX_INITIALIZER;
+static VkDevice vilc_memorySuballocator_device;
+static VkPhysicalDeviceMemoryProperties vilc_memorySuballocator_properties;
+static VkDeviceSize vilc_memorySuballocator_nodeSize;
+static VkDeviceSize vilc_memorySuballocator_blockSize;
+/* the order of the blocks of each memory type, 0 when its heap is too small for blocks */
+static uint32_t vilc_memorySuballocator_orders[VK_MAX_MEMORY_TYPES];
+/* blocks per memory type, twice: without and with device addresses */
+static VilcMemorySuballocatorBlock* vilc_memorySuballocator_pools[VK_MAX_MEMORY_TYPES * 2];
+/* suballocations by the handle the application got */
+static VilcHandleMap vilc_memorySuballocator_suballocations;
+static VilcMemorySuballocatorStats vilc_memorySuballocator_stats;
+
+VILC_LAYER_NEXT(vilc_memorySuballocator, vkCreateDevice)
+VILC_LAYER_NEXT(vilc_memorySuballocator, vkDestroyDevice)
+VILC_LAYER_NEXT(vilc_memorySuballocator, vkAllocateMemory)
+VILC_LAYER_NEXT(vilc_memorySuballocator, vkFreeMemory)
+VILC_LAYER_NEXT(vilc_memorySuballocator, vkMapMemory)
+VILC_LAYER_NEXT(vilc_memorySuballocator, vkUnmapMemory)
+VILC_LAYER_NEXT(vilc_memorySuballocator, vkFlushMappedMemoryRanges)
+VILC_LAYER_NEXT(vilc_memorySuballocator, vkInvalidateMappedMemoryRanges)
+VILC_LAYER_NEXT(vilc_memorySuballocator, vkGetDeviceMemoryCommitment)
+VILC_LAYER_NEXT(vilc_memorySuballocator, vkBindBufferMemory)
+VILC_LAYER_NEXT(vilc_memorySuballocator, vkBindImageMemory)
+VILC_LAYER_NEXT(vilc_memorySuballocator, vkQueueBindSparse)
+#if defined(VK_VERSION_1_1)
+VILC_LAYER_NEXT(vilc_memorySuballocator, vkBindBufferMemory2)
+VILC_LAYER_NEXT(vilc_memorySuballocator, vkBindImageMemory2)
+#endif
+#if defined(VK_VERSION_1_4)
+VILC_LAYER_NEXT(vilc_memorySuballocator, vkMapMemory2)
+VILC_LAYER_NEXT(vilc_memorySuballocator, vkUnmapMemory2)
+#endif
+#if defined(VK_KHR_bind_memory2)
+VILC_LAYER_NEXT(vilc_memorySuballocator, vkBindBufferMemory2KHR)
+VILC_LAYER_NEXT(vilc_memorySuballocator, vkBindImageMemory2KHR)
+#endif
+#if defined(VK_KHR_map_memory2)
+VILC_LAYER_NEXT(vilc_memorySuballocator, vkMapMemory2KHR)
+VILC_LAYER_NEXT(vilc_memorySuballocator, vkUnmapMemory2KHR)
+#endif
+#if defined(VK_EXT_pageable_device_local_memory)
+VILC_LAYER_NEXT(vilc_memorySuballocator, vkSetDeviceMemoryPriorityEXT)
+#endif
+#if defined(VK_EXT_debug_utils)
+VILC_LAYER_NEXT(vilc_memorySuballocator, vkSetDebugUtilsObjectNameEXT)
+VILC_LAYER_NEXT(vilc_memorySuballocator, vkSetDebugUtilsObjectTagEXT)
+#endif
+
+/* 1 + the order of the largest free node under a node of the given order, from its children */
+static uint8_t vilc_memorySuballocator_combine(const uint8_t* tree, uint32_t node, uint32_t order)
+{
+	uint8_t left = tree[node * 2], right = tree[node * 2 + 1];
+
+	/* both children are free as a whole */
+	if (left == order && right == order)
+		return (uint8_t)(order + 1);
+	return left > right ? left : right;
+}
+
+static void vilc_memorySuballocator_updateParents(uint8_t* tree, uint32_t node, uint32_t order)
+{
+	for (; node > 1; node /= 2)
+		tree[node / 2] = vilc_memorySuballocator_combine(tree, node / 2, ++order);
+}
+
+static void vilc_memorySuballocator_initTree(uint8_t* tree, uint32_t blockOrder)
+{
+	uint32_t depth;
+
+	for (depth = 0; depth <= blockOrder; ++depth)
+		memset(tree + (1u << depth), (int)(blockOrder - depth + 1), (size_t)1 << depth);
+}
+
+/* Takes a free node of the given order, descending into the child whose largest free node fits the tightest; returns
+ * its offset in the block, or ~0 when the block has no free node that large
+ */
+static VkDeviceSize vilc_memorySuballocator_takeNode(uint8_t* tree, uint32_t blockOrder, uint32_t order)
+{
+	uint32_t node = 1, nodeOrder;
+
+	if (tree[1] < order + 1)
+		return ~(VkDeviceSize)0;
+
+	for (nodeOrder = blockOrder; nodeOrder > order; --nodeOrder)
+	{
+		uint8_t left = tree[node * 2], right = tree[node * 2 + 1];
+
+		node = node * 2 + (left < order + 1 || (right >= order + 1 && right < left) ? 1 : 0);
+	}
+	tree[node] = 0;
+	vilc_memorySuballocator_updateParents(tree, node, order);
+
+	return (VkDeviceSize)(node - (1u << (blockOrder - order))) * (vilc_memorySuballocator_nodeSize << order);
+}
+
+static void vilc_memorySuballocator_releaseNode(uint8_t* tree, uint32_t blockOrder, uint32_t order, VkDeviceSize offset)
+{
+	uint32_t node = (1u << (blockOrder - order)) + (uint32_t)(offset / (vilc_memorySuballocator_nodeSize << order));
+
+	tree[node] = (uint8_t)(order + 1);
+	vilc_memorySuballocator_updateParents(tree, node, order);
+}
+
+/* Returns the pool of an allocation that can be suballocated, or ~0u when it has to be passed through */
+static uint32_t vilc_memorySuballocator_pool(const VkMemoryAllocateInfo* pAllocateInfo)
+{
+	const VkBaseInStructure* next;
+	uint32_t type = pAllocateInfo->memoryTypeIndex, deviceAddress = 0;
+
+	if (type >= vilc_memorySuballocator_properties.memoryTypeCount || !vilc_memorySuballocator_orders[type] ||
+	    (vilc_memorySuballocator_properties.memoryTypes[type].propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT) ||
+	    pAllocateInfo->allocationSize > vilc_memorySuballocator_nodeSize << (vilc_memorySuballocator_orders[type] - VILC_MEMORY_SUBALLOCATOR_ORDERS))
+		return ~0u;
+
+	for (next = (const VkBaseInStructure*)pAllocateInfo->pNext; next; next = next->pNext)
+	{
+#if defined(VK_VERSION_1_2)
+		if (next->sType == VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO && ((const VkMemoryAllocateFlagsInfo*)next)->flags == VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT)
+		{
+			deviceAddress = 1;
+			continue;
+		}
+#endif
+		return ~0u;
+	}
+
+	return type * 2 + deviceAddress;
+}
+
+/* Allocates a block for a pool; called with the mutex held */
+static VilcMemorySuballocatorBlock* vilc_memorySuballocator_addBlock(VkDevice device, uint32_t pool)
+{
+	uint32_t blockOrder = vilc_memorySuballocator_orders[pool / 2];
+	VkMemoryAllocateInfo allocateInfo;
+	VilcMemorySuballocatorBlock* block;
+#if defined(VK_VERSION_1_2)
+	VkMemoryAllocateFlagsInfo flagsInfo;
+#endif
+
+	block = (VilcMemorySuballocatorBlock*)calloc(1, sizeof(VilcMemorySuballocatorBlock) + ((size_t)2 << blockOrder));
+	if (!block)
+		return NULL;
+
+	memset(&allocateInfo, 0, sizeof(allocateInfo));
+	allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocateInfo.allocationSize = vilc_memorySuballocator_nodeSize << blockOrder;
+	allocateInfo.memoryTypeIndex = pool / 2;
+#if defined(VK_VERSION_1_2)
+	if (pool % 2)
+	{
+		memset(&flagsInfo, 0, sizeof(flagsInfo));
+		flagsInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
+		flagsInfo.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT;
+		allocateInfo.pNext = &flagsInfo;
+	}
+#endif
+
+	if (vilc_memorySuballocator_next_vkAllocateMemory(device, &allocateInfo, NULL, &block->memory) != VK_SUCCESS)
+	{
+		free(block);
+		return NULL;
+	}
+
+	vilc_memorySuballocator_initTree(block->tree, blockOrder);
+	block->next = vilc_memorySuballocator_pools[pool];
+	vilc_memorySuballocator_pools[pool] = block;
+
+	VILC_ATOMIC_ADD(&vilc_memorySuballocator_stats.blockAllocations, 1);
+	VILC_ATOMIC_ADD(&vilc_memorySuballocator_stats.liveBlocks, 1);
+	VILC_ATOMIC_ADD(&vilc_memorySuballocator_stats.blockBytes, allocateInfo.allocationSize);
+	return block;
+}
+
+/* Frees an empty block unless it is the only empty one of its pool; called with the mutex held */
+static void vilc_memorySuballocator_trimBlock(VkDevice device, uint32_t pool, VilcMemorySuballocatorBlock* block)
+{
+	VilcMemorySuballocatorBlock** link;
+	VilcMemorySuballocatorBlock* other;
+
+	for (other = vilc_memorySuballocator_pools[pool]; other; other = other->next)
+		if (other != block && !other->liveCount)
+			break;
+	if (!other)
+		return;
+
+	for (link = &vilc_memorySuballocator_pools[pool]; *link != block; link = &(*link)->next)
+		;
+	*link = block->next;
+
+	vilc_memorySuballocator_next_vkFreeMemory(device, block->memory, NULL);
+	VILC_ATOMIC_ADD(&vilc_memorySuballocator_stats.liveBlocks, (uint32_t)0 - 1);
+	VILC_ATOMIC_ADD(&vilc_memorySuballocator_stats.blockBytes, (uint64_t)0 - (vilc_memorySuballocator_nodeSize << vilc_memorySuballocator_orders[pool / 2]));
+	free(block);
+}
+
+static VilcMemorySuballocation* vilc_memorySuballocator_find(uint64_t key)
+{
+	VilcMemorySuballocation* suballocation;
+
+	if (!key || !VILC_ATOMIC_LOAD(&vilc_memorySuballocator_stats.liveSuballocations))
+		return NULL;
+
+	pthread_mutex_lock(&vilc_memorySuballocator_mutex);
+	suballocation = (VilcMemorySuballocation*)vilc_mapFind(&vilc_memorySuballocator_suballocations, key);
+	pthread_mutex_unlock(&vilc_memorySuballocator_mutex);
+	return suballocation;
+}
+
+/* Returns a pointer into the mapping of the block of a suballocation, mapping the block on the first call */
+static VkResult vilc_memorySuballocator_map(VkDevice device, VilcMemorySuballocation* suballocation, VkDeviceSize offset, void** ppData)
+{
+	VilcMemorySuballocatorBlock* block = suballocation->block;
+	VkResult result = VK_SUCCESS;
+	void* data;
+
+	pthread_mutex_lock(&vilc_memorySuballocator_mutex);
+	if (!block->data)
+	{
+		result = vilc_memorySuballocator_next_vkMapMemory(device, block->memory, 0, VK_WHOLE_SIZE, 0, &data);
+		if (result == VK_SUCCESS)
+			block->data = (char*)data;
+	}
+	if (result == VK_SUCCESS)
+		*ppData = block->data + suballocation->offset + offset;
+	pthread_mutex_unlock(&vilc_memorySuballocator_mutex);
+
+	return result;
+}
+
+/* Translates ranges of suballocations into a copy; *pCopy stays NULL when there are none. Ranges that end at the end
+ * of the allocation are extended to the end of its node, which is a multiple of nonCoherentAtomSize in the block.
+ */
+static VkResult vilc_memorySuballocator_translateRanges(uint32_t memoryRangeCount, const VkMappedMemoryRange* pMemoryRanges, VkMappedMemoryRange** pCopy)
+{
+	VkMappedMemoryRange* copy = NULL;
+	uint32_t i;
+
+	for (i = 0; i < memoryRangeCount; ++i)
+	{
+		VilcMemorySuballocation* suballocation = vilc_memorySuballocator_find(VILC_OBJECT_KEY(pMemoryRanges[i].memory));
+		VkDeviceSize nodeSize;
+
+		if (!suballocation)
+			continue;
+		if (!copy)
+		{
+			if ((copy = (VkMappedMemoryRange*)malloc(memoryRangeCount * sizeof(VkMappedMemoryRange))) == NULL)
+				return VK_ERROR_OUT_OF_HOST_MEMORY;
+			memcpy(copy, pMemoryRanges, memoryRangeCount * sizeof(VkMappedMemoryRange));
+		}
+		nodeSize = vilc_memorySuballocator_nodeSize << suballocation->order;
+		copy[i].memory = suballocation->block->memory;
+		copy[i].offset = suballocation->offset + pMemoryRanges[i].offset;
+		if (pMemoryRanges[i].size == VK_WHOLE_SIZE || pMemoryRanges[i].offset + pMemoryRanges[i].size >= suballocation->size)
+			copy[i].size = nodeSize - pMemoryRanges[i].offset;
+	}
+
+	*pCopy = copy;
+	return VK_SUCCESS;
+}
+
+/* Headers that define VK_VERSION_1_1 also define VK_KHR_bind_memory2, whose structures the core ones alias */
+#if defined(VK_KHR_bind_memory2)
+/* Translates binds to suballocations into a copy; *pCopy stays NULL when there are none */
+static VkResult vilc_memorySuballocator_translateBufferBinds(uint32_t bindInfoCount, const VkBindBufferMemoryInfoKHR* pBindInfos, VkBindBufferMemoryInfoKHR** pCopy)
+{
+	VkBindBufferMemoryInfoKHR* copy = NULL;
+	uint32_t i;
+
+	for (i = 0; i < bindInfoCount; ++i)
+	{
+		VilcMemorySuballocation* suballocation = vilc_memorySuballocator_find(VILC_OBJECT_KEY(pBindInfos[i].memory));
+
+		if (!suballocation)
+			continue;
+		if (!copy)
+		{
+			if ((copy = (VkBindBufferMemoryInfoKHR*)malloc(bindInfoCount * sizeof(VkBindBufferMemoryInfoKHR))) == NULL)
+				return VK_ERROR_OUT_OF_HOST_MEMORY;
+			memcpy(copy, pBindInfos, bindInfoCount * sizeof(VkBindBufferMemoryInfoKHR));
+		}
+		copy[i].memory = suballocation->block->memory;
+		copy[i].memoryOffset += suballocation->offset;
+	}
+
+	*pCopy = copy;
+	return VK_SUCCESS;
+}
+
+static VkResult vilc_memorySuballocator_translateImageBinds(uint32_t bindInfoCount, const VkBindImageMemoryInfoKHR* pBindInfos, VkBindImageMemoryInfoKHR** pCopy)
+{
+	VkBindImageMemoryInfoKHR* copy = NULL;
+	uint32_t i;
+
+	for (i = 0; i < bindInfoCount; ++i)
+	{
+		VilcMemorySuballocation* suballocation = vilc_memorySuballocator_find(VILC_OBJECT_KEY(pBindInfos[i].memory));
+
+		if (!suballocation)
+			continue;
+		if (!copy)
+		{
+			if ((copy = (VkBindImageMemoryInfoKHR*)malloc(bindInfoCount * sizeof(VkBindImageMemoryInfoKHR))) == NULL)
+				return VK_ERROR_OUT_OF_HOST_MEMORY;
+			memcpy(copy, pBindInfos, bindInfoCount * sizeof(VkBindImageMemoryInfoKHR));
+		}
+		copy[i].memory = suballocation->block->memory;
+		copy[i].memoryOffset += suballocation->offset;
+	}
+
+	*pCopy = copy;
+	return VK_SUCCESS;
+}
+#endif /* defined(VK_KHR_bind_memory2) */
+
+static void vilc_memorySuballocator_translateSparseBind(VkDeviceMemory* memory, VkDeviceSize* memoryOffset)
+{
+	VilcMemorySuballocation* suballocation = vilc_memorySuballocator_find(VILC_OBJECT_KEY(*memory));
+
+	if (suballocation)
+	{
+		*memory = suballocation->block->memory;
+		*memoryOffset += suballocation->offset;
+	}
+}
+
+/* Translates sparse binds to suballocations into a copy of the whole call, in one allocation that starts with the
+ * VkBindSparseInfo array; *pCopy stays NULL when there are none
+ */
+static VkResult vilc_memorySuballocator_translateSparseBinds(uint32_t bindInfoCount, const VkBindSparseInfo* pBindInfo, VkBindSparseInfo** pCopy)
+{
+	size_t memoryBindCount = 0, imageBindCount = 0, bufferInfoCount = 0, opaqueInfoCount = 0, imageInfoCount = 0, infoSize;
+	VkSparseMemoryBind* memoryBinds;
+	VkSparseImageMemoryBind* imageBinds;
+	VkSparseBufferMemoryBindInfo* bufferInfos;
+	VkSparseImageOpaqueMemoryBindInfo* opaqueInfos;
+	VkSparseImageMemoryBindInfo* imageInfos;
+	VkBindSparseInfo* copy;
+	uint32_t suballocated = 0, i, j, k;
+
+	*pCopy = NULL;
+	for (i = 0; i < bindInfoCount; ++i)
+	{
+		const VkBindSparseInfo* info = &pBindInfo[i];
+
+		for (j = 0; j < info->bufferBindCount; ++j)
+			for (k = 0; k < info->pBufferBinds[j].bindCount; ++k, ++memoryBindCount)
+				suballocated |= vilc_memorySuballocator_find(VILC_OBJECT_KEY(info->pBufferBinds[j].pBinds[k].memory)) != NULL;
+		for (j = 0; j < info->imageOpaqueBindCount; ++j)
+			for (k = 0; k < info->pImageOpaqueBinds[j].bindCount; ++k, ++memoryBindCount)
+				suballocated |= vilc_memorySuballocator_find(VILC_OBJECT_KEY(info->pImageOpaqueBinds[j].pBinds[k].memory)) != NULL;
+		for (j = 0; j < info->imageBindCount; ++j)
+			for (k = 0; k < info->pImageBinds[j].bindCount; ++k, ++imageBindCount)
+				suballocated |= vilc_memorySuballocator_find(VILC_OBJECT_KEY(info->pImageBinds[j].pBinds[k].memory)) != NULL;
+		bufferInfoCount += info->bufferBindCount;
+		opaqueInfoCount += info->imageOpaqueBindCount;
+		imageInfoCount += info->imageBindCount;
+	}
+	if (!suballocated)
+		return VK_SUCCESS;
+
+	/* the arrays after the VkBindSparseInfo one all hold 64-bit members and sizes that are multiples of 8 */
+	infoSize = (bindInfoCount * sizeof(VkBindSparseInfo) + 7) & ~(size_t)7;
+	copy = (VkBindSparseInfo*)malloc(infoSize + memoryBindCount * sizeof(VkSparseMemoryBind) + imageBindCount * sizeof(VkSparseImageMemoryBind) +
+	    bufferInfoCount * sizeof(VkSparseBufferMemoryBindInfo) + opaqueInfoCount * sizeof(VkSparseImageOpaqueMemoryBindInfo) + imageInfoCount * sizeof(VkSparseImageMemoryBindInfo));
+	if (!copy)
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+
+	memoryBinds = (VkSparseMemoryBind*)((char*)copy + infoSize);
+	imageBinds = (VkSparseImageMemoryBind*)(memoryBinds + memoryBindCount);
+	bufferInfos = (VkSparseBufferMemoryBindInfo*)(imageBinds + imageBindCount);
+	opaqueInfos = (VkSparseImageOpaqueMemoryBindInfo*)(bufferInfos + bufferInfoCount);
+	imageInfos = (VkSparseImageMemoryBindInfo*)(opaqueInfos + opaqueInfoCount);
+
+	for (i = 0; i < bindInfoCount; ++i)
+	{
+		const VkBindSparseInfo* info = &pBindInfo[i];
+
+		copy[i] = *info;
+		copy[i].pBufferBinds = bufferInfos;
+		copy[i].pImageOpaqueBinds = opaqueInfos;
+		copy[i].pImageBinds = imageInfos;
+		for (j = 0; j < info->bufferBindCount; ++j, ++bufferInfos)
+		{
+			*bufferInfos = info->pBufferBinds[j];
+			bufferInfos->pBinds = memoryBinds;
+			for (k = 0; k < info->pBufferBinds[j].bindCount; ++k, ++memoryBinds)
+			{
+				*memoryBinds = info->pBufferBinds[j].pBinds[k];
+				vilc_memorySuballocator_translateSparseBind(&memoryBinds->memory, &memoryBinds->memoryOffset);
+			}
+		}
+		for (j = 0; j < info->imageOpaqueBindCount; ++j, ++opaqueInfos)
+		{
+			*opaqueInfos = info->pImageOpaqueBinds[j];
+			opaqueInfos->pBinds = memoryBinds;
+			for (k = 0; k < info->pImageOpaqueBinds[j].bindCount; ++k, ++memoryBinds)
+			{
+				*memoryBinds = info->pImageOpaqueBinds[j].pBinds[k];
+				vilc_memorySuballocator_translateSparseBind(&memoryBinds->memory, &memoryBinds->memoryOffset);
+			}
+		}
+		for (j = 0; j < info->imageBindCount; ++j, ++imageInfos)
+		{
+			*imageInfos = info->pImageBinds[j];
+			imageInfos->pBinds = imageBinds;
+			for (k = 0; k < info->pImageBinds[j].bindCount; ++k, ++imageBinds)
+			{
+				*imageBinds = info->pImageBinds[j].pBinds[k];
+				vilc_memorySuballocator_translateSparseBind(&imageBinds->memory, &imageBinds->memoryOffset);
+			}
+		}
+	}
+
+	*pCopy = copy;
+	return VK_SUCCESS;
+}
+
+void vilcGetMemorySuballocatorStats(VilcMemorySuballocatorStats* stats)
+{
+	VilcMemorySuballocatorBlock* block;
+	uint32_t pool;
+
+	stats->suballocations = VILC_ATOMIC_LOAD(&vilc_memorySuballocator_stats.suballocations);
+	stats->passedThroughAllocations = VILC_ATOMIC_LOAD(&vilc_memorySuballocator_stats.passedThroughAllocations);
+	stats->blockAllocations = VILC_ATOMIC_LOAD(&vilc_memorySuballocator_stats.blockAllocations);
+	stats->liveSuballocations = VILC_ATOMIC_LOAD(&vilc_memorySuballocator_stats.liveSuballocations);
+	stats->liveBlocks = VILC_ATOMIC_LOAD(&vilc_memorySuballocator_stats.liveBlocks);
+	stats->blockBytes = VILC_ATOMIC_LOAD(&vilc_memorySuballocator_stats.blockBytes);
+	stats->usedBytes = VILC_ATOMIC_LOAD(&vilc_memorySuballocator_stats.usedBytes);
+	stats->requestedBytes = VILC_ATOMIC_LOAD(&vilc_memorySuballocator_stats.requestedBytes);
+	stats->largestFreeBytes = 0;
+
+	pthread_mutex_lock(&vilc_memorySuballocator_mutex);
+	for (pool = 0; pool < VK_MAX_MEMORY_TYPES * 2; ++pool)
+		for (block = vilc_memorySuballocator_pools[pool]; block; block = block->next)
+			if (block->tree[1] && (vilc_memorySuballocator_nodeSize << (block->tree[1] - 1)) > stats->largestFreeBytes)
+				stats->largestFreeBytes = vilc_memorySuballocator_nodeSize << (block->tree[1] - 1);
+	pthread_mutex_unlock(&vilc_memorySuballocator_mutex);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_memorySuballocator_vkCreateDevice(VkPhysicalDevice physicalDevice, const VkDeviceCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDevice* pDevice)
+{
+	VkResult result = vilc_memorySuballocator_next_vkCreateDevice(physicalDevice, pCreateInfo, pAllocator, pDevice);
+	VkPhysicalDeviceProperties properties;
+	uint32_t type, order;
+
+	pthread_mutex_lock(&vilc_memorySuballocator_mutex);
+	/* a second device is passed through */
+	if (result == VK_SUCCESS && !vilc_memorySuballocator_device)
+	{
+		vilc_instance.vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+		vilc_instance.vkGetPhysicalDeviceMemoryProperties(physicalDevice, &vilc_memorySuballocator_properties);
+
+		vilc_memorySuballocator_nodeSize = VILC_MEMORY_SUBALLOCATOR_MIN_NODE_SIZE;
+		while (vilc_memorySuballocator_nodeSize < properties.limits.bufferImageGranularity || vilc_memorySuballocator_nodeSize < properties.limits.nonCoherentAtomSize)
+			vilc_memorySuballocator_nodeSize *= 2;
+
+		for (type = 0; type < vilc_memorySuballocator_properties.memoryTypeCount; ++type)
+		{
+			VkDeviceSize heapSize = vilc_memorySuballocator_properties.memoryHeaps[vilc_memorySuballocator_properties.memoryTypes[type].heapIndex].size;
+
+			for (order = 0; (vilc_memorySuballocator_nodeSize << (order + 1)) <= vilc_memorySuballocator_blockSize && (vilc_memorySuballocator_nodeSize << (order + 1)) <= heapSize >> VILC_MEMORY_SUBALLOCATOR_ORDERS;)
+				order++;
+			vilc_memorySuballocator_orders[type] = order >= VILC_MEMORY_SUBALLOCATOR_ORDERS ? order : 0;
+		}
+		vilc_memorySuballocator_device = *pDevice;
+	}
+	pthread_mutex_unlock(&vilc_memorySuballocator_mutex);
+
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_memorySuballocator_vkDestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator)
+{
+	VilcMemorySuballocatorStats stats;
+	VilcMemorySuballocatorBlock* block;
+	VkDeviceSize freeBytes;
+	uint32_t pool, i;
+
+	if (device && device == vilc_memorySuballocator_device)
+	{
+		vilcGetMemorySuballocatorStats(&stats);
+		freeBytes = stats.blockBytes - stats.usedBytes;
+		fprintf(stderr, "vilc: memory suballocator: %llu allocations suballocated and %llu passed through, %llu blocks allocated; %u suballocations live in %u blocks of %llu bytes, %llu bytes used for %llu requested (%.1f%% lost to rounding), largest free node %llu bytes (%.1f%% of the free space fragmented)\n",
+		    (unsigned long long)stats.suballocations, (unsigned long long)stats.passedThroughAllocations, (unsigned long long)stats.blockAllocations,
+		    stats.liveSuballocations, stats.liveBlocks, (unsigned long long)stats.blockBytes, (unsigned long long)stats.usedBytes,
+		    (unsigned long long)stats.requestedBytes, stats.usedBytes ? 100.0 * (double)(stats.usedBytes - stats.requestedBytes) / (double)stats.usedBytes : 0.0,
+		    (unsigned long long)stats.largestFreeBytes, freeBytes ? 100.0 - 100.0 * (double)stats.largestFreeBytes / (double)freeBytes : 0.0);
+
+		pthread_mutex_lock(&vilc_memorySuballocator_mutex);
+		for (i = 0; i < vilc_memorySuballocator_suballocations.capacity; ++i)
+			free(vilc_memorySuballocator_suballocations.values[i]);
+		vilc_mapFree(&vilc_memorySuballocator_suballocations);
+		for (pool = 0; pool < VK_MAX_MEMORY_TYPES * 2; ++pool)
+			while ((block = vilc_memorySuballocator_pools[pool]) != NULL)
+			{
+				vilc_memorySuballocator_pools[pool] = block->next;
+				vilc_memorySuballocator_next_vkFreeMemory(device, block->memory, NULL);
+				free(block);
+			}
+		VILC_ATOMIC_STORE(&vilc_memorySuballocator_stats.liveSuballocations, 0);
+		VILC_ATOMIC_STORE(&vilc_memorySuballocator_stats.liveBlocks, 0);
+		VILC_ATOMIC_STORE(&vilc_memorySuballocator_stats.blockBytes, 0);
+		VILC_ATOMIC_STORE(&vilc_memorySuballocator_stats.usedBytes, 0);
+		VILC_ATOMIC_STORE(&vilc_memorySuballocator_stats.requestedBytes, 0);
+		vilc_memorySuballocator_device = VK_NULL_HANDLE;
+		pthread_mutex_unlock(&vilc_memorySuballocator_mutex);
+	}
+
+	vilc_memorySuballocator_next_vkDestroyDevice(device, pAllocator);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_memorySuballocator_vkAllocateMemory(VkDevice device, const VkMemoryAllocateInfo* pAllocateInfo, const VkAllocationCallbacks* pAllocator, VkDeviceMemory* pMemory)
+{
+	VilcMemorySuballocation* suballocation;
+	VilcMemorySuballocatorBlock* block = NULL;
+	VkDeviceSize offset = 0;
+	uint32_t pool, order = 0, blockOrder;
+
+	if (device != vilc_memorySuballocator_device)
+		return vilc_memorySuballocator_next_vkAllocateMemory(device, pAllocateInfo, pAllocator, pMemory);
+
+	pool = vilc_memorySuballocator_pool(pAllocateInfo);
+	if (pool == ~0u || (suballocation = (VilcMemorySuballocation*)malloc(sizeof(VilcMemorySuballocation))) == NULL)
+	{
+		VILC_ATOMIC_ADD(&vilc_memorySuballocator_stats.passedThroughAllocations, 1);
+		return vilc_memorySuballocator_next_vkAllocateMemory(device, pAllocateInfo, pAllocator, pMemory);
+	}
+
+	while ((vilc_memorySuballocator_nodeSize << order) < pAllocateInfo->allocationSize)
+		order++;
+	blockOrder = vilc_memorySuballocator_orders[pool / 2];
+
+	pthread_mutex_lock(&vilc_memorySuballocator_mutex);
+	for (block = vilc_memorySuballocator_pools[pool]; block; block = block->next)
+		if ((offset = vilc_memorySuballocator_takeNode(block->tree, blockOrder, order)) != ~(VkDeviceSize)0)
+			break;
+	if (!block && (block = vilc_memorySuballocator_addBlock(device, pool)) != NULL)
+		offset = vilc_memorySuballocator_takeNode(block->tree, blockOrder, order);
+	if (block)
+	{
+		suballocation->block = block;
+		suballocation->offset = offset;
+		suballocation->size = pAllocateInfo->allocationSize;
+		suballocation->order = order;
+		suballocation->pool = pool;
+		if (vilc_mapInsert(&vilc_memorySuballocator_suballocations, VILC_OBJECT_KEY((VkDeviceMemory)(uintptr_t)suballocation), suballocation))
+		{
+			block->liveCount++;
+			VILC_ATOMIC_ADD(&vilc_memorySuballocator_stats.liveSuballocations, 1);
+		}
+		else
+		{
+			vilc_memorySuballocator_releaseNode(block->tree, blockOrder, order, offset);
+			block = NULL;
+		}
+	}
+	pthread_mutex_unlock(&vilc_memorySuballocator_mutex);
+
+	/* without a block the driver fails or serves the allocation itself */
+	if (!block)
+	{
+		free(suballocation);
+		VILC_ATOMIC_ADD(&vilc_memorySuballocator_stats.passedThroughAllocations, 1);
+		return vilc_memorySuballocator_next_vkAllocateMemory(device, pAllocateInfo, pAllocator, pMemory);
+	}
+
+	VILC_ATOMIC_ADD(&vilc_memorySuballocator_stats.suballocations, 1);
+	VILC_ATOMIC_ADD(&vilc_memorySuballocator_stats.usedBytes, vilc_memorySuballocator_nodeSize << order);
+	VILC_ATOMIC_ADD(&vilc_memorySuballocator_stats.requestedBytes, pAllocateInfo->allocationSize);
+	*pMemory = (VkDeviceMemory)(uintptr_t)suballocation;
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_memorySuballocator_vkFreeMemory(VkDevice device, VkDeviceMemory memory, const VkAllocationCallbacks* pAllocator)
+{
+	VilcMemorySuballocation* suballocation = NULL;
+
+	if (memory && device == vilc_memorySuballocator_device)
+	{
+		pthread_mutex_lock(&vilc_memorySuballocator_mutex);
+		suballocation = (VilcMemorySuballocation*)vilc_mapRemove(&vilc_memorySuballocator_suballocations, VILC_OBJECT_KEY(memory));
+		if (suballocation)
+		{
+			VilcMemorySuballocatorBlock* block = suballocation->block;
+
+			vilc_memorySuballocator_releaseNode(block->tree, vilc_memorySuballocator_orders[suballocation->pool / 2], suballocation->order, suballocation->offset);
+			if (!--block->liveCount)
+				vilc_memorySuballocator_trimBlock(device, suballocation->pool, block);
+			VILC_ATOMIC_ADD(&vilc_memorySuballocator_stats.liveSuballocations, (uint32_t)0 - 1);
+		}
+		pthread_mutex_unlock(&vilc_memorySuballocator_mutex);
+	}
+
+	if (!suballocation)
+	{
+		vilc_memorySuballocator_next_vkFreeMemory(device, memory, pAllocator);
+		return;
+	}
+
+	VILC_ATOMIC_ADD(&vilc_memorySuballocator_stats.usedBytes, (uint64_t)0 - (vilc_memorySuballocator_nodeSize << suballocation->order));
+	VILC_ATOMIC_ADD(&vilc_memorySuballocator_stats.requestedBytes, (uint64_t)0 - suballocation->size);
+	free(suballocation);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_memorySuballocator_vkMapMemory(VkDevice device, VkDeviceMemory memory, VkDeviceSize offset, VkDeviceSize size, VkMemoryMapFlags flags, void** ppData)
+{
+	VilcMemorySuballocation* suballocation = device == vilc_memorySuballocator_device ? vilc_memorySuballocator_find(VILC_OBJECT_KEY(memory)) : NULL;
+
+	if (!suballocation)
+		return vilc_memorySuballocator_next_vkMapMemory(device, memory, offset, size, flags, ppData);
+	/* the block is mapped as a whole without flags */
+	if (flags)
+		return VK_ERROR_MEMORY_MAP_FAILED;
+	return vilc_memorySuballocator_map(device, suballocation, offset, ppData);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_memorySuballocator_vkUnmapMemory(VkDevice device, VkDeviceMemory memory)
+{
+	/* blocks stay mapped until they are freed */
+	if (device != vilc_memorySuballocator_device || !vilc_memorySuballocator_find(VILC_OBJECT_KEY(memory)))
+		vilc_memorySuballocator_next_vkUnmapMemory(device, memory);
+}
+
+/* Headers that define VK_VERSION_1_4 also define VK_KHR_map_memory2, whose structures the core ones alias */
+#if defined(VK_KHR_map_memory2)
+/* Returns VK_INCOMPLETE when the call has to be passed through */
+static VkResult vilc_memorySuballocator_map2(VkDevice device, const VkMemoryMapInfoKHR* pMemoryMapInfo, void** ppData)
+{
+	VilcMemorySuballocation* suballocation = device == vilc_memorySuballocator_device ? vilc_memorySuballocator_find(VILC_OBJECT_KEY(pMemoryMapInfo->memory)) : NULL;
+
+	if (!suballocation)
+		return VK_INCOMPLETE;
+	if (pMemoryMapInfo->flags || pMemoryMapInfo->pNext)
+		return VK_ERROR_MEMORY_MAP_FAILED;
+	return vilc_memorySuballocator_map(device, suballocation, pMemoryMapInfo->offset, ppData);
+}
+
+/* Returns 0 when the call has to be passed through */
+static int vilc_memorySuballocator_unmap2(VkDevice device, const VkMemoryUnmapInfoKHR* pMemoryUnmapInfo)
+{
+	return device == vilc_memorySuballocator_device && vilc_memorySuballocator_find(VILC_OBJECT_KEY(pMemoryUnmapInfo->memory)) != NULL;
+}
+#endif /* defined(VK_KHR_map_memory2) */
+
+#if defined(VK_VERSION_1_4)
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_memorySuballocator_vkMapMemory2(VkDevice device, const VkMemoryMapInfo* pMemoryMapInfo, void** ppData)
+{
+	VkResult result = vilc_memorySuballocator_map2(device, pMemoryMapInfo, ppData);
+
+	if (result == VK_INCOMPLETE)
+		return vilc_memorySuballocator_next_vkMapMemory2(device, pMemoryMapInfo, ppData);
+	return result;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_memorySuballocator_vkUnmapMemory2(VkDevice device, const VkMemoryUnmapInfo* pMemoryUnmapInfo)
+{
+	if (vilc_memorySuballocator_unmap2(device, pMemoryUnmapInfo))
+		return VK_SUCCESS;
+	return vilc_memorySuballocator_next_vkUnmapMemory2(device, pMemoryUnmapInfo);
+}
+#endif /* defined(VK_VERSION_1_4) */
+
+#if defined(VK_KHR_map_memory2)
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_memorySuballocator_vkMapMemory2KHR(VkDevice device, const VkMemoryMapInfoKHR* pMemoryMapInfo, void** ppData)
+{
+	VkResult result = vilc_memorySuballocator_map2(device, pMemoryMapInfo, ppData);
+
+	if (result == VK_INCOMPLETE)
+		return vilc_memorySuballocator_next_vkMapMemory2KHR(device, pMemoryMapInfo, ppData);
+	return result;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_memorySuballocator_vkUnmapMemory2KHR(VkDevice device, const VkMemoryUnmapInfoKHR* pMemoryUnmapInfo)
+{
+	if (vilc_memorySuballocator_unmap2(device, pMemoryUnmapInfo))
+		return VK_SUCCESS;
+	return vilc_memorySuballocator_next_vkUnmapMemory2KHR(device, pMemoryUnmapInfo);
+}
+#endif /* defined(VK_KHR_map_memory2) */
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_memorySuballocator_vkFlushMappedMemoryRanges(VkDevice device, uint32_t memoryRangeCount, const VkMappedMemoryRange* pMemoryRanges)
+{
+	VkMappedMemoryRange* copy = NULL;
+	VkResult result = device == vilc_memorySuballocator_device ? vilc_memorySuballocator_translateRanges(memoryRangeCount, pMemoryRanges, &copy) : VK_SUCCESS;
+
+	if (result == VK_SUCCESS)
+		result = vilc_memorySuballocator_next_vkFlushMappedMemoryRanges(device, memoryRangeCount, copy ? copy : pMemoryRanges);
+	free(copy);
+	return result;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_memorySuballocator_vkInvalidateMappedMemoryRanges(VkDevice device, uint32_t memoryRangeCount, const VkMappedMemoryRange* pMemoryRanges)
+{
+	VkMappedMemoryRange* copy = NULL;
+	VkResult result = device == vilc_memorySuballocator_device ? vilc_memorySuballocator_translateRanges(memoryRangeCount, pMemoryRanges, &copy) : VK_SUCCESS;
+
+	if (result == VK_SUCCESS)
+		result = vilc_memorySuballocator_next_vkInvalidateMappedMemoryRanges(device, memoryRangeCount, copy ? copy : pMemoryRanges);
+	free(copy);
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_memorySuballocator_vkGetDeviceMemoryCommitment(VkDevice device, VkDeviceMemory memory, VkDeviceSize* pCommittedMemoryInBytes)
+{
+	VilcMemorySuballocation* suballocation = device == vilc_memorySuballocator_device ? vilc_memorySuballocator_find(VILC_OBJECT_KEY(memory)) : NULL;
+
+	/* lazily allocated memory is not suballocated, so all of a suballocation is committed */
+	if (suballocation)
+		*pCommittedMemoryInBytes = suballocation->size;
+	else
+		vilc_memorySuballocator_next_vkGetDeviceMemoryCommitment(device, memory, pCommittedMemoryInBytes);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_memorySuballocator_vkBindBufferMemory(VkDevice device, VkBuffer buffer, VkDeviceMemory memory, VkDeviceSize memoryOffset)
+{
+	VilcMemorySuballocation* suballocation = device == vilc_memorySuballocator_device ? vilc_memorySuballocator_find(VILC_OBJECT_KEY(memory)) : NULL;
+
+	if (suballocation)
+		return vilc_memorySuballocator_next_vkBindBufferMemory(device, buffer, suballocation->block->memory, suballocation->offset + memoryOffset);
+	return vilc_memorySuballocator_next_vkBindBufferMemory(device, buffer, memory, memoryOffset);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_memorySuballocator_vkBindImageMemory(VkDevice device, VkImage image, VkDeviceMemory memory, VkDeviceSize memoryOffset)
+{
+	VilcMemorySuballocation* suballocation = device == vilc_memorySuballocator_device ? vilc_memorySuballocator_find(VILC_OBJECT_KEY(memory)) : NULL;
+
+	if (suballocation)
+		return vilc_memorySuballocator_next_vkBindImageMemory(device, image, suballocation->block->memory, suballocation->offset + memoryOffset);
+	return vilc_memorySuballocator_next_vkBindImageMemory(device, image, memory, memoryOffset);
+}
+
+#if defined(VK_VERSION_1_1)
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_memorySuballocator_vkBindBufferMemory2(VkDevice device, uint32_t bindInfoCount, const VkBindBufferMemoryInfo* pBindInfos)
+{
+	VkBindBufferMemoryInfo* copy = NULL;
+	VkResult result = device == vilc_memorySuballocator_device ? vilc_memorySuballocator_translateBufferBinds(bindInfoCount, pBindInfos, &copy) : VK_SUCCESS;
+
+	if (result == VK_SUCCESS)
+		result = vilc_memorySuballocator_next_vkBindBufferMemory2(device, bindInfoCount, copy ? copy : pBindInfos);
+	free(copy);
+	return result;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_memorySuballocator_vkBindImageMemory2(VkDevice device, uint32_t bindInfoCount, const VkBindImageMemoryInfo* pBindInfos)
+{
+	VkBindImageMemoryInfo* copy = NULL;
+	VkResult result = device == vilc_memorySuballocator_device ? vilc_memorySuballocator_translateImageBinds(bindInfoCount, pBindInfos, &copy) : VK_SUCCESS;
+
+	if (result == VK_SUCCESS)
+		result = vilc_memorySuballocator_next_vkBindImageMemory2(device, bindInfoCount, copy ? copy : pBindInfos);
+	free(copy);
+	return result;
+}
+#endif /* defined(VK_VERSION_1_1) */
+
+#if defined(VK_KHR_bind_memory2)
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_memorySuballocator_vkBindBufferMemory2KHR(VkDevice device, uint32_t bindInfoCount, const VkBindBufferMemoryInfoKHR* pBindInfos)
+{
+	VkBindBufferMemoryInfoKHR* copy = NULL;
+	VkResult result = device == vilc_memorySuballocator_device ? vilc_memorySuballocator_translateBufferBinds(bindInfoCount, pBindInfos, &copy) : VK_SUCCESS;
+
+	if (result == VK_SUCCESS)
+		result = vilc_memorySuballocator_next_vkBindBufferMemory2KHR(device, bindInfoCount, copy ? copy : pBindInfos);
+	free(copy);
+	return result;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_memorySuballocator_vkBindImageMemory2KHR(VkDevice device, uint32_t bindInfoCount, const VkBindImageMemoryInfoKHR* pBindInfos)
+{
+	VkBindImageMemoryInfoKHR* copy = NULL;
+	VkResult result = device == vilc_memorySuballocator_device ? vilc_memorySuballocator_translateImageBinds(bindInfoCount, pBindInfos, &copy) : VK_SUCCESS;
+
+	if (result == VK_SUCCESS)
+		result = vilc_memorySuballocator_next_vkBindImageMemory2KHR(device, bindInfoCount, copy ? copy : pBindInfos);
+	free(copy);
+	return result;
+}
+#endif /* defined(VK_KHR_bind_memory2) */
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_memorySuballocator_vkQueueBindSparse(VkQueue queue, uint32_t bindInfoCount, const VkBindSparseInfo* pBindInfo, VkFence fence)
+{
+	VkBindSparseInfo* copy = NULL;
+	VkResult result = vilc_memorySuballocator_translateSparseBinds(bindInfoCount, pBindInfo, &copy);
+
+	if (result == VK_SUCCESS)
+		result = vilc_memorySuballocator_next_vkQueueBindSparse(queue, bindInfoCount, copy ? copy : pBindInfo, fence);
+	free(copy);
+	return result;
+}
+
+#if defined(VK_EXT_pageable_device_local_memory)
+static VKAPI_ATTR void VKAPI_CALL vilc_memorySuballocator_vkSetDeviceMemoryPriorityEXT(VkDevice device, VkDeviceMemory memory, float priority)
+{
+	/* blocks are shared, so priorities of suballocations are dropped */
+	if (device != vilc_memorySuballocator_device || !vilc_memorySuballocator_find(VILC_OBJECT_KEY(memory)))
+		vilc_memorySuballocator_next_vkSetDeviceMemoryPriorityEXT(device, memory, priority);
+}
+#endif /* defined(VK_EXT_pageable_device_local_memory) */
+
+#if defined(VK_EXT_debug_utils)
+/* Names and tags of suballocations are dropped, since the driver does not know their handles */
+static int vilc_memorySuballocator_isSuballocation(VkDevice device, VkObjectType objectType, uint64_t objectHandle)
+{
+	return device == vilc_memorySuballocator_device && objectType == VK_OBJECT_TYPE_DEVICE_MEMORY && vilc_memorySuballocator_find(objectHandle);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_memorySuballocator_vkSetDebugUtilsObjectNameEXT(VkDevice device, const VkDebugUtilsObjectNameInfoEXT* pNameInfo)
+{
+	if (vilc_memorySuballocator_isSuballocation(device, pNameInfo->objectType, pNameInfo->objectHandle))
+		return VK_SUCCESS;
+	return vilc_memorySuballocator_next_vkSetDebugUtilsObjectNameEXT(device, pNameInfo);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_memorySuballocator_vkSetDebugUtilsObjectTagEXT(VkDevice device, const VkDebugUtilsObjectTagInfoEXT* pTagInfo)
+{
+	if (vilc_memorySuballocator_isSuballocation(device, pTagInfo->objectType, pTagInfo->objectHandle))
+		return VK_SUCCESS;
+	return vilc_memorySuballocator_next_vkSetDebugUtilsObjectTagEXT(device, pTagInfo);
+}
+#endif /* defined(VK_EXT_debug_utils) */
+
+static void vilc_memorySuballocator_installInstance(void)
+{
+	VILC_LAYER_HOOK(vilc_memorySuballocator, vkCreateDevice)
+#if defined(VK_EXT_debug_utils)
+	VILC_LAYER_HOOK(vilc_memorySuballocator, vkSetDebugUtilsObjectNameEXT)
+	VILC_LAYER_HOOK(vilc_memorySuballocator, vkSetDebugUtilsObjectTagEXT)
+#endif
+}
+
+static void vilc_memorySuballocator_installDevice(void)
+{
+	const char* blockSize = getenv("VILC_MEMORY_SUBALLOCATOR_BLOCK_SIZE");
+
+	vilc_memorySuballocator_blockSize = blockSize ? strtoull(blockSize, NULL, 10) : VILC_MEMORY_SUBALLOCATOR_BLOCK_SIZE;
+
+	VILC_LAYER_HOOK(vilc_memorySuballocator, vkDestroyDevice)
+	VILC_LAYER_HOOK(vilc_memorySuballocator, vkAllocateMemory)
+	VILC_LAYER_HOOK(vilc_memorySuballocator, vkFreeMemory)
+	VILC_LAYER_HOOK(vilc_memorySuballocator, vkMapMemory)
+	VILC_LAYER_HOOK(vilc_memorySuballocator, vkUnmapMemory)
+	VILC_LAYER_HOOK(vilc_memorySuballocator, vkFlushMappedMemoryRanges)
+	VILC_LAYER_HOOK(vilc_memorySuballocator, vkInvalidateMappedMemoryRanges)
+	VILC_LAYER_HOOK(vilc_memorySuballocator, vkGetDeviceMemoryCommitment)
+	VILC_LAYER_HOOK(vilc_memorySuballocator, vkBindBufferMemory)
+	VILC_LAYER_HOOK(vilc_memorySuballocator, vkBindImageMemory)
+	VILC_LAYER_HOOK(vilc_memorySuballocator, vkQueueBindSparse)
+#if defined(VK_VERSION_1_1)
+	VILC_LAYER_HOOK(vilc_memorySuballocator, vkBindBufferMemory2)
+	VILC_LAYER_HOOK(vilc_memorySuballocator, vkBindImageMemory2)
+#endif
+#if defined(VK_VERSION_1_4)
+	VILC_LAYER_HOOK(vilc_memorySuballocator, vkMapMemory2)
+	VILC_LAYER_HOOK(vilc_memorySuballocator, vkUnmapMemory2)
+#endif
+#if defined(VK_KHR_bind_memory2)
+	VILC_LAYER_HOOK(vilc_memorySuballocator, vkBindBufferMemory2KHR)
+	VILC_LAYER_HOOK(vilc_memorySuballocator, vkBindImageMemory2KHR)
+#endif
+#if defined(VK_KHR_map_memory2)
+	VILC_LAYER_HOOK(vilc_memorySuballocator, vkMapMemory2KHR)
+	VILC_LAYER_HOOK(vilc_memorySuballocator, vkUnmapMemory2KHR)
+#endif
+#if defined(VK_EXT_pageable_device_local_memory)
+	VILC_LAYER_HOOK(vilc_memorySuballocator, vkSetDeviceMemoryPriorityEXT)
+#endif
+}
+#endif /* VILC_MEMORY_SUBALLOCATOR */
+
+
+#if defined(VOLK_IN_LOADERS_CLOTH) && defined(VILC_DESCRIPTOR_ALLOCATOR)
+/* Descriptor allocator: every VkDescriptorPool of the application is backed by a chain of driver pools, and the handle
+ * the application gets is the first of them. vkAllocateDescriptorSets calls that run out of memory in one pool move on
+ * to the next, and at the end of the chain a pool twice as large as the last one is created, up to
+ * VILC_DESCRIPTOR_ALLOCATOR_MAX_GROWTH times the size asked for, so VK_ERROR_OUT_OF_POOL_MEMORY and
+ * VK_ERROR_FRAGMENTED_POOL only reach the application for calls that do not fit into a pool of that size.
+ * Pools may only be reset or destroyed, and sets freed, once the submits that used them completed, so these calls are
+ * where the frames that used a pool retire: vkDestroyDescriptorPool resets the chain and parks it, up to
+ * VILC_DESCRIPTOR_ALLOCATOR_PARKED_POOLS chains, and vkCreateDescriptorPool with the same flags and sizes takes a parked
+ * chain back without calling the driver. Sets freed from pools with VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT
+ * go to a freelist per set layout, which later allocations with that layout and without pNext structures take from.
+ * Pools created with pNext structures pass through.
+ */
+#define VILC_DESCRIPTOR_ALLOCATOR_MAX_GROWTH 16
+#define VILC_DESCRIPTOR_ALLOCATOR_PARKED_POOLS 16
+/* calls of up to this many sets are handled without allocating */
+#define VILC_DESCRIPTOR_ALLOCATOR_BATCH 16
+
+typedef struct VilcDescriptorAllocatorSet
+{
+	VkDescriptorSet set;
+	VkDescriptorPool driverPool;
+	VkDescriptorSetLayout layout;
+	int recyclable; /* allocated without pNext structures */
+	struct VilcDescriptorAllocatorSet* next; /* in the freelist of its layout */
+} VilcDescriptorAllocatorSet;
+
+typedef struct VilcDescriptorAllocatorPool
+{
+	pthread_mutex_t mutex;
+	VkDevice device;
+	VkDescriptorPoolCreateFlags flags;
+	uint32_t maxSets;
+	uint32_t poolSizeCount;
+	VkDescriptorPoolSize* poolSizes;
+	VkDescriptorPool* driverPools;
+	uint32_t driverPoolCount;
+	uint32_t driverPoolCapacity;
+	/* the driver pool allocations go to; the ones before it ran out of memory, and the ones after it are empty */
+	uint32_t current;
+	/* driver pools allocated from since the last reset */
+	uint32_t usedCount;
+	/* the size of the last driver pool, in multiples of the size asked for */
+	uint32_t lastScale;
+	/* only for pools with VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT: VkDescriptorSet -> VilcDescriptorAllocatorSet
+	 * of the live sets, and VkDescriptorSetLayout -> first VilcDescriptorAllocatorSet of the freelist of the layout
+	 */
+	VilcHandleMap liveSets;
+	VilcHandleMap freeSets;
+	struct VilcDescriptorAllocatorPool* nextParked;
+} VilcDescriptorAllocatorPool;
+
+static pthread_mutex_t vilc_descriptorAllocator_mutex = PTHREAD_MUTEX_INITIALIZER;
+/* pools of the application by their handle */
+static VilcHandleMap vilc_descriptorAllocator_pools;
+static VilcDescriptorAllocatorPool* vilc_descriptorAllocator_parked;
+static uint32_t vilc_descriptorAllocator_parkedLimit;
+static VilcDescriptorAllocatorStats vilc_descriptorAllocator_stats;
+
+VILC_LAYER_NEXT(vilc_descriptorAllocator, vkDestroyDevice)
+VILC_LAYER_NEXT(vilc_descriptorAllocator, vkCreateDescriptorPool)
+VILC_LAYER_NEXT(vilc_descriptorAllocator, vkDestroyDescriptorPool)
+VILC_LAYER_NEXT(vilc_descriptorAllocator, vkResetDescriptorPool)
+VILC_LAYER_NEXT(vilc_descriptorAllocator, vkAllocateDescriptorSets)
+VILC_LAYER_NEXT(vilc_descriptorAllocator, vkFreeDescriptorSets)
+VILC_LAYER_NEXT(vilc_descriptorAllocator, vkDestroyDescriptorSetLayout)
+
+static VilcDescriptorAllocatorPool* vilc_descriptorAllocator_find(VkDescriptorPool descriptorPool)
+{
+	VilcDescriptorAllocatorPool* pool;
+
+	if (!descriptorPool)
+		return NULL;
+
+	pthread_mutex_lock(&vilc_descriptorAllocator_mutex);
+	pool = (VilcDescriptorAllocatorPool*)vilc_mapFind(&vilc_descriptorAllocator_pools, VILC_OBJECT_KEY(descriptorPool));
+	pthread_mutex_unlock(&vilc_descriptorAllocator_mutex);
+	return pool;
+}
+
+/* Creates a driver pool at the end of the chain, twice as large as the last one up to the maximum growth */
+static VkResult vilc_descriptorAllocator_grow(VkDevice device, VilcDescriptorAllocatorPool* pool)
+{
+	uint32_t scale = pool->lastScale * 2 < VILC_DESCRIPTOR_ALLOCATOR_MAX_GROWTH ? pool->lastScale * 2 : VILC_DESCRIPTOR_ALLOCATOR_MAX_GROWTH;
+	VkDescriptorPoolCreateInfo createInfo;
+	VkDescriptorPoolSize* poolSizes;
+	VkResult result;
+	uint32_t i;
+
+	if (pool->driverPoolCount == pool->driverPoolCapacity)
+	{
+		VkDescriptorPool* driverPools = (VkDescriptorPool*)realloc(pool->driverPools, pool->driverPoolCapacity * 2 * sizeof(VkDescriptorPool));
+		if (!driverPools)
+			return VK_ERROR_OUT_OF_HOST_MEMORY;
+		pool->driverPools = driverPools;
+		pool->driverPoolCapacity *= 2;
+	}
+	poolSizes = (VkDescriptorPoolSize*)malloc((pool->poolSizeCount ? pool->poolSizeCount : 1) * sizeof(VkDescriptorPoolSize));
+	if (!poolSizes)
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+
+	for (i = 0; i < pool->poolSizeCount; ++i)
+	{
+		poolSizes[i] = pool->poolSizes[i];
+		poolSizes[i].descriptorCount *= scale;
+	}
+	memset(&createInfo, 0, sizeof(createInfo));
+	createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	createInfo.flags = pool->flags;
+	createInfo.maxSets = pool->maxSets * scale;
+	createInfo.poolSizeCount = pool->poolSizeCount;
+	createInfo.pPoolSizes = poolSizes;
+
+	result = vilc_descriptorAllocator_next_vkCreateDescriptorPool(device, &createInfo, NULL, &pool->driverPools[pool->driverPoolCount]);
+	free(poolSizes);
+	if (result != VK_SUCCESS)
+		return result;
+
+	pool->driverPoolCount++;
+	pool->lastScale = scale;
+	VILC_ATOMIC_ADD(&vilc_descriptorAllocator_stats.grownPools, 1);
+	VILC_ATOMIC_ADD(&vilc_descriptorAllocator_stats.driverPools, 1);
+	return VK_SUCCESS;
+}
+
+/* Puts a set that the application freed on the freelist of its layout, or frees it */
+static void vilc_descriptorAllocator_release(VkDevice device, VilcDescriptorAllocatorPool* pool, VilcDescriptorAllocatorSet* set)
+{
+	uint64_t key = VILC_OBJECT_KEY(set->layout);
+
+	if (set->recyclable)
+	{
+		set->next = (VilcDescriptorAllocatorSet*)vilc_mapFind(&pool->freeSets, key);
+		if (vilc_mapInsert(&pool->freeSets, key, set))
+			return;
+	}
+	vilc_descriptorAllocator_next_vkFreeDescriptorSets(device, set->driverPool, 1, &set->set);
+	free(set);
+}
+
+/* Takes a set of the layout from its freelist */
+static VilcDescriptorAllocatorSet* vilc_descriptorAllocator_takeFree(VilcDescriptorAllocatorPool* pool, VkDescriptorSetLayout layout)
+{
+	uint64_t key = VILC_OBJECT_KEY(layout);
+	VilcDescriptorAllocatorSet* set = (VilcDescriptorAllocatorSet*)vilc_mapFind(&pool->freeSets, key);
+
+	if (!set || !vilc_mapInsert(&pool->liveSets, VILC_OBJECT_KEY(set->set), set))
+		return NULL;
+	if (set->next)
+		vilc_mapInsert(&pool->freeSets, key, set->next);
+	else
+		vilc_mapRemove(&pool->freeSets, key);
+	return set;
+}
+
+/* Allocates sets from the chain, growing it as needed, and tracks them for pools whose sets can be freed */
+static VkResult vilc_descriptorAllocator_allocate(VkDevice device, VilcDescriptorAllocatorPool* pool, VkDescriptorSetAllocateInfo* pAllocateInfo, VkDescriptorSet* pDescriptorSets)
+{
+	VilcDescriptorAllocatorSet* set;
+	VkResult result;
+	uint32_t i;
+	int grown = 0;
+
+	for (;;)
+	{
+		pAllocateInfo->descriptorPool = pool->driverPools[pool->current];
+		if (pool->usedCount <= pool->current)
+			pool->usedCount = pool->current + 1;
+		result = vilc_descriptorAllocator_next_vkAllocateDescriptorSets(device, pAllocateInfo, pDescriptorSets);
+		VILC_ATOMIC_ADD(&vilc_descriptorAllocator_stats.driverAllocations, 1);
+		if (result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL)
+			break;
+
+		VILC_ATOMIC_ADD(&vilc_descriptorAllocator_stats.outOfPoolErrors, 1);
+		if (pool->current + 1 == pool->driverPoolCount)
+		{
+			/* calls that do not fit into an empty pool of the largest size fail */
+			if (grown && pool->lastScale == VILC_DESCRIPTOR_ALLOCATOR_MAX_GROWTH)
+				return result;
+			if ((result = vilc_descriptorAllocator_grow(device, pool)) != VK_SUCCESS)
+				return result;
+			grown = 1;
+		}
+		pool->current++;
+	}
+	if (result != VK_SUCCESS || !(pool->flags & VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT))
+		return result;
+
+	for (i = 0; i < pAllocateInfo->descriptorSetCount; ++i)
+	{
+		set = (VilcDescriptorAllocatorSet*)malloc(sizeof(VilcDescriptorAllocatorSet));
+		if (!set || !vilc_mapInsert(&pool->liveSets, VILC_OBJECT_KEY(pDescriptorSets[i]), set))
+		{
+			free(set);
+			while (i--)
+				free(vilc_mapRemove(&pool->liveSets, VILC_OBJECT_KEY(pDescriptorSets[i])));
+			vilc_descriptorAllocator_next_vkFreeDescriptorSets(device, pAllocateInfo->descriptorPool, pAllocateInfo->descriptorSetCount, pDescriptorSets);
+			return VK_ERROR_OUT_OF_HOST_MEMORY;
+		}
+		set->set = pDescriptorSets[i];
+		set->driverPool = pAllocateInfo->descriptorPool;
+		set->layout = pAllocateInfo->pSetLayouts[i];
+		set->recyclable = !pAllocateInfo->pNext;
+		set->next = NULL;
+	}
+	return VK_SUCCESS;
+}
+
+/* Resets the driver pools allocated from and drops the sets; the chain stays */
+static void vilc_descriptorAllocator_resetChain(VkDevice device, VilcDescriptorAllocatorPool* pool)
+{
+	VilcDescriptorAllocatorSet* set;
+	uint32_t i;
+
+	for (i = 0; i < pool->usedCount; ++i)
+		vilc_descriptorAllocator_next_vkResetDescriptorPool(device, pool->driverPools[i], 0);
+	pool->current = 0;
+	pool->usedCount = 0;
+
+	for (i = 0; i < pool->liveSets.capacity; ++i)
+		free(pool->liveSets.values[i]);
+	for (i = 0; i < pool->freeSets.capacity; ++i)
+		while ((set = (VilcDescriptorAllocatorSet*)pool->freeSets.values[i]) != NULL)
+		{
+			pool->freeSets.values[i] = set->next;
+			free(set);
+		}
+	vilc_mapFree(&pool->liveSets);
+	vilc_mapFree(&pool->freeSets);
+}
+
+static void vilc_descriptorAllocator_destroyChain(VilcDescriptorAllocatorPool* pool)
+{
+	uint32_t i;
+
+	vilc_descriptorAllocator_resetChain(pool->device, pool);
+	for (i = 0; i < pool->driverPoolCount; ++i)
+		vilc_descriptorAllocator_next_vkDestroyDescriptorPool(pool->device, pool->driverPools[i], NULL);
+	VILC_ATOMIC_ADD(&vilc_descriptorAllocator_stats.driverPools, (uint32_t)0 - pool->driverPoolCount);
+	pthread_mutex_destroy(&pool->mutex);
+	free(pool->driverPools);
+	free(pool);
+}
+
+void vilcGetDescriptorAllocatorStats(VilcDescriptorAllocatorStats* stats)
+{
+	stats->allocatedSets = VILC_ATOMIC_LOAD(&vilc_descriptorAllocator_stats.allocatedSets);
+	stats->recycledSets = VILC_ATOMIC_LOAD(&vilc_descriptorAllocator_stats.recycledSets);
+	stats->driverAllocations = VILC_ATOMIC_LOAD(&vilc_descriptorAllocator_stats.driverAllocations);
+	stats->outOfPoolErrors = VILC_ATOMIC_LOAD(&vilc_descriptorAllocator_stats.outOfPoolErrors);
+	stats->grownPools = VILC_ATOMIC_LOAD(&vilc_descriptorAllocator_stats.grownPools);
+	stats->recycledPools = VILC_ATOMIC_LOAD(&vilc_descriptorAllocator_stats.recycledPools);
+	stats->passedThroughPools = VILC_ATOMIC_LOAD(&vilc_descriptorAllocator_stats.passedThroughPools);
+	stats->livePools = VILC_ATOMIC_LOAD(&vilc_descriptorAllocator_stats.livePools);
+	stats->parkedPools = VILC_ATOMIC_LOAD(&vilc_descriptorAllocator_stats.parkedPools);
+	stats->driverPools = VILC_ATOMIC_LOAD(&vilc_descriptorAllocator_stats.driverPools);
+	vilc_histogramExport(&stats->allocationTime, &vilc_descriptorAllocator_stats.allocationTime);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_descriptorAllocator_vkDestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator)
+{
+	VilcDescriptorAllocatorStats stats;
+	VilcDescriptorAllocatorPool** link;
+	VilcDescriptorAllocatorPool* pool;
+	uint32_t i;
+
+	if (device)
+	{
+		pthread_mutex_lock(&vilc_descriptorAllocator_mutex);
+		/* pools the application did not destroy go with the device, removed while walking the map; removing moves later
+		 * entries back into the slot, so it is looked at again
+		 */
+		for (i = 0; i < vilc_descriptorAllocator_pools.capacity;)
+		{
+			pool = (VilcDescriptorAllocatorPool*)vilc_descriptorAllocator_pools.values[i];
+			if (pool && pool->device == device)
+			{
+				vilc_mapRemove(&vilc_descriptorAllocator_pools, vilc_descriptorAllocator_pools.keys[i]);
+				vilc_descriptorAllocator_destroyChain(pool);
+				VILC_ATOMIC_ADD(&vilc_descriptorAllocator_stats.livePools, (uint32_t)0 - 1);
+			}
+			else
+				++i;
+		}
+		if (!vilc_descriptorAllocator_pools.count)
+			vilc_mapFree(&vilc_descriptorAllocator_pools);
+		for (link = &vilc_descriptorAllocator_parked; (pool = *link) != NULL;)
+		{
+			if (pool->device != device)
+			{
+				link = &pool->nextParked;
+				continue;
+			}
+			*link = pool->nextParked;
+			vilc_descriptorAllocator_destroyChain(pool);
+			VILC_ATOMIC_ADD(&vilc_descriptorAllocator_stats.parkedPools, (uint32_t)0 - 1);
+		}
+		pthread_mutex_unlock(&vilc_descriptorAllocator_mutex);
+
+		vilcGetDescriptorAllocatorStats(&stats);
+		fprintf(stderr, "vilc: descriptor allocator: %llu sets allocated, %llu of them from freelists, in %llu driver calls with %llu out of pool memory errors; %llu driver pools grown, %llu pools recycled, %llu passed through\n",
+		    (unsigned long long)stats.allocatedSets, (unsigned long long)stats.recycledSets, (unsigned long long)stats.driverAllocations,
+		    (unsigned long long)stats.outOfPoolErrors, (unsigned long long)stats.grownPools, (unsigned long long)stats.recycledPools,
+		    (unsigned long long)stats.passedThroughPools);
+		if (stats.allocationTime.count)
+			vilc_histogramPrint("allocation time (ns)", &stats.allocationTime);
+	}
+
+	vilc_descriptorAllocator_next_vkDestroyDevice(device, pAllocator);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_descriptorAllocator_vkCreateDescriptorPool(VkDevice device, const VkDescriptorPoolCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDescriptorPool* pDescriptorPool)
+{
+	size_t poolSizesSize = pCreateInfo->poolSizeCount * sizeof(VkDescriptorPoolSize);
+	VilcDescriptorAllocatorPool** link;
+	VilcDescriptorAllocatorPool* pool;
+	VkResult result;
+
+	if (pCreateInfo->pNext)
+	{
+		VILC_ATOMIC_ADD(&vilc_descriptorAllocator_stats.passedThroughPools, 1);
+		return vilc_descriptorAllocator_next_vkCreateDescriptorPool(device, pCreateInfo, pAllocator, pDescriptorPool);
+	}
+
+	pthread_mutex_lock(&vilc_descriptorAllocator_mutex);
+	for (link = &vilc_descriptorAllocator_parked; (pool = *link) != NULL; link = &pool->nextParked)
+		if (pool->device == device && pool->flags == pCreateInfo->flags && pool->maxSets == pCreateInfo->maxSets &&
+		    pool->poolSizeCount == pCreateInfo->poolSizeCount && (!poolSizesSize || memcmp(pool->poolSizes, pCreateInfo->pPoolSizes, poolSizesSize) == 0))
+			break;
+	if (pool && vilc_mapInsert(&vilc_descriptorAllocator_pools, VILC_OBJECT_KEY(pool->driverPools[0]), pool))
+	{
+		*link = pool->nextParked;
+		pthread_mutex_unlock(&vilc_descriptorAllocator_mutex);
+
+		VILC_ATOMIC_ADD(&vilc_descriptorAllocator_stats.parkedPools, (uint32_t)0 - 1);
+		VILC_ATOMIC_ADD(&vilc_descriptorAllocator_stats.livePools, 1);
+		VILC_ATOMIC_ADD(&vilc_descriptorAllocator_stats.recycledPools, 1);
+		*pDescriptorPool = pool->driverPools[0];
+		return VK_SUCCESS;
+	}
+	pthread_mutex_unlock(&vilc_descriptorAllocator_mutex);
+
+	/* the pool sizes are kept after the pool */
+	pool = (VilcDescriptorAllocatorPool*)calloc(1, sizeof(VilcDescriptorAllocatorPool) + poolSizesSize);
+	if (!pool || (pool->driverPools = (VkDescriptorPool*)malloc(4 * sizeof(VkDescriptorPool))) == NULL)
+	{
+		free(pool);
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	}
+	pool->device = device;
+	pool->flags = pCreateInfo->flags;
+	pool->maxSets = pCreateInfo->maxSets;
+	pool->poolSizeCount = pCreateInfo->poolSizeCount;
+	pool->poolSizes = (VkDescriptorPoolSize*)(pool + 1);
+	if (poolSizesSize)
+		memcpy(pool->poolSizes, pCreateInfo->pPoolSizes, poolSizesSize);
+	pool->driverPoolCapacity = 4;
+	pool->lastScale = 1;
+
+	/* driver pools are all destroyed by the layer, so none of them is created with the allocator of the application */
+	result = vilc_descriptorAllocator_next_vkCreateDescriptorPool(device, pCreateInfo, NULL, &pool->driverPools[0]);
+	if (result != VK_SUCCESS)
+	{
+		free(pool->driverPools);
+		free(pool);
+		return result;
+	}
+	pool->driverPoolCount = 1;
+	pthread_mutex_init(&pool->mutex, NULL);
+
+	pthread_mutex_lock(&vilc_descriptorAllocator_mutex);
+	if (!vilc_mapInsert(&vilc_descriptorAllocator_pools, VILC_OBJECT_KEY(pool->driverPools[0]), pool))
+	{
+		pthread_mutex_unlock(&vilc_descriptorAllocator_mutex);
+		vilc_descriptorAllocator_destroyChain(pool);
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	}
+	pthread_mutex_unlock(&vilc_descriptorAllocator_mutex);
+
+	VILC_ATOMIC_ADD(&vilc_descriptorAllocator_stats.driverPools, 1);
+	VILC_ATOMIC_ADD(&vilc_descriptorAllocator_stats.livePools, 1);
+	*pDescriptorPool = pool->driverPools[0];
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_descriptorAllocator_vkDestroyDescriptorPool(VkDevice device, VkDescriptorPool descriptorPool, const VkAllocationCallbacks* pAllocator)
+{
+	VilcDescriptorAllocatorPool* pool = NULL;
+
+	if (descriptorPool)
+	{
+		pthread_mutex_lock(&vilc_descriptorAllocator_mutex);
+		pool = (VilcDescriptorAllocatorPool*)vilc_mapRemove(&vilc_descriptorAllocator_pools, VILC_OBJECT_KEY(descriptorPool));
+		pthread_mutex_unlock(&vilc_descriptorAllocator_mutex);
+	}
+	if (!pool)
+	{
+		vilc_descriptorAllocator_next_vkDestroyDescriptorPool(device, descriptorPool, pAllocator);
+		return;
+	}
+	VILC_ATOMIC_ADD(&vilc_descriptorAllocator_stats.livePools, (uint32_t)0 - 1);
+
+	vilc_descriptorAllocator_resetChain(device, pool);
+	pthread_mutex_lock(&vilc_descriptorAllocator_mutex);
+	if (VILC_ATOMIC_LOAD(&vilc_descriptorAllocator_stats.parkedPools) < vilc_descriptorAllocator_parkedLimit)
+	{
+		pool->nextParked = vilc_descriptorAllocator_parked;
+		vilc_descriptorAllocator_parked = pool;
+		VILC_ATOMIC_ADD(&vilc_descriptorAllocator_stats.parkedPools, 1);
+		pool = NULL;
+	}
+	pthread_mutex_unlock(&vilc_descriptorAllocator_mutex);
+
+	if (pool)
+		vilc_descriptorAllocator_destroyChain(pool);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_descriptorAllocator_vkResetDescriptorPool(VkDevice device, VkDescriptorPool descriptorPool, VkDescriptorPoolResetFlags flags)
+{
+	VilcDescriptorAllocatorPool* pool = vilc_descriptorAllocator_find(descriptorPool);
+
+	if (!pool)
+		return vilc_descriptorAllocator_next_vkResetDescriptorPool(device, descriptorPool, flags);
+
+	pthread_mutex_lock(&pool->mutex);
+	vilc_descriptorAllocator_resetChain(device, pool);
+	pthread_mutex_unlock(&pool->mutex);
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_descriptorAllocator_vkAllocateDescriptorSets(VkDevice device, const VkDescriptorSetAllocateInfo* pAllocateInfo, VkDescriptorSet* pDescriptorSets)
+{
+	VilcDescriptorAllocatorPool* pool = vilc_descriptorAllocator_find(pAllocateInfo->descriptorPool);
+	VkDescriptorSetLayout layoutStorage[VILC_DESCRIPTOR_ALLOCATOR_BATCH];
+	VkDescriptorSet setStorage[VILC_DESCRIPTOR_ALLOCATOR_BATCH];
+	VkDescriptorSetLayout* layouts = layoutStorage;
+	VkDescriptorSet* sets = setStorage;
+	VkDescriptorSetAllocateInfo allocateInfo;
+	VilcDescriptorAllocatorSet* set;
+	uint32_t count = pAllocateInfo->descriptorSetCount, recycled = 0, remaining = 0, i, j;
+	uint64_t start;
+	VkResult result = VK_SUCCESS;
+	int recyclable;
+
+	if (!pool)
+		return vilc_descriptorAllocator_next_vkAllocateDescriptorSets(device, pAllocateInfo, pDescriptorSets);
+
+	start = vilc_monotonicNow();
+	if (count > VILC_DESCRIPTOR_ALLOCATOR_BATCH)
+	{
+		/* handles of both types are 64-bit */
+		layouts = (VkDescriptorSetLayout*)malloc(count * (sizeof(VkDescriptorSetLayout) + sizeof(VkDescriptorSet)));
+		if (!layouts)
+			return VK_ERROR_OUT_OF_HOST_MEMORY;
+		sets = (VkDescriptorSet*)(layouts + count);
+	}
+
+	pthread_mutex_lock(&pool->mutex);
+	recyclable = (pool->flags & VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT) && !pAllocateInfo->pNext;
+	for (i = 0; i < count; ++i)
+	{
+		set = recyclable ? vilc_descriptorAllocator_takeFree(pool, pAllocateInfo->pSetLayouts[i]) : NULL;
+		pDescriptorSets[i] = set ? set->set : VK_NULL_HANDLE;
+		if (set)
+			recycled++;
+		else
+			layouts[remaining++] = pAllocateInfo->pSetLayouts[i];
+	}
+
+	if (remaining)
+	{
+		allocateInfo = *pAllocateInfo;
+		allocateInfo.descriptorSetCount = remaining;
+		allocateInfo.pSetLayouts = layouts;
+		result = vilc_descriptorAllocator_allocate(device, pool, &allocateInfo, sets);
+	}
+	if (result == VK_SUCCESS)
+	{
+		for (i = 0, j = 0; i < count; ++i)
+			if (!pDescriptorSets[i])
+				pDescriptorSets[i] = sets[j++];
+	}
+	else
+	{
+		/* the call fails as a whole, so the sets taken from freelists go back */
+		for (i = 0; i < count; ++i)
+			if (pDescriptorSets[i])
+			{
+				vilc_descriptorAllocator_release(device, pool, (VilcDescriptorAllocatorSet*)vilc_mapRemove(&pool->liveSets, VILC_OBJECT_KEY(pDescriptorSets[i])));
+				pDescriptorSets[i] = VK_NULL_HANDLE;
+			}
+	}
+	pthread_mutex_unlock(&pool->mutex);
+
+	if (layouts != layoutStorage)
+		free(layouts);
+	if (result != VK_SUCCESS)
+		return result;
+
+	VILC_ATOMIC_ADD(&vilc_descriptorAllocator_stats.allocatedSets, count);
+	VILC_ATOMIC_ADD(&vilc_descriptorAllocator_stats.recycledSets, recycled);
+	vilc_histogramRecord(&vilc_descriptorAllocator_stats.allocationTime, vilc_monotonicNow() - start);
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_descriptorAllocator_vkFreeDescriptorSets(VkDevice device, VkDescriptorPool descriptorPool, uint32_t descriptorSetCount, const VkDescriptorSet* pDescriptorSets)
+{
+	VilcDescriptorAllocatorPool* pool = vilc_descriptorAllocator_find(descriptorPool);
+	VilcDescriptorAllocatorSet* set;
+	uint32_t i;
+
+	if (!pool)
+		return vilc_descriptorAllocator_next_vkFreeDescriptorSets(device, descriptorPool, descriptorSetCount, pDescriptorSets);
+
+	pthread_mutex_lock(&pool->mutex);
+	for (i = 0; i < descriptorSetCount; ++i)
+		if (pDescriptorSets[i] && (set = (VilcDescriptorAllocatorSet*)vilc_mapRemove(&pool->liveSets, VILC_OBJECT_KEY(pDescriptorSets[i]))) != NULL)
+			vilc_descriptorAllocator_release(device, pool, set);
+	pthread_mutex_unlock(&pool->mutex);
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_descriptorAllocator_vkDestroyDescriptorSetLayout(VkDevice device, VkDescriptorSetLayout descriptorSetLayout, const VkAllocationCallbacks* pAllocator)
+{
+	VilcDescriptorAllocatorPool* pool;
+	VilcDescriptorAllocatorSet* set;
+	uint32_t i;
+
+	/* a later layout may get the same handle, so the freelists of the layout are freed */
+	pthread_mutex_lock(&vilc_descriptorAllocator_mutex);
+	for (i = 0; descriptorSetLayout && i < vilc_descriptorAllocator_pools.capacity; ++i)
+	{
+		pool = (VilcDescriptorAllocatorPool*)vilc_descriptorAllocator_pools.values[i];
+		if (!pool || pool->device != device || !pool->freeSets.count)
+			continue;
+
+		pthread_mutex_lock(&pool->mutex);
+		set = (VilcDescriptorAllocatorSet*)vilc_mapRemove(&pool->freeSets, VILC_OBJECT_KEY(descriptorSetLayout));
+		while (set)
+		{
+			VilcDescriptorAllocatorSet* next = set->next;
+
+			vilc_descriptorAllocator_next_vkFreeDescriptorSets(device, set->driverPool, 1, &set->set);
+			free(set);
+			set = next;
+		}
+		pthread_mutex_unlock(&pool->mutex);
+	}
+	pthread_mutex_unlock(&vilc_descriptorAllocator_mutex);
+
+	vilc_descriptorAllocator_next_vkDestroyDescriptorSetLayout(device, descriptorSetLayout, pAllocator);
+}
+
+static void vilc_descriptorAllocator_install(void)
+{
+	const char* parkedPools = getenv("VILC_DESCRIPTOR_ALLOCATOR_PARKED_POOLS");
+
+	vilc_descriptorAllocator_parkedLimit = parkedPools ? (uint32_t)strtoul(parkedPools, NULL, 10) : VILC_DESCRIPTOR_ALLOCATOR_PARKED_POOLS;
+
+	VILC_LAYER_HOOK(vilc_descriptorAllocator, vkDestroyDevice)
+	VILC_LAYER_HOOK(vilc_descriptorAllocator, vkCreateDescriptorPool)
+	VILC_LAYER_HOOK(vilc_descriptorAllocator, vkDestroyDescriptorPool)
+	VILC_LAYER_HOOK(vilc_descriptorAllocator, vkResetDescriptorPool)
+	VILC_LAYER_HOOK(vilc_descriptorAllocator, vkAllocateDescriptorSets)
+	VILC_LAYER_HOOK(vilc_descriptorAllocator, vkFreeDescriptorSets)
+	VILC_LAYER_HOOK(vilc_descriptorAllocator, vkDestroyDescriptorSetLayout)
+}
+#endif /* VILC_DESCRIPTOR_ALLOCATOR */
+
+#if defined(VOLK_IN_LOADERS_CLOTH) && defined(VILC_DESCRIPTOR_REUSE)
+/* Descriptor set reuse: sets allocated with a layout of plain sampler, image, buffer and texel buffer bindings get a
+ * handle of the mode that no driver set backs. vkUpdateDescriptorSets and vkUpdateDescriptorSetWithTemplate write their
+ * descriptors into the content of the set, in binding order with a written flag per descriptor, and the first bind of the
+ * set looks the content up by its hash: a driver set with the same layout and content is bound as it is, and otherwise a
+ * driver set is allocated from pools of the mode and written once. Driver sets no set of the application is bound as
+ * any more retire VILC_DESCRIPTOR_REUSE_FRAMES presents after they were last bound, so command buffers in flight keep
+ * them, and are reused until then. Only sets that are not updated after they were bound are shared: such an update, a
+ * copy from a driver set or a write with pNext structures gives the set a driver set of its own, which the calls that
+ * follow update directly. Layouts with flags or pNext structures and allocations with pNext structures pass through.
+ * Handles can be created again with the value of one that was destroyed, so destroying a buffer, image view, buffer
+ * view or sampler stops the driver sets that refer to it from being shared, frees the idle ones, and drops its
+ * descriptors from the content of the sets.
+ */
+#define VILC_DESCRIPTOR_REUSE_FRAMES 3
+/* sets per driver pool of a layout */
+#define VILC_DESCRIPTOR_REUSE_POOL_SETS 64
+/* writes, copies, frees and binds of up to this many sets are handled without allocating */
+#define VILC_DESCRIPTOR_REUSE_BATCH 32
+/* the descriptor types up to VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT */
+#define VILC_DESCRIPTOR_REUSE_TYPES 11
+
+typedef struct VilcDescriptorReuseBinding
+{
+	uint32_t binding;
+	VkDescriptorType type;
+	uint32_t count;
+	uint32_t size; /* of one descriptor in the content */
+	uint32_t offset; /* of the descriptors in the content */
+	uint32_t first; /* index of the first descriptor, for the written flags */
+	int immutableSamplers;
+} VilcDescriptorReuseBinding;
+
+typedef struct VilcDescriptorReuseLayout
+{
+	VkDescriptorSetLayout layout;
+	/* handles of the application, and sets and driver sets of the layout */
+	uint32_t references;
+	uint32_t handles;
+	/* vkDestroyDescriptorSetLayout calls held until the last reference is dropped */
+	uint32_t pendingDestroys;
+	int hasAllocator;
+	VkAllocationCallbacks allocator;
+	VkDescriptorPool* pools;
+	uint32_t poolCount;
+	uint32_t poolSizeCount;
+	VkDescriptorPoolSize poolSizes[VILC_DESCRIPTOR_REUSE_TYPES];
+	size_t descriptorSize; /* the written flags follow the descriptors in the content */
+	size_t contentSize;
+	uint32_t bindingCount;
+	VilcDescriptorReuseBinding bindings[1];
+} VilcDescriptorReuseLayout;
+
+/* A driver set; shared ones are found by the hash of their content */
+typedef struct VilcDescriptorReuseEntry
+{
+	VilcDescriptorReuseLayout* layout;
+	VkDescriptorSet set;
+	VkDescriptorPool pool;
+	uint64_t hash; /* 0 for driver sets of one set */
+	uint32_t references;
+	uint64_t lastFrame;
+	/* driver sets without references, until they retire */
+	struct VilcDescriptorReuseEntry* prevIdle;
+	struct VilcDescriptorReuseEntry* nextIdle;
+	uint64_t content[1];
+} VilcDescriptorReuseEntry;
+
+typedef struct VilcDescriptorReuseSet
+{
+	VilcDescriptorReuseLayout* layout;
+	struct VilcDescriptorReusePool* pool;
+	struct VilcDescriptorReuseSet* prev;
+	struct VilcDescriptorReuseSet* next;
+	/* the driver set the set is bound as, NULL until it is bound */
+	VilcDescriptorReuseEntry* entry;
+	/* the driver set is the set's own and updates go to it; the content is not kept up to date any more */
+	int isPrivate;
+	uint64_t content[1];
+} VilcDescriptorReuseSet;
+
+typedef struct VilcDescriptorReusePool
+{
+	VkDescriptorPool pool;
+	uint32_t maxSets;
+	uint32_t setCount;
+	VilcDescriptorReuseSet* sets;
+} VilcDescriptorReusePool;
+
+typedef struct VilcDescriptorReuseTemplate
+{
+	int recordable; /* only descriptor types whose writes are recorded */
+	uint32_t entryCount;
+	VkDescriptorUpdateTemplateEntry entries[1];
+} VilcDescriptorReuseTemplate;
+
+static pthread_mutex_t vilc_descriptorReuse_mutex = PTHREAD_MUTEX_INITIALIZER;
+static VkDevice vilc_descriptorReuse_device;
+static uint64_t vilc_descriptorReuse_frames;
+static uint64_t vilc_descriptorReuse_frame;
+static VilcHandleMap vilc_descriptorReuse_layouts; /* VkDescriptorSetLayout -> VilcDescriptorReuseLayout */
+static VilcHandleMap vilc_descriptorReuse_pools; /* VkDescriptorPool -> VilcDescriptorReusePool */
+static VilcHandleMap vilc_descriptorReuse_sets; /* VkDescriptorSet of the application -> VilcDescriptorReuseSet */
+static VilcHandleMap vilc_descriptorReuse_entries; /* content hash -> shared VilcDescriptorReuseEntry */
+static VilcHandleMap vilc_descriptorReuse_templates; /* VkDescriptorUpdateTemplate -> VilcDescriptorReuseTemplate */
+static VilcDescriptorReuseEntry* vilc_descriptorReuse_idle;
+static VilcDescriptorReuseStats vilc_descriptorReuse_stats;
+
+VILC_LAYER_NEXT(vilc_descriptorReuse, vkCreateDevice)
+VILC_LAYER_NEXT(vilc_descriptorReuse, vkDestroyDevice)
+VILC_LAYER_NEXT(vilc_descriptorReuse, vkCreateDescriptorSetLayout)
+VILC_LAYER_NEXT(vilc_descriptorReuse, vkDestroyDescriptorSetLayout)
+VILC_LAYER_NEXT(vilc_descriptorReuse, vkCreateDescriptorPool)
+VILC_LAYER_NEXT(vilc_descriptorReuse, vkDestroyDescriptorPool)
+VILC_LAYER_NEXT(vilc_descriptorReuse, vkResetDescriptorPool)
+VILC_LAYER_NEXT(vilc_descriptorReuse, vkAllocateDescriptorSets)
+VILC_LAYER_NEXT(vilc_descriptorReuse, vkFreeDescriptorSets)
+VILC_LAYER_NEXT(vilc_descriptorReuse, vkUpdateDescriptorSets)
+VILC_LAYER_NEXT(vilc_descriptorReuse, vkCmdBindDescriptorSets)
+VILC_LAYER_NEXT(vilc_descriptorReuse, vkDestroyBuffer)
+VILC_LAYER_NEXT(vilc_descriptorReuse, vkDestroyBufferView)
+VILC_LAYER_NEXT(vilc_descriptorReuse, vkDestroyImageView)
+VILC_LAYER_NEXT(vilc_descriptorReuse, vkDestroySampler)
+#if defined(VK_VERSION_1_1)
+VILC_LAYER_NEXT(vilc_descriptorReuse, vkCreateDescriptorUpdateTemplate)
+VILC_LAYER_NEXT(vilc_descriptorReuse, vkDestroyDescriptorUpdateTemplate)
+VILC_LAYER_NEXT(vilc_descriptorReuse, vkUpdateDescriptorSetWithTemplate)
+#endif
+#if defined(VK_VERSION_1_4)
+VILC_LAYER_NEXT(vilc_descriptorReuse, vkCmdBindDescriptorSets2)
+#endif
+#if defined(VK_KHR_descriptor_update_template)
+VILC_LAYER_NEXT(vilc_descriptorReuse, vkCreateDescriptorUpdateTemplateKHR)
+VILC_LAYER_NEXT(vilc_descriptorReuse, vkDestroyDescriptorUpdateTemplateKHR)
+VILC_LAYER_NEXT(vilc_descriptorReuse, vkUpdateDescriptorSetWithTemplateKHR)
+#endif
+#if defined(VK_KHR_maintenance6)
+VILC_LAYER_NEXT(vilc_descriptorReuse, vkCmdBindDescriptorSets2KHR)
+#endif
+#if defined(VK_KHR_swapchain)
+VILC_LAYER_NEXT(vilc_descriptorReuse, vkQueuePresentKHR)
+#endif
+#if defined(VK_EXT_debug_utils)
+VILC_LAYER_NEXT(vilc_descriptorReuse, vkSetDebugUtilsObjectNameEXT)
+VILC_LAYER_NEXT(vilc_descriptorReuse, vkSetDebugUtilsObjectTagEXT)
+#endif
+
+/* Bytes a descriptor of the type takes in the content of a set, or 0 for types whose writes are not recorded */
+static uint32_t vilc_descriptorReuse_descriptorSize(VkDescriptorType type)
+{
+	switch (type)
+	{
+	case VK_DESCRIPTOR_TYPE_SAMPLER:
+	case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+	case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+	case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+	case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+		return sizeof(VkDescriptorImageInfo);
+	case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+	case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+		return sizeof(VkBufferView);
+	case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+	case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+	case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+	case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+		return sizeof(VkDescriptorBufferInfo);
+	default:
+		return 0;
+	}
+}
+
+static int vilc_descriptorReuse_isBuffer(VkDescriptorType type)
+{
+	return type >= VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER && type <= VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+}
+
+static int vilc_descriptorReuse_isTexelBuffer(VkDescriptorType type)
+{
+	return type == VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER || type == VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER;
+}
+
+static VkDescriptorSet vilc_descriptorReuse_handle(const VilcDescriptorReuseSet* set)
+{
+	return (VkDescriptorSet)(uintptr_t)set;
+}
+
+/* Caller locks */
+static VilcDescriptorReuseSet* vilc_descriptorReuse_find(VkDescriptorSet descriptorSet)
+{
+	if (!descriptorSet || !vilc_descriptorReuse_sets.count)
+		return NULL;
+	return (VilcDescriptorReuseSet*)vilc_mapFind(&vilc_descriptorReuse_sets, VILC_OBJECT_KEY(descriptorSet));
+}
+
+/* Index of the binding with the given number, or bindingCount */
+static uint32_t vilc_descriptorReuse_findBinding(const VilcDescriptorReuseLayout* layout, uint32_t binding)
+{
+	uint32_t low = 0, high = layout->bindingCount;
+
+	while (low < high)
+	{
+		uint32_t middle = (low + high) / 2;
+		if (layout->bindings[middle].binding < binding)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+	return low < layout->bindingCount && layout->bindings[low].binding == binding ? low : layout->bindingCount;
+}
+
+/* Moves a position past the end of its binding on to the next binding with descriptors, the way updates continue;
+ * returns 0 past the last binding
+ */
+static int vilc_descriptorReuse_advance(const VilcDescriptorReuseLayout* layout, uint32_t* index, uint32_t* arrayElement)
+{
+	while (*index < layout->bindingCount && *arrayElement >= layout->bindings[*index].count)
+	{
+		*arrayElement -= layout->bindings[*index].count;
+		++*index;
+	}
+	return *index < layout->bindingCount;
+}
+
+/* Stores count descriptors from data, stride bytes apart, with the fields the descriptor type ignores zeroed, so equal
+ * descriptors are equal bytes
+ */
+static void vilc_descriptorReuse_store(const VilcDescriptorReuseLayout* layout, uint64_t* content, uint32_t binding, uint32_t arrayElement, uint32_t count, const void* data, size_t stride)
+{
+	unsigned char* bytes = (unsigned char*)content;
+	const unsigned char* source = (const unsigned char*)data;
+	uint32_t index = vilc_descriptorReuse_findBinding(layout, binding);
+
+	for (; count && vilc_descriptorReuse_advance(layout, &index, &arrayElement); --count, ++arrayElement, source += stride)
+	{
+		const VilcDescriptorReuseBinding* target = &layout->bindings[index];
+		unsigned char* descriptor = bytes + target->offset + (size_t)arrayElement * target->size;
+
+		memset(descriptor, 0, target->size);
+		if (!vilc_descriptorReuse_isBuffer(target->type) && !vilc_descriptorReuse_isTexelBuffer(target->type))
+		{
+			const VkDescriptorImageInfo* image = (const VkDescriptorImageInfo*)source;
+
+			if ((target->type == VK_DESCRIPTOR_TYPE_SAMPLER || target->type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER) && !target->immutableSamplers)
+				memcpy(descriptor + offsetof(VkDescriptorImageInfo, sampler), &image->sampler, sizeof(image->sampler));
+			if (target->type != VK_DESCRIPTOR_TYPE_SAMPLER)
+			{
+				memcpy(descriptor + offsetof(VkDescriptorImageInfo, imageView), &image->imageView, sizeof(image->imageView));
+				memcpy(descriptor + offsetof(VkDescriptorImageInfo, imageLayout), &image->imageLayout, sizeof(image->imageLayout));
+			}
+		}
+		else
+			memcpy(descriptor, source, target->size);
+		bytes[layout->descriptorSize + target->first + arrayElement] = 1;
+	}
+}
+
+static void vilc_descriptorReuse_copy(const VkCopyDescriptorSet* copy, const VilcDescriptorReuseSet* src, VilcDescriptorReuseSet* dst)
+{
+	const unsigned char* source = (const unsigned char*)src->content;
+	unsigned char* target = (unsigned char*)dst->content;
+	uint32_t srcIndex = vilc_descriptorReuse_findBinding(src->layout, copy->srcBinding), srcElement = copy->srcArrayElement;
+	uint32_t dstIndex = vilc_descriptorReuse_findBinding(dst->layout, copy->dstBinding), dstElement = copy->dstArrayElement;
+	uint32_t count;
+
+	for (count = copy->descriptorCount; count; --count, ++srcElement, ++dstElement)
+	{
+		const VilcDescriptorReuseBinding* from;
+		const VilcDescriptorReuseBinding* to;
+
+		if (!vilc_descriptorReuse_advance(src->layout, &srcIndex, &srcElement) || !vilc_descriptorReuse_advance(dst->layout, &dstIndex, &dstElement))
+			break;
+		from = &src->layout->bindings[srcIndex];
+		to = &dst->layout->bindings[dstIndex];
+		memcpy(target + to->offset + (size_t)dstElement * to->size, source + from->offset + (size_t)srcElement * from->size, to->size);
+		target[dst->layout->descriptorSize + to->first + dstElement] = source[src->layout->descriptorSize + from->first + srcElement];
+	}
+}
+
+/* Writes the descriptors of the content into a driver set, one write per run of written descriptors in a binding */
+static void vilc_descriptorReuse_replay(VkDevice device, const VilcDescriptorReuseLayout* layout, const uint64_t* content, VkDescriptorSet set)
+{
+	const unsigned char* bytes = (const unsigned char*)content;
+	const unsigned char* written = bytes + layout->descriptorSize;
+	VkWriteDescriptorSet writes[VILC_DESCRIPTOR_REUSE_BATCH];
+	uint32_t writeCount = 0, i, first, last;
+
+	for (i = 0; i < layout->bindingCount; ++i)
+	{
+		const VilcDescriptorReuseBinding* binding = &layout->bindings[i];
+
+		for (first = 0; first < binding->count; first = last)
+		{
+			VkWriteDescriptorSet* write = &writes[writeCount];
+			const void* data = bytes + binding->offset + (size_t)first * binding->size;
+
+			for (last = first; last < binding->count && written[binding->first + last]; ++last)
+				;
+			if (last == first)
+			{
+				last++;
+				continue;
+			}
+
+			memset(write, 0, sizeof(*write));
+			write->sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			write->dstSet = set;
+			write->dstBinding = binding->binding;
+			write->dstArrayElement = first;
+			write->descriptorCount = last - first;
+			write->descriptorType = binding->type;
+			if (vilc_descriptorReuse_isTexelBuffer(binding->type))
+				write->pTexelBufferView = (const VkBufferView*)data;
+			else if (vilc_descriptorReuse_isBuffer(binding->type))
+				write->pBufferInfo = (const VkDescriptorBufferInfo*)data;
+			else
+				write->pImageInfo = (const VkDescriptorImageInfo*)data;
+
+			if (++writeCount == VILC_DESCRIPTOR_REUSE_BATCH)
+			{
+				vilc_descriptorReuse_next_vkUpdateDescriptorSets(device, writeCount, writes, 0, NULL);
+				writeCount = 0;
+			}
+		}
+	}
+	if (writeCount)
+		vilc_descriptorReuse_next_vkUpdateDescriptorSets(device, writeCount, writes, 0, NULL);
+}
+
+/* Allocates a driver set from the pools of the layout, adding a pool when they are all full; caller locks */
+static VkResult vilc_descriptorReuse_allocateDriverSet(VkDevice device, VilcDescriptorReuseLayout* layout, VkDescriptorPool* pPool, VkDescriptorSet* pSet)
+{
+	VkDescriptorSetAllocateInfo allocateInfo;
+	VkDescriptorPoolCreateInfo poolInfo;
+	VkDescriptorPool* pools;
+	VkResult result;
+	uint32_t i;
+
+	memset(&allocateInfo, 0, sizeof(allocateInfo));
+	allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocateInfo.descriptorSetCount = 1;
+	allocateInfo.pSetLayouts = &layout->layout;
+	/* the last pool is the one most likely to have room */
+	for (i = layout->poolCount; i--;)
+	{
+		allocateInfo.descriptorPool = layout->pools[i];
+		result = vilc_descriptorReuse_next_vkAllocateDescriptorSets(device, &allocateInfo, pSet);
+		if (result == VK_SUCCESS)
+		{
+			*pPool = layout->pools[i];
+			return VK_SUCCESS;
+		}
+		if (result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL)
+			return result;
+	}
+
+	pools = (VkDescriptorPool*)realloc(layout->pools, (layout->poolCount + 1) * sizeof(VkDescriptorPool));
+	if (!pools)
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	layout->pools = pools;
+
+	memset(&poolInfo, 0, sizeof(poolInfo));
+	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+	poolInfo.maxSets = VILC_DESCRIPTOR_REUSE_POOL_SETS;
+	poolInfo.poolSizeCount = layout->poolSizeCount;
+	poolInfo.pPoolSizes = layout->poolSizes;
+	result = vilc_descriptorReuse_next_vkCreateDescriptorPool(device, &poolInfo, NULL, &pools[layout->poolCount]);
+	if (result != VK_SUCCESS)
+		return result;
+	layout->poolCount++;
+
+	allocateInfo.descriptorPool = pools[layout->poolCount - 1];
+	result = vilc_descriptorReuse_next_vkAllocateDescriptorSets(device, &allocateInfo, pSet);
+	if (result == VK_SUCCESS)
+		*pPool = allocateInfo.descriptorPool;
+	return result;
+}
+
+/* Drops a reference and destroys the layout with the last one, making the destroy calls of the application that were
+ * held; caller locks
+ */
+static void vilc_descriptorReuse_releaseLayout(VkDevice device, VilcDescriptorReuseLayout* layout)
+{
+	uint32_t i;
+
+	if (--layout->references)
+		return;
+
+	for (i = 0; i < layout->poolCount; ++i)
+		vilc_descriptorReuse_next_vkDestroyDescriptorPool(device, layout->pools[i], NULL);
+	for (i = 0; i < layout->pendingDestroys; ++i)
+		vilc_descriptorReuse_next_vkDestroyDescriptorSetLayout(device, layout->layout, layout->hasAllocator ? &layout->allocator : NULL);
+	free(layout->pools);
+	free(layout);
+}
+
+/* Allocates a driver set with the descriptors of the content, shared under the hash unless it is 0; caller locks */
+static VilcDescriptorReuseEntry* vilc_descriptorReuse_createEntry(VkDevice device, VilcDescriptorReuseLayout* layout, const uint64_t* content, uint64_t hash)
+{
+	VilcDescriptorReuseEntry* entry = (VilcDescriptorReuseEntry*)calloc(1, offsetof(VilcDescriptorReuseEntry, content) + (hash ? layout->contentSize : 0) + sizeof(uint64_t));
+
+	if (!entry)
+		return NULL;
+	if (vilc_descriptorReuse_allocateDriverSet(device, layout, &entry->pool, &entry->set) != VK_SUCCESS)
+	{
+		free(entry);
+		return NULL;
+	}
+	vilc_descriptorReuse_replay(device, layout, content, entry->set);
+
+	if (hash)
+	{
+		memcpy(entry->content, content, layout->contentSize);
+		entry->hash = vilc_mapInsert(&vilc_descriptorReuse_entries, hash, entry) ? hash : 0;
+	}
+	entry->layout = layout;
+	entry->references = 1;
+	entry->lastFrame = vilc_descriptorReuse_frame;
+	layout->references++;
+
+	VILC_ATOMIC_ADD(&vilc_descriptorReuse_stats.driverSets, 1);
+	VILC_ATOMIC_ADD(&vilc_descriptorReuse_stats.liveDriverSets, 1);
+	return entry;
+}
+
+static void vilc_descriptorReuse_destroyEntry(VkDevice device, VilcDescriptorReuseEntry* entry)
+{
+	if (entry->prevIdle)
+		entry->prevIdle->nextIdle = entry->nextIdle;
+	else if (vilc_descriptorReuse_idle == entry)
+		vilc_descriptorReuse_idle = entry->nextIdle;
+	if (entry->nextIdle)
+		entry->nextIdle->prevIdle = entry->prevIdle;
+	if (entry->hash)
+		vilc_mapRemove(&vilc_descriptorReuse_entries, entry->hash);
+
+	vilc_descriptorReuse_next_vkFreeDescriptorSets(device, entry->pool, 1, &entry->set);
+	vilc_descriptorReuse_releaseLayout(device, entry->layout);
+	free(entry);
+	VILC_ATOMIC_ADD(&vilc_descriptorReuse_stats.liveDriverSets, (uint32_t)0 - 1);
+}
+
+/* Driver sets without references wait on the idle list until they retire or are bound again; caller locks */
+static void vilc_descriptorReuse_releaseEntry(VilcDescriptorReuseEntry* entry)
+{
+	if (--entry->references)
+		return;
+
+	entry->prevIdle = NULL;
+	entry->nextIdle = vilc_descriptorReuse_idle;
+	if (vilc_descriptorReuse_idle)
+		vilc_descriptorReuse_idle->prevIdle = entry;
+	vilc_descriptorReuse_idle = entry;
+}
+
+static void vilc_descriptorReuse_acquireEntry(VilcDescriptorReuseEntry* entry)
+{
+	if (entry->references++)
+		return;
+
+	if (entry->prevIdle)
+		entry->prevIdle->nextIdle = entry->nextIdle;
+	else
+		vilc_descriptorReuse_idle = entry->nextIdle;
+	if (entry->nextIdle)
+		entry->nextIdle->prevIdle = entry->prevIdle;
+	entry->prevIdle = entry->nextIdle = NULL;
+}
+
+/* Returns the driver set the set is bound as, looking it up by content at the first bind; caller locks */
+static VkDescriptorSet vilc_descriptorReuse_resolve(VkDevice device, VilcDescriptorReuseSet* set)
+{
+	VilcDescriptorReuseLayout* layout = set->layout;
+	VilcDescriptorReuseEntry* entry = set->entry;
+	uint64_t hash;
+
+	if (!entry)
+	{
+		hash = vilc_hashBytes(set->content, layout->contentSize, VILC_OBJECT_KEY(layout->layout));
+		hash = hash ? hash : 1;
+		entry = (VilcDescriptorReuseEntry*)vilc_mapFind(&vilc_descriptorReuse_entries, hash);
+		if (entry && entry->layout == layout && memcmp(entry->content, set->content, layout->contentSize) == 0)
+		{
+			vilc_descriptorReuse_acquireEntry(entry);
+			VILC_ATOMIC_ADD(&vilc_descriptorReuse_stats.reusedSets, 1);
+		}
+		/* a hash collision leaves the driver set unshared */
+		else if ((entry = vilc_descriptorReuse_createEntry(device, layout, set->content, entry ? 0 : hash)) == NULL)
+			return VK_NULL_HANDLE;
+		set->entry = entry;
+	}
+	entry->lastFrame = vilc_descriptorReuse_frame;
+	return entry->set;
+}
+
+/* Gives the set a driver set of its own with the descriptors written so far, for updates after it was bound and
+ * updates the content can not take; caller locks
+ */
+static VilcDescriptorReuseEntry* vilc_descriptorReuse_privatize(VkDevice device, VilcDescriptorReuseSet* set)
+{
+	VilcDescriptorReuseEntry* entry;
+
+	if (set->isPrivate)
+		return set->entry;
+	entry = vilc_descriptorReuse_createEntry(device, set->layout, set->content, 0);
+	if (!entry)
+		return NULL;
+	if (set->entry)
+		vilc_descriptorReuse_releaseEntry(set->entry);
+	set->entry = entry;
+	set->isPrivate = 1;
+	VILC_ATOMIC_ADD(&vilc_descriptorReuse_stats.privateSets, 1);
+	return entry;
+}
+
+/* Caller locks */
+static void vilc_descriptorReuse_freeSet(VkDevice device, VilcDescriptorReuseSet* set)
+{
+	vilc_mapRemove(&vilc_descriptorReuse_sets, VILC_OBJECT_KEY(vilc_descriptorReuse_handle(set)));
+	if (set->prev)
+		set->prev->next = set->next;
+	else
+		set->pool->sets = set->next;
+	if (set->next)
+		set->next->prev = set->prev;
+	set->pool->setCount--;
+
+	if (set->entry)
+		vilc_descriptorReuse_releaseEntry(set->entry);
+	vilc_descriptorReuse_releaseLayout(device, set->layout);
+	free(set);
+}
+
+/* Frees the driver sets that were not bound for VILC_DESCRIPTOR_REUSE_FRAMES presents, or all idle ones; caller locks */
+static void vilc_descriptorReuse_retire(VkDevice device, int all)
+{
+	VilcDescriptorReuseEntry* entry;
+	VilcDescriptorReuseEntry* next;
+
+	for (entry = vilc_descriptorReuse_idle; entry; entry = next)
+	{
+		next = entry->nextIdle;
+		if (all || entry->lastFrame + vilc_descriptorReuse_frames <= vilc_descriptorReuse_frame)
+		{
+			vilc_descriptorReuse_destroyEntry(device, entry);
+			VILC_ATOMIC_ADD(&vilc_descriptorReuse_stats.retiredSets, 1);
+		}
+	}
+}
+
+/* Whether a written descriptor of the content refers to the handle of the object type; with clear, those descriptors
+ * are zeroed and marked unwritten
+ */
+static int vilc_descriptorReuse_refers(const VilcDescriptorReuseLayout* layout, uint64_t* content, VkObjectType objectType, uint64_t handle, int clear)
+{
+	unsigned char* bytes = (unsigned char*)content;
+	unsigned char* written = bytes + layout->descriptorSize;
+	int found = 0;
+	uint32_t i, j;
+
+	for (i = 0; i < layout->bindingCount; ++i)
+	{
+		const VilcDescriptorReuseBinding* binding = &layout->bindings[i];
+		int isImage = !vilc_descriptorReuse_isBuffer(binding->type) && !vilc_descriptorReuse_isTexelBuffer(binding->type);
+		size_t offset;
+
+		if (objectType == VK_OBJECT_TYPE_BUFFER && vilc_descriptorReuse_isBuffer(binding->type))
+			offset = offsetof(VkDescriptorBufferInfo, buffer);
+		else if (objectType == VK_OBJECT_TYPE_BUFFER_VIEW && vilc_descriptorReuse_isTexelBuffer(binding->type))
+			offset = 0;
+		else if (objectType == VK_OBJECT_TYPE_IMAGE_VIEW && isImage && binding->type != VK_DESCRIPTOR_TYPE_SAMPLER)
+			offset = offsetof(VkDescriptorImageInfo, imageView);
+		else if (objectType == VK_OBJECT_TYPE_SAMPLER && (binding->type == VK_DESCRIPTOR_TYPE_SAMPLER || binding->type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER))
+			offset = offsetof(VkDescriptorImageInfo, sampler);
+		else
+			continue;
+
+		for (j = 0; j < binding->count; ++j)
+		{
+			unsigned char* descriptor = bytes + binding->offset + (size_t)j * binding->size;
+			uint64_t value;
+
+			/* non-dispatchable handles take 64 bits on every platform */
+			memcpy(&value, descriptor + offset, sizeof(value));
+			if (!written[binding->first + j] || value != handle)
+				continue;
+			found = 1;
+			if (clear)
+			{
+				memset(descriptor, 0, binding->size);
+				written[binding->first + j] = 0;
+			}
+		}
+	}
+	return found;
+}
+
+/* Called before the application destroys the handle, so a handle created later with the same value does not match the
+ * driver sets written with this one; walks every set, which is fine for destroys
+ */
+static void vilc_descriptorReuse_forget(VkDevice device, VkObjectType objectType, uint64_t handle)
+{
+	VilcDescriptorReuseEntry* entry;
+	VilcDescriptorReuseEntry* next;
+	VilcDescriptorReusePool* pool;
+	VilcDescriptorReuseSet* set;
+	uint32_t i;
+
+	if (!handle)
+		return;
+
+	pthread_mutex_lock(&vilc_descriptorReuse_mutex);
+	if (device != vilc_descriptorReuse_device)
+	{
+		pthread_mutex_unlock(&vilc_descriptorReuse_mutex);
+		return;
+	}
+
+	/* no command buffer in flight may use the handle any more, so idle driver sets with it can be freed right away */
+	for (entry = vilc_descriptorReuse_idle; entry; entry = next)
+	{
+		next = entry->nextIdle;
+		if (entry->hash && vilc_descriptorReuse_refers(entry->layout, entry->content, objectType, handle, 0))
+			vilc_descriptorReuse_destroyEntry(device, entry);
+	}
+
+	/* the other shared driver sets stay bound as they are until they are released, but are not found any more; sets
+	 * replay their content when they get a driver set of their own, which must not write the destroyed handle
+	 */
+	for (i = 0; i < vilc_descriptorReuse_pools.capacity; ++i)
+	{
+		if ((pool = (VilcDescriptorReusePool*)vilc_descriptorReuse_pools.values[i]) == NULL)
+			continue;
+		for (set = pool->sets; set; set = set->next)
+		{
+			entry = set->entry;
+			if (entry && entry->hash && vilc_descriptorReuse_refers(entry->layout, entry->content, objectType, handle, 0))
+			{
+				vilc_mapRemove(&vilc_descriptorReuse_entries, entry->hash);
+				entry->hash = 0;
+			}
+			if (!set->isPrivate)
+				vilc_descriptorReuse_refers(set->layout, set->content, objectType, handle, 1);
+		}
+	}
+	pthread_mutex_unlock(&vilc_descriptorReuse_mutex);
+}
+
+void vilcGetDescriptorReuseStats(VilcDescriptorReuseStats* stats)
+{
+	stats->allocatedSets = VILC_ATOMIC_LOAD(&vilc_descriptorReuse_stats.allocatedSets);
+	stats->passedThroughSets = VILC_ATOMIC_LOAD(&vilc_descriptorReuse_stats.passedThroughSets);
+	stats->recordedUpdates = VILC_ATOMIC_LOAD(&vilc_descriptorReuse_stats.recordedUpdates);
+	stats->reusedSets = VILC_ATOMIC_LOAD(&vilc_descriptorReuse_stats.reusedSets);
+	stats->driverSets = VILC_ATOMIC_LOAD(&vilc_descriptorReuse_stats.driverSets);
+	stats->privateSets = VILC_ATOMIC_LOAD(&vilc_descriptorReuse_stats.privateSets);
+	stats->retiredSets = VILC_ATOMIC_LOAD(&vilc_descriptorReuse_stats.retiredSets);
+	stats->liveDriverSets = VILC_ATOMIC_LOAD(&vilc_descriptorReuse_stats.liveDriverSets);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_descriptorReuse_vkCreateDevice(VkPhysicalDevice physicalDevice, const VkDeviceCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDevice* pDevice)
+{
+	VkResult result = vilc_descriptorReuse_next_vkCreateDevice(physicalDevice, pCreateInfo, pAllocator, pDevice);
+	if (result == VK_SUCCESS)
+	{
+		pthread_mutex_lock(&vilc_descriptorReuse_mutex);
+		vilc_descriptorReuse_device = *pDevice;
+		pthread_mutex_unlock(&vilc_descriptorReuse_mutex);
+	}
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_descriptorReuse_vkDestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator)
+{
+	VilcDescriptorReuseStats stats;
+	VilcDescriptorReuseLayout* layout;
+	uint32_t i, j;
+
+	pthread_mutex_lock(&vilc_descriptorReuse_mutex);
+	if (device && device == vilc_descriptorReuse_device)
+	{
+		/* everything goes with the device: the sets by their pools, and the driver sets by the pools of their layout,
+		 * which the sets and driver sets hold a reference on
+		 */
+		for (i = 0; i < vilc_descriptorReuse_pools.capacity; ++i)
+		{
+			VilcDescriptorReusePool* pool = (VilcDescriptorReusePool*)vilc_descriptorReuse_pools.values[i];
+			while (pool && pool->sets)
+				vilc_descriptorReuse_freeSet(device, pool->sets);
+			free(pool);
+		}
+		vilc_descriptorReuse_retire(device, 1);
+
+		/* layouts the application did not destroy are destroyed with the device, so none of their calls are made */
+		for (i = 0; i < vilc_descriptorReuse_layouts.capacity; ++i)
+			if ((layout = (VilcDescriptorReuseLayout*)vilc_descriptorReuse_layouts.values[i]) != NULL)
+			{
+				for (j = 0; j < layout->poolCount; ++j)
+					vilc_descriptorReuse_next_vkDestroyDescriptorPool(device, layout->pools[j], NULL);
+				free(layout->pools);
+				free(layout);
+			}
+		for (i = 0; i < vilc_descriptorReuse_templates.capacity; ++i)
+			free(vilc_descriptorReuse_templates.values[i]);
+
+		vilc_mapFree(&vilc_descriptorReuse_layouts);
+		vilc_mapFree(&vilc_descriptorReuse_pools);
+		vilc_mapFree(&vilc_descriptorReuse_sets);
+		vilc_mapFree(&vilc_descriptorReuse_entries);
+		vilc_mapFree(&vilc_descriptorReuse_templates);
+		vilc_descriptorReuse_device = VK_NULL_HANDLE;
+
+		vilcGetDescriptorReuseStats(&stats);
+		fprintf(stderr, "vilc: descriptor reuse: %llu sets allocated, %llu passed through, %llu updates recorded; %llu binds reused a driver set, %llu driver sets allocated, %llu of them private, %llu retired\n",
+		    (unsigned long long)stats.allocatedSets, (unsigned long long)stats.passedThroughSets, (unsigned long long)stats.recordedUpdates,
+		    (unsigned long long)stats.reusedSets, (unsigned long long)stats.driverSets, (unsigned long long)stats.privateSets,
+		    (unsigned long long)stats.retiredSets);
+	}
+	pthread_mutex_unlock(&vilc_descriptorReuse_mutex);
+
+	vilc_descriptorReuse_next_vkDestroyDevice(device, pAllocator);
+}
+
+/* Returns the layout to track sets of, or NULL when its sets pass through */
+static VilcDescriptorReuseLayout* vilc_descriptorReuse_createLayout(VkDescriptorSetLayout setLayout, const VkDescriptorSetLayoutCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator)
+{
+	uint32_t typeCounts[VILC_DESCRIPTOR_REUSE_TYPES] = { 0 };
+	VilcDescriptorReuseLayout* layout;
+	VilcDescriptorReuseBinding* binding;
+	size_t offset = 0;
+	uint32_t first = 0, i, j;
+
+	if (pCreateInfo->flags || pCreateInfo->pNext)
+		return NULL;
+	for (i = 0; i < pCreateInfo->bindingCount; ++i)
+		if (!vilc_descriptorReuse_descriptorSize(pCreateInfo->pBindings[i].descriptorType))
+			return NULL;
+
+	layout = (VilcDescriptorReuseLayout*)calloc(1, offsetof(VilcDescriptorReuseLayout, bindings) + (pCreateInfo->bindingCount + 1) * sizeof(VilcDescriptorReuseBinding));
+	if (!layout)
+		return NULL;
+	layout->layout = setLayout;
+	layout->references = 1;
+	layout->handles = 1;
+	layout->hasAllocator = pAllocator != NULL;
+	if (pAllocator)
+		layout->allocator = *pAllocator;
+
+	/* bindings in binding order, insertion sorted as layouts have few */
+	for (i = 0; i < pCreateInfo->bindingCount; ++i)
+	{
+		const VkDescriptorSetLayoutBinding* source = &pCreateInfo->pBindings[i];
+
+		if (!source->descriptorCount)
+			continue;
+		for (j = layout->bindingCount; j > 0 && layout->bindings[j - 1].binding > source->binding; --j)
+			layout->bindings[j] = layout->bindings[j - 1];
+		binding = &layout->bindings[j];
+		binding->binding = source->binding;
+		binding->type = source->descriptorType;
+		binding->count = source->descriptorCount;
+		binding->size = vilc_descriptorReuse_descriptorSize(source->descriptorType);
+		binding->immutableSamplers = source->pImmutableSamplers != NULL;
+		layout->bindingCount++;
+		typeCounts[source->descriptorType] += source->descriptorCount;
+	}
+	for (i = 0; i < layout->bindingCount; ++i)
+	{
+		layout->bindings[i].offset = (uint32_t)offset;
+		layout->bindings[i].first = first;
+		offset += (size_t)layout->bindings[i].count * layout->bindings[i].size;
+		first += layout->bindings[i].count;
+	}
+	layout->descriptorSize = offset;
+	layout->contentSize = offset + first;
+
+	for (i = 0; i < VILC_DESCRIPTOR_REUSE_TYPES; ++i)
+		if (typeCounts[i])
+		{
+			layout->poolSizes[layout->poolSizeCount].type = (VkDescriptorType)i;
+			layout->poolSizes[layout->poolSizeCount].descriptorCount = typeCounts[i] * VILC_DESCRIPTOR_REUSE_POOL_SETS;
+			layout->poolSizeCount++;
+		}
+	return layout;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_descriptorReuse_vkCreateDescriptorSetLayout(VkDevice device, const VkDescriptorSetLayoutCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDescriptorSetLayout* pSetLayout)
+{
+	VkResult result = vilc_descriptorReuse_next_vkCreateDescriptorSetLayout(device, pCreateInfo, pAllocator, pSetLayout);
+	VilcDescriptorReuseLayout* layout;
+
+	if (result != VK_SUCCESS)
+		return result;
+
+	pthread_mutex_lock(&vilc_descriptorReuse_mutex);
+	if (device == vilc_descriptorReuse_device)
+	{
+		/* layouts may be interned by VILC_LAYOUT_CACHE, so the same handle can come back */
+		layout = (VilcDescriptorReuseLayout*)vilc_mapFind(&vilc_descriptorReuse_layouts, VILC_OBJECT_KEY(*pSetLayout));
+		if (layout)
+		{
+			layout->handles++;
+			layout->references++;
+		}
+		else if ((layout = vilc_descriptorReuse_createLayout(*pSetLayout, pCreateInfo, pAllocator)) != NULL &&
+		    !vilc_mapInsert(&vilc_descriptorReuse_layouts, VILC_OBJECT_KEY(*pSetLayout), layout))
+			free(layout);
+	}
+	pthread_mutex_unlock(&vilc_descriptorReuse_mutex);
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_descriptorReuse_vkDestroyDescriptorSetLayout(VkDevice device, VkDescriptorSetLayout descriptorSetLayout, const VkAllocationCallbacks* pAllocator)
+{
+	VilcDescriptorReuseLayout* layout = NULL;
+
+	pthread_mutex_lock(&vilc_descriptorReuse_mutex);
+	if (descriptorSetLayout && device == vilc_descriptorReuse_device)
+		layout = (VilcDescriptorReuseLayout*)vilc_mapFind(&vilc_descriptorReuse_layouts, VILC_OBJECT_KEY(descriptorSetLayout));
+	if (layout)
+	{
+		/* sets of the layout may still be bound, which allocates driver sets with it */
+		if (!--layout->handles)
+			vilc_mapRemove(&vilc_descriptorReuse_layouts, VILC_OBJECT_KEY(descriptorSetLayout));
+		layout->pendingDestroys++;
+		vilc_descriptorReuse_releaseLayout(device, layout);
+	}
+	pthread_mutex_unlock(&vilc_descriptorReuse_mutex);
+
+	if (!layout)
+		vilc_descriptorReuse_next_vkDestroyDescriptorSetLayout(device, descriptorSetLayout, pAllocator);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_descriptorReuse_vkCreateDescriptorPool(VkDevice device, const VkDescriptorPoolCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDescriptorPool* pDescriptorPool)
+{
+	VkResult result = vilc_descriptorReuse_next_vkCreateDescriptorPool(device, pCreateInfo, pAllocator, pDescriptorPool);
+	VilcDescriptorReusePool* pool;
+
+	if (result != VK_SUCCESS)
+		return result;
+
+	pthread_mutex_lock(&vilc_descriptorReuse_mutex);
+	if (device == vilc_descriptorReuse_device && (pool = (VilcDescriptorReusePool*)calloc(1, sizeof(VilcDescriptorReusePool))) != NULL)
+	{
+		pool->pool = *pDescriptorPool;
+		pool->maxSets = pCreateInfo->maxSets;
+		/* an untracked pool only allocates driver sets */
+		if (!vilc_mapInsert(&vilc_descriptorReuse_pools, VILC_OBJECT_KEY(*pDescriptorPool), pool))
+			free(pool);
+	}
+	pthread_mutex_unlock(&vilc_descriptorReuse_mutex);
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_descriptorReuse_vkDestroyDescriptorPool(VkDevice device, VkDescriptorPool descriptorPool, const VkAllocationCallbacks* pAllocator)
+{
+	VilcDescriptorReusePool* pool = NULL;
+
+	pthread_mutex_lock(&vilc_descriptorReuse_mutex);
+	if (descriptorPool && device == vilc_descriptorReuse_device)
+		pool = (VilcDescriptorReusePool*)vilc_mapRemove(&vilc_descriptorReuse_pools, VILC_OBJECT_KEY(descriptorPool));
+	while (pool && pool->sets)
+		vilc_descriptorReuse_freeSet(device, pool->sets);
+	pthread_mutex_unlock(&vilc_descriptorReuse_mutex);
+	free(pool);
+
+	vilc_descriptorReuse_next_vkDestroyDescriptorPool(device, descriptorPool, pAllocator);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_descriptorReuse_vkResetDescriptorPool(VkDevice device, VkDescriptorPool descriptorPool, VkDescriptorPoolResetFlags flags)
+{
+	VilcDescriptorReusePool* pool = NULL;
+
+	pthread_mutex_lock(&vilc_descriptorReuse_mutex);
+	if (device == vilc_descriptorReuse_device)
+		pool = (VilcDescriptorReusePool*)vilc_mapFind(&vilc_descriptorReuse_pools, VILC_OBJECT_KEY(descriptorPool));
+	while (pool && pool->sets)
+		vilc_descriptorReuse_freeSet(device, pool->sets);
+	pthread_mutex_unlock(&vilc_descriptorReuse_mutex);
+
+	return vilc_descriptorReuse_next_vkResetDescriptorPool(device, descriptorPool, flags);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_descriptorReuse_vkAllocateDescriptorSets(VkDevice device, const VkDescriptorSetAllocateInfo* pAllocateInfo, VkDescriptorSet* pDescriptorSets)
+{
+	uint32_t count = pAllocateInfo->descriptorSetCount, i;
+	VilcDescriptorReusePool* pool = NULL;
+	VilcDescriptorReuseLayout* layout;
+	VilcDescriptorReuseSet* set;
+	VkResult result;
+
+	pthread_mutex_lock(&vilc_descriptorReuse_mutex);
+	if (device == vilc_descriptorReuse_device && !pAllocateInfo->pNext)
+		pool = (VilcDescriptorReusePool*)vilc_mapFind(&vilc_descriptorReuse_pools, VILC_OBJECT_KEY(pAllocateInfo->descriptorPool));
+	/* calls with a layout whose sets pass through pass through as a whole */
+	for (i = 0; pool && i < count; ++i)
+		if (!vilc_mapFind(&vilc_descriptorReuse_layouts, VILC_OBJECT_KEY(pAllocateInfo->pSetLayouts[i])))
+			pool = NULL;
+	if (!pool)
+	{
+		pthread_mutex_unlock(&vilc_descriptorReuse_mutex);
+		result = vilc_descriptorReuse_next_vkAllocateDescriptorSets(device, pAllocateInfo, pDescriptorSets);
+		if (result == VK_SUCCESS)
+			VILC_ATOMIC_ADD(&vilc_descriptorReuse_stats.passedThroughSets, count);
+		return result;
+	}
+	if (pool->setCount + count > pool->maxSets)
+	{
+		pthread_mutex_unlock(&vilc_descriptorReuse_mutex);
+		return VK_ERROR_OUT_OF_POOL_MEMORY;
+	}
+
+	for (i = 0; i < count; ++i)
+	{
+		layout = (VilcDescriptorReuseLayout*)vilc_mapFind(&vilc_descriptorReuse_layouts, VILC_OBJECT_KEY(pAllocateInfo->pSetLayouts[i]));
+		set = (VilcDescriptorReuseSet*)calloc(1, offsetof(VilcDescriptorReuseSet, content) + layout->contentSize + sizeof(uint64_t));
+		if (!set || !vilc_mapInsert(&vilc_descriptorReuse_sets, VILC_OBJECT_KEY(vilc_descriptorReuse_handle(set)), set))
+		{
+			free(set);
+			while (i--)
+				vilc_descriptorReuse_freeSet(device, (VilcDescriptorReuseSet*)vilc_mapFind(&vilc_descriptorReuse_sets, VILC_OBJECT_KEY(pDescriptorSets[i])));
+			for (i = 0; i < count; ++i)
+				pDescriptorSets[i] = VK_NULL_HANDLE;
+			pthread_mutex_unlock(&vilc_descriptorReuse_mutex);
+			return VK_ERROR_OUT_OF_HOST_MEMORY;
+		}
+		set->layout = layout;
+		set->pool = pool;
+		set->next = pool->sets;
+		if (pool->sets)
+			pool->sets->prev = set;
+		pool->sets = set;
+		pool->setCount++;
+		layout->references++;
+		pDescriptorSets[i] = vilc_descriptorReuse_handle(set);
+	}
+	pthread_mutex_unlock(&vilc_descriptorReuse_mutex);
+
+	VILC_ATOMIC_ADD(&vilc_descriptorReuse_stats.allocatedSets, count);
+	return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_descriptorReuse_vkFreeDescriptorSets(VkDevice device, VkDescriptorPool descriptorPool, uint32_t descriptorSetCount, const VkDescriptorSet* pDescriptorSets)
+{
+	VkDescriptorSet driverSets[VILC_DESCRIPTOR_REUSE_BATCH];
+	VilcDescriptorReuseSet* set;
+	uint32_t driverSetCount = 0, i;
+	VkResult result = VK_SUCCESS;
+
+	pthread_mutex_lock(&vilc_descriptorReuse_mutex);
+	if (device != vilc_descriptorReuse_device || !vilc_descriptorReuse_sets.count)
+	{
+		pthread_mutex_unlock(&vilc_descriptorReuse_mutex);
+		return vilc_descriptorReuse_next_vkFreeDescriptorSets(device, descriptorPool, descriptorSetCount, pDescriptorSets);
+	}
+	for (i = 0; i < descriptorSetCount; ++i)
+	{
+		if ((set = vilc_descriptorReuse_find(pDescriptorSets[i])) != NULL)
+			vilc_descriptorReuse_freeSet(device, set);
+		else if (pDescriptorSets[i])
+			driverSets[driverSetCount++] = pDescriptorSets[i];
+		if (driverSetCount == VILC_DESCRIPTOR_REUSE_BATCH || (driverSetCount && i + 1 == descriptorSetCount))
+		{
+			result = vilc_descriptorReuse_next_vkFreeDescriptorSets(device, descriptorPool, driverSetCount, driverSets);
+			driverSetCount = 0;
+		}
+	}
+	pthread_mutex_unlock(&vilc_descriptorReuse_mutex);
+	return result;
+}
+
+/* Makes the driver calls of vkUpdateDescriptorSets collected so far */
+static void vilc_descriptorReuse_flush(VkDevice device, VkWriteDescriptorSet* writes, uint32_t* writeCount, VkCopyDescriptorSet* copies, uint32_t* copyCount)
+{
+	if (*writeCount || *copyCount)
+		vilc_descriptorReuse_next_vkUpdateDescriptorSets(device, *writeCount, writes, *copyCount, copies);
+	*writeCount = 0;
+	*copyCount = 0;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_descriptorReuse_vkUpdateDescriptorSets(VkDevice device, uint32_t descriptorWriteCount, const VkWriteDescriptorSet* pDescriptorWrites, uint32_t descriptorCopyCount, const VkCopyDescriptorSet* pDescriptorCopies)
+{
+	VkWriteDescriptorSet writes[VILC_DESCRIPTOR_REUSE_BATCH];
+	VkCopyDescriptorSet copies[VILC_DESCRIPTOR_REUSE_BATCH];
+	uint32_t writeCount = 0, copyCount = 0, recorded = 0, i;
+	VilcDescriptorReuseSet* dst;
+	VilcDescriptorReuseSet* src;
+
+	pthread_mutex_lock(&vilc_descriptorReuse_mutex);
+	if (device != vilc_descriptorReuse_device || !vilc_descriptorReuse_sets.count)
+	{
+		pthread_mutex_unlock(&vilc_descriptorReuse_mutex);
+		vilc_descriptorReuse_next_vkUpdateDescriptorSets(device, descriptorWriteCount, pDescriptorWrites, descriptorCopyCount, pDescriptorCopies);
+		return;
+	}
+
+	/* writes are made before copies, so the writes that reach the driver are made in batches before any copy */
+	for (i = 0; i < descriptorWriteCount; ++i)
+	{
+		const VkWriteDescriptorSet* write = &pDescriptorWrites[i];
+
+		dst = vilc_descriptorReuse_find(write->dstSet);
+		if (dst && !dst->isPrivate && !dst->entry && !write->pNext && vilc_descriptorReuse_descriptorSize(write->descriptorType))
+		{
+			if (vilc_descriptorReuse_isTexelBuffer(write->descriptorType))
+				vilc_descriptorReuse_store(dst->layout, dst->content, write->dstBinding, write->dstArrayElement, write->descriptorCount, write->pTexelBufferView, sizeof(VkBufferView));
+			else if (vilc_descriptorReuse_isBuffer(write->descriptorType))
+				vilc_descriptorReuse_store(dst->layout, dst->content, write->dstBinding, write->dstArrayElement, write->descriptorCount, write->pBufferInfo, sizeof(VkDescriptorBufferInfo));
+			else
+				vilc_descriptorReuse_store(dst->layout, dst->content, write->dstBinding, write->dstArrayElement, write->descriptorCount, write->pImageInfo, sizeof(VkDescriptorImageInfo));
+			recorded++;
+			continue;
+		}
+		if (dst && !vilc_descriptorReuse_privatize(device, dst))
+			continue;
+
+		writes[writeCount] = *write;
+		if (dst)
+			writes[writeCount].dstSet = dst->entry->set;
+		if (++writeCount == VILC_DESCRIPTOR_REUSE_BATCH)
+			vilc_descriptorReuse_flush(device, writes, &writeCount, copies, &copyCount);
+	}
+
+	for (i = 0; i < descriptorCopyCount; ++i)
+	{
+		const VkCopyDescriptorSet* copy = &pDescriptorCopies[i];
+
+		dst = vilc_descriptorReuse_find(copy->dstSet);
+		src = vilc_descriptorReuse_find(copy->srcSet);
+		if (dst && !dst->isPrivate && !dst->entry && src && !src->isPrivate)
+		{
+			vilc_descriptorReuse_copy(copy, src, dst);
+			recorded++;
+			continue;
+		}
+		/* copies from driver sets have to be made by the driver */
+		if (dst && !vilc_descriptorReuse_privatize(device, dst))
+			continue;
+		if (src && !vilc_descriptorReuse_resolve(device, src))
+			continue;
+
+		copies[copyCount] = *copy;
+		if (dst)
+			copies[copyCount].dstSet = dst->entry->set;
+		if (src)
+			copies[copyCount].srcSet = src->entry->set;
+		if (++copyCount == VILC_DESCRIPTOR_REUSE_BATCH)
+			vilc_descriptorReuse_flush(device, writes, &writeCount, copies, &copyCount);
+	}
+	vilc_descriptorReuse_flush(device, writes, &writeCount, copies, &copyCount);
+	pthread_mutex_unlock(&vilc_descriptorReuse_mutex);
+
+	if (recorded)
+		VILC_ATOMIC_ADD(&vilc_descriptorReuse_stats.recordedUpdates, recorded);
+}
+
+/* Replaces the sets of the application with the driver sets they are bound as; returns the array to bind, which is
+ * sets, or pDescriptorSets when none of them is a set of the application
+ */
+static const VkDescriptorSet* vilc_descriptorReuse_translate(uint32_t descriptorSetCount, const VkDescriptorSet* pDescriptorSets, VkDescriptorSet* sets)
+{
+	const VkDescriptorSet* result = pDescriptorSets;
+	VilcDescriptorReuseSet* set;
+	uint32_t i;
+
+	pthread_mutex_lock(&vilc_descriptorReuse_mutex);
+	for (i = 0; vilc_descriptorReuse_sets.count && i < descriptorSetCount; ++i)
+	{
+		set = vilc_descriptorReuse_find(pDescriptorSets[i]);
+		if (set && result == pDescriptorSets)
+		{
+			memcpy(sets, pDescriptorSets, descriptorSetCount * sizeof(VkDescriptorSet));
+			result = sets;
+		}
+		if (set)
+			sets[i] = vilc_descriptorReuse_resolve(vilc_descriptorReuse_device, set);
+	}
+	pthread_mutex_unlock(&vilc_descriptorReuse_mutex);
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_descriptorReuse_vkCmdBindDescriptorSets(VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout, uint32_t firstSet, uint32_t descriptorSetCount, const VkDescriptorSet* pDescriptorSets, uint32_t dynamicOffsetCount, const uint32_t* pDynamicOffsets)
+{
+	VkDescriptorSet storage[VILC_DESCRIPTOR_REUSE_BATCH];
+	VkDescriptorSet* sets = descriptorSetCount > VILC_DESCRIPTOR_REUSE_BATCH ? (VkDescriptorSet*)malloc(descriptorSetCount * sizeof(VkDescriptorSet)) : storage;
+
+	if (!sets)
+		return;
+	vilc_descriptorReuse_next_vkCmdBindDescriptorSets(commandBuffer, pipelineBindPoint, layout, firstSet, descriptorSetCount,
+	    vilc_descriptorReuse_translate(descriptorSetCount, pDescriptorSets, sets), dynamicOffsetCount, pDynamicOffsets);
+	if (sets != storage)
+		free(sets);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_descriptorReuse_vkDestroyBuffer(VkDevice device, VkBuffer buffer, const VkAllocationCallbacks* pAllocator)
+{
+	vilc_descriptorReuse_forget(device, VK_OBJECT_TYPE_BUFFER, VILC_OBJECT_KEY(buffer));
+	vilc_descriptorReuse_next_vkDestroyBuffer(device, buffer, pAllocator);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_descriptorReuse_vkDestroyBufferView(VkDevice device, VkBufferView bufferView, const VkAllocationCallbacks* pAllocator)
+{
+	vilc_descriptorReuse_forget(device, VK_OBJECT_TYPE_BUFFER_VIEW, VILC_OBJECT_KEY(bufferView));
+	vilc_descriptorReuse_next_vkDestroyBufferView(device, bufferView, pAllocator);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_descriptorReuse_vkDestroyImageView(VkDevice device, VkImageView imageView, const VkAllocationCallbacks* pAllocator)
+{
+	vilc_descriptorReuse_forget(device, VK_OBJECT_TYPE_IMAGE_VIEW, VILC_OBJECT_KEY(imageView));
+	vilc_descriptorReuse_next_vkDestroyImageView(device, imageView, pAllocator);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_descriptorReuse_vkDestroySampler(VkDevice device, VkSampler sampler, const VkAllocationCallbacks* pAllocator)
+{
+	vilc_descriptorReuse_forget(device, VK_OBJECT_TYPE_SAMPLER, VILC_OBJECT_KEY(sampler));
+	vilc_descriptorReuse_next_vkDestroySampler(device, sampler, pAllocator);
+}
+
+#if defined(VK_VERSION_1_4) || defined(VK_KHR_maintenance6)
+/* Translates the sets of vkCmdBindDescriptorSets2(KHR); returns 0 when out of memory */
+static int vilc_descriptorReuse_translateInfo(const VkBindDescriptorSetsInfo* pBindDescriptorSetsInfo, VkBindDescriptorSetsInfo* info, VkDescriptorSet* storage, VkDescriptorSet** sets)
+{
+	uint32_t count = pBindDescriptorSetsInfo->descriptorSetCount;
+
+	*sets = count > VILC_DESCRIPTOR_REUSE_BATCH ? (VkDescriptorSet*)malloc(count * sizeof(VkDescriptorSet)) : storage;
+	if (!*sets)
+		return 0;
+	*info = *pBindDescriptorSetsInfo;
+	info->pDescriptorSets = vilc_descriptorReuse_translate(count, pBindDescriptorSetsInfo->pDescriptorSets, *sets);
+	return 1;
+}
+#endif
+
+#if defined(VK_VERSION_1_4)
+static VKAPI_ATTR void VKAPI_CALL vilc_descriptorReuse_vkCmdBindDescriptorSets2(VkCommandBuffer commandBuffer, const VkBindDescriptorSetsInfo* pBindDescriptorSetsInfo)
+{
+	VkDescriptorSet storage[VILC_DESCRIPTOR_REUSE_BATCH];
+	VkBindDescriptorSetsInfo info;
+	VkDescriptorSet* sets;
+
+	if (!vilc_descriptorReuse_translateInfo(pBindDescriptorSetsInfo, &info, storage, &sets))
+		return;
+	vilc_descriptorReuse_next_vkCmdBindDescriptorSets2(commandBuffer, &info);
+	if (sets != storage)
+		free(sets);
+}
+#endif
+
+#if defined(VK_KHR_maintenance6)
+static VKAPI_ATTR void VKAPI_CALL vilc_descriptorReuse_vkCmdBindDescriptorSets2KHR(VkCommandBuffer commandBuffer, const VkBindDescriptorSetsInfo* pBindDescriptorSetsInfo)
+{
+	VkDescriptorSet storage[VILC_DESCRIPTOR_REUSE_BATCH];
+	VkBindDescriptorSetsInfo info;
+	VkDescriptorSet* sets;
+
+	if (!vilc_descriptorReuse_translateInfo(pBindDescriptorSetsInfo, &info, storage, &sets))
+		return;
+	vilc_descriptorReuse_next_vkCmdBindDescriptorSets2KHR(commandBuffer, &info);
+	if (sets != storage)
+		free(sets);
+}
+#endif
+
+#if defined(VK_VERSION_1_1) || defined(VK_KHR_descriptor_update_template)
+/* Keeps the entries of templates that update descriptor sets; caller locks */
+static void vilc_descriptorReuse_createTemplate(VkDescriptorUpdateTemplate descriptorUpdateTemplate, const VkDescriptorUpdateTemplateCreateInfo* pCreateInfo)
+{
+	VilcDescriptorReuseTemplate* updateTemplate;
+	uint32_t i;
+
+	if (pCreateInfo->templateType != VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET)
+		return;
+	updateTemplate = (VilcDescriptorReuseTemplate*)malloc(offsetof(VilcDescriptorReuseTemplate, entries) + (pCreateInfo->descriptorUpdateEntryCount + 1) * sizeof(VkDescriptorUpdateTemplateEntry));
+	if (!updateTemplate)
+		return;
+
+	updateTemplate->recordable = 1;
+	updateTemplate->entryCount = pCreateInfo->descriptorUpdateEntryCount;
+	for (i = 0; i < pCreateInfo->descriptorUpdateEntryCount; ++i)
+	{
+		updateTemplate->entries[i] = pCreateInfo->pDescriptorUpdateEntries[i];
+		if (!vilc_descriptorReuse_descriptorSize(updateTemplate->entries[i].descriptorType))
+			updateTemplate->recordable = 0;
+	}
+	if (!vilc_mapInsert(&vilc_descriptorReuse_templates, VILC_OBJECT_KEY(descriptorUpdateTemplate), updateTemplate))
+		free(updateTemplate);
+}
+
+/* Records the update into the content of the set, or returns the driver set to make it on; caller locks */
+static VkDescriptorSet vilc_descriptorReuse_updateWithTemplate(VkDevice device, VilcDescriptorReuseSet* set, VkDescriptorUpdateTemplate descriptorUpdateTemplate, const void* pData)
+{
+	VilcDescriptorReuseTemplate* updateTemplate = (VilcDescriptorReuseTemplate*)vilc_mapFind(&vilc_descriptorReuse_templates, VILC_OBJECT_KEY(descriptorUpdateTemplate));
+	uint32_t i;
+
+	if (!set->isPrivate && !set->entry && updateTemplate && updateTemplate->recordable)
+	{
+		for (i = 0; i < updateTemplate->entryCount; ++i)
+		{
+			const VkDescriptorUpdateTemplateEntry* entry = &updateTemplate->entries[i];
+			vilc_descriptorReuse_store(set->layout, set->content, entry->dstBinding, entry->dstArrayElement, entry->descriptorCount, (const char*)pData + entry->offset, entry->stride);
+		}
+		VILC_ATOMIC_ADD(&vilc_descriptorReuse_stats.recordedUpdates, 1);
+		return VK_NULL_HANDLE;
+	}
+	return vilc_descriptorReuse_privatize(device, set) ? set->entry->set : VK_NULL_HANDLE;
+}
+#endif
+
+#if defined(VK_VERSION_1_1)
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_descriptorReuse_vkCreateDescriptorUpdateTemplate(VkDevice device, const VkDescriptorUpdateTemplateCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDescriptorUpdateTemplate* pDescriptorUpdateTemplate)
+{
+	VkResult result = vilc_descriptorReuse_next_vkCreateDescriptorUpdateTemplate(device, pCreateInfo, pAllocator, pDescriptorUpdateTemplate);
+	if (result == VK_SUCCESS && device == vilc_descriptorReuse_device)
+	{
+		pthread_mutex_lock(&vilc_descriptorReuse_mutex);
+		vilc_descriptorReuse_createTemplate(*pDescriptorUpdateTemplate, pCreateInfo);
+		pthread_mutex_unlock(&vilc_descriptorReuse_mutex);
+	}
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_descriptorReuse_vkDestroyDescriptorUpdateTemplate(VkDevice device, VkDescriptorUpdateTemplate descriptorUpdateTemplate, const VkAllocationCallbacks* pAllocator)
+{
+	if (descriptorUpdateTemplate)
+	{
+		pthread_mutex_lock(&vilc_descriptorReuse_mutex);
+		free(vilc_mapRemove(&vilc_descriptorReuse_templates, VILC_OBJECT_KEY(descriptorUpdateTemplate)));
+		pthread_mutex_unlock(&vilc_descriptorReuse_mutex);
+	}
+	vilc_descriptorReuse_next_vkDestroyDescriptorUpdateTemplate(device, descriptorUpdateTemplate, pAllocator);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_descriptorReuse_vkUpdateDescriptorSetWithTemplate(VkDevice device, VkDescriptorSet descriptorSet, VkDescriptorUpdateTemplate descriptorUpdateTemplate, const void* pData)
+{
+	VilcDescriptorReuseSet* set;
+
+	pthread_mutex_lock(&vilc_descriptorReuse_mutex);
+	set = device == vilc_descriptorReuse_device ? vilc_descriptorReuse_find(descriptorSet) : NULL;
+	if (!set || (descriptorSet = vilc_descriptorReuse_updateWithTemplate(device, set, descriptorUpdateTemplate, pData)) != VK_NULL_HANDLE)
+		vilc_descriptorReuse_next_vkUpdateDescriptorSetWithTemplate(device, descriptorSet, descriptorUpdateTemplate, pData);
+	pthread_mutex_unlock(&vilc_descriptorReuse_mutex);
+}
+#endif
+
+#if defined(VK_KHR_descriptor_update_template)
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_descriptorReuse_vkCreateDescriptorUpdateTemplateKHR(VkDevice device, const VkDescriptorUpdateTemplateCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDescriptorUpdateTemplate* pDescriptorUpdateTemplate)
+{
+	VkResult result = vilc_descriptorReuse_next_vkCreateDescriptorUpdateTemplateKHR(device, pCreateInfo, pAllocator, pDescriptorUpdateTemplate);
+	if (result == VK_SUCCESS && device == vilc_descriptorReuse_device)
+	{
+		pthread_mutex_lock(&vilc_descriptorReuse_mutex);
+		vilc_descriptorReuse_createTemplate(*pDescriptorUpdateTemplate, pCreateInfo);
+		pthread_mutex_unlock(&vilc_descriptorReuse_mutex);
+	}
+	return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_descriptorReuse_vkDestroyDescriptorUpdateTemplateKHR(VkDevice device, VkDescriptorUpdateTemplate descriptorUpdateTemplate, const VkAllocationCallbacks* pAllocator)
+{
+	if (descriptorUpdateTemplate)
+	{
+		pthread_mutex_lock(&vilc_descriptorReuse_mutex);
+		free(vilc_mapRemove(&vilc_descriptorReuse_templates, VILC_OBJECT_KEY(descriptorUpdateTemplate)));
+		pthread_mutex_unlock(&vilc_descriptorReuse_mutex);
+	}
+	vilc_descriptorReuse_next_vkDestroyDescriptorUpdateTemplateKHR(device, descriptorUpdateTemplate, pAllocator);
+}
+
+static VKAPI_ATTR void VKAPI_CALL vilc_descriptorReuse_vkUpdateDescriptorSetWithTemplateKHR(VkDevice device, VkDescriptorSet descriptorSet, VkDescriptorUpdateTemplate descriptorUpdateTemplate, const void* pData)
+{
+	VilcDescriptorReuseSet* set;
+
+	pthread_mutex_lock(&vilc_descriptorReuse_mutex);
+	set = device == vilc_descriptorReuse_device ? vilc_descriptorReuse_find(descriptorSet) : NULL;
+	if (!set || (descriptorSet = vilc_descriptorReuse_updateWithTemplate(device, set, descriptorUpdateTemplate, pData)) != VK_NULL_HANDLE)
+		vilc_descriptorReuse_next_vkUpdateDescriptorSetWithTemplateKHR(device, descriptorSet, descriptorUpdateTemplate, pData);
+	pthread_mutex_unlock(&vilc_descriptorReuse_mutex);
+}
+#endif
+
+#if defined(VK_KHR_swapchain)
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_descriptorReuse_vkQueuePresentKHR(VkQueue queue, const VkPresentInfoKHR* pPresentInfo)
+{
+	pthread_mutex_lock(&vilc_descriptorReuse_mutex);
+	vilc_descriptorReuse_frame++;
+	if (vilc_descriptorReuse_device)
+		vilc_descriptorReuse_retire(vilc_descriptorReuse_device, 0);
+	pthread_mutex_unlock(&vilc_descriptorReuse_mutex);
+
+	return vilc_descriptorReuse_next_vkQueuePresentKHR(queue, pPresentInfo);
+}
+#endif
+
+#if defined(VK_EXT_debug_utils)
+/* sets of the application have no driver object to name */
+static int vilc_descriptorReuse_isSet(VkDevice device, VkObjectType objectType, uint64_t objectHandle)
+{
+	int found;
+
+	if (objectType != VK_OBJECT_TYPE_DESCRIPTOR_SET)
+		return 0;
+	pthread_mutex_lock(&vilc_descriptorReuse_mutex);
+	found = device == vilc_descriptorReuse_device && vilc_descriptorReuse_find((VkDescriptorSet)(uintptr_t)objectHandle) != NULL;
+	pthread_mutex_unlock(&vilc_descriptorReuse_mutex);
+	return found;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_descriptorReuse_vkSetDebugUtilsObjectNameEXT(VkDevice device, const VkDebugUtilsObjectNameInfoEXT* pNameInfo)
+{
+	if (vilc_descriptorReuse_isSet(device, pNameInfo->objectType, pNameInfo->objectHandle))
+		return VK_SUCCESS;
+	return vilc_descriptorReuse_next_vkSetDebugUtilsObjectNameEXT(device, pNameInfo);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL vilc_descriptorReuse_vkSetDebugUtilsObjectTagEXT(VkDevice device, const VkDebugUtilsObjectTagInfoEXT* pTagInfo)
+{
+	if (vilc_descriptorReuse_isSet(device, pTagInfo->objectType, pTagInfo->objectHandle))
+		return VK_SUCCESS;
+	return vilc_descriptorReuse_next_vkSetDebugUtilsObjectTagEXT(device, pTagInfo);
+}
+#endif /* defined(VK_EXT_debug_utils) */
+
+static void vilc_descriptorReuse_installInstance(void)
+{
+	VILC_LAYER_HOOK(vilc_descriptorReuse, vkCreateDevice)
+#if defined(VK_EXT_debug_utils)
+	VILC_LAYER_HOOK(vilc_descriptorReuse, vkSetDebugUtilsObjectNameEXT)
+	VILC_LAYER_HOOK(vilc_descriptorReuse, vkSetDebugUtilsObjectTagEXT)
+#endif
+}
+
+static void vilc_descriptorReuse_installDevice(void)
+{
+	const char* frames = getenv("VILC_DESCRIPTOR_REUSE_FRAMES");
+
+	vilc_descriptorReuse_frames = frames ? strtoull(frames, NULL, 10) : VILC_DESCRIPTOR_REUSE_FRAMES;
+
+	VILC_LAYER_HOOK(vilc_descriptorReuse, vkDestroyDevice)
+	VILC_LAYER_HOOK(vilc_descriptorReuse, vkCreateDescriptorSetLayout)
+	VILC_LAYER_HOOK(vilc_descriptorReuse, vkDestroyDescriptorSetLayout)
+	VILC_LAYER_HOOK(vilc_descriptorReuse, vkCreateDescriptorPool)
+	VILC_LAYER_HOOK(vilc_descriptorReuse, vkDestroyDescriptorPool)
+	VILC_LAYER_HOOK(vilc_descriptorReuse, vkResetDescriptorPool)
+	VILC_LAYER_HOOK(vilc_descriptorReuse, vkAllocateDescriptorSets)
+	VILC_LAYER_HOOK(vilc_descriptorReuse, vkFreeDescriptorSets)
+	VILC_LAYER_HOOK(vilc_descriptorReuse, vkUpdateDescriptorSets)
+	VILC_LAYER_HOOK(vilc_descriptorReuse, vkCmdBindDescriptorSets)
+	VILC_LAYER_HOOK(vilc_descriptorReuse, vkDestroyBuffer)
+	VILC_LAYER_HOOK(vilc_descriptorReuse, vkDestroyBufferView)
+	VILC_LAYER_HOOK(vilc_descriptorReuse, vkDestroyImageView)
+	VILC_LAYER_HOOK(vilc_descriptorReuse, vkDestroySampler)
+#if defined(VK_VERSION_1_1)
+	VILC_LAYER_HOOK(vilc_descriptorReuse, vkCreateDescriptorUpdateTemplate)
+	VILC_LAYER_HOOK(vilc_descriptorReuse, vkDestroyDescriptorUpdateTemplate)
+	VILC_LAYER_HOOK(vilc_descriptorReuse, vkUpdateDescriptorSetWithTemplate)
+#endif
+#if defined(VK_VERSION_1_4)
+	VILC_LAYER_HOOK(vilc_descriptorReuse, vkCmdBindDescriptorSets2)
+#endif
+#if defined(VK_KHR_descriptor_update_template)
+	VILC_LAYER_HOOK(vilc_descriptorReuse, vkCreateDescriptorUpdateTemplateKHR)
+	VILC_LAYER_HOOK(vilc_descriptorReuse, vkDestroyDescriptorUpdateTemplateKHR)
+	VILC_LAYER_HOOK(vilc_descriptorReuse, vkUpdateDescriptorSetWithTemplateKHR)
+#endif
+#if defined(VK_KHR_maintenance6)
+	VILC_LAYER_HOOK(vilc_descriptorReuse, vkCmdBindDescriptorSets2KHR)
+#endif
+#if defined(VK_KHR_swapchain)
+	VILC_LAYER_HOOK(vilc_descriptorReuse, vkQueuePresentKHR)
+#endif
+}
+#endif /* VILC_DESCRIPTOR_REUSE */
+
+#if defined(VOLK_IN_LOADERS_CLOTH)
+/* Called after instance-level vilc_vk* pointers are loaded from the driver */
+static void vilc_installInstanceLayers(void)
+{
+#if defined(VILC_DRIVER_TABLES)
+	volkGenLoadInstanceTable(&vilc_instance, loadedInstance, vkGetInstanceProcAddrStub);
+#endif
+#if defined(VILC_GPU_TIMESTAMPS)
+	vilc_gpuTimestamps_installInstance();
+#endif
+#if defined(VILC_HOST_MEMORY_STATS)
+	vilc_hostMemory_install();
+#endif
+#if defined(VILC_MEMORY_BUDGET)
+	vilc_memoryBudget_installInstance();
+#endif
+#if defined(VILC_SHADER_MODULE_CACHE)
+	vilc_shaderModuleCache_installInstance();
+#endif
+#if defined(VILC_SAMPLER_CACHE)
+	vilc_samplerCache_installInstance();
+#endif
+#if defined(VILC_LAYOUT_CACHE)
+	vilc_layoutCache_installInstance();
+#endif
+#if defined(VILC_PIPELINE_CACHE)
+	vilc_pipelineCache_installInstance();
+#endif
+#if defined(VILC_BARRIER_COALESCING)
+	vilc_barrierCoalescing_installInstance();
+#endif
+#if defined(VILC_DRAW_BATCHING)
+	vilc_drawBatching_installInstance();
+#endif
+#if defined(VILC_DEFERRED_COMMANDS)
+	vilc_deferredCommands_installInstance();
+#endif
+#if defined(VILC_MAPPING_CACHE)
+	vilc_mappingCache_installInstance();
+#endif
+#if defined(VILC_MEMORY_SUBALLOCATOR)
+	vilc_memorySuballocator_installInstance();
+#endif
+#if defined(VILC_DESCRIPTOR_REUSE)
+	vilc_descriptorReuse_installInstance();
+#endif
+#if defined(VILC_SUBMIT_MERGING)
+	vilc_submitMerging_installInstance();
+#endif
+#if defined(VILC_SUBMIT_THREAD)
+	vilc_submitThread_installInstance();
+#endif
+}
+
+/* Called every time device-level vilc_vk* pointers are (re)loaded from the driver */
+static void vilc_installDeviceLayers(void)
+{
+#if defined(VILC_DRIVER_TABLES)
+	if (loadedDevice)
+		volkGenLoadDeviceTable(&vilc_device, loadedDevice, vkGetDeviceProcAddrStub);
+	else
+		volkGenLoadDeviceTable(&vilc_device, loadedInstance, vkGetInstanceProcAddrStub);
+#endif
+/* installed first, under the modes that watch the calls of the application, so VILC_PERF_LINT still sees every map,
+ * and under the modes that hold queue calls, so held flushes are made right before the submits reach the driver
+ */
+#if defined(VILC_MAPPING_CACHE)
+	vilc_mappingCache_installDevice();
+#endif
+/* over the mapping cache, which then only sees whole blocks, and under every other mode, so they all see the
+ * handles the application got
+ */
+#if defined(VILC_MEMORY_SUBALLOCATOR)
+	vilc_memorySuballocator_installDevice();
+#endif
+#if defined(VILC_CHARACTERIZE)
+	vilc_characterize_install();
+#endif
+#if defined(VILC_PERF_LINT)
+	vilc_perfLint_install();
+#endif
+#if defined(VILC_GPU_TIMESTAMPS)
+	vilc_gpuTimestamps_installDevice();
+#endif
+#if defined(VILC_MEMORY_BUDGET)
+	vilc_memoryBudget_installDevice();
+#endif
+#if defined(VILC_SHADER_MODULE_CACHE)
+	vilc_shaderModuleCache_installDevice();
+#endif
+#if defined(VILC_SAMPLER_CACHE)
+	vilc_samplerCache_installDevice();
+#endif
+#if defined(VILC_LAYOUT_CACHE)
+	vilc_layoutCache_installDevice();
+#endif
+/* installed over the layout cache, so freelists are dropped for every layout the application destroys */
+#if defined(VILC_DESCRIPTOR_ALLOCATOR)
+	vilc_descriptorAllocator_install();
+#endif
+/* over the descriptor allocator, which then only sees the driver sets, and under the modes that record commands, so
+ * binds are translated when they reach the driver
+ */
+#if defined(VILC_DESCRIPTOR_REUSE)
+	vilc_descriptorReuse_installDevice();
+#endif
+/* installed before the pipeline cache, so the cache substituted there is seeded from and merged into like any other */
+#if defined(VILC_PARALLEL_PIPELINES)
+	vilc_parallelPipelines_install();
+#endif
+#if defined(VILC_PIPELINE_CACHE)
+	vilc_pipelineCache_installDevice();
+#endif
+#if defined(VILC_DEFERRED_HOST_OPERATIONS)
+	vilc_deferredOps_install();
+#endif
+/* installed over the modes that record commands of their own, so pending barriers are flushed before those */
+#if defined(VILC_BARRIER_COALESCING)
+	vilc_barrierCoalescing_installDevice();
+#endif
+/* installed over barrier coalescing, so the barriers dropped here are not merged into others first */
+#if defined(VILC_IMAGE_LAYOUT_TRACKING)
+	vilc_imageLayoutTracking_install();
+#endif
+/* installed under the state filter, so the redundant state calls dropped there do not end a run of draws */
+#if defined(VILC_DRAW_BATCHING)
+	vilc_drawBatching_installDevice();
+#endif
+/* installed over the other modes that act on commands, so they only see the calls that reach the driver */
+#if defined(VILC_STATE_FILTER)
+	vilc_stateFilter_install();
+#endif
+/* installed over the modes that act on queue calls, so they see the merged calls and the calls they make on the queues
+ * themselves follow the held ones
+ */
+#if defined(VILC_SUBMIT_MERGING)
+	vilc_submitMerging_installDevice();
+#endif
+/* installed over the modes that act on queue calls, so they run on the submission threads along with the driver calls
+ * they make on the queues themselves
+ */
+#if defined(VILC_SUBMIT_THREAD)
+	vilc_submitThread_installDevice();
+#endif
+/* installed last, so the other modes see the recorded commands as they are replayed, after everything recorded before */
+#if defined(VILC_DEFERRED_COMMANDS)
+	vilc_deferredCommands_installDevice();
+#endif
+}
+#endif
+
 #if !defined(VOLK_IN_LOADERS_CLOTH)
 static PFN_vkVoidFunction vkGetInstanceProcAddrStub(void* context, const char* name)
 {
@@ -5200,7 +20240,7 @@ VkResult vkAllocateDescriptorSets(VkDevice device, const VkDescriptorSetAllocate
 }
 VkResult vkAllocateMemory(VkDevice device, const VkMemoryAllocateInfo* pAllocateInfo, const VkAllocationCallbacks* pAllocator, VkDeviceMemory* pMemory) {
 	vilc_initOnce();
-	return vilc_vkAllocateMemory(device, pAllocateInfo, pAllocator, pMemory);
+	return vilc_vkAllocateMemory(device, pAllocateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_DEVICE_MEMORY), pMemory);
 }
 VkResult vkBeginCommandBuffer(VkCommandBuffer commandBuffer, const VkCommandBufferBeginInfo* pBeginInfo) {
 	vilc_initOnce();
@@ -5392,178 +20432,181 @@ void vkCmdWriteTimestamp(VkCommandBuffer commandBuffer, VkPipelineStageFlagBits
 }
 VkResult vkCreateBuffer(VkDevice device, const VkBufferCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkBuffer* pBuffer) {
 	vilc_initOnce();
-	return vilc_vkCreateBuffer(device, pCreateInfo, pAllocator, pBuffer);
+	return vilc_vkCreateBuffer(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_BUFFER), pBuffer);
 }
 VkResult vkCreateBufferView(VkDevice device, const VkBufferViewCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkBufferView* pView) {
 	vilc_initOnce();
-	return vilc_vkCreateBufferView(device, pCreateInfo, pAllocator, pView);
+	return vilc_vkCreateBufferView(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_BUFFER_VIEW), pView);
 }
 VkResult vkCreateCommandPool(VkDevice device, const VkCommandPoolCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkCommandPool* pCommandPool) {
 	vilc_initOnce();
-	return vilc_vkCreateCommandPool(device, pCreateInfo, pAllocator, pCommandPool);
+	return vilc_vkCreateCommandPool(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_COMMAND_POOL), pCommandPool);
 }
 VkResult vkCreateComputePipelines(VkDevice device, VkPipelineCache pipelineCache, uint32_t createInfoCount, const VkComputePipelineCreateInfo* pCreateInfos, const VkAllocationCallbacks* pAllocator, VkPipeline* pPipelines) {
 	vilc_initOnce();
-	return vilc_vkCreateComputePipelines(device, pipelineCache, createInfoCount, pCreateInfos, pAllocator, pPipelines);
+	return vilc_vkCreateComputePipelines(device, pipelineCache, createInfoCount, pCreateInfos, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_PIPELINE), pPipelines);
 }
 VkResult vkCreateDescriptorPool(VkDevice device, const VkDescriptorPoolCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDescriptorPool* pDescriptorPool) {
 	vilc_initOnce();
-	return vilc_vkCreateDescriptorPool(device, pCreateInfo, pAllocator, pDescriptorPool);
+	return vilc_vkCreateDescriptorPool(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_DESCRIPTOR_POOL), pDescriptorPool);
 }
 VkResult vkCreateDescriptorSetLayout(VkDevice device, const VkDescriptorSetLayoutCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDescriptorSetLayout* pSetLayout) {
 	vilc_initOnce();
-	return vilc_vkCreateDescriptorSetLayout(device, pCreateInfo, pAllocator, pSetLayout);
+	return vilc_vkCreateDescriptorSetLayout(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT), pSetLayout);
 }
 VkResult vkCreateDevice(VkPhysicalDevice physicalDevice, const VkDeviceCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDevice* pDevice) {
 	vilc_initOnce();
-	VkResult result = vilc_vkCreateDevice(physicalDevice, pCreateInfo, pAllocator, pDevice);
+	VkResult result = vilc_vkCreateDevice(physicalDevice, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_DEVICE), pDevice);
 	if(result == VK_SUCCESS) {
 		loadedDevice = *pDevice;
 		volkGenLoadDevice(loadedDevice, vkGetDeviceProcAddrStub);
+		vilc_installDeviceLayers();
 	}
 	return result;
 }
 VkResult vkCreateEvent(VkDevice device, const VkEventCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkEvent* pEvent) {
 	vilc_initOnce();
-	return vilc_vkCreateEvent(device, pCreateInfo, pAllocator, pEvent);
+	return vilc_vkCreateEvent(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_EVENT), pEvent);
 }
 VkResult vkCreateFence(VkDevice device, const VkFenceCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkFence* pFence) {
 	vilc_initOnce();
-	return vilc_vkCreateFence(device, pCreateInfo, pAllocator, pFence);
+	return vilc_vkCreateFence(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_FENCE), pFence);
 }
 VkResult vkCreateFramebuffer(VkDevice device, const VkFramebufferCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkFramebuffer* pFramebuffer) {
 	vilc_initOnce();
-	return vilc_vkCreateFramebuffer(device, pCreateInfo, pAllocator, pFramebuffer);
+	return vilc_vkCreateFramebuffer(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_FRAMEBUFFER), pFramebuffer);
 }
 VkResult vkCreateGraphicsPipelines(VkDevice device, VkPipelineCache pipelineCache, uint32_t createInfoCount, const VkGraphicsPipelineCreateInfo* pCreateInfos, const VkAllocationCallbacks* pAllocator, VkPipeline* pPipelines) {
 	vilc_initOnce();
-	return vilc_vkCreateGraphicsPipelines(device, pipelineCache, createInfoCount, pCreateInfos, pAllocator, pPipelines);
+	return vilc_vkCreateGraphicsPipelines(device, pipelineCache, createInfoCount, pCreateInfos, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_PIPELINE), pPipelines);
 }
 VkResult vkCreateImage(VkDevice device, const VkImageCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkImage* pImage) {
 	vilc_initOnce();
-	return vilc_vkCreateImage(device, pCreateInfo, pAllocator, pImage);
+	return vilc_vkCreateImage(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_IMAGE), pImage);
 }
 VkResult vkCreateImageView(VkDevice device, const VkImageViewCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkImageView* pView) {
 	vilc_initOnce();
-	return vilc_vkCreateImageView(device, pCreateInfo, pAllocator, pView);
+	return vilc_vkCreateImageView(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_IMAGE_VIEW), pView);
 }
 VkResult vkCreateInstance(const VkInstanceCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkInstance* pInstance) {
 	vilc_initOnce();
-	VkResult result = vilc_vkCreateInstance(pCreateInfo, pAllocator, pInstance);
+	VkResult result = vilc_vkCreateInstance(pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_INSTANCE), pInstance);
 	if(result == VK_SUCCESS) {
 		loadedInstance = *pInstance;
 		volkGenLoadInstance(loadedInstance, vkGetInstanceProcAddrStub);
 		volkGenLoadDevice(loadedInstance, vkGetInstanceProcAddrStub);
+		vilc_installInstanceLayers();
+		vilc_installDeviceLayers();
 	}
 	return result;
 }
 VkResult vkCreatePipelineCache(VkDevice device, const VkPipelineCacheCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkPipelineCache* pPipelineCache) {
 	vilc_initOnce();
-	return vilc_vkCreatePipelineCache(device, pCreateInfo, pAllocator, pPipelineCache);
+	return vilc_vkCreatePipelineCache(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_PIPELINE_CACHE), pPipelineCache);
 }
 VkResult vkCreatePipelineLayout(VkDevice device, const VkPipelineLayoutCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkPipelineLayout* pPipelineLayout) {
 	vilc_initOnce();
-	return vilc_vkCreatePipelineLayout(device, pCreateInfo, pAllocator, pPipelineLayout);
+	return vilc_vkCreatePipelineLayout(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_PIPELINE_LAYOUT), pPipelineLayout);
 }
 VkResult vkCreateQueryPool(VkDevice device, const VkQueryPoolCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkQueryPool* pQueryPool) {
 	vilc_initOnce();
-	return vilc_vkCreateQueryPool(device, pCreateInfo, pAllocator, pQueryPool);
+	return vilc_vkCreateQueryPool(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_QUERY_POOL), pQueryPool);
 }
 VkResult vkCreateRenderPass(VkDevice device, const VkRenderPassCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkRenderPass* pRenderPass) {
 	vilc_initOnce();
-	return vilc_vkCreateRenderPass(device, pCreateInfo, pAllocator, pRenderPass);
+	return vilc_vkCreateRenderPass(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_RENDER_PASS), pRenderPass);
 }
 VkResult vkCreateSampler(VkDevice device, const VkSamplerCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkSampler* pSampler) {
 	vilc_initOnce();
-	return vilc_vkCreateSampler(device, pCreateInfo, pAllocator, pSampler);
+	return vilc_vkCreateSampler(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_SAMPLER), pSampler);
 }
 VkResult vkCreateSemaphore(VkDevice device, const VkSemaphoreCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkSemaphore* pSemaphore) {
 	vilc_initOnce();
-	return vilc_vkCreateSemaphore(device, pCreateInfo, pAllocator, pSemaphore);
+	return vilc_vkCreateSemaphore(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_SEMAPHORE), pSemaphore);
 }
 VkResult vkCreateShaderModule(VkDevice device, const VkShaderModuleCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkShaderModule* pShaderModule) {
 	vilc_initOnce();
-	return vilc_vkCreateShaderModule(device, pCreateInfo, pAllocator, pShaderModule);
+	return vilc_vkCreateShaderModule(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_SHADER_MODULE), pShaderModule);
 }
 void vkDestroyBuffer(VkDevice device, VkBuffer buffer, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyBuffer(device, buffer, pAllocator);
+	vilc_vkDestroyBuffer(device, buffer, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_BUFFER));
 }
 void vkDestroyBufferView(VkDevice device, VkBufferView bufferView, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyBufferView(device, bufferView, pAllocator);
+	vilc_vkDestroyBufferView(device, bufferView, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_BUFFER_VIEW));
 }
 void vkDestroyCommandPool(VkDevice device, VkCommandPool commandPool, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyCommandPool(device, commandPool, pAllocator);
+	vilc_vkDestroyCommandPool(device, commandPool, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_COMMAND_POOL));
 }
 void vkDestroyDescriptorPool(VkDevice device, VkDescriptorPool descriptorPool, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyDescriptorPool(device, descriptorPool, pAllocator);
+	vilc_vkDestroyDescriptorPool(device, descriptorPool, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_DESCRIPTOR_POOL));
 }
 void vkDestroyDescriptorSetLayout(VkDevice device, VkDescriptorSetLayout descriptorSetLayout, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyDescriptorSetLayout(device, descriptorSetLayout, pAllocator);
+	vilc_vkDestroyDescriptorSetLayout(device, descriptorSetLayout, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT));
 }
 void vkDestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyDevice(device, pAllocator);
+	vilc_vkDestroyDevice(device, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_DEVICE));
 }
 void vkDestroyEvent(VkDevice device, VkEvent event, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyEvent(device, event, pAllocator);
+	vilc_vkDestroyEvent(device, event, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_EVENT));
 }
 void vkDestroyFence(VkDevice device, VkFence fence, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyFence(device, fence, pAllocator);
+	vilc_vkDestroyFence(device, fence, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_FENCE));
 }
 void vkDestroyFramebuffer(VkDevice device, VkFramebuffer framebuffer, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyFramebuffer(device, framebuffer, pAllocator);
+	vilc_vkDestroyFramebuffer(device, framebuffer, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_FRAMEBUFFER));
 }
 void vkDestroyImage(VkDevice device, VkImage image, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyImage(device, image, pAllocator);
+	vilc_vkDestroyImage(device, image, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_IMAGE));
 }
 void vkDestroyImageView(VkDevice device, VkImageView imageView, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyImageView(device, imageView, pAllocator);
+	vilc_vkDestroyImageView(device, imageView, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_IMAGE_VIEW));
 }
 void vkDestroyInstance(VkInstance instance, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyInstance(instance, pAllocator);
+	vilc_vkDestroyInstance(instance, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_INSTANCE));
 }
 void vkDestroyPipeline(VkDevice device, VkPipeline pipeline, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyPipeline(device, pipeline, pAllocator);
+	vilc_vkDestroyPipeline(device, pipeline, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_PIPELINE));
 }
 void vkDestroyPipelineCache(VkDevice device, VkPipelineCache pipelineCache, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyPipelineCache(device, pipelineCache, pAllocator);
+	vilc_vkDestroyPipelineCache(device, pipelineCache, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_PIPELINE_CACHE));
 }
 void vkDestroyPipelineLayout(VkDevice device, VkPipelineLayout pipelineLayout, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyPipelineLayout(device, pipelineLayout, pAllocator);
+	vilc_vkDestroyPipelineLayout(device, pipelineLayout, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_PIPELINE_LAYOUT));
 }
 void vkDestroyQueryPool(VkDevice device, VkQueryPool queryPool, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyQueryPool(device, queryPool, pAllocator);
+	vilc_vkDestroyQueryPool(device, queryPool, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_QUERY_POOL));
 }
 void vkDestroyRenderPass(VkDevice device, VkRenderPass renderPass, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyRenderPass(device, renderPass, pAllocator);
+	vilc_vkDestroyRenderPass(device, renderPass, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_RENDER_PASS));
 }
 void vkDestroySampler(VkDevice device, VkSampler sampler, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroySampler(device, sampler, pAllocator);
+	vilc_vkDestroySampler(device, sampler, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_SAMPLER));
 }
 void vkDestroySemaphore(VkDevice device, VkSemaphore semaphore, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroySemaphore(device, semaphore, pAllocator);
+	vilc_vkDestroySemaphore(device, semaphore, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_SEMAPHORE));
 }
 void vkDestroyShaderModule(VkDevice device, VkShaderModule shaderModule, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyShaderModule(device, shaderModule, pAllocator);
+	vilc_vkDestroyShaderModule(device, shaderModule, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_SHADER_MODULE));
 }
 VkResult vkDeviceWaitIdle(VkDevice device) {
 	vilc_initOnce();
@@ -5607,7 +20650,7 @@ VkResult vkFreeDescriptorSets(VkDevice device, VkDescriptorPool descriptorPool,
 }
 void vkFreeMemory(VkDevice device, VkDeviceMemory memory, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkFreeMemory(device, memory, pAllocator);
+	vilc_vkFreeMemory(device, memory, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_DEVICE_MEMORY));
 }
 void vkGetBufferMemoryRequirements(VkDevice device, VkBuffer buffer, VkMemoryRequirements* pMemoryRequirements) {
 	vilc_initOnce();
@@ -5769,19 +20812,19 @@ void vkCmdSetDeviceMask(VkCommandBuffer commandBuffer, uint32_t deviceMask) {
 }
 VkResult vkCreateDescriptorUpdateTemplate(VkDevice device, const VkDescriptorUpdateTemplateCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDescriptorUpdateTemplate* pDescriptorUpdateTemplate) {
 	vilc_initOnce();
-	return vilc_vkCreateDescriptorUpdateTemplate(device, pCreateInfo, pAllocator, pDescriptorUpdateTemplate);
+	return vilc_vkCreateDescriptorUpdateTemplate(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_DESCRIPTOR_UPDATE_TEMPLATE), pDescriptorUpdateTemplate);
 }
 VkResult vkCreateSamplerYcbcrConversion(VkDevice device, const VkSamplerYcbcrConversionCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkSamplerYcbcrConversion* pYcbcrConversion) {
 	vilc_initOnce();
-	return vilc_vkCreateSamplerYcbcrConversion(device, pCreateInfo, pAllocator, pYcbcrConversion);
+	return vilc_vkCreateSamplerYcbcrConversion(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_SAMPLER_YCBCR_CONVERSION), pYcbcrConversion);
 }
 void vkDestroyDescriptorUpdateTemplate(VkDevice device, VkDescriptorUpdateTemplate descriptorUpdateTemplate, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyDescriptorUpdateTemplate(device, descriptorUpdateTemplate, pAllocator);
+	vilc_vkDestroyDescriptorUpdateTemplate(device, descriptorUpdateTemplate, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_DESCRIPTOR_UPDATE_TEMPLATE));
 }
 void vkDestroySamplerYcbcrConversion(VkDevice device, VkSamplerYcbcrConversion ycbcrConversion, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroySamplerYcbcrConversion(device, ycbcrConversion, pAllocator);
+	vilc_vkDestroySamplerYcbcrConversion(device, ycbcrConversion, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_SAMPLER_YCBCR_CONVERSION));
 }
 VkResult vkEnumerateInstanceVersion(uint32_t* pApiVersion) {
 	vilc_initOnce();
@@ -5887,7 +20930,7 @@ void vkCmdNextSubpass2(VkCommandBuffer commandBuffer, const VkSubpassBeginInfo*
 }
 VkResult vkCreateRenderPass2(VkDevice device, const VkRenderPassCreateInfo2* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkRenderPass* pRenderPass) {
 	vilc_initOnce();
-	return vilc_vkCreateRenderPass2(device, pCreateInfo, pAllocator, pRenderPass);
+	return vilc_vkCreateRenderPass2(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_RENDER_PASS), pRenderPass);
 }
 VkDeviceAddress vkGetBufferDeviceAddress(VkDevice device, const VkBufferDeviceAddressInfo* pInfo) {
 	vilc_initOnce();
@@ -6033,11 +21076,11 @@ void vkCmdWriteTimestamp2(VkCommandBuffer                   commandBuffer, VkPip
 }
 VkResult vkCreatePrivateDataSlot(VkDevice device, const VkPrivateDataSlotCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkPrivateDataSlot* pPrivateDataSlot) {
 	vilc_initOnce();
-	return vilc_vkCreatePrivateDataSlot(device, pCreateInfo, pAllocator, pPrivateDataSlot);
+	return vilc_vkCreatePrivateDataSlot(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_PRIVATE_DATA_SLOT), pPrivateDataSlot);
 }
 void vkDestroyPrivateDataSlot(VkDevice device, VkPrivateDataSlot privateDataSlot, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyPrivateDataSlot(device, privateDataSlot, pAllocator);
+	vilc_vkDestroyPrivateDataSlot(device, privateDataSlot, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_PRIVATE_DATA_SLOT));
 }
 void vkGetDeviceBufferMemoryRequirements(VkDevice device, const VkDeviceBufferMemoryRequirements* pInfo, VkMemoryRequirements2* pMemoryRequirements) {
 	vilc_initOnce();
@@ -6165,7 +21208,7 @@ void vkCmdInitializeGraphScratchMemoryAMDX(VkCommandBuffer
 }
 VkResult vkCreateExecutionGraphPipelinesAMDX(VkDevice                                        device, VkPipelineCache pipelineCache, uint32_t                                        createInfoCount, const VkExecutionGraphPipelineCreateInfoAMDX* pCreateInfos, const VkAllocationCallbacks*    pAllocator, VkPipeline*               pPipelines) {
 	vilc_initOnce();
-	return vilc_vkCreateExecutionGraphPipelinesAMDX(device, pipelineCache, createInfoCount, pCreateInfos, pAllocator, pPipelines);
+	return vilc_vkCreateExecutionGraphPipelinesAMDX(device, pipelineCache, createInfoCount, pCreateInfos, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_PIPELINE), pPipelines);
 }
 VkResult vkGetExecutionGraphPipelineNodeIndexAMDX(VkDevice                                        device, VkPipeline                                      executionGraph, const VkPipelineShaderStageNodeCreateInfoAMDX*  pNodeInfo, uint32_t*                                       pNodeIndex) {
 	vilc_initOnce();
@@ -6237,15 +21280,15 @@ void vkCmdDispatchDataGraphARM(VkCommandBuffer commandBuffer, VkDataGraphPipelin
 }
 VkResult vkCreateDataGraphPipelineSessionARM(VkDevice                                     device, const VkDataGraphPipelineSessionCreateInfoARM*   pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDataGraphPipelineSessionARM*                   pSession) {
 	vilc_initOnce();
-	return vilc_vkCreateDataGraphPipelineSessionARM(device, pCreateInfo, pAllocator, pSession);
+	return vilc_vkCreateDataGraphPipelineSessionARM(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_DATA_GRAPH_PIPELINE_SESSION_ARM), pSession);
 }
 VkResult vkCreateDataGraphPipelinesARM(VkDevice               device, VkDeferredOperationKHR deferredOperation, VkPipelineCache        pipelineCache, uint32_t               createInfoCount, const VkDataGraphPipelineCreateInfoARM* pCreateInfos, const VkAllocationCallbacks* pAllocator, VkPipeline*     pPipelines) {
 	vilc_initOnce();
-	return vilc_vkCreateDataGraphPipelinesARM(device, deferredOperation, pipelineCache, createInfoCount, pCreateInfos, pAllocator, pPipelines);
+	return vilc_vkCreateDataGraphPipelinesARM(device, deferredOperation, pipelineCache, createInfoCount, pCreateInfos, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_PIPELINE), pPipelines);
 }
 void vkDestroyDataGraphPipelineSessionARM(VkDevice device, VkDataGraphPipelineSessionARM session, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyDataGraphPipelineSessionARM(device, session, pAllocator);
+	vilc_vkDestroyDataGraphPipelineSessionARM(device, session, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_DATA_GRAPH_PIPELINE_SESSION_ARM));
 }
 VkResult vkGetDataGraphPipelineAvailablePropertiesARM(VkDevice device, const VkDataGraphPipelineInfoARM* pPipelineInfo, uint32_t* pPropertiesCount, VkDataGraphPipelinePropertyARM* pProperties) {
 	vilc_initOnce();
@@ -6289,19 +21332,19 @@ void vkCmdCopyTensorARM(VkCommandBuffer commandBuffer, const VkCopyTensorInfoARM
 }
 VkResult vkCreateTensorARM(VkDevice device, const VkTensorCreateInfoARM* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkTensorARM* pTensor) {
 	vilc_initOnce();
-	return vilc_vkCreateTensorARM(device, pCreateInfo, pAllocator, pTensor);
+	return vilc_vkCreateTensorARM(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_TENSOR_ARM), pTensor);
 }
 VkResult vkCreateTensorViewARM(VkDevice device, const VkTensorViewCreateInfoARM* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkTensorViewARM* pView) {
 	vilc_initOnce();
-	return vilc_vkCreateTensorViewARM(device, pCreateInfo, pAllocator, pView);
+	return vilc_vkCreateTensorViewARM(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_TENSOR_VIEW_ARM), pView);
 }
 void vkDestroyTensorARM(VkDevice device, VkTensorARM tensor, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyTensorARM(device, tensor, pAllocator);
+	vilc_vkDestroyTensorARM(device, tensor, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_TENSOR_ARM));
 }
 void vkDestroyTensorViewARM(VkDevice device, VkTensorViewARM tensorView, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyTensorViewARM(device, tensorView, pAllocator);
+	vilc_vkDestroyTensorViewARM(device, tensorView, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_TENSOR_VIEW_ARM));
 }
 void vkGetDeviceTensorMemoryRequirementsARM(VkDevice device, const VkDeviceTensorMemoryRequirementsARM* pInfo, VkMemoryRequirements2* pMemoryRequirements) {
 	vilc_initOnce();
@@ -6415,7 +21458,7 @@ VkResult vkDebugMarkerSetObjectTagEXT(VkDevice device, const VkDebugMarkerObject
 #if defined(VK_EXT_debug_report)
 VkResult vkCreateDebugReportCallbackEXT(VkInstance instance, const VkDebugReportCallbackCreateInfoEXT* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDebugReportCallbackEXT* pCallback) {
 	vilc_initOnce();
-	return vilc_vkCreateDebugReportCallbackEXT(instance, pCreateInfo, pAllocator, pCallback);
+	return vilc_vkCreateDebugReportCallbackEXT(instance, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_DEBUG_REPORT_CALLBACK_EXT), pCallback);
 }
 void vkDebugReportMessageEXT(VkInstance instance, VkDebugReportFlagsEXT flags, VkDebugReportObjectTypeEXT objectType, uint64_t object, size_t location, int32_t messageCode, const char* pLayerPrefix, const char* pMessage) {
 	vilc_initOnce();
@@ -6423,7 +21466,7 @@ void vkDebugReportMessageEXT(VkInstance instance, VkDebugReportFlagsEXT flags, V
 }
 void vkDestroyDebugReportCallbackEXT(VkInstance instance, VkDebugReportCallbackEXT callback, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyDebugReportCallbackEXT(instance, callback, pAllocator);
+	vilc_vkDestroyDebugReportCallbackEXT(instance, callback, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_DEBUG_REPORT_CALLBACK_EXT));
 }
 #endif /* defined(VK_EXT_debug_report) */
 #if defined(VK_EXT_debug_utils)
@@ -6441,11 +21484,11 @@ void vkCmdInsertDebugUtilsLabelEXT(VkCommandBuffer commandBuffer, const VkDebugU
 }
 VkResult vkCreateDebugUtilsMessengerEXT(VkInstance instance, const VkDebugUtilsMessengerCreateInfoEXT* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDebugUtilsMessengerEXT* pMessenger) {
 	vilc_initOnce();
-	return vilc_vkCreateDebugUtilsMessengerEXT(instance, pCreateInfo, pAllocator, pMessenger);
+	return vilc_vkCreateDebugUtilsMessengerEXT(instance, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_DEBUG_UTILS_MESSENGER_EXT), pMessenger);
 }
 void vkDestroyDebugUtilsMessengerEXT(VkInstance instance, VkDebugUtilsMessengerEXT messenger, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyDebugUtilsMessengerEXT(instance, messenger, pAllocator);
+	vilc_vkDestroyDebugUtilsMessengerEXT(instance, messenger, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_DEBUG_UTILS_MESSENGER_EXT));
 }
 void vkQueueBeginDebugUtilsLabelEXT(VkQueue queue, const VkDebugUtilsLabelEXT* pLabelInfo) {
 	vilc_initOnce();
@@ -6543,19 +21586,19 @@ void vkCmdPreprocessGeneratedCommandsEXT(VkCommandBuffer commandBuffer, const Vk
 }
 VkResult vkCreateIndirectCommandsLayoutEXT(VkDevice device, const VkIndirectCommandsLayoutCreateInfoEXT* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkIndirectCommandsLayoutEXT* pIndirectCommandsLayout) {
 	vilc_initOnce();
-	return vilc_vkCreateIndirectCommandsLayoutEXT(device, pCreateInfo, pAllocator, pIndirectCommandsLayout);
+	return vilc_vkCreateIndirectCommandsLayoutEXT(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_INDIRECT_COMMANDS_LAYOUT_EXT), pIndirectCommandsLayout);
 }
 VkResult vkCreateIndirectExecutionSetEXT(VkDevice device, const VkIndirectExecutionSetCreateInfoEXT* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkIndirectExecutionSetEXT* pIndirectExecutionSet) {
 	vilc_initOnce();
-	return vilc_vkCreateIndirectExecutionSetEXT(device, pCreateInfo, pAllocator, pIndirectExecutionSet);
+	return vilc_vkCreateIndirectExecutionSetEXT(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_INDIRECT_EXECUTION_SET_EXT), pIndirectExecutionSet);
 }
 void vkDestroyIndirectCommandsLayoutEXT(VkDevice device, VkIndirectCommandsLayoutEXT indirectCommandsLayout, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyIndirectCommandsLayoutEXT(device, indirectCommandsLayout, pAllocator);
+	vilc_vkDestroyIndirectCommandsLayoutEXT(device, indirectCommandsLayout, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_INDIRECT_COMMANDS_LAYOUT_EXT));
 }
 void vkDestroyIndirectExecutionSetEXT(VkDevice device, VkIndirectExecutionSetEXT indirectExecutionSet, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyIndirectExecutionSetEXT(device, indirectExecutionSet, pAllocator);
+	vilc_vkDestroyIndirectExecutionSetEXT(device, indirectExecutionSet, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_INDIRECT_EXECUTION_SET_EXT));
 }
 void vkGetGeneratedCommandsMemoryRequirementsEXT(VkDevice device, const VkGeneratedCommandsMemoryRequirementsInfoEXT* pInfo, VkMemoryRequirements2* pMemoryRequirements) {
 	vilc_initOnce();
@@ -6579,7 +21622,7 @@ VkResult vkReleaseDisplayEXT(VkPhysicalDevice physicalDevice, VkDisplayKHR displ
 #if defined(VK_EXT_directfb_surface)
 VkResult vkCreateDirectFBSurfaceEXT(VkInstance instance, const VkDirectFBSurfaceCreateInfoEXT* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkSurfaceKHR* pSurface) {
 	vilc_initOnce();
-	return vilc_vkCreateDirectFBSurfaceEXT(instance, pCreateInfo, pAllocator, pSurface);
+	return vilc_vkCreateDirectFBSurfaceEXT(instance, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_SURFACE_KHR), pSurface);
 }
 VkBool32 vkGetPhysicalDeviceDirectFBPresentationSupportEXT(VkPhysicalDevice physicalDevice, uint32_t queueFamilyIndex, IDirectFB* dfb) {
 	vilc_initOnce();
@@ -6613,11 +21656,11 @@ VkResult vkGetSwapchainCounterEXT(VkDevice device, VkSwapchainKHR swapchain, VkS
 }
 VkResult vkRegisterDeviceEventEXT(VkDevice device, const VkDeviceEventInfoEXT* pDeviceEventInfo, const VkAllocationCallbacks* pAllocator, VkFence* pFence) {
 	vilc_initOnce();
-	return vilc_vkRegisterDeviceEventEXT(device, pDeviceEventInfo, pAllocator, pFence);
+	return vilc_vkRegisterDeviceEventEXT(device, pDeviceEventInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_FENCE), pFence);
 }
 VkResult vkRegisterDisplayEventEXT(VkDevice device, VkDisplayKHR display, const VkDisplayEventInfoEXT* pDisplayEventInfo, const VkAllocationCallbacks* pAllocator, VkFence* pFence) {
 	vilc_initOnce();
-	return vilc_vkRegisterDisplayEventEXT(device, display, pDisplayEventInfo, pAllocator, pFence);
+	return vilc_vkRegisterDisplayEventEXT(device, display, pDisplayEventInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_FENCE), pFence);
 }
 #endif /* defined(VK_EXT_display_control) */
 #if defined(VK_EXT_display_surface_counter)
@@ -6677,7 +21720,7 @@ void vkSetHdrMetadataEXT(VkDevice device, uint32_t swapchainCount, const VkSwapc
 #if defined(VK_EXT_headless_surface)
 VkResult vkCreateHeadlessSurfaceEXT(VkInstance instance, const VkHeadlessSurfaceCreateInfoEXT* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkSurfaceKHR* pSurface) {
 	vilc_initOnce();
-	return vilc_vkCreateHeadlessSurfaceEXT(instance, pCreateInfo, pAllocator, pSurface);
+	return vilc_vkCreateHeadlessSurfaceEXT(instance, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_SURFACE_KHR), pSurface);
 }
 #endif /* defined(VK_EXT_headless_surface) */
 #if defined(VK_EXT_host_image_copy)
@@ -6751,7 +21794,7 @@ void vkExportMetalObjectsEXT(VkDevice device, VkExportMetalObjectsInfoEXT* pMeta
 #if defined(VK_EXT_metal_surface)
 VkResult vkCreateMetalSurfaceEXT(VkInstance instance, const VkMetalSurfaceCreateInfoEXT* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkSurfaceKHR* pSurface) {
 	vilc_initOnce();
-	return vilc_vkCreateMetalSurfaceEXT(instance, pCreateInfo, pAllocator, pSurface);
+	return vilc_vkCreateMetalSurfaceEXT(instance, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_SURFACE_KHR), pSurface);
 }
 #endif /* defined(VK_EXT_metal_surface) */
 #if defined(VK_EXT_multi_draw)
@@ -6803,11 +21846,11 @@ VkResult vkCopyMicromapToMemoryEXT(VkDevice device, VkDeferredOperationKHR defer
 }
 VkResult vkCreateMicromapEXT(VkDevice                                           device, const VkMicromapCreateInfoEXT*        pCreateInfo, const VkAllocationCallbacks*       pAllocator, VkMicromapEXT*                        pMicromap) {
 	vilc_initOnce();
-	return vilc_vkCreateMicromapEXT(device, pCreateInfo, pAllocator, pMicromap);
+	return vilc_vkCreateMicromapEXT(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_MICROMAP_EXT), pMicromap);
 }
 void vkDestroyMicromapEXT(VkDevice device, VkMicromapEXT micromap, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyMicromapEXT(device, micromap, pAllocator);
+	vilc_vkDestroyMicromapEXT(device, micromap, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_MICROMAP_EXT));
 }
 void vkGetDeviceMicromapCompatibilityEXT(VkDevice device, const VkMicromapVersionInfoEXT* pVersionInfo, VkAccelerationStructureCompatibilityKHR* pCompatibility) {
 	vilc_initOnce();
@@ -6837,11 +21880,11 @@ VkResult vkGetPipelinePropertiesEXT(VkDevice device, const VkPipelineInfoEXT* pP
 #if defined(VK_EXT_private_data)
 VkResult vkCreatePrivateDataSlotEXT(VkDevice device, const VkPrivateDataSlotCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkPrivateDataSlot* pPrivateDataSlot) {
 	vilc_initOnce();
-	return vilc_vkCreatePrivateDataSlotEXT(device, pCreateInfo, pAllocator, pPrivateDataSlot);
+	return vilc_vkCreatePrivateDataSlotEXT(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_PRIVATE_DATA_SLOT), pPrivateDataSlot);
 }
 void vkDestroyPrivateDataSlotEXT(VkDevice device, VkPrivateDataSlot privateDataSlot, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyPrivateDataSlotEXT(device, privateDataSlot, pAllocator);
+	vilc_vkDestroyPrivateDataSlotEXT(device, privateDataSlot, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_PRIVATE_DATA_SLOT));
 }
 void vkGetPrivateDataEXT(VkDevice device, VkObjectType objectType, uint64_t objectHandle, VkPrivateDataSlot privateDataSlot, uint64_t* pData) {
 	vilc_initOnce();
@@ -6879,11 +21922,11 @@ void vkCmdBindShadersEXT(VkCommandBuffer commandBuffer, uint32_t stageCount, con
 }
 VkResult vkCreateShadersEXT(VkDevice device, uint32_t createInfoCount, const VkShaderCreateInfoEXT* pCreateInfos, const VkAllocationCallbacks* pAllocator, VkShaderEXT* pShaders) {
 	vilc_initOnce();
-	return vilc_vkCreateShadersEXT(device, createInfoCount, pCreateInfos, pAllocator, pShaders);
+	return vilc_vkCreateShadersEXT(device, createInfoCount, pCreateInfos, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_SHADER_EXT), pShaders);
 }
 void vkDestroyShaderEXT(VkDevice device, VkShaderEXT shader, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyShaderEXT(device, shader, pAllocator);
+	vilc_vkDestroyShaderEXT(device, shader, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_SHADER_EXT));
 }
 VkResult vkGetShaderBinaryDataEXT(VkDevice device, VkShaderEXT shader, size_t* pDataSize, void* pData) {
 	vilc_initOnce();
@@ -6931,11 +21974,11 @@ void vkCmdEndTransformFeedbackEXT(VkCommandBuffer commandBuffer, uint32_t firstC
 #if defined(VK_EXT_validation_cache)
 VkResult vkCreateValidationCacheEXT(VkDevice device, const VkValidationCacheCreateInfoEXT* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkValidationCacheEXT* pValidationCache) {
 	vilc_initOnce();
-	return vilc_vkCreateValidationCacheEXT(device, pCreateInfo, pAllocator, pValidationCache);
+	return vilc_vkCreateValidationCacheEXT(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_VALIDATION_CACHE_EXT), pValidationCache);
 }
 void vkDestroyValidationCacheEXT(VkDevice device, VkValidationCacheEXT validationCache, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyValidationCacheEXT(device, validationCache, pAllocator);
+	vilc_vkDestroyValidationCacheEXT(device, validationCache, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_VALIDATION_CACHE_EXT));
 }
 VkResult vkGetValidationCacheDataEXT(VkDevice device, VkValidationCacheEXT validationCache, size_t* pDataSize, void* pData) {
 	vilc_initOnce();
@@ -6949,11 +21992,11 @@ VkResult vkMergeValidationCachesEXT(VkDevice device, VkValidationCacheEXT dstCac
 #if defined(VK_FUCHSIA_buffer_collection)
 VkResult vkCreateBufferCollectionFUCHSIA(VkDevice device, const VkBufferCollectionCreateInfoFUCHSIA* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkBufferCollectionFUCHSIA* pCollection) {
 	vilc_initOnce();
-	return vilc_vkCreateBufferCollectionFUCHSIA(device, pCreateInfo, pAllocator, pCollection);
+	return vilc_vkCreateBufferCollectionFUCHSIA(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_BUFFER_COLLECTION_FUCHSIA), pCollection);
 }
 void vkDestroyBufferCollectionFUCHSIA(VkDevice device, VkBufferCollectionFUCHSIA collection, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyBufferCollectionFUCHSIA(device, collection, pAllocator);
+	vilc_vkDestroyBufferCollectionFUCHSIA(device, collection, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_BUFFER_COLLECTION_FUCHSIA));
 }
 VkResult vkGetBufferCollectionPropertiesFUCHSIA(VkDevice device, VkBufferCollectionFUCHSIA collection, VkBufferCollectionPropertiesFUCHSIA* pProperties) {
 	vilc_initOnce();
@@ -6991,13 +22034,13 @@ VkResult vkImportSemaphoreZirconHandleFUCHSIA(VkDevice device, const VkImportSem
 #if defined(VK_FUCHSIA_imagepipe_surface)
 VkResult vkCreateImagePipeSurfaceFUCHSIA(VkInstance instance, const VkImagePipeSurfaceCreateInfoFUCHSIA* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkSurfaceKHR* pSurface) {
 	vilc_initOnce();
-	return vilc_vkCreateImagePipeSurfaceFUCHSIA(instance, pCreateInfo, pAllocator, pSurface);
+	return vilc_vkCreateImagePipeSurfaceFUCHSIA(instance, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_SURFACE_KHR), pSurface);
 }
 #endif /* defined(VK_FUCHSIA_imagepipe_surface) */
 #if defined(VK_GGP_stream_descriptor_surface)
 VkResult vkCreateStreamDescriptorSurfaceGGP(VkInstance instance, const VkStreamDescriptorSurfaceCreateInfoGGP* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkSurfaceKHR* pSurface) {
 	vilc_initOnce();
-	return vilc_vkCreateStreamDescriptorSurfaceGGP(instance, pCreateInfo, pAllocator, pSurface);
+	return vilc_vkCreateStreamDescriptorSurfaceGGP(instance, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_SURFACE_KHR), pSurface);
 }
 #endif /* defined(VK_GGP_stream_descriptor_surface) */
 #if defined(VK_GOOGLE_display_timing)
@@ -7119,11 +22162,11 @@ VkResult vkCopyMemoryToAccelerationStructureKHR(VkDevice device, VkDeferredOpera
 }
 VkResult vkCreateAccelerationStructureKHR(VkDevice                                           device, const VkAccelerationStructureCreateInfoKHR*        pCreateInfo, const VkAllocationCallbacks*       pAllocator, VkAccelerationStructureKHR*                        pAccelerationStructure) {
 	vilc_initOnce();
-	return vilc_vkCreateAccelerationStructureKHR(device, pCreateInfo, pAllocator, pAccelerationStructure);
+	return vilc_vkCreateAccelerationStructureKHR(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_ACCELERATION_STRUCTURE_KHR), pAccelerationStructure);
 }
 void vkDestroyAccelerationStructureKHR(VkDevice device, VkAccelerationStructureKHR accelerationStructure, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyAccelerationStructureKHR(device, accelerationStructure, pAllocator);
+	vilc_vkDestroyAccelerationStructureKHR(device, accelerationStructure, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_ACCELERATION_STRUCTURE_KHR));
 }
 void vkGetAccelerationStructureBuildSizesKHR(VkDevice                                            device, VkAccelerationStructureBuildTypeKHR                 buildType, const VkAccelerationStructureBuildGeometryInfoKHR*  pBuildInfo, const uint32_t*  pMaxPrimitiveCounts, VkAccelerationStructureBuildSizesInfoKHR*           pSizeInfo) {
 	vilc_initOnce();
@@ -7145,7 +22188,7 @@ VkResult vkWriteAccelerationStructuresPropertiesKHR(VkDevice device, uint32_t ac
 #if defined(VK_KHR_android_surface)
 VkResult vkCreateAndroidSurfaceKHR(VkInstance instance, const VkAndroidSurfaceCreateInfoKHR* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkSurfaceKHR* pSurface) {
 	vilc_initOnce();
-	return vilc_vkCreateAndroidSurfaceKHR(instance, pCreateInfo, pAllocator, pSurface);
+	return vilc_vkCreateAndroidSurfaceKHR(instance, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_SURFACE_KHR), pSurface);
 }
 #endif /* defined(VK_KHR_android_surface) */
 #if defined(VK_KHR_bind_memory2)
@@ -7239,13 +22282,13 @@ void vkCmdNextSubpass2KHR(VkCommandBuffer commandBuffer, const VkSubpassBeginInf
 }
 VkResult vkCreateRenderPass2KHR(VkDevice device, const VkRenderPassCreateInfo2* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkRenderPass* pRenderPass) {
 	vilc_initOnce();
-	return vilc_vkCreateRenderPass2KHR(device, pCreateInfo, pAllocator, pRenderPass);
+	return vilc_vkCreateRenderPass2KHR(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_RENDER_PASS), pRenderPass);
 }
 #endif /* defined(VK_KHR_create_renderpass2) */
 #if defined(VK_KHR_deferred_host_operations)
 VkResult vkCreateDeferredOperationKHR(VkDevice device, const VkAllocationCallbacks* pAllocator, VkDeferredOperationKHR* pDeferredOperation) {
 	vilc_initOnce();
-	return vilc_vkCreateDeferredOperationKHR(device, pAllocator, pDeferredOperation);
+	return vilc_vkCreateDeferredOperationKHR(device, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_DEFERRED_OPERATION_KHR), pDeferredOperation);
 }
 VkResult vkDeferredOperationJoinKHR(VkDevice device, VkDeferredOperationKHR operation) {
 	vilc_initOnce();
@@ -7253,7 +22296,7 @@ VkResult vkDeferredOperationJoinKHR(VkDevice device, VkDeferredOperationKHR oper
 }
 void vkDestroyDeferredOperationKHR(VkDevice device, VkDeferredOperationKHR operation, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyDeferredOperationKHR(device, operation, pAllocator);
+	vilc_vkDestroyDeferredOperationKHR(device, operation, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_DEFERRED_OPERATION_KHR));
 }
 uint32_t vkGetDeferredOperationMaxConcurrencyKHR(VkDevice device, VkDeferredOperationKHR operation) {
 	vilc_initOnce();
@@ -7267,11 +22310,11 @@ VkResult vkGetDeferredOperationResultKHR(VkDevice device, VkDeferredOperationKHR
 #if defined(VK_KHR_descriptor_update_template)
 VkResult vkCreateDescriptorUpdateTemplateKHR(VkDevice device, const VkDescriptorUpdateTemplateCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDescriptorUpdateTemplate* pDescriptorUpdateTemplate) {
 	vilc_initOnce();
-	return vilc_vkCreateDescriptorUpdateTemplateKHR(device, pCreateInfo, pAllocator, pDescriptorUpdateTemplate);
+	return vilc_vkCreateDescriptorUpdateTemplateKHR(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_DESCRIPTOR_UPDATE_TEMPLATE), pDescriptorUpdateTemplate);
 }
 void vkDestroyDescriptorUpdateTemplateKHR(VkDevice device, VkDescriptorUpdateTemplate descriptorUpdateTemplate, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyDescriptorUpdateTemplateKHR(device, descriptorUpdateTemplate, pAllocator);
+	vilc_vkDestroyDescriptorUpdateTemplateKHR(device, descriptorUpdateTemplate, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_DESCRIPTOR_UPDATE_TEMPLATE));
 }
 void vkUpdateDescriptorSetWithTemplateKHR(VkDevice device, VkDescriptorSet descriptorSet, VkDescriptorUpdateTemplate descriptorUpdateTemplate, const void* pData) {
 	vilc_initOnce();
@@ -7301,11 +22344,11 @@ VkResult vkEnumeratePhysicalDeviceGroupsKHR(VkInstance instance, uint32_t* pPhys
 #if defined(VK_KHR_display)
 VkResult vkCreateDisplayModeKHR(VkPhysicalDevice physicalDevice, VkDisplayKHR display, const VkDisplayModeCreateInfoKHR* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDisplayModeKHR* pMode) {
 	vilc_initOnce();
-	return vilc_vkCreateDisplayModeKHR(physicalDevice, display, pCreateInfo, pAllocator, pMode);
+	return vilc_vkCreateDisplayModeKHR(physicalDevice, display, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_DISPLAY_MODE_KHR), pMode);
 }
 VkResult vkCreateDisplayPlaneSurfaceKHR(VkInstance instance, const VkDisplaySurfaceCreateInfoKHR* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkSurfaceKHR* pSurface) {
 	vilc_initOnce();
-	return vilc_vkCreateDisplayPlaneSurfaceKHR(instance, pCreateInfo, pAllocator, pSurface);
+	return vilc_vkCreateDisplayPlaneSurfaceKHR(instance, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_SURFACE_KHR), pSurface);
 }
 VkResult vkGetDisplayModePropertiesKHR(VkPhysicalDevice physicalDevice, VkDisplayKHR display, uint32_t* pPropertyCount, VkDisplayModePropertiesKHR* pProperties) {
 	vilc_initOnce();
@@ -7331,7 +22374,7 @@ VkResult vkGetPhysicalDeviceDisplayPropertiesKHR(VkPhysicalDevice physicalDevice
 #if defined(VK_KHR_display_swapchain)
 VkResult vkCreateSharedSwapchainsKHR(VkDevice device, uint32_t swapchainCount, const VkSwapchainCreateInfoKHR* pCreateInfos, const VkAllocationCallbacks* pAllocator, VkSwapchainKHR* pSwapchains) {
 	vilc_initOnce();
-	return vilc_vkCreateSharedSwapchainsKHR(device, swapchainCount, pCreateInfos, pAllocator, pSwapchains);
+	return vilc_vkCreateSharedSwapchainsKHR(device, swapchainCount, pCreateInfos, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_SWAPCHAIN_KHR), pSwapchains);
 }
 #endif /* defined(VK_KHR_display_swapchain) */
 #if defined(VK_KHR_draw_indirect_count)
@@ -7641,11 +22684,11 @@ void vkReleaseProfilingLockKHR(VkDevice device) {
 #if defined(VK_KHR_pipeline_binary)
 VkResult vkCreatePipelineBinariesKHR(VkDevice device, const VkPipelineBinaryCreateInfoKHR* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkPipelineBinaryHandlesInfoKHR* pBinaries) {
 	vilc_initOnce();
-	return vilc_vkCreatePipelineBinariesKHR(device, pCreateInfo, pAllocator, pBinaries);
+	return vilc_vkCreatePipelineBinariesKHR(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_UNKNOWN), pBinaries);
 }
 void vkDestroyPipelineBinaryKHR(VkDevice device, VkPipelineBinaryKHR pipelineBinary, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyPipelineBinaryKHR(device, pipelineBinary, pAllocator);
+	vilc_vkDestroyPipelineBinaryKHR(device, pipelineBinary, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_PIPELINE_BINARY_KHR));
 }
 VkResult vkGetPipelineBinaryDataKHR(VkDevice device, const VkPipelineBinaryDataInfoKHR* pInfo, VkPipelineBinaryKeyKHR* pPipelineBinaryKey, size_t* pPipelineBinaryDataSize, void* pPipelineBinaryData) {
 	vilc_initOnce();
@@ -7657,7 +22700,7 @@ VkResult vkGetPipelineKeyKHR(VkDevice device, const VkPipelineCreateInfoKHR* pPi
 }
 VkResult vkReleaseCapturedPipelineDataKHR(VkDevice device, const VkReleaseCapturedPipelineDataInfoKHR* pInfo, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	return vilc_vkReleaseCapturedPipelineDataKHR(device, pInfo, pAllocator);
+	return vilc_vkReleaseCapturedPipelineDataKHR(device, pInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_UNKNOWN));
 }
 #endif /* defined(VK_KHR_pipeline_binary) */
 #if defined(VK_KHR_pipeline_executable_properties)
@@ -7713,7 +22756,7 @@ void vkCmdTraceRaysKHR(VkCommandBuffer commandBuffer, const VkStridedDeviceAddre
 }
 VkResult vkCreateRayTracingPipelinesKHR(VkDevice device, VkDeferredOperationKHR deferredOperation, VkPipelineCache pipelineCache, uint32_t createInfoCount, const VkRayTracingPipelineCreateInfoKHR* pCreateInfos, const VkAllocationCallbacks* pAllocator, VkPipeline* pPipelines) {
 	vilc_initOnce();
-	return vilc_vkCreateRayTracingPipelinesKHR(device, deferredOperation, pipelineCache, createInfoCount, pCreateInfos, pAllocator, pPipelines);
+	return vilc_vkCreateRayTracingPipelinesKHR(device, deferredOperation, pipelineCache, createInfoCount, pCreateInfos, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_PIPELINE), pPipelines);
 }
 VkResult vkGetRayTracingCaptureReplayShaderGroupHandlesKHR(VkDevice device, VkPipeline pipeline, uint32_t firstGroup, uint32_t groupCount, size_t dataSize, void* pData) {
 	vilc_initOnce();
@@ -7731,11 +22774,11 @@ VkDeviceSize vkGetRayTracingShaderGroupStackSizeKHR(VkDevice device, VkPipeline
 #if defined(VK_KHR_sampler_ycbcr_conversion)
 VkResult vkCreateSamplerYcbcrConversionKHR(VkDevice device, const VkSamplerYcbcrConversionCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkSamplerYcbcrConversion* pYcbcrConversion) {
 	vilc_initOnce();
-	return vilc_vkCreateSamplerYcbcrConversionKHR(device, pCreateInfo, pAllocator, pYcbcrConversion);
+	return vilc_vkCreateSamplerYcbcrConversionKHR(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_SAMPLER_YCBCR_CONVERSION), pYcbcrConversion);
 }
 void vkDestroySamplerYcbcrConversionKHR(VkDevice device, VkSamplerYcbcrConversion ycbcrConversion, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroySamplerYcbcrConversionKHR(device, ycbcrConversion, pAllocator);
+	vilc_vkDestroySamplerYcbcrConversionKHR(device, ycbcrConversion, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_SAMPLER_YCBCR_CONVERSION));
 }
 #endif /* defined(VK_KHR_sampler_ycbcr_conversion) */
 #if defined(VK_KHR_shared_presentable_image)
@@ -7747,7 +22790,7 @@ VkResult vkGetSwapchainStatusKHR(VkDevice device, VkSwapchainKHR swapchain) {
 #if defined(VK_KHR_surface)
 void vkDestroySurfaceKHR(VkInstance instance, VkSurfaceKHR surface, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroySurfaceKHR(instance, surface, pAllocator);
+	vilc_vkDestroySurfaceKHR(instance, surface, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_SURFACE_KHR));
 }
 VkResult vkGetPhysicalDeviceSurfaceCapabilitiesKHR(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface, VkSurfaceCapabilitiesKHR* pSurfaceCapabilities) {
 	vilc_initOnce();
@@ -7773,11 +22816,11 @@ VkResult vkAcquireNextImageKHR(VkDevice device, VkSwapchainKHR swapchain, uint64
 }
 VkResult vkCreateSwapchainKHR(VkDevice device, const VkSwapchainCreateInfoKHR* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkSwapchainKHR* pSwapchain) {
 	vilc_initOnce();
-	return vilc_vkCreateSwapchainKHR(device, pCreateInfo, pAllocator, pSwapchain);
+	return vilc_vkCreateSwapchainKHR(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_SWAPCHAIN_KHR), pSwapchain);
 }
 void vkDestroySwapchainKHR(VkDevice device, VkSwapchainKHR swapchain, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroySwapchainKHR(device, swapchain, pAllocator);
+	vilc_vkDestroySwapchainKHR(device, swapchain, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_SWAPCHAIN_KHR));
 }
 VkResult vkGetSwapchainImagesKHR(VkDevice device, VkSwapchainKHR swapchain, uint32_t* pSwapchainImageCount, VkImage* pSwapchainImages) {
 	vilc_initOnce();
@@ -7873,19 +22916,19 @@ void vkCmdEndVideoCodingKHR(VkCommandBuffer commandBuffer, const VkVideoEndCodin
 }
 VkResult vkCreateVideoSessionKHR(VkDevice device, const VkVideoSessionCreateInfoKHR* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkVideoSessionKHR* pVideoSession) {
 	vilc_initOnce();
-	return vilc_vkCreateVideoSessionKHR(device, pCreateInfo, pAllocator, pVideoSession);
+	return vilc_vkCreateVideoSessionKHR(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_VIDEO_SESSION_KHR), pVideoSession);
 }
 VkResult vkCreateVideoSessionParametersKHR(VkDevice device, const VkVideoSessionParametersCreateInfoKHR* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkVideoSessionParametersKHR* pVideoSessionParameters) {
 	vilc_initOnce();
-	return vilc_vkCreateVideoSessionParametersKHR(device, pCreateInfo, pAllocator, pVideoSessionParameters);
+	return vilc_vkCreateVideoSessionParametersKHR(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_VIDEO_SESSION_PARAMETERS_KHR), pVideoSessionParameters);
 }
 void vkDestroyVideoSessionKHR(VkDevice device, VkVideoSessionKHR videoSession, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyVideoSessionKHR(device, videoSession, pAllocator);
+	vilc_vkDestroyVideoSessionKHR(device, videoSession, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_VIDEO_SESSION_KHR));
 }
 void vkDestroyVideoSessionParametersKHR(VkDevice device, VkVideoSessionParametersKHR videoSessionParameters, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyVideoSessionParametersKHR(device, videoSessionParameters, pAllocator);
+	vilc_vkDestroyVideoSessionParametersKHR(device, videoSessionParameters, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_VIDEO_SESSION_PARAMETERS_KHR));
 }
 VkResult vkGetPhysicalDeviceVideoCapabilitiesKHR(VkPhysicalDevice physicalDevice, const VkVideoProfileInfoKHR* pVideoProfile, VkVideoCapabilitiesKHR* pCapabilities) {
 	vilc_initOnce();
@@ -7907,7 +22950,7 @@ VkResult vkUpdateVideoSessionParametersKHR(VkDevice device, VkVideoSessionParame
 #if defined(VK_KHR_wayland_surface)
 VkResult vkCreateWaylandSurfaceKHR(VkInstance instance, const VkWaylandSurfaceCreateInfoKHR* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkSurfaceKHR* pSurface) {
 	vilc_initOnce();
-	return vilc_vkCreateWaylandSurfaceKHR(instance, pCreateInfo, pAllocator, pSurface);
+	return vilc_vkCreateWaylandSurfaceKHR(instance, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_SURFACE_KHR), pSurface);
 }
 VkBool32 vkGetPhysicalDeviceWaylandPresentationSupportKHR(VkPhysicalDevice physicalDevice, uint32_t queueFamilyIndex, struct wl_display* display) {
 	vilc_initOnce();
@@ -7917,7 +22960,7 @@ VkBool32 vkGetPhysicalDeviceWaylandPresentationSupportKHR(VkPhysicalDevice physi
 #if defined(VK_KHR_win32_surface)
 VkResult vkCreateWin32SurfaceKHR(VkInstance instance, const VkWin32SurfaceCreateInfoKHR* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkSurfaceKHR* pSurface) {
 	vilc_initOnce();
-	return vilc_vkCreateWin32SurfaceKHR(instance, pCreateInfo, pAllocator, pSurface);
+	return vilc_vkCreateWin32SurfaceKHR(instance, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_SURFACE_KHR), pSurface);
 }
 VkBool32 vkGetPhysicalDeviceWin32PresentationSupportKHR(VkPhysicalDevice physicalDevice, uint32_t queueFamilyIndex) {
 	vilc_initOnce();
@@ -7927,7 +22970,7 @@ VkBool32 vkGetPhysicalDeviceWin32PresentationSupportKHR(VkPhysicalDevice physica
 #if defined(VK_KHR_xcb_surface)
 VkResult vkCreateXcbSurfaceKHR(VkInstance instance, const VkXcbSurfaceCreateInfoKHR* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkSurfaceKHR* pSurface) {
 	vilc_initOnce();
-	return vilc_vkCreateXcbSurfaceKHR(instance, pCreateInfo, pAllocator, pSurface);
+	return vilc_vkCreateXcbSurfaceKHR(instance, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_SURFACE_KHR), pSurface);
 }
 VkBool32 vkGetPhysicalDeviceXcbPresentationSupportKHR(VkPhysicalDevice physicalDevice, uint32_t queueFamilyIndex, xcb_connection_t* connection, xcb_visualid_t visual_id) {
 	vilc_initOnce();
@@ -7937,7 +22980,7 @@ VkBool32 vkGetPhysicalDeviceXcbPresentationSupportKHR(VkPhysicalDevice physicalD
 #if defined(VK_KHR_xlib_surface)
 VkResult vkCreateXlibSurfaceKHR(VkInstance instance, const VkXlibSurfaceCreateInfoKHR* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkSurfaceKHR* pSurface) {
 	vilc_initOnce();
-	return vilc_vkCreateXlibSurfaceKHR(instance, pCreateInfo, pAllocator, pSurface);
+	return vilc_vkCreateXlibSurfaceKHR(instance, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_SURFACE_KHR), pSurface);
 }
 VkBool32 vkGetPhysicalDeviceXlibPresentationSupportKHR(VkPhysicalDevice physicalDevice, uint32_t queueFamilyIndex, Display* dpy, VisualID visualID) {
 	vilc_initOnce();
@@ -7947,19 +22990,19 @@ VkBool32 vkGetPhysicalDeviceXlibPresentationSupportKHR(VkPhysicalDevice physical
 #if defined(VK_MVK_ios_surface)
 VkResult vkCreateIOSSurfaceMVK(VkInstance instance, const VkIOSSurfaceCreateInfoMVK* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkSurfaceKHR* pSurface) {
 	vilc_initOnce();
-	return vilc_vkCreateIOSSurfaceMVK(instance, pCreateInfo, pAllocator, pSurface);
+	return vilc_vkCreateIOSSurfaceMVK(instance, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_SURFACE_KHR), pSurface);
 }
 #endif /* defined(VK_MVK_ios_surface) */
 #if defined(VK_MVK_macos_surface)
 VkResult vkCreateMacOSSurfaceMVK(VkInstance instance, const VkMacOSSurfaceCreateInfoMVK* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkSurfaceKHR* pSurface) {
 	vilc_initOnce();
-	return vilc_vkCreateMacOSSurfaceMVK(instance, pCreateInfo, pAllocator, pSurface);
+	return vilc_vkCreateMacOSSurfaceMVK(instance, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_SURFACE_KHR), pSurface);
 }
 #endif /* defined(VK_MVK_macos_surface) */
 #if defined(VK_NN_vi_surface)
 VkResult vkCreateViSurfaceNN(VkInstance instance, const VkViSurfaceCreateInfoNN* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkSurfaceKHR* pSurface) {
 	vilc_initOnce();
-	return vilc_vkCreateViSurfaceNN(instance, pCreateInfo, pAllocator, pSurface);
+	return vilc_vkCreateViSurfaceNN(instance, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_SURFACE_KHR), pSurface);
 }
 #endif /* defined(VK_NN_vi_surface) */
 #if defined(VK_NVX_binary_import)
@@ -7969,19 +23012,19 @@ void vkCmdCuLaunchKernelNVX(VkCommandBuffer commandBuffer, const VkCuLaunchInfoN
 }
 VkResult vkCreateCuFunctionNVX(VkDevice device, const VkCuFunctionCreateInfoNVX* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkCuFunctionNVX* pFunction) {
 	vilc_initOnce();
-	return vilc_vkCreateCuFunctionNVX(device, pCreateInfo, pAllocator, pFunction);
+	return vilc_vkCreateCuFunctionNVX(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_CU_FUNCTION_NVX), pFunction);
 }
 VkResult vkCreateCuModuleNVX(VkDevice device, const VkCuModuleCreateInfoNVX* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkCuModuleNVX* pModule) {
 	vilc_initOnce();
-	return vilc_vkCreateCuModuleNVX(device, pCreateInfo, pAllocator, pModule);
+	return vilc_vkCreateCuModuleNVX(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_CU_MODULE_NVX), pModule);
 }
 void vkDestroyCuFunctionNVX(VkDevice device, VkCuFunctionNVX function, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyCuFunctionNVX(device, function, pAllocator);
+	vilc_vkDestroyCuFunctionNVX(device, function, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_CU_FUNCTION_NVX));
 }
 void vkDestroyCuModuleNVX(VkDevice device, VkCuModuleNVX module, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyCuModuleNVX(device, module, pAllocator);
+	vilc_vkDestroyCuModuleNVX(device, module, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_CU_MODULE_NVX));
 }
 #endif /* defined(VK_NVX_binary_import) */
 #if defined(VK_NVX_image_view_handle)
@@ -8077,19 +23120,19 @@ void vkCmdCudaLaunchKernelNV(VkCommandBuffer commandBuffer, const VkCudaLaunchIn
 }
 VkResult vkCreateCudaFunctionNV(VkDevice device, const VkCudaFunctionCreateInfoNV* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkCudaFunctionNV* pFunction) {
 	vilc_initOnce();
-	return vilc_vkCreateCudaFunctionNV(device, pCreateInfo, pAllocator, pFunction);
+	return vilc_vkCreateCudaFunctionNV(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_CUDA_FUNCTION_NV), pFunction);
 }
 VkResult vkCreateCudaModuleNV(VkDevice device, const VkCudaModuleCreateInfoNV* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkCudaModuleNV* pModule) {
 	vilc_initOnce();
-	return vilc_vkCreateCudaModuleNV(device, pCreateInfo, pAllocator, pModule);
+	return vilc_vkCreateCudaModuleNV(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_CUDA_MODULE_NV), pModule);
 }
 void vkDestroyCudaFunctionNV(VkDevice device, VkCudaFunctionNV function, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyCudaFunctionNV(device, function, pAllocator);
+	vilc_vkDestroyCudaFunctionNV(device, function, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_CUDA_FUNCTION_NV));
 }
 void vkDestroyCudaModuleNV(VkDevice device, VkCudaModuleNV module, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyCudaModuleNV(device, module, pAllocator);
+	vilc_vkDestroyCudaModuleNV(device, module, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_CUDA_MODULE_NV));
 }
 VkResult vkGetCudaModuleCacheNV(VkDevice device, VkCudaModuleNV module, size_t* pCacheSize, void* pCacheData) {
 	vilc_initOnce();
@@ -8127,11 +23170,11 @@ void vkCmdPreprocessGeneratedCommandsNV(VkCommandBuffer commandBuffer, const VkG
 }
 VkResult vkCreateIndirectCommandsLayoutNV(VkDevice device, const VkIndirectCommandsLayoutCreateInfoNV* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkIndirectCommandsLayoutNV* pIndirectCommandsLayout) {
 	vilc_initOnce();
-	return vilc_vkCreateIndirectCommandsLayoutNV(device, pCreateInfo, pAllocator, pIndirectCommandsLayout);
+	return vilc_vkCreateIndirectCommandsLayoutNV(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_INDIRECT_COMMANDS_LAYOUT_NV), pIndirectCommandsLayout);
 }
 void vkDestroyIndirectCommandsLayoutNV(VkDevice device, VkIndirectCommandsLayoutNV indirectCommandsLayout, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyIndirectCommandsLayoutNV(device, indirectCommandsLayout, pAllocator);
+	vilc_vkDestroyIndirectCommandsLayoutNV(device, indirectCommandsLayout, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_INDIRECT_COMMANDS_LAYOUT_NV));
 }
 void vkGetGeneratedCommandsMemoryRequirementsNV(VkDevice device, const VkGeneratedCommandsMemoryRequirementsInfoNV* pInfo, VkMemoryRequirements2* pMemoryRequirements) {
 	vilc_initOnce();
@@ -8155,11 +23198,11 @@ void vkGetPipelineIndirectMemoryRequirementsNV(VkDevice device, const VkComputeP
 #if defined(VK_NV_external_compute_queue)
 VkResult vkCreateExternalComputeQueueNV(VkDevice device, const VkExternalComputeQueueCreateInfoNV* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkExternalComputeQueueNV* pExternalQueue) {
 	vilc_initOnce();
-	return vilc_vkCreateExternalComputeQueueNV(device, pCreateInfo, pAllocator, pExternalQueue);
+	return vilc_vkCreateExternalComputeQueueNV(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_EXTERNAL_COMPUTE_QUEUE_NV), pExternalQueue);
 }
 void vkDestroyExternalComputeQueueNV(VkDevice device, VkExternalComputeQueueNV externalQueue, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyExternalComputeQueueNV(device, externalQueue, pAllocator);
+	vilc_vkDestroyExternalComputeQueueNV(device, externalQueue, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_EXTERNAL_COMPUTE_QUEUE_NV));
 }
 void vkGetExternalComputeQueueDataNV(VkExternalComputeQueueNV externalQueue, VkExternalComputeQueueDataParamsNV* params, void* pData) {
 	vilc_initOnce();
@@ -8249,11 +23292,11 @@ void vkCmdOpticalFlowExecuteNV(VkCommandBuffer commandBuffer, VkOpticalFlowSessi
 }
 VkResult vkCreateOpticalFlowSessionNV(VkDevice device, const VkOpticalFlowSessionCreateInfoNV* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkOpticalFlowSessionNV* pSession) {
 	vilc_initOnce();
-	return vilc_vkCreateOpticalFlowSessionNV(device, pCreateInfo, pAllocator, pSession);
+	return vilc_vkCreateOpticalFlowSessionNV(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_OPTICAL_FLOW_SESSION_NV), pSession);
 }
 void vkDestroyOpticalFlowSessionNV(VkDevice device, VkOpticalFlowSessionNV session, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyOpticalFlowSessionNV(device, session, pAllocator);
+	vilc_vkDestroyOpticalFlowSessionNV(device, session, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_OPTICAL_FLOW_SESSION_NV));
 }
 VkResult vkGetPhysicalDeviceOpticalFlowImageFormatsNV(VkPhysicalDevice physicalDevice, const VkOpticalFlowImageFormatInfoNV* pOpticalFlowImageFormatInfo, uint32_t* pFormatCount, VkOpticalFlowImageFormatPropertiesNV* pImageFormatProperties) {
 	vilc_initOnce();
@@ -8297,15 +23340,15 @@ VkResult vkCompileDeferredNV(VkDevice device, VkPipeline pipeline, uint32_t shad
 }
 VkResult vkCreateAccelerationStructureNV(VkDevice device, const VkAccelerationStructureCreateInfoNV* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkAccelerationStructureNV* pAccelerationStructure) {
 	vilc_initOnce();
-	return vilc_vkCreateAccelerationStructureNV(device, pCreateInfo, pAllocator, pAccelerationStructure);
+	return vilc_vkCreateAccelerationStructureNV(device, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_ACCELERATION_STRUCTURE_NV), pAccelerationStructure);
 }
 VkResult vkCreateRayTracingPipelinesNV(VkDevice device, VkPipelineCache pipelineCache, uint32_t createInfoCount, const VkRayTracingPipelineCreateInfoNV* pCreateInfos, const VkAllocationCallbacks* pAllocator, VkPipeline* pPipelines) {
 	vilc_initOnce();
-	return vilc_vkCreateRayTracingPipelinesNV(device, pipelineCache, createInfoCount, pCreateInfos, pAllocator, pPipelines);
+	return vilc_vkCreateRayTracingPipelinesNV(device, pipelineCache, createInfoCount, pCreateInfos, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_PIPELINE), pPipelines);
 }
 void vkDestroyAccelerationStructureNV(VkDevice device, VkAccelerationStructureNV accelerationStructure, const VkAllocationCallbacks* pAllocator) {
 	vilc_initOnce();
-	vilc_vkDestroyAccelerationStructureNV(device, accelerationStructure, pAllocator);
+	vilc_vkDestroyAccelerationStructureNV(device, accelerationStructure, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_ACCELERATION_STRUCTURE_NV));
 }
 VkResult vkGetAccelerationStructureHandleNV(VkDevice device, VkAccelerationStructureNV accelerationStructure, size_t dataSize, void* pData) {
 	vilc_initOnce();
@@ -8373,7 +23416,7 @@ VkResult vkQueueSignalReleaseImageOHOS(VkQueue queue, uint32_t waitSemaphoreCoun
 #if defined(VK_OHOS_surface)
 VkResult vkCreateSurfaceOHOS(VkInstance instance, const VkSurfaceCreateInfoOHOS* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkSurfaceKHR* pSurface) {
 	vilc_initOnce();
-	return vilc_vkCreateSurfaceOHOS(instance, pCreateInfo, pAllocator, pSurface);
+	return vilc_vkCreateSurfaceOHOS(instance, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_SURFACE_KHR), pSurface);
 }
 #endif /* defined(VK_OHOS_surface) */
 #if defined(VK_QCOM_tile_memory_heap)
@@ -8415,7 +23458,7 @@ VkResult vkGetScreenBufferPropertiesQNX(VkDevice device, const struct _screen_bu
 #if defined(VK_QNX_screen_surface)
 VkResult vkCreateScreenSurfaceQNX(VkInstance instance, const VkScreenSurfaceCreateInfoQNX* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkSurfaceKHR* pSurface) {
 	vilc_initOnce();
-	return vilc_vkCreateScreenSurfaceQNX(instance, pCreateInfo, pAllocator, pSurface);
+	return vilc_vkCreateScreenSurfaceQNX(instance, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_SURFACE_KHR), pSurface);
 }
 VkBool32 vkGetPhysicalDeviceScreenPresentationSupportQNX(VkPhysicalDevice physicalDevice, uint32_t queueFamilyIndex, struct _screen_window* window) {
 	vilc_initOnce();
@@ -8435,7 +23478,7 @@ void vkGetDescriptorSetLayoutHostMappingInfoVALVE(VkDevice device, const VkDescr
 #if defined(VK_WEBROGUE_surface)
 VkResult vkCreateSurfaceWEBROGUE(VkInstance instance, const VkSurfaceCreateInfoWEBROGUE* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkSurfaceKHR* pSurface) {
 	vilc_initOnce();
-	return vilc_vkCreateSurfaceWEBROGUE(instance, pCreateInfo, pAllocator, pSurface);
+	return vilc_vkCreateSurfaceWEBROGUE(instance, pCreateInfo, VILC_HOST_ALLOCATOR(pAllocator, VK_OBJECT_TYPE_SURFACE_KHR), pSurface);
 }
 #endif /* defined(VK_WEBROGUE_surface) */
 #if (defined(VK_EXT_depth_clamp_control)) || (defined(VK_EXT_shader_object) && defined(VK_EXT_depth_clamp_control))